@@ -0,0 +1,1303 @@
+/*
+ * CSC8502 Coursework - 子系统基准测试
+ *
+ * 不开窗口、不需要显卡（OpenGL 换成空实现，见 NullGL.h），
+ * 在没有显示器的 Linux 上也能跑。测的都是 CPU 这一侧的热点：
+ *   matrix4.*     Matrix4 乘法、变换向量、求逆、构建视图矩阵（固定的随机矩阵）
+ *   noise.*       TerrainNoise 生成 4096×4096 高度图：fBm、山脊、域扭曲，报告每秒采样点数
+ *   erosion.*     TerrainErosion 在 2048×2048 噪声高度图上迭代，按 1 / 2 / 4 个线程扫描，
+ *                 报告每秒迭代次数
+ *   terrain.*     地形构建的每个阶段：自带高度图，和 513×513 噪声地形（固定种子），
+ *                 处理项是顶点数
+ *                 GetHeightAt：一百万次固定的随机查询
+ *                 SelectLod：沿一圈固定的相机位置给各块选 LOD 级别
+ *   bake.*        TerrainBake 烘焙自带高度图的法线、地平线、AO 贴图（512×512），
+ *                 按 1 / 2 / 4 个线程扫描，报告每秒像素数
+ *   splat.*       TerrainSplat 按 Renderer 的三层设置生成自带高度图的材质混合图，报告每秒像素数
+ *   edit.*        TerrainEditor 在自带高度图上沿固定路线画 100 笔，每笔后 UpdateDirtyRegions
+ *                 （小笔刷抬高、大笔刷平滑），报告每秒笔数；rebuild 是一次 RebuildMesh 全量重建，
+ *                 作为对照
+ *   mesh.*        Mesh::LoadFromMeshFile：Meshes 目录下的立方体、球体、角色，处理项是文件行数
+ *   animation.*   MeshAnimation：角色动画文件
+ *   jobs.*        作业系统：均匀的 ParallelFor、一批网格文件并行载入，按 1 / 2 / 4 个线程扫描；
+ *                 一万个空作业的排队和等待
+ *   alloc.*       同样 16384 个小对象分配再释放（释放顺序打乱）：malloc 是 new / delete，
+ *                 pool 是 ObjectPool，arena 是 LinearArena（不单独释放，最后 Reset），
+ *                 报告每秒对象数
+ *   log.*         一万条 LOG_INFO 在调用线程上的开销（输出丢弃），报告每秒条数
+ *   texture.*     Texture 的图片解码：JPG / TGA / PNG
+ *   skybox.*      Skybox::loadCubemap：6 张天空盒贴图
+ *   culling.*     水面分块：按地形给分块分类，和剔除被地形遮住的水面区块
+ *   shore.*       ShorelineDistance 的 4096×4096 距离变换，报告每秒像素数
+ *   ocean.*       OceanFFT 每帧的海面计算：128 / 256 / 512 网格，按 1 / 2 / 4 个线程扫描，
+ *                 报告每秒网格点数
+ *   waterquery.*  WaterQuery 在 256 网格的海面上批量查询 65536 个点，报告每秒查询点数
+ *   water.*       水面 clipmap：覆盖范围不变，每层 32 / 64 / 128 格（越多越细），
+ *                 相机飞行时每帧更新和剔除的开销，报告每秒帧数，按顶点数扫描
+ *   shallowwater.* ShallowWater 在平台上的坑里倒一大团水，模拟 150 步（5 秒），
+ *                 报告每秒处理的块数
+ *   pipeline.*    FramePipeline 驱动合成的帧负载（见 SyntheticFrame.h）：更新约 2 毫秒计算，
+ *                 渲染约 1 毫秒计算加 2 毫秒等待（像交换缓冲时等 GPU），
+ *                 serial / pipelined 两种模式各跑 60 帧，报告每秒帧数
+ *   scaling.*     用 StressScene 生成的场景做规模扫描，每次只改一个参数：
+ *                 地形边长、纹理数、网格实例数、光源数、角色数，
+ *                 最后输出每组的时间和增长指数（见 BenchmarkSuite::PrintScaling）
+ *   scene.*       --scene 指定的场景：构建一次、Update 100 帧
+ *   startup.*     像 Renderer 构造时一样载入自带场景（地形、烘焙贴图、材质混合图、
+ *                 地形纹理、天空盒），派生数据缓存开在临时目录里：
+ *                 cold 每次先清空缓存，warm 全部从缓存读取。
+ *                 其他项都不开缓存，测的是真正的生成
+ * 每项预热一次后运行 --repeats 次，记录最小值和中位数（毫秒），和基线比较最小值。
+ * 按数量计的项（采样点、迭代、查询点）另外输出每秒处理多少个。
+ * 硬件计数器可用时（Linux perf_event）每项还输出 IPC、每个处理项的缓存和分支未命中，
+ * 不可用时这几列是 n/a，计时照常。
+ *
+ * 命令行参数：
+ *   --repeats 次数     每项计时的次数（默认 7）
+ *   --filter 文字      只运行名字里包含这段文字的项
+ *   --data 目录        Textures / Meshes 所在的目录（默认当前目录）
+ *   --write 文件       把结果写成 JSON 基线
+ *   --compare 文件     和 JSON 基线比较，有项退化时返回 1
+ *   --threshold 百分比 比基线慢超过多少算退化（默认 15）
+ *   --floor 毫秒       绝对差小于这个值的不算退化（默认 0.05）
+ *   --workers 个数     作业系统的工作线程数（默认每个硬件线程一个，减去主线程）。
+ *                      按线程数扫描的项在线程比核少的机器上看不出加速，
+ *                      可以用它固定线程数，让不同机器上的结果可以比较
+ *   --scene 参数       另外测一个指定的压力测试场景，如
+ *                      "seed=7,heightmap=513,meshes=2000,characters=16,lights=64,textures=8"
+ *                      （格式见 StressScene::ParseSpec）
+ *   --governor         不跑基准测试，改为运行帧时间预算控制器的模拟测试
+ *                      （见 GovernorSim.h），有场景没通过时返回 1
+ *   --flythrough [帧数] 不跑基准测试，改为无窗口的相机飞行（默认 1000 帧，见 Flythrough.h）：
+ *                      输出帧时间的 p50 / p95 / p99 / 最差帧，每帧明细写到 CSV
+ *   --warmup 帧数      相机飞行正式记录前的预热帧数（默认 60）
+ *   --path 文件        相机路径文件（默认绕地形一圈，格式见 CameraPath.h）
+ *   --csv 文件         相机飞行的每帧明细（默认 flythrough.csv）
+ *
+ * 返回值：0 正常，1 有项退化，2 参数或文件错误。
+ *
+ * 基线和机器有关：Benchmarks/baseline.json 是在一台机器上记录的参考值，
+ * 在自己的机器上先用 --write 记录一份，改动代码后再用 --compare 比较。
+ * Linux 上的编译方法见 Benchmarks/Makefile。
+ */
+
+#include "BenchmarkSuite.h"
+#include "Flythrough.h"
+#include "FramePipeline.h"
+#include "GovernorSim.h"
+#include "NullGL.h"
+#include "OceanFFT.h"
+#include "ShallowWater.h"
+#include "ShorelineDistance.h"
+#include "Skybox.h"
+#include "StressScene.h"
+#include "SyntheticFrame.h"
+#include "Terrain.h"
+#include "TerrainBake.h"
+#include "TerrainEditor.h"
+#include "TerrainErosion.h"
+#include "TerrainNoise.h"
+#include "TerrainSplat.h"
+#include "Texture.h"
+#include "WaterClipmap.h"
+#include "WaterQuery.h"
+#include "WaterTileMap.h"
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/HardwareCounters.h"
+#include "nclgl/JobSystem.h"
+#include "nclgl/LinearArena.h"
+#include "nclgl/Log.h"
+#include "nclgl/Matrix4.h"
+#include "nclgl/Mesh.h"
+#include "nclgl/MeshAnimation.h"
+#include "nclgl/PoolAllocator.h"
+#include "nclgl/common.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>  // SetConsoleOutputCP
+#endif
+
+// ========================================
+// 命令行参数
+// ========================================
+struct BenchmarkOptions
+{
+    int repeats = 7;
+    std::string filter;
+    std::string dataDirectory;
+    std::string writePath;
+    std::string comparePath;
+    double thresholdPercent = 15.0;
+    double floorMs = 0.05;
+    int workers = -1;
+    bool customScene = false;
+    StressScene::Settings scene;
+    bool governor = false;
+    bool flythrough = false;
+    FlythroughOptions flythroughOptions;
+};
+
+static bool ParseArguments(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--repeats") == 0 && hasValue) {
+            options.repeats = atoi(argv[++i]);
+        } else if (strcmp(arg, "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(arg, "--data") == 0 && hasValue) {
+            options.dataDirectory = argv[++i];
+        } else if (strcmp(arg, "--write") == 0 && hasValue) {
+            options.writePath = argv[++i];
+        } else if (strcmp(arg, "--compare") == 0 && hasValue) {
+            options.comparePath = argv[++i];
+        } else if (strcmp(arg, "--threshold") == 0 && hasValue) {
+            options.thresholdPercent = atof(argv[++i]);
+        } else if (strcmp(arg, "--floor") == 0 && hasValue) {
+            options.floorMs = atof(argv[++i]);
+        } else if (strcmp(arg, "--workers") == 0 && hasValue) {
+            options.workers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--scene") == 0 && hasValue) {
+            if (!StressScene::ParseSpec(argv[++i], options.scene)) {
+                return false;
+            }
+            options.customScene = true;
+        } else if (strcmp(arg, "--governor") == 0) {
+            options.governor = true;
+        } else if (strcmp(arg, "--flythrough") == 0) {
+            options.flythrough = true;
+            // 帧数可以省略
+            if (hasValue && atoi(argv[i + 1]) > 0) {
+                options.flythroughOptions.frames = atoi(argv[++i]);
+            }
+        } else if (strcmp(arg, "--warmup") == 0 && hasValue) {
+            options.flythroughOptions.warmup = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(arg, "--path") == 0 && hasValue) {
+            options.flythroughOptions.pathFile = argv[++i];
+        } else if (strcmp(arg, "--csv") == 0 && hasValue) {
+            options.flythroughOptions.csvFile = argv[++i];
+        } else {
+            LOG_ERROR("错误：无法识别的参数 " << arg);
+            return false;
+        }
+    }
+    if (options.repeats <= 0) {
+        LOG_ERROR("错误：--repeats 必须大于 0");
+        return false;
+    }
+    return true;
+}
+
+// ========================================
+// 固定的伪随机数（线性同余），每项测试的输入每次都一样
+// ========================================
+class FixedRandom
+{
+public:
+    explicit FixedRandom(unsigned int seed) : m_State(seed) {}
+
+    float Next(float low, float high)
+    {
+        m_State = m_State * 1664525u + 1013904223u;
+        return low + (high - low) * ((m_State >> 8) / 16777216.0f);
+    }
+
+private:
+    unsigned int m_State;
+};
+
+// 防止编译器把没用到结果的计算整个删掉
+static volatile float g_Sink;
+
+// ========================================
+// Matrix4
+// ========================================
+static void BenchMatrix(BenchmarkSuite& suite)
+{
+    const int count = 1024;
+    const int passes = 100;
+    FixedRandom random(42);
+    std::vector<Matrix4> matrices;
+    std::vector<Vector3> points;
+    for (int i = 0; i < count; ++i) {
+        Vector3 axis(random.Next(-1, 1), random.Next(-1, 1), random.Next(-1, 1));
+        axis.Normalise();
+        Vector3 offset(random.Next(-50, 50), random.Next(-50, 50), random.Next(-50, 50));
+        matrices.push_back(Matrix4::Translation(offset) * Matrix4::Rotation(random.Next(0, 360), axis));
+        points.push_back(Vector3(random.Next(-10, 10), random.Next(-10, 10), random.Next(-10, 10)));
+    }
+
+    suite.Run("matrix4.multiply_100k", [&]() {
+        Matrix4 result;
+        for (int p = 0; p < passes; ++p) {
+            for (int i = 0; i < count; ++i) {
+                result = matrices[i] * matrices[(i + p) % count];
+                g_Sink = result.values[12];
+            }
+        }
+    });
+    suite.Run("matrix4.transform_100k", [&]() {
+        float sum = 0.0f;
+        for (int p = 0; p < passes; ++p) {
+            for (int i = 0; i < count; ++i) {
+                sum += (matrices[i] * points[(i + p) % count]).y;
+            }
+        }
+        g_Sink = sum;
+    });
+    suite.Run("matrix4.inverse_10k", [&]() {
+        for (int p = 0; p < passes / 10; ++p) {
+            for (int i = 0; i < count; ++i) {
+                g_Sink = matrices[i].Inverse().values[0];
+            }
+        }
+    });
+    suite.Run("matrix4.view_matrix_10k", [&]() {
+        for (int p = 0; p < passes / 10; ++p) {
+            for (int i = 0; i < count; ++i) {
+                g_Sink = Matrix4::BuildViewMatrix(points[i], points[(i + p + 1) % count]).values[0];
+            }
+        }
+    });
+}
+
+// ========================================
+// 噪声
+// ========================================
+// 和 Renderer 的噪声地形一样的默认参数（6 层单纯形 fBm），分别打开山脊和域扭曲
+// ========================================
+static void BenchNoise(BenchmarkSuite& suite)
+{
+    const int size = 4096;
+    TerrainNoise noise(1337);
+    std::vector<float> heights;
+
+    TerrainNoise::Settings fbm;
+    TerrainNoise::Settings ridged;
+    ridged.ridged = true;
+    TerrainNoise::Settings warp;
+    warp.warpStrength = 0.5f;
+
+    const std::pair<const char*, TerrainNoise::Settings> variants[] = {
+        { "noise.fbm_4k", fbm }, { "noise.ridged_4k", ridged }, { "noise.warp_4k", warp }
+    };
+    for (const auto& variant : variants) {
+        suite.Run(variant.first, [&]() {
+            noise.Generate(variant.second, heights, size, size);
+            g_Sink = heights[size * size / 2];
+        }, static_cast<double>(size) * size);
+    }
+}
+
+// ========================================
+// 侵蚀
+// ========================================
+// 每次运行从同一张噪声高度图开始（复制高度图的时间也算在内，和迭代比很小），
+// 用默认参数跑 EROSION_ITERATIONS 次迭代。线程数是传给 TerrainErosion 的上限，
+// 作业系统的线程不够时多出来的不起作用（见 --workers）。
+// 按线程数扫描时增长指数 -1 表示随线程数线性加速，0 表示没有加速
+// ========================================
+static const int EROSION_ITERATIONS = 2;
+
+static void BenchErosion(BenchmarkSuite& suite)
+{
+    const int size = 2048;
+    const std::vector<int> threadCounts = { 1, 2, 4 };
+    std::vector<std::string> names;
+    for (int threads : threadCounts) {
+        names.push_back("erosion.2k_threads_" + std::to_string(threads));
+    }
+    suite.AddSweep("erosion (threads)", threadCounts, names);
+
+    bool any = false;
+    for (const std::string& name : names) {
+        any = any || suite.IsSelected(name);
+    }
+    if (!any) {
+        return;
+    }
+
+    std::vector<float> start;
+    TerrainNoise(1337).Generate(TerrainNoise::Settings(), start, size, size);
+    std::vector<float> heights;
+    for (size_t i = 0; i < threadCounts.size(); ++i) {
+        suite.Run(names[i], [&]() {
+            heights = start;
+            TerrainErosion erosion(TerrainErosion::Settings(), threadCounts[i]);
+            erosion.Run(heights, size, size, EROSION_ITERATIONS);
+            g_Sink = heights[size * size / 2];
+        }, EROSION_ITERATIONS);
+    }
+}
+
+// ========================================
+// 按 ProfileScope 记录
+// ========================================
+// 一次构建里各个阶段的时间来自代码里的 ProfileScope：每次构建前清空，构建后读出。
+// metrics 是 (项名, scope 名)，scope 名为空表示整个 build 的时间。
+// 有硬件计数器时各阶段的计数也来自 ProfileScope，处理项是 scope 每次调用的元素数
+// （地形是顶点数），整个 build 用各阶段里最大的元素数
+// ========================================
+typedef std::vector<std::pair<std::string, std::string>> ScopeMetrics;
+
+static void RecordScopes(BenchmarkSuite& suite, const ScopeMetrics& metrics,
+                         const std::function<void()>& build)
+{
+    bool any = false;
+    for (const auto& metric : metrics) {
+        any = any || suite.IsSelected(metric.first);
+    }
+    if (!any) {
+        return;
+    }
+
+    bool counting = HardwareCounters::HasCounters();
+    std::vector<std::vector<double>> samples(metrics.size());
+    std::vector<HardwareSample> counters(metrics.size(), HardwareSample());
+    std::vector<double> items(metrics.size(), 0.0);
+    build();
+    for (int i = 0; i < suite.GetRepeats(); ++i) {
+        ProfileScope::Reset();
+        HardwareSample before, after;
+        if (counting) {
+            HardwareCounters::Read(before);
+        }
+        auto start = std::chrono::steady_clock::now();
+        build();
+        double total = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        if (counting) {
+            HardwareCounters::Read(after);
+        }
+
+        double largest = 0.0;
+        for (size_t m = 0; m < metrics.size(); ++m) {
+            long long calls = 0;
+            long long elements = 0;
+            HardwareSample totals = {};
+            if (metrics[m].second.empty()) {
+                samples[m].push_back(total);
+                if (counting) {
+                    BenchmarkSuite::AddCounts(counters[m], before, after);
+                }
+            } else if (ProfileScope::GetTotals(metrics[m].second.c_str(), calls, elements, totals)) {
+                samples[m].push_back(totals.milliseconds);
+                items[m] = calls > 0 ? static_cast<double>(elements) / calls : 0.0;
+                largest = std::max(largest, items[m]);
+                BenchmarkSuite::AddCounts(counters[m], HardwareSample(), totals);
+            }
+        }
+        for (size_t m = 0; m < metrics.size(); ++m) {
+            if (metrics[m].second.empty()) {
+                items[m] = largest;
+            }
+        }
+    }
+
+    for (size_t m = 0; m < metrics.size(); ++m) {
+        suite.Record(metrics[m].first, samples[m], items[m], counting ? &counters[m] : nullptr);
+    }
+}
+
+// ========================================
+// 地形
+// ========================================
+static ScopeMetrics TerrainStages(const std::string& prefix, const std::vector<const char*>& stages)
+{
+    ScopeMetrics metrics;
+    metrics.push_back(std::make_pair(prefix + ".total", std::string()));
+    for (const char* stage : stages) {
+        metrics.push_back(std::make_pair(prefix + "." + stage, std::string("Terrain::") + stage));
+    }
+    return metrics;
+}
+
+static void BenchTerrain(BenchmarkSuite& suite)
+{
+    RecordScopes(suite, TerrainStages("terrain.heightmap",
+        { "LoadHeightmap", "GenerateVertices", "GenerateIndices", "CalculateNormals", "ComputeLodErrors", "SetupMesh" }),
+        []() { Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f); });
+
+    TerrainNoise noise(1337);
+    TerrainNoise::Settings settings;
+    RecordScopes(suite, TerrainStages("terrain.noise513",
+        { "GenerateHeights", "GenerateVertices", "GenerateIndices", "CalculateNormals", "ComputeLodErrors", "SetupMesh" }),
+        [&]() { Terrain terrain(noise, settings, 513, 100.0f, 10.0f); });
+
+    if (!suite.IsSelected("terrain.get_height_at_1m") && !suite.IsSelected("terrain.select_lod_256")) {
+        return;
+    }
+    Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+    std::vector<float> queries;
+    FixedRandom random(7);
+    float half = terrain.GetTerrainSize() * 0.5f;
+    for (int i = 0; i < 1 << 17; ++i) {
+        queries.push_back(random.Next(-half, half));
+    }
+    suite.Run("terrain.get_height_at_1m", [&]() {
+        float sum = 0.0f;
+        for (int p = 0; p < 16; ++p) {
+            for (size_t i = 0; i + 1 < queries.size(); i += 2) {
+                sum += terrain.GetHeightAt(queries[i], queries[i + 1]);
+            }
+        }
+        g_Sink = sum;
+    });
+
+    // 1080p、45 度视角时的投影系数，允许 2 像素误差
+    const float projectionScale = 1080.0f / (2.0f * tanf(45.0f * 0.5f * 3.14159265f / 180.0f));
+    suite.Run("terrain.select_lod_256", [&]() {
+        int triangles = 0;
+        for (int i = 0; i < 256; ++i) {
+            float angle = i * (6.2831853f / 256.0f);
+            Vector3 camera(cosf(angle) * half * 0.8f, 20.0f + (i % 16) * 4.0f, sinf(angle) * half * 0.8f);
+            terrain.SelectLod(camera, projectionScale, 2.0f);
+            triangles += terrain.GetDrawnTriangleCount();
+        }
+        g_Sink = (float)triangles;
+    });
+}
+
+// ========================================
+// 烘焙
+// ========================================
+// 贴图分辨率取 512（自带高度图是 1025，全分辨率一次一秒多，三个线程数扫下来太久），
+// 每个像素的工作量和全分辨率时一样
+// ========================================
+static void BenchBake(BenchmarkSuite& suite)
+{
+    const std::vector<int> threadCounts = { 1, 2, 4 };
+    std::vector<std::string> names;
+    for (int threads : threadCounts) {
+        names.push_back("bake.heightmap_threads_" + std::to_string(threads));
+    }
+    suite.AddSweep("bake (threads)", threadCounts, names);
+
+    bool any = false;
+    for (const std::string& name : names) {
+        any = any || suite.IsSelected(name);
+    }
+    if (!any) {
+        return;
+    }
+
+    Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+    TerrainBake::Settings settings;
+    settings.resolution = 512;
+    for (size_t i = 0; i < threadCounts.size(); ++i) {
+        TerrainBake bake(settings, threadCounts[i]);
+        suite.Run(names[i], [&]() { bake.Bake(terrain); },
+                  static_cast<double>(settings.resolution) * settings.resolution);
+    }
+}
+
+// ========================================
+// 材质混合图
+// ========================================
+// 层的设置和 Renderer 里一样
+// ========================================
+static std::vector<TerrainSplat::Layer> ShippedSplatLayers()
+{
+    std::vector<TerrainSplat::Layer> layers(3);
+    layers[0].texturePath = TEXTUREDIR"grass.jpg";
+    layers[0].maxHeight = 0.12f;
+    layers[0].maxSlope = 0.15f;
+    layers[0].slopeFade = 0.05f;
+    layers[1].texturePath = TEXTUREDIR"grass11.jpg";
+    layers[1].minHeight = 0.12f;
+    layers[1].maxSlope = 0.15f;
+    layers[1].slopeFade = 0.05f;
+    layers[2].texturePath = TEXTUREDIR"Barren Reds.JPG";
+    layers[2].minSlope = 0.15f;
+    layers[2].slopeFade = 0.05f;
+    return layers;
+}
+
+static void BenchSplat(BenchmarkSuite& suite)
+{
+    if (!suite.IsSelected("splat.generate_heightmap")) {
+        return;
+    }
+    Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+    TerrainSplat splat(ShippedSplatLayers(), TerrainSplat::Settings());
+    suite.Run("splat.generate_heightmap", [&]() { splat.Generate(terrain); },
+              static_cast<double>(terrain.GetWidth()) * terrain.GetHeight());
+}
+
+// ========================================
+// 地形编辑
+// ========================================
+// 一笔的延迟 = 修改高度 + 局部重建顶点、法向量、块误差 + 上传（NullGL 里上传不花时间）。
+// 每次运行后恢复原来的高度并全量重建，下一次从同样的地形开始。
+// 恢复不计时间（一次全量重建比 100 笔小笔刷还慢，计进去就看不出笔刷本身的变化）
+// ========================================
+static const int EDIT_STROKES = 100;
+
+static void BenchEditing(BenchmarkSuite& suite)
+{
+    const char* names[] = { "edit.raise_r2_100", "edit.smooth_r8_100", "edit.rebuild" };
+    bool any = false;
+    for (const char* name : names) {
+        any = any || suite.IsSelected(name);
+    }
+    if (!any) {
+        return;
+    }
+
+    Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+    const std::vector<float> original = terrain.GetHeightData();
+    TerrainEditor editor(terrain);
+
+    auto strokes = [&](TerrainEditor::Brush brush, float radius, float strength) {
+        std::vector<double> samples;
+        for (int run = 0; run <= suite.GetRepeats(); ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < EDIT_STROKES; ++i) {
+                // 一圈螺旋，笔和笔之间部分重叠
+                float angle = i * 0.35f;
+                float distance = 5.0f + i * 0.4f;
+                editor.Apply(brush, cosf(angle) * distance, sinf(angle) * distance, radius, strength);
+                terrain.UpdateDirtyRegions();
+            }
+            double milliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            // 第一次是预热
+            if (run > 0) {
+                samples.push_back(milliseconds);
+            }
+            terrain.GetHeightData() = original;
+            terrain.RebuildMesh();
+        }
+        return samples;
+    };
+
+    if (suite.IsSelected(names[0])) {
+        suite.Record(names[0], strokes(TerrainEditor::Brush::Raise, 2.0f, 0.01f), EDIT_STROKES);
+    }
+    if (suite.IsSelected(names[1])) {
+        suite.Record(names[1], strokes(TerrainEditor::Brush::Smooth, 8.0f, 0.5f), EDIT_STROKES);
+    }
+    suite.Run(names[2], [&]() { terrain.RebuildMesh(); });
+}
+
+// ========================================
+// 网格和动画
+// ========================================
+// 网格文件是文本格式，处理项按文件的行数计（每秒行数、每行的未命中）
+// ========================================
+static double CountLines(const std::string& path)
+{
+    std::ifstream file(path);
+    double lines = 0.0;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines += 1.0;
+    }
+    return lines;
+}
+
+static void BenchMeshes(BenchmarkSuite& suite)
+{
+    const char* meshes[][2] = {
+        { "mesh.load.cube", "Cube.msh" },
+        { "mesh.load.sphere", "Sphere.msh" },
+        { "mesh.load.role_t", "Role_T.msh" }
+    };
+    for (const auto& mesh : meshes) {
+        if (!suite.IsSelected(mesh[0])) {
+            continue;
+        }
+        std::string file = mesh[1];
+        suite.Run(mesh[0], [&]() { delete Mesh::LoadFromMeshFile(file); },
+                  CountLines(MESHDIR + file));
+    }
+
+    suite.Run("animation.load.role_t", []() {
+        MeshAnimation animation("Role_T.anm");
+        g_Sink = static_cast<float>(animation.GetFrameCount());
+    });
+}
+
+// ========================================
+// 作业系统
+// ========================================
+// 两种有代表性的负载按 1 / 2 / 4 个线程扫描（ParallelFor 的 maxThreads，
+// 不会超过作业系统的线程数，见 --workers）：
+//   parallel_for  4096 个均匀的小计算，报告每秒处理项数
+//   mesh_batch    6 种网格文件各 2 份，一次 LoadFromMeshFiles 并行解析，
+//                 大小不一（角色比立方体大得多），报告每秒文件数
+// spawn_wait_10k 单独一项：一万个空作业排队再等待，测的是调度本身的开销
+// ========================================
+static void BenchJobs(BenchmarkSuite& suite)
+{
+    JobSystem& jobs = JobSystem::Get();
+    const std::vector<int> threadCounts = { 1, 2, 4 };
+    std::vector<std::string> forNames;
+    std::vector<std::string> meshNames;
+    for (int threads : threadCounts) {
+        forNames.push_back("jobs.parallel_for_threads_" + std::to_string(threads));
+        meshNames.push_back("jobs.mesh_batch_threads_" + std::to_string(threads));
+    }
+    suite.AddSweep("jobs parallel_for (threads)", threadCounts, forNames);
+    suite.AddSweep("jobs mesh batch (threads)", threadCounts, meshNames);
+
+    const int ITEMS = 4096;
+    std::vector<float> results(ITEMS);
+    for (size_t i = 0; i < threadCounts.size(); ++i) {
+        unsigned int threads = static_cast<unsigned int>(threadCounts[i]);
+        suite.Run(forNames[i], [&]() {
+            jobs.ParallelFor(ITEMS, 16, [&](int item) {
+                float value = static_cast<float>(item);
+                for (int k = 0; k < 256; ++k) {
+                    value = std::sin(value) * 0.5f + 1.0f;
+                }
+                results[item] = value;
+            }, threads);
+            g_Sink = results[ITEMS / 2];
+        }, ITEMS);
+    }
+
+    std::vector<std::string> files;
+    for (int copy = 0; copy < 2; ++copy) {
+        for (const char* file : { "Cube.msh", "Sphere.msh", "Cylinder.msh", "Cone.msh", "Capsule.msh", "Role_T.msh" }) {
+            files.push_back(file);
+        }
+    }
+    for (size_t i = 0; i < threadCounts.size(); ++i) {
+        unsigned int threads = static_cast<unsigned int>(threadCounts[i]);
+        suite.Run(meshNames[i], [&]() {
+            for (Mesh* mesh : Mesh::LoadFromMeshFiles(files, threads)) {
+                delete mesh;
+            }
+        }, static_cast<double>(files.size()));
+    }
+
+    suite.Run("jobs.spawn_wait_10k", [&]() {
+        JobCounter done;
+        for (int i = 0; i < 10000; ++i) {
+            jobs.Run([]() {}, &done);
+        }
+        jobs.Wait(done);
+    }, 10000);
+}
+
+// ========================================
+// 分配器
+// ========================================
+// 三种方式分配同样的 16384 个 64 字节的小对象，再按固定的乱序释放
+// （像场景里的节点一样，生命周期交错）。对象池和临时内存在预热后
+// 不再向系统要内存，测的是稳定状态下的开销
+// ========================================
+static void BenchAllocators(BenchmarkSuite& suite)
+{
+    struct Node
+    {
+        float values[15];
+        int id;
+    };
+    const int COUNT = 16384;
+    std::vector<int> order(COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        order[i] = i;
+    }
+    std::mt19937 rng(42);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<Node*> nodes(COUNT);
+
+    suite.Run("alloc.malloc", [&]() {
+        for (int i = 0; i < COUNT; ++i) {
+            nodes[i] = new Node();
+            nodes[i]->id = i;
+        }
+        for (int i : order) {
+            delete nodes[i];
+        }
+    }, COUNT);
+
+    ObjectPool<Node> pool(1024);
+    suite.Run("alloc.pool", [&]() {
+        for (int i = 0; i < COUNT; ++i) {
+            nodes[i] = pool.Create();
+            nodes[i]->id = i;
+        }
+        for (int i : order) {
+            pool.Destroy(nodes[i]);
+        }
+    }, COUNT);
+
+    LinearArena arena(COUNT * sizeof(Node));
+    suite.Run("alloc.arena", [&]() {
+        for (int i = 0; i < COUNT; ++i) {
+            nodes[i] = arena.Create<Node>();
+            nodes[i]->id = i;
+        }
+        g_Sink = static_cast<float>(nodes[COUNT / 2]->id);
+        arena.Reset();
+    }, COUNT);
+}
+
+// ========================================
+// 日志
+// ========================================
+// 一万条像帧统计那样带整数和小数的 LOG_INFO，测调用线程这一侧的开销
+// （格式化、写进环形缓冲、写满时等写入线程）。输出换成一个什么都不写的流，
+// 每次最后 Flush，下一次从空的缓冲开始
+// ========================================
+static const int LOG_CALLS = 10000;
+
+static void BenchLogging(BenchmarkSuite& suite)
+{
+    std::ostream discard(nullptr);
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_INFO);
+    Log::SetStreams(discard, discard);
+
+    suite.Run("log.call", []() {
+        for (int i = 0; i < LOG_CALLS; ++i) {
+            LOG_INFO("帧 " << i << "：" << 16.7f << " 毫秒，" << 1024 << " 个绘制调用");
+        }
+        Log::Flush();
+    }, LOG_CALLS);
+
+    Log::SetStreams(std::cout, std::cerr);
+    Log::SetLevel(level);
+}
+
+// ========================================
+// 图片解码
+// ========================================
+static void BenchTextures(BenchmarkSuite& suite)
+{
+    const char* textures[][2] = {
+        { "texture.decode.jpg", TEXTUREDIR"grass.jpg" },
+        { "texture.decode.tga", TEXTUREDIR"brick.tga" },
+        { "texture.decode.png", TEXTUREDIR"waterbump.png" }
+    };
+    for (const auto& texture : textures) {
+        std::string path = texture[1];
+        suite.Run(texture[0], [&]() { Texture image(path); });
+    }
+
+    std::vector<std::string> faces = {
+        TEXTUREDIR"skybox/right.jpg", TEXTUREDIR"skybox/left.jpg",
+        TEXTUREDIR"skybox/top.jpg", TEXTUREDIR"skybox/bottom.jpg",
+        TEXTUREDIR"skybox/front.jpg", TEXTUREDIR"skybox/back.jpg"
+    };
+    suite.Run("skybox.load_cubemap", [&]() { Skybox skybox(faces); });
+}
+
+// ========================================
+// 剔除
+// ========================================
+// 水面的设置和 Renderer 里一样：7 层 64×64 的 clipmap，高度图每 32 格一块
+// ========================================
+static void BenchCulling(BenchmarkSuite& suite)
+{
+    if (!suite.IsSelected("culling.tile_classify") && !suite.IsSelected("culling.water_blocks_1k")) {
+        return;
+    }
+    Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+    WaterClipmap water(0.0f, 64, 7, 0.25f);
+    WaterTileMap tiles(terrain, water.GetWaterLevel(), 0.5f, 32);
+    water.SetTileMap(&tiles);
+
+    suite.Run("culling.tile_classify", [&]() { tiles.Classify(terrain); });
+
+    // 相机停在地形上方一个固定位置，只测每帧的区块剔除和合并绘制区间
+    water.Update(Vector3(10.0f, 5.0f, -20.0f));
+    suite.Run("culling.water_blocks_1k", [&]() {
+        for (int i = 0; i < 1000; ++i) {
+            water.Render();
+        }
+        g_Sink = static_cast<float>(water.GetDrawnTriangleCount());
+    });
+}
+
+// ========================================
+// 岸线距离场
+// ========================================
+// 4096×4096 的二维平方距离变换（噪声高度图低于中间值的像素是特征点），
+// 报告每秒像素数。名字沿用请求里的 jfa（跳跃泛洪），
+// 实际是精确的 FH 变换（见 ShorelineDistance.h），两者做的是同一件事
+// ========================================
+static void BenchShoreline(BenchmarkSuite& suite)
+{
+    if (!suite.IsSelected("shore.jfa_4k")) {
+        return;
+    }
+    const int size = 4096;
+    std::vector<float> heights;
+    TerrainNoise(35).Generate(TerrainNoise::Settings(), heights, size, size);
+    std::vector<unsigned char> features(heights.size());
+    for (size_t i = 0; i < heights.size(); ++i) {
+        features[i] = heights[i] < 0.5f ? 1 : 0;
+    }
+    std::vector<float> distances;
+    suite.Run("shore.jfa_4k", [&]() {
+        ShorelineDistance::SquaredDistanceTransform(features, size, size, distances);
+        g_Sink = distances[distances.size() / 2];
+    }, static_cast<double>(size) * size);
+}
+
+// ========================================
+// FFT 海浪
+// ========================================
+// 每帧一次 Update（推进频谱、4 次二维逆 FFT、生成位移和法线+泡沫网格），
+// 三种分辨率各按 1 / 2 / 4 个线程扫描，报告每秒网格点数
+// ========================================
+static void BenchOcean(BenchmarkSuite& suite)
+{
+    const std::vector<int> threadCounts = { 1, 2, 4 };
+    for (int resolution : { 128, 256, 512 }) {
+        std::vector<std::string> names;
+        for (int threads : threadCounts) {
+            names.push_back("ocean.fft_" + std::to_string(resolution) + "_threads_" + std::to_string(threads));
+        }
+        suite.AddSweep("ocean " + std::to_string(resolution) + " (threads)", threadCounts, names);
+
+        OceanFFT::Settings settings;
+        settings.resolution = resolution;
+        for (size_t i = 0; i < threadCounts.size(); ++i) {
+            if (!suite.IsSelected(names[i])) {
+                continue;
+            }
+            OceanFFT ocean(settings, threadCounts[i]);
+            float time = 0.0f;
+            suite.Run(names[i], [&]() {
+                time += 1.0f / 60.0f;
+                ocean.Update(time);
+                g_Sink = ocean.GetDisplacement()[1];
+            }, static_cast<double>(resolution) * resolution);
+        }
+    }
+}
+
+// ========================================
+// 水面高度查询
+// ========================================
+// 256×256 分辨率的海面（Renderer 的设置），一次批量查询 WATER_QUERY_POINTS 个散点，
+// 默认 3 次反解水平位移，报告每秒查询点数
+// ========================================
+static const int WATER_QUERY_POINTS = 65536;
+
+static void BenchWaterQuery(BenchmarkSuite& suite)
+{
+    if (!suite.IsSelected("waterquery.batch")) {
+        return;
+    }
+    OceanFFT ocean(OceanFFT::Settings(), 1);
+    ocean.Update(1.0f);
+    ocean.Update(1.0f + 1.0f / 60.0f);
+    WaterQuery query(ocean, 0.0f);
+
+    std::vector<float> x(WATER_QUERY_POINTS), z(WATER_QUERY_POINTS);
+    for (int i = 0; i < WATER_QUERY_POINTS; ++i) {
+        x[i] = (i % 256) * 1.7f - 200.0f + (i % 13) * 0.05f;
+        z[i] = (i / 256) * 1.3f - 150.0f;
+    }
+    std::vector<WaterQuery::Sample> samples(WATER_QUERY_POINTS);
+    suite.Run("waterquery.batch", [&]() {
+        query.Query(x.data(), z.data(), WATER_QUERY_POINTS, samples.data());
+        g_Sink = samples[WATER_QUERY_POINTS / 2].height;
+    }, WATER_QUERY_POINTS);
+}
+
+// ========================================
+// 水面 clipmap 的精度和开销
+// ========================================
+// 覆盖范围固定为 1024（7 层），每层的格子数从 32 到 128：格子越多，
+// 最内层的格子越小（0.5 / 0.25 / 0.125），水面越细，顶点也越多。
+// 相机沿直线飞 WATER_FRAMES 帧，每帧 Update（原点移动的层重建并上传）和 Render（区块剔除），
+// 报告每秒帧数；扫描的规模是顶点数，指数 1 表示开销和顶点数成正比
+// ========================================
+static const int WATER_FRAMES = 256;
+
+static void BenchWater(BenchmarkSuite& suite)
+{
+    const std::vector<int> gridSizes = { 32, 64, 128 };
+    std::vector<int> vertexCounts;
+    std::vector<std::string> names;
+    for (int gridSize : gridSizes) {
+        std::string name = "water.clipmap_grid_" + std::to_string(gridSize);
+        names.push_back(name);
+
+        WaterClipmap water(0.0f, gridSize, 7, 16.0f / gridSize);
+        vertexCounts.push_back(water.GetVertexCount());
+        if (!suite.IsSelected(name)) {
+            continue;
+        }
+        suite.Run(name, [&]() {
+            for (int frame = 0; frame < WATER_FRAMES; ++frame) {
+                water.Update(Vector3(frame * 0.6f, 5.0f, frame * -0.35f));
+                water.Render();
+            }
+            g_Sink = static_cast<float>(water.GetDrawnTriangleCount());
+        }, WATER_FRAMES);
+    }
+    suite.AddSweep("water clipmap (vertices)", vertexCounts, names);
+}
+
+// ========================================
+// 浅水模拟
+// ========================================
+// 一块 1025×1025 的平台（高出海面），中间一个碗形的坑，坑中心倒进一大团水：
+// 水冲下坑壁、来回晃动、慢慢平静，平静的块进入休眠。
+// 计时 SHALLOW_STEPS 步（30 Hz，5 秒），不含构造和加水；
+// 报告每秒处理的块数（每步醒着的块和它们的邻居，见 GetLastProcessedTileCount）
+// ========================================
+static const int SHALLOW_STEPS = 150;
+
+static void BenchShallowWater(BenchmarkSuite& suite)
+{
+    if (!suite.IsSelected("shallowwater.flooded_pit")) {
+        return;
+    }
+    Terrain terrain(TerrainNoise(36), TerrainNoise::Settings(), 1025, 100.0f, 10.0f);
+    std::vector<float>& heights = terrain.GetHeightData();
+    for (int z = 0; z < 1025; ++z) {
+        for (int x = 0; x < 1025; ++x) {
+            float dx = (x - 512) / 360.0f;
+            float dz = (z - 512) / 360.0f;
+            float r2 = std::min(1.0f, dx * dx + dz * dz);
+            heights[z * 1025 + x] = 0.1f + 0.3f * r2;
+        }
+    }
+
+    ShallowWater::Settings settings;
+    std::vector<double> samples;
+    long long tiles = 0;
+    for (int run = 0; run <= suite.GetRepeats(); ++run) {
+        ShallowWater water(terrain, settings);
+        water.AddWater(0.0f, 0.0f, 12.0f, 2.0f);
+        tiles = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < SHALLOW_STEPS; ++step) {
+            water.Step();
+            tiles += water.GetLastProcessedTileCount();
+        }
+        double milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        // 第一次是预热
+        if (run > 0) {
+            samples.push_back(milliseconds);
+        }
+    }
+    // 步进是确定性的，每次处理的块数相同
+    suite.Record("shallowwater.flooded_pit", samples, static_cast<double>(tiles));
+}
+
+// ========================================
+// 帧流水线
+// ========================================
+// 同一份合成负载分别用串行和流水线模式跑，流水线模式下下一帧的更新
+// 和这一帧的渲染重叠：至少能填进渲染里的等待，多核时还能和渲染的计算并行
+// ========================================
+static void BenchPipeline(BenchmarkSuite& suite)
+{
+    const int FRAMES = 60;
+    SyntheticFrame::Settings settings;
+    settings.updateWork = 100000;
+    settings.renderWork = 50000;
+    settings.renderWaitMs = 2.0f;
+    for (bool pipelined : { false, true }) {
+        SyntheticFrame frame(settings);
+        FramePipeline pipeline(frame, pipelined);
+        suite.Run(pipelined ? "pipeline.pipelined" : "pipeline.serial", [&]() {
+            for (int i = 0; i < FRAMES; ++i) {
+                pipeline.RunFrame(1000.0f / 60.0f);
+            }
+            g_Sink = frame.GetResult();
+        }, FRAMES);
+    }
+}
+
+// ========================================
+// 规模扫描
+// ========================================
+// 用 StressScene 每次只改一个参数，其余为 0（或很小），看时间怎么随规模增长。
+// 构建类的项读 StressScene 里对应步骤的 ProfileScope；
+// 每帧类的项计时 UPDATE_FRAMES 次 Update（单次太短，计时器分辨率不够）
+// ========================================
+static const int UPDATE_FRAMES = 100;
+
+static StressScene::Settings EmptyScene()
+{
+    StressScene::Settings settings;
+    settings.heightmapSize = 0;
+    settings.meshInstances = 0;
+    settings.characters = 0;
+    settings.lights = 0;
+    settings.textures = 0;
+    return settings;
+}
+
+static void RunUpdates(StressScene& scene)
+{
+    for (int frame = 0; frame < UPDATE_FRAMES; ++frame) {
+        scene.Update(frame / 60.0f);
+    }
+}
+
+static void SweepBuild(BenchmarkSuite& suite, const std::string& label, const std::string& prefix,
+                       const char* scope, const std::vector<int>& sizes,
+                       const std::function<void(StressScene::Settings&, int)>& apply)
+{
+    std::vector<std::string> names;
+    for (int size : sizes) {
+        std::string name = prefix + std::to_string(size);
+        names.push_back(name);
+
+        StressScene::Settings settings = EmptyScene();
+        apply(settings, size);
+        RecordScopes(suite, { std::make_pair(name, std::string(scope)) },
+                     [&]() { StressScene scene(settings); });
+    }
+    suite.AddSweep(label, sizes, names);
+}
+
+static void SweepUpdate(BenchmarkSuite& suite, const std::string& label, const std::string& prefix,
+                        const StressScene::Settings& base, const std::vector<int>& sizes,
+                        const std::function<void(StressScene::Settings&, int)>& apply)
+{
+    std::vector<std::string> names;
+    for (int size : sizes) {
+        std::string name = prefix + std::to_string(size);
+        names.push_back(name);
+        if (!suite.IsSelected(name)) {
+            continue;
+        }
+
+        StressScene::Settings settings = base;
+        apply(settings, size);
+        StressScene scene(settings);
+        suite.Run(name, [&]() { RunUpdates(scene); });
+    }
+    suite.AddSweep(label, sizes, names);
+}
+
+static void BenchScaling(BenchmarkSuite& suite)
+{
+    // 规模是边长，顶点数是它的平方：指数 2 才是按顶点线性
+    SweepBuild(suite, "terrain build (side)", "scaling.terrain_", "StressScene::BuildTerrain", { 129, 257, 513 },
+               [](StressScene::Settings& s, int size) { s.heightmapSize = size; });
+    // 纹理轮流用 8 张图片，取 8 的倍数，每种格式的比例不变
+    SweepBuild(suite, "texture load", "scaling.textures_", "StressScene::LoadTextures", { 8, 16, 32 },
+               [](StressScene::Settings& s, int size) { s.textures = size; });
+
+    StressScene::Settings base = EmptyScene();
+    base.heightmapSize = 129;
+    base.lights = 32;
+    SweepUpdate(suite, "light assign (meshes)", "scaling.update_meshes_", base, { 1000, 4000, 16000 },
+                [](StressScene::Settings& s, int size) { s.meshInstances = size; });
+    base.meshInstances = 2000;
+    SweepUpdate(suite, "light assign (lights)", "scaling.update_lights_", base, { 8, 32, 128 },
+                [](StressScene::Settings& s, int size) { s.lights = size; });
+
+    base = EmptyScene();
+    base.heightmapSize = 129;
+    SweepUpdate(suite, "skinning (characters)", "scaling.update_characters_", base, { 4, 16, 64 },
+                [](StressScene::Settings& s, int size) { s.characters = size; });
+}
+
+// ========================================
+// 启动：载入自带场景
+// ========================================
+// 步骤和参数与 Renderer 构造函数里的一样（不含着色器和水面，它们不经过缓存）
+// ========================================
+static void LoadShippedScene()
+{
+    Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+
+    TerrainBake bake{ TerrainBake::Settings() };
+    bake.LoadOrBake(terrain);
+    bake.UploadTextures();
+
+    TerrainSplat splat(ShippedSplatLayers(), TerrainSplat::Settings());
+    splat.Generate(terrain);
+    splat.UploadSplatMap();
+    splat.LoadLayerTextures();
+
+    Texture texture(TEXTUREDIR"grass.jpg", true);
+
+    std::vector<std::string> faces = {
+        TEXTUREDIR"skybox/right.jpg", TEXTUREDIR"skybox/left.jpg",
+        TEXTUREDIR"skybox/top.jpg", TEXTUREDIR"skybox/bottom.jpg",
+        TEXTUREDIR"skybox/front.jpg", TEXTUREDIR"skybox/back.jpg"
+    };
+    Skybox skybox(faces);
+}
+
+static void BenchStartup(BenchmarkSuite& suite)
+{
+    if (!suite.IsSelected("startup.cold") && !suite.IsSelected("startup.warm")) {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "csc8502_benchmark_cache";
+    DerivedDataCache::Settings settings;
+    settings.directory = directory.string();
+    DerivedDataCache& cache = DerivedDataCache::Get();
+    if (error || !cache.Open(settings)) {
+        LOG_ERROR("错误：无法打开临时的派生数据缓存，跳过 startup.*");
+        return;
+    }
+
+    // 清空缓存不算在时间里
+    if (suite.IsSelected("startup.cold")) {
+        LoadShippedScene();
+        std::vector<double> samples;
+        for (int i = 0; i < suite.GetRepeats(); ++i) {
+            cache.Clear();
+            auto start = std::chrono::steady_clock::now();
+            LoadShippedScene();
+            samples.push_back(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        suite.Record("startup.cold", samples);
+    }
+    suite.Run("startup.warm", LoadShippedScene);
+
+    cache.Close();
+    std::filesystem::remove_all(directory, error);
+}
+
+// ========================================
+// --scene 指定的场景
+// ========================================
+static void BenchCustomScene(BenchmarkSuite& suite, const StressScene::Settings& settings)
+{
+    suite.Run("scene.build", [&]() { StressScene scene(settings); });
+    if (suite.IsSelected("scene.update_100")) {
+        StressScene scene(settings);
+        suite.Run("scene.update_100", [&]() { RunUpdates(scene); });
+    }
+}
+
+int main(int argc, char** argv)
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    BenchmarkOptions options;
+    if (!ParseArguments(argc, argv, options)) {
+        return 2;
+    }
+    // 基线文件相对于启动时的目录，先读进来再切换到数据目录
+    std::vector<BenchmarkResult> baseline;
+    if (!options.comparePath.empty() && !BenchmarkSuite::LoadJson(options.comparePath, baseline)) {
+        return 2;
+    }
+    if (!options.writePath.empty()) {
+        options.writePath = std::filesystem::absolute(options.writePath).string();
+    }
+    FlythroughOptions& flythrough = options.flythroughOptions;
+    if (!flythrough.pathFile.empty()) {
+        flythrough.pathFile = std::filesystem::absolute(flythrough.pathFile).string();
+    }
+    if (!flythrough.csvFile.empty()) {
+        flythrough.csvFile = std::filesystem::absolute(flythrough.csvFile).string();
+    }
+    if (!options.dataDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::current_path(options.dataDirectory, error);
+        if (error) {
+            LOG_ERROR("错误：无法进入数据目录 " << options.dataDirectory << "（" << error.message() << "）");
+            return 2;
+        }
+    }
+
+    if (options.governor) {
+        int failures = RunGovernorSimulation(std::cout);
+        std::cout.flush();
+        Log::Shutdown();
+        return failures > 0 ? 1 : 0;
+    }
+
+    InstallNullGL();
+    JobSystem::SetDefaultWorkerCount(options.workers);
+    if (options.flythrough) {
+        LOG_INFO("作业系统：" << JobSystem::Get().GetWorkerCount() << " 个工作线程 + 主线程");
+        int result = RunFlythrough(flythrough);
+        Log::Shutdown();
+        return result;
+    }
+
+    // 作业系统的线程要在打开计数器之前创建，地形构建的阶段时间才包括它们
+    LOG_INFO("作业系统：" << JobSystem::Get().GetWorkerCount() << " 个工作线程 + 主线程");
+    HardwareCounters::Enable();
+    LOG_INFO("基准测试：每项 " << options.repeats << " 次...");
+    Log::Flush();
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_WARNING);
+
+    BenchmarkSuite suite(options.repeats, options.filter);
+    BenchMatrix(suite);
+    BenchNoise(suite);
+    BenchErosion(suite);
+    BenchTerrain(suite);
+    BenchBake(suite);
+    BenchSplat(suite);
+    BenchEditing(suite);
+    BenchMeshes(suite);
+    BenchJobs(suite);
+    BenchAllocators(suite);
+    BenchLogging(suite);
+    BenchTextures(suite);
+    BenchCulling(suite);
+    BenchShoreline(suite);
+    BenchOcean(suite);
+    BenchWaterQuery(suite);
+    BenchWater(suite);
+    BenchShallowWater(suite);
+    BenchPipeline(suite);
+    BenchScaling(suite);
+    BenchStartup(suite);
+    if (options.customScene) {
+        BenchCustomScene(suite, options.scene);
+    }
+
+    Log::SetLevel(level);
+    HardwareCounters::Disable();
+    Log::Flush();
+
+    int result = 0;
+    if (suite.GetResults().empty()) {
+        LOG_ERROR("错误：没有运行任何测试项（--filter " << options.filter << "）");
+        result = 2;
+    } else if (!baseline.empty()) {
+        int regressions = suite.Compare(baseline, options.thresholdPercent, options.floorMs, std::cout);
+        suite.PrintCounters(std::cout);
+        suite.PrintScaling(std::cout);
+        std::cout.flush();
+        if (regressions > 0) {
+            LOG_ERROR("错误：" << regressions << " 项比基线慢 " << options.thresholdPercent << "% 以上");
+            result = 1;
+        } else {
+            LOG_INFO("✓ 没有退化（阈值 " << options.thresholdPercent << "%）");
+        }
+    } else {
+        suite.Print(std::cout);
+        suite.PrintScaling(std::cout);
+        std::cout.flush();
+    }
+
+    if (!options.writePath.empty() && !suite.WriteJson(options.writePath) && result == 0) {
+        result = 2;
+    }
+    Log::Shutdown();
+    return result;
+}
@@ -0,0 +1,354 @@
+#include "BenchmarkSuite.h"
+#include "nclgl/Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+BenchmarkSuite::BenchmarkSuite(int repeats, const std::string& filter)
+    : m_Repeats(std::max(1, repeats))
+    , m_Filter(filter)
+{
+}
+
+bool BenchmarkSuite::IsSelected(const std::string& name) const
+{
+    return m_Filter.empty() || name.find(m_Filter) != std::string::npos;
+}
+
+namespace {
+    // 放大估算的计数偶尔会比前一次读数小一点
+    unsigned long long Increase(unsigned long long from, unsigned long long to)
+    {
+        return to > from ? to - from : 0;
+    }
+}
+
+void BenchmarkSuite::AddCounts(HardwareSample& totals, const HardwareSample& before, const HardwareSample& after)
+{
+    totals.milliseconds += after.milliseconds - before.milliseconds;
+    totals.cycles += Increase(before.cycles, after.cycles);
+    totals.instructions += Increase(before.instructions, after.instructions);
+    totals.cacheMisses += Increase(before.cacheMisses, after.cacheMisses);
+    totals.branchMisses += Increase(before.branchMisses, after.branchMisses);
+}
+
+void BenchmarkSuite::Run(const std::string& name, const std::function<void()>& body, double items)
+{
+    if (!IsSelected(name)) {
+        return;
+    }
+    body();
+
+    // 读计数器在计时之外，读取本身不算进时间
+    bool counting = HardwareCounters::HasCounters();
+    HardwareSample counters = {};
+    std::vector<double> samples;
+    samples.reserve(m_Repeats);
+    for (int i = 0; i < m_Repeats; ++i) {
+        HardwareSample before, after;
+        if (counting) {
+            HardwareCounters::Read(before);
+        }
+        auto start = std::chrono::steady_clock::now();
+        body();
+        samples.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count());
+        if (counting) {
+            HardwareCounters::Read(after);
+            AddCounts(counters, before, after);
+        }
+    }
+    Record(name, samples, items, counting ? &counters : nullptr);
+}
+
+void BenchmarkSuite::Record(const std::string& name, std::vector<double> samples, double items,
+                            const HardwareSample* counters)
+{
+    if (!IsSelected(name) || samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t half = samples.size() / 2;
+
+    BenchmarkResult result;
+    result.name = name;
+    result.median = samples.size() % 2 ? samples[half] : (samples[half - 1] + samples[half]) * 0.5;
+    result.minimum = samples.front();
+    result.items = items;
+    if (counters) {
+        result.counted = true;
+        result.runs = static_cast<int>(samples.size());
+        result.counters = *counters;
+    }
+    m_Results.push_back(result);
+}
+
+void BenchmarkSuite::AddSweep(const std::string& label, const std::vector<int>& sizes,
+                              const std::vector<std::string>& names)
+{
+    Sweep sweep;
+    sweep.label = label;
+    sweep.sizes = sizes;
+    sweep.names = names;
+    m_Sweeps.push_back(sweep);
+}
+
+const BenchmarkResult* BenchmarkSuite::Find(const std::string& name) const
+{
+    for (const BenchmarkResult& r : m_Results) {
+        if (r.name == name) {
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+void BenchmarkSuite::PrintScaling(std::ostream& out) const
+{
+    std::ios::fmtflags flags = out.flags();
+    bool header = false;
+    for (const Sweep& sweep : m_Sweeps) {
+        // 只算这次运行了的规模（--filter 可能排除了一部分）
+        std::vector<int> sizes;
+        std::vector<double> times;
+        for (size_t i = 0; i < sweep.sizes.size(); ++i) {
+            const BenchmarkResult* r = Find(sweep.names[i]);
+            if (r) {
+                sizes.push_back(sweep.sizes[i]);
+                times.push_back(r->minimum);
+            }
+        }
+        if (sizes.empty()) {
+            continue;
+        }
+        if (!header) {
+            out << "\nscaling (min ms at each size, growth exponent: 1 = linear)\n";
+            header = true;
+        }
+
+        out << "  " << std::left << std::setw(24) << sweep.label << std::right << std::fixed;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            out << std::setw(8) << sizes[i] << ": " << std::setprecision(3) << std::setw(9) << times[i];
+        }
+        if (sizes.size() > 1 && times.front() > 0.0 && sizes.back() > sizes.front()) {
+            double exponent = std::log(times.back() / times.front()) /
+                              std::log(static_cast<double>(sizes.back()) / sizes.front());
+            out << "   exponent " << std::setprecision(2) << exponent;
+        }
+        out << "\n";
+    }
+    out.flags(flags);
+}
+
+namespace {
+    const char* COUNTER_HEADER = "    IPC  cache miss/item  branch miss/item";
+
+    // IPC 和每项的两种未命中；没有计数器是 n/a，有计数器但这一项没法算（事件不支持、
+    // 没有 items）是 -
+    void PrintCounterColumns(std::ostream& out, const BenchmarkResult& r)
+    {
+        if (!r.counted) {
+            out << std::setw(7) << "n/a" << std::setw(17) << "n/a" << std::setw(18) << "n/a";
+            return;
+        }
+        if (r.counters.cycles > 0 && r.counters.instructions > 0) {
+            out << std::fixed << std::setprecision(2) << std::setw(7) << r.GetIpc();
+        } else {
+            out << std::setw(7) << "-";
+        }
+        const unsigned long long misses[2] = { r.counters.cacheMisses, r.counters.branchMisses };
+        const int widths[2] = { 17, 18 };
+        for (int i = 0; i < 2; ++i) {
+            if (r.counters.cycles > 0 && r.items > 0.0) {
+                out << std::fixed << std::setprecision(4) << std::setw(widths[i]) << r.GetPerItem(misses[i]);
+            } else {
+                out << std::setw(widths[i]) << "-";
+            }
+        }
+    }
+}
+
+void BenchmarkSuite::Print(std::ostream& out) const
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(36) << "benchmark"
+        << std::right << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+        << std::setw(14) << "per second" << COUNTER_HEADER << "\n";
+    for (const BenchmarkResult& r : m_Results) {
+        out << std::left << std::setw(36) << r.name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << r.median << std::setw(12) << r.minimum;
+        if (r.items > 0.0) {
+            out << std::setw(14) << std::setprecision(4) << std::scientific << r.GetItemsPerSecond();
+        } else {
+            out << std::setw(14) << "-";
+        }
+        PrintCounterColumns(out, r);
+        out << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void BenchmarkSuite::PrintCounters(std::ostream& out) const
+{
+    bool any = false;
+    for (const BenchmarkResult& r : m_Results) {
+        any = any || r.counted;
+    }
+    if (!any) {
+        return;
+    }
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << "\nhardware counters\n" << std::left << std::setw(36) << "benchmark" << std::right
+        << COUNTER_HEADER << "\n";
+    for (const BenchmarkResult& r : m_Results) {
+        out << std::left << std::setw(36) << r.name << std::right;
+        PrintCounterColumns(out, r);
+        out << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool BenchmarkSuite::WriteJson(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("错误：无法写入基线文件 " << path);
+        return false;
+    }
+    char line[256];
+    file << "{\n  \"repeats\": " << m_Repeats << ",\n  \"metrics\": [";
+    for (size_t i = 0; i < m_Results.size(); ++i) {
+        const BenchmarkResult& r = m_Results[i];
+        // 名字只用字母、数字、点和下划线，不需要转义
+        if (r.items > 0.0) {
+            snprintf(line, sizeof(line),
+                     "{\"name\": \"%s\", \"median_ms\": %.4f, \"min_ms\": %.4f, \"per_second\": %.4g}",
+                     r.name.c_str(), r.median, r.minimum, r.GetItemsPerSecond());
+        } else {
+            snprintf(line, sizeof(line), "{\"name\": \"%s\", \"median_ms\": %.4f, \"min_ms\": %.4f}",
+                     r.name.c_str(), r.median, r.minimum);
+        }
+        file << (i ? ",\n    " : "\n    ") << line;
+    }
+    file << "\n  ]\n}\n";
+
+    if (!file.good()) {
+        LOG_ERROR("错误：写入基线文件 " << path << " 失败");
+        return false;
+    }
+    LOG_INFO("✓ 基线已写入 " << path << "（" << m_Results.size() << " 项）");
+    return true;
+}
+
+namespace {
+    // 在 text 的 from 之后找 "key": 并读出后面的数字
+    bool ReadNumber(const std::string& text, size_t from, const char* key, double& value)
+    {
+        size_t at = text.find(key, from);
+        if (at == std::string::npos) {
+            return false;
+        }
+        at = text.find(':', at + strlen(key));
+        if (at == std::string::npos) {
+            return false;
+        }
+        const char* start = text.c_str() + at + 1;
+        char* end = nullptr;
+        value = strtod(start, &end);
+        return end != start;
+    }
+}
+
+bool BenchmarkSuite::LoadJson(const std::string& path, std::vector<BenchmarkResult>& results)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("错误：无法打开基线文件 " << path);
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    results.clear();
+    const char* nameKey = "\"name\": \"";
+    size_t at = text.find(nameKey);
+    while (at != std::string::npos) {
+        size_t start = at + strlen(nameKey);
+        size_t end = text.find('"', start);
+        size_t next = text.find(nameKey, start);
+
+        BenchmarkResult r;
+        if (end == std::string::npos ||
+            !ReadNumber(text, end, "\"median_ms\"", r.median) ||
+            !ReadNumber(text, end, "\"min_ms\"", r.minimum)) {
+            LOG_ERROR("错误：基线文件 " << path << " 格式不对");
+            return false;
+        }
+        r.name = text.substr(start, end - start);
+        results.push_back(r);
+        at = next;
+    }
+    if (results.empty()) {
+        LOG_ERROR("错误：基线文件 " << path << " 里没有任何测试项");
+        return false;
+    }
+    return true;
+}
+
+int BenchmarkSuite::Compare(const std::vector<BenchmarkResult>& baseline, double thresholdPercent,
+                            double floorMs, std::ostream& out) const
+{
+    std::ios::fmtflags flags = out.flags();
+    out << std::left << std::setw(36) << "benchmark"
+        << std::right << std::setw(12) << "baseline ms" << std::setw(12) << "now ms"
+        << std::setw(10) << "change" << "  status\n";
+    out << std::fixed;
+
+    int regressions = 0;
+    for (const BenchmarkResult& r : m_Results) {
+        const BenchmarkResult* base = nullptr;
+        for (const BenchmarkResult& b : baseline) {
+            if (b.name == r.name) {
+                base = &b;
+                break;
+            }
+        }
+
+        out << std::left << std::setw(36) << r.name << std::right << std::setprecision(3);
+        if (!base) {
+            out << std::setw(12) << "-" << std::setw(12) << r.minimum << std::setw(10) << "-" << "  new\n";
+            continue;
+        }
+        double change = base->minimum > 0.0 ? (r.minimum / base->minimum - 1.0) * 100.0 : 0.0;
+        bool regressed = change > thresholdPercent && r.minimum - base->minimum > floorMs;
+        regressions += regressed ? 1 : 0;
+
+        out << std::setw(12) << base->minimum << std::setw(12) << r.minimum
+            << std::setprecision(1) << std::setw(9) << std::showpos << change << std::noshowpos << "%"
+            << (regressed ? "  REGRESSED" : change < -thresholdPercent ? "  faster" : "  ok") << "\n";
+    }
+
+    for (const BenchmarkResult& b : baseline) {
+        bool ran = false;
+        for (const BenchmarkResult& r : m_Results) {
+            ran = ran || r.name == b.name;
+        }
+        if (!ran && IsSelected(b.name)) {
+            out << std::left << std::setw(36) << b.name << "  (in baseline, not run)\n";
+        }
+    }
+    out.flags(flags);
+    return regressions;
+}
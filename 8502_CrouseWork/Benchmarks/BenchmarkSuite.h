@@ -0,0 +1,139 @@
+#pragma once
+#include "nclgl/HardwareCounters.h"
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// ========================================
+// 基准测试结果
+// ========================================
+// 每项记录多次运行的中位数和最小值，单位毫秒。
+// items 是每次运行处理的数量（采样点、迭代、查询点……），不为 0 时
+// 另外按最小值报告每秒处理多少个。
+// 打开了硬件计数器（HardwareCounters::Enable 成功）时，还记下所有计时运行
+// 加起来的周期、指令、缓存和分支未命中，报告 IPC 和每个处理项的未命中数；
+// 没有计数器时 counted 为 false，表里显示 n/a
+// ========================================
+struct BenchmarkResult
+{
+    std::string name;
+    double median;
+    double minimum;
+    double items = 0.0;
+
+    bool counted = false;
+    int runs = 0;                       // counters 是几次运行的总和
+    HardwareSample counters = {};
+
+    double GetItemsPerSecond() const { return minimum > 0.0 ? items * 1000.0 / minimum : 0.0; }
+    double GetIpc() const { return counters.cycles ? (double)counters.instructions / counters.cycles : 0.0; }
+    // 平均每个处理项的事件数（没有 items 时为 0）
+    double GetPerItem(unsigned long long events) const
+    {
+        return items > 0.0 && runs > 0 ? events / (items * runs) : 0.0;
+    }
+};
+
+/**
+ * @class BenchmarkSuite
+ * @brief 收集各项基准测试的时间，写出 / 读入 JSON 基线，并和基线比较
+ *
+ * 每项先不计时地跑一次（预热：文件缓存、分配器、作业系统的线程），
+ * 再跑 repeats 次。和基线比较用的是最小值：被别的进程打断只会让某次变慢，
+ * 不会变快，所以最快的一次最接近代码本身的速度；中位数一起记下来，
+ * 两者差得多说明这台机器当时很忙，结果不可信。
+ *
+ * 基线文件格式（WriteJson 写出，LoadJson 只读这个格式）：
+ *   {
+ *     "repeats": 7,
+ *     "metrics": [
+ *       {"name": "matrix4.multiply", "median_ms": 1.234, "min_ms": 1.201},
+ *       {"name": "noise.fbm_4k", "median_ms": 812.3, "min_ms": 801.9, "per_second": 2.09e+07},
+ *       ...
+ *     ]
+ *   }
+ * 每项占一行，方便在版本控制里看差异。per_second 只是给人看的，
+ * 比较仍然用时间（同样的工作量，两者等价）。
+ */
+class BenchmarkSuite
+{
+public:
+    /**
+     * @param repeats 每项计时的次数
+     * @param filter 只运行名字里包含这段文字的项（空字符串表示全部）
+     */
+    BenchmarkSuite(int repeats, const std::string& filter);
+
+    int GetRepeats() const { return m_Repeats; }
+
+    // 这一项是否要运行（被 filter 排除的项 Run / Record 都会跳过）
+    bool IsSelected(const std::string& name) const;
+
+    /**
+     * @brief 预热一次后计时 repeats 次，记录中位数
+     * @param items 每次运行处理的数量，用来报告吞吐量（0 表示不报告）
+     */
+    void Run(const std::string& name, const std::function<void()>& body, double items = 0.0);
+
+    /**
+     * @brief 记录在别处测出的时间（如 ProfileScope 里某个阶段的时间），每次运行一个样本
+     * @param counters 这些运行加起来的硬件计数（没有计数器时传 nullptr）
+     */
+    void Record(const std::string& name, std::vector<double> samples, double items = 0.0,
+                const HardwareSample* counters = nullptr);
+
+    const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+    /**
+     * @brief 登记一组随规模变化的项（names[i] 是规模 sizes[i] 时的项），供 PrintScaling 使用
+     */
+    void AddSweep(const std::string& label, const std::vector<int>& sizes,
+                  const std::vector<std::string>& names);
+
+    // 每项一行：中位数、最小值、每秒处理数、IPC、每项的缓存 / 分支未命中
+    void Print(std::ostream& out) const;
+
+    // 只有硬件计数那几列（和基线比较时 Compare 的表里没有它们）；没有一项有计数时不输出
+    void PrintCounters(std::ostream& out) const;
+
+    /**
+     * @brief 每组规模扫描一行：各规模的时间，和时间随规模增长的指数
+     *
+     * 指数 = log(最大规模的时间 / 最小规模的时间) / log(最大规模 / 最小规模)，
+     * 1 是线性，2 是平方；小于 1 说明固定开销占了大头。用最小值计算。
+     */
+    void PrintScaling(std::ostream& out) const;
+
+    bool WriteJson(const std::string& path) const;
+    static bool LoadJson(const std::string& path, std::vector<BenchmarkResult>& results);
+
+    // 把 before 到 after 的计数增量（不会是负数）加到 totals 上
+    static void AddCounts(HardwareSample& totals, const HardwareSample& before, const HardwareSample& after);
+
+    /**
+     * @brief 和基线比较（最小值），输出每项的变化
+     * @param thresholdPercent 比基线慢超过这个百分比算退化
+     * @param floorMs 绝对差小于这个值的不算退化（很短的项噪声比例大）
+     * @return 退化的项数
+     *
+     * 基线里没有的项标为新增，这次没运行的基线项只提示，都不算失败。
+     */
+    int Compare(const std::vector<BenchmarkResult>& baseline, double thresholdPercent,
+                double floorMs, std::ostream& out) const;
+
+private:
+    int m_Repeats;
+    std::string m_Filter;
+    std::vector<BenchmarkResult> m_Results;
+
+    struct Sweep
+    {
+        std::string label;
+        std::vector<int> sizes;
+        std::vector<std::string> names;
+    };
+    std::vector<Sweep> m_Sweeps;
+
+    const BenchmarkResult* Find(const std::string& name) const;
+};
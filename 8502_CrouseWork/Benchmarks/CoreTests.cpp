@@ -0,0 +1,891 @@
+#include "BenchmarkSuite.h"
+#include "HeapCounter.h"
+#include "NullGL.h"
+#include "SimulationClock.h"
+#include "StressScene.h"
+#include "Terrain.h"
+#include "Tests.h"
+#include "Texture.h"
+#include "nclgl/HardwareCounters.h"
+#include "nclgl/JobSystem.h"
+#include "nclgl/LinearArena.h"
+#include "nclgl/Log.h"
+#include "nclgl/MemoryTracker.h"
+#include "nclgl/Mesh.h"
+#include "nclgl/PerfCounters.h"
+#include "nclgl/PoolAllocator.h"
+#include "nclgl/common.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ========================================
+// 作业系统压力测试
+// ========================================
+// 每项测试分别用 0 / 1 / 3 / 7 个工作线程的独立作业系统跑一遍
+// （单核机器上线程数比核多，抢占更频繁，反而更容易暴露竞争）。
+// 作业里不调用 TEST_CHECK（测试套件不是线程安全的），
+// 结果先记在原子变量里，回到主线程再检查
+// ========================================
+static const int STRESS_WORKERS[] = { 0, 1, 3, 7 };
+static std::atomic<float> g_JobSink;
+
+// 一点计算量，让作业之间真的有重叠
+static float BusyWork(int iterations, float seed)
+{
+    float value = seed;
+    for (int i = 0; i < iterations; ++i) {
+        value = std::sin(value) * 0.5f + 1.0f;
+    }
+    return value;
+}
+
+static void TestJobStress(TestSuite& suite)
+{
+    // 依赖：40 层、每层 60 个作业，每层依赖上一层的计数器，
+    // 每 10 个里有一个指定在主线程执行。作业开始时上一层必须已经全部完成
+    suite.Run("jobs.stress.dependencies", [&]() {
+        const int LAYERS = 40;
+        const int JOBS_PER_LAYER = 60;
+        for (int workers : STRESS_WORKERS) {
+            JobSystem jobs(workers);
+            std::thread::id mainThread = std::this_thread::get_id();
+            std::vector<JobCounter> counters(LAYERS);
+            std::unique_ptr<std::atomic<int>[]> finished(new std::atomic<int>[LAYERS]);
+            for (int layer = 0; layer < LAYERS; ++layer) {
+                finished[layer] = 0;
+            }
+            std::atomic<int> orderErrors(0);
+            std::atomic<int> affinityErrors(0);
+
+            for (int layer = 0; layer < LAYERS; ++layer) {
+                JobCounter* dependency = layer > 0 ? &counters[layer - 1] : nullptr;
+                for (int j = 0; j < JOBS_PER_LAYER; ++j) {
+                    bool onMain = j % 10 == 0;
+                    auto job = [&, layer, j, onMain]() {
+                        if (layer > 0 && finished[layer - 1].load() != JOBS_PER_LAYER) {
+                            ++orderErrors;
+                        }
+                        if (onMain && std::this_thread::get_id() != mainThread) {
+                            ++affinityErrors;
+                        }
+                        g_JobSink.store(BusyWork(200, static_cast<float>(j)), std::memory_order_relaxed);
+                        ++finished[layer];
+                    };
+                    if (onMain) {
+                        jobs.RunOnMainThread(job, &counters[layer], dependency);
+                    } else {
+                        jobs.Run(job, &counters[layer], dependency);
+                    }
+                }
+            }
+            jobs.Wait(counters[LAYERS - 1]);
+
+            int complete = 0;
+            for (int layer = 0; layer < LAYERS; ++layer) {
+                complete += finished[layer].load() == JOBS_PER_LAYER ? 1 : 0;
+            }
+            TEST_CHECK_EQUAL(suite, complete, LAYERS);
+            TEST_CHECK_EQUAL(suite, orderErrors.load(), 0);
+            TEST_CHECK_EQUAL(suite, affinityErrors.load(), 0);
+            TEST_CHECK_EQUAL(suite, jobs.GetStats().jobsRun, static_cast<unsigned long long>(LAYERS * JOBS_PER_LAYER));
+        }
+    });
+
+    // 主线程作业：工作线程上的作业再排主线程作业，只在主线程执行；
+    // RunMainThreadJobs 只执行调用时已经排好的，作业里新排的留到下一次
+    suite.Run("jobs.stress.main_thread", [&]() {
+        for (int workers : STRESS_WORKERS) {
+            JobSystem jobs(workers);
+            std::thread::id mainThread = std::this_thread::get_id();
+            std::atomic<int> ran(0);
+            std::atomic<int> affinityErrors(0);
+            auto mainJob = [&]() {
+                if (std::this_thread::get_id() != mainThread || !jobs.IsMainThread()) {
+                    ++affinityErrors;
+                }
+                ++ran;
+            };
+
+            JobCounter done;
+            for (int i = 0; i < 200; ++i) {
+                jobs.Run([&]() {
+                    g_JobSink.store(BusyWork(100, 1.0f), std::memory_order_relaxed);
+                    jobs.RunOnMainThread(mainJob, &done);
+                }, &done);
+            }
+            jobs.Wait(done);
+            TEST_CHECK_EQUAL(suite, ran.load(), 200);
+            TEST_CHECK_EQUAL(suite, affinityErrors.load(), 0);
+
+            // 每帧执行一次：作业排的下一个作业不在这一帧执行
+            int frames = 0;
+            ran = 0;
+            for (int i = 0; i < 10; ++i) {
+                jobs.RunOnMainThread(mainJob);
+            }
+            jobs.RunOnMainThread([&]() { jobs.RunOnMainThread(mainJob); });
+            TEST_CHECK_EQUAL(suite, jobs.RunMainThreadJobs(), 11);
+            TEST_CHECK_EQUAL(suite, ran.load(), 10);
+            while (jobs.RunMainThreadJobs() > 0) {
+                ++frames;
+            }
+            TEST_CHECK_EQUAL(suite, frames, 1);
+            TEST_CHECK_EQUAL(suite, ran.load(), 11);
+            TEST_CHECK_EQUAL(suite, affinityErrors.load(), 0);
+        }
+    });
+
+    // 窃取：主线程排 1000 个作业后自己不执行（不调用 Wait，只让出时间片），
+    // 只能全部被工作线程偷走；没有工作线程时跳过这一段。
+    // 然后是嵌套：每个作业再分出子作业并在作业里等待，
+    // 外层和内层的 ParallelFor 里每个下标都只执行一次
+    suite.Run("jobs.stress.stealing", [&]() {
+        for (int workers : STRESS_WORKERS) {
+            JobSystem jobs(workers);
+            if (workers > 0) {
+                const int JOBS = 1000;
+                JobCounter done;
+                std::atomic<int> ran(0);
+                for (int i = 0; i < JOBS; ++i) {
+                    jobs.Run([&ran, i]() {
+                        g_JobSink.store(BusyWork(50, static_cast<float>(i)), std::memory_order_relaxed);
+                        ++ran;
+                    }, &done);
+                }
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+                while (!done.IsDone() && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+                TEST_CHECK(suite, done.IsDone());
+                jobs.Wait(done);
+                TEST_CHECK_EQUAL(suite, ran.load(), JOBS);
+                TEST_CHECK_EQUAL(suite, jobs.GetStats().steals, static_cast<unsigned long long>(JOBS));
+            }
+
+            const int ROOTS = 16;
+            const int CHILDREN = 64;
+            std::atomic<int> children(0);
+            JobCounter roots;
+            for (int r = 0; r < ROOTS; ++r) {
+                jobs.Run([&]() {
+                    JobCounter mine;
+                    for (int c = 0; c < CHILDREN; ++c) {
+                        jobs.Run([&children]() {
+                            g_JobSink.store(BusyWork(50, 2.0f), std::memory_order_relaxed);
+                            ++children;
+                        }, &mine);
+                    }
+                    jobs.Wait(mine);
+                }, &roots);
+            }
+            jobs.Wait(roots);
+            TEST_CHECK_EQUAL(suite, children.load(), ROOTS * CHILDREN);
+
+            const int OUTER = 64;
+            const int INNER = 512;
+            std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[OUTER * INNER]);
+            for (int i = 0; i < OUTER * INNER; ++i) {
+                visits[i] = 0;
+            }
+            jobs.ParallelFor(OUTER, 1, [&](int outer) {
+                jobs.ParallelFor(INNER, 16, [&](int inner) {
+                    ++visits[outer * INNER + inner];
+                });
+            });
+            int exactlyOnce = 0;
+            for (int i = 0; i < OUTER * INNER; ++i) {
+                exactlyOnce += visits[i].load() == 1 ? 1 : 0;
+            }
+            TEST_CHECK_EQUAL(suite, exactlyOnce, OUTER * INNER);
+        }
+    });
+}
+
+// ========================================
+// 网格并行载入
+// ========================================
+// LoadFromMeshFiles 在作业系统上解析，结果和逐个 LoadFromMeshFile 相同；
+// 载入失败的文件留空位，不影响其他文件
+// ========================================
+static void TestMeshJobs(TestSuite& suite)
+{
+    suite.Run("jobs.mesh.batch_matches_serial", [&]() {
+        std::vector<std::string> names = { "Cube.msh", "Sphere.msh", "Role_T.msh", "Missing.msh",
+                                           "Cylinder.msh", "Cone.msh", "Capsule.msh" };
+        LogLevel level = Log::GetLevel();
+        Log::SetLevel(LOG_LEVEL_NONE);
+        std::vector<Mesh*> batch = Mesh::LoadFromMeshFiles(names);
+        Log::SetLevel(level);
+        TEST_CHECK_EQUAL(suite, batch.size(), names.size());
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == "Missing.msh") {
+                TEST_CHECK(suite, batch[i] == nullptr);
+                continue;
+            }
+            Mesh* serial = Mesh::LoadFromMeshFile(names[i]);
+            TEST_CHECK(suite, serial != nullptr && batch[i] != nullptr);
+            if (serial && batch[i]) {
+                TEST_CHECK_EQUAL(suite, batch[i]->GetTriCount(), serial->GetTriCount());
+                TEST_CHECK_EQUAL(suite, batch[i]->GetJointCount(), serial->GetJointCount());
+                TEST_CHECK_EQUAL(suite, batch[i]->GetSubMeshCount(), serial->GetSubMeshCount());
+            }
+            delete serial;
+        }
+        for (Mesh* mesh : batch) {
+            delete mesh;
+        }
+    });
+}
+
+// ========================================
+// 角色动画并行
+// ========================================
+// StressScene 按角色并行计算骨骼矩阵，每个角色只写自己那一段：
+// 几帧之后所有角色的矩阵和单线程逐字节相同
+// ========================================
+static const int ANIMATION_CHARACTERS = 24;
+static const float ANIMATION_TIMES[] = { 0.0f, 0.37f, 1.5f, 12.25f };
+
+// 各个时刻所有角色的骨骼矩阵连在一起
+static std::vector<Matrix4> AnimatePalettes(unsigned int threads)
+{
+    StressScene::Settings settings;
+    settings.heightmapSize = 33;
+    settings.meshInstances = 0;
+    settings.characters = ANIMATION_CHARACTERS;
+    settings.lights = 0;
+    settings.textures = 0;
+    settings.threadCount = threads;
+
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_WARNING);
+    StressScene scene(settings);
+    Log::SetLevel(level);
+
+    std::vector<Matrix4> palettes;
+    if (!scene.IsLoaded()) {
+        return palettes;
+    }
+    unsigned int joints = scene.GetCharacterMesh()->GetJointCount();
+    for (float time : ANIMATION_TIMES) {
+        scene.Update(time);
+        for (int c = 0; c < ANIMATION_CHARACTERS; ++c) {
+            const Matrix4* matrices = scene.GetJointMatrices(c);
+            palettes.insert(palettes.end(), matrices, matrices + joints);
+        }
+    }
+    return palettes;
+}
+
+static void TestAnimationJobs(TestSuite& suite)
+{
+    suite.Run("jobs.animation.thread_invariance", [&]() {
+        std::vector<Matrix4> reference = AnimatePalettes(1);
+        TEST_CHECK(suite, !reference.empty());
+        uint64_t expected = HashArray(reference);
+        for (unsigned int threads : TestThreadCounts()) {
+            std::vector<Matrix4> palettes = AnimatePalettes(threads);
+            TEST_CHECK_EQUAL(suite, palettes.size(), reference.size());
+            TEST_CHECK_EQUAL(suite, HashArray(palettes), expected);
+        }
+    });
+}
+
+// ========================================
+// 稳定状态下不分配堆内存
+// ========================================
+// 测试程序替换了全局的 operator new（见 HeapCounter.h），数一共分配了多少次
+// （所有线程一起算，工作线程也在内）。每项先预热几帧，让队列、对象池、
+// 临时内存长到需要的大小，之后每帧的分配次数必须是 0
+// ========================================
+
+// 预热 warmup 帧后，frames 帧里一共分配了几次
+template <typename Frame>
+static long long SteadyStateAllocations(int warmup, int frames, const Frame& frame)
+{
+    for (int i = 0; i < warmup; ++i) {
+        frame(i);
+    }
+    long long before = GetHeapAllocationCount();
+    for (int i = 0; i < frames; ++i) {
+        frame(warmup + i);
+    }
+    return GetHeapAllocationCount() - before;
+}
+
+static void TestSteadyStateAllocations(TestSuite& suite)
+{
+    // 先确认计数真的生效，不然下面的 0 没有意义
+    suite.Run("alloc.counting_works", [&]() {
+        // 指针存进 volatile 变量，编译器不能把配对的 new / delete 一起省掉
+        static int* volatile escaped = nullptr;
+        long long before = GetHeapAllocationCount();
+        escaped = new int(7);
+        std::vector<float> values(100);
+        long long counted = GetHeapAllocationCount() - before;
+        delete escaped;
+        TEST_CHECK_EQUAL(suite, counted, 2LL);
+        TEST_CHECK_EQUAL(suite, values.size(), static_cast<size_t>(100));
+    });
+
+    // 作业系统：每帧一张小依赖图（两层普通作业、一层主线程作业）加一个 ParallelFor。
+    // 等待依赖的作业放在作业系统的对象池里，队列只增不减
+    suite.Run("alloc.steady_state.jobs", [&]() {
+        for (int workers : { 0, 3 }) {
+            JobSystem jobs(workers);
+            std::atomic<int> ran(0);
+            std::vector<float> results(1024);
+            long long allocations = SteadyStateAllocations(10, 200, [&](int) {
+                JobCounter first;
+                JobCounter second;
+                JobCounter last;
+                for (int i = 0; i < 16; ++i) {
+                    jobs.Run([&ran]() { ++ran; }, &first);
+                    jobs.Run([&ran]() { ++ran; }, &second, &first);
+                }
+                for (int i = 0; i < 4; ++i) {
+                    jobs.RunOnMainThread([&ran]() { ++ran; }, &last, &second);
+                }
+                jobs.ParallelFor(static_cast<int>(results.size()), 64, [&](int i) {
+                    results[i] = std::sqrt(static_cast<float>(i));
+                });
+                jobs.Wait(last);
+                jobs.Wait(second);
+            });
+            TEST_CHECK_EQUAL(suite, allocations, 0LL);
+            TEST_CHECK_EQUAL(suite, ran.load(), 210 * 36);
+        }
+    });
+
+    // 模拟时钟：每帧的临时数组在线程自己的临时内存里
+    suite.Run("alloc.steady_state.simulation_clock", [&]() {
+        SimulationClock clock;
+        int steps = 0;
+        clock.AddSystem("ocean", 60, 4, [&](float) { ++steps; });
+        clock.AddSystem("water", 30, 4, [&](float) { ++steps; });
+        long long allocations = SteadyStateAllocations(10, 500, [&](int frame) {
+            clock.Advance((10 + frame % 25) / 1000.0);
+        });
+        TEST_CHECK_EQUAL(suite, allocations, 0LL);
+        TEST_CHECK(suite, steps > 0);
+    });
+
+    // 每帧的临时内存（LinearArena，每帧 Reset）和对象池（创建、销毁数量每帧不同）
+    suite.Run("alloc.steady_state.arena_and_pool", [&]() {
+        struct Particle
+        {
+            float position[3];
+            float velocity[3];
+            int age;
+        };
+        LinearArena arena(4096);
+        ObjectPool<Particle> pool(64);
+        // 每帧创建一批（100 - 299 个），每批活三帧；
+        // 数量的规律每 200 帧重复一次，预热两轮后不会再出现更高的峰值
+        std::vector<Particle*> batches[3];
+        for (std::vector<Particle*>& batch : batches) {
+            batch.reserve(300);
+        }
+        long long allocations = SteadyStateAllocations(400, 400, [&](int frame) {
+            arena.Reset();
+            int count = 200 + (frame * 37) % 400;
+            Particle* scratch = arena.AllocateArray<Particle>(count);
+            scratch[count - 1].age = frame;
+
+            std::vector<Particle*>& batch = batches[frame % 3];
+            for (Particle* particle : batch) {
+                pool.Destroy(particle);
+            }
+            batch.clear();
+            int created = 100 + (frame * 53) % 200;
+            for (int i = 0; i < created; ++i) {
+                batch.push_back(pool.Create());
+            }
+        });
+        TEST_CHECK_EQUAL(suite, allocations, 0LL);
+        TEST_CHECK_EQUAL(suite, pool.GetLiveCount(), batches[0].size() + batches[1].size() + batches[2].size());
+        for (std::vector<Particle*>& batch : batches) {
+            for (Particle* particle : batch) {
+                pool.Destroy(particle);
+            }
+        }
+        TEST_CHECK_EQUAL(suite, pool.GetLiveCount(), static_cast<size_t>(0));
+    });
+}
+
+// ========================================
+// 内存统计
+// ========================================
+// 载入真实资源，统计的字节数要和按尺寸算出来的一致：
+//   GPU 缓冲 = NullGL 记录下来的 glBufferData 大小之和
+//   GPU 纹理 = 按图片宽高和通道数算的整条 mip 链
+//   CPU      = 顶点 / 索引 / 高度数组的大小
+// 释放 CPU 副本后相应的 CPU 统计要回到 0，对象删除后全部回到 0
+// ========================================
+static long long CurrentBytes(MemoryTag tag, MemoryKind kind)
+{
+    return MemoryTracker::GetUsage(tag, kind).current;
+}
+
+static void TestMemoryTracking(TestSuite& suite)
+{
+    suite.Run("memory.tracker.mesh", [&]() {
+        RecordNullGLBuffers(true);
+        long long cpuBefore = CurrentBytes(MEMORY_MESHES, MEMORY_CPU);
+        long long gpuBefore = CurrentBytes(MEMORY_MESHES, MEMORY_GPU_BUFFER);
+        size_t glBefore = GetNullGLBufferBytes();
+
+        Mesh* mesh = Mesh::LoadFromMeshFile("Cube.msh");
+        TEST_CHECK(suite, mesh != nullptr);
+        if (mesh) {
+            // 24 个顶点 × (位置 12 + 法线 12 + 切线 16 + UV 8) + 36 个索引 × 4
+            const long long expected = 24 * (12 + 12 + 16 + 8) + 36 * 4;
+            TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_MESHES, MEMORY_CPU) - cpuBefore, expected);
+            TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_MESHES, MEMORY_GPU_BUFFER) - gpuBefore, expected);
+            TEST_CHECK_EQUAL(suite, static_cast<long long>(GetNullGLBufferBytes() - glBefore), expected);
+
+            mesh->ReleaseCpuData();
+            TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_MESHES, MEMORY_CPU) - cpuBefore, 0LL);
+            TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_MESHES, MEMORY_GPU_BUFFER) - gpuBefore, expected);
+            delete mesh;
+        }
+        TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_MESHES, MEMORY_GPU_BUFFER) - gpuBefore, 0LL);
+        TEST_CHECK_EQUAL(suite, GetNullGLBufferBytes(), glBefore);
+        RecordNullGLBuffers(false);
+    });
+
+    suite.Run("memory.tracker.terrain", [&]() {
+        int width = 0, height = 0, channels = 0;
+        TEST_CHECK(suite, stbi_info(TEXTUREDIR"heightmap.png", &width, &height, &channels) == 1);
+        // 每个像素一个顶点：位置 12 + 法线 12 + UV 8
+        const long long vertexBytes = static_cast<long long>(width) * height * (12 + 12 + 8);
+        const long long heightBytes = static_cast<long long>(width) * height * sizeof(float);
+
+        RecordNullGLBuffers(true);
+        long long cpuBefore = CurrentBytes(MEMORY_TERRAIN, MEMORY_CPU);
+        long long gpuBefore = CurrentBytes(MEMORY_TERRAIN, MEMORY_GPU_BUFFER);
+        size_t glBefore = GetNullGLBufferBytes();
+        {
+            Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+            const std::vector<unsigned char>* vbo = GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ARRAY_BUFFER));
+            const std::vector<unsigned char>* ebo = GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ELEMENT_ARRAY_BUFFER));
+            TEST_CHECK(suite, vbo != nullptr && ebo != nullptr);
+            if (vbo && ebo) {
+                const long long indexBytes = static_cast<long long>(ebo->size());
+                TEST_CHECK_EQUAL(suite, static_cast<long long>(vbo->size()), vertexBytes);
+                TEST_CHECK(suite, indexBytes > 0 && indexBytes % sizeof(unsigned int) == 0);
+
+                TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TERRAIN, MEMORY_GPU_BUFFER) - gpuBefore, vertexBytes + indexBytes);
+                TEST_CHECK_EQUAL(suite, static_cast<long long>(GetNullGLBufferBytes() - glBefore), vertexBytes + indexBytes);
+                TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TERRAIN, MEMORY_CPU) - cpuBefore,
+                                 vertexBytes + indexBytes + heightBytes);
+
+                // 高度数据留着给碰撞和编辑用，只有顶点和索引的副本会释放
+                terrain.ReleaseCpuCopies();
+                TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TERRAIN, MEMORY_CPU) - cpuBefore, heightBytes);
+                TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TERRAIN, MEMORY_GPU_BUFFER) - gpuBefore, vertexBytes + indexBytes);
+            }
+        }
+        TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TERRAIN, MEMORY_CPU) - cpuBefore, 0LL);
+        TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TERRAIN, MEMORY_GPU_BUFFER) - gpuBefore, 0LL);
+        TEST_CHECK_EQUAL(suite, GetNullGLBufferBytes(), glBefore);
+        RecordNullGLBuffers(false);
+    });
+
+    suite.Run("memory.tracker.textures", [&]() {
+        for (const char* path : { TEXTUREDIR"grass.jpg", TEXTUREDIR"waterbump.png" }) {
+            int width = 0, height = 0, channels = 0;
+            TEST_CHECK(suite, stbi_info(path, &width, &height, &channels) == 1);
+            long long expected = 0;
+            for (int level = 0; ; ++level) {
+                int w = std::max(1, width >> level);
+                int h = std::max(1, height >> level);
+                expected += static_cast<long long>(w) * h * channels;
+                if (w == 1 && h == 1) {
+                    break;
+                }
+            }
+
+            long long gpuBefore = CurrentBytes(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE);
+            {
+                Texture texture(path);
+                TEST_CHECK(suite, texture.IsLoaded());
+                TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE) - gpuBefore, expected);
+            }
+            TEST_CHECK_EQUAL(suite, CurrentBytes(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE) - gpuBefore, 0LL);
+        }
+    });
+}
+
+// ========================================
+// 日志顺序
+// ========================================
+// 几个线程同时写带序号的消息，每个线程写的数量都远超过环形缓冲的容量
+// （逼着它们等写入线程），输出读回来以后每个线程自己的消息要一条不少、
+// 按序号排好。第二项在它们写到一半时 Log::Shutdown：那之后直接写出，
+// 但停下时还在环形缓冲里、或正在放进去的消息也不能丢，顺序也不能乱。
+// 停下以后就回不到写入线程了，所以这一项放在最后
+// ========================================
+static const int LOG_PRODUCERS = 4;
+static const int LOG_MESSAGES = 5000;
+
+// 返回读回的输出；shutdownMidway 时主线程等大约四分之一的消息写完后关闭日志
+static std::string LogFromThreads(bool shutdownMidway)
+{
+    std::ostringstream captured;
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_INFO);
+    Log::SetStreams(captured, captured);
+
+    std::atomic<int> logged(0);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < LOG_PRODUCERS; ++p) {
+        producers.emplace_back([p, &logged]() {
+            for (int i = 0; i < LOG_MESSAGES; ++i) {
+                LOG_INFO("order " << p << " " << i);
+                logged.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    if (shutdownMidway) {
+        while (logged.load() < LOG_PRODUCERS * LOG_MESSAGES / 4) {
+            std::this_thread::yield();
+        }
+        Log::Shutdown();
+    }
+    for (std::thread& t : producers) {
+        t.join();
+    }
+    Log::SetStreams(std::cout, std::cerr);
+    Log::SetLevel(level);
+    return captured.str();
+}
+
+static void CheckLogOrder(TestSuite& suite, const std::string& output)
+{
+    std::vector<int> next(LOG_PRODUCERS, 0);
+    int outOfOrder = 0;
+    int unexpected = 0;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        int p = -1, i = -1;
+        if (sscanf(line.c_str(), "order %d %d", &p, &i) != 2 || p < 0 || p >= LOG_PRODUCERS) {
+            ++unexpected;
+            continue;
+        }
+        if (i != next[p]) {
+            ++outOfOrder;
+        }
+        next[p] = i + 1;
+    }
+    TEST_CHECK_EQUAL(suite, unexpected, 0);
+    TEST_CHECK_EQUAL(suite, outOfOrder, 0);
+    for (int p = 0; p < LOG_PRODUCERS; ++p) {
+        TEST_CHECK_EQUAL(suite, next[p], LOG_MESSAGES);
+    }
+}
+
+static void TestLogOrdering(TestSuite& suite)
+{
+    suite.Run("log.ordering.per_thread", [&]() {
+        CheckLogOrder(suite, LogFromThreads(false));
+    });
+
+    suite.Run("log.ordering.during_shutdown", [&]() {
+        CheckLogOrder(suite, LogFromThreads(true));
+    });
+}
+
+// ========================================
+// 性能计数器
+// ========================================
+// 几个线程同时注册同一个名字（拿到同一个编号），同时 Add 计数器、Set 仪表，
+// EndFrame 的快照要算出准确的每帧增量和总数；导出的 CSV / JSON 里
+// 对应的列和值要和快照一致
+// ========================================
+static const int PERF_THREADS = 4;
+static const int PERF_ADDS = 20000;
+
+// JSON 里第 frame 帧的 values 数组，找不到时返回空
+static std::vector<long long> JsonFrameValues(const std::string& json, int frame)
+{
+    std::vector<long long> values;
+    std::string key = "{\"frame\": " + std::to_string(frame) + ", \"values\": [";
+    size_t at = json.find(key);
+    if (at == std::string::npos) {
+        return values;
+    }
+    const char* c = json.c_str() + at + key.size();
+    while (*c != ']' && *c) {
+        char* end = nullptr;
+        values.push_back(strtoll(c, &end, 10));
+        c = end;
+        while (*c == ',' || *c == ' ') {
+            ++c;
+        }
+    }
+    return values;
+}
+
+static void TestPerfCounters(TestSuite& suite)
+{
+    suite.Run("perf.counters.threads_and_export", [&]() {
+        std::atomic<int> counterIds[PERF_THREADS];
+        std::atomic<int> gaugeIds[PERF_THREADS];
+        std::vector<std::thread> threads;
+        for (int t = 0; t < PERF_THREADS; ++t) {
+            threads.emplace_back([&, t]() {
+                counterIds[t] = PerfCounters::Register("test_counter", PERF_COUNTER);
+                gaugeIds[t] = PerfCounters::Register("test_gauge", PERF_GAUGE);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+        int counter = counterIds[0];
+        int gauge = gaugeIds[0];
+        TEST_CHECK(suite, counter >= PERF_BUILTIN_COUNT && gauge >= PERF_BUILTIN_COUNT && counter != gauge);
+        for (int t = 1; t < PERF_THREADS; ++t) {
+            TEST_CHECK_EQUAL(suite, counterIds[t].load(), counter);
+            TEST_CHECK_EQUAL(suite, gaugeIds[t].load(), gauge);
+        }
+        if (counter < 0 || gauge < 0) {
+            return;
+        }
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetKind(counter), PERF_COUNTER);
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetKind(gauge), PERF_GAUGE);
+
+        // 从干净的一帧开始，之前的测试加过的数不算进来
+        PerfCounters::EndFrame();
+        long long totalBefore = PerfCounters::GetTotal(counter);
+
+        // 第一帧：每个线程加 PERF_ADDS 次，每次加线程号 + 1；仪表最后设成 (线程号 + 1) × 1000
+        for (int t = 0; t < PERF_THREADS; ++t) {
+            threads.emplace_back([=]() {
+                for (int i = 0; i < PERF_ADDS; ++i) {
+                    PerfCounters::Add(counter, t + 1);
+                    PerfCounters::Set(gauge, i);
+                }
+                PerfCounters::Set(gauge, (t + 1) * 1000);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        PerfCounterLog log;
+        PerfCounters::EndFrame();
+        log.AddFrame();
+        int firstFrame = PerfCounters::GetFrameNumber();
+
+        long long expected = 0;
+        for (int t = 0; t < PERF_THREADS; ++t) {
+            expected += static_cast<long long>(PERF_ADDS) * (t + 1);
+        }
+        long long gaugeValue = PerfCounters::GetFrameValue(gauge);
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetFrameValue(counter), expected);
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetTotal(counter), totalBefore + expected);
+        TEST_CHECK(suite, gaugeValue % 1000 == 0 && gaugeValue >= 1000 && gaugeValue <= PERF_THREADS * 1000);
+
+        // 第二帧：计数器只加 5，仪表不动，还是上一帧的值
+        PerfCounters::Add(counter, 5);
+        PerfCounters::EndFrame();
+        log.AddFrame();
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetFrameValue(counter), 5LL);
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetTotal(counter), totalBefore + expected + 5);
+        TEST_CHECK_EQUAL(suite, PerfCounters::GetFrameValue(gauge), gaugeValue);
+
+        // CSV：表头是 frame 加上每个计数器的名字，每帧一行
+        std::ostringstream csv;
+        log.WriteCsv(csv);
+        std::istringstream csvLines(csv.str());
+        std::vector<std::vector<std::string>> rows;
+        std::string line;
+        while (std::getline(csvLines, line)) {
+            std::vector<std::string> cells;
+            std::istringstream cellStream(line);
+            std::string cell;
+            while (std::getline(cellStream, cell, ',')) {
+                cells.push_back(cell);
+            }
+            rows.push_back(cells);
+        }
+        int columns = PerfCounters::GetCount() + 1;
+        TEST_CHECK_EQUAL(suite, rows.size(), static_cast<size_t>(3));
+        if (rows.size() == 3) {
+            TEST_CHECK_EQUAL(suite, static_cast<int>(rows[0].size()), columns);
+            TEST_CHECK_EQUAL(suite, static_cast<int>(rows[1].size()), columns);
+            TEST_CHECK_EQUAL(suite, static_cast<int>(rows[2].size()), columns);
+        }
+        if (rows.size() == 3 && static_cast<int>(rows[0].size()) == columns &&
+            static_cast<int>(rows[1].size()) == columns && static_cast<int>(rows[2].size()) == columns) {
+            TEST_CHECK_EQUAL(suite, rows[0][0], std::string("frame"));
+            TEST_CHECK_EQUAL(suite, rows[0][1 + PERF_DRAW_CALLS], std::string("draw_calls"));
+            TEST_CHECK_EQUAL(suite, rows[0][1 + counter], std::string("test_counter"));
+            TEST_CHECK_EQUAL(suite, rows[0][1 + gauge], std::string("test_gauge"));
+            TEST_CHECK_EQUAL(suite, rows[1][0], std::to_string(firstFrame));
+            TEST_CHECK_EQUAL(suite, rows[2][0], std::to_string(firstFrame + 1));
+            TEST_CHECK_EQUAL(suite, rows[1][1 + counter], std::to_string(expected));
+            TEST_CHECK_EQUAL(suite, rows[2][1 + counter], std::string("5"));
+            TEST_CHECK_EQUAL(suite, rows[1][1 + gauge], std::to_string(gaugeValue));
+            TEST_CHECK_EQUAL(suite, rows[2][1 + gauge], std::to_string(gaugeValue));
+        }
+
+        // JSON：计数器名字和种类，每帧的 values 数组按编号排列
+        std::ostringstream jsonStream;
+        log.WriteJson(jsonStream);
+        std::string json = jsonStream.str();
+        TEST_CHECK(suite, json.find("{\"name\": \"test_counter\", \"kind\": \"counter\"}") != std::string::npos);
+        TEST_CHECK(suite, json.find("{\"name\": \"test_gauge\", \"kind\": \"gauge\"}") != std::string::npos);
+        std::vector<long long> first = JsonFrameValues(json, firstFrame);
+        std::vector<long long> second = JsonFrameValues(json, firstFrame + 1);
+        TEST_CHECK_EQUAL(suite, static_cast<int>(first.size()), PerfCounters::GetCount());
+        TEST_CHECK_EQUAL(suite, static_cast<int>(second.size()), PerfCounters::GetCount());
+        if (static_cast<int>(first.size()) == PerfCounters::GetCount() &&
+            static_cast<int>(second.size()) == PerfCounters::GetCount()) {
+            TEST_CHECK_EQUAL(suite, first[counter], expected);
+            TEST_CHECK_EQUAL(suite, second[counter], 5LL);
+            TEST_CHECK_EQUAL(suite, first[gauge], gaugeValue);
+            TEST_CHECK_EQUAL(suite, second[gauge], gaugeValue);
+        }
+    });
+}
+
+// ========================================
+// 基准测试的硬件计数列
+// ========================================
+// 沙箱和大多数虚拟机里没有 perf_event：计时照常记录，IPC 和未命中几列是 n/a。
+// 有计数时的格式用 Record 传入固定的计数检查，和机器无关
+// ========================================
+
+// Print 输出里名字为 name 的那一行，按空白分开
+static std::vector<std::string> BenchmarkRow(const BenchmarkSuite& bench, const std::string& name)
+{
+    std::ostringstream out;
+    bench.Print(out);
+    std::istringstream lines(out.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream cells(line);
+        std::vector<std::string> row;
+        std::string cell;
+        while (cells >> cell) {
+            row.push_back(cell);
+        }
+        if (!row.empty() && row[0] == name) {
+            return row;
+        }
+    }
+    return {};
+}
+
+static void TestBenchmarkCounters(TestSuite& suite)
+{
+    suite.Run("bench.counters.fallback_without_counters", [&]() {
+        // 打开失败时会记一条错误，这里是预期的
+        LogLevel level = Log::GetLevel();
+        Log::SetLevel(LOG_LEVEL_NONE);
+        HardwareCounters::Enable();
+        Log::SetLevel(level);
+        bool counting = HardwareCounters::HasCounters();
+
+        BenchmarkSuite bench(3, "");
+        volatile float sink = 0.0f;
+        bench.Run("bench.busy", [&]() {
+            for (int i = 0; i < 100000; ++i) {
+                sink = sink + std::sqrt(static_cast<float>(i));
+            }
+        }, 100000.0);
+        bench.Record("bench.recorded", { 2.0, 1.0, 3.0 });
+        HardwareCounters::Disable();
+
+        const std::vector<BenchmarkResult>& results = bench.GetResults();
+        TEST_CHECK_EQUAL(suite, results.size(), static_cast<size_t>(2));
+        if (results.size() != 2) {
+            return;
+        }
+        TEST_CHECK(suite, results[0].median > 0.0 && results[0].minimum > 0.0);
+        TEST_CHECK(suite, results[0].GetItemsPerSecond() > 0.0);
+        TEST_CHECK_EQUAL(suite, results[0].counted, counting);
+        TEST_CHECK_NEAR(suite, results[1].median, 2.0, 1e-9);
+        TEST_CHECK_NEAR(suite, results[1].minimum, 1.0, 1e-9);
+        TEST_CHECK(suite, !results[1].counted);
+
+        // 列：名字、中位数、最小值、每秒处理数、IPC、缓存未命中 / 项、分支未命中 / 项
+        std::vector<std::string> busy = BenchmarkRow(bench, "bench.busy");
+        std::vector<std::string> recorded = BenchmarkRow(bench, "bench.recorded");
+        TEST_CHECK_EQUAL(suite, busy.size(), static_cast<size_t>(7));
+        TEST_CHECK_EQUAL(suite, recorded.size(), static_cast<size_t>(7));
+        if (busy.size() == 7 && !counting) {
+            TEST_CHECK_EQUAL(suite, busy[4], std::string("n/a"));
+            TEST_CHECK_EQUAL(suite, busy[5], std::string("n/a"));
+            TEST_CHECK_EQUAL(suite, busy[6], std::string("n/a"));
+        }
+        if (recorded.size() == 7) {
+            TEST_CHECK_EQUAL(suite, recorded[3], std::string("-"));
+            TEST_CHECK_EQUAL(suite, recorded[4], std::string("n/a"));
+        }
+
+        // Compare 之后的计数表：只有没计数的项时不输出
+        std::ostringstream counters;
+        bench.PrintCounters(counters);
+        TEST_CHECK_EQUAL(suite, counters.str().empty(), !counting);
+    });
+
+    suite.Run("bench.counters.ipc_and_misses_per_item", [&]() {
+        BenchmarkSuite bench(3, "");
+        HardwareSample counters = {};
+        counters.cycles = 1000;
+        counters.instructions = 2500;
+        counters.cacheMisses = 30;
+        counters.branchMisses = 60;
+        bench.Record("bench.counted", { 1.0, 1.0, 1.0 }, 100.0, &counters);
+        HardwareSample noItems = counters;
+        bench.Record("bench.no_items", { 1.0 }, 0.0, &noItems);
+
+        // 三次运行，每次 100 项：每项 0.1 次缓存未命中、0.2 次分支未命中
+        std::vector<std::string> row = BenchmarkRow(bench, "bench.counted");
+        TEST_CHECK_EQUAL(suite, row.size(), static_cast<size_t>(7));
+        if (row.size() == 7) {
+            TEST_CHECK_EQUAL(suite, row[4], std::string("2.50"));
+            TEST_CHECK_EQUAL(suite, row[5], std::string("0.1000"));
+            TEST_CHECK_EQUAL(suite, row[6], std::string("0.2000"));
+        }
+        row = BenchmarkRow(bench, "bench.no_items");
+        TEST_CHECK_EQUAL(suite, row.size(), static_cast<size_t>(7));
+        if (row.size() == 7) {
+            TEST_CHECK_EQUAL(suite, row[4], std::string("2.50"));
+            TEST_CHECK_EQUAL(suite, row[5], std::string("-"));
+            TEST_CHECK_EQUAL(suite, row[6], std::string("-"));
+        }
+
+        std::ostringstream out;
+        bench.PrintCounters(out);
+        TEST_CHECK(suite, out.str().find("hardware counters") != std::string::npos);
+    });
+}
+
+void RunCoreTests(TestSuite& suite)
+{
+    TestJobStress(suite);
+    TestMeshJobs(suite);
+    TestAnimationJobs(suite);
+    TestSteadyStateAllocations(suite);
+    TestMemoryTracking(suite);
+    TestPerfCounters(suite);
+    TestBenchmarkCounters(suite);
+    TestLogOrdering(suite);
+}
@@ -0,0 +1,131 @@
+#include "Flythrough.h"
+#include "Camera.h"
+#include "CameraPath.h"
+#include "FrameTimeRecorder.h"
+#include "OceanFFT.h"
+#include "ShallowWater.h"
+#include "SimulationClock.h"
+#include "Terrain.h"
+#include "WaterClipmap.h"
+#include "WaterTileMap.h"
+#include "nclgl/Log.h"
+#include "nclgl/common.h"
+#include <chrono>
+
+namespace
+{
+    double ElapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // ========================================
+    // 场景（设置和 Renderer 构造函数里一样）
+    // ========================================
+    struct HeadlessScene
+    {
+        Terrain terrain;
+        WaterClipmap water;
+        OceanFFT ocean;
+        WaterTileMap tiles;
+        ShallowWater shallowWater;
+        SimulationClock clock;
+        Camera camera;
+        float waterTime;
+        int oceanSystem;
+        int shallowWaterSystem;
+
+        static OceanFFT::Settings OceanSettings()
+        {
+            OceanFFT::Settings settings;
+            settings.resolution = 128;
+            settings.patchSize = 64.0f;
+            settings.windSpeed = 5.0f;
+            settings.fetch = 1000.0f;
+            settings.choppiness = 1.3f;
+            return settings;
+        }
+
+        static ShallowWater::Settings ShallowWaterSettings()
+        {
+            ShallowWater::Settings settings;
+            settings.timeStep = 1.0f / 30.0f;
+            return settings;
+        }
+
+        HeadlessScene()
+            : terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f)
+            , water(0.0f, 64, 7, 0.25f)
+            , ocean(OceanSettings())
+            , tiles(terrain, 0.0f, 0.5f, 32)
+            , shallowWater(terrain, ShallowWaterSettings())
+            , waterTime(0.0f)
+        {
+            ocean.Update(waterTime);
+            ocean.UploadTextures();
+            tiles.UploadMask();
+            water.SetTileMap(&tiles);
+            oceanSystem = clock.AddSystem("ocean", 60, 4, [this](float dt) {
+                waterTime += dt;
+                ocean.Update(waterTime);
+            });
+            shallowWaterSystem = clock.AddSystem("shallowWater", 30, 2, [this](float) {
+                shallowWater.Step();
+            });
+        }
+
+        void Update(float seconds)
+        {
+            water.Update(camera.Position);
+            clock.Advance(seconds);
+            if (clock.GetStepsThisFrame(oceanSystem) > 0) {
+                ocean.UploadTextures();
+            }
+            shallowWater.UpdateMesh(clock.GetAlpha(shallowWaterSystem));
+        }
+
+        void Render()
+        {
+            terrain.Render();
+            water.Render();
+            shallowWater.Render();
+        }
+    };
+}
+
+int RunFlythrough(const FlythroughOptions& options)
+{
+    CameraPath path = CameraPath::CreateOrbit(60.0f, 12.0f);
+    if (!options.pathFile.empty() && !path.LoadFromFile(options.pathFile)) {
+        return 2;
+    }
+
+    LOG_INFO("相机飞行（无窗口）：载入场景...");
+    HeadlessScene scene;
+    LOG_INFO("相机飞行（无窗口）：预热 " << options.warmup << " 帧，记录 " << options.frames << " 帧...");
+
+    const float frameSeconds = 1.0f / 60.0f;
+    FrameTimeRecorder recorder(options.frames);
+    int total = options.warmup + options.frames;
+    for (int i = 0; i < total; ++i) {
+        // 预热期间停在起点；正式记录的帧走完整条路径（和主程序的 --benchmark 一样）
+        int frame = i - options.warmup;
+        float t = (frame > 0 && options.frames > 1) ? static_cast<float>(frame) / (options.frames - 1) : 0.0f;
+        path.Apply(scene.camera, t);
+
+        auto start = std::chrono::steady_clock::now();
+        scene.Update(frameSeconds);
+        double updateMs = ElapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        scene.Render();
+        double renderMs = ElapsedMs(start);
+
+        if (frame >= 0) {
+            recorder.AddFrame(static_cast<float>(updateMs), static_cast<float>(renderMs));
+        }
+    }
+
+    recorder.PrintSummary();
+    Log::Flush();
+    return options.csvFile.empty() || recorder.WriteCsv(options.csvFile) ? 0 : 2;
+}
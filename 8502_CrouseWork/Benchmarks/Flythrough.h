@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+
+// ========================================
+// 无窗口的相机飞行基准测试
+// ========================================
+// 和主程序的 --benchmark 一样：相机沿脚本路径（默认绕地形一圈，见 CameraPath.h）
+// 飞行，每帧按固定的 1/60 秒推进，先预热再逐帧记录，最后输出
+// 平均、p50 / p95 / p99、最差帧和每帧明细 CSV（见 FrameTimeRecorder.h）。
+//
+// 区别是 OpenGL 换成空实现（NullGL.h），不需要窗口和显卡，只测 CPU 这一侧：
+// 场景和 Renderer 的默认设置一样（自带高度图的地形、7 层水面 clipmap、
+// 128 网格的 FFT 海浪、水面分块、浅水模拟），每帧的工作也照着 Renderer 来：
+//   更新：相机跟随路径，水面网格跟随相机，模拟时钟推进海浪（60 Hz）和浅水（30 Hz），
+//         有新的海浪步时上传纹理，浅水网格按插值系数更新
+//   渲染：地形、水面、浅水的绘制（剔除、合并绘制区间；GL 调用不做事）
+// 没有 GPU，CSV 里的 gpu_ms 都是 -1
+// ========================================
+struct FlythroughOptions
+{
+    int frames = 1000;
+    int warmup = 60;
+    std::string pathFile;                   // 空 = 默认路径
+    std::string csvFile = "flythrough.csv";
+};
+
+// 成功返回 0；路径文件或 CSV 写入失败时返回 2
+int RunFlythrough(const FlythroughOptions& options);
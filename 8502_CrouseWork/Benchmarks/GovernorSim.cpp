@@ -0,0 +1,259 @@
+#include "GovernorSim.h"
+#include "FrameGovernor.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <string>
+
+namespace {
+    // ========================================
+    // 代价模型
+    // ========================================
+    // 负载为 1 时最高画质的一帧：GPU 14 毫秒（预算 16），CPU 8 毫秒。
+    // 各部分乘上对应那一项的级别系数，再乘负载曲线和随机抖动
+    // ========================================
+    const float TARGET_MS = 16.0f;
+    const int GPU_LATENCY = 3;
+
+    // GPU：固定开销、像素着色（∝ 分辨率²）、地形顶点、水面顶点（也随绘制距离减少）
+    const float GPU_FIXED = 2.0f;
+    const float GPU_FILL = 7.0f;
+    const float GPU_TERRAIN = 2.5f;
+    const float GPU_WATER = 2.5f;
+
+    // CPU：模拟（不受画质影响）、地形 LOD 选择和水面网格更新
+    const float CPU_SIMULATION = 6.0f;
+    const float CPU_TERRAIN = 0.5f;
+    const float CPU_WATER = 1.5f;
+
+    const float TERRAIN_FACTOR[FrameGovernor::LEVEL_COUNT] = { 1.0f, 0.55f, 0.35f, 0.25f };
+    const float DISTANCE_FACTOR[FrameGovernor::LEVEL_COUNT] = { 1.0f, 0.8f, 0.65f, 0.5f };
+
+    struct FrameCost
+    {
+        float cpu;
+        float gpu;
+    };
+
+    FrameCost ModelCost(const FrameGovernor& governor)
+    {
+        const FrameGovernor::Quality& q = governor.GetQuality();
+        float terrain = TERRAIN_FACTOR[governor.GetLevel(FrameGovernor::KNOB_TERRAIN_LOD)];
+        float water = (q.waterGridSize / 64.0f) * (q.waterGridSize / 64.0f) *
+                      DISTANCE_FACTOR[governor.GetLevel(FrameGovernor::KNOB_DRAW_DISTANCE)];
+
+        FrameCost cost;
+        cost.gpu = GPU_FIXED + GPU_FILL * q.renderScale * q.renderScale + GPU_TERRAIN * terrain + GPU_WATER * water;
+        cost.cpu = CPU_SIMULATION + CPU_TERRAIN * terrain + CPU_WATER * water;
+        return cost;
+    }
+
+    // 负载曲线：第 frame 帧的 CPU / GPU 负载倍数（1 = 正常）
+    struct Load
+    {
+        float cpu;
+        float gpu;
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        int frames;
+        float jitter;                               // 每帧随机抖动的幅度（±）
+        std::function<Load(int)> load;
+    };
+
+    struct Stats
+    {
+        int changes = 0;
+        int upgrades = 0;
+        int scaleChanges = 0;           // 渲染分辨率被调整的次数
+        int windowFrames = 0;           // 检查窗口里的帧数
+        int windowOver = 0;             // 其中超预算的帧数
+        int finalLevels[FrameGovernor::KNOB_COUNT] = {};
+    };
+
+    // 伪随机：std::mt19937 的输出序列由标准规定，各平台相同
+    float Uniform(std::mt19937& rng)
+    {
+        return (rng() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // 跑一个场景；checkFrom..checkTo 之间统计超预算的帧
+    Stats Simulate(const Scenario& scenario, int checkFrom, int checkTo)
+    {
+        FrameGovernor::Settings settings;
+        settings.targetMs = TARGET_MS;
+        FrameGovernor governor(settings);
+
+        std::mt19937 rng(20240611u);
+        std::deque<float> gpuInFlight;
+        Stats stats;
+
+        for (int frame = 0; frame < scenario.frames; ++frame) {
+            Load load = scenario.load(frame);
+            FrameCost cost = ModelCost(governor);
+            float cpu = cost.cpu * load.cpu * (1.0f + scenario.jitter * (Uniform(rng) * 2.0f - 1.0f));
+            float gpu = cost.gpu * load.gpu * (1.0f + scenario.jitter * (Uniform(rng) * 2.0f - 1.0f));
+
+            // 和 GpuTimer 一样晚几帧才拿到
+            gpuInFlight.push_back(gpu);
+            float gpuResult = -1.0f;
+            if (static_cast<int>(gpuInFlight.size()) > GPU_LATENCY) {
+                gpuResult = gpuInFlight.front();
+                gpuInFlight.pop_front();
+            }
+
+            if (frame >= checkFrom && frame < checkTo) {
+                ++stats.windowFrames;
+                stats.windowOver += std::max(cpu, gpu) > TARGET_MS * settings.overBudget ? 1 : 0;
+            }
+
+            int scaleBefore = governor.GetLevel(FrameGovernor::KNOB_RENDER_SCALE);
+            int sumBefore = 0;
+            for (int k = 0; k < FrameGovernor::KNOB_COUNT; ++k) {
+                sumBefore += governor.GetLevel(static_cast<FrameGovernor::Knob>(k));
+            }
+            if (governor.Update(cpu, gpuResult)) {
+                int sumAfter = 0;
+                for (int k = 0; k < FrameGovernor::KNOB_COUNT; ++k) {
+                    sumAfter += governor.GetLevel(static_cast<FrameGovernor::Knob>(k));
+                }
+                ++stats.changes;
+                stats.upgrades += sumAfter < sumBefore ? 1 : 0;
+                stats.scaleChanges += governor.GetLevel(FrameGovernor::KNOB_RENDER_SCALE) != scaleBefore ? 1 : 0;
+            }
+        }
+        for (int k = 0; k < FrameGovernor::KNOB_COUNT; ++k) {
+            stats.finalLevels[k] = governor.GetLevel(static_cast<FrameGovernor::Knob>(k));
+        }
+        return stats;
+    }
+
+    bool AllAtTop(const Stats& stats)
+    {
+        for (int k = 0; k < FrameGovernor::KNOB_COUNT; ++k) {
+            if (stats.finalLevels[k] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Report(std::ostream& out, const char* name, const Stats& stats, bool pass, const std::string& failure)
+    {
+        out << "  " << std::left << std::setw(18) << name << std::right
+            << std::setw(5) << stats.changes << " changes"
+            << std::setw(5) << stats.upgrades << " up";
+        if (stats.windowFrames > 0) {
+            out << std::fixed << std::setprecision(1) << std::setw(7)
+                << 100.0 * stats.windowOver / stats.windowFrames << "% over";
+        } else {
+            out << "             ";
+        }
+        out << "   levels";
+        for (int k = 0; k < FrameGovernor::KNOB_COUNT; ++k) {
+            out << " " << stats.finalLevels[k];
+        }
+        out << (pass ? "   PASS" : "   FAIL: ") << (pass ? "" : failure) << "\n";
+    }
+}
+
+int RunGovernorSimulation(std::ostream& out)
+{
+    out << "governor simulation (target " << TARGET_MS << " ms, gpu latency " << GPU_LATENCY << " frames)\n"
+        << "  levels = render_scale terrain_lod water_density draw_distance (0 = best)\n";
+    int failures = 0;
+
+    // 1. 平稳：负载在预算以内，不应该有任何调整
+    {
+        Scenario s = { "steady", 3000, 0.05f, [](int) { return Load{ 1.0f, 1.0f }; } };
+        Stats stats = Simulate(s, 0, s.frames);
+        bool pass = stats.changes == 0;
+        Report(out, s.name, stats, pass, "quality changed under a load that fits the budget");
+        failures += pass ? 0 : 1;
+    }
+
+    // 2. 卡顿：平稳负载上每隔几十帧有一帧 CPU 60 毫秒、GPU 翻 4 倍，不应该降画质
+    {
+        Scenario s = { "hitches", 3000, 0.05f, [](int frame) {
+            return Load{ frame % 47 == 0 ? 7.5f : 1.0f, frame % 53 == 0 ? 4.0f : 1.0f };
+        } };
+        Stats stats = Simulate(s, 0, s.frames);
+        bool pass = stats.changes == 0;
+        Report(out, s.name, stats, pass, "isolated hitches changed quality");
+        failures += pass ? 0 : 1;
+    }
+
+    // 3. 持续超载：GPU 负载 1.6 倍持续 1800 帧，之后恢复
+    //    开始 300 帧后超预算的帧不超过 5%，结束时回到最高画质
+    {
+        Scenario s = { "overload", 6000, 0.05f, [](int frame) {
+            return Load{ 1.0f, frame >= 600 && frame < 2400 ? 1.6f : 1.0f };
+        } };
+        Stats stats = Simulate(s, 900, 2400);
+        std::string failure;
+        if (stats.windowOver * 20 > stats.windowFrames) {
+            failure = "did not get back under budget";
+        } else if (!AllAtTop(stats)) {
+            failure = "did not restore full quality after the load went away";
+        } else if (stats.changes > 24) {
+            failure = "too many changes";
+        }
+        Report(out, s.name, stats, failure.empty(), failure);
+        failures += failure.empty() ? 0 : 1;
+    }
+
+    // 4. 负载慢慢变化：GPU 负载在 0.7 到 1.9 倍之间按正弦变化（周期 2000 帧）
+    //    大部分时间在预算以内，调整次数有上限
+    {
+        Scenario s = { "slow_wave", 8000, 0.05f, [](int frame) {
+            return Load{ 1.0f, 1.3f + 0.6f * static_cast<float>(std::sin(frame * 6.2831853 / 2000.0)) };
+        } };
+        Stats stats = Simulate(s, 0, s.frames);
+        std::string failure;
+        if (stats.windowOver * 10 > stats.windowFrames) {
+            failure = "over budget for more than 10% of frames";
+        } else if (stats.changes > 4 * 24) {
+            failure = "too many changes";
+        }
+        Report(out, s.name, stats, failure.empty(), failure);
+        failures += failure.empty() ? 0 : 1;
+    }
+
+    // 5. 贴着预算抖动：负载 1.15 倍、抖动 ±15%，最高画质下一半的帧超预算，
+    //    降一级就够；不应该反复升级又降级
+    {
+        Scenario s = { "noisy_borderline", 12000, 0.15f, [](int) { return Load{ 1.0f, 1.15f }; } };
+        Stats stats = Simulate(s, 0, s.frames);
+        std::string failure;
+        if (stats.changes > 12) {
+            failure = "oscillating";
+        }
+        Report(out, s.name, stats, failure.empty(), failure);
+        failures += failure.empty() ? 0 : 1;
+    }
+
+    // 6. CPU 瓶颈：模拟慢到超预算，渲染分辨率不应该被降低（它只省 GPU 时间）
+    //    其他各项降到底也没用，之后不应该再动
+    {
+        Scenario s = { "cpu_bound", 4000, 0.05f, [](int) { return Load{ 2.5f, 1.0f }; } };
+        Stats stats = Simulate(s, 0, s.frames);
+        std::string failure;
+        if (stats.scaleChanges > 0) {
+            failure = "lowered render scale while CPU bound";
+        } else if (stats.changes > (FrameGovernor::KNOB_COUNT - 1) * (FrameGovernor::LEVEL_COUNT - 1)) {
+            failure = "kept changing quality that cannot help";
+        }
+        Report(out, s.name, stats, failure.empty(), failure);
+        failures += failure.empty() ? 0 : 1;
+    }
+
+    out << (failures ? "governor simulation: " : "governor simulation: all passed")
+        << (failures ? std::to_string(failures) + " failed\n" : "\n");
+    return failures;
+}
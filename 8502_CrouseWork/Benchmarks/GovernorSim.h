@@ -0,0 +1,18 @@
+#pragma once
+#include <iosfwd>
+
+// ========================================
+// 帧时间预算控制器的模拟测试
+// ========================================
+// 不渲染任何东西：用一个简单的代价模型（每项画质每一级对 CPU / GPU 时间的影响）
+// 和合成的负载曲线（平稳、卡顿、持续超载、贴着预算抖动、CPU 瓶颈），
+// 逐帧算出 CPU 和 GPU 时间喂给 FrameGovernor，检查它的反应：
+//   - 负载没超时不动画质，单独的卡顿帧也不动
+//   - 持续超载时几百帧内回到预算以内，负载退去后恢复到最高画质
+//   - 负载贴着预算抖动时调整次数有上限（不来回震荡）
+//   - CPU 是瓶颈时不降渲染分辨率
+// GPU 时间和真实的计时查询一样晚 3 帧才拿到。随机数种子固定，每次结果相同。
+//
+// 每个场景输出一行统计，返回没通过的场景数
+// ========================================
+int RunGovernorSimulation(std::ostream& out);
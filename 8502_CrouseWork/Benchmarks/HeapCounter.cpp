@@ -0,0 +1,110 @@
+#include "HeapCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>  // _aligned_malloc
+#endif
+
+static std::atomic<long long> g_HeapAllocations(0);
+
+long long GetHeapAllocationCount()
+{
+    return g_HeapAllocations.load();
+}
+
+static void* Allocate(std::size_t size)
+{
+    g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* block = std::malloc(size ? size : 1);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+// MSVC 没有 aligned_alloc，对齐的块要用 _aligned_free 释放
+static void* AllocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    void* block = _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc 要求大小是对齐的整数倍
+    void* block = std::aligned_alloc(align, (size + align - 1) / align * align + (size ? 0 : align));
+#endif
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+static void FreeAligned(void* block)
+{
+#ifdef _MSC_VER
+    _aligned_free(block);
+#else
+    std::free(block);
+#endif
+}
+
+void* operator new(std::size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+    FreeAligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept
+{
+    FreeAligned(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(block);
+}
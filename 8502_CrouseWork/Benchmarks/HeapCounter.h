@@ -0,0 +1,11 @@
+#pragma once
+
+// ========================================
+// 堆分配计数（只链接进测试程序）
+// ========================================
+// HeapCounter.cpp 替换了全局的 operator new / new[]（包括对齐的版本）和
+// 对应的 operator delete / delete[]，每次分配计一次，所有线程一起算。
+// 放在单独的文件里：和调用 new 的代码在同一个文件时，GCC 内联以后会把
+// new 表达式和这里的 free 配对，报 -Wmismatched-new-delete
+// ========================================
+long long GetHeapAllocationCount();
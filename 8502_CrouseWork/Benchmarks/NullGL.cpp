@@ -0,0 +1,160 @@
+#include "NullGL.h"
+#include <cstring>
+#include <map>
+
+namespace {
+    GLuint nextName = 1;
+
+    // 缓冲记录
+    bool recordBuffers = false;
+    std::map<GLuint, std::vector<unsigned char>> bufferData;
+    std::map<GLenum, GLuint> lastAllocated;
+    GLuint arrayBinding = 0;
+    GLuint boundVertexArray = 0;
+    std::map<GLuint, GLuint> elementBindings;   // VAO → 索引缓冲（0 号 VAO 也有自己的）
+
+    GLuint& Binding(GLenum target)
+    {
+        return target == GL_ELEMENT_ARRAY_BUFFER ? elementBindings[boundVertexArray] : arrayBinding;
+    }
+
+    void GenerateNames(GLsizei n, GLuint* names)
+    {
+        for (GLsizei i = 0; i < n; ++i) {
+            names[i] = nextName++;
+        }
+    }
+
+    void APIENTRY GenBuffers(GLsizei n, GLuint* buffers) { GenerateNames(n, buffers); }
+    void APIENTRY GenTextures(GLsizei n, GLuint* textures) { GenerateNames(n, textures); }
+    void APIENTRY GenVertexArrays(GLsizei n, GLuint* arrays) { GenerateNames(n, arrays); }
+    void APIENTRY DeleteNames(GLsizei, const GLuint*) {}
+
+    void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        for (GLsizei i = 0; i < n; ++i) {
+            bufferData.erase(buffers[i]);
+        }
+    }
+
+    void APIENTRY BindVertexArray(GLuint array) { boundVertexArray = array; }
+
+    void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+    {
+        if (target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER) {
+            Binding(target) = buffer;
+        }
+    }
+
+    void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum)
+    {
+        if (!recordBuffers || (target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER)) {
+            return;
+        }
+        GLuint buffer = Binding(target);
+        std::vector<unsigned char>& contents = bufferData[buffer];
+        contents.assign(static_cast<size_t>(size), 0);
+        if (data && size > 0) {
+            memcpy(contents.data(), data, static_cast<size_t>(size));
+        }
+        lastAllocated[target] = buffer;
+    }
+
+    void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        if (!recordBuffers || (target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER)) {
+            return;
+        }
+        std::vector<unsigned char>& contents = bufferData[Binding(target)];
+        // 真正的 GL 在越界时报 GL_INVALID_VALUE 并忽略这次调用
+        if (offset < 0 || size < 0 || static_cast<size_t>(offset + size) > contents.size()) {
+            return;
+        }
+        memcpy(contents.data() + offset, data, static_cast<size_t>(size));
+    }
+
+    void APIENTRY Enum(GLenum) {}
+    void APIENTRY Name(GLuint) {}
+    void APIENTRY BindName(GLenum, GLuint) {}
+    void APIENTRY EnumInt(GLenum, GLint) {}
+    void APIENTRY TexParameteri(GLenum, GLenum, GLint) {}
+    void APIENTRY TexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) {}
+    void APIENTRY TexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*) {}
+    void APIENTRY TexImage3D(GLenum, GLint, GLint, GLsizei, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) {}
+    void APIENTRY VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+    void APIENTRY VertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void*) {}
+    void APIENTRY ObjectLabel(GLenum, GLuint, GLsizei, const GLchar*) {}
+    void APIENTRY DrawArrays(GLenum, GLint, GLsizei) {}
+    void APIENTRY DrawElements(GLenum, GLsizei, GLenum, const void*) {}
+    void APIENTRY MultiDrawElements(GLenum, const GLsizei*, GLenum, const void* const*, GLsizei) {}
+    GLint APIENTRY GetUniformLocation(GLuint, const GLchar*) { return -1; }
+    void APIENTRY Uniform1i(GLint, GLint) {}
+    void APIENTRY UniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+}
+
+void InstallNullGL()
+{
+    glad_glGenBuffers = GenBuffers;
+    glad_glGenTextures = GenTextures;
+    glad_glGenVertexArrays = GenVertexArrays;
+    glad_glDeleteBuffers = DeleteBuffers;
+    glad_glDeleteTextures = DeleteNames;
+    glad_glDeleteVertexArrays = DeleteNames;
+
+    glad_glActiveTexture = Enum;
+    glad_glDepthFunc = Enum;
+    glad_glGenerateMipmap = Enum;
+    glad_glBindVertexArray = BindVertexArray;
+    glad_glEnableVertexAttribArray = Name;
+    glad_glUseProgram = Name;
+    glad_glBindBuffer = BindBuffer;
+    glad_glBindTexture = BindName;
+    glad_glPixelStorei = EnumInt;
+    glad_glTexParameteri = TexParameteri;
+
+    glad_glBufferData = BufferData;
+    glad_glBufferSubData = BufferSubData;
+    glad_glTexImage2D = TexImage2D;
+    glad_glTexSubImage2D = TexSubImage2D;
+    glad_glTexImage3D = TexImage3D;
+    glad_glVertexAttribPointer = VertexAttribPointer;
+    glad_glVertexAttribIPointer = VertexAttribIPointer;
+    glad_glObjectLabel = ObjectLabel;
+
+    glad_glDrawArrays = DrawArrays;
+    glad_glDrawElements = DrawElements;
+    glad_glMultiDrawElements = MultiDrawElements;
+    glad_glGetUniformLocation = GetUniformLocation;
+    glad_glUniform1i = Uniform1i;
+    glad_glUniformMatrix4fv = UniformMatrix4fv;
+}
+
+void RecordNullGLBuffers(bool enabled)
+{
+    recordBuffers = enabled;
+    if (!enabled) {
+        bufferData.clear();
+        lastAllocated.clear();
+    }
+}
+
+const std::vector<unsigned char>* GetNullGLBufferData(GLuint buffer)
+{
+    auto it = bufferData.find(buffer);
+    return it == bufferData.end() ? nullptr : &it->second;
+}
+
+GLuint GetNullGLLastAllocatedBuffer(GLenum target)
+{
+    auto it = lastAllocated.find(target);
+    return it == lastAllocated.end() ? 0 : it->second;
+}
+
+size_t GetNullGLBufferBytes()
+{
+    size_t bytes = 0;
+    for (const auto& buffer : bufferData) {
+        bytes += buffer.second.size();
+    }
+    return bytes;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// ========================================
+// 空 OpenGL
+// ========================================
+// 把基准测试会用到的 glad 函数指针指向什么都不做的函数，
+// 这样 Terrain / Mesh / Texture / Skybox / WaterClipmap 不用窗口和显卡也能创建，
+// 在没有显示器的 Linux 上也能跑。
+//
+// glGen* 按顺序发不重复的非零 ID（IsLoaded 之类的检查靠它），其余调用直接返回，
+// 所以测到的只是 CPU 这一侧：解码、生成顶点、整理数据，不包括驱动复制和 GPU 上传。
+// 只覆盖上面这些类用到的函数，其他 GL 函数仍是空指针，调用会直接崩溃 ——
+// 给被测代码加了新的 GL 调用时在 NullGL.cpp 里补上。
+//
+// 测试可以打开缓冲记录：glBufferData / glBufferSubData 写入的内容按缓冲 ID 存一份，
+// 用来检查上传的顶点和索引（绑定按目标记录，索引缓冲的绑定和真正的 GL 一样属于 VAO）。
+// 记录要复制数据，基准测试不打开。
+// ========================================
+#include <glad/glad.h>
+#include <vector>
+
+void InstallNullGL();
+
+void RecordNullGLBuffers(bool enabled);
+
+// 缓冲的内容（没有记录过时返回 nullptr）
+const std::vector<unsigned char>* GetNullGLBufferData(GLuint buffer);
+
+// 最近一次对这个目标调用 glBufferData 的缓冲，用来找刚创建的对象的缓冲
+GLuint GetNullGLLastAllocatedBuffer(GLenum target);
+
+// 记录下来、还没有删除的缓冲一共多少字节（即 glBufferData 要求的大小之和），
+// 用来和显存统计（MemoryTracker）对照
+size_t GetNullGLBufferBytes();
@@ -0,0 +1,509 @@
+#include "FramePipeline.h"
+#include "SimulationClock.h"
+#include "SyntheticFrame.h"
+#include "Tests.h"
+#include "nclgl/InputStream.h"
+#include "nclgl/Log.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// ========================================
+// 固定步长模拟时钟
+// ========================================
+// 时间来源换成假时钟：测试自己决定每次 Tick 读到的时间
+// ========================================
+struct FakeTime
+{
+    double now = 0.0;
+
+    SimulationClock::TimeSource Source() { return [this]() { return now; }; }
+};
+
+static void TestClock(TestSuite& suite)
+{
+    // 帧时间随机（5 - 40 毫秒），每帧的步数随帧时间变化，
+    // 但总步数始终等于 floor(总时间 × 频率)，每步的 dt 固定
+    suite.Run("sim.clock.fixed_step_counts", [&]() {
+        FakeTime time;
+        SimulationClock clock(time.Source());
+        int steps = 0;
+        bool fixedDt = true;
+        int system = clock.AddSystem("physics", 60, 8, [&](float dt) {
+            ++steps;
+            fixedDt = fixedDt && dt == 1.0f / 60.0f;
+        });
+        TEST_CHECK_EQUAL(suite, system, 0);
+
+        // 第一次 Tick 只记下起点
+        time.now = 12.5;
+        TEST_CHECK_EQUAL(suite, clock.Tick(), 0);
+
+        std::mt19937 rng(37);
+        long long elapsed = 0;
+        for (int frame = 0; frame < 1000; ++frame) {
+            long long frameMicroseconds = 5000 + rng() % 35001;
+            elapsed += frameMicroseconds;
+            time.now = 12.5 + elapsed / 1e6;
+            int before = steps;
+            int executed = clock.Tick();
+            TEST_CHECK_EQUAL(suite, executed, steps - before);
+            TEST_CHECK_EQUAL(suite, clock.GetStepsThisFrame(system), executed);
+        }
+        TEST_CHECK(suite, fixedDt);
+        TEST_CHECK_EQUAL(suite, clock.GetTimeMicroseconds(), elapsed);
+        TEST_CHECK_EQUAL(suite, static_cast<long long>(steps), elapsed * 60 / SimulationClock::MICROSECONDS_PER_SECOND);
+        TEST_CHECK_EQUAL(suite, clock.GetStepCount(system), static_cast<long long>(steps));
+        TEST_CHECK_EQUAL(suite, clock.GetDroppedSteps(system), 0LL);
+
+        // 同样的帧时间直接用 Advance 喂，步数相同
+        SimulationClock replay;
+        int replaySteps = 0;
+        replay.AddSystem("physics", 60, 8, [&](float) { ++replaySteps; });
+        rng.seed(37);
+        for (int frame = 0; frame < 1000; ++frame) {
+            replay.Advance((5000 + rng() % 35001) / 1e6);
+        }
+        TEST_CHECK_EQUAL(suite, replaySteps, steps);
+    });
+
+    // 追帧上限：欠的步数超过上限时只执行上限步，其余丢弃，下一帧不再补；
+    // 超长帧先按 maxFrameSeconds 截断
+    suite.Run("sim.clock.catch_up_cap", [&]() {
+        SimulationClock clock(SimulationClock::TimeSource(), 0.25);
+        int steps = 0;
+        int system = clock.AddSystem("water", 60, 4, [&](float) { ++steps; });
+
+        // 0.2 秒：欠 12 步，执行 4 步，丢弃 8 步
+        TEST_CHECK_EQUAL(suite, clock.Advance(0.2), 4);
+        TEST_CHECK_EQUAL(suite, clock.GetDroppedSteps(system), 8LL);
+        TEST_CHECK_NEAR(suite, clock.GetSystemTime(system), 0.2, 1e-9);
+
+        // 正常的一帧只执行一步，不追之前丢掉的
+        TEST_CHECK_EQUAL(suite, clock.Advance(1.0 / 60.0), 1);
+        TEST_CHECK_EQUAL(suite, clock.GetDroppedSteps(system), 8LL);
+
+        // 3 秒的断点帧截断成 0.25 秒：欠 15 步，执行 4 步，丢弃 11 步
+        TEST_CHECK_EQUAL(suite, clock.Advance(3.0), 4);
+        TEST_CHECK_NEAR(suite, clock.GetFrameSeconds(), 0.25, 1e-9);
+        TEST_CHECK_EQUAL(suite, clock.GetDroppedSteps(system), 19LL);
+        TEST_CHECK_EQUAL(suite, clock.GetStepCount(system) + clock.GetDroppedSteps(system),
+                         clock.GetTimeMicroseconds() * 60 / SimulationClock::MICROSECONDS_PER_SECOND);
+
+        // 禁用期间不积累欠的步数，重新启用后从当前时刻开始
+        clock.SetSystemEnabled(system, false);
+        TEST_CHECK_EQUAL(suite, clock.Advance(0.2), 0);
+        clock.SetSystemEnabled(system, true);
+        TEST_CHECK_EQUAL(suite, clock.Advance(1.0 / 60.0), 1);
+        TEST_CHECK_EQUAL(suite, clock.GetDroppedSteps(system), 19LL);
+        TEST_CHECK_EQUAL(suite, steps, 10);
+
+        // 无效参数（预期的错误信息不输出）
+        LogLevel level = Log::GetLevel();
+        Log::SetLevel(LOG_LEVEL_NONE);
+        TEST_CHECK_EQUAL(suite, clock.AddSystem("bad", 0, 4, [](float) {}), -1);
+        TEST_CHECK_EQUAL(suite, clock.AddSystem("bad", 30, 0, [](float) {}), -1);
+        Log::SetLevel(level);
+    });
+
+    // 30 Hz 和 60 Hz 两个系统在同一帧里按步的时刻交替执行，同一时刻先注册的先执行
+    suite.Run("sim.clock.interleave_30_60", [&]() {
+        SimulationClock clock;
+        std::string order;
+        std::vector<double> stepTimes;
+        long long waterSteps = 0;
+        long long animationSteps = 0;
+        clock.AddSystem("water", 30, 10, [&](float) {
+            order += 'W';
+            stepTimes.push_back(++waterSteps / 30.0);
+        });
+        clock.AddSystem("animation", 60, 10, [&](float) {
+            order += 'A';
+            stepTimes.push_back(++animationSteps / 60.0);
+        });
+
+        TEST_CHECK_EQUAL(suite, clock.Advance(0.1), 9);
+        TEST_CHECK_EQUAL(suite, order, std::string("AWAAWAAWA"));
+
+        // 帧时间不规则时，全部步的时刻仍然单调不减
+        std::mt19937 rng(3060);
+        for (int frame = 0; frame < 500; ++frame) {
+            clock.Advance((1000 + rng() % 60000) / 1e6);
+        }
+        bool ordered = true;
+        for (size_t i = 1; i < stepTimes.size(); ++i) {
+            ordered = ordered && stepTimes[i] >= stepTimes[i - 1];
+        }
+        TEST_CHECK(suite, ordered);
+        TEST_CHECK_EQUAL(suite, animationSteps, waterSteps * 2 + (animationSteps % 2));
+    });
+
+    // 插值系数 = 当前时刻超出最后一个整步的部分 / 步长；
+    // 没有丢步时，系统时间 + alpha × 步长 = 时钟时间
+    suite.Run("sim.clock.alpha", [&]() {
+        FakeTime time;
+        SimulationClock clock(time.Source());
+        int water = clock.AddSystem("water", 30, 4, [](float) {});
+        int animation = clock.AddSystem("animation", 60, 4, [](float) {});
+        clock.Tick();
+
+        time.now = 0.05;
+        clock.Tick();
+        TEST_CHECK_EQUAL(suite, clock.GetStepCount(water), 1LL);
+        TEST_CHECK_NEAR(suite, clock.GetAlpha(water), 0.5, 1e-6);
+        TEST_CHECK_EQUAL(suite, clock.GetStepCount(animation), 3LL);
+        TEST_CHECK_NEAR(suite, clock.GetAlpha(animation), 0.0, 1e-6);
+
+        time.now = 0.06;
+        clock.Tick();
+        TEST_CHECK_NEAR(suite, clock.GetAlpha(water), 0.8, 1e-6);
+        TEST_CHECK_NEAR(suite, clock.GetAlpha(animation), 0.6, 1e-6);
+
+        std::mt19937 rng(7);
+        bool consistent = true;
+        bool inRange = true;
+        for (int frame = 0; frame < 300; ++frame) {
+            time.now += (2000 + rng() % 30000) / 1e6;
+            clock.Tick();
+            for (int system : { water, animation }) {
+                double alpha = clock.GetAlpha(system);
+                inRange = inRange && alpha >= 0.0 && alpha < 1.0;
+                double reconstructed = clock.GetSystemTime(system) + alpha * clock.GetStepSeconds(system);
+                consistent = consistent && std::fabs(reconstructed - clock.GetTime()) < 1e-6;
+            }
+        }
+        TEST_CHECK(suite, inRange);
+        TEST_CHECK(suite, consistent);
+    });
+}
+
+// ========================================
+// 输入录制与回放
+// ========================================
+// 用合成的键盘 / 鼠标状态驱动 InputStream（与 InputRecorder 用的是同一份
+// 编码），不需要 Windows 的 Keyboard / Mouse
+// ========================================
+static const unsigned int TEST_KEYS = 200;     // 小于 256，好构造越界的键码
+static const unsigned int TEST_BUTTONS = 3;
+static const size_t HEADER_BYTES = 16;
+
+// 录下来的一段输入：每帧的状态、帧时间、累计时间，以及每帧结束时的文件偏移
+struct Recording
+{
+    std::vector<InputStream::State> states;
+    std::vector<float> msec;
+    std::vector<double> timestamps;
+    std::vector<size_t> frameEnds;
+    std::vector<size_t> firstEvent;     // 每帧第一个事件的偏移（没有事件时为 0）
+    std::vector<unsigned char> bytes;
+};
+
+static size_t EventBytes(const InputStream::Event& e)
+{
+    switch (e.type) {
+    case InputStream::EVENT_KEY:
+    case InputStream::EVENT_BUTTON:
+        return 3;
+    case InputStream::EVENT_RELATIVE:
+    case InputStream::EVENT_ABSOLUTE:
+        return 9;
+    default:
+        return 2;
+    }
+}
+
+static size_t VarintBytes(size_t value)
+{
+    size_t bytes = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++bytes;
+    }
+    return bytes;
+}
+
+static std::vector<unsigned char> ReadBytes(const std::string& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+static void WriteBytes(const std::string& path, const std::vector<unsigned char>& bytes, size_t size)
+{
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(bytes.data()), size);
+}
+
+static bool SameState(const InputStream::State& a, const InputStream::State& b)
+{
+    return a.keys == b.keys && a.keyHolds == b.keyHolds && a.buttons == b.buttons &&
+           a.buttonHolds == b.buttonHolds && a.doubleClicks == b.doubleClicks &&
+           a.relative.x == b.relative.x && a.relative.y == b.relative.y &&
+           a.absolute.x == b.absolute.x && a.absolute.y == b.absolute.y && a.wheel == b.wheel;
+}
+
+// 随机输入：每帧改动少量按键，鼠标时动时停，约四分之一的帧完全不变（零事件）
+static Recording RecordSynthetic(const std::string& path, int frames, unsigned int seed)
+{
+    Recording recording;
+    InputStream stream(TEST_KEYS, TEST_BUTTONS);
+    InputStream::State state;
+    stream.ResetState(state);
+    std::mt19937 rng(seed);
+
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_NONE);
+    stream.StartRecording(path);
+    size_t offset = HEADER_BYTES;
+    for (int frame = 0; frame < frames; ++frame) {
+        if (rng() % 4 != 0) {
+            for (unsigned int i = rng() % 4; i > 0; --i) {
+                unsigned int key = rng() % TEST_KEYS;
+                state.keyHolds[key] = state.keys[key];
+                state.keys[key] = rng() % 2;
+            }
+            unsigned int button = rng() % TEST_BUTTONS;
+            state.buttonHolds[button] = state.buttons[button];
+            state.buttons[button] = rng() % 2;
+            state.doubleClicks[button] = rng() % 8 == 0;
+            bool moving = rng() % 2 == 0;
+            state.relative = moving ? Vector2((int)(rng() % 41) - 20.0f, (int)(rng() % 41) - 20.0f) : Vector2(0.0f, 0.0f);
+            state.absolute = state.absolute + state.relative;
+            state.wheel = (int)(rng() % 7) - 3;
+        }
+        float msec = 5.0f + (rng() % 30000) / 1000.0f;
+        stream.RecordFrame(state, msec);
+
+        const std::vector<InputStream::Event>& events = stream.GetFrameEvents();
+        size_t header = sizeof(float) + VarintBytes(events.size());
+        recording.firstEvent.push_back(events.empty() ? 0 : offset + header);
+        offset += header;
+        for (const InputStream::Event& e : events) {
+            offset += EventBytes(e);
+        }
+        recording.states.push_back(state);
+        recording.msec.push_back(msec);
+        recording.timestamps.push_back(stream.GetTimestampMSec());
+        recording.frameEnds.push_back(offset);
+    }
+    stream.Stop();
+    Log::SetLevel(level);
+
+    recording.bytes = ReadBytes(path);
+    return recording;
+}
+
+// 回放一个文件，返回成功回放的帧数；每帧与录制时比对
+static int Replay(const std::string& path, const Recording& recording, bool& started, bool& damaged, bool& matches)
+{
+    InputStream stream(TEST_KEYS, TEST_BUTTONS);
+    InputStream::State state;
+    stream.ResetState(state);
+    float msec = 0.0f;
+    matches = true;
+
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_NONE);
+    started = stream.StartReplay(path);
+    int frames = 0;
+    while (started && stream.ReplayFrame(state, msec)) {
+        matches = matches && frames < (int)recording.states.size() &&
+                  SameState(state, recording.states[frames]) && msec == recording.msec[frames] &&
+                  stream.GetTimestampMSec() == recording.timestamps[frames];
+        ++frames;
+    }
+    damaged = stream.IsDamaged();
+    // 损坏之后不再回放后面的帧
+    bool stopped = !stream.ReplayFrame(state, msec);
+    matches = matches && stopped && stream.GetFrameCount() == frames;
+    Log::SetLevel(level);
+    return frames;
+}
+
+static void TestInputReplay(TestSuite& suite)
+{
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    std::string recordingPath = (directory / "csc8502_input_test.ncli").string();
+    std::string damagedPath = (directory / "csc8502_input_damaged.ncli").string();
+
+    // 录制再回放：每帧的状态、帧时间和累计时间都与录制时逐位相同
+    suite.Run("sim.input.replay_determinism", [&]() {
+        Recording recording = RecordSynthetic(recordingPath, 500, 39);
+        TEST_CHECK_EQUAL(suite, recording.bytes.size(), recording.frameEnds.back());
+
+        bool started, damaged, matches;
+        int frames = Replay(recordingPath, recording, started, damaged, matches);
+        TEST_CHECK(suite, started);
+        TEST_CHECK_EQUAL(suite, frames, 500);
+        TEST_CHECK(suite, !damaged);
+        TEST_CHECK(suite, matches);
+
+        // 同一个文件回放两次，结果相同
+        frames = Replay(recordingPath, recording, started, damaged, matches);
+        TEST_CHECK_EQUAL(suite, frames, 500);
+        TEST_CHECK(suite, matches);
+    });
+
+    // 截断：在每个字节处截断，截在帧边界上是干净的结尾，否则在残缺的那一帧
+    // 报损坏；之前的帧照常回放。文件头不完整时 StartReplay 失败
+    suite.Run("sim.input.truncated", [&]() {
+        Recording recording = RecordSynthetic(recordingPath, 60, 40);
+        bool allMatch = true;
+        bool framesCorrect = true;
+        bool damageCorrect = true;
+        for (size_t cut = 0; cut < recording.bytes.size(); ++cut) {
+            WriteBytes(damagedPath, recording.bytes, cut);
+            bool started, damaged, matches;
+            int frames = Replay(damagedPath, recording, started, damaged, matches);
+            if (cut < HEADER_BYTES) {
+                TEST_CHECK(suite, !started);
+                continue;
+            }
+            int complete = 0;
+            bool boundary = cut == HEADER_BYTES;
+            for (size_t end : recording.frameEnds) {
+                if (end <= cut) {
+                    ++complete;
+                }
+                boundary = boundary || end == cut;
+            }
+            allMatch = allMatch && started && matches;
+            framesCorrect = framesCorrect && frames == complete;
+            damageCorrect = damageCorrect && damaged == !boundary;
+        }
+        TEST_CHECK(suite, allMatch);
+        TEST_CHECK(suite, framesCorrect);
+        TEST_CHECK(suite, damageCorrect);
+    });
+
+    // 损坏：未知的事件类型、越界的键码都让回放停在那一帧
+    suite.Run("sim.input.corrupt", [&]() {
+        Recording recording = RecordSynthetic(recordingPath, 60, 41);
+        size_t frame = 30;
+        while (frame < recording.firstEvent.size() && recording.firstEvent[frame] == 0) {
+            ++frame;
+        }
+        TEST_CHECK(suite, frame < recording.firstEvent.size());
+        size_t position = recording.firstEvent[frame];
+
+        std::vector<unsigned char> bytes = recording.bytes;
+        bytes[position] = 9;
+        WriteBytes(damagedPath, bytes, bytes.size());
+        bool started, damaged, matches;
+        int frames = Replay(damagedPath, recording, started, damaged, matches);
+        TEST_CHECK(suite, started);
+        TEST_CHECK_EQUAL(suite, frames, (int)frame);
+        TEST_CHECK(suite, damaged);
+        TEST_CHECK(suite, matches);
+
+        // 找第一个按键事件，把键码改成越界值
+        size_t keyFrame = recording.frameEnds.size();
+        for (size_t i = 0; i < recording.firstEvent.size() && keyFrame == recording.frameEnds.size(); ++i) {
+            if (recording.firstEvent[i] != 0 && recording.bytes[recording.firstEvent[i]] == InputStream::EVENT_KEY) {
+                keyFrame = i;
+            }
+        }
+        TEST_CHECK(suite, keyFrame < recording.frameEnds.size());
+        bytes = recording.bytes;
+        bytes[recording.firstEvent[keyFrame] + 1] = (unsigned char)TEST_KEYS;
+        WriteBytes(damagedPath, bytes, bytes.size());
+        frames = Replay(damagedPath, recording, started, damaged, matches);
+        TEST_CHECK_EQUAL(suite, frames, (int)keyFrame);
+        TEST_CHECK(suite, damaged);
+        TEST_CHECK(suite, matches);
+
+        // 文件头：错误的标识、或者键数不同的录制都不能回放
+        bytes = recording.bytes;
+        bytes[0] = 'X';
+        WriteBytes(damagedPath, bytes, bytes.size());
+        Replay(damagedPath, recording, started, damaged, matches);
+        TEST_CHECK(suite, !started);
+
+        InputStream other(TEST_KEYS + 1, TEST_BUTTONS);
+        LogLevel level = Log::GetLevel();
+        Log::SetLevel(LOG_LEVEL_NONE);
+        TEST_CHECK(suite, !other.StartReplay(recordingPath));
+        Log::SetLevel(level);
+    });
+
+    std::filesystem::remove(recordingPath, error);
+    std::filesystem::remove(damagedPath, error);
+}
+
+// ========================================
+// 帧流水线
+// ========================================
+// FramePipeline 驱动合成的帧负载（SyntheticFrame），不需要窗口和 GL
+// ========================================
+static void TestPipeline(TestSuite& suite)
+{
+    // 顺序：串行模式第 N 帧渲染第 N 帧的更新，流水线模式渲染第 N-1 帧的
+    // （第一帧没有快照）；每帧的帧时间交给同一帧的更新；
+    // 发布不和更新重叠，发布和渲染都在主线程上
+    suite.Run("sim.pipeline.frame_order", [&]() {
+        for (bool pipelined : { false, true }) {
+            SyntheticFrame::Settings settings;
+            settings.updateWork = 2000;
+            settings.renderWork = 1000;
+            SyntheticFrame frame(settings);
+            FramePipeline pipeline(frame, pipelined);
+            TEST_CHECK(suite, pipeline.IsPipelined() == pipelined);
+
+            const int FRAMES = 200;
+            std::vector<float> msec;
+            for (int i = 0; i < FRAMES; ++i) {
+                msec.push_back(10.0f + i * 0.25f);
+                pipeline.RunFrame(msec.back());
+            }
+
+            bool order = frame.GetRenderedFrames().size() == FRAMES;
+            for (int i = 0; order && i < FRAMES; ++i) {
+                order = frame.GetRenderedFrames()[i] == (pipelined ? i : i + 1);
+            }
+            TEST_CHECK(suite, order);
+            TEST_CHECK(suite, frame.GetUpdateMsec() == msec);
+            TEST_CHECK_EQUAL(suite, frame.GetViolations(), 0);
+        }
+    });
+
+    // 重叠：渲染里有一段不占 CPU 的等待（像交换缓冲时等 GPU），流水线模式下
+    // 下一帧的更新在这段时间里执行，整帧时间明显小于更新和渲染之和；
+    // 串行模式下整帧时间就是两者之和
+    suite.Run("sim.pipeline.overlap", [&]() {
+        SyntheticFrame::Settings settings;
+        settings.updateWork = 100000;
+        settings.renderWaitMs = 3.0f;
+        for (bool pipelined : { false, true }) {
+            SyntheticFrame frame(settings);
+            FramePipeline pipeline(frame, pipelined);
+            pipeline.RunFrame(16.0f);
+
+            double frameMs = 0.0;
+            double stageMs = 0.0;
+            for (int i = 0; i < 30; ++i) {
+                FramePipeline::Timing timing = pipeline.RunFrame(16.0f);
+                frameMs += timing.frameMs;
+                stageMs += timing.updateMs + timing.renderMs;
+            }
+            if (pipelined) {
+                TEST_CHECK(suite, frameMs < 0.85 * stageMs);
+            } else {
+                TEST_CHECK(suite, frameMs >= 0.99 * stageMs);
+            }
+            TEST_CHECK_EQUAL(suite, frame.GetViolations(), 0);
+        }
+    });
+}
+
+void RunSimulationTests(TestSuite& suite)
+{
+    TestClock(suite);
+    TestInputReplay(suite);
+    TestPipeline(suite);
+}
@@ -0,0 +1,53 @@
+#include "SyntheticFrame.h"
+#include <chrono>
+#include <cmath>
+
+SyntheticFrame::SyntheticFrame(const Settings& settings)
+    : m_Settings(settings)
+    , m_MainThread(std::this_thread::get_id())
+    , m_Updating(false)
+    , m_Violations(0)
+    , m_UpdatedFrame(0)
+    , m_PublishedFrame(0)
+    , m_UpdateResult(0.0f)
+    , m_RenderResult(0.0f)
+{
+}
+
+float SyntheticFrame::Work(int iterations, float seed)
+{
+    float value = seed;
+    for (int i = 0; i < iterations; ++i) {
+        value = std::sin(value) * 0.5f + 1.0f;
+    }
+    return value;
+}
+
+void SyntheticFrame::UpdateScene(float msec)
+{
+    m_Updating = true;
+    m_UpdateMsec.push_back(msec);
+    m_UpdateResult += Work(m_Settings.updateWork, msec);
+    ++m_UpdatedFrame;
+    m_Updating = false;
+}
+
+void SyntheticFrame::PublishFrame()
+{
+    if (m_Updating || std::this_thread::get_id() != m_MainThread) {
+        ++m_Violations;
+    }
+    m_PublishedFrame = m_UpdatedFrame;
+}
+
+void SyntheticFrame::RenderScene()
+{
+    if (std::this_thread::get_id() != m_MainThread) {
+        ++m_Violations;
+    }
+    m_Rendered.push_back(m_PublishedFrame);
+    m_RenderResult += Work(m_Settings.renderWork, static_cast<float>(m_PublishedFrame));
+    if (m_Settings.renderWaitMs > 0.0f) {
+        std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(m_Settings.renderWaitMs));
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "FramePipeline.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// ========================================
+// 合成的帧负载
+// ========================================
+// 代替 Renderer 交给 FramePipeline，不需要窗口和 GL：
+//   UpdateScene   做 updateWork 次迭代的计算，把帧号写进更新快照
+//   PublishFrame  把更新快照交给渲染
+//   RenderScene   做 renderWork 次迭代的计算，再睡 renderWaitMs 毫秒
+//                 （相当于交换缓冲时等垂直同步 / 等 GPU，这段时间不占 CPU）
+// 计算量按迭代次数给而不是按时间，线程多于核时被抢占也不会多算。
+//
+// 每帧渲染的是哪一帧的快照、每次更新拿到的帧时间都记下来：串行模式渲染
+// 这一帧刚更新的快照，流水线模式渲染上一帧的（第一帧还没有快照，记为 0）。
+// 同时检查 FramePipeline 的约定：PublishFrame 不和 UpdateScene 同时执行，
+// 发布和渲染都在创建它的线程（主线程）上
+// ========================================
+class SyntheticFrame : public FrameStages
+{
+public:
+    struct Settings
+    {
+        int updateWork = 0;
+        int renderWork = 0;
+        float renderWaitMs = 0.0f;
+    };
+
+    explicit SyntheticFrame(const Settings& settings);
+
+    void UpdateScene(float msec) override;
+    void PublishFrame() override;
+    void RenderScene() override;
+
+    // 每次 RenderScene 画的快照是第几帧的更新（从 1 开始，0 = 还没有）
+    const std::vector<int>& GetRenderedFrames() const { return m_Rendered; }
+    // 每次 UpdateScene 拿到的帧时间
+    const std::vector<float>& GetUpdateMsec() const { return m_UpdateMsec; }
+    // 违反约定的次数：发布时更新还在进行，或者发布 / 渲染不在主线程上
+    int GetViolations() const { return m_Violations.load(); }
+
+    float GetResult() const { return m_UpdateResult + m_RenderResult; }
+
+private:
+    static float Work(int iterations, float seed);
+
+    Settings m_Settings;
+    std::thread::id m_MainThread;
+    std::atomic<bool> m_Updating;
+    std::atomic<int> m_Violations;
+    int m_UpdatedFrame;     // 更新快照
+    int m_PublishedFrame;   // 已发布的快照
+    std::vector<int> m_Rendered;
+    std::vector<float> m_UpdateMsec;
+    // 计算结果留着，免得被编译器优化掉；更新和渲染可能同时执行，各写各的
+    float m_UpdateResult;
+    float m_RenderResult;
+};
@@ -0,0 +1,729 @@
+#include "NullGL.h"
+#include "Tests.h"
+#include "Terrain.h"
+#include "TerrainBake.h"
+#include "TerrainEditor.h"
+#include "TerrainErosion.h"
+#include "TerrainNoise.h"
+#include "TerrainSplat.h"
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/Log.h"
+#include "nclgl/common.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ========================================
+// 噪声
+// ========================================
+// 尺寸故意不是图块边长（64）和 SIMD 宽度（4）的倍数，边上的图块和行尾都要走到
+// ========================================
+static void TestNoise(TestSuite& suite)
+{
+    const int width = 301;
+    const int height = 257;
+    TerrainNoise noise(1337);
+
+    TerrainNoise::Settings fbm;
+    TerrainNoise::Settings ridged;
+    ridged.basis = TerrainNoise::Basis::Gradient;
+    ridged.ridged = true;
+    TerrainNoise::Settings warp;
+    warp.warpStrength = 0.5f;
+    const TerrainNoise::Settings variants[] = { fbm, ridged, warp };
+
+    suite.Run("terrain.noise.thread_invariance", [&]() {
+        for (const TerrainNoise::Settings& settings : variants) {
+            std::vector<float> reference;
+            noise.Generate(settings, reference, width, height, 1);
+            uint64_t expected = HashArray(reference);
+            for (unsigned int threads : TestThreadCounts()) {
+                std::vector<float> heights;
+                noise.Generate(settings, heights, width, height, threads);
+                TEST_CHECK_EQUAL(suite, HashArray(heights), expected);
+            }
+        }
+    });
+
+    // 单点采样和批量生成走同一条 SIMD 路径，结果应当逐位相同
+    suite.Run("terrain.noise.sample_matches_generate", [&]() {
+        for (const TerrainNoise::Settings& settings : variants) {
+            std::vector<float> heights;
+            noise.Generate(settings, heights, width, height);
+            const int points[][2] = { { 0, 0 }, { width - 1, 0 }, { 123, 45 }, { 299, 256 }, { 64, 128 } };
+            for (const auto& p : points) {
+                float u = p[0] * (1.0f / (width - 1));
+                float v = p[1] * (1.0f / (height - 1));
+                TEST_CHECK_EQUAL(suite, noise.Sample(settings, u, v), heights[p[1] * width + p[0]]);
+            }
+        }
+    });
+}
+
+// ========================================
+// 侵蚀
+// ========================================
+// 图块是 128 格，地图取 3×3 个图块多一点，2×2 着色的四个阶段都有多个图块
+// ========================================
+static void TestErosion(TestSuite& suite)
+{
+    const int width = 400;
+    const int height = 390;
+    const int iterations = 3;
+    TerrainNoise noise(7);
+    std::vector<float> start;
+    noise.Generate(TerrainNoise::Settings(), start, width, height);
+
+    TerrainErosion::Settings settings;
+    settings.dropletsPerTile = 128;
+
+    suite.Run("terrain.erosion.thread_invariance", [&]() {
+        std::vector<float> reference = start;
+        TerrainErosion(settings, 1).Run(reference, width, height, iterations);
+        TEST_CHECK(suite, HashArray(reference) != HashArray(start));
+
+        uint64_t expected = HashArray(reference);
+        for (unsigned int threads : TestThreadCounts()) {
+            std::vector<float> heights = start;
+            TerrainErosion(settings, threads).Run(heights, width, height, iterations);
+            TEST_CHECK_EQUAL(suite, HashArray(heights), expected);
+        }
+    });
+
+    // 每帧跑一次迭代和一次跑完结果相同
+    suite.Run("terrain.erosion.incremental_matches_batch", [&]() {
+        std::vector<float> batch = start;
+        TerrainErosion(settings).Run(batch, width, height, iterations);
+
+        std::vector<float> stepped = start;
+        TerrainErosion erosion(settings);
+        for (int i = 0; i < iterations; ++i) {
+            erosion.Run(stepped, width, height, 1);
+        }
+        TEST_CHECK_EQUAL(suite, erosion.GetIterationCount(), iterations);
+        TEST_CHECK_EQUAL(suite, HashArray(stepped), HashArray(batch));
+    });
+}
+
+// ========================================
+// 编辑：脏区域局部更新
+// ========================================
+// 同一块噪声地形建两份：edited 用笔刷修改后 UpdateDirtyRegions，
+// reference 拿到同样的高度后 RebuildMesh 全量重建。NullGL 记下两边上传的顶点缓冲，
+// 每一步之后逐字节比较（位置、法向量、纹理坐标），
+// 再从几个相机位置 SelectLod 比较绘制的三角形数（各块的几何误差也要一样）。
+// 161 × 161 的地形是 5 × 5 个 LOD 块，笔刷放在块的边角和地图的边角上
+// ========================================
+static bool SameVertexBuffer(GLuint a, GLuint b)
+{
+    const std::vector<unsigned char>* dataA = GetNullGLBufferData(a);
+    const std::vector<unsigned char>* dataB = GetNullGLBufferData(b);
+    return dataA && dataB && !dataA->empty() && dataA->size() == dataB->size() &&
+           memcmp(dataA->data(), dataB->data(), dataA->size()) == 0;
+}
+
+static bool SameLodSelection(Terrain& a, Terrain& b)
+{
+    const float half = a.GetTerrainSize() * 0.5f;
+    const Vector3 cameras[] = {
+        Vector3(0.0f, 20.0f, 0.0f), Vector3(-half, 5.0f, -half),
+        Vector3(half * 0.5f, 40.0f, -half * 0.3f), Vector3(half, 2.0f, 0.0f)
+    };
+    for (const Vector3& camera : cameras) {
+        a.SelectLod(camera, 600.0f, 1.0f);
+        b.SelectLod(camera, 600.0f, 1.0f);
+        a.Render();
+        b.Render();
+        if (a.GetDrawnTriangleCount() != b.GetDrawnTriangleCount()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestEditing(TestSuite& suite)
+{
+    suite.Run("terrain.edit.dirty_regions_match_rebuild", [&]() {
+        RecordNullGLBuffers(true);
+        TerrainNoise noise(3);
+        TerrainNoise::Settings settings;
+
+        Terrain edited(noise, settings, 161);
+        GLuint editedBuffer = GetNullGLLastAllocatedBuffer(GL_ARRAY_BUFFER);
+        Terrain reference(noise, settings, 161);
+        GLuint referenceBuffer = GetNullGLLastAllocatedBuffer(GL_ARRAY_BUFFER);
+        // 释放了顶点副本的地形改高度时走整体重建，结果也要一样
+        Terrain released(noise, settings, 161);
+        GLuint releasedBuffer = GetNullGLLastAllocatedBuffer(GL_ARRAY_BUFFER);
+        released.ReleaseCpuCopies();
+
+        TEST_CHECK(suite, editedBuffer != referenceBuffer && SameVertexBuffer(editedBuffer, referenceBuffer));
+
+        // 网格坐标 → 世界坐标（和 Terrain::WorldToGridX 相反）
+        const float cell = edited.GetTerrainSize() / (edited.GetWidth() - 1);
+        const float half = edited.GetTerrainSize() * 0.5f;
+        auto world = [&](float grid) { return grid * cell - half; };
+
+        struct Stroke
+        {
+            TerrainEditor::Brush brush;
+            float gridX, gridZ, radius, strength;
+        };
+        typedef TerrainEditor::Brush Brush;
+        // 每组笔刷画完后更新一次；同一组里的笔刷可能合并成一个脏区域，也可能各自一个
+        const std::vector<std::vector<Stroke>> groups = {
+            { { Brush::Raise, 32.0f, 32.0f, 3.0f, 0.2f } },             // 四个块的公共角
+            { { Brush::Lower, 64.0f, 100.0f, 2.0f, 0.15f } },           // 块的竖边
+            { { Brush::Flatten, 0.0f, 0.0f, 4.0f, 0.8f } },             // 地图左上角
+            { { Brush::Smooth, 160.0f, 80.0f, 5.0f, 0.7f } },           // 地图右边
+            { { Brush::Raise, 160.0f, 160.0f, 1.5f, 0.3f } },           // 地图右下角
+            { { Brush::Smooth, 96.0f, 0.0f, 3.0f, 1.0f } },             // 地图上边、块的边
+            { { Brush::Raise, 40.0f, 120.0f, 1.0f, 0.1f },              // 相邻，合并成一个区域
+              { Brush::Lower, 42.0f, 120.0f, 1.0f, 0.1f } },
+            { { Brush::Raise, 10.0f, 60.0f, 1.5f, 0.2f },               // 相距较远，两个区域
+              { Brush::Flatten, 140.0f, 20.0f, 2.0f, 1.0f } }
+        };
+
+        int step = 0;
+        for (const std::vector<Stroke>& group : groups) {
+            TerrainEditor editor(edited);
+            for (const Stroke& stroke : group) {
+                editor.Apply(stroke.brush, world(stroke.gridX), world(stroke.gridZ),
+                             stroke.radius * cell, stroke.strength);
+            }
+            edited.UpdateDirtyRegions();
+            reference.GetHeightData() = edited.GetHeightData();
+            reference.RebuildMesh();
+            released.GetHeightData() = edited.GetHeightData();
+            released.MarkDirty(0, 0, released.GetWidth() - 1, released.GetHeight() - 1);
+            released.UpdateDirtyRegions();
+
+            bool same = SameVertexBuffer(editedBuffer, referenceBuffer);
+            if (!TEST_CHECK(suite, same)) {
+                std::cout << "        （第 " << step << " 组笔刷之后顶点不同）\n";
+            }
+            TEST_CHECK(suite, SameVertexBuffer(releasedBuffer, referenceBuffer));
+            TEST_CHECK(suite, SameLodSelection(edited, reference));
+            ++step;
+        }
+
+        // 两个区域之间只隔一格：边界的法向量要用到两边更新后的位置
+        std::vector<float>& heights = edited.GetHeightData();
+        const int width = edited.GetWidth();
+        for (int z = 70; z <= 80; ++z) {
+            for (int x = 70; x <= 79; ++x) {
+                heights[z * width + x] += 0.05f;
+            }
+            for (int x = 81; x <= 90; ++x) {
+                heights[z * width + x] -= 0.05f;
+            }
+        }
+        edited.MarkDirty(70, 70, 79, 80);
+        edited.MarkDirty(81, 70, 90, 80);
+        edited.UpdateDirtyRegions();
+        reference.GetHeightData() = edited.GetHeightData();
+        reference.RebuildMesh();
+        TEST_CHECK(suite, SameVertexBuffer(editedBuffer, referenceBuffer));
+        TEST_CHECK(suite, SameLodSelection(edited, reference));
+
+        RecordNullGLBuffers(false);
+    });
+}
+
+// ========================================
+// 烘焙
+// ========================================
+// 参考数据不存整张贴图（自带高度图烘焙出来有十几 MB），每个通道存 16 × 16 块的平均值，
+// 比较时允许 BAKE_TOLERANCE 的差（0 - 255）：换编译器、换 CPU 后浮点结果
+// 可能差一点，但光照的样子不该变。整张贴图的哈希也记下来，只用于提示是否逐位相同。
+// 文件格式：
+//   hash <贴图名> <十六进制哈希>
+//   <贴图名>.<通道> <16 × 16 个平均值，行优先>
+// ========================================
+static const int BAKE_BLOCKS = 16;
+static const double BAKE_TOLERANCE = 0.5;
+
+struct BakedMap
+{
+    std::string name;
+    const std::vector<unsigned char>* texels;
+    int channels;
+};
+
+static std::vector<double> BlockMeans(const std::vector<unsigned char>& texels, int resolution,
+                                      int channels, int channel)
+{
+    std::vector<double> sums(BAKE_BLOCKS * BAKE_BLOCKS, 0.0);
+    std::vector<int> counts(BAKE_BLOCKS * BAKE_BLOCKS, 0);
+    for (int z = 0; z < resolution; ++z) {
+        for (int x = 0; x < resolution; ++x) {
+            int block = (z * BAKE_BLOCKS / resolution) * BAKE_BLOCKS + x * BAKE_BLOCKS / resolution;
+            sums[block] += texels[(static_cast<size_t>(z) * resolution + x) * channels + channel];
+            ++counts[block];
+        }
+    }
+    for (size_t i = 0; i < sums.size(); ++i) {
+        sums[i] = counts[i] > 0 ? sums[i] / counts[i] : 0.0;
+    }
+    return sums;
+}
+
+static bool WriteBakeGolden(const std::string& path, const std::vector<BakedMap>& maps, int resolution)
+{
+    std::ofstream file(path);
+    file << "# TerrainBake：Textures/heightmap.png，地形 100 × 10，默认烘焙参数\n";
+    file << "# 由 tests --update-golden 生成，格式见 TerrainTests.cpp\n";
+    char hash[32];
+    for (const BakedMap& map : maps) {
+        snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(HashArray(*map.texels)));
+        file << "hash " << map.name << " " << hash << "\n";
+    }
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    for (const BakedMap& map : maps) {
+        for (int c = 0; c < map.channels; ++c) {
+            file << map.name << "." << c;
+            for (double mean : BlockMeans(*map.texels, resolution, map.channels, c)) {
+                file << " " << mean;
+            }
+            file << "\n";
+        }
+    }
+    if (!file.good()) {
+        return false;
+    }
+    LOG_WARNING("参考数据已更新：" << path);
+    return true;
+}
+
+static void CheckBakeGolden(TestSuite& suite, const std::string& path, const std::vector<BakedMap>& maps,
+                            int resolution)
+{
+    std::ifstream file(path);
+    if (!TEST_CHECK(suite, file.is_open())) {
+        std::cout << "        （找不到参考数据 " << path << "，用 --update-golden 生成）\n";
+        return;
+    }
+
+    int linesChecked = 0;
+    bool identical = true;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream in(line);
+        std::string key;
+        in >> key;
+        if (key == "hash") {
+            std::string name, expected;
+            in >> name >> expected;
+            for (const BakedMap& map : maps) {
+                char hash[32];
+                snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(HashArray(*map.texels)));
+                if (map.name == name && expected != hash) {
+                    identical = false;
+                }
+            }
+            continue;
+        }
+
+        size_t dot = key.rfind('.');
+        std::string name = key.substr(0, dot);
+        int channel = dot == std::string::npos ? 0 : atoi(key.c_str() + dot + 1);
+        const BakedMap* map = nullptr;
+        for (const BakedMap& m : maps) {
+            map = m.name == name ? &m : map;
+        }
+        if (!TEST_CHECK(suite, map != nullptr && channel < map->channels)) {
+            continue;
+        }
+
+        std::vector<double> actual = BlockMeans(*map->texels, resolution, map->channels, channel);
+        double worst = 0.0;
+        int worstBlock = 0;
+        for (int block = 0; block < BAKE_BLOCKS * BAKE_BLOCKS; ++block) {
+            double expected = 0.0;
+            in >> expected;
+            double difference = std::fabs(actual[block] - expected);
+            if (difference > worst) {
+                worst = difference;
+                worstBlock = block;
+            }
+        }
+        if (!TEST_CHECK(suite, !in.fail() && worst <= BAKE_TOLERANCE)) {
+            std::cout << "        （" << key << " 第 " << worstBlock << " 块差 " << worst << "）\n";
+        }
+        ++linesChecked;
+    }
+    // 每张贴图的每个通道都要有参考数据
+    int expectedLines = 0;
+    for (const BakedMap& map : maps) {
+        expectedLines += map.channels;
+    }
+    TEST_CHECK_EQUAL(suite, linesChecked, expectedLines);
+    if (!identical) {
+        std::cout << "        （和参考数据不是逐位相同，但在容差以内）\n";
+    }
+}
+
+static void TestBake(TestSuite& suite)
+{
+    suite.Run("terrain.bake.thread_invariance", [&]() {
+        TerrainNoise noise(11);
+        Terrain terrain(noise, TerrainNoise::Settings(), 200);
+        TerrainBake::Settings settings;
+        settings.horizonDistance = 48.0f;
+
+        TerrainBake reference(settings, 1);
+        reference.Bake(terrain);
+        for (unsigned int threads : TestThreadCounts()) {
+            TerrainBake bake(settings, threads);
+            bake.Bake(terrain);
+            TEST_CHECK_EQUAL(suite, HashArray(bake.GetNormalMap()), HashArray(reference.GetNormalMap()));
+            TEST_CHECK_EQUAL(suite, HashArray(bake.GetHorizonMap(0)), HashArray(reference.GetHorizonMap(0)));
+            TEST_CHECK_EQUAL(suite, HashArray(bake.GetHorizonMap(1)), HashArray(reference.GetHorizonMap(1)));
+            TEST_CHECK_EQUAL(suite, HashArray(bake.GetAOMap()), HashArray(reference.GetAOMap()));
+        }
+    });
+
+    suite.Run("terrain.bake.golden_heightmap", [&]() {
+        Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+        TerrainBake bake{ TerrainBake::Settings() };
+        bake.Bake(terrain);
+        int resolution = bake.GetResolution();
+        TEST_CHECK_EQUAL(suite, resolution, terrain.GetWidth());
+
+        const std::vector<BakedMap> maps = {
+            { "normal", &bake.GetNormalMap(), 3 },
+            { "horizon0", &bake.GetHorizonMap(0), 4 },
+            { "horizon1", &bake.GetHorizonMap(1), 4 },
+            { "ao", &bake.GetAOMap(), 1 }
+        };
+        std::string path = suite.GetGoldenPath("bake_heightmap.txt");
+        if (suite.IsUpdatingGolden()) {
+            TEST_CHECK(suite, WriteBakeGolden(path, maps, resolution));
+        } else {
+            CheckBakeGolden(suite, path, maps, resolution);
+        }
+    });
+}
+
+// ========================================
+// 材质混合图
+// ========================================
+// 斜坡地形：先用噪声建一块地形，再把高度换成解析的斜坡（混合图只读高度数据）。
+// 129 × 129，地形边长 100，格子间距 0.78125
+// ========================================
+static const int SPLAT_SIZE = 129;
+
+// 每个像素的四个通道之和都是 255，返回不是的像素数
+static int CountBadSums(const TerrainSplat& splat)
+{
+    const std::vector<unsigned char>& map = splat.GetSplatMap();
+    int bad = 0;
+    for (size_t i = 0; i + 3 < map.size(); i += 4) {
+        bad += map[i] + map[i + 1] + map[i + 2] + map[i + 3] != 255 ? 1 : 0;
+    }
+    return bad;
+}
+
+// 权重最大的层
+static int DominantLayer(const TerrainSplat& splat, int x, int z)
+{
+    const unsigned char* texel = &splat.GetSplatMap()[(static_cast<size_t>(z) * splat.GetWidth() + x) * 4];
+    int best = 0;
+    for (int i = 1; i < TerrainSplat::MAX_LAYERS; ++i) {
+        best = texel[i] > texel[best] ? i : best;
+    }
+    return best;
+}
+
+static unsigned char Weight(const TerrainSplat& splat, int x, int z, int layer)
+{
+    return splat.GetSplatMap()[(static_cast<size_t>(z) * splat.GetWidth() + x) * 4 + layer];
+}
+
+static void TestSplat(TestSuite& suite)
+{
+    suite.Run("terrain.splat.weights_sum_to_one", [&]() {
+        // 和 Renderer 一样的三层（草地、高处草地、陡坡岩石）
+        std::vector<TerrainSplat::Layer> layers(3);
+        layers[0].maxHeight = 0.12f;
+        layers[0].maxSlope = 0.15f;
+        layers[0].slopeFade = 0.05f;
+        layers[1].minHeight = 0.12f;
+        layers[1].maxSlope = 0.15f;
+        layers[1].slopeFade = 0.05f;
+        layers[2].minSlope = 0.15f;
+        layers[2].slopeFade = 0.05f;
+
+        Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+        TerrainSplat splat(layers, TerrainSplat::Settings());
+        splat.Generate(terrain);
+        TEST_CHECK_EQUAL(suite, splat.GetSplatMap().size(),
+                         static_cast<size_t>(terrain.GetWidth()) * terrain.GetHeight() * 4);
+        TEST_CHECK_EQUAL(suite, CountBadSums(splat), 0);
+
+        // 四层，带曲率带（山谷 / 山脊），有的像素没有任何层匹配（退回第一层）
+        std::vector<TerrainSplat::Layer> curved(4);
+        curved[0].maxHeight = 0.3f;
+        curved[1].minCurvature = 0.002f;
+        curved[2].maxCurvature = -0.002f;
+        curved[3].minHeight = 0.6f;
+        curved[3].minSlope = 0.5f;
+        TerrainSplat four(curved, TerrainSplat::Settings());
+        four.Generate(terrain);
+        TEST_CHECK_EQUAL(suite, CountBadSums(four), 0);
+    });
+
+    suite.Run("terrain.splat.height_bands", [&]() {
+        // 高度沿 x 从 0 线性升到 1；高度缩放 1，坡度只有 0.01，坡度带不起作用
+        Terrain terrain(TerrainNoise(1), TerrainNoise::Settings(), SPLAT_SIZE, 100.0f, 1.0f);
+        std::vector<float>& heights = terrain.GetHeightData();
+        for (int z = 0; z < SPLAT_SIZE; ++z) {
+            for (int x = 0; x < SPLAT_SIZE; ++x) {
+                heights[z * SPLAT_SIZE + x] = x / static_cast<float>(SPLAT_SIZE - 1);
+            }
+        }
+
+        std::vector<TerrainSplat::Layer> layers(3);
+        layers[0].maxHeight = 0.3f;
+        layers[1].minHeight = 0.3f;
+        layers[1].maxHeight = 0.7f;
+        layers[2].minHeight = 0.7f;
+        TerrainSplat splat(layers, TerrainSplat::Settings());
+        splat.Generate(terrain);
+
+        const int z = SPLAT_SIZE / 2;
+        // 远离过渡带的地方只有一层
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 13, z, 0)), 255);    // 高度 0.10
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 64, z, 1)), 255);    // 0.50
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 115, z, 2)), 255);   // 0.90
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 0, z, 0)), 255);     // 地图边上
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 128, z, 2)), 255);
+        // 过渡带（0.25 - 0.35、0.65 - 0.75）里两层混合，总和仍是 255
+        TEST_CHECK(suite, Weight(splat, 35, z, 0) > 0 && Weight(splat, 35, z, 1) > 0);
+        TEST_CHECK(suite, Weight(splat, 93, z, 1) > 0 && Weight(splat, 93, z, 2) > 0);
+        TEST_CHECK_EQUAL(suite, CountBadSums(splat), 0);
+        // 沿斜坡往上，占主导的层只会往后换
+        int previous = 0;
+        bool monotonic = true;
+        for (int x = 0; x < SPLAT_SIZE; ++x) {
+            int layer = DominantLayer(splat, x, z);
+            monotonic = monotonic && layer >= previous;
+            previous = layer;
+        }
+        TEST_CHECK(suite, monotonic);
+    });
+
+    suite.Run("terrain.splat.slope_bands", [&]() {
+        // 高度（格子单位）= x² / 256，坡度 = x / 128：从 0 升到 1。
+        // 二次函数的中心差分是精确的，所以 x 处的坡度就是 x / 128（离开地图边一个采样半径）
+        const float heightScale = 100.0f;
+        Terrain terrain(TerrainNoise(1), TerrainNoise::Settings(), SPLAT_SIZE, 100.0f, heightScale);
+        float cellSize = terrain.GetTerrainSize() / (SPLAT_SIZE - 1);
+        float verticalScale = heightScale / cellSize;
+        std::vector<float>& heights = terrain.GetHeightData();
+        for (int z = 0; z < SPLAT_SIZE; ++z) {
+            for (int x = 0; x < SPLAT_SIZE; ++x) {
+                heights[z * SPLAT_SIZE + x] = x * x / 256.0f / verticalScale;
+            }
+        }
+
+        std::vector<TerrainSplat::Layer> layers(2);
+        layers[0].maxSlope = 0.3f;
+        layers[0].slopeFade = 0.05f;
+        layers[1].minSlope = 0.3f;
+        layers[1].slopeFade = 0.05f;
+        TerrainSplat splat(layers, TerrainSplat::Settings());
+        splat.Generate(terrain);
+
+        const int z = SPLAT_SIZE / 2;
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 12, z, 0)), 255);    // 坡度 0.09
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 30, z, 0)), 255);    // 0.23
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 50, z, 1)), 255);    // 0.39
+        TEST_CHECK_EQUAL(suite, static_cast<int>(Weight(splat, 110, z, 1)), 255);   // 0.86
+        TEST_CHECK(suite, Weight(splat, 36, z, 0) > 0 && Weight(splat, 36, z, 1) > 0);  // 0.28
+        TEST_CHECK_EQUAL(suite, CountBadSums(splat), 0);
+    });
+
+    suite.Run("terrain.splat.thread_invariance", [&]() {
+        std::vector<TerrainSplat::Layer> layers(2);
+        layers[0].maxSlope = 0.4f;
+        layers[1].minSlope = 0.4f;
+        Terrain terrain(TerrainNoise(5), TerrainNoise::Settings(), 257);
+        TerrainSplat reference(layers, TerrainSplat::Settings(), 1);
+        reference.Generate(terrain);
+        for (unsigned int threads : TestThreadCounts()) {
+            TerrainSplat splat(layers, TerrainSplat::Settings(), threads);
+            splat.Generate(terrain);
+            TEST_CHECK_EQUAL(suite, HashArray(splat.GetSplatMap()), HashArray(reference.GetSplatMap()));
+        }
+    });
+}
+
+// ========================================
+// 地形网格缓存
+// ========================================
+// 在临时目录开缓存，先正常构建一次（写入缓存），再把缓存里的条目改坏：
+//   索引超出顶点数、LOD 块的索引区间超出索引数组（两种都重新算好内容的哈希，
+//   只有地形自己的检查能发现），以及内容翻转一个字节但哈希不变（缓存的校验发现）
+// 每种都要当作没有命中：重新构建并写回缓存，上传的索引和正常构建的一样。
+// 没改过的条目则直接命中，不再写入
+// ========================================
+
+// 缓存条目文件：magic | 版本 | 键哈希 | kind 长度 | kind | 内容大小 | 内容哈希 | 内容
+// （见 DerivedDataCache.cpp），返回内容开始的位置，0 表示读不懂
+static size_t ReadCacheEntry(const std::string& path, std::vector<unsigned char>& bytes)
+{
+    std::ifstream file(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (bytes.size() < 20) {
+        return 0;
+    }
+    uint32_t kindLength = 0;
+    memcpy(&kindLength, &bytes[16], sizeof(kindLength));
+    size_t payload = 20 + kindLength + 16;
+    return payload <= bytes.size() ? payload : 0;
+}
+
+static void WriteCacheEntry(const std::string& path, std::vector<unsigned char>& bytes, size_t payload,
+                            bool rehash)
+{
+    if (rehash) {
+        uint64_t hash = DerivedDataKey::Hash(&bytes[payload], bytes.size() - payload, 0);
+        memcpy(&bytes[payload - sizeof(hash)], &hash, sizeof(hash));
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// 跳过一个数组（元素个数 + 元素），返回下一项的位置
+static size_t SkipArray(const std::vector<unsigned char>& bytes, size_t at, size_t elementSize)
+{
+    uint64_t count = 0;
+    memcpy(&count, &bytes[at], sizeof(count));
+    return at + sizeof(count) + static_cast<size_t>(count) * elementSize;
+}
+
+static void TestMeshCache(TestSuite& suite)
+{
+    suite.Run("terrain.cache.rejects_bad_entries", [&]() {
+        std::error_code error;
+        std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "csc8502_test_cache";
+        DerivedDataCache::Settings settings;
+        settings.directory = directory.string();
+        DerivedDataCache& cache = DerivedDataCache::Get();
+        TEST_CHECK(suite, !error && cache.Open(settings));
+        if (!cache.IsOpen()) {
+            return;
+        }
+        cache.Clear();
+        RecordNullGLBuffers(true);
+
+        std::vector<unsigned char> goodIndices;
+        {
+            Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+            goodIndices = *GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ELEMENT_ARRAY_BUFFER));
+        }
+        std::string entryPath;
+        for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+            if (file.path().filename().string().compare(0, 13, "terrain_mesh_") == 0) {
+                entryPath = file.path().string();
+            }
+        }
+        TEST_CHECK(suite, !entryPath.empty());
+
+        // 0 = 不改，1 = 索引越界，2 = LOD 块区间越界，3 = 翻转一个字节、哈希不变
+        for (int damage = 0; damage < 4 && !entryPath.empty(); ++damage) {
+            std::vector<unsigned char> bytes;
+            size_t payload = ReadCacheEntry(entryPath, bytes);
+            TEST_CHECK(suite, payload > 0);
+            if (payload == 0) {
+                break;
+            }
+            // 内容：宽 | 高 | 第 0 级索引数 | 块数 X | 块数 Z（各 4 字节）| 高度 | 顶点 | 索引 | LOD 分块
+            size_t vertices = SkipArray(bytes, payload + 20, sizeof(float));
+            size_t indices = SkipArray(bytes, vertices, 12 + 12 + 8);
+            size_t chunks = SkipArray(bytes, indices, sizeof(unsigned int));
+            if (damage == 1) {
+                const unsigned int outOfRange = 0xFFFFFFF0u;
+                memcpy(&bytes[indices + 8 + 100 * sizeof(unsigned int)], &outOfRange, sizeof(outOfRange));
+            } else if (damage == 2) {
+                // LodChunk 里 indexOffset[0] 在 x0 z0 cellsX cellsZ minY maxY error[4] 之后
+                const unsigned int offset = 0x7FFFFFF0u;
+                memcpy(&bytes[chunks + 8 + 40], &offset, sizeof(offset));
+            } else if (damage == 3) {
+                bytes[vertices + 8] ^= 0x40;
+            }
+            if (damage > 0) {
+                WriteCacheEntry(entryPath, bytes, payload, damage != 3);
+            }
+
+            int stores = cache.GetStats().stores;
+            LogLevel level = Log::GetLevel();
+            Log::SetLevel(LOG_LEVEL_NONE);
+            Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+            Log::SetLevel(level);
+            const std::vector<unsigned char>* uploaded =
+                GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ELEMENT_ARRAY_BUFFER));
+            TEST_CHECK_EQUAL(suite, cache.GetStats().stores - stores, (damage == 0 ? 0 : 1));
+            TEST_CHECK(suite, uploaded && *uploaded == goodIndices);
+        }
+
+        RecordNullGLBuffers(false);
+        cache.Clear();
+        cache.Close();
+        std::filesystem::remove_all(directory, error);
+    });
+
+    // 打开之后别的实例（另一个进程）写进来的条目，命中时按磁盘上的文件大小
+    // （含文件头）记进总大小，和 Store、Open 记的一样
+    suite.Run("terrain.cache.foreign_entry_size", [&]() {
+        std::error_code error;
+        std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "csc8502_test_cache";
+        DerivedDataCache::Settings settings;
+        settings.directory = directory.string();
+        DerivedDataCache& cache = DerivedDataCache::Get();
+        DerivedDataCache other;
+        TEST_CHECK(suite, !error && cache.Open(settings) && other.Open(settings));
+        if (!cache.IsOpen() || !other.IsOpen()) {
+            return;
+        }
+        cache.Clear();
+
+        DerivedDataKey key("test_entry", 1);
+        key.Add(static_cast<int32_t>(42));
+        std::vector<unsigned char> payload(1000, 7);
+        TEST_CHECK(suite, other.Store(key, payload));
+        std::vector<unsigned char> loaded;
+        TEST_CHECK(suite, cache.Load(key, loaded) && loaded == payload);
+        uint64_t onDisk = std::filesystem::file_size(directory / key.GetFileName(), error);
+        TEST_CHECK(suite, !error && onDisk > payload.size());
+        TEST_CHECK_EQUAL(suite, cache.GetTotalBytes(), onDisk);
+        TEST_CHECK_EQUAL(suite, cache.GetTotalBytes(), other.GetTotalBytes());
+
+        other.Close();
+        cache.Clear();
+        cache.Close();
+        std::filesystem::remove_all(directory, error);
+    });
+}
+
+void RunTerrainTests(TestSuite& suite)
+{
+    TestNoise(suite);
+    TestErosion(suite);
+    TestEditing(suite);
+    TestBake(suite);
+    TestSplat(suite);
+    TestMeshCache(suite);
+}
@@ -0,0 +1,129 @@
+/*
+ * CSC8502 Coursework - 子系统测试
+ *
+ * 和基准测试一样不开窗口、不需要显卡（OpenGL 换成空实现，见 NullGL.h），
+ * 检查各子系统的结果是否正确：
+ *   terrain.*     噪声、侵蚀、烘焙在不同线程数下逐位相同，侵蚀分帧执行和一次执行相同；
+ *                 笔刷编辑后局部更新的顶点和全量重建逐字节相同；
+ *                 自带高度图的烘焙贴图和参考数据（golden/）一致；
+ *                 材质混合图的权重之和为 1，在高度、坡度斜坡上选出预期的层；
+ *                 网格缓存的条目被改坏（索引越界、LOD 块区间越界、内容和哈希对不上）时
+ *                 不使用，重新构建；别的实例写进缓存的条目按磁盘上的大小计入总大小
+ *   water.*       Clipmap 各层的顶点数、层与层之间没有裂缝、相机小幅移动时网格不动；
+ *                 自带高度图上各类水面分块的个数和估算省下的像素数；
+ *                 岸线距离场和暴力搜索逐个相等；
+ *                 FFT 海浪的结果和线程数无关；
+ *                 水面高度查询和 waterVertex.glsl 的采样方式（CPU 移植版）一致
+ *   sim.*         固定步长时钟（假时间来源）：步数、追帧上限和丢步、30 / 60 Hz 交替、插值系数；
+ *                 输入录制回放逐帧相同，截断或损坏的文件在出错的那一帧干净地停下；
+ *                 帧流水线（合成负载）渲染的快照顺序、更新和渲染的重叠
+ *   jobs.*        作业系统分别用 0 / 1 / 3 / 7 个工作线程：依赖顺序、主线程作业、
+ *                 窃取和嵌套等待；网格文件并行载入和逐个载入的结果相同；
+ *                 压力测试场景的角色骨骼矩阵和线程数无关
+ *   alloc.*       替换全局 operator new 计数：作业依赖、模拟时钟、每帧临时内存和
+ *                 对象池在预热之后不再分配堆内存
+ *   memory.*      内存统计：网格、地形、纹理的 CPU / GPU 字节数和按尺寸算的一致，
+ *                 GPU 缓冲和 NullGL 记录的大小一致，释放 CPU 副本和删除后归零
+ *   log.*         4 个线程各写 5000 条带序号的日志（远超过环形缓冲），
+ *                 读回的输出里每个线程的消息不丢、不乱序；写到一半时 Log::Shutdown 也一样
+ *   perf.*        性能计数器：多个线程同时注册、Add、Set，快照的每帧增量和总数准确，
+ *                 导出的 CSV / JSON 和快照一致
+ *   bench.*       基准测试的硬件计数列：没有计数器时照常计时、IPC 和未命中是 n/a，
+ *                 有计数时 IPC 和每项未命中的数值
+ *
+ * 命令行参数：
+ *   --filter 文字      只运行名字里包含这段文字的测试
+ *   --data 目录        Textures / Meshes 所在的目录（默认当前目录）
+ *   --workers 个数     作业系统的工作线程数（默认 3）。线程数测试比较的是
+ *                      1、2 和全部线程的结果，所以单核机器上也要有工作线程
+ *   --golden 目录      参考数据所在的目录（默认 golden，相对于启动时的目录）
+ *   --update-golden    不检查参考数据，改为把这次的结果写成新的参考数据。
+ *                      只在有意改变了输出（并确认新结果是对的）之后使用
+ *
+ * 返回值：0 全部通过，1 有测试失败，2 参数错误。
+ * Linux 上用 make -C Benchmarks test 编译并运行。
+ */
+
+#include "NullGL.h"
+#include "TestSuite.h"
+#include "Tests.h"
+#include "nclgl/JobSystem.h"
+#include "nclgl/Log.h"
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>  // SetConsoleOutputCP
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    std::string filter;
+    std::string dataDirectory;
+    int workers = 3;
+    std::string goldenDirectory = "golden";
+    bool updateGolden = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (strcmp(arg, "--data") == 0 && hasValue) {
+            dataDirectory = argv[++i];
+        } else if (strcmp(arg, "--workers") == 0 && hasValue) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--golden") == 0 && hasValue) {
+            goldenDirectory = argv[++i];
+        } else if (strcmp(arg, "--update-golden") == 0) {
+            updateGolden = true;
+        } else {
+            LOG_ERROR("错误：无法识别的参数 " << arg);
+            Log::Shutdown();
+            return 2;
+        }
+    }
+    // 参考数据目录相对于启动时的目录，切换到数据目录之前先转成绝对路径
+    goldenDirectory = std::filesystem::absolute(goldenDirectory).string();
+    if (!dataDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::current_path(dataDirectory, error);
+        if (error) {
+            LOG_ERROR("错误：无法进入数据目录 " << dataDirectory << "（" << error.message() << "）");
+            Log::Shutdown();
+            return 2;
+        }
+    }
+
+    InstallNullGL();
+    JobSystem::SetDefaultWorkerCount(workers);
+    LOG_INFO("作业系统：" << JobSystem::Get().GetWorkerCount() << " 个工作线程 + 主线程");
+    Log::Flush();
+    // 被测代码正常的进度信息不输出，只留警告和错误
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_WARNING);
+
+    TestSuite suite(filter);
+    suite.SetGoldenDirectory(goldenDirectory, updateGolden);
+    RunTerrainTests(suite);
+    RunWaterTests(suite);
+    RunSimulationTests(suite);
+    RunCoreTests(suite);
+
+    Log::SetLevel(level);
+    int result = 0;
+    if (suite.GetTestCount() == 0) {
+        LOG_ERROR("错误：没有运行任何测试（--filter " << filter << "）");
+        result = 2;
+    } else {
+        suite.PrintSummary();
+        result = suite.GetFailedTestCount() > 0 ? 1 : 0;
+    }
+    Log::Shutdown();
+    return result;
+}
@@ -0,0 +1,79 @@
+#include "TestSuite.h"
+#include "nclgl/Log.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+TestSuite::TestSuite(const std::string& filter)
+    : m_Filter(filter)
+    , m_UpdateGolden(false)
+    , m_Tests(0)
+    , m_FailedTests(0)
+    , m_Checks(0)
+    , m_FailedChecks(0)
+{
+}
+
+bool TestSuite::IsSelected(const std::string& name) const
+{
+    return m_Filter.empty() || name.find(m_Filter) != std::string::npos;
+}
+
+void TestSuite::Run(const std::string& name, const std::function<void()>& body)
+{
+    if (!IsSelected(name)) {
+        return;
+    }
+    m_Checks = 0;
+    m_FailedChecks = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    body();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 被测代码的日志是异步写出的，先让它写完，输出才不会和结果行交错
+    Log::Flush();
+    ++m_Tests;
+    bool passed = m_FailedChecks == 0 && m_Checks > 0;
+    if (!passed) {
+        ++m_FailedTests;
+    }
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << (passed ? "  ok    " : "  FAIL  ") << std::left << std::setw(48) << name
+              << std::right << std::setw(5) << m_Checks << " 项检查" << std::fixed << std::setprecision(2)
+              << std::setw(8) << seconds << " s";
+    if (m_Checks == 0) {
+        std::cout << "（没有任何检查）";
+    }
+    std::cout << "\n";
+    std::cout.flags(flags);
+    std::cout.flush();
+}
+
+void TestSuite::SetGoldenDirectory(const std::string& directory, bool update)
+{
+    m_GoldenDirectory = directory;
+    m_UpdateGolden = update;
+}
+
+std::string TestSuite::GetGoldenPath(const std::string& fileName) const
+{
+    return m_GoldenDirectory.empty() ? fileName : m_GoldenDirectory + "/" + fileName;
+}
+
+bool TestSuite::Check(bool passed, const std::string& message, const char* file, int line)
+{
+    ++m_Checks;
+    if (!passed) {
+        ++m_FailedChecks;
+        Log::Flush();
+        std::cout << "        失败：" << message << "  (" << file << ":" << line << ")\n";
+    }
+    return passed;
+}
+
+void TestSuite::PrintSummary() const
+{
+    std::cout << "\n" << m_Tests << " 个测试，" << m_FailedTests << " 个失败\n";
+    std::cout.flush();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <functional>
+#include <sstream>
+#include <string>
+
+/**
+ * @class TestSuite
+ * @brief 无窗口的子系统测试：按名字运行测试，统计失败的检查
+ *
+ * 和基准测试共用一套引擎源文件和空 OpenGL（见 NullGL.h），
+ * 在没有显示器的 Linux 上也能跑。每个测试是一个函数，里面用 TEST_CHECK
+ * 检查条件；失败时输出表达式和位置，测试继续往下跑（一次看到所有问题），
+ * 最后按失败数决定返回值。
+ *
+ * 用法：
+ *   suite.Run("noise.thread_invariance", [&]() {
+ *       TEST_CHECK(suite, a == b);
+ *       TEST_CHECK_EQUAL(suite, tiles.CountTiles(...), 123);
+ *   });
+ */
+class TestSuite
+{
+public:
+    /**
+     * @param filter 只运行名字里包含这段文字的测试（空字符串表示全部）
+     */
+    explicit TestSuite(const std::string& filter);
+
+    bool IsSelected(const std::string& name) const;
+
+    // 运行一个测试，输出它的名字、检查数和结果
+    void Run(const std::string& name, const std::function<void()>& body);
+
+    // 记录一次检查；失败时输出 message 和位置
+    bool Check(bool passed, const std::string& message, const char* file, int line);
+
+    /**
+     * @brief 参考数据（golden）文件所在的目录
+     * @param update true 时检查参考数据的测试改为把这次的结果写成新的参考数据
+     */
+    void SetGoldenDirectory(const std::string& directory, bool update);
+    std::string GetGoldenPath(const std::string& fileName) const;
+    bool IsUpdatingGolden() const { return m_UpdateGolden; }
+
+    int GetTestCount() const { return m_Tests; }
+    int GetFailedTestCount() const { return m_FailedTests; }
+
+    // 一行总结：运行了几个测试，几个失败
+    void PrintSummary() const;
+
+private:
+    std::string m_Filter;
+    std::string m_GoldenDirectory;
+    bool m_UpdateGolden;
+    int m_Tests;
+    int m_FailedTests;
+    int m_Checks;          // 当前测试的检查数
+    int m_FailedChecks;    // 当前测试失败的检查数
+};
+
+#define TEST_CHECK(suite, condition) \
+    (suite).Check((condition), #condition, __FILE__, __LINE__)
+
+// 失败时把两边的值也输出
+#define TEST_CHECK_EQUAL(suite, actual, expected)                                     \
+    do {                                                                              \
+        auto testActual = (actual);                                                   \
+        auto testExpected = (expected);                                               \
+        std::ostringstream testMessage;                                               \
+        testMessage << #actual << " == " << #expected                                 \
+                    << "（实际 " << testActual << "，期望 " << testExpected << "）";  \
+        (suite).Check(testActual == testExpected, testMessage.str(), __FILE__, __LINE__); \
+    } while (0)
+
+// |actual - expected| <= tolerance
+#define TEST_CHECK_NEAR(suite, actual, expected, tolerance)                           \
+    do {                                                                              \
+        double testActual = (actual);                                                 \
+        double testExpected = (expected);                                             \
+        std::ostringstream testMessage;                                               \
+        testMessage << #actual << " ≈ " << #expected                                  \
+                    << "（实际 " << testActual << "，期望 " << testExpected           \
+                    << "，容差 " << (tolerance) << "）";                             \
+        (suite).Check(testActual - testExpected <= (tolerance) &&                     \
+                      testExpected - testActual <= (tolerance),                       \
+                      testMessage.str(), __FILE__, __LINE__);                         \
+    } while (0)
@@ -0,0 +1,36 @@
+#pragma once
+#include "TestSuite.h"
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/JobSystem.h"
+#include <cstdint>
+#include <vector>
+
+// ========================================
+// 各组测试的入口（TestMain.cpp 按顺序调用）
+// ========================================
+void RunTerrainTests(TestSuite& suite);
+void RunWaterTests(TestSuite& suite);
+void RunSimulationTests(TestSuite& suite);
+void RunCoreTests(TestSuite& suite);
+
+// ========================================
+// 测试共用的小工具
+// ========================================
+
+// 数组内容的 64 位哈希，比较两次输出是否逐位相同
+template <typename T>
+uint64_t HashArray(const std::vector<T>& values)
+{
+    return DerivedDataKey::Hash(values.data(), values.size() * sizeof(T), 0);
+}
+
+// 线程数测试用的线程数：1、2 和作业系统的全部线程（去掉重复）
+inline std::vector<unsigned int> TestThreadCounts()
+{
+    std::vector<unsigned int> counts = { 1, 2 };
+    unsigned int all = JobSystem::Get().GetWorkerCount() + 1;
+    if (all > 2) {
+        counts.push_back(all);
+    }
+    return counts;
+}
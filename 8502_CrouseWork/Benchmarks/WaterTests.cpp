@@ -0,0 +1,552 @@
+#include "NullGL.h"
+#include "OceanFFT.h"
+#include "ShorelineDistance.h"
+#include "Terrain.h"
+#include "Tests.h"
+#include "WaterClipmap.h"
+#include "WaterQuery.h"
+#include "WaterTileMap.h"
+#include "nclgl/common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+// ========================================
+// 水面 Clipmap
+// ========================================
+// 顶点格式和 WaterClipmap::Vertex 一样：位置、法向量、纹理坐标，共 8 个 float
+// ========================================
+static const int WATER_VERTEX_FLOATS = 8;
+
+// 每层顶点 / 三角形数（见 WaterClipmap 构造函数里的推导）
+static int ExpectedVertexCount(int n, int levels)
+{
+    int h = n / 2;
+    return (n + 1) * (n + 1) + (levels - 1) * ((n + 1) * (n + 1) - (h - 1) * (h - 1) + 4 * h);
+}
+
+static int ExpectedTriangleCount(int n, int levels)
+{
+    int h = n / 2;
+    return 2 * n * n + (levels - 1) * (2 * (n * n - h * h - 4 * h) + 3 * 4 * h);
+}
+
+struct WaterMesh
+{
+    const std::vector<unsigned char>* vertices;
+    const std::vector<unsigned char>* indices;
+
+    int GetTriangleCount() const { return static_cast<int>(indices->size() / (3 * sizeof(unsigned int))); }
+
+    void GetPosition(unsigned int index, float& x, float& z) const
+    {
+        const float* v = reinterpret_cast<const float*>(vertices->data()) + index * WATER_VERTEX_FLOATS;
+        x = v[0];
+        z = v[2];
+    }
+
+    unsigned int GetIndex(int i) const { return reinterpret_cast<const unsigned int*>(indices->data())[i]; }
+};
+
+// ========================================
+// 检查上传的网格是否严丝合缝
+// ========================================
+// 按位置（而不是顶点编号）统计每条边被几个三角形用到：
+// 内部的边正好 2 个，最外层的外边界正好 1 个。有 T 形接缝或裂缝时，
+// 接缝两边的边对不上，会出现只用了 1 次的内部边。
+// 三角形面积之和等于覆盖范围的面积，说明各层之间没有重叠也没有空洞。
+// 所有坐标都是 2 的幂次格子边长的整数倍（或半格），浮点数可以精确比较
+// ========================================
+static bool IsWatertight(const WaterMesh& mesh, const WaterClipmap& water, int& openEdges, double& area)
+{
+    typedef std::pair<float, float> Point;
+    std::map<std::pair<Point, Point>, int> edges;
+    area = 0.0;
+    for (int t = 0; t < mesh.GetTriangleCount(); ++t) {
+        Point p[3];
+        for (int k = 0; k < 3; ++k) {
+            mesh.GetPosition(mesh.GetIndex(t * 3 + k), p[k].first, p[k].second);
+        }
+        area += 0.5 * std::fabs((p[1].first - p[0].first) * (p[2].second - p[0].second) -
+                                (p[2].first - p[0].first) * (p[1].second - p[0].second));
+        for (int k = 0; k < 3; ++k) {
+            Point a = p[k];
+            Point b = p[(k + 1) % 3];
+            ++edges[a < b ? std::make_pair(a, b) : std::make_pair(b, a)];
+        }
+    }
+
+    int outer = water.GetLevelCount() - 1;
+    Vector2 origin = water.GetLevelOrigin(outer);
+    float extent = water.GetExtent();
+    auto onBoundary = [&](const Point& a, const Point& b) {
+        return (a.first == b.first && (a.first == origin.x || a.first == origin.x + extent)) ||
+               (a.second == b.second && (a.second == origin.y || a.second == origin.y + extent));
+    };
+
+    openEdges = 0;
+    for (const auto& edge : edges) {
+        int expected = onBoundary(edge.first.first, edge.first.second) ? 1 : 2;
+        openEdges += edge.second != expected ? 1 : 0;
+    }
+    return openEdges == 0 && std::fabs(area - static_cast<double>(extent) * extent) < 1e-3 * extent * extent;
+}
+
+static void TestClipmap(TestSuite& suite)
+{
+    suite.Run("water.clipmap.ring_counts", [&]() {
+        const int configs[][2] = { { 16, 1 }, { 16, 4 }, { 64, 7 }, { 128, 3 } };
+        for (const auto& config : configs) {
+            WaterClipmap water(0.0f, config[0], config[1], 0.25f);
+            TEST_CHECK_EQUAL(suite, water.GetLevelCount(), config[1]);
+            TEST_CHECK_EQUAL(suite, water.GetVertexCount(), ExpectedVertexCount(config[0], config[1]));
+            TEST_CHECK_EQUAL(suite, water.GetTriangleCount(), ExpectedTriangleCount(config[0], config[1]));
+            TEST_CHECK_NEAR(suite, water.GetExtent(), config[0] * 0.25 * (1 << (config[1] - 1)), 0.0);
+            // 不剔除时画全部三角形
+            water.Render();
+            TEST_CHECK_EQUAL(suite, water.GetDrawnTriangleCount(), water.GetTriangleCount());
+        }
+    });
+
+    suite.Run("water.clipmap.seamless_nesting", [&]() {
+        RecordNullGLBuffers(true);
+        WaterClipmap water(0.0f, 32, 5, 0.25f);
+        WaterMesh mesh = {
+            GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ARRAY_BUFFER)),
+            GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ELEMENT_ARRAY_BUFFER))
+        };
+        TEST_CHECK(suite, mesh.vertices && mesh.indices);
+        if (mesh.vertices && mesh.indices) {
+            // 相机走到各种位置（负数、跨越不同层的吸附边界），每次只上传变化的层，
+            // 检查的是 GPU 那边拼起来的结果
+            const Vector3 cameras[] = {
+                Vector3(0.0f, 0.0f, 0.0f), Vector3(0.3f, 0.0f, 0.1f), Vector3(-7.9f, 0.0f, 3.6f),
+                Vector3(123.4f, 0.0f, -56.7f), Vector3(-1000.1f, 0.0f, 999.9f), Vector3(8.0f, 0.0f, 8.0f)
+            };
+            for (const Vector3& camera : cameras) {
+                water.Update(camera);
+                int openEdges = 0;
+                double area = 0.0;
+                bool watertight = IsWatertight(mesh, water, openEdges, area);
+                if (!TEST_CHECK(suite, watertight)) {
+                    std::cout << "        （相机 " << camera.x << ", " << camera.z << "：" << openEdges
+                              << " 条边没有对上，面积 " << area << "）\n";
+                }
+                // 相机在最内层的中间一半里
+                Vector2 origin = water.GetLevelOrigin(0);
+                float inner = water.GetCellSize(0) * 32;
+                TEST_CHECK(suite, camera.x >= origin.x + inner * 0.25f && camera.x <= origin.x + inner * 0.75f &&
+                                  camera.z >= origin.y + inner * 0.25f && camera.z <= origin.y + inner * 0.75f);
+            }
+        }
+        RecordNullGLBuffers(false);
+    });
+
+    suite.Run("water.clipmap.snapping", [&]() {
+        RecordNullGLBuffers(true);
+        WaterClipmap water(0.0f, 32, 5, 0.25f);
+        const std::vector<unsigned char>* vertices = GetNullGLBufferData(GetNullGLLastAllocatedBuffer(GL_ARRAY_BUFFER));
+        TEST_CHECK(suite, vertices != nullptr);
+        if (vertices) {
+            // 相机在吸附格（第 0 层的两格）里移动不到一格：原点不变，什么都不重新上传
+            const float cell = water.GetCellSize(0);
+            water.Update(Vector3(10.0f * cell + 0.1f * cell, 0.0f, -6.0f * cell + 0.2f * cell));
+            std::vector<unsigned char> before = *vertices;
+            std::vector<Vector2> origins;
+            for (int l = 0; l < water.GetLevelCount(); ++l) {
+                origins.push_back(water.GetLevelOrigin(l));
+            }
+            const float steps[][2] = { { 0.8f, 0.0f }, { 0.0f, 0.7f }, { 0.5f, 0.5f }, { 0.9f, 0.9f } };
+            for (const auto& step : steps) {
+                water.Update(Vector3(10.1f * cell + step[0] * cell, 0.0f, -5.8f * cell + step[1] * cell));
+                bool same = vertices->size() == before.size() &&
+                            memcmp(vertices->data(), before.data(), before.size()) == 0;
+                TEST_CHECK(suite, same);
+                for (int l = 0; l < water.GetLevelCount(); ++l) {
+                    TEST_CHECK(suite, water.GetLevelOrigin(l).x == origins[l].x &&
+                                      water.GetLevelOrigin(l).y == origins[l].y);
+                }
+            }
+
+            // 任何相机位置，每层原点都是本层格子的偶数倍（外层格子的整数倍），网格不会游动
+            bool snapped = true;
+            for (int i = 0; i < 200; ++i) {
+                water.Update(Vector3(i * 1.37f - 130.0f, 0.0f, i * -0.91f + 40.0f));
+                for (int l = 0; l < water.GetLevelCount(); ++l) {
+                    double units = water.GetLevelOrigin(l).x / (2.0 * water.GetCellSize(l));
+                    double unitsZ = water.GetLevelOrigin(l).y / (2.0 * water.GetCellSize(l));
+                    snapped = snapped && units == std::floor(units) && unitsZ == std::floor(unitsZ);
+                }
+            }
+            TEST_CHECK(suite, snapped);
+        }
+        RecordNullGLBuffers(false);
+    });
+}
+
+// ========================================
+// 水面分块（自带高度图）
+// ========================================
+// 设置和 Renderer 一样：水面高度 0，余量 0.5，每 32 格一块。
+// 期望值是在这张高度图上数出来的，高度图或分类规则变了要一起更新。
+//
+// 省下的像素按俯视估算：高度图一个像素对应屏幕上一个像素（1025×1025 的正交俯视图）。
+// 被遮住的块整块不画（连光栅化都省了），岸线块里遮罩为 0 的像素在片段着色器一开始就 discard
+// ========================================
+static const int EXPECTED_OPEN_TILES = 83;
+static const int EXPECTED_SHORELINE_TILES = 130;
+static const int EXPECTED_BURIED_TILES = 811;
+static const long long EXPECTED_CULLED_PIXELS = 832385;     // 1025×1025 的 79.2%
+static const long long EXPECTED_DISCARDED_PIXELS = 65630;   // 6.2%，合计 85.5%
+
+static void TestTileMap(TestSuite& suite)
+{
+    suite.Run("water.tiles.heightmap_counts", [&]() {
+        Terrain terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+        WaterTileMap tiles(terrain, 0.0f, 0.5f, 32);
+        const int width = terrain.GetWidth();
+        const int height = terrain.GetHeight();
+        const std::vector<unsigned char>& mask = tiles.GetMask();
+
+        int open = tiles.CountTiles(WaterTileMap::TileState::Open);
+        int shoreline = tiles.CountTiles(WaterTileMap::TileState::Shoreline);
+        int buried = tiles.CountTiles(WaterTileMap::TileState::Buried);
+        TEST_CHECK_EQUAL(suite, open + shoreline + buried, tiles.GetTileCountX() * tiles.GetTileCountZ());
+        TEST_CHECK_EQUAL(suite, open, EXPECTED_OPEN_TILES);
+        TEST_CHECK_EQUAL(suite, shoreline, EXPECTED_SHORELINE_TILES);
+        TEST_CHECK_EQUAL(suite, buried, EXPECTED_BURIED_TILES);
+
+        // 每个像素归到它所在的块（边界上的像素归左下的块，不重复计算），
+        // 同时检查遮罩和块的状态一致：被遮住的块全是 0，可见的块全是 255
+        long long culled = 0;
+        long long discarded = 0;
+        bool consistent = true;
+        for (int z = 0; z < height; ++z) {
+            for (int x = 0; x < width; ++x) {
+                int tx = std::min(x / 32, tiles.GetTileCountX() - 1);
+                int tz = std::min(z / 32, tiles.GetTileCountZ() - 1);
+                WaterTileMap::TileState state = tiles.GetTileState(tx, tz);
+                unsigned char value = mask[static_cast<size_t>(z) * width + x];
+                if (state == WaterTileMap::TileState::Buried) {
+                    ++culled;
+                    consistent = consistent && value == 0;
+                } else if (state == WaterTileMap::TileState::Open) {
+                    consistent = consistent && value == 255;
+                } else if (value == 0) {
+                    ++discarded;
+                }
+            }
+        }
+        TEST_CHECK(suite, consistent);
+        TEST_CHECK_EQUAL(suite, culled, EXPECTED_CULLED_PIXELS);
+        TEST_CHECK_EQUAL(suite, discarded, EXPECTED_DISCARDED_PIXELS);
+    });
+}
+
+// ========================================
+// 岸线距离场
+// ========================================
+// 和逐点暴力搜索对照。FH 变换是精确的（double 计算，平方距离都是整数），
+// 误差上限为 0：平方距离逐个相等，有符号距离按同样的公式换算后逐位相等
+// ========================================
+static const float SHORE_FAR_AWAY = 1e20f;
+
+// 暴力版平方距离变换：每个像素扫一遍全部特征点
+static std::vector<float> BruteForceTransform(const std::vector<unsigned char>& features, int width, int height)
+{
+    std::vector<float> out(features.size(), SHORE_FAR_AWAY);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            long long best = -1;
+            for (int fy = 0; fy < height; ++fy) {
+                for (int fx = 0; fx < width; ++fx) {
+                    if (features[fy * width + fx]) {
+                        long long d = static_cast<long long>(fx - x) * (fx - x) + static_cast<long long>(fy - y) * (fy - y);
+                        best = best < 0 || d < best ? d : best;
+                    }
+                }
+            }
+            if (best >= 0) {
+                out[y * width + x] = static_cast<float>(best);
+            }
+        }
+    }
+    return out;
+}
+
+// 固定种子的随机特征图：密度从很稀疏到很密，另外有全空和只有一个点的情况
+static std::vector<unsigned char> RandomFeatures(std::mt19937& rng, int width, int height, int variant)
+{
+    std::vector<unsigned char> features(static_cast<size_t>(width) * height, 0);
+    if (variant == 0) {
+        return features;
+    }
+    if (variant == 1) {
+        features[rng() % features.size()] = 1;
+        return features;
+    }
+    unsigned int percent = 1 + variant * 7 % 60;
+    for (unsigned char& feature : features) {
+        feature = rng() % 100 < percent ? 1 : 0;
+    }
+    return features;
+}
+
+static void TestShoreline(TestSuite& suite)
+{
+    suite.Run("water.shore.transform_matches_brute_force", [&]() {
+        std::mt19937 rng(35);
+        int mismatches = 0;
+        int far = 0;
+        for (int map = 0; map < 120; ++map) {
+            int width = 1 + rng() % 40;
+            int height = 1 + rng() % 40;
+            std::vector<unsigned char> features = RandomFeatures(rng, width, height, map % 10);
+            std::vector<float> expected = BruteForceTransform(features, width, height);
+            std::vector<float> actual;
+            ShorelineDistance::SquaredDistanceTransform(features, width, height, actual, 1);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                // 没有特征点时只要求“很大”
+                if (expected[i] >= SHORE_FAR_AWAY) {
+                    far += actual[i] >= SHORE_FAR_AWAY ? 0 : 1;
+                } else {
+                    mismatches += actual[i] == expected[i] ? 0 : 1;
+                }
+            }
+        }
+        TEST_CHECK_EQUAL(suite, mismatches, 0);
+        TEST_CHECK_EQUAL(suite, far, 0);
+    });
+
+    // 地形范围以外是水：在四周补一圈湿像素，岸线在湿/干像素之间（各 0.5 格）
+    suite.Run("water.shore.signed_field_matches_brute_force", [&]() {
+        const int size = 33;
+        Terrain terrain(TerrainNoise(3), TerrainNoise::Settings(), size, 64.0f, 1.0f);
+        const float cellSize = terrain.GetTerrainSize() / (size - 1);
+        std::mt19937 rng(350);
+        for (int variant = 0; variant < 4; ++variant) {
+            // 0：噪声地形本身；1：随机的湿/干像素；2：全部在水下；3：全部是陆地
+            std::vector<float>& heights = terrain.GetHeightData();
+            for (float& height : heights) {
+                if (variant == 1) {
+                    height = rng() % 3 == 0 ? -1.0f : 1.0f;
+                } else if (variant >= 2) {
+                    height = variant == 2 ? -1.0f : 1.0f;
+                }
+            }
+            const float waterLevel = variant == 0 ? 0.5f : 0.0f;
+
+            ShorelineDistance shore(4.0f, 1);
+            shore.Compute(terrain, waterLevel);
+
+            const int padded = size + 2;
+            std::vector<unsigned char> wet(padded * padded, 1);
+            for (int z = 0; z < size; ++z) {
+                for (int x = 0; x < size; ++x) {
+                    wet[(z + 1) * padded + x + 1] = heights[z * size + x] < waterLevel ? 1 : 0;
+                }
+            }
+            std::vector<unsigned char> dry(wet.size());
+            for (size_t i = 0; i < wet.size(); ++i) {
+                dry[i] = 1 - wet[i];
+            }
+            std::vector<float> toWet = BruteForceTransform(wet, padded, padded);
+            std::vector<float> toDry = BruteForceTransform(dry, padded, padded);
+
+            int mismatches = 0;
+            for (int z = 0; z < size; ++z) {
+                for (int x = 0; x < size; ++x) {
+                    int p = (z + 1) * padded + x + 1;
+                    float actual = shore.GetDistance(x, z);
+                    if (wet[p] && toDry[p] >= SHORE_FAR_AWAY) {
+                        // 没有陆地：一个很大的负数
+                        mismatches += actual <= -SHORE_FAR_AWAY ? 0 : 1;
+                        continue;
+                    }
+                    float cells = wet[p] ? -(std::sqrt(toDry[p]) - 0.5f) : std::sqrt(toWet[p]) - 0.5f;
+                    mismatches += actual == cells * cellSize ? 0 : 1;
+                }
+            }
+            TEST_CHECK_EQUAL(suite, mismatches, 0);
+        }
+    });
+
+    suite.Run("water.shore.thread_invariance", [&]() {
+        std::mt19937 rng(3500);
+        const int width = 301;
+        const int height = 257;
+        for (int variant = 2; variant < 6; ++variant) {
+            std::vector<unsigned char> features = RandomFeatures(rng, width, height, variant);
+            std::vector<float> reference;
+            ShorelineDistance::SquaredDistanceTransform(features, width, height, reference, 1);
+            for (unsigned int threads : TestThreadCounts()) {
+                std::vector<float> out;
+                ShorelineDistance::SquaredDistanceTransform(features, width, height, out, threads);
+                TEST_CHECK_EQUAL(suite, HashArray(out), HashArray(reference));
+            }
+        }
+    });
+}
+
+// ========================================
+// FFT 海浪
+// ========================================
+// 每列只由一个线程按固定顺序计算，位移和法线+泡沫网格应当和线程数无关、逐位相同。
+// 两种海浪谱、几个不同的时刻（频谱推进和 FFT 都要走到）
+// ========================================
+static void TestOcean(TestSuite& suite)
+{
+    suite.Run("water.ocean.thread_invariance", [&]() {
+        OceanFFT::Settings phillips;
+        phillips.resolution = 64;
+        phillips.spectrum = OceanFFT::Spectrum::Phillips;
+        OceanFFT::Settings jonswap;
+        jonswap.resolution = 128;
+        jonswap.seed = 7;
+        const float times[] = { 0.0f, 1.25f, 37.5f };
+
+        for (const OceanFFT::Settings& settings : { phillips, jonswap }) {
+            std::vector<uint64_t> expected;
+            OceanFFT reference(settings, 1);
+            for (float time : times) {
+                reference.Update(time);
+                expected.push_back(HashArray(reference.GetDisplacement()) ^ HashArray(reference.GetNormalFoam()));
+            }
+            // 海面确实在动
+            TEST_CHECK(suite, expected[0] != expected[1] && expected[1] != expected[2]);
+
+            for (unsigned int threads : TestThreadCounts()) {
+                OceanFFT ocean(settings, threads);
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    ocean.Update(times[i]);
+                    TEST_CHECK_EQUAL(suite, HashArray(ocean.GetDisplacement()) ^ HashArray(ocean.GetNormalFoam()),
+                                     expected[i]);
+                }
+            }
+        }
+    });
+}
+
+// ========================================
+// 水面高度查询
+// ========================================
+// 和 waterVertex.glsl 对照：着色器在 lod 0 时 textureLod(oceanDisplacement, xz / patchSize)
+// 是 GL_REPEAT + GL_LINEAR 的双线性采样（像素中心在 i + 0.5），
+// 网格点 p 被移到 p + D(p)。下面是它逐行照搬的标量版本（double 计算）
+// ========================================
+static void SampleShaderGrid(const std::vector<float>& grid, int N, float patchSize, double x, double z,
+                             double out[3])
+{
+    double u = x / patchSize * N - 0.5;
+    double v = z / patchSize * N - 0.5;
+    double u0 = std::floor(u);
+    double v0 = std::floor(v);
+    double fx = u - u0;
+    double fz = v - v0;
+    auto wrap = [N](long long i) { return static_cast<int>(((i % N) + N) % N); };
+    int x0 = wrap(static_cast<long long>(u0));
+    int z0 = wrap(static_cast<long long>(v0));
+    int x1 = wrap(static_cast<long long>(u0) + 1);
+    int z1 = wrap(static_cast<long long>(v0) + 1);
+    for (int c = 0; c < 3; ++c) {
+        double a = grid[(z0 * N + x0) * 4 + c];
+        double b = grid[(z0 * N + x1) * 4 + c];
+        double d = grid[(z1 * N + x0) * 4 + c];
+        double e = grid[(z1 * N + x1) * 4 + c];
+        double top = a + (b - a) * fx;
+        double bottom = d + (e - d) * fx;
+        out[c] = top + (bottom - top) * fz;
+    }
+}
+
+// 反解水平位移后的高度误差上限（世界单位 = 米）。
+// 不动点迭代每次把水平残差缩小到约 1/3，误差是残差乘以坡度：
+// 默认 3 次时在 4 毫米以内，8 次时在 0.1 毫米以内
+static const int WATER_QUERY_ITERATIONS[] = { 3, 8 };
+static const double WATER_QUERY_TOLERANCE[] = { 1e-2, 1e-4 };
+
+static void TestWaterQuery(TestSuite& suite)
+{
+    OceanFFT::Settings settings;
+    settings.resolution = 128;
+    OceanFFT ocean(settings, 1);
+    ocean.Update(3.0f);
+    ocean.Update(3.0f + 1.0f / 60.0f);
+    const int N = ocean.GetResolution();
+    const float patch = ocean.GetPatchSize();
+    const float waterLevel = -2.5f;
+
+    // 固定的查询点，覆盖负坐标和好几块平铺之外
+    std::vector<float> xs, zs;
+    for (int i = 0; i < 203; ++i) {
+        xs.push_back(-300.0f + i * 3.17f);
+        zs.push_back(250.0f - i * 2.53f + (i % 7) * 0.11f);
+    }
+
+    // 不反解水平位移时，查询点就是纹理采样点：高度、法线、速度都和着色器的采样一致
+    suite.Run("water.query.matches_shader_sampling", [&]() {
+        WaterQuery query(ocean, waterLevel, 0);
+        double maxError = 0.0;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            WaterQuery::Sample sample = query.Query(xs[i], zs[i]);
+            double d[3], previous[3], n[3];
+            SampleShaderGrid(ocean.GetDisplacement(), N, patch, xs[i], zs[i], d);
+            SampleShaderGrid(ocean.GetPreviousDisplacement(), N, patch, xs[i], zs[i], previous);
+            SampleShaderGrid(ocean.GetNormalFoam(), N, patch, xs[i], zs[i], n);
+            double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            double dt = ocean.GetTime() - ocean.GetPreviousTime();
+
+            maxError = std::max(maxError, std::fabs(sample.height - (waterLevel + d[1])));
+            maxError = std::max(maxError, std::fabs(sample.normal.x - n[0] / length));
+            maxError = std::max(maxError, std::fabs(sample.normal.y - n[1] / length));
+            maxError = std::max(maxError, std::fabs(sample.normal.z - n[2] / length));
+            // 速度是位移差除以 1/60 秒，float 的舍入误差被放大 60 倍
+            maxError = std::max(maxError, std::fabs(sample.velocity.y - (d[1] - previous[1]) / dt) / 60.0);
+        }
+        TEST_CHECK_NEAR(suite, maxError, 0.0, 1e-4);
+    });
+
+    // 着色器把网格点 p 画在 p + D(p)，在那个位置查询应当得到 p 的高度
+    suite.Run("water.query.matches_displaced_surface", [&]() {
+        for (int k = 0; k < 2; ++k) {
+            WaterQuery query(ocean, waterLevel, WATER_QUERY_ITERATIONS[k]);
+            double maxError = 0.0;
+            for (size_t i = 0; i < xs.size(); ++i) {
+                double d[3];
+                SampleShaderGrid(ocean.GetDisplacement(), N, patch, xs[i], zs[i], d);
+                float x = static_cast<float>(xs[i] + d[0]);
+                float z = static_cast<float>(zs[i] + d[2]);
+                maxError = std::max(maxError, std::fabs(query.GetHeight(x, z) - (waterLevel + d[1])));
+            }
+            TEST_CHECK_NEAR(suite, maxError, 0.0, WATER_QUERY_TOLERANCE[k]);
+        }
+    });
+
+    // 批量查询（SSE 4 个一组，末尾不足 4 个补齐）和逐点查询逐位相同
+    suite.Run("water.query.batch_matches_single", [&]() {
+        WaterQuery query(ocean, waterLevel);
+        std::vector<WaterQuery::Sample> samples(xs.size());
+        query.Query(xs.data(), zs.data(), static_cast<int>(xs.size()), samples.data());
+        for (size_t i = 0; i < xs.size(); i += 10) {
+            WaterQuery::Sample single = query.Query(xs[i], zs[i]);
+            TEST_CHECK_EQUAL(suite, samples[i].height, single.height);
+            TEST_CHECK_EQUAL(suite, samples[i].normal.y, single.normal.y);
+        }
+        WaterQuery::Sample last = query.Query(xs.back(), zs.back());
+        TEST_CHECK_EQUAL(suite, samples.back().height, last.height);
+    });
+}
+
+void RunWaterTests(TestSuite& suite)
+{
+    TestClipmap(suite);
+    TestTileMap(suite);
+    TestShoreline(suite);
+    TestOcean(suite);
+    TestWaterQuery(suite);
+}
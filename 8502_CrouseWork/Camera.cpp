@@ -100,6 +100,15 @@ void Camera::ProcessMouseScroll(float yoffset)
         Zoom = 45.0f;
 }
 
+// 直接设置位置和朝向
+void Camera::SetPose(const Vector3& position, float yaw, float pitch)
+{
+    Position = position;
+    Yaw = yaw;
+    Pitch = pitch;
+    UpdateCameraVectors();
+}
+
 // 更新相机向量
 void Camera::UpdateCameraVectors()
 {
@@ -64,6 +64,9 @@ public:
     // 处理鼠标滚轮
     void ProcessMouseScroll(float yoffset);
 
+    // 直接设置位置和朝向（脚本相机路径用）
+    void SetPose(const Vector3& position, float yaw, float pitch);
+
 private:
     // 更新相机向量（从欧拉角计算前、右、上向量）
     void UpdateCameraVectors();
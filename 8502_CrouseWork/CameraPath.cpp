@@ -0,0 +1,181 @@
+#include "CameraPath.h"
+#include "nclgl/Log.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    // 均匀 Catmull-Rom：经过 p1（s = 0）和 p2（s = 1）
+    float CatmullRom(float p0, float p1, float p2, float p3, float s)
+    {
+        float s2 = s * s;
+        float s3 = s2 * s;
+        return 0.5f * (2.0f * p1
+                       + (p2 - p0) * s
+                       + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * s2
+                       + (3.0f * p1 - p0 - 3.0f * p2 + p3) * s3);
+    }
+}
+
+CameraPath::CameraPath()
+    : m_Looping(false)
+{
+}
+
+void CameraPath::AddKeyframe(const Vector3& position, float yaw, float pitch)
+{
+    Keyframe key;
+    key.position = position;
+    key.yaw = yaw;
+    key.pitch = pitch;
+    m_Keyframes.push_back(key);
+}
+
+bool CameraPath::LoadFromFile(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        LOG_ERROR("错误：无法打开相机路径文件 " << path);
+        return false;
+    }
+
+    std::vector<Keyframe> keyframes;
+    bool looping = false;
+    bool first = true;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+
+        if (first && line.compare(start, 4, "loop") == 0)
+        {
+            looping = true;
+            first = false;
+            continue;
+        }
+        first = false;
+
+        std::istringstream stream(line);
+        Keyframe key;
+        if (!(stream >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch))
+        {
+            LOG_ERROR("错误：相机路径文件 " << path << " 第 " << lineNumber
+                      << " 行格式错误（应为 x y z yaw pitch）");
+            return false;
+        }
+        keyframes.push_back(key);
+    }
+
+    if (keyframes.empty())
+    {
+        LOG_ERROR("错误：相机路径文件 " << path << " 中没有关键帧");
+        return false;
+    }
+
+    m_Keyframes.swap(keyframes);
+    m_Looping = looping;
+    LOG_INFO("✓ 加载相机路径: " << path << "（" << m_Keyframes.size() << " 个关键帧"
+             << (m_Looping ? "，闭合" : "") << "）");
+    return true;
+}
+
+// ========================================
+// 默认环绕路径
+// ========================================
+// 高度按 sin(2θ) 起伏，低点贴近水面；俯仰角跟着高度变化，
+// 始终大致看向地形中心
+// ========================================
+CameraPath CameraPath::CreateOrbit(float radius, float height, int keyframes)
+{
+    CameraPath path;
+    path.SetLooping(true);
+    keyframes = std::max(keyframes, 4);
+
+    const float pi = 3.14159265358979323846f;
+    for (int i = 0; i < keyframes; ++i)
+    {
+        float angle = 2.0f * pi * i / keyframes;
+        float y = height * (1.0f + 0.8f * std::sin(2.0f * angle));
+        Vector3 position(radius * std::cos(angle), y, radius * std::sin(angle));
+
+        // 朝向原点：front = (cos(yaw), ·, sin(yaw))
+        float yaw = angle * 180.0f / pi + 180.0f;
+        float pitch = -std::atan2(y, radius) * 180.0f / pi * 0.6f;
+        path.AddKeyframe(position, yaw, pitch);
+    }
+    return path;
+}
+
+// 闭合路径下标回绕；不闭合时截断到两端
+const CameraPath::Keyframe& CameraPath::At(int index) const
+{
+    int count = static_cast<int>(m_Keyframes.size());
+    if (m_Looping)
+        index = ((index % count) + count) % count;
+    else
+        index = std::max(0, std::min(count - 1, index));
+    return m_Keyframes[index];
+}
+
+CameraPath::Keyframe CameraPath::Sample(float t) const
+{
+    if (m_Keyframes.empty())
+    {
+        Keyframe origin;
+        origin.position = Vector3(0.0f, 0.0f, 0.0f);
+        origin.yaw = 0.0f;
+        origin.pitch = 0.0f;
+        return origin;
+    }
+    int count = static_cast<int>(m_Keyframes.size());
+    if (count == 1)
+        return m_Keyframes[0];
+
+    // 闭合路径有 count 段（最后一段回到起点），否则 count - 1 段
+    int segments = m_Looping ? count : count - 1;
+    t = std::max(0.0f, std::min(1.0f, t));
+    float u = t * segments;
+    int segment = std::min(static_cast<int>(u), segments - 1);
+    float s = u - segment;
+
+    const Keyframe& k0 = At(segment - 1);
+    const Keyframe& k1 = At(segment);
+    const Keyframe& k2 = At(segment + 1);
+    const Keyframe& k3 = At(segment + 2);
+
+    // 偏航角按最短方向展开（相邻关键帧相差不超过 180 度），
+    // 闭合路径从 350 度回到 10 度时不会反向转一整圈
+    auto unwrap = [](float previous, float yaw) {
+        while (yaw - previous > 180.0f)
+            yaw -= 360.0f;
+        while (yaw - previous < -180.0f)
+            yaw += 360.0f;
+        return yaw;
+    };
+    float yaw1 = k1.yaw;
+    float yaw0 = unwrap(yaw1, k0.yaw);
+    float yaw2 = unwrap(yaw1, k2.yaw);
+    float yaw3 = unwrap(yaw2, k3.yaw);
+
+    Keyframe result;
+    result.position.x = CatmullRom(k0.position.x, k1.position.x, k2.position.x, k3.position.x, s);
+    result.position.y = CatmullRom(k0.position.y, k1.position.y, k2.position.y, k3.position.y, s);
+    result.position.z = CatmullRom(k0.position.z, k1.position.z, k2.position.z, k3.position.z, s);
+    result.yaw = CatmullRom(yaw0, yaw1, yaw2, yaw3, s);
+    result.pitch = CatmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, s);
+    return result;
+}
+
+void CameraPath::Apply(Camera& camera, float t) const
+{
+    Keyframe key = Sample(t);
+    camera.SetPose(key.position, key.yaw, key.pitch);
+}
@@ -0,0 +1,64 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include "nclgl/Vector3.h"
+#include <string>
+#include <vector>
+
+class Camera;
+
+// ========================================
+// 相机路径（基准测试用的脚本相机）
+// ========================================
+// 功能：
+// 1. 一串关键帧（位置 + 偏航角 + 俯仰角），用 Catmull-Rom 样条平滑插值，
+//    曲线经过每一个关键帧；闭合路径首尾相接
+// 2. 按参数 t ∈ [0, 1] 取样：关键帧之间均匀分配（不按弧长），
+//    同一个 t 总是得到同一个相机姿态，不依赖帧时间
+// 3. 可以从文本文件加载，每行一个关键帧：
+//      x y z yaw pitch
+//    空行和 # 开头的行忽略；文件第一个非注释行为 "loop" 时路径闭合
+// 4. CreateOrbit 生成默认路径：绕地形一圈，高低起伏，
+//    覆盖远景、贴近水面和翻过山脊几种情况
+//
+// 角度单位为度，与 Camera 一致；相邻关键帧之间的偏航角按最短方向插值
+// ========================================
+
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        Vector3 position;
+        float yaw;
+        float pitch;
+    };
+
+    CameraPath();
+
+    void AddKeyframe(const Vector3& position, float yaw, float pitch);
+    void SetLooping(bool looping) { m_Looping = looping; }
+    bool IsLooping() const { return m_Looping; }
+    int GetKeyframeCount() const { return static_cast<int>(m_Keyframes.size()); }
+    void Clear() { m_Keyframes.clear(); }
+
+    // 从文件加载（替换现有关键帧）；失败时输出错误并返回 false
+    bool LoadFromFile(const std::string& path);
+
+    // 绕原点一圈的默认路径：radius 为水平半径，height 为平均高度
+    static CameraPath CreateOrbit(float radius, float height, int keyframes = 12);
+
+    // 取样；关键帧少于 2 个时返回第一个关键帧（没有关键帧返回原点）
+    Keyframe Sample(float t) const;
+
+    // 把取样结果应用到相机
+    void Apply(Camera& camera, float t) const;
+
+private:
+    std::vector<Keyframe> m_Keyframes;
+    bool m_Looping;
+
+    const Keyframe& At(int index) const;
+};
+
+#endif // CAMERA_PATH_H
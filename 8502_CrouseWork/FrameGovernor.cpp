@@ -0,0 +1,182 @@
+#include "FrameGovernor.h"
+#include <algorithm>
+#include <cstdio>
+
+// ========================================
+// 各项每一级的取值（第 0 级就是不开控制器时的画质）
+// ========================================
+static const float RENDER_SCALES[FrameGovernor::LEVEL_COUNT]  = { 1.0f, 0.85f, 0.7f, 0.5f };
+static const float TERRAIN_ERRORS[FrameGovernor::LEVEL_COUNT] = { 1.0f, 2.0f, 4.0f, 8.0f };
+static const int WATER_GRIDS[FrameGovernor::LEVEL_COUNT]      = { 64, 48, 32, 16 };
+static const float DRAW_DISTANCES[FrameGovernor::LEVEL_COUNT] = { 10000.0f, 500.0f, 300.0f, 180.0f };
+
+// 还没测到降级省了多少时，假设省了 20%
+static const float ASSUMED_COST_RATIO = 0.8f;
+// m_RecentFrame 的权重：约 8 帧前的时间只剩 10%
+static const float RECENT_WEIGHT = 0.25f;
+
+FrameGovernor::FrameGovernor(const Settings& settings)
+    : m_Settings(settings)
+{
+    Reset();
+}
+
+void FrameGovernor::Reset()
+{
+    std::fill(m_Levels, m_Levels + KNOB_COUNT, 0);
+    m_Quality = QualityForLevels(m_Levels);
+
+    m_SmoothedCpu = 0.0f;
+    m_SmoothedGpu = -1.0f;
+    m_LastGpu = -1.0f;
+    m_RecentFrame = 0.0f;
+    m_FrameBeforeDegrade = 0.0f;
+
+    m_OverFrames = 0;
+    m_UnderFrames = 0;
+    m_SettleFrames = 0;
+    m_UpgradeWait = m_Settings.upgradeFrames;
+    m_FramesSinceChange = 0;
+    m_LastChangeWasUpgrade = false;
+    m_ChangeCount = 0;
+    m_History.clear();
+}
+
+FrameGovernor::Quality FrameGovernor::QualityForLevels(const int levels[KNOB_COUNT])
+{
+    Quality quality;
+    quality.renderScale = RENDER_SCALES[levels[KNOB_RENDER_SCALE]];
+    quality.terrainErrorPixels = TERRAIN_ERRORS[levels[KNOB_TERRAIN_LOD]];
+    quality.waterGridSize = WATER_GRIDS[levels[KNOB_WATER_DENSITY]];
+    quality.drawDistance = DRAW_DISTANCES[levels[KNOB_DRAW_DISTANCE]];
+    return quality;
+}
+
+const char* FrameGovernor::GetKnobName(Knob knob)
+{
+    switch (knob) {
+    case KNOB_RENDER_SCALE:  return "render_scale";
+    case KNOB_TERRAIN_LOD:   return "terrain_lod";
+    case KNOB_WATER_DENSITY: return "water_density";
+    case KNOB_DRAW_DISTANCE: return "draw_distance";
+    default:                 return "unknown";
+    }
+}
+
+// ========================================
+// 每帧更新
+// ========================================
+// 判断超预算用这一帧的时间（CPU 和最近的 GPU 时间取较长的），
+// 平均值变化太慢：一次卡顿会让它在预算以上停留好几十帧
+// ========================================
+bool FrameGovernor::Update(float cpuMs, float gpuMs)
+{
+    if (gpuMs >= 0.0f) {
+        m_LastGpu = gpuMs;
+        m_SmoothedGpu = m_SmoothedGpu < 0.0f ? gpuMs : m_SmoothedGpu + (gpuMs - m_SmoothedGpu) * m_Settings.smoothing;
+    }
+    m_SmoothedCpu = m_SmoothedCpu <= 0.0f ? cpuMs : m_SmoothedCpu + (cpuMs - m_SmoothedCpu) * m_Settings.smoothing;
+
+    float frameMs = std::max(cpuMs, m_LastGpu);
+    m_RecentFrame = m_RecentFrame <= 0.0f ? frameMs : m_RecentFrame + (frameMs - m_RecentFrame) * RECENT_WEIGHT;
+    ++m_FramesSinceChange;
+
+    // 升级撑过了观察期：等待时间恢复初始值
+    if (m_LastChangeWasUpgrade && m_FramesSinceChange == m_Settings.probeFrames) {
+        m_UpgradeWait = m_Settings.upgradeFrames;
+    }
+    // 降级后新画质的时间已经稳定：记下这一级省了多少
+    if (!m_LastChangeWasUpgrade && !m_History.empty() && m_FrameBeforeDegrade > 0.0f &&
+        m_FramesSinceChange == m_Settings.settleFrames + m_Settings.measureFrames) {
+        m_History.back().costRatio = std::min(1.0f, std::max(0.25f, m_RecentFrame / m_FrameBeforeDegrade));
+    }
+
+    if (m_SettleFrames > 0) {
+        --m_SettleFrames;
+        return false;
+    }
+
+    if (frameMs > m_Settings.targetMs * m_Settings.overBudget) {
+        ++m_OverFrames;
+        m_UnderFrames = 0;
+    } else {
+        m_OverFrames = std::max(0, m_OverFrames - 1);
+        bool headroom = false;
+        if (!m_History.empty()) {
+            float ratio = m_History.back().costRatio > 0.0f ? m_History.back().costRatio : ASSUMED_COST_RATIO;
+            headroom = frameMs / ratio < m_Settings.targetMs * m_Settings.upgradeHeadroom;
+        }
+        m_UnderFrames = headroom ? m_UnderFrames + 1 : 0;
+    }
+
+    if (m_OverFrames >= m_Settings.degradeFrames) {
+        // 升级后很快又超预算：这一级撑不住，下次多等一倍
+        if (m_LastChangeWasUpgrade && m_FramesSinceChange < m_Settings.probeFrames) {
+            m_UpgradeWait = std::min(m_UpgradeWait * 2, m_Settings.maxUpgradeFrames);
+        }
+        if (Degrade()) {
+            OnChanged(false);
+            return true;
+        }
+        // 已经降无可降，漏桶不再往上涨
+        m_OverFrames = m_Settings.degradeFrames;
+    } else if (m_UnderFrames >= m_UpgradeWait) {
+        if (Upgrade()) {
+            OnChanged(true);
+            return true;
+        }
+        m_UnderFrames = 0;
+    }
+    return false;
+}
+
+bool FrameGovernor::Degrade()
+{
+    // GPU 是瓶颈时才降渲染分辨率；其余各项降当前画质最好的一项，同级按枚举顺序
+    int first = IsGpuBound() ? KNOB_RENDER_SCALE : KNOB_RENDER_SCALE + 1;
+    int best = -1;
+    for (int knob = first; knob < KNOB_COUNT; ++knob) {
+        if (m_Levels[knob] < LEVEL_COUNT - 1 && (best < 0 || m_Levels[knob] < m_Levels[best])) {
+            best = knob;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    ++m_Levels[best];
+    Step step = { static_cast<Knob>(best), 0.0f };
+    m_History.push_back(step);
+    m_FrameBeforeDegrade = m_RecentFrame;
+    return true;
+}
+
+bool FrameGovernor::Upgrade()
+{
+    if (m_History.empty()) {
+        return false;
+    }
+    --m_Levels[m_History.back().knob];
+    m_History.pop_back();
+    return true;
+}
+
+void FrameGovernor::OnChanged(bool upgrade)
+{
+    m_Quality = QualityForLevels(m_Levels);
+    m_OverFrames = 0;
+    m_UnderFrames = 0;
+    m_SettleFrames = m_Settings.settleFrames;
+    m_FramesSinceChange = 0;
+    m_LastChangeWasUpgrade = upgrade;
+    ++m_ChangeCount;
+}
+
+std::string FrameGovernor::Describe() const
+{
+    char line[160];
+    snprintf(line, sizeof(line), "budget %.1fms cpu %.1f gpu %.1f (%s) | scale %d%% lod %.0fpx water %d dist %.0f",
+             m_Settings.targetMs, m_SmoothedCpu, std::max(0.0f, m_SmoothedGpu), IsGpuBound() ? "gpu" : "cpu",
+             static_cast<int>(m_Quality.renderScale * 100.0f + 0.5f), m_Quality.terrainErrorPixels,
+             m_Quality.waterGridSize, m_Quality.drawDistance);
+    return line;
+}
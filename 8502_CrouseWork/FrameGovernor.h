@@ -0,0 +1,137 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <string>
+#include <vector>
+
+// ========================================
+// 帧时间预算控制器
+// ========================================
+// 每帧读入测得的 CPU 和 GPU 时间，超出预算时降低画质，
+// 长时间有余量时再一级一级恢复。可调的画质有四项，每项 4 级（0 = 最高）：
+//   1. 内部渲染分辨率（窗口分辨率的 100% / 85% / 70% / 50%）
+//   2. 地形 LOD 允许的屏幕误差（1 / 2 / 4 / 8 像素）
+//   3. 水面网格密度（每层每边 64 / 48 / 32 / 16 格，覆盖范围不变）
+//   4. 绘制距离（远裁剪面和水面区块）
+//
+// 防止来回抖动（滞回）：
+// 1. 降级和升级用两条线：超过 目标 × overBudget 才算超预算；
+//    预计升级后的帧时间低于 目标 × upgradeHeadroom 才算有余量，两条线之间保持不动。
+//    “预计”用的是降级时实测的节省比例：降级前后各取一次近几帧的平均，
+//    升级后的时间 ≈ 现在的时间 ÷ 比例（还没测到时按节省 20% 估计）
+// 2. 超预算的帧用“漏桶”计数（超一帧加一，不超减一），单独一帧卡顿不会降级；
+//    有余量要连续这么多帧才升级，中间任何一帧没余量就重新计数
+// 3. 每次调整后的几帧不做判断：GPU 时间晚几帧才能拿到，要等新画质的时间进来
+// 4. 升级后很快又超预算，说明这一级撑不住：下次升级前等待的时间加倍；
+//    升级撑过了观察期，等待时间恢复初始值
+//
+// 选哪一项：
+// GPU 时间（平滑后）比 CPU 长时在全部四项里选，否则不动渲染分辨率
+// （它只影响 GPU 的像素着色）。在可选的项里降当前级别最高（画质最好）的一项，
+// 所以各项轮流降级，而不是一项降到底再降下一项；升级按降级的相反顺序恢复。
+//
+// 只是控制逻辑，不调用 GL：调用方把 GetQuality() 应用到渲染器。
+// 用合成的帧时间序列做的模拟测试见 Benchmarks/GovernorSim.cpp
+// ========================================
+
+class FrameGovernor
+{
+public:
+    enum Knob
+    {
+        KNOB_RENDER_SCALE,
+        KNOB_TERRAIN_LOD,
+        KNOB_WATER_DENSITY,
+        KNOB_DRAW_DISTANCE,
+        KNOB_COUNT
+    };
+
+    static const int LEVEL_COUNT = 4;
+
+    struct Settings
+    {
+        float targetMs          = 16.0f;    // 目标帧时间
+        float overBudget        = 1.05f;    // 帧时间 > 目标 × 这个值 算超预算
+        float upgradeHeadroom   = 0.9f;     // 预计升级后的帧时间 < 目标 × 这个值 算有余量
+        float smoothing         = 0.1f;     // 指数平均的权重（判断瓶颈和显示）
+        int degradeFrames       = 8;        // 漏桶计数到这么多时降一级
+        int upgradeFrames       = 90;       // 连续有余量这么多帧后升一级（初始值）
+        int maxUpgradeFrames    = 1440;     // 升级失败后等待时间加倍的上限
+        int settleFrames        = 12;       // 每次调整后不做判断的帧数
+        int measureFrames       = 8;        // 不判断的帧过后再等这么多帧，测降级省了多少
+        int probeFrames         = 120;      // 升级后这么多帧内降级算升级失败
+    };
+
+    // 应用到渲染器的画质参数
+    struct Quality
+    {
+        float renderScale;          // 内部渲染分辨率 / 窗口分辨率
+        float terrainErrorPixels;   // 地形 LOD 允许的屏幕误差（像素）
+        int waterGridSize;          // 水面每层每边的格子数（4 的倍数，不小于 16）
+        float drawDistance;         // 远裁剪面；水面只画这个距离以内的区块
+    };
+
+    explicit FrameGovernor(const Settings& settings);
+
+    // ========================================
+    // 每帧调用一次
+    // ========================================
+    // cpuMs：这一帧 CPU 上的工作时间（不含等待垂直同步）
+    // gpuMs：新取回的 GPU 时间；< 0 表示这一帧没有，沿用上一个
+    // 返回 true 表示画质变了，调用方要应用 GetQuality()
+    // ========================================
+    bool Update(float cpuMs, float gpuMs);
+
+    // 回到最高画质，清空所有计数
+    void Reset();
+
+    const Settings& GetSettings() const { return m_Settings; }
+    const Quality& GetQuality() const { return m_Quality; }
+    int GetLevel(Knob knob) const { return m_Levels[knob]; }
+    float GetSmoothedCpuMs() const { return m_SmoothedCpu; }
+    float GetSmoothedGpuMs() const { return m_SmoothedGpu; }   // 还没有 GPU 时间时为 -1
+    bool IsGpuBound() const { return m_SmoothedGpu > m_SmoothedCpu; }
+    int GetChangeCount() const { return m_ChangeCount; }
+    int GetUpgradeWait() const { return m_UpgradeWait; }
+
+    // 一行状态，如 "budget 16.0ms cpu 9.1 gpu 17.3 (gpu) | scale 85% lod 2px water 48 dist 2000"
+    std::string Describe() const;
+
+    static const char* GetKnobName(Knob knob);
+
+    // 各项的级别 → 画质参数
+    static Quality QualityForLevels(const int levels[KNOB_COUNT]);
+
+private:
+    Settings m_Settings;
+    int m_Levels[KNOB_COUNT];
+    Quality m_Quality;
+
+    float m_SmoothedCpu;
+    float m_SmoothedGpu;
+    float m_LastGpu;            // 最近一次取回的 GPU 时间
+    float m_RecentFrame;        // 近几帧的帧时间（权重大的指数平均）
+
+    int m_OverFrames;           // 漏桶
+    int m_UnderFrames;          // 连续有余量的帧数
+    int m_SettleFrames;         // 剩余的不判断帧数
+    int m_UpgradeWait;          // 当前升级前要等的帧数
+    int m_FramesSinceChange;
+    bool m_LastChangeWasUpgrade;
+    int m_ChangeCount;
+
+    // 降过级的项，升级时从后往前恢复
+    struct Step
+    {
+        Knob knob;
+        float costRatio;        // 降级后 / 降级前的帧时间，还没测到时为 0
+    };
+    std::vector<Step> m_History;
+    float m_FrameBeforeDegrade; // 最近一次降级前的 m_RecentFrame
+
+    bool Degrade();
+    bool Upgrade();
+    void OnChanged(bool upgrade);
+};
+
+#endif // FRAME_GOVERNOR_H
@@ -0,0 +1,69 @@
+#include "FramePipeline.h"
+#include "nclgl/JobSystem.h"
+#include <chrono>
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    float ToMsec(Clock::duration d)
+    {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+}
+
+FramePipeline::FramePipeline(FrameStages& stages, bool pipelined)
+    : m_Stages(stages)
+    , m_Pipelined(pipelined)
+    , m_HasUpdate(false)
+    , m_UpdateMsec(0.0f)
+    , m_UpdateMs(0.0f)
+{
+}
+
+FramePipeline::Timing FramePipeline::RunFrame(float msec)
+{
+    Timing timing = { 0.0f, 0.0f, 0.0f };
+    Clock::time_point start = Clock::now();
+
+    if (!m_Pipelined)
+    {
+        m_Stages.UpdateScene(msec);
+        Clock::time_point updated = Clock::now();
+        m_Stages.PublishFrame();
+        m_Stages.RenderScene();
+
+        timing.updateMs = ToMsec(updated - start);
+        timing.renderMs = ToMsec(Clock::now() - updated);
+        timing.frameMs = ToMsec(Clock::now() - start);
+        return timing;
+    }
+
+    // 上一帧的更新已经完成（上次 RunFrame 等过），这里执行它排队的上传并发布快照
+    if (m_HasUpdate)
+    {
+        m_Stages.PublishFrame();
+    }
+
+    // 下一帧的模拟交给作业系统；模拟内部的并行循环由其余工作线程分担
+    JobSystem& jobs = JobSystem::Get();
+    // 作业只捕获 this，std::function 不需要额外分配内存
+    JobCounter updated;
+    m_UpdateMsec = msec;
+    jobs.Run([this]() {
+        Clock::time_point updateStart = Clock::now();
+        m_Stages.UpdateScene(m_UpdateMsec);
+        m_UpdateMs = ToMsec(Clock::now() - updateStart);
+    }, &updated);
+
+    m_Stages.RenderScene();
+    timing.renderMs = ToMsec(Clock::now() - start);   // 包含前面的 PublishFrame
+
+    // 渲染完后主线程帮忙执行模拟剩下的作业
+    jobs.Wait(updated);
+    m_HasUpdate = true;
+    timing.updateMs = m_UpdateMs;
+
+    timing.frameMs = ToMsec(Clock::now() - start);
+    return timing;
+}
@@ -0,0 +1,56 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+// ========================================
+// 帧流水线
+// ========================================
+// 串行：  UpdateScene(N) → PublishFrame → RenderScene(N)
+// 流水线：PublishFrame(N) → [ UpdateScene(N+1) 在工作线程上
+//                            ‖ RenderScene(N) 在主线程（GL 线程）上 ]
+//
+// 流水线模式下 CPU 模拟和 GL 提交重叠执行，一帧的时间接近两者中较长的
+// 一个，而不是两者之和；代价是画面比输入晚一帧。
+// 第一帧还没有发布过快照，只会清屏。
+//
+// RunFrame 返回时更新已经完成，所以两帧之间（UpdateWindow、输入回放、
+// 基准测试改相机等）可以放心修改场景
+// ========================================
+
+// 流水线驱动的三个阶段，约定见 Renderer.h 的“帧流水线”一节。
+// Renderer 实现它；基准测试和测试用不需要 GL 的合成负载
+// （Benchmarks/SyntheticFrame.h）
+class FrameStages
+{
+public:
+    virtual ~FrameStages() {}
+
+    virtual void UpdateScene(float msec) = 0;
+    virtual void PublishFrame() = 0;
+    virtual void RenderScene() = 0;
+};
+
+class FramePipeline
+{
+public:
+    struct Timing
+    {
+        float updateMs;   // UpdateScene
+        float renderMs;   // PublishFrame + RenderScene（GL 工作）
+        float frameMs;    // 整帧；流水线模式下小于两者之和
+    };
+
+    FramePipeline(FrameStages& stages, bool pipelined);
+
+    Timing RunFrame(float msec);
+
+    bool IsPipelined() const { return m_Pipelined; }
+
+private:
+    FrameStages& m_Stages;
+    bool m_Pipelined;
+    bool m_HasUpdate;   // 有一帧已经更新完、还没有发布
+    float m_UpdateMsec; // 交给更新作业的帧时间
+    float m_UpdateMs;   // 更新作业测得的耗时
+};
+
+#endif // FRAME_PIPELINE_H
@@ -0,0 +1,150 @@
+#include "FrameTimeRecorder.h"
+#include "nclgl/Log.h"
+#include "nclgl/MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+FrameTimeRecorder::FrameTimeRecorder(int expectedFrames)
+{
+    if (expectedFrames > 0)
+        m_Frames.reserve(expectedFrames);
+}
+
+int FrameTimeRecorder::AddFrame(float updateMs, float renderMs, float frameMs)
+{
+    Frame frame;
+    frame.updateMs = updateMs;
+    frame.renderMs = renderMs;
+    frame.cpuMs = frameMs >= 0.0f ? frameMs : updateMs + renderMs;
+    frame.gpuMs = -1.0f;
+    frame.cpuBytes = MemoryTracker::GetTotal(MEMORY_CPU).current;
+    frame.gpuBytes = MemoryTracker::GetTotal(MEMORY_GPU_BUFFER).current +
+                     MemoryTracker::GetTotal(MEMORY_GPU_TEXTURE).current;
+    m_Frames.push_back(frame);
+    return static_cast<int>(m_Frames.size()) - 1;
+}
+
+void FrameTimeRecorder::SetGpuTime(int frame, float milliseconds)
+{
+    if (frame < 0 || frame >= GetFrameCount())
+        return;
+    m_Frames[frame].gpuMs = milliseconds;
+}
+
+// ========================================
+// 统计
+// ========================================
+// 百分位用最近秩法：p 分位 = 排序后第 ceil(p × n) 个值，
+// 结果一定是某一帧的实际时间
+// ========================================
+FrameTimeRecorder::Summary FrameTimeRecorder::Summarize(const std::vector<float>& values,
+                                                        const std::vector<int>& frames)
+{
+    Summary summary = { 0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1 };
+    if (values.empty())
+        return summary;
+
+    summary.count = static_cast<int>(values.size());
+    double total = 0.0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        total += values[i];
+        if (summary.worstFrame < 0 || values[i] > summary.worst)
+        {
+            summary.worst = values[i];
+            summary.worstFrame = frames[i];
+        }
+    }
+    summary.mean = static_cast<float>(total / values.size());
+
+    std::vector<float> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+        int rank = static_cast<int>(std::ceil(p * sorted.size()));
+        return sorted[std::max(0, std::min(static_cast<int>(sorted.size()) - 1, rank - 1))];
+    };
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    return summary;
+}
+
+FrameTimeRecorder::Summary FrameTimeRecorder::SummarizeCpu() const
+{
+    std::vector<float> values;
+    std::vector<int> frames;
+    values.reserve(m_Frames.size());
+    frames.reserve(m_Frames.size());
+    for (int i = 0; i < GetFrameCount(); ++i)
+    {
+        values.push_back(m_Frames[i].cpuMs);
+        frames.push_back(i);
+    }
+    return Summarize(values, frames);
+}
+
+FrameTimeRecorder::Summary FrameTimeRecorder::SummarizeGpu() const
+{
+    std::vector<float> values;
+    std::vector<int> frames;
+    for (int i = 0; i < GetFrameCount(); ++i)
+    {
+        if (m_Frames[i].gpuMs >= 0.0f)
+        {
+            values.push_back(m_Frames[i].gpuMs);
+            frames.push_back(i);
+        }
+    }
+    return Summarize(values, frames);
+}
+
+bool FrameTimeRecorder::WriteCsv(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        LOG_ERROR("错误：无法写入帧时间文件 " << path);
+        return false;
+    }
+
+    file << "frame,update_ms,render_ms,cpu_ms,gpu_ms,cpu_mem_mb,gpu_mem_mb\n";
+    file << std::fixed << std::setprecision(4);
+    for (int i = 0; i < GetFrameCount(); ++i)
+    {
+        const Frame& frame = m_Frames[i];
+        file << i << ',' << frame.updateMs << ',' << frame.renderMs << ',' << frame.cpuMs << ',';
+        if (frame.gpuMs >= 0.0f)
+            file << frame.gpuMs;
+        file << ',' << frame.cpuBytes / (1024.0 * 1024.0) << ',' << frame.gpuBytes / (1024.0 * 1024.0) << '\n';
+    }
+
+    if (!file.good())
+    {
+        LOG_ERROR("错误：写入帧时间文件 " << path << " 失败");
+        return false;
+    }
+    LOG_INFO("✓ 帧时间已写入 " << path << "（" << GetFrameCount() << " 帧）");
+    return true;
+}
+
+void FrameTimeRecorder::PrintSummary() const
+{
+    auto print = [](const char* label, const Summary& summary) {
+        char line[160];
+        snprintf(line, sizeof(line), "  %s  平均 %.3f  p50 %.3f  p95 %.3f  p99 %.3f  最差 %.3f（第 %d 帧）",
+                 label, summary.mean, summary.p50, summary.p95, summary.p99, summary.worst, summary.worstFrame);
+        LOG_INFO(line);
+    };
+
+    LOG_INFO("\n帧时间统计（毫秒，" << GetFrameCount() << " 帧）：");
+    print("CPU", SummarizeCpu());
+
+    Summary gpu = SummarizeGpu();
+    if (gpu.count > 0)
+        print("GPU", gpu);
+    else
+        LOG_INFO("  GPU  无数据");
+}
@@ -0,0 +1,67 @@
+#ifndef FRAME_TIME_RECORDER_H
+#define FRAME_TIME_RECORDER_H
+
+#include <string>
+#include <vector>
+
+// ========================================
+// 帧时间记录与统计（基准测试用）
+// ========================================
+// 功能：
+// 1. 每帧记录 CPU 时间（更新 / 渲染两部分，以及整帧时间）和 GPU 时间
+//    GPU 时间通常晚几帧才拿到，按帧编号补填；没有 GPU 时间的帧为 -1
+// 2. 统计：平均、p50 / p95 / p99（最近秩法）、最差帧及其编号
+// 3. 输出每帧明细 CSV，方便不同提交之间对比
+// 4. 每帧同时记下 MemoryTracker 统计的内存和显存总量
+// ========================================
+
+class FrameTimeRecorder
+{
+public:
+    struct Frame
+    {
+        float updateMs;
+        float renderMs;
+        float cpuMs;     // 整帧时间；两部分串行执行时为 updateMs + renderMs
+        float gpuMs;     // -1 表示没有数据
+        long long cpuBytes;   // 记录这一帧时的内存总量
+        long long gpuBytes;   // 显存总量（缓冲 + 纹理）
+    };
+
+    struct Summary
+    {
+        int count;
+        float mean;
+        float p50;
+        float p95;
+        float p99;
+        float worst;
+        int worstFrame;
+    };
+
+    explicit FrameTimeRecorder(int expectedFrames = 0);
+
+    // 返回帧编号；frameMs < 0 表示两部分串行执行，整帧时间取两者之和
+    int AddFrame(float updateMs, float renderMs, float frameMs = -1.0f);
+    void SetGpuTime(int frame, float milliseconds);
+
+    int GetFrameCount() const { return static_cast<int>(m_Frames.size()); }
+    const Frame& GetFrame(int frame) const { return m_Frames[frame]; }
+
+    Summary SummarizeCpu() const;
+    Summary SummarizeGpu() const;   // 只统计有 GPU 时间的帧；count 为 0 表示没有数据
+
+    // 写出 CSV：frame,update_ms,render_ms,cpu_ms,gpu_ms,cpu_mem_mb,gpu_mem_mb；
+    // 失败时输出错误并返回 false
+    bool WriteCsv(const std::string& path) const;
+
+    // 输出统计结果到控制台
+    void PrintSummary() const;
+
+private:
+    std::vector<Frame> m_Frames;
+
+    static Summary Summarize(const std::vector<float>& values, const std::vector<int>& frames);
+};
+
+#endif // FRAME_TIME_RECORDER_H
@@ -0,0 +1,86 @@
+#include "GpuTimer.h"
+#include "nclgl/Log.h"
+#include <algorithm>
+
+GpuTimer::GpuTimer(int latency)
+    : m_Supported(false)
+    , m_Active(false)
+    , m_Head(0)
+    , m_Pending(0)
+{
+    // 计时查询是 OpenGL 3.3 核心功能，旧驱动可能没有
+    m_Supported = glGenQueries != nullptr && glBeginQuery != nullptr &&
+                  glGetQueryObjectui64v != nullptr;
+    if (!m_Supported)
+    {
+        LOG_ERROR("错误：驱动不支持 GPU 计时查询，只记录 CPU 时间");
+        return;
+    }
+
+    m_Queries.resize(std::max(latency, 2));
+    for (Query& query : m_Queries)
+    {
+        glGenQueries(1, &query.id);
+        query.frame = -1;
+    }
+}
+
+GpuTimer::~GpuTimer()
+{
+    for (Query& query : m_Queries)
+        glDeleteQueries(1, &query.id);
+}
+
+void GpuTimer::Begin(int frame)
+{
+    if (!m_Supported || m_Active || IsFull())
+        return;
+
+    int slot = (m_Head + m_Pending) % static_cast<int>(m_Queries.size());
+    m_Queries[slot].frame = frame;
+    glBeginQuery(GL_TIME_ELAPSED, m_Queries[slot].id);
+    m_Active = true;
+}
+
+void GpuTimer::End()
+{
+    if (!m_Supported || !m_Active)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m_Active = false;
+    ++m_Pending;
+}
+
+bool GpuTimer::Poll(int& frame, float& milliseconds)
+{
+    return Collect(false, frame, milliseconds);
+}
+
+bool GpuTimer::Wait(int& frame, float& milliseconds)
+{
+    return Collect(true, frame, milliseconds);
+}
+
+bool GpuTimer::Collect(bool wait, int& frame, float& milliseconds)
+{
+    if (!m_Supported || m_Pending == 0)
+        return false;
+
+    Query& query = m_Queries[m_Head];
+    if (!wait)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &nanoseconds);
+    frame = query.frame;
+    milliseconds = static_cast<float>(static_cast<double>(nanoseconds) / 1.0e6);
+
+    m_Head = (m_Head + 1) % static_cast<int>(m_Queries.size());
+    --m_Pending;
+    return true;
+}
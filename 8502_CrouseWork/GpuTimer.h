@@ -0,0 +1,55 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+#include <vector>
+
+// ========================================
+// GPU 帧时间（GL_TIME_ELAPSED 查询）
+// ========================================
+// 功能：
+// 1. Begin / End 之间提交的 GL 命令在 GPU 上执行的时间
+// 2. 查询结果要等 GPU 执行完才有，立即读取会让 CPU 等 GPU；
+//    这里用一圈查询对象轮流使用，Poll 只取已经完成的结果，
+//    通常晚几帧拿到，不会阻塞
+// 3. 驱动不支持计时查询时 IsSupported 返回 false，Begin/End 什么也不做
+// ========================================
+
+class GpuTimer
+{
+public:
+    // latency：同时在途的查询数（≥ 2）
+    explicit GpuTimer(int latency = 4);
+    ~GpuTimer();
+
+    bool IsSupported() const { return m_Supported; }
+    bool IsFull() const { return m_Supported && m_Pending == static_cast<int>(m_Queries.size()); }
+
+    // frame 为调用方的帧编号，Poll 时原样返回
+    // 在途查询已满（IsFull）时 Begin 不计时，调用方应先 Wait 取回最早的结果
+    void Begin(int frame);
+    void End();
+
+    // 取回一个已经完成的结果（按提交顺序）；没有时返回 false
+    bool Poll(int& frame, float& milliseconds);
+
+    // 等待并取回最早的一个在途结果（结束测量时用）；没有在途查询时返回 false
+    bool Wait(int& frame, float& milliseconds);
+
+private:
+    struct Query
+    {
+        GLuint id;
+        int frame;
+    };
+
+    bool m_Supported;
+    bool m_Active;
+    std::vector<Query> m_Queries;
+    int m_Head;      // 最早的在途查询
+    int m_Pending;   // 在途查询数
+
+    bool Collect(bool wait, int& frame, float& milliseconds);
+};
+
+#endif // GPU_TIMER_H
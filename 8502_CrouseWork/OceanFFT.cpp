@@ -0,0 +1,535 @@
+#include "OceanFFT.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
+#include <emmintrin.h>  // SSE2（x64 下始终可用）
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    const float GRAVITY = 9.81f;
+    const float PI = 3.14159265358979f;
+    const double TWO_PI_D = 6.283185307179586;
+
+    bool IsPowerOfTwo(int n)
+    {
+        return n > 0 && (n & (n - 1)) == 0;
+    }
+
+    // 标准正态分布随机数（Box-Muller）
+    // 不用 std::normal_distribution：它的实现因标准库而异，换编译器结果会变
+    struct Gaussian
+    {
+        std::mt19937 rng;
+
+        explicit Gaussian(unsigned int seed) : rng(seed) {}
+
+        float Uniform()
+        {
+            // (0, 1]
+            return ((rng() >> 8) + 1) * (1.0f / 16777216.0f);
+        }
+
+        void Next(float& a, float& b)
+        {
+            float u1 = Uniform();
+            float u2 = Uniform();
+            float r = std::sqrt(-2.0f * std::log(u1));
+            a = r * std::cos(2.0f * PI * u2);
+            b = r * std::sin(2.0f * PI * u2);
+        }
+    };
+}
+
+OceanFFT::OceanFFT(const Settings& settings, unsigned int threadCount)
+    : m_Settings(settings)
+    , m_ThreadCount(threadCount)
+    , m_N(settings.resolution)
+    , m_Time(0.0f)
+    , m_PreviousTime(0.0f)
+    , m_DisplacementTexture(0)
+    , m_NormalFoamTexture(0)
+    , m_CpuMemory(MEMORY_WATER, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_WATER, MEMORY_GPU_TEXTURE)
+{
+    if (!IsPowerOfTwo(m_N) || m_N < 16 || m_N > 1024)
+    {
+        LOG_ERROR("错误：海浪网格分辨率必须是 16 - 1024 之间的2的幂，已改为256");
+        m_N = 256;
+        m_Settings.resolution = 256;
+    }
+
+    size_t count = static_cast<size_t>(m_N) * m_N;
+    for (int f = 0; f < FIELD_COUNT; ++f)
+    {
+        m_Re[f].assign(count, 0.0f);
+        m_Im[f].assign(count, 0.0f);
+        m_ScratchRe[f].assign(count, 0.0f);
+        m_ScratchIm[f].assign(count, 0.0f);
+    }
+    m_Displacement.assign(count * 4, 0.0f);
+    m_NormalFoam.assign(count * 4, 0.0f);
+    m_PreviousDisplacement.assign(count * 4, 0.0f);
+
+    // 位反转表
+    int bits = 0;
+    while ((1 << bits) < m_N)
+        ++bits;
+    m_BitReverse.resize(m_N);
+    for (int i = 0; i < m_N; ++i)
+    {
+        int r = 0;
+        for (int b = 0; b < bits; ++b)
+        {
+            if (i & (1 << b))
+                r |= 1 << (bits - 1 - b);
+        }
+        m_BitReverse[i] = r;
+    }
+
+    // 逆FFT的旋转因子 e^{+2πi·j/N}
+    m_TwiddleRe.resize(m_N / 2);
+    m_TwiddleIm.resize(m_N / 2);
+    for (int j = 0; j < m_N / 2; ++j)
+    {
+        double angle = TWO_PI_D * j / m_N;
+        m_TwiddleRe[j] = static_cast<float>(std::cos(angle));
+        m_TwiddleIm[j] = static_cast<float>(std::sin(angle));
+    }
+
+    InitSpectrum();
+
+    size_t bytes = VectorBytes(m_H0Re) + VectorBytes(m_H0Im) + VectorBytes(m_H0ConjRe) +
+                   VectorBytes(m_H0ConjIm) + VectorBytes(m_Omega) + VectorBytes(m_BitReverse) +
+                   VectorBytes(m_TwiddleRe) + VectorBytes(m_TwiddleIm) + VectorBytes(m_Displacement) +
+                   VectorBytes(m_NormalFoam) + VectorBytes(m_PreviousDisplacement);
+    for (int f = 0; f < FIELD_COUNT; ++f)
+    {
+        bytes += VectorBytes(m_Re[f]) + VectorBytes(m_Im[f]) +
+                 VectorBytes(m_ScratchRe[f]) + VectorBytes(m_ScratchIm[f]);
+    }
+    m_CpuMemory.Set(bytes);
+
+    LOG_INFO("✓ 海浪频谱初始化完成: " << m_N << "×" << m_N
+             << "，平铺尺寸 " << m_Settings.patchSize);
+}
+
+OceanFFT::~OceanFFT()
+{
+    if (m_DisplacementTexture != 0)
+        glDeleteTextures(1, &m_DisplacementTexture);
+    if (m_NormalFoamTexture != 0)
+        glDeleteTextures(1, &m_NormalFoamTexture);
+}
+
+// ========================================
+// 海浪谱（波数空间的方向谱密度）
+// ========================================
+// Phillips：A · exp(-1/(kL)²) / k⁴ · (k̂·ŵ)²，L = V²/g
+//           逆风方向的波额外衰减
+// JONSWAP： 频率谱 S(ω) = α g² / ω⁵ · exp(-5/4 (ωp/ω)⁴) · γ^r
+//           换算到波数：S(k) = S(ω) · dω/dk / k，dω/dk = g / (2ω)
+//           方向分布 D(θ) = 2/π · cos²(θ - θw)（只在顺风半平面）
+// 两者都乘 exp(-k²l²) 抑制极短的波
+// ========================================
+float OceanFFT::SpectrumValue(float kx, float kz) const
+{
+    float k = std::sqrt(kx * kx + kz * kz);
+    if (k < 1e-6f)
+        return 0.0f;
+
+    float windX = std::cos(m_Settings.windAngle);
+    float windZ = std::sin(m_Settings.windAngle);
+    float cosTheta = (kx * windX + kz * windZ) / k;
+    float wind = std::max(m_Settings.windSpeed, 0.1f);
+    float cutoff = std::exp(-k * k * m_Settings.smallWaveCutoff * m_Settings.smallWaveCutoff);
+
+    if (m_Settings.spectrum == Spectrum::Phillips)
+    {
+        float L = wind * wind / GRAVITY;
+        float kL = k * L;
+        float value = m_Settings.amplitude * std::exp(-1.0f / (kL * kL)) / (k * k * k * k) *
+                      cosTheta * cosTheta * cutoff;
+        if (cosTheta < 0.0f)
+            value *= 0.07f;
+        return value;
+    }
+
+    // JONSWAP
+    if (cosTheta <= 0.0f)
+        return 0.0f;
+
+    float fetch = std::max(m_Settings.fetch, 1.0f);
+    float omega = std::sqrt(GRAVITY * k);
+    float alpha = 0.076f * std::pow(wind * wind / (fetch * GRAVITY), 0.22f);
+    float omegaPeak = 22.0f * std::pow(GRAVITY * GRAVITY / (wind * fetch), 1.0f / 3.0f);
+    float sigma = omega <= omegaPeak ? 0.07f : 0.09f;
+    float r = std::exp(-(omega - omegaPeak) * (omega - omegaPeak) /
+                       (2.0f * sigma * sigma * omegaPeak * omegaPeak));
+    float ratio = omegaPeak / omega;
+    float spectrumOmega = alpha * GRAVITY * GRAVITY / std::pow(omega, 5.0f) *
+                          std::exp(-1.25f * ratio * ratio * ratio * ratio) *
+                          std::pow(m_Settings.peakSharpness, r);
+
+    float dOmegaDk = GRAVITY / (2.0f * omega);
+    float direction = 2.0f / PI * cosTheta * cosTheta;
+    return spectrumOmega * dOmegaDk / k * direction * cutoff;
+}
+
+// ========================================
+// 初始频谱
+// ========================================
+// 频率按标准FFT顺序排列：下标 i < N/2 对应 +i，否则对应 i - N
+// h0(k) = (ξr + iξi) / √2 · √(S(k) · Δk²)，ξ 为标准正态随机数
+// 奈奎斯特频率（i = N/2）处 -k 与 k 重合，无法保持共轭对称，直接置零
+// ========================================
+void OceanFFT::InitSpectrum()
+{
+    int N = m_N;
+    size_t count = static_cast<size_t>(N) * N;
+    float dk = 2.0f * PI / m_Settings.patchSize;
+
+    m_H0Re.assign(count, 0.0f);
+    m_H0Im.assign(count, 0.0f);
+    m_H0ConjRe.assign(count, 0.0f);
+    m_H0ConjIm.assign(count, 0.0f);
+    m_Omega.assign(count, 0.0f);
+
+    Gaussian gaussian(m_Settings.seed);
+    for (int z = 0; z < N; ++z)
+    {
+        int mz = z < N / 2 ? z : z - N;
+        for (int x = 0; x < N; ++x)
+        {
+            int mx = x < N / 2 ? x : x - N;
+            size_t index = static_cast<size_t>(z) * N + x;
+
+            // 每个频率都取一次随机数，保证随机序列与参数无关
+            float xiRe, xiIm;
+            gaussian.Next(xiRe, xiIm);
+
+            float kx = mx * dk;
+            float kz = mz * dk;
+            m_Omega[index] = std::sqrt(GRAVITY * std::sqrt(kx * kx + kz * kz));
+
+            if (mx == -N / 2 || mz == -N / 2)
+                continue;
+
+            float amplitude = std::sqrt(SpectrumValue(kx, kz) * dk * dk) * 0.70710678f;
+            m_H0Re[index] = xiRe * amplitude;
+            m_H0Im[index] = xiIm * amplitude;
+        }
+    }
+
+    // conj(h0(-k))
+    for (int z = 0; z < N; ++z)
+    {
+        int nz = (N - z) % N;
+        for (int x = 0; x < N; ++x)
+        {
+            int nx = (N - x) % N;
+            size_t index = static_cast<size_t>(z) * N + x;
+            size_t mirror = static_cast<size_t>(nz) * N + nx;
+            m_H0ConjRe[index] = m_H0Re[mirror];
+            m_H0ConjIm[index] = -m_H0Im[mirror];
+        }
+    }
+}
+
+// ========================================
+// 每帧更新
+// ========================================
+void OceanFFT::Update(float time)
+{
+    // 保留上一帧的位移（BuildOutput 会整张覆盖 m_Displacement）
+    m_Displacement.swap(m_PreviousDisplacement);
+    m_PreviousTime = m_Time;
+    m_Time = time;
+
+    BuildFrequencyFields(time);
+    InverseFFT2D();
+    BuildOutput();
+}
+
+// ========================================
+// 推进频谱并生成4个打包的复数场
+// ========================================
+// h(k,t) = h0(k)·e^{iωt} + conj(h0(-k))·e^{-iωt}
+//
+// 各实数场的频谱（i 为虚数单位，k = |k|）：
+//   高度 h        水平位移 Dx = i·kx/k·h   Dz = i·kz/k·h
+//   坡度 sx = i·kx·h   sz = i·kz·h
+//   位移导数 Dxx = -kx²/k·h   Dzz = -kz²/k·h   Dxz = -kx·kz/k·h
+// 打包：F0 = h + i·Dx，F1 = Dz + i·sx，F2 = sz + i·Dxx，F3 = Dzz + i·Dxz
+// ========================================
+void OceanFFT::BuildFrequencyFields(float time)
+{
+    int N = m_N;
+    float dk = 2.0f * PI / m_Settings.patchSize;
+
+    ParallelFor(N, m_ThreadCount, [&](int z) {
+        int mz = z < N / 2 ? z : z - N;
+        float kz = mz * dk;
+
+        for (int x = 0; x < N; ++x)
+        {
+            int mx = x < N / 2 ? x : x - N;
+            float kx = mx * dk;
+            size_t index = static_cast<size_t>(z) * N + x;
+
+            // 相位取模后再转成 float，时间很大时也不会丢失精度
+            double phase = std::fmod(static_cast<double>(m_Omega[index]) * time, TWO_PI_D);
+            float c = static_cast<float>(std::cos(phase));
+            float s = static_cast<float>(std::sin(phase));
+
+            float hr = m_H0Re[index] * c - m_H0Im[index] * s + m_H0ConjRe[index] * c + m_H0ConjIm[index] * s;
+            float hi = m_H0Re[index] * s + m_H0Im[index] * c - m_H0ConjRe[index] * s + m_H0ConjIm[index] * c;
+
+            float k = std::sqrt(kx * kx + kz * kz);
+            float invK = k > 1e-6f ? 1.0f / k : 0.0f;
+
+            // i·a = (-a.im, a.re)
+            float dxRe = -kx * invK * hi, dxIm = kx * invK * hr;
+            float dzRe = -kz * invK * hi, dzIm = kz * invK * hr;
+            float sxRe = -kx * hi,        sxIm = kx * hr;
+            float szRe = -kz * hi,        szIm = kz * hr;
+            float dxxRe = -kx * kx * invK * hr, dxxIm = -kx * kx * invK * hi;
+            float dzzRe = -kz * kz * invK * hr, dzzIm = -kz * kz * invK * hi;
+            float dxzRe = -kx * kz * invK * hr, dxzIm = -kx * kz * invK * hi;
+
+            // X + i·Y = (X.re - Y.im) + i(X.im + Y.re)
+            m_Re[0][index] = hr - dxIm;      m_Im[0][index] = hi + dxRe;
+            m_Re[1][index] = dzRe - sxIm;    m_Im[1][index] = dzIm + sxRe;
+            m_Re[2][index] = szRe - dxxIm;   m_Im[2][index] = szIm + dxxRe;
+            m_Re[3][index] = dzzRe - dxzIm;  m_Im[3][index] = dzzIm + dxzRe;
+        }
+    });
+}
+
+// ========================================
+// 二维逆FFT
+// ========================================
+// 列FFT → 转置 → 列FFT
+// 不再转置回来：结果按 [x][z] 存放，BuildOutput 读取时交换下标
+// ========================================
+void OceanFFT::InverseFFT2D()
+{
+    int groups = m_N / 4;
+
+    ParallelFor(FIELD_COUNT * groups, m_ThreadCount, [&](int i) {
+        ColumnFFT(i / groups, i % groups);
+    });
+
+    ParallelFor(FIELD_COUNT * groups, m_ThreadCount, [&](int i) {
+        Transpose(i / groups, i % groups);
+    });
+    for (int f = 0; f < FIELD_COUNT; ++f)
+    {
+        m_Re[f].swap(m_ScratchRe[f]);
+        m_Im[f].swap(m_ScratchIm[f]);
+    }
+
+    ParallelFor(FIELD_COUNT * groups, m_ThreadCount, [&](int i) {
+        ColumnFFT(i / groups, i % groups);
+    });
+}
+
+// ========================================
+// 对第 group 组的4列同时做一维逆FFT（基2，迭代）
+// ========================================
+// 行主序存储时，同一行相邻的4列正好是连续的4个 float，
+// SSE 的4个通道各算一列，操作完全相同
+// ========================================
+void OceanFFT::ColumnFFT(int field, int group)
+{
+    int N = m_N;
+    float* re = m_Re[field].data() + group * 4;
+    float* im = m_Im[field].data() + group * 4;
+
+    // 位反转重排
+    for (int r = 0; r < N; ++r)
+    {
+        int rr = m_BitReverse[r];
+        if (rr > r)
+        {
+            __m128 a = _mm_loadu_ps(re + r * N);
+            __m128 b = _mm_loadu_ps(re + rr * N);
+            _mm_storeu_ps(re + r * N, b);
+            _mm_storeu_ps(re + rr * N, a);
+            a = _mm_loadu_ps(im + r * N);
+            b = _mm_loadu_ps(im + rr * N);
+            _mm_storeu_ps(im + r * N, b);
+            _mm_storeu_ps(im + rr * N, a);
+        }
+    }
+
+    // 蝶形运算
+    for (int size = 2; size <= N; size *= 2)
+    {
+        int half = size / 2;
+        int step = N / size;
+        for (int start = 0; start < N; start += size)
+        {
+            for (int k = 0; k < half; ++k)
+            {
+                __m128 wr = _mm_set1_ps(m_TwiddleRe[k * step]);
+                __m128 wi = _mm_set1_ps(m_TwiddleIm[k * step]);
+
+                float* aRe = re + (start + k) * N;
+                float* aIm = im + (start + k) * N;
+                float* bRe = re + (start + k + half) * N;
+                float* bIm = im + (start + k + half) * N;
+
+                __m128 ar = _mm_loadu_ps(aRe);
+                __m128 ai = _mm_loadu_ps(aIm);
+                __m128 br = _mm_loadu_ps(bRe);
+                __m128 bi = _mm_loadu_ps(bIm);
+
+                // t = b · w
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+
+                _mm_storeu_ps(aRe, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(aIm, _mm_add_ps(ai, ti));
+                _mm_storeu_ps(bRe, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(bIm, _mm_sub_ps(ai, ti));
+            }
+        }
+    }
+}
+
+// ========================================
+// 转置第 blockRow 行的 4×4 块，写入 scratch
+// ========================================
+void OceanFFT::Transpose(int field, int blockRow)
+{
+    int N = m_N;
+    const float* sources[2] = { m_Re[field].data(), m_Im[field].data() };
+    float* targets[2] = { m_ScratchRe[field].data(), m_ScratchIm[field].data() };
+
+    for (int part = 0; part < 2; ++part)
+    {
+        const float* src = sources[part] + blockRow * 4 * N;
+        float* dst = targets[part] + blockRow * 4;
+        for (int blockCol = 0; blockCol < N / 4; ++blockCol)
+        {
+            __m128 r0 = _mm_loadu_ps(src + 0 * N + blockCol * 4);
+            __m128 r1 = _mm_loadu_ps(src + 1 * N + blockCol * 4);
+            __m128 r2 = _mm_loadu_ps(src + 2 * N + blockCol * 4);
+            __m128 r3 = _mm_loadu_ps(src + 3 * N + blockCol * 4);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(dst + (blockCol * 4 + 0) * N, r0);
+            _mm_storeu_ps(dst + (blockCol * 4 + 1) * N, r1);
+            _mm_storeu_ps(dst + (blockCol * 4 + 2) * N, r2);
+            _mm_storeu_ps(dst + (blockCol * 4 + 3) * N, r3);
+        }
+    }
+}
+
+// ========================================
+// 生成位移、法线、泡沫网格
+// ========================================
+// 位移：(λ·Dx, h, λ·Dz)
+// 法线：normalize(-sx, 1, -sz)
+// 泡沫：雅可比 J = (1 + λDxx)(1 + λDzz) - (λDxz)²
+//       J < foamThreshold 的地方浪尖开始折叠，越小泡沫越多
+// ========================================
+void OceanFFT::BuildOutput()
+{
+    int N = m_N;
+    float scale = m_Settings.heightScale;
+    float lambda = m_Settings.choppiness * scale;
+    float threshold = m_Settings.foamThreshold;
+
+    ParallelFor(N, m_ThreadCount, [&](int z) {
+        for (int x = 0; x < N; ++x)
+        {
+            size_t source = static_cast<size_t>(x) * N + z;   // FFT结果按 [x][z] 存放
+            size_t target = (static_cast<size_t>(z) * N + x) * 4;
+
+            float h   = m_Re[0][source];
+            float dx  = m_Im[0][source];
+            float dz  = m_Re[1][source];
+            float sx  = m_Im[1][source];
+            float sz  = m_Re[2][source];
+            float dxx = m_Im[2][source];
+            float dzz = m_Re[3][source];
+            float dxz = m_Im[3][source];
+
+            m_Displacement[target + 0] = lambda * dx;
+            m_Displacement[target + 1] = scale * h;
+            m_Displacement[target + 2] = lambda * dz;
+            m_Displacement[target + 3] = 0.0f;
+
+            float nx = -sx * scale;
+            float nz = -sz * scale;
+            float invLength = 1.0f / std::sqrt(nx * nx + 1.0f + nz * nz);
+
+            float jacobian = (1.0f + lambda * dxx) * (1.0f + lambda * dzz) - lambda * lambda * dxz * dxz;
+            float foam = threshold > 0.0f ? (threshold - jacobian) / threshold : 0.0f;
+
+            m_NormalFoam[target + 0] = nx * invLength;
+            m_NormalFoam[target + 1] = invLength;
+            m_NormalFoam[target + 2] = nz * invLength;
+            m_NormalFoam[target + 3] = std::min(std::max(foam, 0.0f), 1.0f);
+        }
+    });
+}
+
+// ========================================
+// 上传纹理
+// ========================================
+// 每帧上传一次；远处的水面格子比纹理像素大，用 mipmap 避免闪烁
+// ========================================
+void OceanFFT::UploadTextures()
+{
+    bool create = m_DisplacementTexture == 0;
+    if (create)
+    {
+        glGenTextures(1, &m_DisplacementTexture);
+        glGenTextures(1, &m_NormalFoamTexture);
+    }
+
+    struct Target { GLuint id; GLint internalFormat; const float* data; };
+    Target targets[2] = {
+        { m_DisplacementTexture, GL_RGBA32F, m_Displacement.data() },
+        { m_NormalFoamTexture,   GL_RGBA16F, m_NormalFoam.data() }
+    };
+
+    for (const Target& target : targets)
+    {
+        glBindTexture(GL_TEXTURE_2D, target.id);
+        if (create)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, target.internalFormat, m_N, m_N, 0,
+                         GL_RGBA, GL_FLOAT, target.data);
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_N, m_N, GL_RGBA, GL_FLOAT, target.data);
+        }
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, static_cast<long long>(m_N) * m_N * (16 + 16));
+
+    // RGBA32F + RGBA16F，带 mipmap
+    if (create)
+        m_GpuMemory.Set(MemoryTracker::TextureBytes(m_N, m_N, 1, 16 + 8, true));
+}
+
+void OceanFFT::BindTextures(unsigned int firstUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_2D, m_DisplacementTexture);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_2D, m_NormalFoamTexture);
+    glActiveTexture(GL_TEXTURE0);
+    PerfCounters::Add(PERF_TEXTURE_BINDS, 2);
+}
@@ -0,0 +1,136 @@
+#ifndef OCEAN_FFT_H
+#define OCEAN_FFT_H
+
+#include <glad/glad.h>
+#include "nclgl/MemoryTracker.h"
+#include <vector>
+
+// ========================================
+// FFT 海浪模拟（Tessendorf 方法）
+// ========================================
+// 功能：
+// 1. 按 Phillips 或 JONSWAP 海浪谱生成初始频谱 h0(k)（固定种子，可重复）
+// 2. 每帧按色散关系 ω = √(g·k) 推进频谱，逆FFT得到一块可平铺的海面：
+//    - 位移网格：水平位移(x, z)（choppiness 控制浪尖锐度）+ 高度
+//    - 法线网格：由坡度计算
+//    - 泡沫网格：由位移的雅可比行列式计算（J 越小浪尖越“折叠”）
+// 3. 二维FFT：SSE 一次处理4列，按列组多线程；
+//    先对列做FFT、转置、再对列做FFT。每列只由一个线程按固定顺序计算，
+//    所以结果与线程数无关（确定性）
+// 4. 结果上传为纹理，水面着色器按世界坐标 / patchSize 平铺采样
+//
+// 频谱打包：输出都是实数场，两个实数场的频谱 A、B 可以合成 A + iB
+// 做一次复数逆FFT，结果的实部是 a、虚部是 b。8个实数场只需要4次FFT。
+// ========================================
+
+class OceanFFT
+{
+public:
+    enum class Spectrum
+    {
+        Phillips,   // 经典 Phillips 谱（amplitude 控制整体幅度）
+        JONSWAP     // 有限风区的 JONSWAP 谱（由风速和风区决定幅度）
+    };
+
+    // ========================================
+    // 海浪参数（长度单位：世界单位 = 米）
+    // ========================================
+    struct Settings
+    {
+        int      resolution     = 256;      // 网格分辨率（2的幂，16 - 1024）
+        float    patchSize      = 64.0f;    // 一块海面的边长（平铺周期）
+        Spectrum spectrum       = Spectrum::JONSWAP;
+        float    windSpeed      = 8.0f;     // 风速（米/秒）
+        float    windAngle      = 0.5f;     // 风向（弧度，从 +X 轴转向 +Z 轴）
+        float    fetch          = 20000.0f; // JONSWAP 风区长度（米）
+        float    peakSharpness  = 3.3f;     // JONSWAP 峰值增强因子 γ
+        float    amplitude      = 0.0005f;  // Phillips 幅度系数 A
+        float    heightScale    = 1.0f;     // 最终高度/位移的整体缩放
+        float    choppiness     = 1.0f;     // 水平位移强度 λ（0 = 纯正弦起伏）
+        float    smallWaveCutoff = 0.05f;   // 抑制波长小于此值的小波（米）
+        float    foamThreshold  = 0.6f;     // 雅可比行列式低于此值开始出现泡沫
+        unsigned int seed       = 1;
+    };
+
+    OceanFFT(const Settings& settings, unsigned int threadCount = 0);
+    ~OceanFFT();
+
+    // ========================================
+    // 计算 time 时刻的海面（秒）
+    // ========================================
+    void Update(float time);
+
+    // ========================================
+    // 纹理
+    // ========================================
+    // UploadTextures：上传当前网格（第一次调用时创建纹理）
+    // BindTextures：位移 → firstUnit，法线+泡沫 → firstUnit + 1
+    // ========================================
+    void UploadTextures();
+    void BindTextures(unsigned int firstUnit) const;
+    bool IsUploaded() const { return m_DisplacementTexture != 0; }
+
+    int GetResolution() const { return m_N; }
+    float GetPatchSize() const { return m_Settings.patchSize; }
+    const Settings& GetSettings() const { return m_Settings; }
+
+    // 网格数据（行主序，N × N × 4）
+    //   位移：(dx, 高度, dz, 0)
+    //   法线+泡沫：(nx, ny, nz, foam)
+    const std::vector<float>& GetDisplacement() const { return m_Displacement; }
+    const std::vector<float>& GetNormalFoam() const { return m_NormalFoam; }
+
+    // 上一次 Update 的位移网格和两次的时间（WaterQuery 用差分计算水面速度）
+    const std::vector<float>& GetPreviousDisplacement() const { return m_PreviousDisplacement; }
+    float GetTime() const { return m_Time; }
+    float GetPreviousTime() const { return m_PreviousTime; }
+
+private:
+    Settings m_Settings;
+    unsigned int m_ThreadCount;
+    int m_N;
+
+    // 初始频谱 h0(k) 和 conj(h0(-k))，以及每个频率的 ω
+    std::vector<float> m_H0Re, m_H0Im;
+    std::vector<float> m_H0ConjRe, m_H0ConjIm;
+    std::vector<float> m_Omega;
+
+    // 4个打包的复数场（实部/虚部分开存放，便于SIMD）
+    static const int FIELD_COUNT = 4;
+    std::vector<float> m_Re[FIELD_COUNT];
+    std::vector<float> m_Im[FIELD_COUNT];
+    std::vector<float> m_ScratchRe[FIELD_COUNT];
+    std::vector<float> m_ScratchIm[FIELD_COUNT];
+
+    // FFT 用的位反转表和旋转因子
+    std::vector<int> m_BitReverse;
+    std::vector<float> m_TwiddleRe, m_TwiddleIm;
+
+    // 输出网格
+    std::vector<float> m_Displacement;
+    std::vector<float> m_NormalFoam;
+    std::vector<float> m_PreviousDisplacement;
+    float m_Time;
+    float m_PreviousTime;
+
+    // OpenGL 纹理
+    GLuint m_DisplacementTexture;
+    GLuint m_NormalFoamTexture;
+
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+
+    // 初始化
+    void InitSpectrum();
+    float SpectrumValue(float kx, float kz) const;
+
+    // 每帧的步骤
+    void BuildFrequencyFields(float time);
+    void InverseFFT2D();
+    void ColumnFFT(int field, int group);
+    void Transpose(int field, int blockRow);
+    void BuildOutput();
+};
+
+#endif // OCEAN_FFT_H
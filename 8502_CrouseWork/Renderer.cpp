@@ -1,13 +1,38 @@
 ﻿#include "Renderer.h"
 #include "nclgl/common.h"
-#include <iostream>
-
-Renderer::Renderer(Window& parent) : OGLRenderer(parent) {
+#include "nclgl/JobSystem.h"
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// 水面：每层每边的格子数和最细格子边长（画质降低时格子数减少、边长反比增大，覆盖范围不变）
+static const int WATER_GRID_SIZE = 64;
+static const int WATER_LEVELS = 7;
+static const float WATER_BASE_CELL = 0.25f;
+
+Renderer::Renderer(Window& parent) : OGLRenderer(parent), pendingGLWork(frameArena) {
     // 初始化场景对象指针为 nullptr
     camera = nullptr;
     terrain = nullptr;
     skybox = nullptr;
     water = nullptr;
+    ocean = nullptr;
+    waterTime = 0.0f;
+    oceanSystem = shallowWaterSystem = erosionSystem = -1;
+    shallowTilesCounter = -1;
+    inputEnabled = true;
+    waterTiles = nullptr;
+    shoreDistance = nullptr;
+    shallowWater = nullptr;
+    terrainErosion = nullptr;
+    erosionActive = false;
+    terrainEditor = nullptr;
+    terrainBake = nullptr;
+    horizonBakePending = false;
+    terrainSplat = nullptr;
+    horizonBakeX0 = horizonBakeZ0 = horizonBakeX1 = horizonBakeZ1 = 0;
 
     terrainShader = nullptr;
     skyboxShader = nullptr;
@@ -15,6 +40,21 @@ Renderer::Renderer(Window& parent) : OGLRenderer(parent) {
 
     terrainTexture = nullptr;
 
+    overlay = nullptr;
+    overlayVisible = false;
+
+    // 最高画质，地形不做 LOD（误差阈值 0），远裁剪面 10000
+    quality.renderScale = 1.0f;
+    quality.terrainErrorPixels = 0.0f;
+    quality.waterGridSize = WATER_GRID_SIZE;
+    quality.drawDistance = 10000.0f;
+    lastSwapMs = 0.0f;
+    sceneFBO = sceneColour = sceneDepth = 0;
+    sceneWidth = sceneHeight = 0;
+
+    snapshots[0].valid = snapshots[1].valid = false;
+    updateSnapshot = 0;
+
     // 初始化参数
     lightPosition = Vector3(100.0f, 100.0f, 100.0f);
     lightColor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -28,68 +68,105 @@ Renderer::Renderer(Window& parent) : OGLRenderer(parent) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "初始化 Renderer..." << std::endl;
-    std::cout << "========================================" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("初始化 Renderer...");
+    LOG_INFO("========================================");
 
     // ========================================
     // 创建相机
     // ========================================
-    std::cout << "\n[1/5] 创建相机..." << std::endl;
+    LOG_INFO("\n[1/5] 创建相机...");
     camera = new Camera(Vector3(0.0f, 10.0f, 20.0f));  // 初始位置
     camera->MovementSpeed = cameraSpeed;
     camera->MouseSensitivity = mouseSensitivity;
-    std::cout << "✓ 相机创建成功" << std::endl;
+    LOG_INFO("✓ 相机创建成功");
 
     // ========================================
     // 加载着色器
     // ========================================
-    std::cout << "\n[2/5] 加载着色器..." << std::endl;
+    LOG_INFO("\n[2/5] 加载着色器...");
 
     // 注意：路径相对于可执行文件所在目录（x64/Debug/）
     // 需要向上两级到达项目目录，然后进入 Shaders
     terrainShader = new Shader("terrainVertex.glsl",
                                 "terrainFragment.glsl");
     if (!terrainShader->LoadSuccess()) {
-        std::cerr << "✗ 地形着色器加载失败！" << std::endl;
+        LOG_ERROR("✗ 地形着色器加载失败！");
         init = false;
         return;
     }
-    std::cout << "✓ 地形着色器加载成功" << std::endl;
+    LOG_INFO("✓ 地形着色器加载成功");
 
     skyboxShader = new Shader("skyboxVertex.glsl",
                                "skyboxFragment.glsl");
     if (!skyboxShader->LoadSuccess()) {
-        std::cerr << "✗ 天空盒着色器加载失败！" << std::endl;
+        LOG_ERROR("✗ 天空盒着色器加载失败！");
         init = false;
         return;
     }
-    std::cout << "✓ 天空盒着色器加载成功" << std::endl;
+    LOG_INFO("✓ 天空盒着色器加载成功");
 
     waterShader = new Shader("waterVertex.glsl",
                               "waterFragment.glsl");
     if (!waterShader->LoadSuccess()) {
-        std::cerr << "✗ 水面着色器加载失败！" << std::endl;
+        LOG_ERROR("✗ 水面着色器加载失败！");
         init = false;
         return;
     }
-    std::cout << "✓ 水面着色器加载成功" << std::endl;
+    LOG_INFO("✓ 水面着色器加载成功");
 
     // ========================================
     // 创建地形
     // ========================================
-    std::cout << "\n[3/5] 创建地形..." << std::endl;
+    LOG_INFO("\n[3/5] 创建地形...");
     terrain = new Terrain(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
 
+    // 侵蚀模拟：高度换算成格子单位 = 高度缩放 / 格子间距
+    TerrainErosion::Settings erosionSettings;
+    if (terrain->GetWidth() > 1) {
+        float cellSize = terrain->GetTerrainSize() / (terrain->GetWidth() - 1);
+        erosionSettings.verticalScale = terrain->GetHeightScale() / cellSize;
+    }
+    terrainErosion = new TerrainErosion(erosionSettings);
+    terrainEditor = new TerrainEditor(*terrain);
+
+    // 烘焙法线/地平线/AO贴图（高度图不变时直接读取缓存）
+    LOG_INFO("烘焙地形光照贴图...");
+    TerrainBake::Settings bakeSettings;
+    terrainBake = new TerrainBake(bakeSettings);
+    terrainBake->LoadOrBake(*terrain);
+    terrainBake->UploadTextures();
+
+    // 材质混合图：低处草地、高处草甸、陡坡岩石
+    LOG_INFO("生成地形材质混合图...");
+    std::vector<TerrainSplat::Layer> splatLayers(3);
+    splatLayers[0].texturePath = TEXTUREDIR"grass.jpg";
+    splatLayers[0].maxHeight = 0.12f;
+    splatLayers[0].maxSlope = 0.15f;
+    splatLayers[0].slopeFade = 0.05f;
+    splatLayers[1].texturePath = TEXTUREDIR"grass11.jpg";
+    splatLayers[1].minHeight = 0.12f;
+    splatLayers[1].maxSlope = 0.15f;
+    splatLayers[1].slopeFade = 0.05f;
+    splatLayers[2].texturePath = TEXTUREDIR"Barren Reds.JPG";
+    splatLayers[2].minSlope = 0.15f;
+    splatLayers[2].slopeFade = 0.05f;
+
+    TerrainSplat::Settings splatSettings;
+    terrainSplat = new TerrainSplat(splatLayers, splatSettings);
+    terrainSplat->Generate(*terrain);
+    terrainSplat->UploadSplatMap();
+    terrainSplat->LoadLayerTextures();
+
     // 加载地形纹理
-    std::cout << "加载地形纹理..." << std::endl;
+    LOG_INFO("加载地形纹理...");
     terrainTexture = new Texture(TEXTUREDIR"grass.jpg", true);
-    std::cout << "✓ 地形纹理加载成功" << std::endl;
+    LOG_INFO("✓ 地形纹理加载成功");
 
     // ========================================
     // 创建天空盒
     // ========================================
-    std::cout << "\n[4/5] 创建天空盒..." << std::endl;
+    LOG_INFO("\n[4/5] 创建天空盒...");
     std::vector<std::string> faces = {
          TEXTUREDIR"skybox/right.jpg",
          TEXTUREDIR"skybox/left.jpg",
@@ -101,18 +178,73 @@ Renderer::Renderer(Window& parent) : OGLRenderer(parent) {
     skybox = new Skybox(faces);
 
     // ========================================
-    // 创建水面（暂时注释，等其他对象就绪后再启用）
+    // 创建水面
     // ========================================
-    std::cout << "\n[5/5] 创建水面..." << std::endl;
-    std::cout << "  (暂时跳过 - 等地形和天空盒就绪)" << std::endl;
-    water = new WaterPlane(0.0f, 1000.0f, 100);
+    // 7层，每层64×64格，最细格子0.25：
+    // 覆盖 1024 单位（与原来的 1000 单位水面相当），相机附近顶点间距 0.25
+    LOG_INFO("\n[5/5] 创建水面...");
+    water = new WaterClipmap(0.0f, WATER_GRID_SIZE, WATER_LEVELS, WATER_BASE_CELL);
+    water->Update(camera->Position);
+
+    // FFT 海浪：64单位一块，128×128 网格（单线程约2毫秒）
+    // 风速/风区较小，浪高与原来的正弦波水面相当（最高约0.1）
+    OceanFFT::Settings oceanSettings;
+    oceanSettings.resolution = 128;
+    oceanSettings.patchSize = 64.0f;
+    oceanSettings.windSpeed = 5.0f;
+    oceanSettings.fetch = 1000.0f;
+    oceanSettings.choppiness = 1.3f;
+    ocean = new OceanFFT(oceanSettings);
+    ocean->Update(waterTime);
+    ocean->UploadTextures();
+
+    // 水面分块：高度图每 32 格一块；留 0.5 的余量给波峰和水平位移
+    waterTiles = new WaterTileMap(*terrain, water->GetWaterLevel(), 0.5f, 32);
+    waterTiles->UploadMask();
+    water->SetTileMap(waterTiles);
+
+    // 岸线距离场：编码范围 ±4 单位
+    shoreDistance = new ShorelineDistance(4.0f);
+    shoreDistance->Compute(*terrain, water->GetWaterLevel());
+    shoreDistance->UploadTexture();
+
+    // 浅水模拟：高度图每 4 格取一个格子（257×257），32×32 格一块
+    ShallowWater::Settings shallowSettings;
+    shallowSettings.seaLevel = water->GetWaterLevel();
+    shallowSettings.timeStep = 1.0f / 30.0f;
+    shallowWater = new ShallowWater(*terrain, shallowSettings);
+
+    // ========================================
+    // 模拟系统（固定步长，每帧按实际经过的时间执行若干步）
+    // ========================================
+    // 海浪是动画，60 Hz；浅水和侵蚀计算量大，30 Hz
+    // 侵蚀默认暂停，按 E 开关
+    oceanSystem = simClock.AddSystem("ocean", 60, 4, [this](float dt) {
+        waterTime += dt;
+        ocean->Update(waterTime);
+    });
+    shallowWaterSystem = simClock.AddSystem("shallowWater", 30, 2, [this](float) {
+        shallowWater->Step();
+    });
+    erosionSystem = simClock.AddSystem("erosion", 30, 1, [this](float) {
+        terrainErosion->Run(terrain->GetHeightData(), terrain->GetWidth(), terrain->GetHeight(), 1);
+    });
+    simClock.SetSystemEnabled(erosionSystem, erosionActive);
+    shallowTilesCounter = PerfCounters::Register("shallow_tiles", PERF_GAUGE);
+
+    // 文字叠加层（按 O 显示性能计数器）；失败只是没有叠加层
+    overlay = new TextOverlay(2);
+    if (!overlay->IsValid()) {
+        delete overlay;
+        overlay = nullptr;
+    }
 
     // 初始化成功
     init = true;
 
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "✓ Renderer 初始化完成" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("✓ Renderer 初始化完成");
+    LOG_INFO("========================================\n");
 }
 
 Renderer::~Renderer() {
@@ -121,6 +253,14 @@ Renderer::~Renderer() {
     if (terrain) delete terrain;
     if (skybox) delete skybox;
     if (water) delete water;
+    if (ocean) delete ocean;
+    if (waterTiles) delete waterTiles;
+    if (shoreDistance) delete shoreDistance;
+    if (shallowWater) delete shallowWater;
+    if (terrainErosion) delete terrainErosion;
+    if (terrainEditor) delete terrainEditor;
+    if (terrainBake) delete terrainBake;
+    if (terrainSplat) delete terrainSplat;
 
     // 清理着色器
     if (terrainShader) delete terrainShader;
@@ -130,7 +270,10 @@ Renderer::~Renderer() {
     // 清理纹理
     if (terrainTexture) delete terrainTexture;
 
-    std::cout << "Renderer destroyed" << std::endl;
+    if (overlay) delete overlay;
+    ReleaseSceneTarget();
+
+    LOG_INFO("Renderer destroyed");
 }
 
 void Renderer::UpdateScene(float msec) {
@@ -142,36 +285,349 @@ void Renderer::UpdateScene(float msec) {
     // ========================================
     // 处理键盘输入 - 相机移动
     // ========================================
-    if (Window::GetKeyboard()->KeyDown(KEYBOARD_W)) {
+    if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_W)) {
         camera->ProcessKeyboard(FORWARD, deltaTime);
     }
-    if (Window::GetKeyboard()->KeyDown(KEYBOARD_S)) {
+    if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_S)) {
         camera->ProcessKeyboard(BACKWARD, deltaTime);
     }
-    if (Window::GetKeyboard()->KeyDown(KEYBOARD_A)) {
+    if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_A)) {
         camera->ProcessKeyboard(LEFT, deltaTime);
     }
-    if (Window::GetKeyboard()->KeyDown(KEYBOARD_D)) {
+    if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_D)) {
         camera->ProcessKeyboard(RIGHT, deltaTime);
     }
-    if (Window::GetKeyboard()->KeyDown(KEYBOARD_SPACE)) {
+    if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_SPACE)) {
         camera->ProcessKeyboard(UP, deltaTime);
     }
-    if (Window::GetKeyboard()->KeyDown(KEYBOARD_SHIFT)) {
+    if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_SHIFT)) {
         camera->ProcessKeyboard(DOWN, deltaTime);
     }
 
+    // 水面网格跟随相机（重建的层级要上传）
+    if (water) {
+        Vector3 position = camera->Position;
+        QueueGLWork([this, position]() { water->Update(position); });
+    }
+
     // ========================================
     // 处理鼠标输入 - 相机旋转
     // ========================================
     // nclgl Mouse 提供了相对移动量
-    if (Window::GetMouse()->ButtonDown(MOUSE_LEFT)) {
+    if (inputEnabled && Window::GetMouse()->ButtonDown(MOUSE_LEFT)) {
         // 获取鼠标相对移动量
         float xoffset = Window::GetMouse()->GetRelativePosition().x;
         float yoffset = -Window::GetMouse()->GetRelativePosition().y; // Y坐标反转
 
         camera->ProcessMouseMovement(xoffset, yoffset);
     }
+
+    // ========================================
+    // 地形侵蚀 - 按 E 开关，由模拟时钟每秒执行 30 次迭代
+    // ========================================
+    if (inputEnabled && Window::GetKeyboard()->KeyTriggered(KEYBOARD_E)) {
+        erosionActive = !erosionActive;
+        LOG_INFO((erosionActive ? "开始地形侵蚀" : "暂停地形侵蚀")
+                 << "（已完成 " << terrainErosion->GetIterationCount() << " 次迭代）");
+
+        // 暂停时整张重新烘焙地平线和AO，重新计算岸线距离场
+        if (!erosionActive) {
+            QueueGLWork([this]() {
+                if (terrainBake) {
+                    terrainBake->Bake(*terrain);
+                }
+                if (shoreDistance && water) {
+                    shoreDistance->Compute(*terrain, water->GetWaterLevel());
+                }
+            });
+        }
+        simClock.SetSystemEnabled(erosionSystem, erosionActive);
+    }
+    // ========================================
+    // 地形编辑 - 笔刷作用在相机视线与地形的交点
+    // ========================================
+    if (terrain && terrainEditor) {
+        Keyboard* keyboard = Window::GetKeyboard();
+        const float brushRadius = 5.0f;
+        Vector3 hitPoint;
+
+        if (inputEnabled && keyboard->KeyDown(KEYBOARD_R) && PickTerrain(hitPoint)) {
+            terrainEditor->Apply(TerrainEditor::Brush::Raise, hitPoint.x, hitPoint.z, brushRadius, 0.2f * deltaTime);
+        }
+        if (inputEnabled && keyboard->KeyDown(KEYBOARD_F) && PickTerrain(hitPoint)) {
+            terrainEditor->Apply(TerrainEditor::Brush::Lower, hitPoint.x, hitPoint.z, brushRadius, 0.2f * deltaTime);
+        }
+        if (inputEnabled && keyboard->KeyDown(KEYBOARD_T) && PickTerrain(hitPoint)) {
+            terrainEditor->Apply(TerrainEditor::Brush::Flatten, hitPoint.x, hitPoint.z, brushRadius, 2.0f * deltaTime);
+        }
+        if (inputEnabled && keyboard->KeyDown(KEYBOARD_G) && PickTerrain(hitPoint)) {
+            terrainEditor->Apply(TerrainEditor::Brush::Smooth, hitPoint.x, hitPoint.z, brushRadius, 5.0f * deltaTime);
+        }
+
+        // 法线贴图和材质混合图跟着脏区域每帧更新；
+        // 地平线/AO 范围大，等松开笔刷后再烘焙
+        // 浅水的地形高度是纯 CPU 数据，马上更新（本帧的模拟步就要用）；
+        // 其余的都会上传贴图 / 顶点，排进 GL 队列
+        int dx0, dz0, dx1, dz1;
+        if (terrain->GetDirtyBounds(dx0, dz0, dx1, dz1)) {
+            if (shallowWater) {
+                shallowWater->RefreshTerrain(*terrain, dx0, dz0, dx1, dz1);
+            }
+
+            QueueGLWork([this, dx0, dz0, dx1, dz1]() {
+                if (terrainSplat) {
+                    terrainSplat->GenerateRegion(*terrain, dx0, dz0, dx1, dz1);
+                }
+                if (waterTiles) {
+                    waterTiles->ClassifyRegion(*terrain, dx0, dz0, dx1, dz1);
+                }
+                if (terrainBake) {
+                    terrainBake->BakeRegion(*terrain, dx0, dz0, dx1, dz1, false);
+                }
+            });
+
+            if (terrainBake) {
+                if (horizonBakePending) {
+                    horizonBakeX0 = std::min(horizonBakeX0, dx0);
+                    horizonBakeZ0 = std::min(horizonBakeZ0, dz0);
+                    horizonBakeX1 = std::max(horizonBakeX1, dx1);
+                    horizonBakeZ1 = std::max(horizonBakeZ1, dz1);
+                } else {
+                    horizonBakeX0 = dx0;
+                    horizonBakeZ0 = dz0;
+                    horizonBakeX1 = dx1;
+                    horizonBakeZ1 = dz1;
+                    horizonBakePending = true;
+                }
+            }
+        }
+
+        // 每帧只重建、上传一次被修改的区域
+        QueueGLWork([this]() { terrain->UpdateDirtyRegions(); });
+
+        bool brushHeld = inputEnabled &&
+                         (keyboard->KeyDown(KEYBOARD_R) || keyboard->KeyDown(KEYBOARD_F) ||
+                          keyboard->KeyDown(KEYBOARD_T) || keyboard->KeyDown(KEYBOARD_G));
+        if (horizonBakePending && !brushHeld) {
+            int bx0 = horizonBakeX0, bz0 = horizonBakeZ0, bx1 = horizonBakeX1, bz1 = horizonBakeZ1;
+            horizonBakePending = false;
+
+            // 岸线距离场是全局的，同样等松开笔刷后整张重新计算
+            QueueGLWork([this, bx0, bz0, bx1, bz1]() {
+                terrainBake->BakeRegion(*terrain, bx0, bz0, bx1, bz1, true);
+                if (shoreDistance && water) {
+                    shoreDistance->Compute(*terrain, water->GetWaterLevel());
+                }
+            });
+        }
+    }
+
+    // ========================================
+    // 浅水模拟 - 按住 Q 在视线落点处倒水
+    // ========================================
+    if (shallowWater) {
+        Vector3 hitPoint;
+        if (inputEnabled && Window::GetKeyboard()->KeyDown(KEYBOARD_Q) && PickTerrain(hitPoint)) {
+            shallowWater->AddWater(hitPoint.x, hitPoint.z, 3.0f, 1.0f * deltaTime);
+        }
+    }
+
+    // ========================================
+    // 推进固定步长的模拟系统（海浪 / 浅水 / 侵蚀）
+    // ========================================
+    // 放在输入处理之后：本帧加的水、改的地形在这几步中生效
+    simClock.Advance(deltaTime);
+
+    // 海浪纹理只在这一帧算过新的一步时才上传
+    if (ocean && oceanSystem >= 0 && simClock.GetStepsThisFrame(oceanSystem) > 0) {
+        QueueGLWork([this]() { ocean->UploadTextures(); });
+    }
+
+    // 侵蚀这一帧执行过迭代：网格、烘焙贴图等每帧只更新一次
+    if (erosionSystem >= 0 && simClock.GetStepsThisFrame(erosionSystem) > 0) {
+        if (shallowWater) {
+            shallowWater->RefreshTerrain(*terrain, 0, 0, terrain->GetWidth() - 1, terrain->GetHeight() - 1);
+        }
+        QueueGLWork([this]() {
+            terrain->RebuildMesh();
+            if (terrainBake) {
+                terrainBake->BakeRegion(*terrain, 0, 0, terrain->GetWidth() - 1, terrain->GetHeight() - 1, false);
+            }
+            if (terrainSplat) {
+                terrainSplat->Generate(*terrain);
+            }
+            if (waterTiles) {
+                waterTiles->Classify(*terrain);
+            }
+        });
+    }
+
+    // 浅水网格：在最近两步之间按插值系数取水深
+    if (shallowWater && shallowWaterSystem >= 0) {
+        float alpha = simClock.GetAlpha(shallowWaterSystem);
+        QueueGLWork([this, alpha]() { shallowWater->UpdateMesh(alpha); });
+        PerfCounters::Set(shallowTilesCounter, shallowWater->GetLastProcessedTileCount());
+    }
+
+    // ========================================
+    // 写入渲染快照
+    // ========================================
+    RenderSnapshot& snapshot = snapshots[updateSnapshot];
+    snapshot.valid = true;
+    snapshot.viewMatrix = camera->GetViewMatrix();
+    snapshot.cameraPosition = camera->Position;
+    snapshot.zoom = camera->Zoom;
+
+    // 海浪最近一步的时间 + 插值系数 × 步长
+    snapshot.waterTime = waterTime;
+    if (oceanSystem >= 0) {
+        snapshot.waterTime += simClock.GetAlpha(oceanSystem) * simClock.GetStepSeconds(oceanSystem);
+    }
+
+    snapshot.lightPosition = lightPosition;
+    snapshot.lightColor = lightColor;
+}
+
+// ========================================
+// 发布一帧
+// ========================================
+// 必须在主线程上、没有 UpdateScene 正在执行时调用：
+// 排队的 GL 工作会读取模拟数据（海浪、地形高度、水深）
+// ========================================
+void Renderer::PublishFrame() {
+    // 其他作业提交给主线程的 GL 工作（纹理上传等）
+    JobSystem::Get().RunMainThreadJobs();
+
+    pendingGLWork.Execute();
+    frameArena.Reset();
+
+    updateSnapshot = 1 - updateSnapshot;
+}
+
+void Renderer::ReleaseCpuCopies() {
+    if (terrain) {
+        terrain->ReleaseCpuCopies();
+    }
+    if (shallowWater) {
+        shallowWater->ReleaseCpuCopies();
+    }
+}
+
+Matrix4 Renderer::GetProjectionMatrix(const RenderSnapshot& snapshot) const {
+    return Matrix4::Perspective(1.0f, quality.drawDistance, (float)width / (float)height, snapshot.zoom);
+}
+
+// ========================================
+// 应用画质
+// ========================================
+void Renderer::ApplyQuality(const FrameGovernor::Quality& newQuality) {
+    // 水面网格密度：按新的格子数重建，格子边长反比缩放，覆盖范围不变
+    if (water && camera && newQuality.waterGridSize != quality.waterGridSize) {
+        float cellSize = WATER_BASE_CELL * WATER_GRID_SIZE / newQuality.waterGridSize;
+        WaterClipmap* rebuilt = new WaterClipmap(water->GetWaterLevel(), newQuality.waterGridSize,
+                                                 water->GetLevelCount(), cellSize);
+        rebuilt->Update(camera->Position);
+        rebuilt->SetTileMap(waterTiles);
+        delete water;
+        water = rebuilt;
+    }
+
+    quality = newQuality;
+    if (water) {
+        water->SetDrawDistance(quality.drawDistance);
+    }
+    if (quality.renderScale >= 1.0f) {
+        ReleaseSceneTarget();
+    }
+}
+
+// ========================================
+// 内部渲染分辨率的离屏缓冲
+// ========================================
+// 颜色和深度都用渲染缓冲（不需要采样），画完用 glBlitFramebuffer 线性放大到窗口。
+// 尺寸变化（画质或窗口大小改变）时重建；创建失败时返回 false，这一帧直接画到窗口
+// ========================================
+bool Renderer::PrepareSceneTarget(int targetWidth, int targetHeight) {
+    if (sceneFBO && targetWidth == sceneWidth && targetHeight == sceneHeight) {
+        return true;
+    }
+    ReleaseSceneTarget();
+
+    glGenFramebuffers(1, &sceneFBO);
+    glGenRenderbuffers(1, &sceneColour);
+    glGenRenderbuffers(1, &sceneDepth);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, sceneColour);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, targetWidth, targetHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, sceneDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, targetWidth, targetHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, sceneColour);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, sceneDepth);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        LOG_ERROR_LIMITED("错误：无法创建 " << targetWidth << "x" << targetHeight << " 的离屏缓冲，按窗口分辨率渲染");
+        ReleaseSceneTarget();
+        return false;
+    }
+    sceneWidth = targetWidth;
+    sceneHeight = targetHeight;
+    return true;
+}
+
+void Renderer::ReleaseSceneTarget() {
+    if (sceneFBO) glDeleteFramebuffers(1, &sceneFBO);
+    if (sceneColour) glDeleteRenderbuffers(1, &sceneColour);
+    if (sceneDepth) glDeleteRenderbuffers(1, &sceneDepth);
+    sceneFBO = sceneColour = sceneDepth = 0;
+    sceneWidth = sceneHeight = 0;
+}
+
+// ========================================
+// 相机视线与地形求交
+// ========================================
+// 沿相机前方向量步进，找到第一次低于地形表面的位置，
+// 再在最后一步内二分细化
+// ========================================
+bool Renderer::PickTerrain(Vector3& hitPoint) const {
+    if (!camera || !terrain) return false;
+
+    const float stepSize = 0.25f;
+    const float maxDistance = terrain->GetTerrainSize() * 1.5f;
+    const float halfSize = terrain->GetTerrainSize() / 2.0f;
+
+    Vector3 dir = camera->Front;
+    Vector3 prev = camera->Position;
+
+    for (float t = stepSize; t <= maxDistance; t += stepSize) {
+        Vector3 p = camera->Position + dir * t;
+        if (p.x < -halfSize || p.x > halfSize || p.z < -halfSize || p.z > halfSize) {
+            prev = p;
+            continue;
+        }
+
+        if (p.y <= terrain->GetHeightAt(p.x, p.z)) {
+            // 二分细化交点
+            Vector3 lo = prev;
+            Vector3 hi = p;
+            for (int i = 0; i < 8; ++i) {
+                Vector3 mid = (lo + hi) * 0.5f;
+                if (mid.y <= terrain->GetHeightAt(mid.x, mid.z)) {
+                    hi = mid;
+                } else {
+                    lo = mid;
+                }
+            }
+            hitPoint = hi;
+            return true;
+        }
+        prev = p;
+    }
+    return false;
 }
 
 void Renderer::RenderScene() {
@@ -179,25 +635,29 @@ void Renderer::RenderScene() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glClearColor(0.5f, 0.7f, 0.9f, 1.0f);  // 天空蓝色背景
 
-    if (!camera) {
+    // 只读取已发布的快照：下一帧的 UpdateScene 可能正在另一个线程上修改相机和模拟
+    const RenderSnapshot& snapshot = snapshots[1 - updateSnapshot];
+    if (!snapshot.valid) {
         SwapBuffers();
         return;
     }
 
-    // ========================================
-    // 设置投影矩阵和视图矩阵
-    // ========================================
-    Matrix4 viewMatrix = camera->GetViewMatrix();
-    Matrix4 projMatrix = Matrix4::Perspective(1.0f, 10000.0f,
-                                               (float)width / (float)height,
-                                               camera->Zoom);
+    // 内部渲染分辨率低于窗口时，场景画到离屏缓冲里，最后放大
+    int targetWidth = std::max(1, (int)(width * quality.renderScale + 0.5f));
+    int targetHeight = std::max(1, (int)(height * quality.renderScale + 0.5f));
+    bool scaled = quality.renderScale < 1.0f && PrepareSceneTarget(targetWidth, targetHeight);
+    if (scaled) {
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+        glViewport(0, 0, sceneWidth, sceneHeight);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
     // ========================================
     // 1. 渲染天空盒（最先渲染，深度测试设为 LEQUAL）
     // ========================================
     if (skybox && skyboxShader) {
         glDepthFunc(GL_LEQUAL);  // 允许天空盒在最远处
-        RenderSkybox();
+        RenderSkybox(snapshot);
         glDepthFunc(GL_LESS);    // 恢复默认深度测试
     }
 
@@ -205,45 +665,64 @@ void Renderer::RenderScene() {
     // 2. 渲染地形
     // ========================================
     if (terrain && terrainShader) {
-        RenderTerrain();
+        RenderTerrain(snapshot);
     }
 
     // ========================================
     // 3. 渲染水面（最后渲染，使用混合）
     // ========================================
     if (water && waterShader) {
-        RenderWater();
+        RenderWater(snapshot);
     }
 
-    // 交换缓冲
+    if (scaled) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+    }
+
+    // ========================================
+    // 4. 文字叠加层（在场景之上，始终按窗口分辨率）
+    // ========================================
+    if (overlay && overlayVisible) {
+        overlay->Render(width, height);
+    }
+
+    // 交换缓冲（单独计时：开启垂直同步时这里会等待）
+    std::chrono::steady_clock::time_point swapStart = std::chrono::steady_clock::now();
     SwapBuffers();
+    lastSwapMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - swapStart).count();
 }
 
-void Renderer::RenderSkybox() {
-    if (!skybox || !skyboxShader || !camera) return;
+void Renderer::SetOverlayText(const std::vector<std::string>& lines) {
+    if (overlay) {
+        overlay->SetLines(lines);
+    }
+}
+
+void Renderer::RenderSkybox(const RenderSnapshot& snapshot) {
+    if (!skybox || !skyboxShader) return;
 
     // 获取视图和投影矩阵
-    Matrix4 viewMatrix = camera->GetViewMatrix();
-    Matrix4 projMatrix = Matrix4::Perspective(1.0f, 10000.0f,
-                                               (float)width / (float)height,
-                                               camera->Zoom);
+    Matrix4 projMatrix = GetProjectionMatrix(snapshot);
 
     // 渲染天空盒（Skybox::Draw 会处理 uniform 设置）
-    skybox->Draw(*skyboxShader, viewMatrix, projMatrix);
+    skybox->Draw(*skyboxShader, snapshot.viewMatrix, projMatrix);
 }
 
-void Renderer::RenderTerrain() {
-    if (!terrain || !terrainShader || !camera) return;
+void Renderer::RenderTerrain(const RenderSnapshot& snapshot) {
+    if (!terrain || !terrainShader) return;
 
     // 激活地形着色器
     glUseProgram(terrainShader->GetProgram());
+    PerfCounters::Add(PERF_SHADER_BINDS);
 
     // 设置变换矩阵
     Matrix4 modelMatrix; // 单位矩阵（地形在原点）
-    Matrix4 viewMatrix = camera->GetViewMatrix();
-    Matrix4 projMatrix = Matrix4::Perspective(1.0f, 10000.0f,
-                                               (float)width / (float)height,
-                                               camera->Zoom);
+    Matrix4 viewMatrix = snapshot.viewMatrix;
+    Matrix4 projMatrix = GetProjectionMatrix(snapshot);
 
     glUniformMatrix4fv(glGetUniformLocation(terrainShader->GetProgram(), "model"),
                        1, false, (float*)&modelMatrix);
@@ -253,11 +732,11 @@ void Renderer::RenderTerrain() {
                        1, false, (float*)&projMatrix);
 
     // 设置光照
-    SetShaderLight(terrainShader);
+    SetShaderLight(terrainShader, snapshot);
 
     // 设置相机位置（用于高光计算）
     glUniform3fv(glGetUniformLocation(terrainShader->GetProgram(), "viewPos"),
-                 1, (float*)&camera->Position);
+                 1, (float*)&snapshot.cameraPosition);
 
     // 绑定地形纹理
     if (terrainTexture) {
@@ -265,22 +744,49 @@ void Renderer::RenderTerrain() {
         glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "terrainTexture"), 0);
     }
 
+    // 绑定烘焙贴图（纹理单元1-4）
+    bool useBakedMaps = terrainBake && terrainBake->IsUploaded();
+    if (useBakedMaps) {
+        terrainBake->BindTextures(1);
+        glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "normalMap"), 1);
+        glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "horizonMap0"), 2);
+        glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "horizonMap1"), 3);
+        glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "aoMap"), 4);
+    }
+    glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "useBakedMaps"), useBakedMaps ? 1 : 0);
+
+    // 绑定材质混合图（纹理单元5）和材质层纹理数组（纹理单元6）
+    bool useSplatMap = terrainSplat && terrainSplat->IsReady();
+    if (useSplatMap) {
+        terrainSplat->BindTextures(5);
+        glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "splatMap"), 5);
+        glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "layerTextures"), 6);
+        glUniform1f(glGetUniformLocation(terrainShader->GetProgram(), "layerTiling"), 32.0f);
+    }
+    glUniform1i(glGetUniformLocation(terrainShader->GetProgram(), "useSplatMap"), useSplatMap ? 1 : 0);
+
+    // 地形 LOD：屏幕误差按实际渲染的分辨率（离屏缓冲的高度）换算
+    if (quality.terrainErrorPixels > 0.0f) {
+        int viewportHeight = sceneFBO ? sceneHeight : height;
+        float projectionScale = viewportHeight / (2.0f * std::tan(DegToRad(snapshot.zoom) * 0.5f));
+        terrain->SelectLod(snapshot.cameraPosition, projectionScale, quality.terrainErrorPixels);
+    }
+
     // 渲染地形
     terrain->Render();
 }
 
-void Renderer::RenderWater() {
-    if (!water || !waterShader || !camera) return;
+void Renderer::RenderWater(const RenderSnapshot& snapshot) {
+    if (!water || !waterShader) return;
 
     // 激活水面着色器
     glUseProgram(waterShader->GetProgram());
+    PerfCounters::Add(PERF_SHADER_BINDS);
 
     // 设置变换矩阵
     Matrix4 modelMatrix; // 单位矩阵
-    Matrix4 viewMatrix = camera->GetViewMatrix();
-    Matrix4 projMatrix = Matrix4::Perspective(1.0f, 10000.0f,
-                                               (float)width / (float)height,
-                                               camera->Zoom);
+    Matrix4 viewMatrix = snapshot.viewMatrix;
+    Matrix4 projMatrix = GetProjectionMatrix(snapshot);
 
     glUniformMatrix4fv(glGetUniformLocation(waterShader->GetProgram(), "model"),
                        1, false, (float*)&modelMatrix);
@@ -289,36 +795,77 @@ void Renderer::RenderWater() {
     glUniformMatrix4fv(glGetUniformLocation(waterShader->GetProgram(), "projection"),
                        1, false, (float*)&projMatrix);
 
-    // 设置时间（用于波浪动画）
-    // 注意：需要一个时间累加器，暂时使用静态变量
-    static float time = 0.0f;
-    time += 0.016f; // 假设 60 FPS
-    glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "time"), time);
+    // 设置时间：海浪最近一步的时间 + 插值系数 × 步长（写快照时已算好）
+    glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "time"), snapshot.waterTime);
 
     // 设置相机位置
     glUniform3fv(glGetUniformLocation(waterShader->GetProgram(), "viewPos"),
-                 1, (float*)&camera->Position);
+                 1, (float*)&snapshot.cameraPosition);
 
     // 如果有天空盒，绑定它用于反射
     if (skybox) {
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->GetCubemapID());
+        PerfCounters::Add(PERF_TEXTURE_BINDS);
         glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "skybox"), 0);
     }
 
+    // FFT 海浪纹理：位移 → 1，法线+泡沫 → 2
+    if (ocean && ocean->IsUploaded()) {
+        ocean->BindTextures(1);
+        glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "oceanDisplacement"), 1);
+        glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "oceanNormalFoam"), 2);
+        glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "oceanPatchSize"), ocean->GetPatchSize());
+        glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "oceanTexelSize"),
+                    ocean->GetPatchSize() / ocean->GetResolution());
+    }
+
+    // 岸线遮罩 → 3
+    bool useWaterMask = waterTiles && waterTiles->IsUploaded();
+    glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "useWaterMask"), useWaterMask);
+    if (useWaterMask) {
+        waterTiles->BindMask(3);
+        Vector4 maskTransform = waterTiles->GetMaskTransform();
+        glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "waterMask"), 3);
+        glUniform4fv(glGetUniformLocation(waterShader->GetProgram(), "waterMaskTransform"),
+                     1, (float*)&maskTransform);
+    }
+
+    // 岸线距离场 → 4
+    bool useShoreDistance = shoreDistance && shoreDistance->IsUploaded();
+    glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "useShoreDistance"), useShoreDistance);
+    if (useShoreDistance) {
+        shoreDistance->BindTexture(4);
+        Vector4 shoreTransform = shoreDistance->GetTextureTransform();
+        glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "shoreDistance"), 4);
+        glUniform4fv(glGetUniformLocation(waterShader->GetProgram(), "shoreTransform"),
+                     1, (float*)&shoreTransform);
+        glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "shoreMaxDistance"),
+                    shoreDistance->GetMaxDistance());
+    }
+
     // 渲染水面
+    glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "oceanWaveScale"), 1.0f);
     water->Render();
+
+    // 地形上的积水：用同一个着色器，不做岸线遮罩，波浪只保留一点细纹
+    if (shallowWater) {
+        glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "useWaterMask"), 0);
+        glUniform1i(glGetUniformLocation(waterShader->GetProgram(), "useShoreDistance"), 0);
+        glUniform1f(glGetUniformLocation(waterShader->GetProgram(), "oceanWaveScale"), 0.15f);
+        shallowWater->Render();
+    }
 }
 
-void Renderer::SetShaderLight(Shader* s) {
+void Renderer::SetShaderLight(Shader* s, const RenderSnapshot& snapshot) {
     if (!s) return;
 
     // 设置光照 uniform
     glUniform3fv(glGetUniformLocation(s->GetProgram(), "lightPos"),
-                 1, (float*)&lightPosition);
+                 1, (float*)&snapshot.lightPosition);
 
     // 将 Vector4 转换为 Vector3（只传RGB，忽略alpha）
-    Vector3 lightColorRGB(lightColor.x, lightColor.y, lightColor.z);
+    Vector3 lightColorRGB(snapshot.lightColor.x, snapshot.lightColor.y, snapshot.lightColor.z);
     glUniform3fv(glGetUniformLocation(s->GetProgram(), "lightColor"),
                  1, (float*)&lightColorRGB);
 }
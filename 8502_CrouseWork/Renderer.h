@@ -3,15 +3,29 @@
 #include "nclgl/OGLRenderer.h"
 #include "Camera.h"
 #include "Terrain.h"
+#include "TerrainErosion.h"
+#include "TerrainEditor.h"
+#include "TerrainBake.h"
+#include "TerrainSplat.h"
 #include "Skybox.h"
-#include "WaterPlane.h"
+#include "WaterClipmap.h"
+#include "OceanFFT.h"
+#include "WaterTileMap.h"
+#include "ShorelineDistance.h"
+#include "ShallowWater.h"
+#include "SimulationClock.h"
 #include "Texture.h"
+#include "TextOverlay.h"
+#include "FrameGovernor.h"
+#include "FramePipeline.h"
+#include "nclgl/LinearArena.h"
 
 /*
  * Renderer - 主渲染器类
- * 继承自 OGLRenderer，负责管理整个场景的渲染
+ * 继承自 OGLRenderer，负责管理整个场景的渲染；
+ * 同时是 FramePipeline 驱动的帧阶段（FrameStages）
  */
-class Renderer : public OGLRenderer {
+class Renderer : public OGLRenderer, public FrameStages {
 public:
     Renderer(Window& parent);
     virtual ~Renderer();
@@ -20,21 +34,139 @@ public:
     virtual void RenderScene() override;
     virtual void UpdateScene(float msec) override;
 
+    // ========================================
+    // 帧流水线
+    // ========================================
+    // UpdateScene 只做 CPU 工作：读输入、推进模拟，把渲染要用的数据写进
+    // 快照，需要调用 GL 的上传先排进队列，不直接调用 GL；
+    // PublishFrame 在主线程上执行排队的上传并发布快照；
+    // RenderScene 只读已发布的快照和 GL 对象。
+    // 因此下一帧的 UpdateScene 可以在工作线程上与这一帧的 RenderScene
+    // 同时执行（见 FramePipeline），只要 PublishFrame 不和它同时调用
+    // ========================================
+    virtual void PublishFrame() override;
+
+    // 释放已上传到GPU、之后不再读取的CPU副本（地形顶点/索引、浅水索引）
+    // 地形之后被修改时会整体重建，编辑变慢
+    void ReleaseCpuCopies();
+
+    // 基准测试：由脚本驱动相机时关闭键盘/鼠标输入
+    Camera* GetCamera() { return camera; }
+    void SetInputEnabled(bool enabled) { inputEnabled = enabled; }
+
+    // 屏幕左上角的文字叠加层（性能计数器），默认隐藏
+    // 只能在主线程上调用（与 RenderScene 同一线程）
+    void SetOverlayVisible(bool visible) { overlayVisible = visible; }
+    bool IsOverlayVisible() const { return overlayVisible; }
+    void SetOverlayText(const std::vector<std::string>& lines);
+
+    // ========================================
+    // 画质（由帧时间预算控制器调整，见 FrameGovernor）
+    // ========================================
+    // 只能在两帧之间调用（FramePipeline::RunFrame 返回后）：
+    // 水面网格密度变化时在这里重建水面，需要 GL。
+    // 默认是最高画质、地形不做 LOD，与不开控制器时完全相同
+    // ========================================
+    void ApplyQuality(const FrameGovernor::Quality& newQuality);
+    const FrameGovernor::Quality& GetQuality() const { return quality; }
+
+    // 上一次 RenderScene 中 SwapBuffers 的耗时（等垂直同步或等 GPU），
+    // 渲染时间减去它才是 CPU 实际工作的时间
+    float GetLastSwapMs() const { return lastSwapMs; }
+
 protected:
+    // ========================================
+    // 渲染快照 - 渲染一帧需要的全部 CPU 数据
+    // ========================================
+    // 双缓冲：UpdateScene 写 snapshots[updateSnapshot]，
+    // PublishFrame 交换后 RenderScene 读另一份
+    // 场景里没有骨骼动画或会移动的物体，所以只有相机、海浪时间和光照
+    // ========================================
+    struct RenderSnapshot {
+        bool valid;             // 还没发布过快照时 RenderScene 只清屏
+        Matrix4 viewMatrix;
+        Vector3 cameraPosition;
+        float zoom;             // 视野（度）；投影矩阵渲染时按窗口宽高比计算
+        float waterTime;        // 海浪时间（已按插值系数推到帧时刻）
+        Vector3 lightPosition;
+        Vector4 lightColor;
+    };
+
     // 场景渲染子函数
-    void RenderSkybox();
-    void RenderTerrain();
-    void RenderWater();
+    void RenderSkybox(const RenderSnapshot& snapshot);
+    void RenderTerrain(const RenderSnapshot& snapshot);
+    void RenderWater(const RenderSnapshot& snapshot);
 
     // 辅助函数 - 设置着色器 uniform
-    void SetShaderLight(Shader* s);
+    void SetShaderLight(Shader* s, const RenderSnapshot& snapshot);
+
+    // 辅助函数 - 相机视线与地形的交点（用于地形编辑笔刷）
+    bool PickTerrain(Vector3& hitPoint) const;
+
+    // 辅助函数 - 帧流水线
+    template <typename Work>
+    void QueueGLWork(Work&& work) { pendingGLWork.Add(std::forward<Work>(work)); }
+    Matrix4 GetProjectionMatrix(const RenderSnapshot& snapshot) const;
+
+    // 辅助函数 - 内部渲染分辨率（画质的渲染比例 < 1 时先画到离屏缓冲再放大到窗口）
+    bool PrepareSceneTarget(int targetWidth, int targetHeight);
+    void ReleaseSceneTarget();
 
 private:
+    // 渲染快照（双缓冲）
+    RenderSnapshot snapshots[2];
+    int updateSnapshot;
+
+    // 每帧的临时内存，PublishFrame 执行完排队的工作后整体清空
+    LinearArena frameArena;
+
+    // UpdateScene 排队的 GL 工作（存放在 frameArena 中），
+    // 由 PublishFrame 在主线程上按顺序执行
+    ArenaCommandList pendingGLWork;
+
     // 场景对象
     Camera* camera;
     Terrain* terrain;
     Skybox* skybox;
-    WaterPlane* water;
+    WaterClipmap* water;    // 跟随相机的多层级水面
+
+    // 固定步长模拟时钟：海浪 60 Hz，浅水和侵蚀 30 Hz，与帧率无关
+    SimulationClock simClock;
+    int oceanSystem;
+    int shallowWaterSystem;
+    int erosionSystem;
+    int shallowTilesCounter;    // 性能计数器：浅水上一步实际计算的区块数（gauge）
+
+    bool inputEnabled;      // false 时忽略键盘和鼠标（基准测试）
+
+    // FFT 海浪（按固定步长在CPU上计算，上传为水面的位移/法线/泡沫纹理）
+    OceanFFT* ocean;
+    float waterTime;        // 海浪模拟时间（秒，最近一步）
+
+    // 水面分块（被地形完全遮住的水面区块不绘制，岸线用遮罩丢弃片段）
+    WaterTileMap* waterTiles;
+
+    // 岸线距离场（岸边泡沫、浅水颜色、波浪衰减）
+    ShorelineDistance* shoreDistance;
+
+    // 浅水模拟（按住 Q 在视线落点处倒水，水顺着地形流进洼地）
+    ShallowWater* shallowWater;
+
+    // 地形侵蚀（按 E 开关，每帧执行一次迭代）
+    TerrainErosion* terrainErosion;
+    bool erosionActive;
+
+    // 地形编辑（按住 R/F/T/G 在视线落点处抬高/降低/压平/平滑）
+    TerrainEditor* terrainEditor;
+
+    // 地形烘焙贴图（法线 / 地平线 / AO）
+    // 编辑时每帧只更新法线贴图，松开笔刷后再重新烘焙该区域的地平线和AO
+    TerrainBake* terrainBake;
+    bool horizonBakePending;
+    int horizonBakeX0, horizonBakeZ0, horizonBakeX1, horizonBakeZ1;
+
+    // 地形材质混合图（按高度/坡度/曲率混合多层纹理）
+    TerrainSplat* terrainSplat;
 
     // 着色器
     Shader* terrainShader;
@@ -44,6 +176,21 @@ private:
     // 纹理
     Texture* terrainTexture;
 
+    // 文字叠加层（加载失败时为 nullptr，不影响场景渲染）
+    TextOverlay* overlay;
+    bool overlayVisible;
+
+    // 画质
+    FrameGovernor::Quality quality;
+    float lastSwapMs;
+
+    // 离屏缓冲（内部渲染分辨率），没用到时为 0
+    GLuint sceneFBO;
+    GLuint sceneColour;
+    GLuint sceneDepth;
+    int sceneWidth;
+    int sceneHeight;
+
     // 光照参数
     Vector3 lightPosition;
     Vector4 lightColor;
@@ -0,0 +1,12 @@
+#version 330 core
+
+// 输出：片段颜色
+out vec4 FragColor;
+
+// 底板和文字各画一次，颜色由 uniform 指定（底板半透明）
+uniform vec4 color;
+
+void main()
+{
+    FragColor = color;
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+// 输入：屏幕像素坐标（左上角为原点，y 向下）
+layout (location = 0) in vec2 aPos;
+
+// 渲染区域大小（像素）
+uniform vec2 screenSize;
+
+void main()
+{
+    // 像素坐标 → 标准化设备坐标（-1 到 1，y 向上）
+    vec2 ndc = vec2(aPos.x / screenSize.x * 2.0 - 1.0,
+                    1.0 - aPos.y / screenSize.y * 2.0);
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
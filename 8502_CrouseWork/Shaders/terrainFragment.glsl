@@ -2,9 +2,10 @@
 // 地形片段着色器
 // ========================================
 // 功能：
-// 1. 采样地形纹理
+// 1. 采样地形纹理（有材质混合图时按权重混合多层纹理）
 // 2. 计算简单的光照（环境光 + 漫反射）
-// 3. 输出最终颜色
+// 3. 使用烘焙贴图：逐像素法线、地平线自阴影、环境光遮蔽
+// 4. 输出最终颜色
 // ========================================
 
 #version 330 core
@@ -29,6 +30,42 @@ uniform vec3 lightPos;              // 光源位置（世界空间）
 uniform vec3 lightColor;            // 光源颜色
 uniform vec3 viewPos;               // 相机位置（世界空间）
 
+// 烘焙贴图（TerrainBake 生成，纹理坐标与地形 TexCoord 相同）
+uniform bool useBakedMaps;          // 贴图是否可用
+uniform sampler2D normalMap;        // 逐像素法线（n * 0.5 + 0.5）
+uniform sampler2D horizonMap0;      // 方位 0°/45°/90°/135° 的 sin(地平线仰角)
+uniform sampler2D horizonMap1;      // 方位 180°/225°/270°/315°
+uniform sampler2D aoMap;            // 环境光遮蔽
+
+// 材质混合图（TerrainSplat 生成）
+// 固定采样 1 次混合图 + 4 次纹理数组，不随材质层数变化，也没有分支
+uniform bool useSplatMap;               // 混合图是否可用
+uniform sampler2D splatMap;             // RGBA = 第0-3层的权重（和为1）
+uniform sampler2DArray layerTextures;   // 各材质层纹理
+uniform float layerTiling;              // 材质层纹理在地形上的重复次数
+
+// ========================================
+// 地平线自阴影
+// ========================================
+// 按光线的方位角在相邻两个烘焙方位之间插值出地平线仰角，
+// 光线仰角低于地平线时处于阴影中（边缘做一点软化）
+// 方位 k 对应方向 (cos(k×45°), sin(k×45°))，在 XZ 平面上从 +X 转向 +Z
+// ========================================
+float HorizonShadow(vec2 uv, vec3 lightDir)
+{
+    vec4 h0 = texture(horizonMap0, uv);
+    vec4 h1 = texture(horizonMap1, uv);
+    float horizon[8] = float[8](h0.r, h0.g, h0.b, h0.a, h1.r, h1.g, h1.b, h1.a);
+
+    float azimuth = atan(lightDir.z, lightDir.x);          // -π .. π
+    float sector = fract(azimuth / 6.28318530718) * 8.0;   // 0 .. 8
+    int k0 = int(floor(sector)) & 7;
+    int k1 = (k0 + 1) & 7;
+    float horizonSin = mix(horizon[k0], horizon[k1], fract(sector));
+
+    return smoothstep(horizonSin - 0.05, horizonSin + 0.05, lightDir.y);
+}
+
 // ========================================
 // 主函数：片段着色器的入口点
 // ========================================
@@ -42,6 +79,16 @@ void main()
     //   参数2：纹理坐标 (u, v)
     //   返回：该位置的纹理颜色（RGBA）
     vec3 texColor = texture(terrainTexture, TexCoord).rgb;
+    if (useSplatMap)
+    {
+        // 权重为0的层（包括不存在的层）对结果没有贡献
+        vec4 weights = texture(splatMap, TexCoord);
+        vec2 layerUV = TexCoord * layerTiling;
+        texColor = weights.r * texture(layerTextures, vec3(layerUV, 0.0)).rgb
+                 + weights.g * texture(layerTextures, vec3(layerUV, 1.0)).rgb
+                 + weights.b * texture(layerTextures, vec3(layerUV, 2.0)).rgb
+                 + weights.a * texture(layerTextures, vec3(layerUV, 3.0)).rgb;
+    }
 
     // ========================================
     // 2. 环境光（Ambient）
@@ -51,6 +98,10 @@ void main()
     // 降低环境光，增强明暗对比，让地形更立体
     float ambientStrength = 0.15;    // 环境光强度（降低到0.15，原来是0.3）
     vec3 ambient = ambientStrength * lightColor;
+    if (useBakedMaps)
+    {
+        ambient *= texture(aoMap, TexCoord).r;
+    }
 
     // ========================================
     // 3. 漫反射光（Diffuse）
@@ -61,6 +112,11 @@ void main()
     // 3.1 归一化法向量
     // 注意：从顶点着色器传来的法向量可能在插值后不是单位向量
     vec3 norm = normalize(Normal);
+    if (useBakedMaps)
+    {
+        // 烘焙法线比顶点法线插值更精细
+        norm = normalize(texture(normalMap, TexCoord).rgb * 2.0 - 1.0);
+    }
 
     // 3.2 计算光线方向（从片段指向光源）
     vec3 lightDir = normalize(lightPos - FragPos);
@@ -111,7 +167,9 @@ void main()
     // ========================================
     // 最终光照 = 环境光 + 漫反射光 + 镜面反射光
     // 这就是完整的Phong光照模型！
-    vec3 lighting = ambient + diffuse + specular;
+    // 地平线自阴影只影响直接光（漫反射 + 高光）
+    float shadow = useBakedMaps ? HorizonShadow(TexCoord, lightDir) : 1.0;
+    vec3 lighting = ambient + (diffuse + specular) * shadow;
     vec3 result = lighting * texColor;
 
     // ========================================
@@ -7,6 +7,7 @@ in vec3 FragPos;        // 片段的世界空间位置
 in vec3 Normal;         // 法向量（世界空间）
 in vec2 TexCoord;       // 纹理坐标
 in vec3 ViewDir;        // 视线方向
+in vec2 OceanUV;        // 海浪纹理坐标
 
 // ========================================
 // 输出：片段的最终颜色
@@ -19,13 +20,42 @@ out vec4 FragColor;
 uniform samplerCube skybox;   // 天空盒立方体贴图
 uniform vec3 waterColor;      // 水的基础颜色
 uniform float time;           // 时间（可用于额外效果）
+uniform sampler2D oceanNormalFoam;  // FFT 海浪的法线(xyz)和泡沫(w)
+uniform float oceanWaveScale;       // 波浪强度（海面 1，地形上的积水很小）
+
+// 岸线遮罩（WaterTileMap）：地形高于水面的地方为 0
+uniform bool useWaterMask;
+uniform sampler2D waterMask;
+uniform vec4 waterMaskTransform;    // uv = xz * transform.xy + transform.zw
+
+// 岸线距离场（ShorelineDistance）：水下为负，陆地为正
+uniform bool useShoreDistance;
+uniform sampler2D shoreDistance;
+uniform vec4 shoreTransform;
+uniform float shoreMaxDistance;
 
 void main()
 {
+    // ========================================
+    // 0. 岸线遮罩：被地形完全挡住的水面直接丢弃
+    // ========================================
+    // 放在最前面，跳过后面的纹理采样和混合
+    if (useWaterMask) {
+        vec2 maskUV = FragPos.xz * waterMaskTransform.xy + waterMaskTransform.zw;
+        bool insideTerrain = all(greaterThanEqual(maskUV, vec2(0.0))) && all(lessThanEqual(maskUV, vec2(1.0)));
+        if (insideTerrain && texture(waterMask, maskUV).r < 0.01) {
+            discard;
+        }
+    }
+
     // ========================================
     // 1. 归一化向量
     // ========================================
-    vec3 norm = normalize(Normal);
+    // 法线取自海浪纹理（逐像素，比顶点插值细致得多），
+    // 按波浪强度叠加到网格法线上（积水的网格法线随水面坡度变化）
+    vec4 normalFoam = texture(oceanNormalFoam, OceanUV);
+    normalFoam.w *= oceanWaveScale;
+    vec3 norm = normalize(Normal + (normalFoam.xyz - vec3(0.0, 1.0, 0.0)) * oceanWaveScale);
     vec3 viewDir = normalize(ViewDir);
 
     // ========================================
@@ -69,12 +99,31 @@ void main()
     vec3 finalColor = mix(baseColor, tintedReflection, reflectionStrength);
     // 即使从上方看，也能看到50%的天空反射，让水面更亮
 
+    // 浪尖泡沫：白色，不透明
+    float foam = normalFoam.w;
+
+    // 岸边：浅水偏青绿色，岸线附近一条随时间起伏的泡沫带
+    if (useShoreDistance) {
+        vec2 shoreUV = FragPos.xz * shoreTransform.xy + shoreTransform.zw;
+        vec2 edgeUV = clamp(shoreUV, 0.0, 1.0);
+        float outside = length((shoreUV - edgeUV) / shoreTransform.xy);
+        float shoreDist = (texture(shoreDistance, edgeUV).r * 2.0 - 1.0) * shoreMaxDistance - outside;
+        float shallow = 1.0 - smoothstep(0.0, shoreMaxDistance, -shoreDist);
+        finalColor = mix(finalColor, vec3(0.25, 0.6, 0.6), shallow * 0.35);
+
+        float band = 1.0 - smoothstep(0.0, 0.6, -shoreDist);
+        float lapping = 0.5 + 0.5 * sin(time * 1.5 + shoreDist * 6.0);
+        foam = max(foam, band * lapping * 0.7);
+    }
+    finalColor = mix(finalColor, vec3(0.9, 0.95, 1.0), foam * 0.8);
+
     // ========================================
     // 5. 根据观察角度调整透明度
     // ========================================
     // 从上往下看：较透明（能看到水下地形）
     // 从侧面看：较不透明（水面反射更明显）
     float alpha = 0.7 + fresnel * 0.25;
+    alpha = mix(alpha, 1.0, foam);
     // 基础透明度0.7，侧面增加到0.95，让水面看起来更有实体感
 
     // ========================================
@@ -14,6 +14,7 @@ out vec3 FragPos;    // 片段的世界空间位置
 out vec3 Normal;     // 法向量（世界空间，扰动后）
 out vec2 TexCoord;   // 纹理坐标
 out vec3 ViewDir;    // 视线方向（从片段指向相机）
+out vec2 OceanUV;    // 海浪纹理坐标（位移前的位置，片段着色器采样法线和泡沫）
 
 // ========================================
 // Uniform变量：变换矩阵
@@ -24,44 +25,52 @@ uniform mat4 projection;  // 投影矩阵
 uniform vec3 viewPos;     // 相机位置（世界空间）
 uniform float time;       // 时间（用于波浪动画）
 
+// ========================================
+// Uniform变量：FFT 海浪（OceanFFT）
+// ========================================
+uniform sampler2D oceanDisplacement;  // (dx, 高度, dz)
+uniform float oceanPatchSize;         // 一块海面的边长（纹理平铺周期）
+uniform float oceanTexelSize;         // 海浪网格一个像素对应的世界长度
+uniform float oceanWaveScale;         // 波浪强度（海面 1，地形上的积水很小）
+
+// ========================================
+// Uniform变量：岸线距离场（ShorelineDistance）
+// ========================================
+uniform bool useShoreDistance;
+uniform sampler2D shoreDistance;      // 有符号距离，编码到 [0, 1]
+uniform vec4 shoreTransform;          // uv = xz * transform.xy + transform.zw
+uniform float shoreMaxDistance;       // 编码范围 ±shoreMaxDistance
+
 void main()
 {
     // ========================================
-    // 1. 计算动态波浪
+    // 1. 采样FFT海浪位移
     // ========================================
-    // 使用多个正弦波叠加创建复杂的水面波动
+    // 海浪纹理按世界坐标平铺；远处水面格子比纹理像素大，
+    // 按距离选择 mip 层级，避免高频波浪在远处闪烁
     vec3 pos = aPos;
-
-    // 波浪1：主波浪（X方向）- 减小振幅让水面更平静
-    float wave1 = sin(pos.x * 0.3 + time * 0.3) * 0.05;
-
-    // 波浪2：次波浪（Z方向）- 减小振幅
-    float wave2 = cos(pos.z * 0.4 + time * 0.4) * 0.04;
-
-    // 波浪3：对角线波浪 - 减小振幅
-    float wave3 = sin((pos.x + pos.z) * 0.2 + time * 0.25) * 0.03;
-
-    // 波浪4：细节波浪 - 减小振幅和速度
-    float wave4 = cos(pos.x * 0.8 - time * 0.2) * 0.02;
-
-    // 叠加所有波浪
-    pos.y += wave1 + wave2 + wave3 + wave4;
+    OceanUV = aPos.xz / oceanPatchSize;
+
+    float dist = length(viewPos.xz - aPos.xz);
+    float lod = max(0.0, log2(dist / (24.0 * oceanTexelSize)));
+    vec3 displacement = textureLod(oceanDisplacement, OceanUV, lod).xyz * oceanWaveScale;
+
+    // 靠近岸边水变浅，波浪减弱（离岸 shoreMaxDistance/2 以外不衰减）
+    if (useShoreDistance) {
+        vec2 shoreUV = aPos.xz * shoreTransform.xy + shoreTransform.zw;
+        vec2 edgeUV = clamp(shoreUV, 0.0, 1.0);
+        float outside = length((shoreUV - edgeUV) / shoreTransform.xy);
+        float shoreDist = (textureLod(shoreDistance, edgeUV, 0.0).r * 2.0 - 1.0) * shoreMaxDistance - outside;
+        displacement *= mix(0.2, 1.0, smoothstep(0.0, shoreMaxDistance * 0.5, -shoreDist));
+    }
+    pos += displacement;
 
     // ========================================
-    // 2. 计算扰动后的法向量（近似方法）
+    // 2. 法向量
     // ========================================
+    // 逐像素的海浪法线在片段着色器中采样，这里只传递网格法线
     vec3 normal = aNormal;
 
-    // 根据波浪计算法向量X分量扰动 - 减小扰动强度
-    normal.x += cos(pos.x * 0.3 + time * 0.3) * 0.3 * 0.05;
-    normal.x += sin(pos.x * 0.8 - time * 0.2) * 0.8 * 0.02;
-
-    // 根据波浪计算法向量Z分量扰动 - 减小扰动强度
-    normal.z += sin(pos.z * 0.4 + time * 0.4) * 0.4 * 0.04;
-
-    // 归一化法向量
-    normal = normalize(normal);
-
     // ========================================
     // 3. 变换到世界空间
     // ========================================
@@ -83,13 +92,10 @@ void main()
 // ========================================
 // 补充说明：
 // ========================================
-// 这个着色器与地形顶点着色器非常相似
-// 主要区别：
-// - 水面是平面，法向量始终是 (0, 1, 0)
-// - 水面可以添加波浪动画（通过修改 aPos.y）
+// 波浪来自 CPU 上的 FFT 海浪模拟（OceanFFT），每帧上传为纹理：
+// - 位移纹理包含水平位移，浪尖被挤压得更尖锐（choppy waves）
+// - 纹理可无缝平铺，水面网格再大也只需要一块海面
 //
-// 可选的波浪效果（未实现）：
-//   float wave = sin(aPos.x * 0.5 + time) * cos(aPos.z * 0.5 + time) * 0.2;
-//   vec3 wavePos = aPos + vec3(0.0, wave, 0.0);
-//   FragPos = vec3(model * vec4(wavePos, 1.0));
+// mip 层级：一个纹理像素在 24 倍像素大小的距离外开始降级，
+// 数值越小远处水面越平滑
 // ========================================
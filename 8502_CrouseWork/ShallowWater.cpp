@@ -0,0 +1,680 @@
+#include "ShallowWater.h"
+#include "Terrain.h"
+#include "nclgl/LinearArena.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// 干格子的顶点放在地形以下这么深，被地形挡住
+static const float DRY_OFFSET = 0.05f;
+
+ShallowWater::ShallowWater(const Terrain& terrain, const Settings& settings, unsigned int threadCount)
+    : m_Settings(settings)
+    , m_ThreadCount(threadCount)
+    , m_Width(0)
+    , m_Height(0)
+    , m_CellSize(1.0f)
+    , m_TerrainSize(terrain.GetTerrainSize())
+    , m_TilesX(0)
+    , m_TilesZ(0)
+    , m_LastProcessedTiles(0)
+    , m_RenderAlpha(1.0f)
+    , m_VAO(0)
+    , m_VBO(0)
+    , m_EBO(0)
+    , m_CpuMemory(MEMORY_WATER, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_WATER, MEMORY_GPU_BUFFER)
+{
+    if (m_Settings.cellStep < 1)
+        m_Settings.cellStep = 1;
+    if (m_Settings.tileSize < 4)
+    {
+        LOG_ERROR("错误：浅水模拟的块大小不能小于4，已改为32");
+        m_Settings.tileSize = 32;
+    }
+
+    int step = m_Settings.cellStep;
+    m_Width = (terrain.GetWidth() - 1) / step + 1;
+    m_Height = (terrain.GetHeight() - 1) / step + 1;
+    m_CellSize = m_TerrainSize / (terrain.GetWidth() - 1) * step;
+
+    int tile = m_Settings.tileSize;
+    m_TilesX = (m_Width + tile - 1) / tile;
+    m_TilesZ = (m_Height + tile - 1) / tile;
+
+    size_t count = static_cast<size_t>(m_Width) * m_Height;
+    m_Ground.assign(count, 0.0f);
+    m_Depth.assign(count, 0.0f);
+    m_PreviousDepth.assign(count, 0.0f);
+    m_FluxL.assign(count, 0.0f);
+    m_FluxR.assign(count, 0.0f);
+    m_FluxT.assign(count, 0.0f);
+    m_FluxB.assign(count, 0.0f);
+    m_VelocityX.assign(count, 0.0f);
+    m_VelocityZ.assign(count, 0.0f);
+
+    Tile initial = { false, 0, true, false, false, 0.0f, 0.0f };
+    m_Tiles.assign(static_cast<size_t>(m_TilesX) * m_TilesZ, initial);
+
+    SampleGround(terrain, 0, 0, m_Width - 1, m_Height - 1);
+
+    // 顶点 + 按块分组的索引
+    m_Vertices.resize(count);
+    for (int t = 0; t < GetTileCount(); ++t)
+        BuildTileVertices(t);
+
+    m_TileIndexOffset.resize(GetTileCount());
+    m_TileIndexCount.resize(GetTileCount());
+    for (int t = 0; t < GetTileCount(); ++t)
+    {
+        int x0 = (t % m_TilesX) * tile;
+        int z0 = (t / m_TilesX) * tile;
+        int x1 = std::min(m_Width - 1, x0 + tile);
+        int z1 = std::min(m_Height - 1, z0 + tile);
+
+        m_TileIndexOffset[t] = static_cast<int>(m_Indices.size());
+        for (int z = z0; z < z1; ++z)
+        {
+            for (int x = x0; x < x1; ++x)
+            {
+                unsigned int a = static_cast<unsigned int>(Index(x, z));
+                unsigned int b = static_cast<unsigned int>(Index(x + 1, z));
+                unsigned int c = static_cast<unsigned int>(Index(x + 1, z + 1));
+                unsigned int d = static_cast<unsigned int>(Index(x, z + 1));
+                // 与 WaterPlane 相同的朝向
+                m_Indices.push_back(a); m_Indices.push_back(d); m_Indices.push_back(b);
+                m_Indices.push_back(b); m_Indices.push_back(d); m_Indices.push_back(c);
+            }
+        }
+        m_TileIndexCount[t] = static_cast<int>(m_Indices.size()) - m_TileIndexOffset[t];
+    }
+
+    SetupMesh();
+    UpdateMemoryStats();
+
+    LOG_INFO("✓ 浅水模拟: " << m_Width << "×" << m_Height << " 格（格子边长 " << m_CellSize
+             << "），" << m_TilesX << "×" << m_TilesZ << " 块");
+}
+
+ShallowWater::~ShallowWater()
+{
+    if (m_VAO != 0)
+        glDeleteVertexArrays(1, &m_VAO);
+    if (m_VBO != 0)
+        glDeleteBuffers(1, &m_VBO);
+    if (m_EBO != 0)
+        glDeleteBuffers(1, &m_EBO);
+}
+
+void ShallowWater::SampleGround(const Terrain& terrain, int x0, int z0, int x1, int z1)
+{
+    const std::vector<float>& heights = terrain.GetHeightData();
+    float heightScale = terrain.GetHeightScale();
+    int terrainWidth = terrain.GetWidth();
+    int step = m_Settings.cellStep;
+
+    for (int z = z0; z <= z1; ++z)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            size_t source = static_cast<size_t>(z * step) * terrainWidth + x * step;
+            m_Ground[Index(x, z)] = heights[source] * heightScale;
+        }
+    }
+}
+
+// ========================================
+// 一步模拟
+// ========================================
+// 流量块集合 F = 醒着的块 + 邻居
+// 水深块集合 D = F + 邻居（F 边缘的水会流进这些块）
+// 不在 F 中的块都是休眠的，它们的流量已经清零，所以 D 中只读取流量也不会丢水
+// ========================================
+void ShallowWater::Step()
+{
+    // 上一步在插值的块：先把“上一步水深”同步成当前水深（保持不插值的块两者相等），
+    // 这一步如果没有再变化，需要按最终水深重建一次
+    int tile = m_Settings.tileSize;
+    for (int t = 0; t < GetTileCount(); ++t)
+    {
+        Tile& state = m_Tiles[t];
+        if (!state.moving)
+            continue;
+        state.moving = false;
+        state.meshDirty = true;
+
+        int x0 = (t % m_TilesX) * tile;
+        int z0 = (t / m_TilesX) * tile;
+        int x1 = std::min(m_Width, x0 + tile);
+        int z1 = std::min(m_Height, z0 + tile);
+        for (int z = z0; z < z1; ++z)
+            std::copy(&m_Depth[Index(x0, z)], &m_Depth[Index(x0, z)] + (x1 - x0), &m_PreviousDepth[Index(x0, z)]);
+    }
+
+    CollectTiles();
+    m_LastProcessedTiles = static_cast<int>(m_DepthTiles.size());
+    if (m_FluxTiles.empty())
+        return;
+
+    ParallelFor(static_cast<int>(m_FluxTiles.size()), m_ThreadCount, [&](int i) {
+        ComputeFlux(m_FluxTiles[i]);
+    });
+
+    // 休眠块被邻居的水推动就醒来，否则流量清零（保持“休眠块流量为 0”）
+    for (int t : m_FluxTiles)
+    {
+        Tile& state = m_Tiles[t];
+        if (state.awake)
+            continue;
+        if (state.maxFlow >= m_Settings.sleepEpsilon)
+        {
+            state.awake = true;
+            state.calmSteps = 0;
+            continue;
+        }
+
+        int x0 = (t % m_TilesX) * tile;
+        int z0 = (t / m_TilesX) * tile;
+        int x1 = std::min(m_Width, x0 + tile);
+        int z1 = std::min(m_Height, z0 + tile);
+        for (int z = z0; z < z1; ++z)
+        {
+            for (int x = x0; x < x1; ++x)
+            {
+                size_t i = Index(x, z);
+                m_FluxL[i] = m_FluxR[i] = m_FluxT[i] = m_FluxB[i] = 0.0f;
+            }
+        }
+    }
+
+    ParallelFor(static_cast<int>(m_DepthTiles.size()), m_ThreadCount, [&](int i) {
+        UpdateDepth(m_DepthTiles[i]);
+    });
+
+    SettleTiles();
+}
+
+void ShallowWater::CollectTiles()
+{
+    // 每步都要用的临时标记，放在线程的临时内存里
+    ArenaScope scratch(LinearArena::Scratch());
+    ArenaAllocator<char> alloc(scratch.GetArena());
+    ArenaVector<char> inFlux(m_Tiles.size(), 0, alloc);
+    ArenaVector<char> inDepth(m_Tiles.size(), 0, alloc);
+
+    auto dilate = [&](const ArenaVector<char>& source, ArenaVector<char>& target) {
+        for (int tz = 0; tz < m_TilesZ; ++tz)
+        {
+            for (int tx = 0; tx < m_TilesX; ++tx)
+            {
+                if (!source[tz * m_TilesX + tx])
+                    continue;
+                for (int nz = std::max(0, tz - 1); nz <= std::min(m_TilesZ - 1, tz + 1); ++nz)
+                    for (int nx = std::max(0, tx - 1); nx <= std::min(m_TilesX - 1, tx + 1); ++nx)
+                        target[nz * m_TilesX + nx] = 1;
+            }
+        }
+    };
+
+    ArenaVector<char> awake(m_Tiles.size(), 0, alloc);
+    for (size_t t = 0; t < m_Tiles.size(); ++t)
+        awake[t] = m_Tiles[t].awake ? 1 : 0;
+    dilate(awake, inFlux);
+    dilate(inFlux, inDepth);
+
+    // 按块编号排序，保证每步处理顺序固定
+    m_FluxTiles.clear();
+    m_DepthTiles.clear();
+    for (int t = 0; t < static_cast<int>(m_Tiles.size()); ++t)
+    {
+        if (inFlux[t])
+            m_FluxTiles.push_back(t);
+        if (inDepth[t])
+            m_DepthTiles.push_back(t);
+    }
+}
+
+// ========================================
+// 流量（只写本块格子的流量）
+// ========================================
+void ShallowWater::ComputeFlux(int t)
+{
+    int tile = m_Settings.tileSize;
+    int x0 = (t % m_TilesX) * tile;
+    int z0 = (t / m_TilesX) * tile;
+    int x1 = std::min(m_Width, x0 + tile);
+    int z1 = std::min(m_Height, z0 + tile);
+
+    float dt = m_Settings.timeStep;
+    float l = m_CellSize;
+    float scale = dt * m_Settings.gravity * l;    // dt × g × A / l，A = l²
+    float damping = m_Settings.damping;
+    float sea = m_Settings.seaLevel;
+    float maxFlow = 0.0f;
+
+    for (int z = z0; z < z1; ++z)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            size_t i = Index(x, z);
+            float depth = m_Depth[i];
+            float h = m_Ground[i] + depth;
+
+            // 地形外是海面
+            float hl = x > 0 ? m_Ground[i - 1] + m_Depth[i - 1] : sea;
+            float hr = x < m_Width - 1 ? m_Ground[i + 1] + m_Depth[i + 1] : sea;
+            float ht = z > 0 ? m_Ground[i - m_Width] + m_Depth[i - m_Width] : sea;
+            float hb = z < m_Height - 1 ? m_Ground[i + m_Width] + m_Depth[i + m_Width] : sea;
+
+            float fl = std::max(0.0f, m_FluxL[i] * damping + scale * (h - hl));
+            float fr = std::max(0.0f, m_FluxR[i] * damping + scale * (h - hr));
+            float ft = std::max(0.0f, m_FluxT[i] * damping + scale * (h - ht));
+            float fb = std::max(0.0f, m_FluxB[i] * damping + scale * (h - hb));
+
+            // 一步内流出的水不能超过格子里的水
+            float total = (fl + fr + ft + fb) * dt;
+            float volume = depth * l * l;
+            if (total > volume)
+            {
+                float k = total > 0.0f ? volume / total : 0.0f;
+                fl *= k;
+                fr *= k;
+                ft *= k;
+                fb *= k;
+                total = volume;
+            }
+
+            m_FluxL[i] = fl;
+            m_FluxR[i] = fr;
+            m_FluxT[i] = ft;
+            m_FluxB[i] = fb;
+            maxFlow = std::max(maxFlow, total / (l * l));
+        }
+    }
+
+    m_Tiles[t].maxFlow = maxFlow;
+}
+
+// ========================================
+// 水深和速度（只读流量，只写本块格子的水深）
+// ========================================
+void ShallowWater::UpdateDepth(int t)
+{
+    int tile = m_Settings.tileSize;
+    int x0 = (t % m_TilesX) * tile;
+    int z0 = (t / m_TilesX) * tile;
+    int x1 = std::min(m_Width, x0 + tile);
+    int z1 = std::min(m_Height, z0 + tile);
+
+    float dt = m_Settings.timeStep;
+    float l = m_CellSize;
+    float invArea = 1.0f / (l * l);
+    float minDepth = m_Settings.minDepth;
+    float maxChange = 0.0f;
+
+    for (int z = z0; z < z1; ++z)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            size_t i = Index(x, z);
+            float inLeft   = x > 0 ? m_FluxR[i - 1] : 0.0f;
+            float inRight  = x < m_Width - 1 ? m_FluxL[i + 1] : 0.0f;
+            float inTop    = z > 0 ? m_FluxB[i - m_Width] : 0.0f;
+            float inBottom = z < m_Height - 1 ? m_FluxT[i + m_Width] : 0.0f;
+            float inflow = inLeft + inRight + inTop + inBottom;
+            float outflow = m_FluxL[i] + m_FluxR[i] + m_FluxT[i] + m_FluxB[i];
+
+            float depth = m_Depth[i];
+            float next = std::max(0.0f, depth + dt * (inflow - outflow) * invArea);
+            m_PreviousDepth[i] = depth;
+            m_Depth[i] = next;
+            maxChange = std::max(maxChange, std::fabs(next - depth));
+
+            // 穿过格子的平均流量 / (格子宽 × 平均水深)
+            float average = 0.5f * (depth + next);
+            if (average > minDepth)
+            {
+                m_VelocityX[i] = 0.5f * (inLeft - m_FluxL[i] + m_FluxR[i] - inRight) / (l * average);
+                m_VelocityZ[i] = 0.5f * (inTop - m_FluxT[i] + m_FluxB[i] - inBottom) / (l * average);
+            }
+            else
+            {
+                m_VelocityX[i] = 0.0f;
+                m_VelocityZ[i] = 0.0f;
+            }
+        }
+    }
+
+    m_Tiles[t].maxChange = maxChange;
+}
+
+// ========================================
+// 唤醒 / 休眠
+// ========================================
+void ShallowWater::SettleTiles()
+{
+    int tile = m_Settings.tileSize;
+    float epsilon = m_Settings.sleepEpsilon;
+
+    for (int t : m_DepthTiles)
+    {
+        Tile& state = m_Tiles[t];
+        if (state.maxChange > 0.0f)
+        {
+            state.meshDirty = true;
+            state.moving = true;
+        }
+
+        if (!state.awake)
+        {
+            if (state.maxChange >= epsilon)
+            {
+                state.awake = true;
+                state.calmSteps = 0;
+            }
+            continue;
+        }
+
+        if (state.maxChange < epsilon && state.maxFlow < epsilon)
+            ++state.calmSteps;
+        else
+            state.calmSteps = 0;
+
+        if (state.calmSteps >= m_Settings.sleepSteps)
+        {
+            state.awake = false;
+            state.calmSteps = 0;
+
+            int x0 = (t % m_TilesX) * tile;
+            int z0 = (t / m_TilesX) * tile;
+            int x1 = std::min(m_Width, x0 + tile);
+            int z1 = std::min(m_Height, z0 + tile);
+            for (int z = z0; z < z1; ++z)
+            {
+                for (int x = x0; x < x1; ++x)
+                {
+                    size_t i = Index(x, z);
+                    m_FluxL[i] = m_FluxR[i] = m_FluxT[i] = m_FluxB[i] = 0.0f;
+                    m_VelocityX[i] = m_VelocityZ[i] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+void ShallowWater::WakeTile(int tx, int tz)
+{
+    if (tx < 0 || tz < 0 || tx >= m_TilesX || tz >= m_TilesZ)
+        return;
+    Tile& state = m_Tiles[tz * m_TilesX + tx];
+    state.awake = true;
+    state.calmSteps = 0;
+    state.meshDirty = true;
+}
+
+// ========================================
+// 加水
+// ========================================
+void ShallowWater::AddWater(float worldX, float worldZ, float radius, float amount)
+{
+    float half = m_TerrainSize * 0.5f;
+    float cx = (worldX + half) / m_CellSize;
+    float cz = (worldZ + half) / m_CellSize;
+    float r = std::max(radius / m_CellSize, 1.0f);
+
+    int x0 = std::max(0, static_cast<int>(std::floor(cx - r)));
+    int z0 = std::max(0, static_cast<int>(std::floor(cz - r)));
+    int x1 = std::min(m_Width - 1, static_cast<int>(std::ceil(cx + r)));
+    int z1 = std::min(m_Height - 1, static_cast<int>(std::ceil(cz + r)));
+    if (x0 > x1 || z0 > z1)
+        return;
+
+    for (int z = z0; z <= z1; ++z)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            float dx = (x - cx) / r;
+            float dz = (z - cz) / r;
+            float d2 = dx * dx + dz * dz;
+            if (d2 < 1.0f)
+            {
+                float falloff = (1.0f - d2) * (1.0f - d2);
+                // 上一步的水深一起加，插值时新加的水不会“渐入”
+                m_Depth[Index(x, z)] += amount * falloff;
+                m_PreviousDepth[Index(x, z)] += amount * falloff;
+            }
+        }
+    }
+
+    int tile = m_Settings.tileSize;
+    for (int tz = z0 / tile; tz <= z1 / tile; ++tz)
+        for (int tx = x0 / tile; tx <= x1 / tile; ++tx)
+            WakeTile(tx, tz);
+}
+
+void ShallowWater::RefreshTerrain(const Terrain& terrain, int x0, int z0, int x1, int z1)
+{
+    int step = m_Settings.cellStep;
+    int sx0 = std::max(0, x0 / step);
+    int sz0 = std::max(0, z0 / step);
+    int sx1 = std::min(m_Width - 1, (x1 + step - 1) / step);
+    int sz1 = std::min(m_Height - 1, (z1 + step - 1) / step);
+    if (sx0 > sx1 || sz0 > sz1)
+        return;
+
+    SampleGround(terrain, sx0, sz0, sx1, sz1);
+
+    int tile = m_Settings.tileSize;
+    for (int tz = sz0 / tile; tz <= sz1 / tile; ++tz)
+        for (int tx = sx0 / tile; tx <= sx1 / tile; ++tx)
+            WakeTile(tx, tz);
+}
+
+int ShallowWater::GetAwakeTileCount() const
+{
+    int count = 0;
+    for (const Tile& tile : m_Tiles)
+        count += tile.awake ? 1 : 0;
+    return count;
+}
+
+double ShallowWater::GetTotalVolume() const
+{
+    double volume = 0.0;
+    for (float depth : m_Depth)
+        volume += depth;
+    return volume * m_CellSize * m_CellSize;
+}
+
+// ========================================
+// 渲染网格
+// ========================================
+void ShallowWater::BuildTileVertices(int t)
+{
+    int tile = m_Settings.tileSize;
+    int x0 = (t % m_TilesX) * tile;
+    int z0 = (t / m_TilesX) * tile;
+    int x1 = std::min(m_Width, x0 + tile);
+    int z1 = std::min(m_Height, z0 + tile);
+    float half = m_TerrainSize * 0.5f;
+    float minDepth = m_Settings.minDepth;
+    bool hasWater = false;
+
+    // 在上一步和这一步之间插值（不在变化的块两者相等）
+    float alpha = m_RenderAlpha;
+    auto depthAt = [&](size_t i) {
+        return m_PreviousDepth[i] + (m_Depth[i] - m_PreviousDepth[i]) * alpha;
+    };
+    auto surface = [&](int x, int z) {
+        x = std::max(0, std::min(m_Width - 1, x));
+        z = std::max(0, std::min(m_Height - 1, z));
+        size_t i = Index(x, z);
+        return m_Ground[i] + depthAt(i);
+    };
+
+    for (int z = z0; z < z1; ++z)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            size_t i = Index(x, z);
+            float depth = depthAt(i);
+            bool wet = depth >= minDepth;
+            hasWater = hasWater || wet;
+
+            float wx = -half + x * m_CellSize;
+            float wz = -half + z * m_CellSize;
+            float y = m_Ground[i] + depth - (wet ? 0.0f : DRY_OFFSET);
+
+            Vector3 normal(surface(x - 1, z) - surface(x + 1, z),
+                           2.0f * m_CellSize,
+                           surface(x, z - 1) - surface(x, z + 1));
+            normal.Normalise();
+
+            Vertex& v = m_Vertices[i];
+            v.Position = Vector3(wx, y, wz);
+            v.Normal = normal;
+            v.TexCoord = Vector2(wx * 0.001f + 0.5f, wz * 0.001f + 0.5f);
+        }
+    }
+
+    // 本块最后一列/行的四边形用到右/下邻块的顶点，邻块没有水时它的顶点在地形以下，
+    // 所以水边界落在块边界上也是向下收口，不会悬空
+    m_Tiles[t].hasWater = hasWater;
+    m_Tiles[t].meshDirty = false;
+}
+
+// ========================================
+// 重建并上传被改动的块
+// ========================================
+// 一行块的顶点在缓冲中是连续的几行，整条上传
+// 正在插值的块每帧都要重建
+// ========================================
+void ShallowWater::UpdateMesh(float alpha)
+{
+    m_RenderAlpha = std::max(0.0f, std::min(1.0f, alpha));
+    int tile = m_Settings.tileSize;
+    for (int tz = 0; tz < m_TilesZ; ++tz)
+    {
+        bool rowDirty = false;
+        for (int tx = 0; tx < m_TilesX; ++tx)
+        {
+            int t = tz * m_TilesX + tx;
+            if (m_Tiles[t].meshDirty || m_Tiles[t].moving)
+            {
+                BuildTileVertices(t);
+                rowDirty = true;
+            }
+        }
+
+        if (rowDirty && m_VBO != 0)
+        {
+            int z0 = tz * tile;
+            int z1 = std::min(m_Height, z0 + tile);
+            glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+            glBufferSubData(GL_ARRAY_BUFFER,
+                            Index(0, z0) * sizeof(Vertex),
+                            static_cast<size_t>(z1 - z0) * m_Width * sizeof(Vertex),
+                            &m_Vertices[Index(0, z0)]);
+            PerfCounters::Add(PERF_BYTES_UPLOADED, static_cast<long long>(z1 - z0) * m_Width * sizeof(Vertex));
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+}
+
+void ShallowWater::SetupMesh()
+{
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    glGenBuffers(1, &m_VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(Vertex), m_Vertices.data(), GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &m_EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(unsigned int), m_Indices.data(), GL_STATIC_DRAW);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+    m_GpuMemory.Set(m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+
+    // 与 WaterPlane 相同的顶点布局
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoord));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+}
+
+void ShallowWater::ReleaseCpuCopies()
+{
+    if (m_EBO == 0)
+        return;
+
+    std::vector<unsigned int>().swap(m_Indices);
+    UpdateMemoryStats();
+}
+
+void ShallowWater::UpdateMemoryStats()
+{
+    size_t bytes = VectorBytes(m_Ground) + VectorBytes(m_Depth) + VectorBytes(m_PreviousDepth) +
+                   VectorBytes(m_FluxL) + VectorBytes(m_FluxR) + VectorBytes(m_FluxT) + VectorBytes(m_FluxB) +
+                   VectorBytes(m_VelocityX) + VectorBytes(m_VelocityZ) + VectorBytes(m_Tiles) +
+                   VectorBytes(m_Vertices) + VectorBytes(m_Indices) +
+                   VectorBytes(m_TileIndexOffset) + VectorBytes(m_TileIndexCount);
+    m_CpuMemory.Set(bytes);
+}
+
+// ========================================
+// 渲染：只画有水的块，相邻的块合并成一个区间
+// ========================================
+void ShallowWater::Render()
+{
+    if (m_VAO == 0)
+        return;
+
+    m_DrawCounts.clear();
+    m_DrawOffsets.clear();
+    int rangeStart = -1;
+    int rangeEnd = -1;
+    for (int t = 0; t < GetTileCount(); ++t)
+    {
+        if (!m_Tiles[t].hasWater || m_TileIndexCount[t] == 0)
+            continue;
+
+        int offset = m_TileIndexOffset[t];
+        if (offset != rangeEnd)
+        {
+            if (rangeStart >= 0)
+            {
+                m_DrawCounts.push_back(rangeEnd - rangeStart);
+                m_DrawOffsets.push_back(reinterpret_cast<const void*>(rangeStart * sizeof(unsigned int)));
+            }
+            rangeStart = offset;
+        }
+        rangeEnd = offset + m_TileIndexCount[t];
+    }
+    if (rangeStart >= 0)
+    {
+        m_DrawCounts.push_back(rangeEnd - rangeStart);
+        m_DrawOffsets.push_back(reinterpret_cast<const void*>(rangeStart * sizeof(unsigned int)));
+    }
+
+    if (m_DrawCounts.empty())
+        return;
+
+    glBindVertexArray(m_VAO);
+    glMultiDrawElements(GL_TRIANGLES, m_DrawCounts.data(), GL_UNSIGNED_INT,
+                        m_DrawOffsets.data(), static_cast<GLsizei>(m_DrawCounts.size()));
+    glBindVertexArray(0);
+
+    long long indexCount = 0;
+    for (GLsizei count : m_DrawCounts)
+        indexCount += count;
+    PerfCounters::Add(PERF_DRAW_CALLS);
+    PerfCounters::Add(PERF_TRIANGLES, indexCount / 3);
+}
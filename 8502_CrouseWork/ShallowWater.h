@@ -0,0 +1,159 @@
+#ifndef SHALLOW_WATER_H
+#define SHALLOW_WATER_H
+
+#include <glad/glad.h>
+#include "nclgl/Vector2.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/MemoryTracker.h"
+#include <vector>
+
+class Terrain;
+
+// ========================================
+// 高度场浅水模拟（Virtual Pipes）
+// ========================================
+// 功能：
+// 1. 每个格子有水深 d，相邻格子之间有一根“虚拟水管”，
+//    水管流量由两边水面高度差（地形 + 水深）加速：
+//      f ← f × damping + dt × g × Δh × l
+//    流出总量超过格子里的水时按比例缩小（水深永远不为负）
+//    然后按流入 - 流出更新水深，并计算水平速度
+// 2. 地形边缘外是海：边缘格子的水可以流出去（按海平面计算）
+// 3. 网格按块（tile）划分：
+//    - 一块里的水深变化和流量都小于阈值，连续若干步后进入休眠
+//    - 每步只计算醒着的块和它们的邻居；邻居的水被扰动就会醒来
+//    - 计算量只与有水流动的区域成正比
+// 4. 多线程：每步分两遍（流量 → 水深），每遍的块之间互不写同一数据，
+//    结果与线程数无关（确定性）
+// 5. 自带渲染网格：顶点高度 = 地形 + 水深（干的格子略低于地形，被地形挡住），
+//    只绘制有水的块，使用水面着色器
+// 6. 固定步长：由 SimulationClock 按 1 / timeStep 的频率调用 Step；
+//    渲染时用插值系数在上一步和这一步的水深之间插值，帧率高于模拟频率时水面也是连续的
+// ========================================
+
+class ShallowWater
+{
+public:
+    struct Settings
+    {
+        int   cellStep      = 4;            // 模拟网格 = 每隔 cellStep 个高度图采样取一个
+        int   tileSize      = 32;           // 块边长（格子数）
+        float timeStep      = 1.0f / 30.0f; // 固定步长（秒）
+        float gravity       = 9.81f;
+        float damping       = 0.995f;       // 每步的流量衰减（摩擦）
+        float seaLevel      = 0.0f;         // 地形外海面高度
+        float sleepEpsilon  = 1e-4f;        // 水深变化 / 流量低于此值视为静止
+        int   sleepSteps    = 30;           // 连续静止多少步后休眠
+        float minDepth      = 0.002f;       // 小于此水深视为干
+    };
+
+    ShallowWater(const Terrain& terrain, const Settings& settings, unsigned int threadCount = 0);
+    ~ShallowWater();
+
+    // 推进一个固定步长
+    void Step();
+
+    // 在世界坐标 (x, z) 附近加水（圆形，中心最多，边缘为 0）
+    void AddWater(float worldX, float worldZ, float radius, float amount);
+
+    // 地形被修改后同步地形高度（高度图网格坐标，包含两端），并唤醒相关块
+    void RefreshTerrain(const Terrain& terrain, int x0, int z0, int x1, int z1);
+
+    // ========================================
+    // 渲染
+    // ========================================
+    // UpdateMesh：重建并上传被改动过的块的顶点；
+    //            alpha 为距上一步的插值系数 [0, 1]（来自 SimulationClock）
+    // Render：只绘制有水的块（调用前需要绑定水面着色器）
+    // ========================================
+    void UpdateMesh(float alpha = 1.0f);
+    void Render();
+
+    // 释放索引的CPU副本（上传后不再需要；顶点每次更新都要用，保留）
+    void ReleaseCpuCopies();
+
+    // ========================================
+    // 查询 / 统计
+    // ========================================
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    float GetCellSize() const { return m_CellSize; }
+    float GetDepth(int x, int z) const { return m_Depth[Index(x, z)]; }
+    Vector2 GetVelocity(int x, int z) const { return Vector2(m_VelocityX[Index(x, z)], m_VelocityZ[Index(x, z)]); }
+    const std::vector<float>& GetDepthData() const { return m_Depth; }
+
+    int GetTileCount() const { return m_TilesX * m_TilesZ; }
+    int GetAwakeTileCount() const;
+    int GetLastProcessedTileCount() const { return m_LastProcessedTiles; }
+    double GetTotalVolume() const;
+
+private:
+    Settings m_Settings;
+    unsigned int m_ThreadCount;
+
+    // 网格
+    int m_Width;
+    int m_Height;
+    float m_CellSize;
+    float m_TerrainSize;
+    int m_TilesX;
+    int m_TilesZ;
+
+    // 每个格子的状态（行主序）
+    std::vector<float> m_Ground;     // 地形高度（世界单位）
+    std::vector<float> m_Depth;      // 水深
+    std::vector<float> m_PreviousDepth;  // 上一步的水深（渲染插值用）
+    std::vector<float> m_FluxL, m_FluxR, m_FluxT, m_FluxB;   // 流向 -X / +X / -Z / +Z
+    std::vector<float> m_VelocityX, m_VelocityZ;
+
+    // 块状态
+    struct Tile
+    {
+        bool awake;
+        int calmSteps;      // 连续静止的步数
+        bool meshDirty;     // 顶点需要重建
+        bool hasWater;      // 有水（需要绘制）
+        bool moving;        // 上一步水深有变化（渲染时需要插值，每帧重建）
+        float maxChange;    // 本步的最大水深变化（用于判断静止）
+        float maxFlow;      // 本步的最大流出量（折算成水深）
+    };
+    std::vector<Tile> m_Tiles;
+    std::vector<int> m_FluxTiles;    // 本步计算流量的块
+    std::vector<int> m_DepthTiles;   // 本步更新水深的块
+    int m_LastProcessedTiles;
+    float m_RenderAlpha;
+
+    // OpenGL
+    struct Vertex
+    {
+        Vector3 Position;
+        Vector3 Normal;
+        Vector2 TexCoord;
+    };
+    std::vector<Vertex> m_Vertices;
+    std::vector<unsigned int> m_Indices;
+    std::vector<int> m_TileIndexOffset;
+    std::vector<int> m_TileIndexCount;
+    std::vector<GLsizei> m_DrawCounts;
+    std::vector<const void*> m_DrawOffsets;
+    GLuint m_VAO;
+    GLuint m_VBO;
+    GLuint m_EBO;
+
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+
+    size_t Index(int x, int z) const { return static_cast<size_t>(z) * m_Width + x; }
+    void SampleGround(const Terrain& terrain, int x0, int z0, int x1, int z1);
+    void WakeTile(int tx, int tz);
+    void CollectTiles();
+    void ComputeFlux(int tile);
+    void UpdateDepth(int tile);
+    void SettleTiles();
+    void BuildTileVertices(int tile);
+    void SetupMesh();
+    void UpdateMemoryStats();
+};
+
+#endif // SHALLOW_WATER_H
@@ -0,0 +1,219 @@
+#include "ShorelineDistance.h"
+#include "Terrain.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float FAR_AWAY = 1e20f;
+
+    // ========================================
+    // 一维平方距离变换（下包络抛物线）
+    // ========================================
+    // d[q] = min_p ((q - p)² + f[p])
+    // 只有有限值的 p 参与下包络（f = FAR_AWAY 的点不可能是最小值），
+    // 既避免了大数相减的精度问题，也省掉了这部分计算
+    // 中间计算用 double：4k 图上的平方距离超过 float 能精确表示的整数范围
+    // ========================================
+    void Transform1D(const float* f, int n, float* d, int* v, double* z)
+    {
+        int k = -1;
+        for (int q = 0; q < n; ++q)
+        {
+            if (f[q] >= FAR_AWAY)
+                continue;
+
+            double fq = static_cast<double>(f[q]) + static_cast<double>(q) * q;
+            double s = -1e30;
+            while (k >= 0)
+            {
+                int p = v[k];
+                s = (fq - (static_cast<double>(f[p]) + static_cast<double>(p) * p)) / (2.0 * (q - p));
+                if (s > z[k])
+                    break;
+                --k;
+            }
+            ++k;
+            v[k] = q;
+            z[k] = k == 0 ? -1e30 : s;
+            z[k + 1] = 1e30;
+        }
+
+        if (k < 0)
+        {
+            std::fill(d, d + n, FAR_AWAY);
+            return;
+        }
+
+        int j = 0;
+        for (int q = 0; q < n; ++q)
+        {
+            while (z[j + 1] < q)
+                ++j;
+            double dq = q - v[j];
+            d[q] = static_cast<float>(dq * dq + f[v[j]]);
+        }
+    }
+}
+
+ShorelineDistance::ShorelineDistance(float maxDistance, unsigned int threadCount)
+    : m_MaxDistance(maxDistance > 0.0f ? maxDistance : 1.0f)
+    , m_ThreadCount(threadCount)
+    , m_Width(0)
+    , m_Height(0)
+    , m_TerrainSize(1.0f)
+    , m_Texture(0)
+    , m_CpuMemory(MEMORY_WATER, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_WATER, MEMORY_GPU_TEXTURE)
+{
+}
+
+ShorelineDistance::~ShorelineDistance()
+{
+    if (m_Texture != 0)
+        glDeleteTextures(1, &m_Texture);
+}
+
+// ========================================
+// 二维变换：列 → 行
+// ========================================
+void ShorelineDistance::SquaredDistanceTransform(const std::vector<unsigned char>& features,
+                                                 int width, int height,
+                                                 std::vector<float>& out,
+                                                 unsigned int threadCount)
+{
+    size_t count = static_cast<size_t>(width) * height;
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        out[i] = features[i] ? 0.0f : FAR_AWAY;
+
+    // 每列：复制到连续的临时数组，变换后写回
+    ParallelFor(width, threadCount, [&](int x) {
+        std::vector<float> f(height), d(height);
+        std::vector<int> v(height);
+        std::vector<double> z(height + 1);
+        for (int y = 0; y < height; ++y)
+            f[y] = out[static_cast<size_t>(y) * width + x];
+        Transform1D(f.data(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; ++y)
+            out[static_cast<size_t>(y) * width + x] = d[y];
+    });
+
+    // 每行：数据本来就连续
+    ParallelFor(height, threadCount, [&](int y) {
+        std::vector<float> f(out.begin() + static_cast<size_t>(y) * width,
+                             out.begin() + static_cast<size_t>(y + 1) * width);
+        std::vector<int> v(width);
+        std::vector<double> z(width + 1);
+        Transform1D(f.data(), width, &out[static_cast<size_t>(y) * width], v.data(), z.data());
+    });
+}
+
+// ========================================
+// 有符号距离
+// ========================================
+// 陆地像素：到最近湿像素的距离 - 0.5
+// 水下像素：-(到最近干像素的距离 - 0.5)
+// ========================================
+void ShorelineDistance::Compute(const Terrain& terrain, float waterLevel)
+{
+    m_Width = terrain.GetWidth();
+    m_Height = terrain.GetHeight();
+    m_TerrainSize = terrain.GetTerrainSize();
+    size_t count = static_cast<size_t>(m_Width) * m_Height;
+
+    // 地形范围以外是开阔水面：四周各加一圈湿像素再做变换，
+    // 这样地形边缘的陆地也会得到到“岸线”的距离
+    const std::vector<float>& heights = terrain.GetHeightData();
+    float heightScale = terrain.GetHeightScale();
+    int paddedWidth = m_Width + 2;
+    int paddedHeight = m_Height + 2;
+    size_t paddedCount = static_cast<size_t>(paddedWidth) * paddedHeight;
+    std::vector<unsigned char> wet(paddedCount, 1), dry(paddedCount, 0);
+    for (int z = 0; z < m_Height; ++z)
+    {
+        for (int x = 0; x < m_Width; ++x)
+        {
+            size_t padded = static_cast<size_t>(z + 1) * paddedWidth + x + 1;
+            wet[padded] = heights[static_cast<size_t>(z) * m_Width + x] * heightScale < waterLevel ? 1 : 0;
+            dry[padded] = 1 - wet[padded];
+        }
+    }
+
+    std::vector<float> toWet, toDry;
+    SquaredDistanceTransform(wet, paddedWidth, paddedHeight, toWet, m_ThreadCount);
+    SquaredDistanceTransform(dry, paddedWidth, paddedHeight, toDry, m_ThreadCount);
+
+    // 格子边长（世界单位）；高度图是正方形地形
+    float cellSize = terrain.GetTerrainSize() / (m_Width - 1);
+    m_Field.resize(count);
+    m_Encoded.resize(count);
+    m_CpuMemory.Set(VectorBytes(m_Field) + VectorBytes(m_Encoded));
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t padded = (i / m_Width + 1) * paddedWidth + i % m_Width + 1;
+        float cells;
+        if (wet[padded])
+            cells = toDry[padded] >= FAR_AWAY ? -FAR_AWAY : -(std::sqrt(toDry[padded]) - 0.5f);
+        else
+            cells = std::sqrt(toWet[padded]) - 0.5f;
+
+        // 整张地形都在水下（没有干像素）时为 -FAR_AWAY，不乘格子边长以免溢出
+        float distance = std::fabs(cells) >= FAR_AWAY ? cells : cells * cellSize;
+        m_Field[i] = distance;
+
+        float normalized = distance / m_MaxDistance * 0.5f + 0.5f;
+        normalized = std::max(0.0f, std::min(1.0f, normalized));
+        m_Encoded[i] = static_cast<unsigned char>(normalized * 255.0f + 0.5f);
+    }
+
+    if (m_Texture != 0)
+        UploadTexture();
+}
+
+// 网格点 i 对应纹理像素中心 (i + 0.5) / W
+Vector4 ShorelineDistance::GetTextureTransform() const
+{
+    float half = m_TerrainSize * 0.5f;
+    float scaleX = (m_Width - 1) / (m_TerrainSize * m_Width);
+    float scaleZ = (m_Height - 1) / (m_TerrainSize * m_Height);
+    return Vector4(scaleX, scaleZ,
+                   half * scaleX + 0.5f / m_Width,
+                   half * scaleZ + 0.5f / m_Height);
+}
+
+void ShorelineDistance::UploadTexture()
+{
+    if (m_Encoded.empty())
+    {
+        LOG_ERROR("错误：岸线距离场尚未计算，无法上传");
+        return;
+    }
+
+    if (m_Texture == 0)
+        glGenTextures(1, &m_Texture);
+
+    glBindTexture(GL_TEXTURE_2D, m_Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_Width, m_Height, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, m_Encoded.data());
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_Encoded.size());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_GpuMemory.Set(MemoryTracker::TextureBytes(m_Width, m_Height, 1, 1, false));
+}
+
+void ShorelineDistance::BindTexture(unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, m_Texture);
+    glActiveTexture(GL_TEXTURE0);
+    PerfCounters::Add(PERF_TEXTURE_BINDS);
+}
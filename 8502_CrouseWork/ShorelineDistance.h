@@ -0,0 +1,86 @@
+#ifndef SHORELINE_DISTANCE_H
+#define SHORELINE_DISTANCE_H
+
+#include <glad/glad.h>
+#include "nclgl/Vector4.h"
+#include "nclgl/MemoryTracker.h"
+#include <vector>
+
+class Terrain;
+
+// ========================================
+// 岸线距离场
+// ========================================
+// 功能：
+// 1. 对地形高度图计算到水位等高线（岸线）的有符号距离（世界单位）：
+//    水下为负，陆地为正，岸线处为 0
+// 2. 精确欧氏距离变换（Felzenszwalb & Huttenlocher）：
+//    先对每一列做一维平方距离变换，再对每一行做一次，
+//    两遍都按列/按行多线程，每列/每行只由一个线程计算，结果与线程数无关
+// 3. 上传为 R8 纹理：[-maxDistance, maxDistance] 线性映射到 [0, 1]，
+//    超出范围截断。水面着色器用它做岸边泡沫、浅水颜色和波浪衰减
+//
+// 岸线位于湿/干像素之间：相邻的湿像素和干像素距离分别为 -0.5 和 +0.5 格
+// 地形范围以外视为水面，所以地形边缘的陆地也有到岸线的距离；
+// 着色器在地形以外用“边缘的距离 - 到地形边缘的距离”外推
+// ========================================
+
+class ShorelineDistance
+{
+public:
+    ShorelineDistance(float maxDistance, unsigned int threadCount = 0);
+    ~ShorelineDistance();
+
+    // 计算整张距离场（地形编辑后重新调用）
+    void Compute(const Terrain& terrain, float waterLevel);
+
+    // ========================================
+    // 二维精确平方距离变换
+    // ========================================
+    // features - width × height，非 0 的像素为特征点
+    // out      - 每个像素到最近特征点的平方距离（像素单位）；
+    //            没有任何特征点时为一个很大的数
+    // ========================================
+    static void SquaredDistanceTransform(const std::vector<unsigned char>& features,
+                                         int width, int height,
+                                         std::vector<float>& out,
+                                         unsigned int threadCount = 0);
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    float GetMaxDistance() const { return m_MaxDistance; }
+
+    // 有符号距离（世界单位，行主序）
+    const std::vector<float>& GetField() const { return m_Field; }
+    float GetDistance(int x, int z) const { return m_Field[static_cast<size_t>(z) * m_Width + x]; }
+
+    // ========================================
+    // 纹理
+    // ========================================
+    // 着色器中：uv = 世界坐标.xz × transform.xy + transform.zw
+    // 解码：距离 = (采样值 × 2 - 1) × maxDistance
+    // uv 超出 [0, 1] 时：距离 = 采样(clamp(uv)) - 到地形边缘的世界距离
+    // ========================================
+    void UploadTexture();
+    Vector4 GetTextureTransform() const;
+    void BindTexture(unsigned int unit) const;
+    bool IsUploaded() const { return m_Texture != 0; }
+
+private:
+    float m_MaxDistance;
+    unsigned int m_ThreadCount;
+
+    int m_Width;
+    int m_Height;
+    float m_TerrainSize;
+    std::vector<float> m_Field;
+    std::vector<unsigned char> m_Encoded;
+
+    GLuint m_Texture;
+
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+};
+
+#endif // SHORELINE_DISTANCE_H
@@ -0,0 +1,182 @@
+#include "SimulationClock.h"
+#include "nclgl/GameTimer.h"
+#include "nclgl/LinearArena.h"
+#include "nclgl/Log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    long long ToMicroseconds(double seconds)
+    {
+        return static_cast<long long>(std::llround(seconds * SimulationClock::MICROSECONDS_PER_SECOND));
+    }
+}
+
+SimulationClock::SimulationClock(TimeSource source, double maxFrameSeconds)
+    : m_Source(source)
+    , m_MaxFrameTime(ToMicroseconds(maxFrameSeconds > 0.0 ? maxFrameSeconds : 0.25))
+    , m_Time(0)
+    , m_FrameTime(0)
+    , m_LastSourceTime(0)
+    , m_HasSourceTime(false)
+{
+}
+
+SimulationClock::TimeSource SimulationClock::FromGameTimer(const GameTimer& timer)
+{
+    const GameTimer* source = &timer;
+    return [source]() { return source->GetTotalTimeSeconds(); };
+}
+
+int SimulationClock::AddSystem(const std::string& name, int rateHz, int maxStepsPerFrame, StepFunction step)
+{
+    if (rateHz <= 0 || maxStepsPerFrame <= 0 || !step)
+    {
+        LOG_ERROR("错误：模拟系统 \"" << name << "\" 的参数无效（频率 " << rateHz
+                  << "，每帧最多 " << maxStepsPerFrame << " 步）");
+        return -1;
+    }
+
+    System system;
+    system.name = name;
+    system.rate = rateHz;
+    system.maxStepsPerFrame = maxStepsPerFrame;
+    system.step = step;
+    system.enabled = true;
+    system.stepsDone = 0;
+    system.stepsExecuted = 0;
+    system.stepsDropped = 0;
+    system.stepsThisFrame = 0;
+
+    // 中途注册的系统从当前时刻开始计步，不补之前的步
+    system.stepsDone = StepsDue(system);
+
+    m_Systems.push_back(system);
+    return static_cast<int>(m_Systems.size()) - 1;
+}
+
+void SimulationClock::SetSystemEnabled(int system, bool enabled)
+{
+    if (system < 0 || system >= GetSystemCount())
+        return;
+    System& s = m_Systems[system];
+    if (enabled && !s.enabled)
+        s.stepsDone = StepsDue(s);
+    s.enabled = enabled;
+}
+
+bool SimulationClock::IsSystemEnabled(int system) const
+{
+    return system >= 0 && system < GetSystemCount() && m_Systems[system].enabled;
+}
+
+// 到当前时刻为止应当完成的步数：floor(时间 × 频率)，整数运算
+long long SimulationClock::StepsDue(const System& system) const
+{
+    return m_Time * system.rate / MICROSECONDS_PER_SECOND;
+}
+
+int SimulationClock::Tick()
+{
+    if (!m_Source)
+    {
+        LOG_ERROR("错误：模拟时钟没有时间来源，请改用 Advance");
+        return 0;
+    }
+
+    // 按读数的差值推进（而不是累加浮点帧时间），量化误差不会累积
+    long long now = ToMicroseconds(m_Source());
+    if (!m_HasSourceTime)
+    {
+        m_LastSourceTime = now;
+        m_HasSourceTime = true;
+    }
+    long long elapsed = now - m_LastSourceTime;
+    m_LastSourceTime = now;
+    return Advance(static_cast<double>(elapsed) / MICROSECONDS_PER_SECOND);
+}
+
+// ========================================
+// 推进一帧
+// ========================================
+// 1. 帧时间量化、截断后累加到模拟时间
+// 2. 每个系统欠下的步数 = 应完成 - 已完成；超过上限的部分丢弃
+// 3. 所有系统的步按时刻先后交替执行：
+//    第 n 步的时刻为 n / rate，比较 (n_a / rate_a) 与 (n_b / rate_b) 用交叉相乘
+// ========================================
+int SimulationClock::Advance(double frameSeconds)
+{
+    m_FrameTime = std::max(0LL, std::min(m_MaxFrameTime, ToMicroseconds(frameSeconds)));
+    m_Time += m_FrameTime;
+
+    ArenaScope scratch(LinearArena::Scratch());
+    ArenaVector<long long> pending(m_Systems.size(), 0, ArenaAllocator<long long>(scratch.GetArena()));
+    for (size_t i = 0; i < m_Systems.size(); ++i)
+    {
+        System& s = m_Systems[i];
+        s.stepsThisFrame = 0;
+
+        long long due = StepsDue(s);
+        if (!s.enabled)
+        {
+            s.stepsDone = due;
+            continue;
+        }
+
+        long long owed = due - s.stepsDone;
+        if (owed > s.maxStepsPerFrame)
+        {
+            long long dropped = owed - s.maxStepsPerFrame;
+            s.stepsDropped += dropped;
+            s.stepsDone += dropped;
+            owed = s.maxStepsPerFrame;
+        }
+        pending[i] = owed;
+    }
+
+    int total = 0;
+    for (;;)
+    {
+        int next = -1;
+        for (size_t i = 0; i < m_Systems.size(); ++i)
+        {
+            if (pending[i] == 0)
+                continue;
+            if (next < 0)
+            {
+                next = static_cast<int>(i);
+                continue;
+            }
+            const System& a = m_Systems[i];
+            const System& b = m_Systems[next];
+            if ((a.stepsDone + 1) * b.rate < (b.stepsDone + 1) * a.rate)
+                next = static_cast<int>(i);
+        }
+        if (next < 0)
+            break;
+
+        System& s = m_Systems[next];
+        s.step(1.0f / s.rate);
+        ++s.stepsDone;
+        ++s.stepsExecuted;
+        ++s.stepsThisFrame;
+        --pending[next];
+        ++total;
+    }
+    return total;
+}
+
+// 当前时刻超出最后一个整步的部分 / 步长
+float SimulationClock::GetAlpha(int system) const
+{
+    const System& s = m_Systems[system];
+    long long phase = (m_Time * s.rate) % MICROSECONDS_PER_SECOND;
+    return static_cast<float>(static_cast<double>(phase) / MICROSECONDS_PER_SECOND);
+}
+
+double SimulationClock::GetSystemTime(int system) const
+{
+    const System& s = m_Systems[system];
+    return static_cast<double>(s.stepsDone) / s.rate;
+}
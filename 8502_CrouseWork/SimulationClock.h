@@ -0,0 +1,112 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class GameTimer;
+
+// ========================================
+// 固定步长模拟时钟
+// ========================================
+// 功能：
+// 1. 每帧把实际经过的时间交给时钟，时钟决定每个系统这一帧执行几步：
+//    每个系统有自己的频率（例如水 30 Hz、动画 60 Hz），每步的 dt 固定，
+//    模拟结果与帧率无关
+// 2. 追帧上限：一帧内某个系统最多执行 maxStepsPerFrame 步，
+//    追不上的步数直接丢弃（记入 GetDroppedSteps），避免越卡越慢
+// 3. 插值系数：GetAlpha 返回当前时刻在该系统上一步和下一步之间的位置 [0, 1)，
+//    渲染时用它在两步状态之间插值
+// 4. 确定性：
+//    - 帧时间先量化成整数微秒再累加，之后全部是整数运算，没有浮点误差累积
+//    - 同一帧内多个系统按各自步的时间先后交替执行（同时刻按注册顺序）
+//    - 相同的帧时间序列（例如回放录制的输入）总是产生相同的步序列
+// 5. 时间来源可注入：默认读取 GameTimer，测试时可以传入假时钟，
+//    或者不用时间来源，直接调用 Advance 喂帧时间
+// ========================================
+
+class SimulationClock
+{
+public:
+    // 返回单调递增的时间（秒）
+    typedef std::function<double()> TimeSource;
+    // 执行一步，参数为固定步长（秒）
+    typedef std::function<void(float)> StepFunction;
+
+    static const long long MICROSECONDS_PER_SECOND = 1000000;
+
+    // maxFrameSeconds：单帧时间上限（断点、拖动窗口后的超长帧按此截断）
+    explicit SimulationClock(TimeSource source = TimeSource(), double maxFrameSeconds = 0.25);
+
+    // 以 GameTimer 的总时间为时间来源（timer 的生命周期要长于时钟）
+    static TimeSource FromGameTimer(const GameTimer& timer);
+
+    // ========================================
+    // 注册系统
+    // ========================================
+    // rateHz           - 每秒步数（整数，保证步的时刻可以精确计算）
+    // maxStepsPerFrame - 每帧最多执行的步数
+    // 返回系统编号；参数无效时返回 -1
+    // ========================================
+    int AddSystem(const std::string& name, int rateHz, int maxStepsPerFrame, StepFunction step);
+
+    // 禁用的系统不执行，也不积累欠下的步数（重新启用时不会一次追很多步）
+    void SetSystemEnabled(int system, bool enabled);
+    bool IsSystemEnabled(int system) const;
+
+    // ========================================
+    // 推进
+    // ========================================
+    // Tick    - 从时间来源读取当前时间，推进两次 Tick 之间的时间
+    // Advance - 直接推进指定的帧时间（秒）
+    // 返回本帧所有系统执行的总步数
+    // ========================================
+    int Tick();
+    int Advance(double frameSeconds);
+
+    // ========================================
+    // 查询
+    // ========================================
+    int GetSystemCount() const { return static_cast<int>(m_Systems.size()); }
+    const std::string& GetSystemName(int system) const { return m_Systems[system].name; }
+    int GetRate(int system) const { return m_Systems[system].rate; }
+    float GetStepSeconds(int system) const { return 1.0f / m_Systems[system].rate; }
+    float GetAlpha(int system) const;
+    int GetStepsThisFrame(int system) const { return m_Systems[system].stepsThisFrame; }
+    long long GetStepCount(int system) const { return m_Systems[system].stepsExecuted; }
+    long long GetDroppedSteps(int system) const { return m_Systems[system].stepsDropped; }
+
+    // 该系统已执行的步对应的模拟时间（秒）
+    double GetSystemTime(int system) const;
+
+    long long GetTimeMicroseconds() const { return m_Time; }
+    double GetTime() const { return static_cast<double>(m_Time) / MICROSECONDS_PER_SECOND; }
+    float GetFrameSeconds() const { return static_cast<float>(m_FrameTime) / MICROSECONDS_PER_SECOND; }
+
+private:
+    struct System
+    {
+        std::string name;
+        int rate;
+        int maxStepsPerFrame;
+        StepFunction step;
+        bool enabled;
+        long long stepsDone;      // 已经处理（执行或丢弃）的步数
+        long long stepsExecuted;
+        long long stepsDropped;
+        int stepsThisFrame;
+    };
+
+    TimeSource m_Source;
+    long long m_MaxFrameTime;
+    long long m_Time;            // 模拟总时间（微秒）
+    long long m_FrameTime;       // 最近一帧的时间（微秒，截断后）
+    long long m_LastSourceTime;  // 上一次 Tick 时时间来源的读数（微秒）
+    bool m_HasSourceTime;
+    std::vector<System> m_Systems;
+
+    long long StepsDue(const System& system) const;
+};
+
+#endif // SIMULATION_CLOCK_H
@@ -1,13 +1,23 @@
 #include "Skybox.h"
-#include <iostream>
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/JobSystem.h"
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
+#include "nclgl/Shader.h"
 
 // STB 库（用于加载纹理）
 #include "stb_image.h"
 
+// 派生数据缓存：解码后的面（宽 | 高 | RGB 像素）
+// 解码方式改变时把版本加 1
+static const unsigned int SKYBOX_FACE_VERSION = 1;
+
 /**
  * 构造函数 - 加载立方体贴图并初始化顶点数据
  */
-Skybox::Skybox(const std::vector<std::string>& faces) {
+Skybox::Skybox(const std::vector<std::string>& faces)
+    : textureMemory(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE)
+    , bufferMemory(MEMORY_MESHES, MEMORY_GPU_BUFFER) {
     // 加载立方体贴图纹理
     cubemapTexture = loadCubemap(faces);
 
@@ -94,6 +104,7 @@ void Skybox::setupSkybox() {
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
+    bufferMemory.Set(sizeof(skyboxVertices));
 
     // 顶点位置属性 (location = 0)
     glEnableVertexAttribArray(0);
@@ -117,47 +128,104 @@ GLuint Skybox::loadCubemap(const std::vector<std::string>& faces) {
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-    std::cout << "开始加载天空盒立方体贴图..." << std::endl;
-
-    // 加载6张纹理到立方体贴图的6个面
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++) {
-        // 使用 STB 加载图像（立方体贴图不需要翻转Y轴）
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 3);  // 强制RGB
-
-        if (data) {
-            // 根据通道数确定格式
-            GLenum format = GL_RGB;  // 默认使用RGB
-            if (nrChannels == 1)
-                format = GL_RED;
-            else if (nrChannels == 3)
-                format = GL_RGB;
-            else if (nrChannels == 4)
-                format = GL_RGBA;
-
-            // 加载纹理数据到对应的立方体贴图面
-            // GL_TEXTURE_CUBE_MAP_POSITIVE_X + i 枚举值是连续的
-            glTexImage2D(
-                GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,  // 目标面
-                0,                                     // Mipmap级别
-                format,                                // 内部格式
-                width, height,                         // 宽度和高度
-                0,                                     // 边框（必须为0）
-                format,                                // 数据格式
-                GL_UNSIGNED_BYTE,                      // 数据类型
-                data                                   // 像素数据
-            );
+    LOG_INFO("开始加载天空盒立方体贴图...");
+
+    // 解码图像是最耗时的部分，6张图片各作为一个作业并行解码（解码结果存进派生数据缓存，
+    // 下次启动直接读取）；上传必须在拥有 GL 上下文的主线程上进行，作为依赖解码完成的主线程作业
+    struct Face {
+        std::vector<int32_t> size;          // 宽、高
+        std::vector<unsigned char> pixels;  // RGB
+        bool cached = false;
+        const char* error = nullptr;   // stbi_failure_reason 按线程记录，要在解码线程上取
+    };
+    std::vector<Face> images(faces.size());
+
+    size_t uploadedBytes = 0;
 
+    JobSystem& jobs = JobSystem::Get();
+    JobCounter decoded, uploaded;
+    for (size_t i = 0; i < faces.size(); i++) {
+        jobs.Run([&faces, &images, i]() {
+            Face& face = images[i];
+            std::vector<unsigned char> encoded;
+            DerivedDataKey key("skybox_face", SKYBOX_FACE_VERSION);
+            if (!key.AddFile(faces[i], &encoded)) {
+                face.error = "无法读取文件";
+                return;
+            }
+
+            DerivedDataCache& cache = DerivedDataCache::Get();
+            std::vector<unsigned char> derived;
+            if (cache.Load(key, derived)) {
+                DerivedDataReader reader(derived);
+                face.cached = reader.ReadArray(face.size) && reader.ReadArray(face.pixels) && reader.IsComplete() &&
+                              face.size.size() == 2 && face.size[0] > 0 && face.size[1] > 0 &&
+                              face.pixels.size() == static_cast<size_t>(face.size[0]) * face.size[1] * 3;
+                if (face.cached)
+                    return;
+            }
+
+            // 使用 STB 加载图像（立方体贴图不需要翻转Y轴）
+            int width = 0, height = 0, nrChannels = 0;
+            unsigned char* data = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+                                                        &width, &height, &nrChannels, 3);  // 强制RGB
+            if (!data) {
+                face.size.clear();
+                face.error = stbi_failure_reason();
+                return;
+            }
+            face.size = { width, height };
+            face.pixels.assign(data, data + static_cast<size_t>(width) * height * 3);
             stbi_image_free(data);
 
-            std::cout << "天空盒纹理加载成功: " << faces[i] << " (" << width << "x" << height << ")" << std::endl;
-        }
-        else {
-            std::cerr << "错误：立方体贴图纹理加载失败: " << faces[i] << std::endl;
-            std::cerr << "STB错误信息: " << stbi_failure_reason() << std::endl;
-        }
+            if (cache.IsOpen()) {
+                derived.clear();
+                DerivedDataWriter writer(derived);
+                writer.WriteArray(face.size);
+                writer.WriteArray(face.pixels);
+                cache.Store(key, derived);
+            }
+        }, &decoded);
     }
 
+    jobs.RunOnMainThread([&]() {
+        // 加载6张纹理到立方体贴图的6个面
+        for (unsigned int i = 0; i < faces.size(); i++) {
+            Face& face = images[i];
+            if (face.size.size() == 2) {
+                // 强制转换成了 RGB，实际数据都是3通道
+                GLenum format = GL_RGB;
+
+                // 加载纹理数据到对应的立方体贴图面
+                // GL_TEXTURE_CUBE_MAP_POSITIVE_X + i 枚举值是连续的
+                glTexImage2D(
+                    GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,  // 目标面
+                    0,                                     // Mipmap级别
+                    format,                                // 内部格式
+                    face.size[0], face.size[1],            // 宽度和高度
+                    0,                                     // 边框（必须为0）
+                    format,                                // 数据格式
+                    GL_UNSIGNED_BYTE,                      // 数据类型
+                    face.pixels.data()                     // 像素数据
+                );
+
+                uploadedBytes += MemoryTracker::TextureBytes(face.size[0], face.size[1], 1, 3, false);
+                PerfCounters::Add(PERF_ASSETS_LOADED);
+
+                LOG_INFO("天空盒纹理加载成功: " << faces[i] << " (" << face.size[0] << "x" << face.size[1] << ")"
+                         << (face.cached ? "（派生数据缓存）" : ""));
+            }
+            else {
+                LOG_ERROR("错误：立方体贴图纹理加载失败: " << faces[i]);
+                LOG_ERROR("STB错误信息: " << (face.error ? face.error : "未知"));
+            }
+        }
+    }, &uploaded, &decoded);
+
+    jobs.Wait(uploaded);
+    textureMemory.Set(uploadedBytes);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, uploadedBytes);
+
     // 设置纹理参数
     // 使用线性过滤，让天空盒更平滑
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -188,12 +256,13 @@ GLuint Skybox::loadCubemap(const std::vector<std::string>& faces) {
 void Skybox::Draw(Shader& shader, const Matrix4& view, const Matrix4& projection) {
     // 安全检查：确保VAO已经创建
     if (VAO == 0) {
-        std::cerr << "错误：天空盒VAO未初始化，无法渲染！" << std::endl;
+        LOG_ERROR_LIMITED("错误：天空盒VAO未初始化，无法渲染！");
         return;
     }
 
     // 激活着色器
     glUseProgram(shader.GetProgram());
+    PerfCounters::Add(PERF_SHADER_BINDS);
 
     // 设置uniform变量（nclgl Shader 使用 glUniform 直接设置）
     glUniformMatrix4fv(glGetUniformLocation(shader.GetProgram(), "view"), 1, false, (float*)&view);
@@ -202,10 +271,13 @@ void Skybox::Draw(Shader& shader, const Matrix4& view, const Matrix4& projection
     // 绑定天空盒立方体贴图到纹理单元0
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+    PerfCounters::Add(PERF_TEXTURE_BINDS);
     glUniform1i(glGetUniformLocation(shader.GetProgram(), "skybox"), 0);
 
     // 渲染立方体
     glBindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);  // 36个顶点（6面 × 2三角形 × 3顶点）
+    PerfCounters::Add(PERF_DRAW_CALLS);
+    PerfCounters::Add(PERF_TRIANGLES, 12);
     glBindVertexArray(0);
 }
@@ -1,11 +1,12 @@
 #pragma once
 #include <glad/glad.h>
 #include "nclgl/Matrix4.h"
+#include "nclgl/MemoryTracker.h"
 #include <string>
 #include <vector>
 
-// 使用 nclgl 框架的 Shader
-#include "nclgl/Shader.h"
+// 使用 nclgl 框架的 Shader（只在 Draw 里用到）
+class Shader;
 
 /**
  * @class Skybox
@@ -52,6 +53,9 @@ private:
     GLuint VBO;              // 顶点缓冲对象
     GLuint cubemapTexture;   // 立方体贴图纹理ID
 
+    TrackedMemory textureMemory;  // 6个面的显存
+    TrackedMemory bufferMemory;   // 顶点缓冲
+
     /**
      * @brief 初始化天空盒立方体的顶点数据和VAO/VBO
      */
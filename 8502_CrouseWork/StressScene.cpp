@@ -0,0 +1,359 @@
+#include "StressScene.h"
+#include "Terrain.h"
+#include "TerrainNoise.h"
+#include "Texture.h"
+#include "nclgl/HardwareCounters.h"
+#include "nclgl/Log.h"
+#include "nclgl/Mesh.h"
+#include "nclgl/MeshAnimation.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+namespace {
+    // Meshes 目录里的静态网格（原点在中心、大小约为 1 的几个）
+    const char* MESH_FILES[] = { "Cube.msh", "Sphere.msh", "Cylinder.msh", "Cone.msh", "Capsule.msh" };
+    const int MESH_FILE_COUNT = sizeof(MESH_FILES) / sizeof(MESH_FILES[0]);
+
+    // 不同格式、不同大小的图片轮流用
+    const char* TEXTURE_FILES[] = {
+        TEXTUREDIR"brick.tga", TEXTUREDIR"rusted_north.jpg", TEXTUREDIR"waterbump.png",
+        TEXTUREDIR"stainedglass.tga", TEXTUREDIR"Barren Reds.JPG", TEXTUREDIR"star.png",
+        TEXTUREDIR"water.tga", TEXTUREDIR"rusted_east.jpg"
+    };
+    const int TEXTURE_FILE_COUNT = sizeof(TEXTURE_FILES) / sizeof(TEXTURE_FILES[0]);
+
+    // 每类物体各用一条随机序列
+    enum Stream
+    {
+        STREAM_TERRAIN,
+        STREAM_MESHES,
+        STREAM_CHARACTERS,
+        STREAM_LIGHTS
+    };
+
+    class SceneRandom
+    {
+    public:
+        SceneRandom(unsigned int seed, Stream stream)
+            : m_Engine(seed * 0x9E3779B9u + static_cast<unsigned int>(stream) * 0x85EBCA6Bu + 1u) {}
+
+        // [low, high)
+        float Next(float low, float high)
+        {
+            return low + (high - low) * ((m_Engine() >> 8) * (1.0f / 16777216.0f));
+        }
+
+        int NextInt(int count)
+        {
+            return static_cast<int>(m_Engine() % static_cast<unsigned int>(count));
+        }
+
+    private:
+        std::mt19937 m_Engine;
+    };
+}
+
+// ========================================
+// 构造函数
+// ========================================
+StressScene::StressScene(const Settings& settings)
+    : m_Settings(settings)
+    , m_Loaded(true)
+    , m_Terrain(nullptr)
+    , m_CharacterMesh(nullptr)
+    , m_Animation(nullptr)
+{
+    BuildTerrain();
+    LoadTextures();
+    PlaceMeshes();
+    PlaceCharacters();
+    PlaceLights();
+
+    if (m_Loaded) {
+        Update(0.0f);
+        LOG_INFO("✓ 压力测试场景：地形 " << m_Settings.heightmapSize << "²，"
+                 << m_Instances.size() << " 个网格，" << m_Characters.size() << " 个角色，"
+                 << m_Lights.size() << " 个光源，" << m_Textures.size() << " 张纹理");
+    }
+}
+
+StressScene::~StressScene()
+{
+    delete m_Terrain;
+    for (Mesh* mesh : m_Meshes) {
+        delete mesh;
+    }
+    delete m_CharacterMesh;
+    delete m_Animation;
+    for (Texture* texture : m_Textures) {
+        delete texture;
+    }
+}
+
+// ========================================
+// 地形
+// ========================================
+void StressScene::BuildTerrain()
+{
+    if (m_Settings.heightmapSize < 2) {
+        return;     // 平地
+    }
+    ProfileScope scope("StressScene::BuildTerrain",
+                       static_cast<long long>(m_Settings.heightmapSize) * m_Settings.heightmapSize);
+
+    // 噪声种子也从场景种子来，换种子就换一片地形
+    SceneRandom random(m_Settings.seed, STREAM_TERRAIN);
+    TerrainNoise noise(static_cast<unsigned int>(random.NextInt(1 << 30)) + 1u);
+    TerrainNoise::Settings noiseSettings;
+    m_Terrain = new Terrain(noise, noiseSettings, m_Settings.heightmapSize,
+                            m_Settings.terrainSize, m_Settings.heightScale);
+}
+
+float StressScene::GroundHeight(float x, float z) const
+{
+    return m_Terrain ? m_Terrain->GetHeightAt(x, z) : 0.0f;
+}
+
+// ========================================
+// 纹理
+// ========================================
+void StressScene::LoadTextures()
+{
+    ProfileScope scope("StressScene::LoadTextures", m_Settings.textures);
+    for (int i = 0; i < m_Settings.textures; ++i) {
+        Texture* texture = new Texture(TEXTURE_FILES[i % TEXTURE_FILE_COUNT]);
+        if (!texture->IsLoaded()) {
+            delete texture;
+            continue;
+        }
+        m_Textures.push_back(texture);
+    }
+}
+
+// ========================================
+// 静态网格
+// ========================================
+void StressScene::PlaceMeshes()
+{
+    if (m_Settings.meshInstances <= 0) {
+        return;
+    }
+    ProfileScope scope("StressScene::PlaceMeshes", m_Settings.meshInstances);
+
+    // 几个网格文件在作业系统上并行解析
+    m_Meshes = Mesh::LoadFromMeshFiles(std::vector<std::string>(MESH_FILES, MESH_FILES + MESH_FILE_COUNT));
+    for (int i = 0; i < MESH_FILE_COUNT; ++i) {
+        if (!m_Meshes[i]) {
+            LOG_ERROR("错误：压力测试场景无法加载网格 " << MESH_FILES[i]);
+            m_Loaded = false;
+            return;
+        }
+    }
+
+    SceneRandom random(m_Settings.seed, STREAM_MESHES);
+    float half = m_Settings.terrainSize * 0.5f;
+    m_Instances.resize(m_Settings.meshInstances);
+    for (Instance& instance : m_Instances) {
+        float x = random.Next(-half, half);
+        float z = random.Next(-half, half);
+        float yaw = random.Next(0.0f, 360.0f);
+        float scale = random.Next(0.25f, 1.5f);
+
+        // 纹理数量不影响取了几个随机数，改纹理数量时网格的位置不变
+        int texturePick = random.NextInt(1 << 30);
+
+        instance.mesh = random.NextInt(MESH_FILE_COUNT);
+        instance.texture = m_Textures.empty() ? -1 : texturePick % static_cast<int>(m_Textures.size());
+        instance.position = Vector3(x, GroundHeight(x, z) + scale * 0.5f, z);
+        instance.radius = scale;
+        instance.model = Matrix4::Translation(instance.position) *
+                         Matrix4::Rotation(yaw, Vector3(0, 1, 0)) *
+                         Matrix4::Scale(Vector3(scale, scale, scale));
+        instance.lightCount = 0;
+    }
+}
+
+// ========================================
+// 角色
+// ========================================
+void StressScene::PlaceCharacters()
+{
+    if (m_Settings.characters <= 0) {
+        return;
+    }
+    ProfileScope scope("StressScene::PlaceCharacters", m_Settings.characters);
+
+    m_CharacterMesh = Mesh::LoadFromMeshFile("Role_T.msh");
+    m_Animation = new MeshAnimation("Role_T.anm");
+    if (!m_CharacterMesh || m_Animation->GetFrameCount() == 0 ||
+        m_Animation->GetJointCount() != m_CharacterMesh->GetJointCount()) {
+        LOG_ERROR("错误：压力测试场景无法加载角色 Role_T（网格或动画缺失，或骨骼数不一致）");
+        m_Loaded = false;
+        return;
+    }
+
+    SceneRandom random(m_Settings.seed, STREAM_CHARACTERS);
+    float half = m_Settings.terrainSize * 0.5f;
+    float length = m_Animation->GetFrameCount() / std::max(m_Animation->GetFrameRate(), 1.0f);
+    m_Characters.resize(m_Settings.characters);
+    for (Character& character : m_Characters) {
+        float x = random.Next(-half, half);
+        float z = random.Next(-half, half);
+        float yaw = random.Next(0.0f, 360.0f);
+
+        character.position = Vector3(x, GroundHeight(x, z), z);
+        character.model = Matrix4::Translation(character.position) *
+                          Matrix4::Rotation(yaw, Vector3(0, 1, 0));
+        character.startTime = random.Next(0.0f, length);
+    }
+    m_JointMatrices.resize(m_Characters.size() * m_CharacterMesh->GetJointCount());
+}
+
+// ========================================
+// 光源
+// ========================================
+void StressScene::PlaceLights()
+{
+    if (m_Settings.lights <= 0) {
+        return;
+    }
+    SceneRandom random(m_Settings.seed, STREAM_LIGHTS);
+    float half = m_Settings.terrainSize * 0.5f;
+    m_Lights.resize(m_Settings.lights);
+    for (Light& light : m_Lights) {
+        float x = random.Next(-half, half);
+        float z = random.Next(-half, half);
+
+        light.centre = Vector3(x, GroundHeight(x, z) + 2.0f, z);
+        light.orbitRadius = random.Next(1.0f, 8.0f);
+        light.speed = random.Next(0.2f, 1.0f);
+        light.phase = random.Next(0.0f, 2.0f * PI);
+        light.radius = random.Next(4.0f, 12.0f);
+        light.colour = Vector4(random.Next(0.3f, 1.0f), random.Next(0.3f, 1.0f), random.Next(0.3f, 1.0f), 1.0f);
+        light.position = light.centre;
+    }
+}
+
+// ========================================
+// 每帧更新
+// ========================================
+void StressScene::Update(float time)
+{
+    ProfileScope scope("StressScene::Update");
+    for (Light& light : m_Lights) {
+        float angle = light.phase + light.speed * time;
+        light.position = light.centre + Vector3(std::cos(angle), 0.0f, std::sin(angle)) * light.orbitRadius;
+    }
+    AnimateCharacters(time);
+    AssignLights();
+}
+
+// ========================================
+// 骨骼动画
+// ========================================
+// 和 nclgl 教程的蒙皮一样：当前帧的关节矩阵 × 逆绑定姿势，不在帧之间插值。
+// 每个角色只写自己那一段 m_JointMatrices，按角色并行，结果和线程数无关
+// ========================================
+void StressScene::AnimateCharacters(float time)
+{
+    if (m_Characters.empty()) {
+        return;
+    }
+    unsigned int jointCount = m_CharacterMesh->GetJointCount();
+    ProfileScope scope("StressScene::AnimateCharacters",
+                       static_cast<long long>(m_Characters.size()) * jointCount);
+
+    const Matrix4* inverseBindPose = m_CharacterMesh->GetInverseBindPose();
+    unsigned int frameCount = m_Animation->GetFrameCount();
+    ParallelFor(static_cast<int>(m_Characters.size()), m_Settings.threadCount, [&](int c)
+    {
+        float frameTime = (time + m_Characters[c].startTime) * m_Animation->GetFrameRate();
+        unsigned int frame = static_cast<unsigned int>(std::max(frameTime, 0.0f)) % frameCount;
+
+        const Matrix4* joints = m_Animation->GetJointData(frame);
+        Matrix4* out = &m_JointMatrices[static_cast<size_t>(c) * jointCount];
+        for (unsigned int j = 0; j < jointCount; ++j) {
+            out[j] = joints[j] * inverseBindPose[j];
+        }
+    });
+}
+
+const Matrix4* StressScene::GetJointMatrices(int character) const
+{
+    return &m_JointMatrices[static_cast<size_t>(character) * m_CharacterMesh->GetJointCount()];
+}
+
+// ========================================
+// 给网格分配光源
+// ========================================
+// 每个实例找出包围球和光源范围相交的光源（最多 MAX_LIGHTS_PER_OBJECT 个），
+// 就是前向渲染里逐物体选光源的做法：实例数 × 光源数
+// ========================================
+void StressScene::AssignLights()
+{
+    if (m_Instances.empty()) {
+        return;
+    }
+    ProfileScope scope("StressScene::AssignLights",
+                       static_cast<long long>(m_Instances.size()) * m_Lights.size());
+
+    for (Instance& instance : m_Instances) {
+        instance.lightCount = 0;
+        for (size_t l = 0; l < m_Lights.size() && instance.lightCount < MAX_LIGHTS_PER_OBJECT; ++l) {
+            const Light& light = m_Lights[l];
+            Vector3 offset = light.position - instance.position;
+            float reach = light.radius + instance.radius;
+            if (Vector3::Dot(offset, offset) < reach * reach) {
+                instance.lights[instance.lightCount++] = static_cast<int>(l);
+            }
+        }
+    }
+}
+
+// ========================================
+// 解析参数文字
+// ========================================
+bool StressScene::ParseSpec(const std::string& text, Settings& settings)
+{
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            LOG_ERROR("错误：场景参数 \"" << item << "\" 应该是 名字=数字");
+            return false;
+        }
+        std::string key = item.substr(0, equals);
+        std::string value = item.substr(equals + 1);
+        char* end = nullptr;
+        long number = strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || number < 0) {
+            LOG_ERROR("错误：场景参数 " << key << " 的值 \"" << value << "\" 不是非负整数");
+            return false;
+        }
+
+        if (key == "seed") {
+            settings.seed = static_cast<unsigned int>(number);
+        } else if (key == "heightmap") {
+            settings.heightmapSize = static_cast<int>(number);
+        } else if (key == "meshes") {
+            settings.meshInstances = static_cast<int>(number);
+        } else if (key == "characters") {
+            settings.characters = static_cast<int>(number);
+        } else if (key == "lights") {
+            settings.lights = static_cast<int>(number);
+        } else if (key == "textures") {
+            settings.textures = static_cast<int>(number);
+        } else {
+            LOG_ERROR("错误：无法识别的场景参数 " << key
+                      << "（可用：seed heightmap meshes characters lights textures）");
+            return false;
+        }
+    }
+    return true;
+}
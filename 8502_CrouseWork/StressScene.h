@@ -0,0 +1,148 @@
+#ifndef STRESS_SCENE_H
+#define STRESS_SCENE_H
+
+#include "nclgl/Matrix4.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/Vector4.h"
+#include <string>
+#include <vector>
+
+class Mesh;
+class MeshAnimation;
+class Terrain;
+class Texture;
+
+// ========================================
+// 压力测试场景生成器
+// ========================================
+// 项目自带的场景只有一张高度图、一片水面和天空盒，碰不到规模上的瓶颈。
+// 这里按参数生成大得多的场景，用来测各个子系统随规模怎么变化：
+// 1. 地形：指定边长的噪声地形（种子来自场景种子）
+// 2. 静态网格：Meshes 目录里的立方体 / 球体 / 圆柱 / 圆锥 / 胶囊，随机摆在地形上
+// 3. 角色：Role_T 带骨骼动画，每个角色从动画的不同位置开始播放
+// 4. 点光源：绕各自的中心转圈，每帧重新给每个网格分配影响它的光源
+// 5. 纹理：轮流加载 Textures 目录里几张不同格式的图片，每张都单独解码上传
+//
+// 确定性：
+// 只用 std::mt19937（标准规定了输出序列），不用 std::uniform_real_distribution
+// （各标准库实现不同）。每类物体用种子派生出的独立随机序列，
+// 所以只改某一类的数量时，其他物体的位置不变 —— 扫描规模时只有一个变量。
+//
+// 网格、动画和纹理文件每种只加载一次，实例共享（纹理数量除外，见上）。
+// ========================================
+
+class StressScene
+{
+public:
+    static const int MAX_LIGHTS_PER_OBJECT = 8;
+
+    struct Settings
+    {
+        unsigned int seed   = 1;
+        int heightmapSize   = 257;    // 地形边长（顶点数）
+        int meshInstances   = 100;
+        int characters      = 4;
+        int lights          = 8;
+        int textures        = 4;
+        float terrainSize   = 100.0f;
+        float heightScale   = 10.0f;
+        unsigned int threadCount = 0; // 角色动画用几个线程（0 = 作业系统的全部线程）
+    };
+
+    // 静态网格实例
+    struct Instance
+    {
+        int mesh;                       // GetMesh 的下标
+        int texture;                    // GetTexture 的下标，没有纹理时为 -1
+        Vector3 position;
+        float radius;                   // 包围球半径（用于分配光源）
+        Matrix4 model;
+        int lightCount;                 // 上一次 Update 分配到的光源
+        int lights[MAX_LIGHTS_PER_OBJECT];
+    };
+
+    // 带动画的角色
+    struct Character
+    {
+        Vector3 position;
+        Matrix4 model;
+        float startTime;                // 动画起点（秒），让角色的动作错开
+    };
+
+    struct Light
+    {
+        Vector3 centre;                 // 转圈的中心
+        float orbitRadius;
+        float speed;                    // 弧度/秒
+        float phase;
+        float radius;                   // 影响范围
+        Vector4 colour;
+        Vector3 position;               // 上一次 Update 的位置
+    };
+
+    explicit StressScene(const Settings& settings);
+    ~StressScene();
+
+    // 地形、网格和动画文件都加载成功（纹理加载失败只跳过那一张）
+    bool IsLoaded() const { return m_Loaded; }
+
+    // ========================================
+    // 推进到 time（秒）
+    // ========================================
+    // 移动光源、给每个角色计算骨骼矩阵（动画帧 × 逆绑定姿势）、
+    // 重新给每个网格实例分配光源
+    // ========================================
+    void Update(float time);
+
+    const Settings& GetSettings() const { return m_Settings; }
+    Terrain* GetTerrain() const { return m_Terrain; }
+    int GetMeshCount() const { return static_cast<int>(m_Meshes.size()); }
+    Mesh* GetMesh(int i) const { return m_Meshes[i]; }
+    Mesh* GetCharacterMesh() const { return m_CharacterMesh; }
+    int GetTextureCount() const { return static_cast<int>(m_Textures.size()); }
+    Texture* GetTexture(int i) const { return m_Textures[i]; }
+
+    const std::vector<Instance>& GetInstances() const { return m_Instances; }
+    const std::vector<Character>& GetCharacters() const { return m_Characters; }
+    const std::vector<Light>& GetLights() const { return m_Lights; }
+
+    // 第 i 个角色的骨骼矩阵（GetCharacterMesh()->GetJointCount() 个）
+    const Matrix4* GetJointMatrices(int character) const;
+
+    // ========================================
+    // 从文字读参数
+    // ========================================
+    // 格式："seed=7,heightmap=513,meshes=2000,characters=16,lights=64,textures=8"
+    // 只改写出现的项；有不认识的项或数字不对时返回 false
+    // ========================================
+    static bool ParseSpec(const std::string& text, Settings& settings);
+
+private:
+    Settings m_Settings;
+    bool m_Loaded;
+
+    Terrain* m_Terrain;
+    std::vector<Mesh*> m_Meshes;
+    Mesh* m_CharacterMesh;
+    MeshAnimation* m_Animation;
+    std::vector<Texture*> m_Textures;
+
+    std::vector<Instance> m_Instances;
+    std::vector<Character> m_Characters;
+    std::vector<Light> m_Lights;
+    std::vector<Matrix4> m_JointMatrices;   // 每个角色 jointCount 个，连续存放
+
+    void BuildTerrain();
+    void LoadTextures();
+    void PlaceMeshes();
+    void PlaceCharacters();
+    void PlaceLights();
+
+    void AnimateCharacters(float time);
+    void AssignLights();
+
+    // 地形上 (x, z) 处的高度（没有地形时为 0）
+    float GroundHeight(float x, float z) const;
+};
+
+#endif // STRESS_SCENE_H
@@ -1,13 +1,40 @@
 #include "Terrain.h"
-#include <iostream>
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/HardwareCounters.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
 #include <algorithm>
-#include <windows.h>  // GetCurrentDirectoryA
+#include <cmath>
+#include <filesystem>
+#include <limits>
 
 // ========================================
 // STB - 图像加载库
 // ========================================
 #include "stb_image.h"
 
+// ========================================
+// 并行构建时每个任务处理的行数
+// ========================================
+// 每个任务大约处理这么多个顶点；笔刷这种小区域只有一个任务，
+// 直接在当前线程完成，不值得分发
+// ========================================
+static const int VERTICES_PER_JOB = 16384;
+
+static int RowGrain(int rowLength)
+{
+    return std::max(1, VERTICES_PER_JOB / std::max(1, rowLength));
+}
+
+// ========================================
+// 派生数据缓存中地形网格的版本
+// ========================================
+// 高度图的读取、顶点、法向量、索引或 LOD 误差的算法改变时加 1，
+// 旧的缓存项就不会再被找到
+// ========================================
+static const unsigned int TERRAIN_MESH_VERSION = 1;
+
 // ========================================
 // 构造函数 - 创建地形对象
 // ========================================
@@ -22,54 +49,165 @@ Terrain::Terrain(const std::string& heightmapPath,
     , m_TerrainSize(terrainSize)    // 存储地形大小参数
     , m_HeightScale(heightScale)    // 存储高度缩放参数
     , m_IndexCount(0)       // 索引数量，稍后生成索引时设置
+    , m_ChunksX(0)
+    , m_ChunksZ(0)
+    , m_LodActive(false)
+    , m_DrawnIndexCount(0)
+    , m_KeepCpuCopies(true)
+    , m_CpuMemory(MEMORY_TERRAIN, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_TERRAIN, MEMORY_GPU_BUFFER)
 {
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "开始创建地形..." << std::endl;
-    std::cout << "========================================" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("开始创建地形...");
+    LOG_INFO("========================================");
+
+    // ========================================
+    // 派生数据缓存：高度图文件的内容和参数都没变时，
+    // 直接读取上次生成的高度、顶点、索引和 LOD 分块，跳过步骤1-4。
+    // 缓存没打开时不读文件算哈希；读了的话文件内容留给步骤1解码，不读第二遍
+    // ========================================
+    DerivedDataKey meshKey("terrain_mesh", TERRAIN_MESH_VERSION);
+    std::vector<unsigned char> contents;
+    bool keyed = DerivedDataCache::Get().IsOpen() && meshKey.AddFile(heightmapPath, &contents);
+    meshKey.Add(m_TerrainSize);
+    meshKey.Add(m_HeightScale);
+    meshKey.Add(static_cast<int32_t>(LOD_CHUNK_CELLS));
+    meshKey.Add(static_cast<int32_t>(LOD_LEVELS));
+    meshKey.Add(static_cast<int32_t>(sizeof(Vertex)));
+    if (keyed && LoadMeshCache(meshKey))
+    {
+        LOG_INFO("✓ 地形网格从派生数据缓存读取 (" << m_Width << " x " << m_Height << ")");
+        UploadMesh();
+        return;
+    }
 
     // ========================================
     // 步骤1：加载高度图
     // ========================================
-    std::cout << "\n[步骤1] 加载高度图: " << heightmapPath << std::endl;
-    if (!LoadHeightmap(heightmapPath))
+    LOG_INFO("\n[步骤1] 加载高度图: " << heightmapPath);
+    if (!LoadHeightmap(heightmapPath, keyed ? &contents : nullptr))
     {
-        std::cerr << "错误：无法加载高度图！" << std::endl;
+        LOG_ERROR("错误：无法加载高度图！");
         return;
     }
-    std::cout << "✓ 成功加载高度图 (" << m_Width << " x " << m_Height << ")" << std::endl;
+    LOG_INFO("✓ 成功加载高度图 (" << m_Width << " x " << m_Height << ")");
+
+    BuildMesh();
+    if (keyed)
+    {
+        StoreMeshCache(meshKey);
+    }
+}
+
+// ========================================
+// 构造函数 - 程序化生成地形
+// ========================================
+Terrain::Terrain(const TerrainNoise& noise,
+                 const TerrainNoise::Settings& settings,
+                 int resolution,
+                 float terrainSize,
+                 float heightScale,
+                 unsigned int threadCount)
+    : m_VAO(0)
+    , m_VBO(0)
+    , m_EBO(0)
+    , m_Width(resolution)
+    , m_Height(resolution)
+    , m_TerrainSize(terrainSize)
+    , m_HeightScale(heightScale)
+    , m_IndexCount(0)
+    , m_ChunksX(0)
+    , m_ChunksZ(0)
+    , m_LodActive(false)
+    , m_DrawnIndexCount(0)
+    , m_KeepCpuCopies(true)
+    , m_CpuMemory(MEMORY_TERRAIN, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_TERRAIN, MEMORY_GPU_BUFFER)
+{
+    LOG_INFO("\n========================================");
+    LOG_INFO("开始程序化生成地形...");
+    LOG_INFO("========================================");
+
+    // ========================================
+    // 步骤1：用噪声生成高度数据
+    // ========================================
+    // 直接写入 m_HeightData（0.0 - 1.0），与加载高度图的结果格式一致
+    LOG_INFO("\n[步骤1] 生成噪声高度 (" << m_Width << " x " << m_Height << ")...");
+    {
+        ProfileScope scope("Terrain::GenerateHeights", static_cast<long long>(m_Width) * m_Height);
+        noise.Generate(settings, m_HeightData, m_Width, m_Height, threadCount);
+    }
+    LOG_INFO("✓ 高度数据生成完成");
 
+    BuildMesh();
+}
+
+// ========================================
+// 从高度数据构建网格（步骤2-5）
+// ========================================
+void Terrain::BuildMesh()
+{
     // ========================================
     // 步骤2：生成顶点数据
     // ========================================
-    std::cout << "\n[步骤2] 生成地形顶点..." << std::endl;
-    GenerateVertices();
-    std::cout << "✓ 生成了 " << m_Vertices.size() << " 个顶点" << std::endl;
+    LOG_INFO("\n[步骤2] 生成地形顶点...");
+    long long vertexCount = static_cast<long long>(m_Width) * m_Height;
+    {
+        ProfileScope scope("Terrain::GenerateVertices", vertexCount);
+        GenerateVertices();
+    }
+    LOG_INFO("✓ 生成了 " << m_Vertices.size() << " 个顶点");
 
     // ========================================
     // 步骤3：生成三角形索引
     // ========================================
-    std::cout << "\n[步骤3] 生成三角形索引..." << std::endl;
-    GenerateIndices();
-    std::cout << "✓ 生成了 " << m_Indices.size() / 3 << " 个三角形 ("
-              << m_Indices.size() << " 个索引)" << std::endl;
+    LOG_INFO("\n[步骤3] 生成三角形索引...");
+    {
+        ProfileScope scope("Terrain::GenerateIndices", vertexCount);
+        GenerateIndices();
+    }
+    LOG_INFO("✓ 生成了 " << m_IndexCount / 3 << " 个三角形 ("
+             << m_Chunks.size() << " 块，" << LOD_LEVELS << " 级 LOD 共 " << m_Indices.size() << " 个索引)");
+    {
+        ProfileScope scope("Terrain::ComputeLodErrors", vertexCount);
+        UpdateChunkErrors({ 0, 0, m_Width - 1, m_Height - 1 });
+    }
 
     // ========================================
     // 步骤4：计算法向量
     // ========================================
-    std::cout << "\n[步骤4] 计算顶点法向量..." << std::endl;
-    CalculateNormals();
-    std::cout << "✓ 法向量计算完成" << std::endl;
+    LOG_INFO("\n[步骤4] 计算顶点法向量...");
+    {
+        ProfileScope scope("Terrain::CalculateNormals", vertexCount);
+        CalculateNormals();
+    }
+    LOG_INFO("✓ 法向量计算完成");
+
+    UploadMesh();
+}
+
+// ========================================
+// 上传网格（步骤5）
+// ========================================
+void Terrain::UploadMesh()
+{
+    long long vertexCount = static_cast<long long>(m_Width) * m_Height;
 
     // ========================================
     // 步骤5：设置OpenGL缓冲对象
     // ========================================
-    std::cout << "\n[步骤5] 创建OpenGL缓冲对象..." << std::endl;
-    SetupMesh();
-    std::cout << "✓ GPU缓冲对象创建成功" << std::endl;
+    LOG_INFO("\n[步骤5] 创建OpenGL缓冲对象...");
+    {
+        ProfileScope scope("Terrain::SetupMesh", vertexCount);
+        SetupMesh();
+    }
+    LOG_INFO("✓ GPU缓冲对象创建成功");
+
+    UpdateMemoryStats();
 
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "地形创建完成！" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("地形创建完成！");
+    LOG_INFO("========================================\n");
 }
 
 // ========================================
@@ -86,26 +224,27 @@ Terrain::~Terrain()
     if (m_EBO != 0)
         glDeleteBuffers(1, &m_EBO);
 
-    std::cout << "地形对象已销毁，GPU资源已释放" << std::endl;
+    LOG_INFO("地形对象已销毁，GPU资源已释放");
 }
 
 // ========================================
 // 加载高度图
 // ========================================
 // 工作原理：
-// 1. 使用STB_image读取图像文件
+// 1. 使用STB_image读取图像文件（或解码已经读进内存的文件内容）
 // 2. 提取每个像素的亮度值（0-255）
 // 3. 存储到 m_HeightData 数组中
 // ========================================
-bool Terrain::LoadHeightmap(const std::string& path)
+bool Terrain::LoadHeightmap(const std::string& path, const std::vector<unsigned char>* contents)
 {
+    ProfileScope scope("Terrain::LoadHeightmap");
+
     // ========================================
     // 打印调试信息
     // ========================================
-    char currentDir[MAX_PATH];
-    GetCurrentDirectoryA(MAX_PATH, currentDir);
-    std::cout << "  当前工作目录: " << currentDir << std::endl;
-    std::cout << "  尝试加载高度图: " << path << std::endl;
+    std::string currentDir = std::filesystem::current_path().string();
+    LOG_INFO("  当前工作目录: " << currentDir);
+    LOG_INFO("  尝试加载高度图: " << path);
 
     // ========================================
     // 使用 STB 加载图像
@@ -118,33 +257,42 @@ bool Terrain::LoadHeightmap(const std::string& path)
     //   0             - 自动检测通道数（而不是强制转换）
     // ========================================
     int channels;
-    unsigned char* data = stbi_load(path.c_str(), &m_Width, &m_Height, &channels, 0);
+    unsigned char* data = nullptr;
+    if (contents && !contents->empty())
+    {
+        data = stbi_load_from_memory(contents->data(), static_cast<int>(contents->size()),
+                                     &m_Width, &m_Height, &channels, 0);
+    }
+    else
+    {
+        data = stbi_load(path.c_str(), &m_Width, &m_Height, &channels, 0);
+    }
 
     // 检查是否加载成功
     if (!data)
     {
-        std::cerr << "错误：无法加载图像 " << path << std::endl;
-        std::cerr << "STB错误信息: " << stbi_failure_reason() << std::endl;
+        LOG_ERROR("错误：无法加载图像 " << path);
+        LOG_ERROR("STB错误信息: " << stbi_failure_reason());
 
         // 尝试使用绝对路径
-        char absPath[MAX_PATH];
-        GetCurrentDirectoryA(MAX_PATH, absPath);
-        std::string fullPath = std::string(absPath) + "\\" + path;
-        std::cout << "  尝试使用绝对路径: " << fullPath << std::endl;
+        std::string fullPath = (std::filesystem::current_path() / path).string();
+        LOG_INFO("  尝试使用绝对路径: " << fullPath);
         data = stbi_load(fullPath.c_str(), &m_Width, &m_Height, &channels, 0);
 
         if (!data) {
-            std::cerr << "  绝对路径也失败: " << stbi_failure_reason() << std::endl;
+            LOG_ERROR("  绝对路径也失败: " << stbi_failure_reason());
             return false;
         }
-        std::cout << "  ✓ 使用绝对路径加载成功！" << std::endl;
+        LOG_INFO("  ✓ 使用绝对路径加载成功！");
     }
+    PerfCounters::Add(PERF_ASSETS_LOADED);
 
     // ========================================
     // 打印图像信息
     // ========================================
-    std::cout << "  图像信息: " << m_Width << "x" << m_Height
-              << ", 通道数: " << channels << std::endl;
+    scope.SetElements(static_cast<long long>(m_Width) * m_Height);
+    LOG_INFO("  图像信息: " << m_Width << "x" << m_Height
+             << ", 通道数: " << channels);
 
     // ========================================
     // 将图像数据转换为高度值
@@ -190,6 +338,111 @@ bool Terrain::LoadHeightmap(const std::string& path)
     return true;
 }
 
+// ========================================
+// 派生数据缓存
+// ========================================
+// 内容：宽 | 高 | 第 0 级索引数 | 块数 X | 块数 Z | 高度 | 顶点 | 索引 | LOD 分块
+// 读出来的数据逐项检查大小，索引不能超出顶点数，各块的索引区间不能超出索引数组，
+// 对不上就当作没有命中，重新生成（缓存本身已经校验过内容的哈希，
+// 这里防的是写入时就不对的数据，免得越界绘制）
+// ========================================
+static bool IndicesInRange(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+    unsigned int largest = 0;
+    for (unsigned int index : indices)
+    {
+        largest = std::max(largest, index);
+    }
+    return indices.empty() || largest < vertexCount;
+}
+
+bool Terrain::LoadMeshCache(const DerivedDataKey& key)
+{
+    std::vector<unsigned char> data;
+    if (!DerivedDataCache::Get().Load(key, data))
+        return false;
+
+    ProfileScope scope("Terrain::LoadMeshCache");
+    DerivedDataReader reader(data);
+    int32_t width = 0, height = 0, chunksX = 0, chunksZ = 0;
+    uint32_t indexCount = 0;
+    reader.Read(width);
+    reader.Read(height);
+    reader.Read(indexCount);
+    reader.Read(chunksX);
+    reader.Read(chunksZ);
+    reader.ReadArray(m_HeightData);
+    reader.ReadArray(m_Vertices);
+    reader.ReadArray(m_Indices);
+    reader.ReadArray(m_Chunks);
+
+    size_t vertexCount = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0);
+    if (!reader.IsComplete() || width < 2 || height < 2 ||
+        m_HeightData.size() != vertexCount || m_Vertices.size() != vertexCount ||
+        indexCount > m_Indices.size() || m_Chunks.size() != static_cast<size_t>(std::max(chunksX, 0)) * std::max(chunksZ, 0) ||
+        !IndicesInRange(m_Indices, vertexCount) || !ChunksInRange(width, height))
+    {
+        m_HeightData.clear();
+        m_Vertices.clear();
+        m_Indices.clear();
+        m_Chunks.clear();
+        return false;
+    }
+
+    m_Width = width;
+    m_Height = height;
+    m_IndexCount = indexCount;
+    m_ChunksX = chunksX;
+    m_ChunksZ = chunksZ;
+    for (LodChunk& chunk : m_Chunks)
+    {
+        chunk.level = 0;
+    }
+    m_LodActive = false;
+    m_DrawnIndexCount = 0;
+    scope.SetElements(static_cast<long long>(vertexCount));
+    PerfCounters::Add(PERF_ASSETS_LOADED);
+    return true;
+}
+
+bool Terrain::ChunksInRange(int width, int height) const
+{
+    for (const LodChunk& chunk : m_Chunks)
+    {
+        if (chunk.x0 < 0 || chunk.z0 < 0 || chunk.cellsX < 1 || chunk.cellsZ < 1 ||
+            chunk.cellsX > width - 1 - chunk.x0 || chunk.cellsZ > height - 1 - chunk.z0)
+            return false;
+
+        for (int level = 0; level < LOD_LEVELS; ++level)
+        {
+            uint64_t end = static_cast<uint64_t>(chunk.indexOffset[level]) + chunk.indexCount[level];
+            if (end > m_Indices.size())
+                return false;
+        }
+    }
+    return true;
+}
+
+void Terrain::StoreMeshCache(const DerivedDataKey& key) const
+{
+    DerivedDataCache& cache = DerivedDataCache::Get();
+    if (!cache.IsOpen())
+        return;
+
+    std::vector<unsigned char> data;
+    DerivedDataWriter writer(data);
+    writer.Write(static_cast<int32_t>(m_Width));
+    writer.Write(static_cast<int32_t>(m_Height));
+    writer.Write(static_cast<uint32_t>(m_IndexCount));
+    writer.Write(static_cast<int32_t>(m_ChunksX));
+    writer.Write(static_cast<int32_t>(m_ChunksZ));
+    writer.WriteArray(m_HeightData);
+    writer.WriteArray(m_Vertices);
+    writer.WriteArray(m_Indices);
+    writer.WriteArray(m_Chunks);
+    cache.Store(key, data);
+}
+
 // ========================================
 // 生成地形顶点
 // ========================================
@@ -207,6 +460,17 @@ void Terrain::GenerateVertices()
     // 顶点数 = 宽度 × 高度
     m_Vertices.resize(m_Width * m_Height);
 
+    // 整张地形就是一个覆盖全部顶点的矩形
+    UpdateVertices({ 0, 0, m_Width - 1, m_Height - 1 });
+}
+
+// ========================================
+// 更新矩形区域内的顶点（包含两端）
+// ========================================
+// 全量生成和局部编辑共用这段代码，保证两者结果完全一致
+// ========================================
+void Terrain::UpdateVertices(const DirtyRect& rect)
+{
     // 计算每个网格单元的实际大小
     // 如果地形大小是100，分辨率是256，则每格大小 = 100/255 ≈ 0.39
     float cellSizeX = m_TerrainSize / (m_Width - 1);
@@ -217,11 +481,13 @@ void Terrain::GenerateVertices()
     float startZ = -m_TerrainSize / 2.0f;
 
     // ========================================
-    // 遍历每个高度图像素，生成对应的3D顶点
+    // 遍历区域内每个高度图像素，生成对应的3D顶点
     // ========================================
-    for (int z = 0; z < m_Height; ++z)          // Z轴（深度方向）
+    // 每行只写自己的顶点，按行分给作业系统并行处理
+    ParallelFor(rect.z1 - rect.z0 + 1, 0, [&](int row)
     {
-        for (int x = 0; x < m_Width; ++x)       // X轴（宽度方向）
+        int z = rect.z0 + row;                      // Z轴（深度方向）
+        for (int x = rect.x0; x <= rect.x1; ++x)    // X轴（宽度方向）
         {
             // 获取当前顶点在数组中的索引
             int vertexIndex = GetVertexIndex(x, z);
@@ -257,7 +523,7 @@ void Terrain::GenerateVertices()
             // 先设置为向上的向量，稍后会重新计算
             m_Vertices[vertexIndex].Normal = Vector3(0.0f, 1.0f, 0.0f);
         }
-    }
+    }, RowGrain(rect.x1 - rect.x0 + 1));
 }
 
 // ========================================
@@ -271,53 +537,302 @@ void Terrain::GenerateVertices()
 //   │  ╲   │        三角形2: [v1, v3, v2]
 //   │    ╲ │
 //   v2 ─── v3
+//
+// 格子按 LOD 块分组：先是每块的全分辨率网格（第 0 级，块按行优先排列，
+// 全部画出来就是整张地形），后面是各块较粗的几级（见 WriteLodIndices）
 // ========================================
 void Terrain::GenerateIndices()
 {
-    // 计算需要的索引数量
-    // (宽度-1) × (高度-1) 个格子
-    // 每个格子 = 2个三角形 = 6个索引
-    int numQuads = (m_Width - 1) * (m_Height - 1);
-    m_Indices.reserve(numQuads * 6);
-
     // ========================================
-    // 遍历每个格子，生成2个三角形
+    // 划分块，算出每块每级在索引数组中的位置
     // ========================================
-    for (int z = 0; z < m_Height - 1; ++z)      // 不包括最后一行
+    m_ChunksX = (m_Width - 2) / LOD_CHUNK_CELLS + 1;
+    m_ChunksZ = (m_Height - 2) / LOD_CHUNK_CELLS + 1;
+    m_Chunks.assign(static_cast<size_t>(m_ChunksX) * m_ChunksZ, LodChunk());
+
+    for (int cz = 0; cz < m_ChunksZ; ++cz)
     {
-        for (int x = 0; x < m_Width - 1; ++x)   // 不包括最后一列
+        for (int cx = 0; cx < m_ChunksX; ++cx)
         {
-            // ========================================
-            // 获取当前格子的4个顶点索引
-            // ========================================
-            //   topLeft ─── topRight
-            //      │           │
-            //   bottomLeft ─ bottomRight
-            // ========================================
-            int topLeft     = GetVertexIndex(x, z);
-            int topRight    = GetVertexIndex(x + 1, z);
-            int bottomLeft  = GetVertexIndex(x, z + 1);
-            int bottomRight = GetVertexIndex(x + 1, z + 1);
+            LodChunk& chunk = m_Chunks[cz * m_ChunksX + cx];
+            chunk.x0 = cx * LOD_CHUNK_CELLS;
+            chunk.z0 = cz * LOD_CHUNK_CELLS;
+            chunk.cellsX = std::min(LOD_CHUNK_CELLS, m_Width - 1 - chunk.x0);
+            chunk.cellsZ = std::min(LOD_CHUNK_CELLS, m_Height - 1 - chunk.z0);
+            chunk.minY = 0.0f;
+            chunk.maxY = 0.0f;
+            chunk.level = 0;
+        }
+    }
 
-            // ========================================
-            // 三角形1（左上三角形）
-            // ========================================
-            // 顶点顺序：逆时针（OpenGL默认正面）
-            m_Indices.push_back(topLeft);
-            m_Indices.push_back(bottomLeft);
-            m_Indices.push_back(topRight);
+    unsigned int offset = 0;
+    for (int level = 0; level < LOD_LEVELS; ++level)
+    {
+        for (LodChunk& chunk : m_Chunks)
+        {
+            // 块太小用不了这一级时沿用上一级的索引
+            if (level > 0 && !IsLodLevelUsable(chunk.cellsX, chunk.cellsZ, level))
+            {
+                chunk.indexOffset[level] = chunk.indexOffset[level - 1];
+                chunk.indexCount[level] = chunk.indexCount[level - 1];
+                continue;
+            }
+            chunk.indexOffset[level] = offset;
+            chunk.indexCount[level] = LodTriangleCount(chunk.cellsX, chunk.cellsZ, level) * 3;
+            offset += chunk.indexCount[level];
+        }
+        if (level == 0)
+        {
+            // 存储第 0 级的索引总数（不分块渲染时用到）
+            m_IndexCount = offset;
+        }
+    }
+    m_Indices.resize(offset);
 
-            // ========================================
-            // 三角形2（右下三角形）
-            // ========================================
-            m_Indices.push_back(topRight);
-            m_Indices.push_back(bottomLeft);
-            m_Indices.push_back(bottomRight);
+    // 每块每级在索引数组中的位置是固定的，按块并行填写
+    ParallelFor(static_cast<int>(m_Chunks.size()), 0, [&](int i)
+    {
+        const LodChunk& chunk = m_Chunks[i];
+        for (int level = 0; level < LOD_LEVELS; ++level)
+        {
+            if (level == 0 || chunk.indexOffset[level] != chunk.indexOffset[level - 1])
+            {
+                WriteLodIndices(chunk, level, &m_Indices[chunk.indexOffset[level]]);
+            }
+        }
+    }, 1);
+
+    m_LodActive = false;
+    m_DrawnIndexCount = 0;
+}
+
+// ========================================
+// 一块的第 level 级网格
+// ========================================
+// 步长 s = 2^level。第 0 级就是逐格两个三角形（与上面的示意图相同）。
+// 其余各级：
+//   ┌─┬─┬─┬─┬─┬─┬─┬─┐   外圈：块的四条边，每格一个顶点（与相邻块的第 0 级一致）
+//   │╲ ╲│ │ │ │ │╱ ╱│   内部：从 (s, s) 到 (边长-s, 边长-s)，每 s 格一个顶点，
+//   ├─ ┌───┬───┐ ─┤       按同样的方式分成两个三角形
+//   │  │   │   │  │   中间的梯形带：沿着边把外圈和内圈的顶点按位置交替连起来
+//   │  ├───┼───┤  │   （“拉链”），四个梯形在对角线上相接
+//   │  │   │   │  │
+//   ├─ └───┴───┘ ─┤
+//   │╱ ╱│ │ │ │ │╲ ╲│
+//   └─┴─┴─┴─┴─┴─┴─┴─┘
+// 所有三角形从上往下看的绕向与第 0 级相同（背面剔除结果一致）
+// ========================================
+bool Terrain::IsLodLevelUsable(int cellsX, int cellsZ, int level)
+{
+    int stride = 1 << level;
+    return level == 0 ||
+           (cellsX % stride == 0 && cellsZ % stride == 0 && cellsX >= 2 * stride && cellsZ >= 2 * stride);
+}
+
+int Terrain::LodTriangleCount(int cellsX, int cellsZ, int level)
+{
+    if (level == 0)
+    {
+        return cellsX * cellsZ * 2;
+    }
+    int stride = 1 << level;
+    int innerX = cellsX / stride - 2;   // 内部网格的格子数
+    int innerZ = cellsZ / stride - 2;
+    // 每条边的拉链：外圈每格一个三角形，内圈每格一个三角形
+    return innerX * innerZ * 2 + 2 * (cellsX + innerX) + 2 * (cellsZ + innerZ);
+}
+
+void Terrain::WriteLodIndices(const LodChunk& chunk, int level, unsigned int* out) const
+{
+    // 按网格坐标添加三角形，需要时交换后两个顶点，让绕向与第 0 级相同
+    // （第 0 级的 [TL, BL, TR] 在 x-z 平面上的叉积为负）
+    auto triangle = [&](int ax, int az, int bx, int bz, int cx, int cz)
+    {
+        int cross = (bx - ax) * (cz - az) - (bz - az) * (cx - ax);
+        *out++ = GetVertexIndex(ax, az);
+        if (cross < 0)
+        {
+            *out++ = GetVertexIndex(bx, bz);
+            *out++ = GetVertexIndex(cx, cz);
+        }
+        else
+        {
+            *out++ = GetVertexIndex(cx, cz);
+            *out++ = GetVertexIndex(bx, bz);
+        }
+    };
+    // 两个三角形的切法与第 0 级相同：[TL, BL, TR] 和 [TR, BL, BR]
+    auto quad = [&](int x, int z, int step)
+    {
+        triangle(x, z, x, z + step, x + step, z);
+        triangle(x + step, z, x, z + step, x + step, z + step);
+    };
+
+    if (level == 0)
+    {
+        for (int z = chunk.z0; z < chunk.z0 + chunk.cellsZ; ++z)
+        {
+            for (int x = chunk.x0; x < chunk.x0 + chunk.cellsX; ++x)
+            {
+                quad(x, z, 1);
+            }
+        }
+        return;
+    }
+
+    int stride = 1 << level;
+    int x1 = chunk.x0 + chunk.cellsX;
+    int z1 = chunk.z0 + chunk.cellsZ;
+
+    // 内部网格
+    for (int z = chunk.z0 + stride; z < z1 - stride; z += stride)
+    {
+        for (int x = chunk.x0 + stride; x < x1 - stride; x += stride)
+        {
+            quad(x, z, stride);
         }
     }
 
-    // 存储索引总数（Render时需要用到）
-    m_IndexCount = static_cast<unsigned int>(m_Indices.size());
+    // 拉链：外圈从 outerStart 到 outerEnd（每格一个顶点），
+    // 内圈从 outerStart + stride 到 outerEnd - stride（每 stride 格一个顶点）；
+    // 每次前进下一个顶点位置更靠前的一边。
+    // vertex(t, inner) 把沿边的位置和内/外圈换成网格坐标
+    auto zipper = [&](int outerStart, int outerEnd, const auto& vertex)
+    {
+        int outer = outerStart;
+        int inner = outerStart + stride;
+        int innerEnd = outerEnd - stride;
+        while (outer < outerEnd || inner < innerEnd)
+        {
+            int ax, az, bx, bz, cx, cz;
+            vertex(outer, false, ax, az);
+            vertex(inner, true, cx, cz);
+            if (inner >= innerEnd || (outer < outerEnd && outer + 1 <= inner + stride))
+            {
+                vertex(outer + 1, false, bx, bz);
+                ++outer;
+            }
+            else
+            {
+                vertex(inner + stride, true, bx, bz);
+                inner += stride;
+            }
+            triangle(ax, az, bx, bz, cx, cz);
+        }
+    };
+
+    zipper(chunk.x0, x1, [&](int t, bool inner, int& x, int& z) { x = t; z = inner ? chunk.z0 + stride : chunk.z0; });
+    zipper(chunk.x0, x1, [&](int t, bool inner, int& x, int& z) { x = t; z = inner ? z1 - stride : z1; });
+    zipper(chunk.z0, z1, [&](int t, bool inner, int& x, int& z) { z = t; x = inner ? chunk.x0 + stride : chunk.x0; });
+    zipper(chunk.z0, z1, [&](int t, bool inner, int& x, int& z) { z = t; x = inner ? x1 - stride : x1; });
+}
+
+// ========================================
+// 块的高度范围和几何误差
+// ========================================
+// 误差用粗网格上的双线性插值近似该级的表面（拉链带里的实际三角形
+// 与此略有出入），取块内所有顶点与它的最大高度差。
+// 块按行优先各自独立，并行计算
+// ========================================
+void Terrain::UpdateChunkErrors(const DirtyRect& rect)
+{
+    if (m_Chunks.empty())
+        return;
+
+    // 与矩形相交的块（块的边界顶点属于两边的块）
+    int cx0 = std::max(0, (rect.x0 - 1) / LOD_CHUNK_CELLS);
+    int cz0 = std::max(0, (rect.z0 - 1) / LOD_CHUNK_CELLS);
+    int cx1 = std::min(m_ChunksX - 1, rect.x1 / LOD_CHUNK_CELLS);
+    int cz1 = std::min(m_ChunksZ - 1, rect.z1 / LOD_CHUNK_CELLS);
+    int columns = cx1 - cx0 + 1;
+
+    ParallelFor(columns * (cz1 - cz0 + 1), 0, [&](int i)
+    {
+        LodChunk& chunk = m_Chunks[(cz0 + i / columns) * m_ChunksX + cx0 + i % columns];
+
+        float minY = GetHeight(chunk.x0, chunk.z0);
+        float maxY = minY;
+        for (int z = chunk.z0; z <= chunk.z0 + chunk.cellsZ; ++z)
+        {
+            for (int x = chunk.x0; x <= chunk.x0 + chunk.cellsX; ++x)
+            {
+                minY = std::min(minY, GetHeight(x, z));
+                maxY = std::max(maxY, GetHeight(x, z));
+            }
+        }
+        chunk.minY = minY * m_HeightScale;
+        chunk.maxY = maxY * m_HeightScale;
+
+        chunk.error[0] = 0.0f;
+        for (int level = 1; level < LOD_LEVELS; ++level)
+        {
+            // 用不了的级别（索引与上一级相同）永远不选；能不能用只随级别往上变差
+            if (!IsLodLevelUsable(chunk.cellsX, chunk.cellsZ, level))
+            {
+                chunk.error[level] = std::numeric_limits<float>::max();
+                continue;
+            }
+            int stride = 1 << level;
+            float error = 0.0f;
+            // 外圈保持全分辨率，只看内部的顶点
+            for (int z = chunk.z0 + 1; z < chunk.z0 + chunk.cellsZ; ++z)
+            {
+                int gz = chunk.z0 + std::min((z - chunk.z0) / stride * stride, chunk.cellsZ - stride);
+                float fz = static_cast<float>(z - gz) / stride;
+                for (int x = chunk.x0 + 1; x < chunk.x0 + chunk.cellsX; ++x)
+                {
+                    int gx = chunk.x0 + std::min((x - chunk.x0) / stride * stride, chunk.cellsX - stride);
+                    float fx = static_cast<float>(x - gx) / stride;
+                    float top = GetHeight(gx, gz) + (GetHeight(gx + stride, gz) - GetHeight(gx, gz)) * fx;
+                    float bottom = GetHeight(gx, gz + stride) +
+                                   (GetHeight(gx + stride, gz + stride) - GetHeight(gx, gz + stride)) * fx;
+                    float approx = top + (bottom - top) * fz;
+                    error = std::max(error, std::abs(GetHeight(x, z) - approx));
+                }
+            }
+            // 粗一级的误差不小于细一级（跳过的顶点只多不少）
+            chunk.error[level] = std::max(error * m_HeightScale, chunk.error[level - 1]);
+        }
+    }, 1);
+}
+
+// ========================================
+// 选择各块的 LOD 级别
+// ========================================
+void Terrain::SelectLod(const Vector3& cameraPosition, float projectionScale, float maxErrorPixels)
+{
+    m_LodActive = false;
+    float cellSizeX = m_TerrainSize / (m_Width - 1);
+    float cellSizeZ = m_TerrainSize / (m_Height - 1);
+    float startX = -m_TerrainSize / 2.0f;
+    float startZ = -m_TerrainSize / 2.0f;
+
+    for (LodChunk& chunk : m_Chunks)
+    {
+        chunk.level = 0;
+        if (maxErrorPixels <= 0.0f)
+            continue;
+
+        // 相机到块包围盒的距离（在包围盒里面时为 0，只能用第 0 级）
+        float minX = startX + chunk.x0 * cellSizeX;
+        float minZ = startZ + chunk.z0 * cellSizeZ;
+        float dx = std::max(std::max(minX - cameraPosition.x, cameraPosition.x - (minX + chunk.cellsX * cellSizeX)), 0.0f);
+        float dy = std::max(std::max(chunk.minY - cameraPosition.y, cameraPosition.y - chunk.maxY), 0.0f);
+        float dz = std::max(std::max(minZ - cameraPosition.z, cameraPosition.z - (minZ + chunk.cellsZ * cellSizeZ)), 0.0f);
+        float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        // 误差随级别单调增加：从最粗一级往回找第一个满足的
+        float allowed = maxErrorPixels * distance / projectionScale;
+        for (int level = LOD_LEVELS - 1; level > 0; --level)
+        {
+            if (chunk.error[level] <= allowed)
+            {
+                chunk.level = level;
+                break;
+            }
+        }
+        m_LodActive = m_LodActive || chunk.level > 0;
+    }
 }
 
 // ========================================
@@ -325,83 +840,102 @@ void Terrain::GenerateIndices()
 // ========================================
 // 工作原理：
 // 1. 对于每个三角形，计算其法向量（使用叉乘）
-// 2. 将三角形法向量累加到其3个顶点上
+// 2. 将周围三角形的法向量累加到顶点上
 // 3. 最后归一化每个顶点的法向量
 //
 // 为什么这样做？
 // - 平滑着色需要每个顶点的法向量
 // - 通过平均周围三角形的法向量，得到平滑效果
+//
+// 实现方式：
+// 每个顶点自己“收集”周围最多6个三角形的法向量（而不是遍历三角形
+// 再“分发”给3个顶点），这样任意矩形区域都可以单独重算，
+// 局部编辑时只需要重算脏区域附近的顶点。
 // ========================================
 void Terrain::CalculateNormals()
 {
-    // ========================================
-    // 步骤1：先将所有法向量清零
-    // ========================================
-    for (auto& vertex : m_Vertices)
-    {
-        vertex.Normal = Vector3(0.0f, 0.0f, 0.0f);
-    }
+    UpdateNormals({ 0, 0, m_Width - 1, m_Height - 1 });
+}
 
-    // ========================================
-    // 步骤2：遍历每个三角形，计算并累加法向量
-    // ========================================
-    // 每3个索引定义一个三角形
-    for (size_t i = 0; i < m_Indices.size(); i += 3)
+void Terrain::UpdateNormals(const DirtyRect& rect)
+{
+    // 法向量只读取位置、只写自己的顶点，各行互不影响
+    ParallelFor(rect.z1 - rect.z0 + 1, 0, [&](int row)
     {
-        // 获取三角形的3个顶点索引
-        unsigned int index0 = m_Indices[i];
-        unsigned int index1 = m_Indices[i + 1];
-        unsigned int index2 = m_Indices[i + 2];
+        int z = rect.z0 + row;
+        for (int x = rect.x0; x <= rect.x1; ++x)
+        {
+            m_Vertices[GetVertexIndex(x, z)].Normal = ComputeVertexNormal(x, z);
+        }
+    }, RowGrain(rect.x1 - rect.x0 + 1));
+}
 
-        // 获取3个顶点的位置
-        Vector3 v0 = m_Vertices[index0].Position;
-        Vector3 v1 = m_Vertices[index1].Position;
-        Vector3 v2 = m_Vertices[index2].Position;
+// ========================================
+// 格子中的两个三角形（与 GenerateIndices 一致）
+// ========================================
+//   TL ─── TR       三角形1: [TL, BL, TR]
+//   │  ╲   │        三角形2: [TR, BL, BR]
+//   │    ╲ │
+//   BL ─── BR
+//
+// 法向量 = Cross(v1 - v0, v2 - v0)，遵循右手定则
+// ========================================
+Vector3 Terrain::TriangleNormal1(int qx, int qz) const
+{
+    const Vector3& v0 = m_Vertices[GetVertexIndex(qx, qz)].Position;      // TL
+    const Vector3& v1 = m_Vertices[GetVertexIndex(qx, qz + 1)].Position;  // BL
+    const Vector3& v2 = m_Vertices[GetVertexIndex(qx + 1, qz)].Position;  // TR
+    return Vector3::Cross(v1 - v0, v2 - v0);
+}
 
-        // ========================================
-        // 计算三角形的两条边向量
-        // ========================================
-        //      v1
-        //      /\
-        //     /  \
-        //    /    \
-        //   v0 ──── v2
-        //
-        // edge1 = v1 - v0（从v0指向v1）
-        // edge2 = v2 - v0（从v0指向v2）
-        // ========================================
-        Vector3 edge1 = v1 - v0;
-        Vector3 edge2 = v2 - v0;
+Vector3 Terrain::TriangleNormal2(int qx, int qz) const
+{
+    const Vector3& v0 = m_Vertices[GetVertexIndex(qx + 1, qz)].Position;      // TR
+    const Vector3& v1 = m_Vertices[GetVertexIndex(qx, qz + 1)].Position;      // BL
+    const Vector3& v2 = m_Vertices[GetVertexIndex(qx + 1, qz + 1)].Position;  // BR
+    return Vector3::Cross(v1 - v0, v2 - v0);
+}
 
-        // ========================================
-        // 使用叉乘计算法向量
-        // ========================================
-        // Cross(edge1, edge2) 得到垂直于三角形平面的向量
-        // 这个向量的方向遵循右手定则
-        // ========================================
-        Vector3 normal = Vector3::Cross(edge1, edge2);
+// ========================================
+// 计算单个顶点的法向量
+// ========================================
+// 顶点(x, z)属于4个格子：
+//   格子(x-1, z-1)：作为BR，只在三角形2中
+//   格子(x,   z-1)：作为BL，在三角形1和2中
+//   格子(x-1, z  )：作为TR，在三角形1和2中
+//   格子(x,   z  )：作为TL，只在三角形1中
+// 按格子的行优先顺序累加，与逐三角形累加的顺序相同
+// ========================================
+Vector3 Terrain::ComputeVertexNormal(int x, int z) const
+{
+    Vector3 normal(0.0f, 0.0f, 0.0f);
 
-        // ========================================
-        // 将法向量累加到3个顶点上
-        // ========================================
-        // 因为一个顶点可能被多个三角形共享
-        // 所以我们累加所有相关三角形的法向量
-        // ========================================
-        m_Vertices[index0].Normal += normal;
-        m_Vertices[index1].Normal += normal;
-        m_Vertices[index2].Normal += normal;
-    }
+    bool hasLeft  = x > 0;
+    bool hasRight = x < m_Width - 1;
+    bool hasUp    = z > 0;
+    bool hasDown  = z < m_Height - 1;
 
-    // ========================================
-    // 步骤3：归一化所有法向量
-    // ========================================
-    // 归一化 = 将向量长度变为1，但保持方向不变
-    // 这对于光照计算很重要
-    // ========================================
-    for (auto& vertex : m_Vertices)
+    if (hasLeft && hasUp)
+    {
+        normal += TriangleNormal2(x - 1, z - 1);
+    }
+    if (hasRight && hasUp)
+    {
+        normal += TriangleNormal1(x, z - 1);
+        normal += TriangleNormal2(x, z - 1);
+    }
+    if (hasLeft && hasDown)
     {
-        vertex.Normal = vertex.Normal.Normalised();
+        normal += TriangleNormal1(x - 1, z);
+        normal += TriangleNormal2(x - 1, z);
     }
+    if (hasRight && hasDown)
+    {
+        normal += TriangleNormal1(x, z);
+    }
+
+    // 归一化 = 将向量长度变为1，但保持方向不变
+    return normal.Normalised();
 }
 
 // ========================================
@@ -452,6 +986,9 @@ void Terrain::SetupMesh()
                  m_Indices.data(),
                  GL_STATIC_DRAW);
 
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+    m_GpuMemory.Set(m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+
     // ========================================
     // 步骤4：配置顶点属性指针
     // ========================================
@@ -509,9 +1046,9 @@ void Terrain::SetupMesh()
     // 解绑后，后续的OpenGL调用不会影响这个VAO的配置
     glBindVertexArray(0);
 
-    std::cout << "  - VAO ID: " << m_VAO << std::endl;
-    std::cout << "  - VBO ID: " << m_VBO << " (存储 " << m_Vertices.size() << " 个顶点)" << std::endl;
-    std::cout << "  - EBO ID: " << m_EBO << " (存储 " << m_Indices.size() << " 个索引)" << std::endl;
+    LOG_INFO("  - VAO ID: " << m_VAO);
+    LOG_INFO("  - VBO ID: " << m_VBO << " (存储 " << m_Vertices.size() << " 个顶点)");
+    LOG_INFO("  - EBO ID: " << m_EBO << " (存储 " << m_Indices.size() << " 个索引)");
 }
 
 // ========================================
@@ -527,7 +1064,7 @@ void Terrain::Render()
     // 安全检查：确保VAO已经创建
     // ========================================
     if (m_VAO == 0) {
-        std::cerr << "错误：地形VAO未初始化，无法渲染！" << std::endl;
+        LOG_ERROR_LIMITED("错误：地形VAO未初始化，无法渲染！");
         return;
     }
 
@@ -544,13 +1081,244 @@ void Terrain::Render()
     //   m_IndexCount - 索引数量
     //   GL_UNSIGNED_INT - 索引类型
     //   0 - 索引数组的偏移量
+    // 所有块都在第 0 级时，第 0 级的索引正好是整张地形，一次画完
     // ========================================
-    glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, 0);
+    if (!m_LodActive)
+    {
+        glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, 0);
+        m_DrawnIndexCount = static_cast<int>(m_IndexCount);
+    }
+    else
+    {
+        // 按块的顺序收集各块选中级别的索引区间，首尾相接的合并
+        m_DrawCounts.clear();
+        m_DrawOffsets.clear();
+        m_DrawnIndexCount = 0;
+        unsigned int rangeStart = 0;
+        unsigned int rangeEnd = 0;
+        for (const LodChunk& chunk : m_Chunks)
+        {
+            unsigned int offset = chunk.indexOffset[chunk.level];
+            if (offset != rangeEnd && rangeEnd > rangeStart)
+            {
+                m_DrawCounts.push_back(static_cast<GLsizei>(rangeEnd - rangeStart));
+                m_DrawOffsets.push_back(reinterpret_cast<const void*>(rangeStart * sizeof(unsigned int)));
+            }
+            if (offset != rangeEnd)
+            {
+                rangeStart = offset;
+            }
+            rangeEnd = offset + chunk.indexCount[chunk.level];
+            m_DrawnIndexCount += chunk.indexCount[chunk.level];
+        }
+        m_DrawCounts.push_back(static_cast<GLsizei>(rangeEnd - rangeStart));
+        m_DrawOffsets.push_back(reinterpret_cast<const void*>(rangeStart * sizeof(unsigned int)));
+
+        glMultiDrawElements(GL_TRIANGLES, m_DrawCounts.data(), GL_UNSIGNED_INT,
+                            m_DrawOffsets.data(), static_cast<GLsizei>(m_DrawCounts.size()));
+    }
+    // 多重绘制只算一次调用
+    PerfCounters::Add(PERF_DRAW_CALLS);
+    PerfCounters::Add(PERF_TRIANGLES, m_DrawnIndexCount / 3);
 
     // 解绑VAO（良好习惯）
     glBindVertexArray(0);
 }
 
+// ========================================
+// 重建网格（高度数据被修改后调用）
+// ========================================
+// 工作原理：
+// 1. 重新生成顶点位置（网格大小不变）
+// 2. 重新计算法向量
+// 3. 用 glBufferSubData 覆盖VBO内容（不重新分配显存）
+// ========================================
+void Terrain::RebuildMesh()
+{
+    if (m_VBO == 0)
+        return;
+
+    // 顶点副本已释放时 GenerateVertices 会重新分配
+    GenerateVertices();
+    CalculateNormals();
+    UploadVertices({ 0, 0, m_Width - 1, m_Height - 1 });
+
+    UpdateChunkErrors({ 0, 0, m_Width - 1, m_Height - 1 });
+
+    // 全量重建后，之前标记的脏区域也已经是最新的
+    m_DirtyRects.clear();
+
+    if (!m_KeepCpuCopies)
+        std::vector<Vertex>().swap(m_Vertices);
+    UpdateMemoryStats();
+}
+
+// ========================================
+// 释放顶点/索引的CPU副本
+// ========================================
+// 索引数量和各块各级的区间已经记下，渲染不需要索引数组
+// ========================================
+void Terrain::ReleaseCpuCopies()
+{
+    if (m_VBO == 0)
+        return;
+
+    m_KeepCpuCopies = false;
+    std::vector<Vertex>().swap(m_Vertices);
+    std::vector<unsigned int>().swap(m_Indices);
+    UpdateMemoryStats();
+}
+
+void Terrain::UpdateMemoryStats()
+{
+    m_CpuMemory.Set(VectorBytes(m_Vertices) + VectorBytes(m_Indices) + VectorBytes(m_HeightData));
+}
+
+// ========================================
+// 标记脏区域
+// ========================================
+// 新区域与已有区域重叠或相邻时合并成一个包围矩形，
+// 合并后可能又碰到别的区域，所以循环直到没有可合并的
+// ========================================
+void Terrain::MarkDirty(int x0, int z0, int x1, int z1)
+{
+    if (x0 > x1) std::swap(x0, x1);
+    if (z0 > z1) std::swap(z0, z1);
+
+    DirtyRect rect;
+    rect.x0 = std::max(0, x0);
+    rect.z0 = std::max(0, z0);
+    rect.x1 = std::min(m_Width - 1, x1);
+    rect.z1 = std::min(m_Height - 1, z1);
+    if (rect.x0 > rect.x1 || rect.z0 > rect.z1)
+        return;
+
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < m_DirtyRects.size(); ++i)
+        {
+            const DirtyRect& r = m_DirtyRects[i];
+            if (r.x0 <= rect.x1 + 1 && rect.x0 <= r.x1 + 1 &&
+                r.z0 <= rect.z1 + 1 && rect.z0 <= r.z1 + 1)
+            {
+                rect.x0 = std::min(rect.x0, r.x0);
+                rect.z0 = std::min(rect.z0, r.z0);
+                rect.x1 = std::max(rect.x1, r.x1);
+                rect.z1 = std::max(rect.z1, r.z1);
+                m_DirtyRects.erase(m_DirtyRects.begin() + i);
+                merged = true;
+                break;
+            }
+        }
+    }
+    m_DirtyRects.push_back(rect);
+}
+
+// ========================================
+// 所有脏区域的包围矩形
+// ========================================
+bool Terrain::GetDirtyBounds(int& x0, int& z0, int& x1, int& z1) const
+{
+    if (m_DirtyRects.empty())
+        return false;
+
+    x0 = m_DirtyRects[0].x0;
+    z0 = m_DirtyRects[0].z0;
+    x1 = m_DirtyRects[0].x1;
+    z1 = m_DirtyRects[0].z1;
+    for (const DirtyRect& rect : m_DirtyRects)
+    {
+        x0 = std::min(x0, rect.x0);
+        z0 = std::min(z0, rect.z0);
+        x1 = std::max(x1, rect.x1);
+        z1 = std::max(z1, rect.z1);
+    }
+    return true;
+}
+
+// ========================================
+// 只重建脏区域
+// ========================================
+// 工作原理：
+// 1. 高度改变的顶点 → 重新计算位置
+// 2. 法向量依赖上下左右的顶点 → 外扩一格重新计算
+// 3. 只上传外扩后的区域
+// 注意：先更新所有区域的位置，再计算法向量，
+//       这样两个区域相距一格时，边界法向量也能用到最新位置
+// ========================================
+void Terrain::UpdateDirtyRegions()
+{
+    if (m_DirtyRects.empty() || m_VBO == 0)
+        return;
+
+    // 没有顶点副本时无法只更新局部，整体重建
+    if (!m_KeepCpuCopies)
+    {
+        RebuildMesh();
+        return;
+    }
+
+    for (const DirtyRect& rect : m_DirtyRects)
+    {
+        UpdateVertices(rect);
+    }
+
+    for (const DirtyRect& rect : m_DirtyRects)
+    {
+        DirtyRect border;
+        border.x0 = std::max(0, rect.x0 - 1);
+        border.z0 = std::max(0, rect.z0 - 1);
+        border.x1 = std::min(m_Width - 1, rect.x1 + 1);
+        border.z1 = std::min(m_Height - 1, rect.z1 + 1);
+
+        UpdateNormals(border);
+        UploadVertices(border);
+        UpdateChunkErrors(rect);
+    }
+
+    m_DirtyRects.clear();
+}
+
+// ========================================
+// 上传矩形区域内的顶点
+// ========================================
+// 顶点按行存储：
+// - 区域横跨整行时，所有行在VBO中是连续的，一次上传
+// - 否则每行一段，逐行调用 glBufferSubData
+// ========================================
+void Terrain::UploadVertices(const DirtyRect& rect)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+
+    if (rect.x0 == 0 && rect.x1 == m_Width - 1)
+    {
+        int first = GetVertexIndex(0, rect.z0);
+        int count = (rect.z1 - rect.z0 + 1) * m_Width;
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        first * sizeof(Vertex),
+                        count * sizeof(Vertex),
+                        &m_Vertices[first]);
+        PerfCounters::Add(PERF_BYTES_UPLOADED, count * sizeof(Vertex));
+    }
+    else
+    {
+        int count = rect.x1 - rect.x0 + 1;
+        for (int z = rect.z0; z <= rect.z1; ++z)
+        {
+            int first = GetVertexIndex(rect.x0, z);
+            glBufferSubData(GL_ARRAY_BUFFER,
+                            first * sizeof(Vertex),
+                            count * sizeof(Vertex),
+                            &m_Vertices[first]);
+        }
+        PerfCounters::Add(PERF_BYTES_UPLOADED, (rect.z1 - rect.z0 + 1) * count * sizeof(Vertex));
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 // ========================================
 // 辅助函数：获取指定网格位置的高度
 // ========================================
@@ -574,6 +1342,19 @@ int Terrain::GetVertexIndex(int x, int z) const
     return z * m_Width + x;
 }
 
+// ========================================
+// 世界坐标 → 网格坐标
+// ========================================
+float Terrain::WorldToGridX(float worldX) const
+{
+    return (worldX + m_TerrainSize / 2.0f) / m_TerrainSize * (m_Width - 1);
+}
+
+float Terrain::WorldToGridZ(float worldZ) const
+{
+    return (worldZ + m_TerrainSize / 2.0f) / m_TerrainSize * (m_Height - 1);
+}
+
 // ========================================
 // 获取世界坐标位置的地形高度
 // ========================================
@@ -4,9 +4,13 @@
 #include <glad/glad.h>
 #include "nclgl/Vector2.h"
 #include "nclgl/Vector3.h"
+#include "nclgl/MemoryTracker.h"
+#include "TerrainNoise.h"
 #include <string>
 #include <vector>
 
+class DerivedDataKey;
+
 // ========================================
 // 地形类 - 从高度图生成3D地形
 // ========================================
@@ -14,7 +18,9 @@
 // 1. 加载高度图图像（灰度图）
 // 2. 根据像素亮度生成地形网格
 // 3. 计算法向量（用于光照）
-// 4. 渲染地形
+// 4. 渲染地形（分块 LOD，见 SelectLod）
+// 5. 从高度图生成的网格存进派生数据缓存（DerivedDataCache 打开时），
+//    高度图文件和参数不变时下次直接读取，跳过1-3
 // ========================================
 
 class Terrain
@@ -32,6 +38,23 @@ public:
             float terrainSize = 100.0f,
             float heightScale = 10.0f);
 
+    // ========================================
+    // 构造函数 - 程序化生成
+    // ========================================
+    // 参数：
+    //   noise       - 噪声生成器（种子/种子纹理已设置好）
+    //   settings    - fBm/山脊/域扭曲参数
+    //   resolution  - 高度图分辨率（每边采样数）
+    //   threadCount - 生成高度时的线程数（0 = 全部硬件线程）
+    // 高度直接写入 m_HeightData，之后的流程与加载高度图相同
+    // ========================================
+    Terrain(const TerrainNoise& noise,
+            const TerrainNoise::Settings& settings,
+            int resolution,
+            float terrainSize = 100.0f,
+            float heightScale = 10.0f,
+            unsigned int threadCount = 0);
+
     // ========================================
     // 析构函数 - 清理OpenGL资源
     // ========================================
@@ -41,9 +64,33 @@ public:
     // 渲染地形
     // ========================================
     // 注意：调用前必须先激活着色器并设置uniform变量
+    // 按最近一次 SelectLod 选出的级别绘制各块
     // ========================================
     void Render();
 
+    // ========================================
+    // 分块 LOD
+    // ========================================
+    // 地形按 LOD_CHUNK_CELLS × LOD_CHUNK_CELLS 格分块，每块有 LOD_LEVELS 级网格：
+    // 第 k 级内部每 2^k 格取一个顶点，边上一圈保持全分辨率，
+    // 和内部之间用三角形缝起来，所以相邻两块级别不同也不会有裂缝。
+    // 全部索引在构建时一次生成（同一个EBO），换级别不需要上传任何东西。
+    //
+    // 每块每级记录几何误差：跳过的顶点的实际高度与粗网格插值的最大差（世界单位），
+    // 高度改变时（RebuildMesh / UpdateDirtyRegions）重算。
+    // SelectLod 给每块选误差投影到屏幕上不超过 maxErrorPixels 的最粗一级：
+    //   屏幕误差 ≈ 误差 × projectionScale / 相机到这一块包围盒的距离
+    //   projectionScale = 视口高度（像素）/ (2 × tan(垂直视野 / 2))
+    // 没调用过 SelectLod（或 maxErrorPixels <= 0）时全部用第 0 级，与不分块时相同
+    // ========================================
+    static const int LOD_CHUNK_CELLS = 32;
+    static const int LOD_LEVELS = 4;
+
+    void SelectLod(const Vector3& cameraPosition, float projectionScale, float maxErrorPixels);
+
+    // 上一次 Render 绘制的三角形数
+    int GetDrawnTriangleCount() const { return m_DrawnIndexCount / 3; }
+
     // ========================================
     // 获取地形宽度和深度（网格分辨率）
     // ========================================
@@ -60,6 +107,57 @@ public:
     // ========================================
     float GetHeightAt(float worldX, float worldZ) const;
 
+    // ========================================
+    // 高度数据访问（侵蚀、编辑等直接修改高度）
+    // ========================================
+    // 数据为 0.0 - 1.0，行主序，m_Width × m_Height
+    // 修改后需要调用 RebuildMesh()（或 MarkDirty + UpdateDirtyRegions）
+    // 才会反映到顶点和法向量
+    // ========================================
+    std::vector<float>& GetHeightData() { return m_HeightData; }
+    const std::vector<float>& GetHeightData() const { return m_HeightData; }
+
+    float GetTerrainSize() const { return m_TerrainSize; }
+    float GetHeightScale() const { return m_HeightScale; }
+
+    // ========================================
+    // 根据当前高度数据重建顶点位置和法向量，并重新上传VBO
+    // ========================================
+    // 索引（拓扑）不变，只更新顶点缓冲
+    // ========================================
+    void RebuildMesh();
+
+    // ========================================
+    // 局部更新（地形编辑用）
+    // ========================================
+    // MarkDirty：标记被修改过高度的矩形区域（网格坐标，包含两端）
+    //            重叠或相邻的区域会自动合并
+    // UpdateDirtyRegions：只重建脏区域内的顶点、外扩一格的法向量，
+    //            并用 glBufferSubData 只上传这些顶点
+    // 结果与 RebuildMesh() 全量重建逐位相同
+    // ========================================
+    void MarkDirty(int x0, int z0, int x1, int z1);
+    void UpdateDirtyRegions();
+    bool HasDirtyRegions() const { return !m_DirtyRects.empty(); }
+
+    // 所有脏区域的包围矩形（没有脏区域时返回 false）
+    // 需要在 UpdateDirtyRegions() 之前调用，例如用于同步更新烘焙贴图
+    bool GetDirtyBounds(int& x0, int& z0, int& x1, int& z1) const;
+
+    // 世界坐标 → 网格坐标（浮点，可能超出范围）
+    float WorldToGridX(float worldX) const;
+    float WorldToGridZ(float worldZ) const;
+
+    // ========================================
+    // 释放顶点/索引的CPU副本（上传到GPU后就不再需要）
+    // ========================================
+    // 高度数据保留（拾取、侵蚀、浅水都要用）。之后修改高度时
+    // 临时重新生成全部顶点并整体上传，然后再次释放，
+    // 所以编辑会变慢，适合只看不改的场景
+    // ========================================
+    void ReleaseCpuCopies();
+    bool HasCpuCopies() const { return m_KeepCpuCopies; }
+
 private:
     // ========================================
     // 顶点结构体 - 定义每个顶点的数据
@@ -92,15 +190,68 @@ private:
     int m_Height;              // 高度图高度（像素）
     float m_TerrainSize;       // 地形实际大小（世界坐标）
     float m_HeightScale;       // 高度缩放系数
-    unsigned int m_IndexCount; // 总索引数量（用于渲染时的drawElements）
+    unsigned int m_IndexCount; // 第 0 级（全分辨率）的索引数量，位于索引数组开头
+
+    // ========================================
+    // 脏区域（网格坐标，包含两端）
+    // ========================================
+    struct DirtyRect
+    {
+        int x0, z0, x1, z1;
+    };
+    std::vector<DirtyRect> m_DirtyRects;
+
+    // ========================================
+    // LOD 分块
+    // ========================================
+    // 索引数组按级别排列：先是所有块的第 0 级，再是所有块的第 1 级……
+    // 同一级里按块的行优先顺序，所以相邻两块选了同一级时索引是连续的，合并成一个绘制区间
+    // ========================================
+    struct LodChunk
+    {
+        int x0, z0;                             // 左上角（网格坐标）
+        int cellsX, cellsZ;                     // 格子数（最后一行/列的块可能小一些）
+        float minY, maxY;                       // 高度范围（世界坐标）
+        float error[LOD_LEVELS];                // 各级的几何误差（世界单位）
+        unsigned int indexOffset[LOD_LEVELS];   // 各级在索引数组中的位置
+        unsigned int indexCount[LOD_LEVELS];
+        int level;                              // SelectLod 选中的级别
+    };
+    std::vector<LodChunk> m_Chunks;
+    int m_ChunksX;
+    int m_ChunksZ;
+    bool m_LodActive;                           // 有块不在第 0 级
+    std::vector<GLsizei> m_DrawCounts;
+    std::vector<const void*> m_DrawOffsets;
+    int m_DrawnIndexCount;
+
+    // ========================================
+    // 内存统计
+    // ========================================
+    bool m_KeepCpuCopies;          // false：上传后释放顶点/索引
+    TrackedMemory m_CpuMemory;     // 顶点 + 索引 + 高度数据
+    TrackedMemory m_GpuMemory;     // VBO + EBO
 
     // ========================================
     // 私有函数 - 地形生成流程
     // ========================================
 
+    // 从 m_HeightData 生成网格并上传GPU（步骤2-5）
+    void BuildMesh();
+
+    // 把顶点和索引上传GPU（步骤5），更新内存统计
+    void UploadMesh();
+
+    // 派生数据缓存：高度、顶点、索引和 LOD 分块（key 包含高度图文件的内容和参数）
+    bool LoadMeshCache(const DerivedDataKey& key);
+    void StoreMeshCache(const DerivedDataKey& key) const;
+    // 读出来的 LOD 分块都在 width × height 的网格里，各级索引区间都在 m_Indices 里
+    bool ChunksInRange(int width, int height) const;
+
     // 1. 加载高度图图像
-    // 使用STB_image读取图像，提取每个像素的亮度值
-    bool LoadHeightmap(const std::string& path);
+    // 使用STB_image读取图像，提取每个像素的亮度值。
+    // contents 是已经读进内存的文件内容（算缓存 key 时读的），有就直接解码，不再读文件
+    bool LoadHeightmap(const std::string& path, const std::vector<unsigned char>* contents = nullptr);
 
     // 2. 生成网格顶点
     // 为每个高度图像素创建一个3D顶点
@@ -127,6 +278,37 @@ private:
 
     // 获取指定网格坐标的顶点索引
     int GetVertexIndex(int x, int z) const;
+
+    // 更新矩形区域内的顶点位置和纹理坐标
+    void UpdateVertices(const DirtyRect& rect);
+
+    // 计算矩形区域内的顶点法向量
+    void UpdateNormals(const DirtyRect& rect);
+
+    // 计算单个顶点的法向量（周围三角形法向量之和，归一化）
+    Vector3 ComputeVertexNormal(int x, int z) const;
+
+    // 计算格子(qx, qz)中两个三角形的面法向量（未归一化）
+    Vector3 TriangleNormal1(int qx, int qz) const;
+    Vector3 TriangleNormal2(int qx, int qz) const;
+
+    // 上传矩形区域内的顶点到VBO
+    void UploadVertices(const DirtyRect& rect);
+
+    // 重算与矩形区域相交的块的高度范围和各级几何误差
+    void UpdateChunkErrors(const DirtyRect& rect);
+
+    // 块的第 level 级网格是否可用（格子数能被步长整除，内部至少剩一个顶点）
+    static bool IsLodLevelUsable(int cellsX, int cellsZ, int level);
+
+    // 一块第 level 级的三角形数（必须可用）
+    static int LodTriangleCount(int cellsX, int cellsZ, int level);
+
+    // 把一块第 level 级的索引写到 out（LodTriangleCount × 3 个）
+    void WriteLodIndices(const LodChunk& chunk, int level, unsigned int* out) const;
+
+    // 按当前各数组的大小更新内存统计
+    void UpdateMemoryStats();
 };
 
 #endif // TERRAIN_H
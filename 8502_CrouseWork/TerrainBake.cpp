@@ -0,0 +1,431 @@
+#include "TerrainBake.h"
+#include "Terrain.h"
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // 烘焙结果改变时加 1，旧的缓存项就不会再被找到
+    const unsigned int BAKE_VERSION = 1;
+
+    const float TWO_PI = 6.28318530718f;
+
+    unsigned char ToByte(float v)
+    {
+        v = std::min(std::max(v, 0.0f), 1.0f);
+        return static_cast<unsigned char>(v * 255.0f + 0.5f);
+    }
+}
+
+TerrainBake::TerrainBake(const Settings& settings, unsigned int threadCount)
+    : m_Settings(settings)
+    , m_ThreadCount(threadCount)
+    , m_Resolution(0)
+    , m_NormalTexture(0)
+    , m_AOTexture(0)
+    , m_CpuMemory(MEMORY_TERRAIN, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_TERRAIN, MEMORY_GPU_TEXTURE)
+{
+    m_HorizonTextures[0] = 0;
+    m_HorizonTextures[1] = 0;
+}
+
+TerrainBake::~TerrainBake()
+{
+    if (m_NormalTexture != 0)
+        glDeleteTextures(1, &m_NormalTexture);
+    if (m_HorizonTextures[0] != 0)
+        glDeleteTextures(2, m_HorizonTextures);
+    if (m_AOTexture != 0)
+        glDeleteTextures(1, &m_AOTexture);
+}
+
+// ========================================
+// 读取缓存或重新烘焙
+// ========================================
+bool TerrainBake::LoadOrBake(const Terrain& terrain)
+{
+    DerivedDataKey key = ComputeKey(terrain);
+
+    if (LoadCache(key))
+    {
+        LOG_INFO("✓ 地形烘焙贴图从派生数据缓存读取");
+        return true;
+    }
+
+    Bake(terrain);
+
+    // 缓存没有打开时不保存；写入失败由 DerivedDataCache 报错
+    SaveCache(key);
+    return false;
+}
+
+// ========================================
+// 烘焙全部贴图
+// ========================================
+void TerrainBake::Bake(const Terrain& terrain)
+{
+    Source src = MakeSource(terrain);
+    if (src.width < 2 || src.height < 2)
+    {
+        LOG_ERROR("错误：地形高度数据为空，无法烘焙");
+        return;
+    }
+
+    int resolution = m_Settings.resolution > 1 ? m_Settings.resolution : src.width;
+    Allocate(resolution);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ParallelFor(m_Resolution, m_ThreadCount, [&](int row) {
+        BakeNormalRow(src, row, 0, m_Resolution - 1);
+        BakeHorizonRow(src, row, 0, m_Resolution - 1);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    LOG_INFO("✓ 地形烘焙完成: " << m_Resolution << "×" << m_Resolution
+             << "（" << std::chrono::duration<double, std::milli>(end - start).count()
+             << " ms）");
+
+    if (IsUploaded())
+    {
+        UploadRegion(0, 0, m_Resolution - 1, m_Resolution - 1, true);
+    }
+}
+
+// ========================================
+// 局部重新烘焙
+// ========================================
+// 法线只依赖相邻一格，地平线/AO 依赖 horizonDistance 范围内的高度，
+// 所以受影响的贴图区域要按需要外扩
+// ========================================
+void TerrainBake::BakeRegion(const Terrain& terrain, int x0, int z0, int x1, int z1, bool includeHorizon)
+{
+    if (m_Resolution < 2)
+        return;
+
+    Source src = MakeSource(terrain);
+    if (src.width < 2 || src.height < 2)
+        return;
+
+    float margin = includeHorizon ? m_Settings.horizonDistance + 1.0f : 1.0f;
+
+    // 网格坐标 → 贴图像素坐标
+    float scaleX = static_cast<float>(m_Resolution - 1) / (src.width - 1);
+    float scaleZ = static_cast<float>(m_Resolution - 1) / (src.height - 1);
+    int tx0 = std::max(0, static_cast<int>(std::floor((x0 - margin) * scaleX)));
+    int tz0 = std::max(0, static_cast<int>(std::floor((z0 - margin) * scaleZ)));
+    int tx1 = std::min(m_Resolution - 1, static_cast<int>(std::ceil((x1 + margin) * scaleX)));
+    int tz1 = std::min(m_Resolution - 1, static_cast<int>(std::ceil((z1 + margin) * scaleZ)));
+    if (tx0 > tx1 || tz0 > tz1)
+        return;
+
+    ParallelFor(tz1 - tz0 + 1, m_ThreadCount, [&](int i) {
+        BakeNormalRow(src, tz0 + i, tx0, tx1);
+        if (includeHorizon)
+            BakeHorizonRow(src, tz0 + i, tx0, tx1);
+    });
+
+    if (IsUploaded())
+    {
+        UploadRegion(tx0, tz0, tx1, tz1, includeHorizon);
+    }
+}
+
+TerrainBake::Source TerrainBake::MakeSource(const Terrain& terrain) const
+{
+    Source src;
+    src.heights = terrain.GetHeightData().data();
+    src.width = terrain.GetWidth();
+    src.height = terrain.GetHeight();
+    src.verticalScale = 0.0f;
+    if (src.width > 1)
+    {
+        float cellSize = terrain.GetTerrainSize() / (src.width - 1);
+        src.verticalScale = terrain.GetHeightScale() / cellSize;
+    }
+    return src;
+}
+
+void TerrainBake::Allocate(int resolution)
+{
+    m_Resolution = resolution;
+    size_t texels = static_cast<size_t>(resolution) * resolution;
+    m_NormalMap.assign(texels * 3, 0);
+    m_HorizonMaps[0].assign(texels * 4, 0);
+    m_HorizonMaps[1].assign(texels * 4, 0);
+    m_AOMap.assign(texels, 255);
+
+    m_CpuMemory.Set(VectorBytes(m_NormalMap) + VectorBytes(m_HorizonMaps[0]) +
+                    VectorBytes(m_HorizonMaps[1]) + VectorBytes(m_AOMap));
+}
+
+float TerrainBake::TexelToGrid(int texel, int gridSize) const
+{
+    return static_cast<float>(texel) * (gridSize - 1) / (m_Resolution - 1);
+}
+
+// ========================================
+// 双线性采样高度（格子单位），坐标超出范围时取边界
+// ========================================
+static float SampleHeight(const float* heights, int width, int height, float verticalScale, float gx, float gz)
+{
+    gx = std::min(std::max(gx, 0.0f), static_cast<float>(width - 1));
+    gz = std::min(std::max(gz, 0.0f), static_cast<float>(height - 1));
+
+    int x0 = std::min(static_cast<int>(gx), width - 2);
+    int z0 = std::min(static_cast<int>(gz), height - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+
+    const float* row0 = heights + z0 * width + x0;
+    const float* row1 = row0 + width;
+    float h0 = row0[0] + (row0[1] - row0[0]) * fx;
+    float h1 = row1[0] + (row1[1] - row1[0]) * fx;
+    return (h0 + (h1 - h0) * fz) * verticalScale;
+}
+
+// ========================================
+// 法线贴图：中心差分
+// ========================================
+void TerrainBake::BakeNormalRow(const Source& src, int row, int tx0, int tx1)
+{
+    float stepX = static_cast<float>(src.width - 1) / (m_Resolution - 1);
+    float stepZ = static_cast<float>(src.height - 1) / (m_Resolution - 1);
+    float gz = TexelToGrid(row, src.height);
+
+    for (int tx = tx0; tx <= tx1; ++tx)
+    {
+        float gx = TexelToGrid(tx, src.width);
+
+        float hL = SampleHeight(src.heights, src.width, src.height, src.verticalScale, gx - stepX, gz);
+        float hR = SampleHeight(src.heights, src.width, src.height, src.verticalScale, gx + stepX, gz);
+        float hU = SampleHeight(src.heights, src.width, src.height, src.verticalScale, gx, gz - stepZ);
+        float hD = SampleHeight(src.heights, src.width, src.height, src.verticalScale, gx, gz + stepZ);
+
+        // 法向量 = normalize(-dh/dx, 1, -dh/dz)
+        float nx = -(hR - hL) / (2.0f * stepX);
+        float nz = -(hD - hU) / (2.0f * stepZ);
+        float invLength = 1.0f / std::sqrt(nx * nx + 1.0f + nz * nz);
+
+        unsigned char* out = &m_NormalMap[(static_cast<size_t>(row) * m_Resolution + tx) * 3];
+        out[0] = ToByte(nx * invLength * 0.5f + 0.5f);
+        out[1] = ToByte(invLength * 0.5f + 0.5f);
+        out[2] = ToByte(nz * invLength * 0.5f + 0.5f);
+    }
+}
+
+// ========================================
+// 地平线贴图 + AO
+// ========================================
+// 每个方位沿直线向外采样，采样距离按几何级数增长（近处密、远处疏），
+// 记录最大的仰角正切 tan = Δh / 距离，存 sin(仰角)
+//
+// AO：余弦加权下，某方位仰角 θ 以上可见的比例为 1 - sin²θ，
+//     对所有方位取平均
+// ========================================
+void TerrainBake::BakeHorizonRow(const Source& src, int row, int tx0, int tx1)
+{
+    float texelStep = static_cast<float>(src.width - 1) / (m_Resolution - 1);
+    float firstStep = std::max(texelStep, 0.5f);
+    float maxDistance = std::max(m_Settings.horizonDistance, firstStep);
+    int steps = std::max(m_Settings.horizonSteps, 2);
+    float growth = std::pow(maxDistance / firstStep, 1.0f / (steps - 1));
+
+    float dirX[HORIZON_DIRECTIONS];
+    float dirZ[HORIZON_DIRECTIONS];
+    for (int k = 0; k < HORIZON_DIRECTIONS; ++k)
+    {
+        float angle = TWO_PI * k / HORIZON_DIRECTIONS;
+        dirX[k] = std::cos(angle);
+        dirZ[k] = std::sin(angle);
+    }
+
+    float maxX = static_cast<float>(src.width - 1);
+    float maxZ = static_cast<float>(src.height - 1);
+    float gz = TexelToGrid(row, src.height);
+
+    for (int tx = tx0; tx <= tx1; ++tx)
+    {
+        float gx = TexelToGrid(tx, src.width);
+        float h = SampleHeight(src.heights, src.width, src.height, src.verticalScale, gx, gz);
+
+        size_t texel = static_cast<size_t>(row) * m_Resolution + tx;
+        float occlusion = 0.0f;
+
+        for (int k = 0; k < HORIZON_DIRECTIONS; ++k)
+        {
+            float maxSlope = 0.0f;
+            float t = firstStep;
+            for (int s = 0; s < steps; ++s, t *= growth)
+            {
+                float sx = gx + dirX[k] * t;
+                float sz = gz + dirZ[k] * t;
+                if (sx < 0.0f || sx > maxX || sz < 0.0f || sz > maxZ)
+                    break;
+
+                float slope = (SampleHeight(src.heights, src.width, src.height, src.verticalScale, sx, sz) - h) / t;
+                maxSlope = std::max(maxSlope, slope);
+            }
+
+            float sinAngle = maxSlope / std::sqrt(1.0f + maxSlope * maxSlope);
+            m_HorizonMaps[k / 4][texel * 4 + (k % 4)] = ToByte(sinAngle);
+            occlusion += sinAngle * sinAngle;
+        }
+
+        m_AOMap[texel] = ToByte(1.0f - occlusion / HORIZON_DIRECTIONS);
+    }
+}
+
+// ========================================
+// 上传纹理
+// ========================================
+void TerrainBake::UploadTextures()
+{
+    if (m_Resolution < 2)
+    {
+        LOG_ERROR("错误：地形烘焙贴图尚未生成，无法上传");
+        return;
+    }
+
+    if (m_NormalTexture == 0)
+    {
+        glGenTextures(1, &m_NormalTexture);
+        glGenTextures(2, m_HorizonTextures);
+        glGenTextures(1, &m_AOTexture);
+    }
+
+    struct Target { GLuint id; GLint internalFormat; GLenum format; const unsigned char* data; };
+    Target targets[4] = {
+        { m_NormalTexture,      GL_RGB8,  GL_RGB,  m_NormalMap.data() },
+        { m_HorizonTextures[0], GL_RGBA8, GL_RGBA, m_HorizonMaps[0].data() },
+        { m_HorizonTextures[1], GL_RGBA8, GL_RGBA, m_HorizonMaps[1].data() },
+        { m_AOTexture,          GL_R8,    GL_RED,  m_AOMap.data() }
+    };
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const Target& target : targets)
+    {
+        glBindTexture(GL_TEXTURE_2D, target.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, target.internalFormat, m_Resolution, m_Resolution, 0,
+                     target.format, GL_UNSIGNED_BYTE, target.data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 法线 RGB8 + 两张地平线 RGBA8 + AO R8，都带完整 mipmap
+    m_GpuMemory.Set(MemoryTracker::TextureBytes(m_Resolution, m_Resolution, 1, 3 + 4 + 4 + 1, true));
+    PerfCounters::Add(PERF_BYTES_UPLOADED, static_cast<long long>(m_Resolution) * m_Resolution * (3 + 4 + 4 + 1));
+}
+
+void TerrainBake::UploadRegion(int tx0, int tz0, int tx1, int tz1, bool includeHorizon)
+{
+    struct Target { GLuint id; GLenum format; int channels; const unsigned char* data; };
+    Target targets[4] = {
+        { m_NormalTexture,      GL_RGB,  3, m_NormalMap.data() },
+        { m_AOTexture,          GL_RED,  1, m_AOMap.data() },
+        { m_HorizonTextures[0], GL_RGBA, 4, m_HorizonMaps[0].data() },
+        { m_HorizonTextures[1], GL_RGBA, 4, m_HorizonMaps[1].data() }
+    };
+    int count = includeHorizon ? 4 : 1;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_Resolution);
+    for (int i = 0; i < count; ++i)
+    {
+        const Target& target = targets[i];
+        const unsigned char* first = target.data +
+            (static_cast<size_t>(tz0) * m_Resolution + tx0) * target.channels;
+
+        glBindTexture(GL_TEXTURE_2D, target.id);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, tx0, tz0, tx1 - tx0 + 1, tz1 - tz0 + 1,
+                        target.format, GL_UNSIGNED_BYTE, first);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        PerfCounters::Add(PERF_BYTES_UPLOADED,
+                          static_cast<long long>(tx1 - tx0 + 1) * (tz1 - tz0 + 1) * target.channels);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TerrainBake::BindTextures(unsigned int firstUnit) const
+{
+    GLuint ids[4] = { m_NormalTexture, m_HorizonTextures[0], m_HorizonTextures[1], m_AOTexture };
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_2D, ids[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    PerfCounters::Add(PERF_TEXTURE_BINDS, 4);
+}
+
+// ========================================
+// 缓存（派生数据缓存）
+// ========================================
+// 键：烘焙代码的版本、地形尺寸和缩放、烘焙参数、全部高度数据
+// 内容：分辨率(int32) | 法线 | 地平线0 | 地平线1 | AO
+// ========================================
+DerivedDataKey TerrainBake::ComputeKey(const Terrain& terrain) const
+{
+    DerivedDataKey key("terrain_bake", BAKE_VERSION);
+    key.Add(terrain.GetWidth());
+    key.Add(terrain.GetHeight());
+    key.Add(terrain.GetTerrainSize());
+    key.Add(terrain.GetHeightScale());
+    key.Add(m_Settings.resolution);
+    key.Add(m_Settings.horizonSteps);
+    key.Add(m_Settings.horizonDistance);
+
+    const std::vector<float>& heights = terrain.GetHeightData();
+    key.AddBytes(heights.data(), heights.size() * sizeof(float));
+    return key;
+}
+
+bool TerrainBake::LoadCache(const DerivedDataKey& key)
+{
+    std::vector<unsigned char> data;
+    if (!DerivedDataCache::Get().Load(key, data))
+        return false;
+
+    DerivedDataReader reader(data);
+    int32_t resolution = 0;
+    if (!reader.Read(resolution) || resolution < 2)
+        return false;
+
+    Allocate(resolution);
+    reader.ReadBytes(m_NormalMap.data(), m_NormalMap.size());
+    reader.ReadBytes(m_HorizonMaps[0].data(), m_HorizonMaps[0].size());
+    reader.ReadBytes(m_HorizonMaps[1].data(), m_HorizonMaps[1].size());
+    reader.ReadBytes(m_AOMap.data(), m_AOMap.size());
+
+    if (!reader.IsComplete())
+    {
+        m_Resolution = 0;
+        return false;
+    }
+    return true;
+}
+
+bool TerrainBake::SaveCache(const DerivedDataKey& key) const
+{
+    std::vector<unsigned char> data;
+    DerivedDataWriter writer(data);
+    writer.Write(static_cast<int32_t>(m_Resolution));
+    writer.WriteBytes(m_NormalMap.data(), m_NormalMap.size());
+    writer.WriteBytes(m_HorizonMaps[0].data(), m_HorizonMaps[0].size());
+    writer.WriteBytes(m_HorizonMaps[1].data(), m_HorizonMaps[1].size());
+    writer.WriteBytes(m_AOMap.data(), m_AOMap.size());
+    return DerivedDataCache::Get().Store(key, data);
+}
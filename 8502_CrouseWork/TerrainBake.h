@@ -0,0 +1,133 @@
+#ifndef TERRAIN_BAKE_H
+#define TERRAIN_BAKE_H
+
+#include <glad/glad.h>
+#include "nclgl/MemoryTracker.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Terrain;
+class DerivedDataKey;
+
+// ========================================
+// 地形烘焙 - 从高度场预计算光照贴图
+// ========================================
+// 功能：
+// 1. 法线贴图：逐像素法向量，光照细节不再受网格分辨率限制
+// 2. 地平线贴图：HORIZON_DIRECTIONS 个方位上的地平线仰角（sin值），
+//    片段着色器用它和太阳仰角比较，得到廉价的地形自阴影
+// 3. 环境光遮蔽（AO）贴图：由地平线角积分得到
+// 4. 多线程逐行烘焙，结果与线程数无关
+// 5. 烘焙结果存进派生数据缓存（DerivedDataCache），高度数据和参数不变时直接读取
+//
+// 贴图格式（烘焙分辨率 R × R，纹理坐标与地形的 TexCoord 相同）：
+//   法线贴图    RGB8   n * 0.5 + 0.5
+//   地平线贴图  2张 RGBA8，通道依次为方位 0-3、4-7（方位 k = k × 45°，
+//               从 +X 轴转向 +Z 轴），值 = sin(地平线仰角)
+//   AO贴图      R8     1 = 完全不遮挡
+// ========================================
+
+class TerrainBake
+{
+public:
+    static const int HORIZON_DIRECTIONS = 8;
+
+    // ========================================
+    // 烘焙参数
+    // ========================================
+    struct Settings
+    {
+        int   resolution      = 0;       // 贴图分辨率（0 = 与高度图相同）
+        int   horizonSteps    = 24;      // 每个方位的采样次数（按几何级数拉远）
+        float horizonDistance = 128.0f;  // 地平线搜索距离（高度图格子数）
+    };
+
+    explicit TerrainBake(const Settings& settings, unsigned int threadCount = 0);
+    ~TerrainBake();
+
+    // ========================================
+    // 读取缓存，缓存中没有时重新烘焙并写回缓存
+    // ========================================
+    // 缓存键包含高度数据和参数，任何一项变化都会重新烘焙
+    // 派生数据缓存没有打开时总是重新烘焙
+    // 返回：true = 命中缓存
+    // ========================================
+    bool LoadOrBake(const Terrain& terrain);
+
+    // 烘焙全部贴图
+    void Bake(const Terrain& terrain);
+
+    // ========================================
+    // 局部重新烘焙（地形编辑后调用）
+    // ========================================
+    // x0, z0, x1, z1 - 被修改的高度图区域（网格坐标，包含两端）
+    // includeHorizon - false 只更新法线贴图（很快，可以每帧调用）；
+    //                  true  同时更新地平线和AO（范围外扩 horizonDistance）
+    // 如果纹理已上传，会同步更新对应的纹理区域
+    // ========================================
+    void BakeRegion(const Terrain& terrain, int x0, int z0, int x1, int z1, bool includeHorizon);
+
+    // ========================================
+    // 上传 / 绑定纹理
+    // ========================================
+    // BindTextures 依次绑定到 firstUnit 开始的4个纹理单元：
+    //   法线、地平线0-3、地平线4-7、AO
+    // ========================================
+    void UploadTextures();
+    void BindTextures(unsigned int firstUnit) const;
+    bool IsUploaded() const { return m_NormalTexture != 0; }
+
+    int GetResolution() const { return m_Resolution; }
+    const std::vector<unsigned char>& GetNormalMap() const { return m_NormalMap; }
+    const std::vector<unsigned char>& GetHorizonMap(int index) const { return m_HorizonMaps[index]; }
+    const std::vector<unsigned char>& GetAOMap() const { return m_AOMap; }
+
+private:
+    Settings m_Settings;
+    unsigned int m_ThreadCount;
+
+    // CPU 端贴图数据
+    int m_Resolution;
+    std::vector<unsigned char> m_NormalMap;         // R × R × 3
+    std::vector<unsigned char> m_HorizonMaps[2];    // R × R × 4
+    std::vector<unsigned char> m_AOMap;             // R × R
+
+    // OpenGL 纹理
+    GLuint m_NormalTexture;
+    GLuint m_HorizonTextures[2];
+    GLuint m_AOTexture;
+
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+
+    // 烘焙时的输入（高度换算成格子单位，方便直接算坡度）
+    struct Source
+    {
+        const float* heights;
+        int width;
+        int height;
+        float verticalScale;   // heightScale / 格子间距
+    };
+
+    Source MakeSource(const Terrain& terrain) const;
+    void Allocate(int resolution);
+
+    // 烘焙贴图中的一行（[tx0, tx1] 范围）
+    void BakeNormalRow(const Source& src, int row, int tx0, int tx1);
+    void BakeHorizonRow(const Source& src, int row, int tx0, int tx1);
+
+    // 贴图像素 → 高度图格子坐标
+    float TexelToGrid(int texel, int gridSize) const;
+
+    // 把纹理中矩形区域的数据重新上传
+    void UploadRegion(int tx0, int tz0, int tx1, int tz1, bool includeHorizon);
+
+    // 缓存
+    DerivedDataKey ComputeKey(const Terrain& terrain) const;
+    bool LoadCache(const DerivedDataKey& key);
+    bool SaveCache(const DerivedDataKey& key) const;
+};
+
+#endif // TERRAIN_BAKE_H
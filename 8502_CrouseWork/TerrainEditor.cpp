@@ -0,0 +1,122 @@
+#include "TerrainEditor.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+TerrainEditor::TerrainEditor(Terrain& terrain)
+    : m_Terrain(terrain)
+{
+}
+
+// ========================================
+// 应用笔刷
+// ========================================
+// 工作原理：
+// 1. 把笔刷中心和半径换算成网格坐标，得到包围矩形
+// 2. 平滑笔刷先复制一份矩形（外扩一格）的旧高度，
+//    保证结果不受遍历顺序影响
+// 3. 逐格按衰减权重修改高度
+// 4. 把包围矩形标记为脏区域
+// ========================================
+void TerrainEditor::Apply(Brush brush, float worldX, float worldZ, float radius, float strength)
+{
+    int width = m_Terrain.GetWidth();
+    int height = m_Terrain.GetHeight();
+    if (width < 2 || height < 2 || radius <= 0.0f)
+        return;
+
+    std::vector<float>& heights = m_Terrain.GetHeightData();
+
+    // 笔刷中心和半径（网格单位）
+    float cx = m_Terrain.WorldToGridX(worldX);
+    float cz = m_Terrain.WorldToGridZ(worldZ);
+    float cellSize = m_Terrain.GetTerrainSize() / (width - 1);
+    float r = radius / cellSize;
+
+    int x0 = std::max(0, static_cast<int>(std::floor(cx - r)));
+    int z0 = std::max(0, static_cast<int>(std::floor(cz - r)));
+    int x1 = std::min(width - 1, static_cast<int>(std::ceil(cx + r)));
+    int z1 = std::min(height - 1, static_cast<int>(std::ceil(cz + r)));
+    if (x0 > x1 || z0 > z1)
+        return;
+
+    // 压平的目标高度：笔刷中心当前的高度
+    float flattenTarget = 0.0f;
+    if (brush == Brush::Flatten)
+    {
+        int ix = std::min(std::max(static_cast<int>(cx + 0.5f), 0), width - 1);
+        int iz = std::min(std::max(static_cast<int>(cz + 0.5f), 0), height - 1);
+        flattenTarget = heights[iz * width + ix];
+    }
+
+    // 平滑笔刷需要旧高度的副本（外扩一格用于取邻居）
+    int sx0 = std::max(0, x0 - 1);
+    int sz0 = std::max(0, z0 - 1);
+    int sx1 = std::min(width - 1, x1 + 1);
+    int sz1 = std::min(height - 1, z1 + 1);
+    int sw = sx1 - sx0 + 1;
+    std::vector<float> snapshot;
+    if (brush == Brush::Smooth)
+    {
+        snapshot.resize(static_cast<size_t>(sw) * (sz1 - sz0 + 1));
+        for (int z = sz0; z <= sz1; ++z)
+        {
+            std::copy(heights.begin() + z * width + sx0,
+                      heights.begin() + z * width + sx1 + 1,
+                      snapshot.begin() + (z - sz0) * sw);
+        }
+    }
+
+    for (int z = z0; z <= z1; ++z)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            // 衰减权重：中心为1，边缘平滑降到0
+            float dx = x - cx;
+            float dz = z - cz;
+            float d2 = (dx * dx + dz * dz) / (r * r);
+            if (d2 >= 1.0f)
+                continue;
+            float falloff = (1.0f - d2) * (1.0f - d2);
+
+            float& h = heights[z * width + x];
+            switch (brush)
+            {
+            case Brush::Raise:
+                h += strength * falloff;
+                break;
+
+            case Brush::Lower:
+                h -= strength * falloff;
+                break;
+
+            case Brush::Flatten:
+                h += (flattenTarget - h) * std::min(1.0f, strength * falloff);
+                break;
+
+            case Brush::Smooth:
+            {
+                // 3×3 邻域平均（边界处只取存在的邻居）
+                float sum = 0.0f;
+                int count = 0;
+                for (int nz = std::max(sz0, z - 1); nz <= std::min(sz1, z + 1); ++nz)
+                {
+                    for (int nx = std::max(sx0, x - 1); nx <= std::min(sx1, x + 1); ++nx)
+                    {
+                        sum += snapshot[(nz - sz0) * sw + (nx - sx0)];
+                        ++count;
+                    }
+                }
+                float average = sum / count;
+                h += (average - h) * std::min(1.0f, strength * falloff);
+                break;
+            }
+            }
+
+            // 高度保持在高度图范围内
+            h = std::min(std::max(h, 0.0f), 1.0f);
+        }
+    }
+
+    m_Terrain.MarkDirty(x0, z0, x1, z1);
+}
@@ -0,0 +1,48 @@
+#ifndef TERRAIN_EDITOR_H
+#define TERRAIN_EDITOR_H
+
+class Terrain;
+
+// ========================================
+// 地形编辑器 - 用笔刷实时修改地形高度
+// ========================================
+// 功能：
+// 1. 抬高 / 降低 / 压平 / 平滑 四种笔刷
+// 2. 每次笔刷只修改圆形范围内的高度，并把包围矩形标记为脏区域
+// 3. 每帧调用一次 Terrain::UpdateDirtyRegions()，
+//    只重建、上传被修改的那一小块网格
+// ========================================
+
+class TerrainEditor
+{
+public:
+    // 笔刷类型
+    enum class Brush
+    {
+        Raise,      // 抬高
+        Lower,      // 降低
+        Flatten,    // 压平到笔刷中心的高度
+        Smooth      // 向周围平均高度靠拢
+    };
+
+    explicit TerrainEditor(Terrain& terrain);
+
+    // ========================================
+    // 应用一次笔刷
+    // ========================================
+    // 参数：
+    //   brush            - 笔刷类型
+    //   worldX, worldZ   - 笔刷中心（世界坐标）
+    //   radius           - 笔刷半径（世界单位）
+    //   strength         - 强度：
+    //                      抬高/降低：中心处改变的高度（0.0 - 1.0 高度单位）
+    //                      压平/平滑：中心处向目标靠拢的比例（0.0 - 1.0）
+    // 笔刷边缘使用平滑衰减 (1 - (d/r)²)²
+    // ========================================
+    void Apply(Brush brush, float worldX, float worldZ, float radius, float strength);
+
+private:
+    Terrain& m_Terrain;
+};
+
+#endif // TERRAIN_EDITOR_H
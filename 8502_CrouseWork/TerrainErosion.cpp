@@ -0,0 +1,355 @@
+#include "TerrainErosion.h"
+#include "nclgl/LinearArena.h"
+#include "nclgl/Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+// ========================================
+// 随机数辅助函数
+// ========================================
+// 把多个整数混合成一个种子（splitmix32 风格）
+static inline unsigned int HashSeed(unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+{
+    unsigned int h = a * 0x9E3779B9u;
+    h ^= b + 0x7F4A7C15u + (h << 6) + (h >> 2);
+    h ^= c + 0x85EBCA6Bu + (h << 6) + (h >> 2);
+    h ^= d + 0xC2B2AE35u + (h << 6) + (h >> 2);
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h ? h : 1u;
+}
+
+// xorshift32，返回 0.0 - 1.0
+static inline float NextFloat(unsigned int& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// ========================================
+// 双线性插值高度和坡度
+// ========================================
+// 调用者保证 (x, z) 所在格子的右下角也在地图内
+// ========================================
+static inline void HeightAndGradient(const float* heights, int width, float x, float z,
+                                     float& h, float& gx, float& gz)
+{
+    int nx = static_cast<int>(x);
+    int nz = static_cast<int>(z);
+    float fx = x - nx;
+    float fz = z - nz;
+
+    const float* p = heights + static_cast<size_t>(nz) * width + nx;
+    float h00 = p[0];
+    float h10 = p[1];
+    float h01 = p[width];
+    float h11 = p[width + 1];
+
+    gx = (h10 - h00) * (1.0f - fz) + (h11 - h01) * fz;
+    gz = (h01 - h00) * (1.0f - fx) + (h11 - h10) * fx;
+    h = h00 * (1.0f - fx) * (1.0f - fz) + h10 * fx * (1.0f - fz)
+      + h01 * (1.0f - fx) * fz + h11 * fx * fz;
+}
+
+// ========================================
+// 构造函数 - 预计算侵蚀笔刷
+// ========================================
+TerrainErosion::TerrainErosion(const Settings& settings, unsigned int threadCount)
+    : m_Settings(settings)
+    , m_ThreadCount(threadCount)
+    , m_Iteration(0)
+    , m_CpuMemory(MEMORY_SIMULATION, MEMORY_CPU)
+{
+    // 笔刷权重 = max(0, 半径 - 距离)，再归一化，保证总和为1
+    int r = std::max(1, m_Settings.erosionRadius);
+    m_Settings.erosionRadius = r;
+
+    float total = 0.0f;
+    for (int dz = -r; dz <= r; ++dz)
+    {
+        for (int dx = -r; dx <= r; ++dx)
+        {
+            float dist = std::sqrt(static_cast<float>(dx * dx + dz * dz));
+            float w = static_cast<float>(r) - dist;
+            if (w > 0.0f)
+            {
+                m_Brush.push_back({ dx, dz, w });
+                total += w;
+            }
+        }
+    }
+    for (auto& cell : m_Brush)
+    {
+        cell.weight /= total;
+    }
+}
+
+// ========================================
+// 执行侵蚀迭代
+// ========================================
+void TerrainErosion::Run(std::vector<float>& heights, int width, int height, int iterations)
+{
+    if (width < 2 || height < 2 || heights.size() < static_cast<size_t>(width) * height)
+        return;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        if (m_Settings.hydraulic)
+        {
+            HydraulicPass(heights.data(), width, height);
+        }
+        if (m_Settings.thermal)
+        {
+            for (int p = 0; p < m_Settings.thermalPasses; ++p)
+            {
+                ThermalPass(heights, width, height);
+            }
+        }
+        ++m_Iteration;
+    }
+}
+
+// ========================================
+// 水力侵蚀（一轮）
+// ========================================
+// 工作原理：
+// 1. 按当前迭代次数平移图块网格
+// 2. 图块按 (tx 奇偶, tz 奇偶) 分成4组，逐组执行
+// 3. 同组图块并行，每个图块内的水滴按顺序模拟
+// ========================================
+void TerrainErosion::HydraulicPass(float* heights, int width, int height)
+{
+    const int T = TILE_SIZE;
+    const int margin = T / 2 - 1;
+
+    // 每次迭代平移网格，避免图块边界固定不变
+    int offset = (m_Iteration * 53) % T;
+    int tilesX = (width + offset + T - 1) / T;
+    int tilesZ = (height + offset + T - 1) / T;
+
+    ArenaScope scratch(LinearArena::Scratch());
+    ArenaVector<int> phaseTiles{ArenaAllocator<int>(scratch.GetArena())};
+    phaseTiles.reserve(static_cast<size_t>(tilesX) * tilesZ / 4 + 4);
+
+    for (int phase = 0; phase < 4; ++phase)
+    {
+        phaseTiles.clear();
+        for (int tz = 0; tz < tilesZ; ++tz)
+        {
+            for (int tx = 0; tx < tilesX; ++tx)
+            {
+                if (((tx & 1) | ((tz & 1) << 1)) == phase)
+                {
+                    phaseTiles.push_back(tz * tilesX + tx);
+                }
+            }
+        }
+
+        ParallelFor(static_cast<int>(phaseTiles.size()), m_ThreadCount, [&](int k)
+        {
+            int tile = phaseTiles[k];
+            int tx = tile % tilesX;
+            int tz = tile / tilesX;
+
+            // 图块范围（水滴出生区域），裁剪到地图内
+            int sx0 = std::max(0, tx * T - offset);
+            int sz0 = std::max(0, tz * T - offset);
+            int sx1 = std::min(width - 1, tx * T - offset + T);
+            int sz1 = std::min(height - 1, tz * T - offset + T);
+            if (sx1 <= sx0 || sz1 <= sz0)
+                return;
+
+            // 水滴活动区域 = 图块向外扩展 margin
+            Region region;
+            region.x0 = std::max(0, sx0 - margin);
+            region.z0 = std::max(0, sz0 - margin);
+            region.x1 = std::min(width, sx1 + margin);
+            region.z1 = std::min(height, sz1 + margin);
+
+            // 不完整的图块按面积比例减少水滴数
+            int area = (sx1 - sx0) * (sz1 - sz0);
+            int droplets = static_cast<int>(
+                static_cast<long long>(m_Settings.dropletsPerTile) * area / (T * T));
+
+            unsigned int rng = HashSeed(m_Settings.seed, static_cast<unsigned int>(m_Iteration),
+                                        static_cast<unsigned int>(tx), static_cast<unsigned int>(tz));
+            for (int d = 0; d < droplets; ++d)
+            {
+                float x = sx0 + NextFloat(rng) * (sx1 - sx0);
+                float z = sz0 + NextFloat(rng) * (sz1 - sz0);
+                SimulateDroplet(heights, width, region, x, z);
+            }
+        });
+    }
+}
+
+// ========================================
+// 模拟单个水滴
+// ========================================
+// 每一步：
+// 1. 根据坡度和惯性更新方向，移动一格
+// 2. 计算泥沙容量 = 下降高度 × 速度 × 水量 × 系数
+// 3. 泥沙超过容量（或上坡）→ 沉积；否则 → 用笔刷侵蚀周围
+// 4. 更新速度，水分蒸发
+// 水滴离开活动区域时直接结束
+// ========================================
+void TerrainErosion::SimulateDroplet(float* heights, int width, const Region& region,
+                                     float startX, float startZ) const
+{
+    const Settings& s = m_Settings;
+    const int r = s.erosionRadius;
+    const float hs = s.verticalScale;
+    const float invHs = 1.0f / hs;
+
+    // 笔刷和双线性插值需要的范围都在区域内
+    auto inside = [&](int nx, int nz)
+    {
+        return nx - r >= region.x0 && nx + r + 1 < region.x1
+            && nz - r >= region.z0 && nz + r + 1 < region.z1;
+    };
+
+    float posX = startX;
+    float posZ = startZ;
+    float dirX = 0.0f;
+    float dirZ = 0.0f;
+    float speed = s.initialSpeed;
+    float water = s.initialWater;
+    float sediment = 0.0f;
+
+    for (int life = 0; life < s.maxLifetime; ++life)
+    {
+        int nodeX = static_cast<int>(posX);
+        int nodeZ = static_cast<int>(posZ);
+        if (!inside(nodeX, nodeZ))
+            break;
+
+        float offX = posX - nodeX;
+        float offZ = posZ - nodeZ;
+
+        float h, gx, gz;
+        HeightAndGradient(heights, width, posX, posZ, h, gx, gz);
+
+        // 更新方向：惯性 + 沿坡度向下
+        dirX = dirX * s.inertia - gx * (1.0f - s.inertia);
+        dirZ = dirZ * s.inertia - gz * (1.0f - s.inertia);
+        float len = std::sqrt(dirX * dirX + dirZ * dirZ);
+        if (len < 1e-12f)
+            break;  // 平地，水滴停下
+        dirX /= len;
+        dirZ /= len;
+
+        posX += dirX;
+        posZ += dirZ;
+        if (posX < 0.0f || posZ < 0.0f || !inside(static_cast<int>(posX), static_cast<int>(posZ)))
+            break;
+
+        float newH, ngx, ngz;
+        HeightAndGradient(heights, width, posX, posZ, newH, ngx, ngz);
+        float deltaH = (newH - h) * hs;   // 格子单位
+
+        float capacity = std::max(-deltaH * speed * water * s.capacityFactor, s.minCapacity);
+
+        float* node = heights + static_cast<size_t>(nodeZ) * width + nodeX;
+        if (sediment > capacity || deltaH > 0.0f)
+        {
+            // ========================================
+            // 沉积：上坡时填平坑洼，否则沉积超出容量的部分
+            // ========================================
+            float amount = deltaH > 0.0f ? std::min(deltaH, sediment)
+                                         : (sediment - capacity) * s.depositSpeed;
+            sediment -= amount;
+
+            // 按双线性权重分给所在格子的4个角
+            float raw = amount * invHs;
+            node[0]         += raw * (1.0f - offX) * (1.0f - offZ);
+            node[1]         += raw * offX * (1.0f - offZ);
+            node[width]     += raw * (1.0f - offX) * offZ;
+            node[width + 1] += raw * offX * offZ;
+        }
+        else
+        {
+            // ========================================
+            // 侵蚀：不超过下降高度，避免挖出深坑
+            // ========================================
+            float amount = std::min((capacity - sediment) * s.erodeSpeed, -deltaH);
+            for (const BrushCell& cell : m_Brush)
+            {
+                float* p = node + cell.dz * width + cell.dx;
+                float want = amount * cell.weight * invHs;
+                float take = std::min(*p, want);
+                *p -= take;
+                sediment += take * hs;
+            }
+        }
+
+        // 下坡加速，上坡减速
+        speed = std::sqrt(std::max(0.0f, speed * speed - deltaH * s.gravity));
+        water *= (1.0f - s.evaporateSpeed);
+    }
+}
+
+// ========================================
+// 热力侵蚀（一轮）
+// ========================================
+// 相邻两格高度差超过休止角时，把超出部分的一部分从高处搬到低处。
+// 每对相邻格子的搬运量是对称的，所以总高度守恒。
+// 读旧缓冲、写新缓冲，任何线程数结果都一样。
+// ========================================
+void TerrainErosion::ThermalPass(std::vector<float>& heights, int width, int height)
+{
+    m_Scratch.resize(heights.size());
+    m_CpuMemory.Set(VectorBytes(m_Brush) + VectorBytes(m_Scratch));
+
+    const float talus = m_Settings.talusSlope / m_Settings.verticalScale;
+    const float talusDiag = talus * 1.41421356f;
+    // 8个邻居同时搬运，系数不超过 1/16 才能保证稳定
+    const float k = std::min(std::max(m_Settings.thermalRate, 0.0f), 1.0f) / 16.0f;
+
+    const float* src = heights.data();
+    float* dst = m_Scratch.data();
+
+    const int rowsPerTask = 64;
+    int tasks = (height + rowsPerTask - 1) / rowsPerTask;
+
+    ParallelFor(tasks, m_ThreadCount, [&](int task)
+    {
+        int z0 = task * rowsPerTask;
+        int z1 = std::min(height, z0 + rowsPerTask);
+
+        for (int z = z0; z < z1; ++z)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                size_t i = static_cast<size_t>(z) * width + x;
+                float h = src[i];
+                float delta = 0.0f;
+
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    int nz = z + dz;
+                    if (nz < 0 || nz >= height)
+                        continue;
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        int nx = x + dx;
+                        if ((dx == 0 && dz == 0) || nx < 0 || nx >= width)
+                            continue;
+
+                        float t = (dx != 0 && dz != 0) ? talusDiag : talus;
+                        float d = src[static_cast<size_t>(nz) * width + nx] - h;
+                        if (d > t)
+                            delta += k * (d - t);      // 从高处邻居流入
+                        else if (d < -t)
+                            delta -= k * (-d - t);     // 向低处邻居流出
+                    }
+                }
+                dst[i] = h + delta;
+            }
+        }
+    });
+
+    heights.swap(m_Scratch);
+}
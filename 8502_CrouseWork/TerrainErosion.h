@@ -0,0 +1,120 @@
+#ifndef TERRAIN_EROSION_H
+#define TERRAIN_EROSION_H
+
+#include "nclgl/MemoryTracker.h"
+#include <vector>
+
+// ========================================
+// 地形侵蚀模拟 - 让高度图看起来更自然
+// ========================================
+// 功能：
+// 1. 水力侵蚀：模拟大量水滴沿坡面流下，冲刷并沉积泥沙
+// 2. 热力侵蚀：坡度超过休止角的地方向低处崩塌
+// 3. 分图块多线程执行，结果与线程数无关（确定性）
+// 4. 可以每帧只跑少量迭代，分多帧逐步完成
+//
+// 并行方式：
+// - 水力侵蚀：地图切成 TILE_SIZE 的图块，按 2×2 着色分4个阶段执行。
+//   同一阶段的图块之间隔着一整个图块，水滴最多越出自己图块半个图块，
+//   所以同时运行的水滴永远不会读写同一格。每个图块的随机数只由
+//   (种子, 迭代次数, 图块坐标) 决定，因此结果与线程数无关。
+//   每次迭代整体平移图块网格，避免图块边界形成接缝。
+// - 热力侵蚀：双缓冲，每格只读旧高度、写新高度，天然确定性。
+// ========================================
+
+class TerrainErosion
+{
+public:
+    // ========================================
+    // 侵蚀参数
+    // ========================================
+    // 高度数据为 0.0 - 1.0（与 Terrain 的 m_HeightData 相同）
+    // verticalScale 把高度换算成“格子”单位，用于计算坡度和速度：
+    //   verticalScale = heightScale / 格子间距
+    // ========================================
+    struct Settings
+    {
+        unsigned int seed = 1;
+        float verticalScale = 25.0f;
+
+        // 水力侵蚀
+        bool  hydraulic       = true;
+        int   dropletsPerTile = 256;    // 每次迭代每个图块的水滴数
+        int   maxLifetime     = 30;     // 水滴最多走多少步
+        int   erosionRadius   = 3;      // 侵蚀笔刷半径（格）
+        float inertia         = 0.05f;  // 惯性：0 = 完全沿坡度，1 = 保持方向
+        float capacityFactor  = 4.0f;   // 泥沙容量系数
+        float minCapacity     = 0.01f;  // 最小泥沙容量
+        float erodeSpeed      = 0.3f;   // 侵蚀速度
+        float depositSpeed    = 0.3f;   // 沉积速度
+        float evaporateSpeed  = 0.01f;  // 每步蒸发比例
+        float gravity         = 4.0f;
+        float initialWater    = 1.0f;
+        float initialSpeed    = 1.0f;
+
+        // 热力侵蚀
+        bool  thermal         = true;
+        int   thermalPasses   = 1;      // 每次迭代的热力侵蚀次数
+        float talusSlope      = 0.8f;   // 休止角（坡度，格子单位）
+        float thermalRate     = 0.5f;   // 每次搬运超出部分的比例（0 - 1）
+    };
+
+    // ========================================
+    // 构造函数
+    // ========================================
+    // 参数：
+    //   settings    - 侵蚀参数
+    //   threadCount - 线程数（0 = 全部硬件线程）
+    // ========================================
+    TerrainErosion(const Settings& settings, unsigned int threadCount = 0);
+
+    // ========================================
+    // 执行侵蚀迭代
+    // ========================================
+    // 一次迭代 = 一轮水力侵蚀 + thermalPasses 轮热力侵蚀
+    // 可以每帧调用 Run(..., 1)，内部记住已完成的迭代次数，
+    // 分多帧执行与一次性执行的结果完全相同
+    // ========================================
+    void Run(std::vector<float>& heights, int width, int height, int iterations);
+
+    // 重新开始（迭代计数清零）
+    void Reset() { m_Iteration = 0; }
+
+    int GetIterationCount() const { return m_Iteration; }
+    const Settings& GetSettings() const { return m_Settings; }
+
+    // 图块边长
+    static const int TILE_SIZE = 128;
+
+private:
+    // 侵蚀笔刷中的一格
+    struct BrushCell
+    {
+        int dx;
+        int dz;
+        float weight;
+    };
+
+    // 水滴可以活动的矩形区域 [x0, x1) × [z0, z1)
+    struct Region
+    {
+        int x0, z0, x1, z1;
+    };
+
+    Settings m_Settings;
+    unsigned int m_ThreadCount;
+    int m_Iteration;
+
+    std::vector<BrushCell> m_Brush;      // 预计算的侵蚀笔刷权重
+    std::vector<float> m_Scratch;        // 热力侵蚀的双缓冲
+    TrackedMemory m_CpuMemory;
+
+    void HydraulicPass(float* heights, int width, int height);
+    void ThermalPass(std::vector<float>& heights, int width, int height);
+
+    // 在指定区域内模拟一个水滴
+    void SimulateDroplet(float* heights, int width, const Region& region,
+                         float startX, float startZ) const;
+};
+
+#endif // TERRAIN_EROSION_H
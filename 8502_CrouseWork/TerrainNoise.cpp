@@ -0,0 +1,425 @@
+#include "TerrainNoise.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <emmintrin.h>  // SSE2（x64 下始终可用）
+
+// ========================================
+// STB - 图像加载库（用于读取种子纹理）
+// ========================================
+#include "stb_image.h"
+
+// ========================================
+// 常量
+// ========================================
+// 8个梯度方向：4条对角线 + 4条坐标轴
+static const float kGradX[8] = { 1.0f, -1.0f,  1.0f, -1.0f, 1.0f, -1.0f, 0.0f,  0.0f };
+static const float kGradY[8] = { 1.0f,  1.0f, -1.0f, -1.0f, 0.0f,  0.0f, 1.0f, -1.0f };
+
+// 单纯形噪声的斜切系数
+static const float kF2 = 0.36602540378f;   // (sqrt(3) - 1) / 2
+static const float kG2 = 0.21132486540f;   // (3 - sqrt(3)) / 6
+
+// ========================================
+// SSE 辅助函数
+// ========================================
+
+// floor()：SSE2 没有 roundps，用截断再修正负数
+static inline __m128 FloorPS(__m128 x)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmplt_ps(x, t), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 AbsPS(__m128 x)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+// 淡化曲线 6t^5 - 15t^4 + 10t^3
+static inline __m128 FadePS(__m128 t)
+{
+    __m128 a = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+    __m128 b = _mm_add_ps(_mm_mul_ps(t, a), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), b);
+}
+
+static inline __m128 LerpPS(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+// ========================================
+// 梯度噪声（4个采样点一起计算）
+// ========================================
+// 返回范围约为 -1.0 到 1.0（二维梯度噪声理论范围 ±√2/2，乘 √2 归一化）
+// 排列表查表没有SIMD gather，逐通道标量查表，其余运算全部向量化
+// ========================================
+static __m128 GradientNoise4(const unsigned char* perm, __m128 x, __m128 y)
+{
+    __m128 fx = FloorPS(x);
+    __m128 fy = FloorPS(y);
+
+    alignas(16) int xi[4];
+    alignas(16) int yi[4];
+    __m128i mask255 = _mm_set1_epi32(255);
+    _mm_store_si128((__m128i*)xi, _mm_and_si128(_mm_cvttps_epi32(fx), mask255));
+    _mm_store_si128((__m128i*)yi, _mm_and_si128(_mm_cvttps_epi32(fy), mask255));
+
+    // 每个通道查出格子4个角的梯度
+    alignas(16) float g00x[4], g00y[4], g10x[4], g10y[4];
+    alignas(16) float g01x[4], g01y[4], g11x[4], g11y[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        int a = perm[xi[i]] + yi[i];
+        int b = perm[xi[i] + 1] + yi[i];
+        int h00 = perm[a] & 7;
+        int h01 = perm[a + 1] & 7;
+        int h10 = perm[b] & 7;
+        int h11 = perm[b + 1] & 7;
+        g00x[i] = kGradX[h00]; g00y[i] = kGradY[h00];
+        g10x[i] = kGradX[h10]; g10y[i] = kGradY[h10];
+        g01x[i] = kGradX[h01]; g01y[i] = kGradY[h01];
+        g11x[i] = kGradX[h11]; g11y[i] = kGradY[h11];
+    }
+
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 dx0 = _mm_sub_ps(x, fx);
+    __m128 dy0 = _mm_sub_ps(y, fy);
+    __m128 dx1 = _mm_sub_ps(dx0, one);
+    __m128 dy1 = _mm_sub_ps(dy0, one);
+
+    // 四个角的梯度与偏移向量点乘
+    __m128 n00 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(g00x), dx0), _mm_mul_ps(_mm_load_ps(g00y), dy0));
+    __m128 n10 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(g10x), dx1), _mm_mul_ps(_mm_load_ps(g10y), dy0));
+    __m128 n01 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(g01x), dx0), _mm_mul_ps(_mm_load_ps(g01y), dy1));
+    __m128 n11 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(g11x), dx1), _mm_mul_ps(_mm_load_ps(g11y), dy1));
+
+    // 双线性插值（使用淡化曲线平滑）
+    __m128 u = FadePS(dx0);
+    __m128 v = FadePS(dy0);
+    __m128 n = LerpPS(LerpPS(n00, n10, u), LerpPS(n01, n11, u), v);
+    return _mm_mul_ps(n, _mm_set1_ps(1.41421356f));
+}
+
+// ========================================
+// 单纯形噪声（4个采样点一起计算）
+// ========================================
+// 每个点只受所在三角形3个顶点影响，比梯度噪声少一个角
+// 返回范围约为 -1.0 到 1.0
+// ========================================
+static __m128 SimplexNoise4(const unsigned char* perm, __m128 x, __m128 y)
+{
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 zero = _mm_setzero_ps();
+    __m128 g2 = _mm_set1_ps(kG2);
+
+    // 斜切到单纯形网格，找到所在格子
+    __m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(kF2));
+    __m128 fi = FloorPS(_mm_add_ps(x, s));
+    __m128 fj = FloorPS(_mm_add_ps(y, s));
+    __m128 t = _mm_mul_ps(_mm_add_ps(fi, fj), g2);
+
+    // 第一个顶点的偏移
+    __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(fi, t));
+    __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(fj, t));
+
+    // 判断在上三角还是下三角
+    __m128 upper = _mm_cmpgt_ps(x0, y0);
+    __m128 i1 = _mm_and_ps(upper, one);
+    __m128 j1 = _mm_andnot_ps(upper, one);
+
+    // 第二、第三个顶点的偏移
+    __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+    __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+    __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(2.0f * kG2));
+    __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(2.0f * kG2));
+
+    alignas(16) int ii[4];
+    alignas(16) int jj[4];
+    __m128i mask255 = _mm_set1_epi32(255);
+    _mm_store_si128((__m128i*)ii, _mm_and_si128(_mm_cvttps_epi32(fi), mask255));
+    _mm_store_si128((__m128i*)jj, _mm_and_si128(_mm_cvttps_epi32(fj), mask255));
+    int upperBits = _mm_movemask_ps(upper);
+
+    alignas(16) float g0x[4], g0y[4], g1x[4], g1y[4], g2x[4], g2y[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        int oi = (upperBits >> i) & 1;
+        int oj = 1 - oi;
+        int h0 = perm[ii[i] + perm[jj[i]]] & 7;
+        int h1 = perm[ii[i] + oi + perm[jj[i] + oj]] & 7;
+        int h2 = perm[ii[i] + 1 + perm[jj[i] + 1]] & 7;
+        g0x[i] = kGradX[h0]; g0y[i] = kGradY[h0];
+        g1x[i] = kGradX[h1]; g1y[i] = kGradY[h1];
+        g2x[i] = kGradX[h2]; g2y[i] = kGradY[h2];
+    }
+
+    // 每个顶点的贡献：max(0.5 - r², 0)^4 × (梯度·偏移)
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 t0 = _mm_max_ps(_mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0)), zero);
+    __m128 t1 = _mm_max_ps(_mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1)), zero);
+    __m128 t2 = _mm_max_ps(_mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2)), zero);
+    t0 = _mm_mul_ps(t0, t0); t0 = _mm_mul_ps(t0, t0);
+    t1 = _mm_mul_ps(t1, t1); t1 = _mm_mul_ps(t1, t1);
+    t2 = _mm_mul_ps(t2, t2); t2 = _mm_mul_ps(t2, t2);
+
+    __m128 n0 = _mm_mul_ps(t0, _mm_add_ps(_mm_mul_ps(_mm_load_ps(g0x), x0), _mm_mul_ps(_mm_load_ps(g0y), y0)));
+    __m128 n1 = _mm_mul_ps(t1, _mm_add_ps(_mm_mul_ps(_mm_load_ps(g1x), x1), _mm_mul_ps(_mm_load_ps(g1y), y1)));
+    __m128 n2 = _mm_mul_ps(t2, _mm_add_ps(_mm_mul_ps(_mm_load_ps(g2x), x2), _mm_mul_ps(_mm_load_ps(g2y), y2)));
+
+    // 缩放到约 -1.0 到 1.0
+    return _mm_mul_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), _mm_set1_ps(70.0f));
+}
+
+static inline __m128 Basis4(const unsigned char* perm, TerrainNoise::Basis basis, __m128 x, __m128 y)
+{
+    return basis == TerrainNoise::Basis::Simplex ? SimplexNoise4(perm, x, y)
+                                                 : GradientNoise4(perm, x, y);
+}
+
+// ========================================
+// fBm / 山脊噪声叠加
+// ========================================
+// fBm：   每层频率 × lacunarity，振幅 × gain，结果约 -1 到 1
+// Ridged：每层取 (1 - |n|)²，并用上一层结果加权，结果约 0 到 1
+// ========================================
+static __m128 Fractal4(const unsigned char* perm, const TerrainNoise::Settings& s,
+                       int octaves, bool ridged, __m128 x, __m128 y)
+{
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 sum = _mm_setzero_ps();
+    __m128 weight = one;
+    float amplitude = 1.0f;
+    float frequency = 1.0f;
+    float norm = 0.0f;
+
+    for (int o = 0; o < octaves; ++o)
+    {
+        // 每层加一个固定偏移，避免各层在原点处相关
+        __m128 ox = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(frequency)), _mm_set1_ps(o * 17.13f));
+        __m128 oy = _mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(frequency)), _mm_set1_ps(o * 31.71f));
+        __m128 n = Basis4(perm, s.basis, ox, oy);
+
+        if (ridged)
+        {
+            n = _mm_sub_ps(one, AbsPS(n));
+            n = _mm_mul_ps(n, n);
+            n = _mm_mul_ps(n, weight);
+            weight = _mm_min_ps(_mm_max_ps(_mm_mul_ps(n, _mm_set1_ps(2.0f)), _mm_setzero_ps()), one);
+        }
+
+        sum = _mm_add_ps(sum, _mm_mul_ps(n, _mm_set1_ps(amplitude)));
+        norm += amplitude;
+        amplitude *= s.gain;
+        frequency *= s.lacunarity;
+    }
+
+    return _mm_div_ps(sum, _mm_set1_ps(norm > 0.0f ? norm : 1.0f));
+}
+
+// ========================================
+// 计算4个采样点的最终高度（0.0 - 1.0）
+// ========================================
+// u, v 为归一化坐标；批量生成和单点采样都调用这个函数
+// ========================================
+static __m128 Evaluate4(const unsigned char* perm, const TerrainNoise::Settings& s, __m128 u, __m128 v)
+{
+    __m128 x = _mm_add_ps(_mm_mul_ps(u, _mm_set1_ps(s.frequency)), _mm_set1_ps(s.offsetX));
+    __m128 y = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(s.frequency)), _mm_set1_ps(s.offsetZ));
+
+    // ========================================
+    // 域扭曲：用两组低频fBm偏移采样坐标
+    // ========================================
+    if (s.warpStrength > 0.0f)
+    {
+        int warpOctaves = std::max(2, s.octaves / 2);
+        __m128 wf = _mm_set1_ps(s.warpFrequency);
+        __m128 wx = _mm_mul_ps(x, wf);
+        __m128 wy = _mm_mul_ps(y, wf);
+        __m128 qx = Fractal4(perm, s, warpOctaves, false, wx, wy);
+        __m128 qy = Fractal4(perm, s, warpOctaves, false,
+                             _mm_add_ps(wx, _mm_set1_ps(5.2f)),
+                             _mm_add_ps(wy, _mm_set1_ps(1.3f)));
+        __m128 strength = _mm_set1_ps(s.warpStrength);
+        x = _mm_add_ps(x, _mm_mul_ps(qx, strength));
+        y = _mm_add_ps(y, _mm_mul_ps(qy, strength));
+    }
+
+    __m128 n = Fractal4(perm, s, s.octaves, s.ridged, x, y);
+
+    // fBm 从 -1..1 映射到 0..1；山脊噪声本身已在 0..1
+    if (!s.ridged)
+    {
+        n = _mm_add_ps(_mm_mul_ps(n, _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+    }
+    return _mm_min_ps(_mm_max_ps(n, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+// ========================================
+// 构造函数
+// ========================================
+TerrainNoise::TerrainNoise(unsigned int seed)
+{
+    SetSeed(seed);
+}
+
+// ========================================
+// 用整数种子洗牌排列表（Fisher-Yates）
+// ========================================
+void TerrainNoise::SetSeed(unsigned int seed)
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        m_Perm[i] = static_cast<unsigned char>(i);
+    }
+
+    // xorshift32 随机数（种子不能为0）
+    unsigned int state = seed ? seed : 0x9E3779B9u;
+    for (int i = 255; i > 0; --i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        int j = static_cast<int>(state % static_cast<unsigned int>(i + 1));
+        std::swap(m_Perm[i], m_Perm[j]);
+    }
+
+    // 复制一遍，查表时 perm[a + 1] 不会越界
+    for (int i = 0; i < 256; ++i)
+    {
+        m_Perm[256 + i] = m_Perm[i];
+    }
+}
+
+// ========================================
+// 用种子纹理洗牌排列表
+// ========================================
+// 工作原理：
+// 1. 对全部像素做 FNV-1a 哈希，作为洗牌的初始种子
+// 2. 洗牌时再把像素值混入每一步的随机数
+// 这样纹理上任何一个像素改变，都会得到不同的地形
+// ========================================
+bool TerrainNoise::SetSeedTexture(const std::string& path)
+{
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 1);
+    if (!data)
+    {
+        LOG_ERROR("错误：无法加载种子纹理 " << path);
+        LOG_ERROR("STB错误信息: " << stbi_failure_reason());
+        return false;
+    }
+    PerfCounters::Add(PERF_ASSETS_LOADED);
+
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+
+    SetSeed(hash);
+
+    // 第二轮洗牌：随机数异或上像素值
+    unsigned int state = hash ? hash : 0x9E3779B9u;
+    for (int i = 255; i > 0; --i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        unsigned int r = state ^ data[(static_cast<size_t>(i) * 7919u) % pixelCount];
+        int j = static_cast<int>(r % static_cast<unsigned int>(i + 1));
+        std::swap(m_Perm[i], m_Perm[j]);
+    }
+    for (int i = 0; i < 256; ++i)
+    {
+        m_Perm[256 + i] = m_Perm[i];
+    }
+
+    stbi_image_free(data);
+
+    char hashText[16];
+    snprintf(hashText, sizeof(hashText), "%x", hash);
+    LOG_INFO("  种子纹理: " << path << " (" << width << "x" << height
+             << ", 哈希 0x" << hashText << ")");
+    return true;
+}
+
+// ========================================
+// 单点采样
+// ========================================
+float TerrainNoise::Sample(const Settings& settings, float u, float v) const
+{
+    __m128 r = Evaluate4(m_Perm, settings, _mm_set1_ps(u), _mm_set1_ps(v));
+    return _mm_cvtss_f32(r);
+}
+
+// ========================================
+// 生成一个图块
+// ========================================
+// 每行按4个采样点一组处理
+// 行尾不足4个时仍走SIMD路径，只写回有效的通道
+// ========================================
+void TerrainNoise::GenerateTile(const Settings& settings, float* out,
+                                int width, int height,
+                                int x0, int z0, int w, int h) const
+{
+    float invW = width > 1 ? 1.0f / (width - 1) : 0.0f;
+    float invH = height > 1 ? 1.0f / (height - 1) : 0.0f;
+    __m128 invW4 = _mm_set1_ps(invW);
+    __m128 laneOffset = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+    for (int z = z0; z < z0 + h; ++z)
+    {
+        __m128 v = _mm_set1_ps(static_cast<float>(z) * invH);
+        float* row = out + static_cast<size_t>(z) * width;
+
+        for (int x = x0; x < x0 + w; x += 4)
+        {
+            __m128 xs = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffset);
+            __m128 r = Evaluate4(m_Perm, settings, _mm_mul_ps(xs, invW4), v);
+
+            int remaining = x0 + w - x;
+            if (remaining >= 4)
+            {
+                _mm_storeu_ps(row + x, r);
+            }
+            else
+            {
+                alignas(16) float tmp[4];
+                _mm_store_ps(tmp, r);
+                for (int i = 0; i < remaining; ++i)
+                {
+                    row[x + i] = tmp[i];
+                }
+            }
+        }
+    }
+}
+
+// ========================================
+// 并行生成整张高度图
+// ========================================
+// 将高度图切成 TILE_SIZE × TILE_SIZE 的图块，每个图块是一个任务
+// ========================================
+void TerrainNoise::Generate(const Settings& settings, std::vector<float>& out,
+                            int width, int height,
+                            unsigned int threadCount) const
+{
+    out.resize(static_cast<size_t>(width) * height);
+
+    int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesZ = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    float* data = out.data();
+    ParallelFor(tilesX * tilesZ, threadCount, [&](int tile)
+    {
+        int tx = (tile % tilesX) * TILE_SIZE;
+        int tz = (tile / tilesX) * TILE_SIZE;
+        int w = std::min(TILE_SIZE, width - tx);
+        int h = std::min(TILE_SIZE, height - tz);
+        GenerateTile(settings, data, width, height, tx, tz, w, h);
+    });
+}
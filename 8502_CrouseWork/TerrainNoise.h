@@ -0,0 +1,106 @@
+#ifndef TERRAIN_NOISE_H
+#define TERRAIN_NOISE_H
+
+#include <string>
+#include <vector>
+
+// ========================================
+// 程序化噪声模块 - 生成地形高度数据
+// ========================================
+// 功能：
+// 1. 梯度噪声（Perlin）和单纯形噪声（Simplex）
+// 2. fBm 分形叠加、山脊噪声（Ridged）
+// 3. 域扭曲（Domain Warping），让地形更自然
+// 4. SSE 一次计算4个采样点，按图块（tile）多线程并行
+//
+// 确定性：
+// 每个采样点只依赖自己的坐标和种子，且所有采样点（包括行尾）
+// 都走同一条SIMD路径，所以不管用几个线程，输出都逐位相同。
+// ========================================
+
+class TerrainNoise
+{
+public:
+    // 基础噪声类型
+    enum class Basis
+    {
+        Gradient,   // 经典梯度噪声（Perlin）
+        Simplex     // 单纯形噪声，方向性伪影更少
+    };
+
+    // ========================================
+    // 生成参数
+    // ========================================
+    struct Settings
+    {
+        Basis basis        = Basis::Simplex;
+        int   octaves      = 6;       // fBm 叠加层数
+        float frequency    = 4.0f;    // 整张图的基础频率（周期数）
+        float lacunarity   = 2.0f;    // 每层频率倍数
+        float gain         = 0.5f;    // 每层振幅倍数
+        bool  ridged       = false;   // 使用山脊噪声（尖锐山脊）
+        float warpStrength = 0.0f;    // 域扭曲强度（0 = 关闭）
+        float warpFrequency = 1.0f;   // 域扭曲噪声相对频率
+        float offsetX      = 0.0f;    // 采样偏移（用于平移/拼接图块）
+        float offsetZ      = 0.0f;
+    };
+
+    // ========================================
+    // 构造函数
+    // ========================================
+    // 参数：
+    //   seed - 随机种子，决定排列表（相同种子 = 相同地形）
+    // ========================================
+    explicit TerrainNoise(unsigned int seed = 1337);
+
+    // ========================================
+    // 用种子纹理（如 noise.png）生成排列表
+    // ========================================
+    // 纹理像素作为洗牌的随机源，换一张种子图就换一片地形
+    // 返回：是否加载成功（失败时保留原来的排列表）
+    // ========================================
+    bool SetSeedTexture(const std::string& path);
+
+    // 重新设置整数种子
+    void SetSeed(unsigned int seed);
+
+    // ========================================
+    // 单点采样（返回 0.0 - 1.0，与高度图数据范围一致）
+    // ========================================
+    // u, v 为 0.0 - 1.0 的归一化坐标
+    // 内部走与批量生成相同的SIMD路径，结果完全一致
+    // ========================================
+    float Sample(const Settings& settings, float u, float v) const;
+
+    // ========================================
+    // 生成一个矩形区域（图块）
+    // ========================================
+    // 参数：
+    //   out           - 整张高度图的首地址（行主序，width × height）
+    //   width, height - 整张高度图的尺寸（用于坐标归一化）
+    //   x0, z0, w, h  - 图块在高度图中的位置和大小
+    // ========================================
+    void GenerateTile(const Settings& settings, float* out,
+                      int width, int height,
+                      int x0, int z0, int w, int h) const;
+
+    // ========================================
+    // 并行生成整张高度图
+    // ========================================
+    // 参数：
+    //   out         - 输出数组，会被调整为 width × height
+    //   threadCount - 线程数（0 = 全部硬件线程）
+    // ========================================
+    void Generate(const Settings& settings, std::vector<float>& out,
+                  int width, int height,
+                  unsigned int threadCount = 0) const;
+
+    // 图块边长（每个线程任务处理一个图块）
+    static const int TILE_SIZE = 64;
+
+private:
+    // 排列表（重复两遍，避免取模）
+    unsigned char m_Perm[512];
+};
+
+#endif // TERRAIN_NOISE_H
@@ -0,0 +1,402 @@
+#include "TerrainSplat.h"
+#include "Terrain.h"
+#include "Texture.h"
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/Log.h"
+#include "nclgl/Parallel.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "stb_image.h"
+
+namespace
+{
+    // 派生数据缓存中材质层的版本：缩放或 Mipmap 的生成方式改变时加 1
+    // 缓存内容：级数 | 各级 RGB 像素（第 0 级为 layerSize × layerSize）
+    const unsigned int SPLAT_LAYER_VERSION = 1;
+
+    float SmoothStep(float edge0, float edge1, float x)
+    {
+        if (edge1 <= edge0)
+            return x < edge0 ? 0.0f : 1.0f;
+        float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.0f), 1.0f);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    // 值在 [lo, hi] 内为 1，两侧在 fade 范围内平滑降到 0
+    float Band(float v, float lo, float hi, float fade)
+    {
+        return SmoothStep(lo - fade, lo, v) * (1.0f - SmoothStep(hi, hi + fade, v));
+    }
+
+    // 双线性缩放 RGB 图像
+    void ResizeRGB(const unsigned char* src, int srcW, int srcH, unsigned char* dst, int dstW, int dstH)
+    {
+        for (int y = 0; y < dstH; ++y)
+        {
+            float sy = (y + 0.5f) * srcH / dstH - 0.5f;
+            int y0 = std::min(std::max(static_cast<int>(std::floor(sy)), 0), srcH - 1);
+            int y1 = std::min(y0 + 1, srcH - 1);
+            float fy = std::min(std::max(sy - y0, 0.0f), 1.0f);
+
+            for (int x = 0; x < dstW; ++x)
+            {
+                float sx = (x + 0.5f) * srcW / dstW - 0.5f;
+                int x0 = std::min(std::max(static_cast<int>(std::floor(sx)), 0), srcW - 1);
+                int x1 = std::min(x0 + 1, srcW - 1);
+                float fx = std::min(std::max(sx - x0, 0.0f), 1.0f);
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    float a = src[(y0 * srcW + x0) * 3 + c];
+                    float b = src[(y0 * srcW + x1) * 3 + c];
+                    float d = src[(y1 * srcW + x0) * 3 + c];
+                    float e = src[(y1 * srcW + x1) * 3 + c];
+                    float top = a + (b - a) * fx;
+                    float bottom = d + (e - d) * fx;
+                    dst[(y * dstW + x) * 3 + c] = static_cast<unsigned char>(top + (bottom - top) * fy + 0.5f);
+                }
+            }
+        }
+    }
+
+    bool ReadLayerLevels(const std::vector<unsigned char>& data, int size,
+                         std::vector<std::vector<unsigned char>>& levels)
+    {
+        DerivedDataReader reader(data);
+        int32_t levelCount = 0;
+        if (!reader.Read(levelCount) || levelCount <= 0 || levelCount > 32)
+            return false;
+        levels.resize(levelCount);
+        for (int k = 0; k < levelCount; ++k)
+        {
+            int levelSize = std::max(1, size >> k);
+            if (!reader.ReadArray(levels[k]) || levels[k].size() != static_cast<size_t>(levelSize) * levelSize * 3)
+                return false;
+        }
+        return reader.IsComplete();
+    }
+}
+
+TerrainSplat::TerrainSplat(const std::vector<Layer>& layers, const Settings& settings, unsigned int threadCount)
+    : m_Layers(layers)
+    , m_Settings(settings)
+    , m_ThreadCount(threadCount)
+    , m_Width(0)
+    , m_Height(0)
+    , m_SplatTexture(0)
+    , m_LayerArray(0)
+    , m_CpuMemory(MEMORY_TERRAIN, MEMORY_CPU)
+    , m_SplatMemory(MEMORY_TERRAIN, MEMORY_GPU_TEXTURE)
+    , m_LayerMemory(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE)
+{
+    if (m_Layers.size() > static_cast<size_t>(MAX_LAYERS))
+    {
+        LOG_ERROR("错误：材质层最多 " << MAX_LAYERS << " 层，多余的层被忽略");
+        m_Layers.resize(MAX_LAYERS);
+    }
+}
+
+TerrainSplat::~TerrainSplat()
+{
+    if (m_SplatTexture != 0)
+        glDeleteTextures(1, &m_SplatTexture);
+    if (m_LayerArray != 0)
+        glDeleteTextures(1, &m_LayerArray);
+}
+
+// ========================================
+// 生成整张混合图
+// ========================================
+void TerrainSplat::Generate(const Terrain& terrain)
+{
+    m_Width = terrain.GetWidth();
+    m_Height = terrain.GetHeight();
+    if (m_Width < 2 || m_Height < 2 || m_Layers.empty())
+    {
+        LOG_ERROR("错误：地形高度数据或材质层为空，无法生成混合图");
+        m_Width = m_Height = 0;
+        m_SplatMap.clear();
+        return;
+    }
+
+    m_SplatMap.assign(static_cast<size_t>(m_Width) * m_Height * 4, 0);
+    m_CpuMemory.Set(VectorBytes(m_SplatMap));
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ParallelFor(m_Height, m_ThreadCount, [&](int z) {
+        GenerateRow(terrain, z, 0, m_Width - 1);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    LOG_INFO("✓ 材质混合图生成完成: " << m_Width << "×" << m_Height << "，"
+             << m_Layers.size() << " 层（"
+             << std::chrono::duration<double, std::milli>(end - start).count() << " ms）");
+
+    if (m_SplatTexture != 0)
+    {
+        UploadRegion(0, 0, m_Width - 1, m_Height - 1);
+    }
+}
+
+// ========================================
+// 局部重新生成
+// ========================================
+void TerrainSplat::GenerateRegion(const Terrain& terrain, int x0, int z0, int x1, int z1)
+{
+    if (m_SplatMap.empty() || terrain.GetWidth() != m_Width || terrain.GetHeight() != m_Height)
+        return;
+
+    // 坡度和曲率都要用到采样半径以内的高度
+    int margin = std::max(1, static_cast<int>(std::ceil(m_Settings.sampleRadius)));
+    x0 = std::max(0, x0 - margin);
+    z0 = std::max(0, z0 - margin);
+    x1 = std::min(m_Width - 1, x1 + margin);
+    z1 = std::min(m_Height - 1, z1 + margin);
+    if (x0 > x1 || z0 > z1)
+        return;
+
+    ParallelFor(z1 - z0 + 1, m_ThreadCount, [&](int i) {
+        GenerateRow(terrain, z0 + i, x0, x1);
+    });
+
+    if (m_SplatTexture != 0)
+    {
+        UploadRegion(x0, z0, x1, z1);
+    }
+}
+
+// ========================================
+// 计算一行的材质权重
+// ========================================
+// 坡度：半径 r 处的中心差分得到梯度（格子单位），坡度 = |梯度|
+// 曲率：半径 r 处四个邻居与中心的拉普拉斯 / r²
+// 8位高度图相邻格子只差一个量化台阶，所以坡度也在半径 r 上计算，
+// 避免台阶噪声
+// ========================================
+void TerrainSplat::GenerateRow(const Terrain& terrain, int z, int x0, int x1)
+{
+    const float* heights = terrain.GetHeightData().data();
+    float cellSize = terrain.GetTerrainSize() / (m_Width - 1);
+    float verticalScale = terrain.GetHeightScale() / cellSize;
+    int r = std::max(1, static_cast<int>(m_Settings.sampleRadius + 0.5f));
+    int layerCount = static_cast<int>(m_Layers.size());
+
+    int zUp = std::max(z - r, 0);
+    int zDown = std::min(z + r, m_Height - 1);
+
+    for (int x = x0; x <= x1; ++x)
+    {
+        int xLeft = std::max(x - r, 0);
+        int xRight = std::min(x + r, m_Width - 1);
+
+        float h = heights[z * m_Width + x];
+
+        float dhdx = (heights[z * m_Width + xRight] - heights[z * m_Width + xLeft]) *
+                     verticalScale / (xRight - xLeft);
+        float dhdz = (heights[zDown * m_Width + x] - heights[zUp * m_Width + x]) *
+                     verticalScale / (zDown - zUp);
+        float slope = std::sqrt(dhdx * dhdx + dhdz * dhdz);
+
+        float laplacian = heights[z * m_Width + xLeft] + heights[z * m_Width + xRight] +
+                          heights[zUp * m_Width + x] + heights[zDown * m_Width + x] - 4.0f * h;
+        float curvature = laplacian * verticalScale / static_cast<float>(r * r);
+
+        // 各层权重
+        float weights[MAX_LAYERS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float sum = 0.0f;
+        for (int i = 0; i < layerCount; ++i)
+        {
+            const Layer& layer = m_Layers[i];
+            weights[i] = Band(h, layer.minHeight, layer.maxHeight, layer.heightFade) *
+                         Band(slope, layer.minSlope, layer.maxSlope, layer.slopeFade) *
+                         Band(curvature, layer.minCurvature, layer.maxCurvature, layer.curvatureFade);
+            sum += weights[i];
+        }
+
+        // 没有任何层匹配时使用第一层
+        if (sum <= 1e-6f)
+        {
+            weights[0] = 1.0f;
+            sum = 1.0f;
+        }
+
+        // 归一化并量化到 0-255，舍入误差补到权重最大的层，保证总和为 255
+        unsigned char* out = &m_SplatMap[(static_cast<size_t>(z) * m_Width + x) * 4];
+        int total = 0;
+        int largest = 0;
+        for (int i = 0; i < MAX_LAYERS; ++i)
+        {
+            int value = static_cast<int>(weights[i] / sum * 255.0f + 0.5f);
+            out[i] = static_cast<unsigned char>(value);
+            total += value;
+            if (weights[i] > weights[largest])
+                largest = i;
+        }
+        out[largest] = static_cast<unsigned char>(out[largest] + (255 - total));
+    }
+}
+
+// ========================================
+// 加载材质层纹理，创建纹理数组
+// ========================================
+// 纹理数组要求每层尺寸相同，所以统一缩放到 layerSize
+// 图像解码比较慢，各层并行加载
+// ========================================
+bool TerrainSplat::LoadLayerTextures()
+{
+    int size = m_Settings.layerSize;
+    int layerCount = static_cast<int>(m_Layers.size());
+    if (layerCount == 0 || size <= 0)
+        return false;
+
+    // 每层缩放后的图像和 Mipmap 存进派生数据缓存，下次启动直接读取
+    // levels[i][k]：第 i 层第 k 级
+    size_t layerBytes = static_cast<size_t>(size) * size * 3;
+    std::vector<std::vector<std::vector<unsigned char>>> levels(layerCount);
+    std::vector<char> loaded(layerCount, 0);
+    std::vector<char> cached(layerCount, 0);
+    DerivedDataCache& cache = DerivedDataCache::Get();
+
+    ParallelFor(layerCount, m_ThreadCount, [&](int i) {
+        std::vector<unsigned char> encoded;
+        DerivedDataKey key("splat_layer", SPLAT_LAYER_VERSION);
+        if (!key.AddFile(m_Layers[i].texturePath, &encoded))
+            return;
+        key.Add(size);
+
+        std::vector<unsigned char> derived;
+        if (cache.Load(key, derived) && ReadLayerLevels(derived, size, levels[i]))
+        {
+            loaded[i] = 1;
+            cached[i] = 1;
+            PerfCounters::Add(PERF_ASSETS_LOADED);
+            return;
+        }
+
+        int w = 0, h = 0, channels = 0;
+        unsigned char* data = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &w, &h, &channels, 3);
+        if (!data)
+            return;
+
+        levels[i].assign(1, std::vector<unsigned char>(layerBytes));
+        unsigned char* dst = levels[i][0].data();
+        if (w == size && h == size)
+            std::copy(data, data + layerBytes, dst);
+        else
+            ResizeRGB(data, w, h, dst, size, size);
+
+        stbi_image_free(data);
+        loaded[i] = 1;
+        PerfCounters::Add(PERF_ASSETS_LOADED);
+
+        // 缓存关着时没有地方保存，Mipmap 仍由 GPU 生成
+        if (cache.IsOpen())
+        {
+            Texture::BuildMipChain(levels[i], size, size, 3);
+            derived.clear();
+            DerivedDataWriter writer(derived);
+            writer.Write(static_cast<int32_t>(levels[i].size()));
+            for (const std::vector<unsigned char>& level : levels[i])
+                writer.WriteArray(level);
+            cache.Store(key, derived);
+        }
+    });
+
+    bool allLoaded = true;
+    size_t mipLevels = levels[0].size();
+    for (int i = 0; i < layerCount; ++i)
+    {
+        if (!loaded[i])
+        {
+            LOG_ERROR("错误：无法加载材质层纹理: " << m_Layers[i].texturePath);
+            allLoaded = false;
+        }
+        mipLevels = std::min(mipLevels, levels[i].size());
+    }
+    // 有一层没有 CPU 生成的 Mipmap 就只上传第 0 级，由 GPU 生成
+    if (mipLevels == 0)
+        mipLevels = 1;
+    bool cpuMips = mipLevels > 1;
+
+    if (m_LayerArray == 0)
+        glGenTextures(1, &m_LayerArray);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_LayerArray);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < mipLevels; ++level)
+    {
+        // 各层同一级拼在一起上传；没加载成功的层填灰色
+        int levelSize = std::max(1, size >> level);
+        size_t levelBytes = static_cast<size_t>(levelSize) * levelSize * 3;
+        std::vector<unsigned char> pixels(levelBytes * layerCount, 128);
+        for (int i = 0; i < layerCount; ++i)
+        {
+            if (loaded[i])
+                std::copy(levels[i][level].begin(), levels[i][level].end(), pixels.begin() + levelBytes * i);
+        }
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), GL_RGB8, levelSize, levelSize, layerCount, 0,
+                     GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        PerfCounters::Add(PERF_BYTES_UPLOADED, pixels.size());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (!cpuMips)
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    m_LayerMemory.Set(MemoryTracker::TextureBytes(size, size, layerCount, 3, true));
+
+    int cachedCount = static_cast<int>(std::count(cached.begin(), cached.end(), 1));
+    LOG_INFO("✓ 材质层纹理数组创建成功: " << layerCount << " 层，"
+             << size << "×" << size << "（" << cachedCount << " 层来自派生数据缓存）");
+    return allLoaded;
+}
+
+void TerrainSplat::UploadSplatMap()
+{
+    if (m_SplatMap.empty())
+    {
+        LOG_ERROR("错误：材质混合图尚未生成，无法上传");
+        return;
+    }
+
+    if (m_SplatTexture == 0)
+        glGenTextures(1, &m_SplatTexture);
+
+    glBindTexture(GL_TEXTURE_2D, m_SplatTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, m_SplatMap.data());
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_SplatMap.size());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_SplatMemory.Set(MemoryTracker::TextureBytes(m_Width, m_Height, 1, 4, false));
+}
+
+void TerrainSplat::UploadRegion(int x0, int z0, int x1, int z1)
+{
+    glBindTexture(GL_TEXTURE_2D, m_SplatTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_Width);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x0, z0, x1 - x0 + 1, z1 - z0 + 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                    &m_SplatMap[(static_cast<size_t>(z0) * m_Width + x0) * 4]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, static_cast<long long>(x1 - x0 + 1) * (z1 - z0 + 1) * 4);
+}
+
+void TerrainSplat::BindTextures(unsigned int firstUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_2D, m_SplatTexture);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_LayerArray);
+    glActiveTexture(GL_TEXTURE0);
+    PerfCounters::Add(PERF_TEXTURE_BINDS, 2);
+}
@@ -0,0 +1,114 @@
+#ifndef TERRAIN_SPLAT_H
+#define TERRAIN_SPLAT_H
+
+#include <glad/glad.h>
+#include "nclgl/MemoryTracker.h"
+#include <string>
+#include <vector>
+
+class Terrain;
+
+// ========================================
+// 地形材质混合图（Splat Map）
+// ========================================
+// 功能：
+// 1. 在CPU上按高度、坡度、曲率计算每个高度图像素的材质层权重
+// 2. 权重打包成一张 RGBA8 混合图（每个通道一层，最多 MAX_LAYERS 层）
+// 3. 各层纹理打包成一个纹理数组（GL_TEXTURE_2D_ARRAY）
+// 4. 片段着色器固定采样 1 次混合图 + MAX_LAYERS 次纹理数组，没有分支
+// 5. 多线程逐行计算，结果与线程数无关；支持局部重新生成（地形编辑）
+//
+// 每层的权重 = 高度带 × 坡度带 × 曲率带（带边缘用 smoothstep 过渡），
+// 然后把所有层的权重归一化，使它们之和为 1
+// ========================================
+
+class TerrainSplat
+{
+public:
+    static const int MAX_LAYERS = 4;
+
+    // ========================================
+    // 材质层参数
+    // ========================================
+    // 高度：0.0 - 1.0（与高度图相同）
+    // 坡度：tan(坡角)，0 = 平地，1 = 45°
+    // 曲率：高度的拉普拉斯（格子单位），> 0 为凹（山谷），< 0 为凸（山脊）
+    // ========================================
+    struct Layer
+    {
+        std::string texturePath;
+        float minHeight     = 0.0f;
+        float maxHeight     = 1.0f;
+        float heightFade    = 0.05f;
+        float minSlope      = 0.0f;
+        float maxSlope      = 1000.0f;
+        float slopeFade     = 0.1f;
+        float minCurvature  = -1000.0f;
+        float maxCurvature  = 1000.0f;
+        float curvatureFade = 0.01f;
+    };
+
+    struct Settings
+    {
+        float sampleRadius = 4.0f;    // 计算坡度和曲率的采样半径（格子数），越大越平滑
+        int   layerSize    = 1024;    // 纹理数组中每层的分辨率
+    };
+
+    TerrainSplat(const std::vector<Layer>& layers, const Settings& settings, unsigned int threadCount = 0);
+    ~TerrainSplat();
+
+    // 生成整张混合图
+    void Generate(const Terrain& terrain);
+
+    // ========================================
+    // 局部重新生成（地形编辑后调用）
+    // ========================================
+    // x0, z0, x1, z1 - 被修改的高度图区域（网格坐标，包含两端）
+    // 范围会外扩采样半径；纹理已上传时同步更新纹理区域
+    // ========================================
+    void GenerateRegion(const Terrain& terrain, int x0, int z0, int x1, int z1);
+
+    // ========================================
+    // 纹理
+    // ========================================
+    // LoadLayerTextures：加载各层图像，缩放到 layerSize，创建纹理数组
+    // UploadSplatMap：上传混合图
+    // BindTextures：混合图 → firstUnit，纹理数组 → firstUnit + 1
+    // ========================================
+    bool LoadLayerTextures();
+    void UploadSplatMap();
+    void BindTextures(unsigned int firstUnit) const;
+    bool IsReady() const { return m_SplatTexture != 0 && m_LayerArray != 0; }
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    int GetLayerCount() const { return static_cast<int>(m_Layers.size()); }
+    const std::vector<unsigned char>& GetSplatMap() const { return m_SplatMap; }
+
+private:
+    std::vector<Layer> m_Layers;
+    Settings m_Settings;
+    unsigned int m_ThreadCount;
+
+    // 混合图（与高度图同分辨率，RGBA8）
+    int m_Width;
+    int m_Height;
+    std::vector<unsigned char> m_SplatMap;
+
+    // OpenGL 纹理
+    GLuint m_SplatTexture;
+    GLuint m_LayerArray;
+
+    // 内存统计：混合图算地形，材质层纹理算纹理
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_SplatMemory;
+    TrackedMemory m_LayerMemory;
+
+    // 计算一行 [x0, x1] 的权重
+    void GenerateRow(const Terrain& terrain, int z, int x0, int x1);
+
+    // 上传混合图的矩形区域
+    void UploadRegion(int x0, int z0, int x1, int z1);
+};
+
+#endif // TERRAIN_SPLAT_H
@@ -0,0 +1,217 @@
+#include "TextOverlay.h"
+#include "nclgl/Shader.h"
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
+
+namespace {
+    // ========================================
+    // 3×5 点阵字体
+    // ========================================
+    // 每个字 5 行，每行 3 位（最高位在左）
+    // ========================================
+    const int GLYPH_WIDTH = 3;
+    const int GLYPH_HEIGHT = 5;
+    const int GLYPH_ADVANCE = 4;    // 字间隔一个像素
+    const int LINE_ADVANCE = 7;     // 行间隔两个像素
+    const int MARGIN = 4;           // 底板比文字四周多出的像素（字体像素）
+
+    struct Glyph {
+        char c;
+        unsigned char rows[GLYPH_HEIGHT];
+    };
+
+    const Glyph GLYPHS[] = {
+        { '0', { 7, 5, 5, 5, 7 } }, { '1', { 2, 6, 2, 2, 7 } },
+        { '2', { 7, 1, 7, 4, 7 } }, { '3', { 7, 1, 3, 1, 7 } },
+        { '4', { 5, 5, 7, 1, 1 } }, { '5', { 7, 4, 7, 1, 7 } },
+        { '6', { 7, 4, 7, 5, 7 } }, { '7', { 7, 1, 1, 2, 2 } },
+        { '8', { 7, 5, 7, 5, 7 } }, { '9', { 7, 5, 7, 1, 7 } },
+        { 'A', { 2, 5, 7, 5, 5 } }, { 'B', { 6, 5, 6, 5, 6 } },
+        { 'C', { 3, 4, 4, 4, 3 } }, { 'D', { 6, 5, 5, 5, 6 } },
+        { 'E', { 7, 4, 6, 4, 7 } }, { 'F', { 7, 4, 6, 4, 4 } },
+        { 'G', { 3, 4, 5, 5, 3 } }, { 'H', { 5, 5, 7, 5, 5 } },
+        { 'I', { 7, 2, 2, 2, 7 } }, { 'J', { 1, 1, 1, 5, 2 } },
+        { 'K', { 5, 5, 6, 5, 5 } }, { 'L', { 4, 4, 4, 4, 7 } },
+        { 'M', { 5, 7, 7, 5, 5 } }, { 'N', { 6, 5, 5, 5, 5 } },
+        { 'O', { 2, 5, 5, 5, 2 } }, { 'P', { 6, 5, 6, 4, 4 } },
+        { 'Q', { 2, 5, 5, 6, 3 } }, { 'R', { 6, 5, 6, 5, 5 } },
+        { 'S', { 3, 4, 2, 1, 6 } }, { 'T', { 7, 2, 2, 2, 2 } },
+        { 'U', { 5, 5, 5, 5, 7 } }, { 'V', { 5, 5, 5, 5, 2 } },
+        { 'W', { 5, 5, 7, 7, 5 } }, { 'X', { 5, 5, 2, 5, 5 } },
+        { 'Y', { 5, 5, 2, 2, 2 } }, { 'Z', { 7, 1, 2, 4, 7 } },
+        { ' ', { 0, 0, 0, 0, 0 } }, { '_', { 0, 0, 0, 0, 7 } },
+        { '-', { 0, 0, 7, 0, 0 } }, { '+', { 0, 2, 7, 2, 0 } },
+        { '.', { 0, 0, 0, 0, 2 } }, { ':', { 0, 2, 0, 2, 0 } },
+        { '/', { 1, 1, 2, 4, 4 } }, { '%', { 5, 1, 2, 4, 5 } },
+        { '(', { 1, 2, 2, 2, 1 } }, { ')', { 4, 2, 2, 2, 4 } },
+        { '=', { 0, 7, 0, 7, 0 } }, { ',', { 0, 0, 0, 2, 4 } },
+    };
+
+    const Glyph UNKNOWN_GLYPH = { '?', { 7, 1, 2, 0, 2 } };
+
+    const Glyph& FindGlyph(char c) {
+        if (c >= 'a' && c <= 'z') {
+            c = (char)(c - 'a' + 'A');
+        }
+        for (const Glyph& g : GLYPHS) {
+            if (g.c == c) {
+                return g;
+            }
+        }
+        return UNKNOWN_GLYPH;
+    }
+}
+
+// ========================================
+// 构造函数 - 加载着色器，创建 VAO/VBO
+// ========================================
+TextOverlay::TextOverlay(int pixelSize)
+    : m_Shader(nullptr)
+    , m_VAO(0)
+    , m_VBO(0)
+    , m_BufferBytes(0)
+    , m_Dirty(false)
+    , m_PixelSize(pixelSize > 0 ? pixelSize : 1)
+{
+    m_Shader = new Shader("overlayVertex.glsl", "overlayFragment.glsl");
+    if (!m_Shader->LoadSuccess()) {
+        LOG_ERROR("错误：叠加层着色器加载失败");
+        delete m_Shader;
+        m_Shader = nullptr;
+        return;
+    }
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindVertexArray(0);
+}
+
+// ========================================
+// 析构函数 - 释放 GPU 资源
+// ========================================
+TextOverlay::~TextOverlay()
+{
+    if (m_VAO != 0)
+        glDeleteVertexArrays(1, &m_VAO);
+    if (m_VBO != 0)
+        glDeleteBuffers(1, &m_VBO);
+    delete m_Shader;
+}
+
+// ========================================
+// 设置要显示的文字（每个字符串一行）
+// ========================================
+// 只生成顶点，不调用 GL，可以在任何线程上调用（但不能和 Render 同时）
+// ========================================
+void TextOverlay::SetLines(const std::vector<std::string>& lines)
+{
+    m_Vertices.clear();
+
+    // 底板：最长一行的宽度 × 行数
+    size_t longest = 0;
+    for (const std::string& line : lines) {
+        if (line.size() > longest)
+            longest = line.size();
+    }
+    float unit = (float)m_PixelSize;
+    float width = (longest * GLYPH_ADVANCE + MARGIN * 2 - 1) * unit;
+    float height = (lines.size() * LINE_ADVANCE + MARGIN * 2 - 2) * unit;
+    AddRect(0.0f, 0.0f, lines.empty() ? 0.0f : width, lines.empty() ? 0.0f : height);
+
+    // 文字：同一行里连续亮起的像素合并成一个矩形
+    for (size_t l = 0; l < lines.size(); ++l) {
+        const std::string& line = lines[l];
+        float top = (MARGIN + l * LINE_ADVANCE) * unit;
+        for (size_t i = 0; i < line.size(); ++i) {
+            const Glyph& g = FindGlyph(line[i]);
+            float left = (MARGIN + i * GLYPH_ADVANCE) * unit;
+            for (int row = 0; row < GLYPH_HEIGHT; ++row) {
+                int col = 0;
+                while (col < GLYPH_WIDTH) {
+                    int bit = GLYPH_WIDTH - 1 - col;
+                    if (!(g.rows[row] & (1 << bit))) {
+                        ++col;
+                        continue;
+                    }
+                    int start = col;
+                    while (col < GLYPH_WIDTH && (g.rows[row] & (1 << (GLYPH_WIDTH - 1 - col))))
+                        ++col;
+                    AddRect(left + start * unit, top + row * unit,
+                            left + col * unit, top + (row + 1) * unit);
+                }
+            }
+        }
+    }
+    m_Dirty = true;
+}
+
+// ========================================
+// 绘制叠加层
+// ========================================
+void TextOverlay::Render(int screenWidth, int screenHeight)
+{
+    if (!IsValid() || m_Vertices.size() <= 12)
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    if (m_Dirty) {
+        size_t bytes = m_Vertices.size() * sizeof(float);
+        if (bytes > m_BufferBytes) {
+            glBufferData(GL_ARRAY_BUFFER, bytes, m_Vertices.data(), GL_DYNAMIC_DRAW);
+            m_BufferBytes = bytes;
+        }
+        else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_Vertices.data());
+        }
+        PerfCounters::Add(PERF_BYTES_UPLOADED, (long long)bytes);
+        m_Dirty = false;
+    }
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLuint program = m_Shader->GetProgram();
+    glUseProgram(program);
+    PerfCounters::Add(PERF_SHADER_BINDS);
+    glUniform2f(glGetUniformLocation(program, "screenSize"), (float)screenWidth, (float)screenHeight);
+    GLint colorLocation = glGetUniformLocation(program, "color");
+
+    glBindVertexArray(m_VAO);
+
+    // 底板（前 6 个顶点）
+    glUniform4f(colorLocation, 0.0f, 0.0f, 0.0f, 0.55f);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    // 文字
+    GLsizei textVertices = (GLsizei)(m_Vertices.size() / 2 - 6);
+    glUniform4f(colorLocation, 1.0f, 1.0f, 0.6f, 1.0f);
+    glDrawArrays(GL_TRIANGLES, 6, textVertices);
+
+    PerfCounters::Add(PERF_DRAW_CALLS, 2);
+    PerfCounters::Add(PERF_TRIANGLES, 2 + textVertices / 3);
+
+    glBindVertexArray(0);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+    if (!blend)
+        glDisable(GL_BLEND);
+}
+
+// ========================================
+// 辅助函数 - 添加一个矩形（两个三角形）
+// ========================================
+void TextOverlay::AddRect(float x0, float y0, float x1, float y1)
+{
+    const float quad[12] = {
+        x0, y0,  x0, y1,  x1, y1,
+        x0, y0,  x1, y1,  x1, y0,
+    };
+    m_Vertices.insert(m_Vertices.end(), quad, quad + 12);
+}
@@ -0,0 +1,47 @@
+#ifndef TEXT_OVERLAY_H
+#define TEXT_OVERLAY_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+class Shader;
+
+// ========================================
+// 屏幕文字叠加层（性能计数器等调试信息）
+// ========================================
+// 功能：
+// 1. 内置 3×5 像素的点阵字体（数字、字母、少量符号，小写按大写显示），
+//    不需要字体文件或纹理
+// 2. SetLines 在 CPU 上把每个字的每行连续像素合并成一个矩形，
+//    Render 时才上传并绘制：先画半透明底板，再画文字
+// 3. 坐标以屏幕左上角为原点、单位为像素；pixelSize 为字体像素的放大倍数
+// ========================================
+
+class TextOverlay
+{
+public:
+    explicit TextOverlay(int pixelSize = 2);
+    ~TextOverlay();
+
+    bool IsValid() const { return m_Shader != nullptr && m_VAO != 0; }
+
+    void SetLines(const std::vector<std::string>& lines);
+
+    // 需要在 GL 线程上调用；会临时关闭深度测试并开启混合
+    void Render(int screenWidth, int screenHeight);
+
+private:
+    Shader* m_Shader;
+    GLuint m_VAO;
+    GLuint m_VBO;
+    size_t m_BufferBytes;           // 已分配的显存大小，不够时才重新分配
+
+    std::vector<float> m_Vertices;  // 前 6 个顶点是底板，之后是文字
+    bool m_Dirty;
+    int m_PixelSize;
+
+    void AddRect(float x0, float y0, float x1, float y1);
+};
+
+#endif // TEXT_OVERLAY_H
@@ -1,27 +1,84 @@
 #include "Texture.h"
-#include <iostream>
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
 
 // 使用 STB 图像加载库
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+// ========================================
+// 派生数据缓存
+// ========================================
+// 解码或 Mipmap 的生成方式改变时把版本加 1，旧的缓存项就不会再被找到
+// 缓存内容：宽 | 高 | 通道数 | 级数 | 各级像素
+// ========================================
+static const unsigned int TEXTURE_DATA_VERSION = 1;
+
+static void WriteDecodedImage(int width, int height, int channels,
+                              const std::vector<std::vector<unsigned char>>& levels,
+                              std::vector<unsigned char>& out)
+{
+    DerivedDataWriter writer(out);
+    writer.Write(static_cast<int32_t>(width));
+    writer.Write(static_cast<int32_t>(height));
+    writer.Write(static_cast<int32_t>(channels));
+    writer.Write(static_cast<int32_t>(levels.size()));
+    for (const std::vector<unsigned char>& level : levels)
+    {
+        writer.WriteArray(level);
+    }
+}
+
+static bool ReadDecodedImage(const std::vector<unsigned char>& data, int& width, int& height, int& channels,
+                             std::vector<std::vector<unsigned char>>& levels)
+{
+    DerivedDataReader reader(data);
+    int32_t w = 0, h = 0, c = 0, levelCount = 0;
+    if (!reader.Read(w) || !reader.Read(h) || !reader.Read(c) || !reader.Read(levelCount) ||
+        w <= 0 || h <= 0 || c <= 0 || levelCount <= 0 || levelCount > 32)
+    {
+        return false;
+    }
+    levels.resize(levelCount);
+    for (int i = 0; i < levelCount; ++i)
+    {
+        size_t expected = static_cast<size_t>(std::max(1, w >> i)) * std::max(1, h >> i) * c;
+        if (!reader.ReadArray(levels[i]) || levels[i].size() != expected)
+        {
+            return false;
+        }
+    }
+    if (!reader.IsComplete())
+    {
+        return false;
+    }
+    width = w;
+    height = h;
+    channels = c;
+    return true;
+}
+
 // 构造函数：从文件加载
 Texture::Texture(const std::string& path, bool generateMipmap)
     : m_TextureID(0), m_Width(0), m_Height(0), m_Channels(0), m_FilePath(path)
+    , m_GpuMemory(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE)
 {
     if (!LoadFromFile(path, generateMipmap))
     {
-        std::cerr << "错误：纹理加载失败: " << path << std::endl;
+        LOG_ERROR("错误：纹理加载失败: " << path);
     }
 }
 
 // 构造函数：从内存缓冲区加载
 Texture::Texture(const unsigned char* data, int size, const std::string& name, bool generateMipmap)
     : m_TextureID(0), m_Width(0), m_Height(0), m_Channels(0), m_FilePath(name)
+    , m_GpuMemory(MEMORY_TEXTURES, MEMORY_GPU_TEXTURE)
 {
     if (!LoadFromMemory(data, size, name, generateMipmap))
     {
-        std::cerr << "错误：从内存加载纹理失败: " << name << std::endl;
+        LOG_ERROR("错误：从内存加载纹理失败: " << name);
     }
 }
 
@@ -41,6 +98,7 @@ void Texture::Bind(unsigned int unit) const
     glActiveTexture(GL_TEXTURE0 + unit);
     // 绑定纹理
     glBindTexture(GL_TEXTURE_2D, m_TextureID);
+    PerfCounters::Add(PERF_TEXTURE_BINDS);
 }
 
 // 解绑纹理
@@ -52,158 +110,181 @@ void Texture::Unbind() const
 // 从文件加载纹理
 bool Texture::LoadFromFile(const std::string& path, bool generateMipmap)
 {
-    // 使用 STB 加载图像（保持原始格式）
-    // stbi_load 参数：文件名，宽度指针，高度指针，通道数指针，强制通道数（0表示自动）
-    unsigned char* data = stbi_load(path.c_str(), &m_Width, &m_Height, &m_Channels, 0);
+    // 文件内容既是缓存键的一部分，缓存没有命中时也直接从内存解码，只读一次文件
+    std::vector<unsigned char> encoded;
+    DerivedDataKey key("texture", TEXTURE_DATA_VERSION);
+    if (!key.AddFile(path, &encoded))
+    {
+        LOG_ERROR("错误：无法读取纹理文件: " << path);
+        return false;
+    }
+    key.Add(generateMipmap);
 
-    if (!data)
+    if (!LoadImage(encoded.data(), static_cast<int>(encoded.size()), key, path, generateMipmap))
     {
-        std::cerr << "错误：STB无法加载图像: " << path << std::endl;
-        std::cerr << "STB错误信息: " << stbi_failure_reason() << std::endl;
         return false;
     }
+    PerfCounters::Add(PERF_ASSETS_LOADED);
+    return true;
+}
 
-    std::cout << "成功加载纹理: " << path << std::endl;
-    std::cout << "  尺寸: " << m_Width << "x" << m_Height << std::endl;
-    std::cout << "  通道数: " << m_Channels << std::endl;
+// 从内存缓冲区加载纹理
+bool Texture::LoadFromMemory(const unsigned char* buffer, int bufferSize, const std::string& name, bool generateMipmap)
+{
+    DerivedDataKey key("texture", TEXTURE_DATA_VERSION);
+    key.AddBytes(buffer, bufferSize);
+    key.Add(generateMipmap);
+    return LoadImage(buffer, bufferSize, key, name, generateMipmap);
+}
 
-    // 生成OpenGL纹理
-    glGenTextures(1, &m_TextureID);
-    glBindTexture(GL_TEXTURE_2D, m_TextureID);
+// 解码并上传
+bool Texture::LoadImage(const unsigned char* buffer, int bufferSize, const DerivedDataKey& key,
+                        const std::string& name, bool generateMipmap)
+{
+    // ========================================
+    // 解码结果（和 Mipmap）：先查派生数据缓存
+    // ========================================
+    DerivedDataCache& cache = DerivedDataCache::Get();
+    std::vector<std::vector<unsigned char>> levels;
+    std::vector<unsigned char> derived;
+    bool cached = cache.Load(key, derived) && ReadDecodedImage(derived, m_Width, m_Height, m_Channels, levels);
+
+    if (!cached)
+    {
+        // 使用 STB 解码图像（保持原始格式）
+        unsigned char* data = stbi_load_from_memory(buffer, bufferSize, &m_Width, &m_Height, &m_Channels, 0);
+        if (!data)
+        {
+            LOG_ERROR("错误：STB无法加载图像: " << name);
+            LOG_ERROR("STB错误信息: " << stbi_failure_reason());
+            return false;
+        }
+        levels.resize(1);
+        levels[0].assign(data, data + static_cast<size_t>(m_Width) * m_Height * m_Channels);
+        stbi_image_free(data);
 
-    // 设置纹理参数
-    // 纹理环绕方式（Wrapping）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // 缓存关着时没有地方保存，Mipmap 仍由 GPU 生成（glGenerateMipmap）
+        if (cache.IsOpen())
+        {
+            if (generateMipmap)
+            {
+                BuildMipChain(levels, m_Width, m_Height, m_Channels);
+            }
+            derived.clear();
+            WriteDecodedImage(m_Width, m_Height, m_Channels, levels, derived);
+            cache.Store(key, derived);
+        }
+    }
 
-    // 纹理过滤方式（Filtering）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, generateMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    LOG_INFO("成功加载纹理: " << name << (cached ? "（派生数据缓存）" : ""));
+    LOG_INFO("  尺寸: " << m_Width << "x" << m_Height);
+    LOG_INFO("  通道数: " << m_Channels);
 
     // 根据通道数选择格式
     GLenum internalFormat;
     GLenum dataFormat;
-
-    // 设置像素对齐（对于RGB非常重要！）
     if (m_Channels == 3)
     {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // RGB需要1字节对齐
         internalFormat = GL_RGB;
         dataFormat = GL_RGB;
     }
     else if (m_Channels == 4)
     {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);  // RGBA使用4字节对齐
         internalFormat = GL_RGBA;
         dataFormat = GL_RGBA;
     }
     else if (m_Channels == 1)
     {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         internalFormat = GL_RED;
         dataFormat = GL_RED;
     }
     else
     {
-        std::cerr << "错误：不支持的通道数: " << m_Channels << std::endl;
-        stbi_image_free(data);
-        return false;
-    }
-
-    std::cout << "  使用格式: " << (m_Channels == 3 ? "RGB" : (m_Channels == 4 ? "RGBA" : "RED")) << std::endl;
-
-    // 上传纹理数据到GPU
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_Width, m_Height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-
-    // 生成Mipmap
-    if (generateMipmap)
-    {
-        glGenerateMipmap(GL_TEXTURE_2D);
-        std::cout << "  Mipmap已生成" << std::endl;
-    }
-
-    // 释放图像数据
-    stbi_image_free(data);
-
-    // 解绑纹理
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return true;
-}
-
-// 从内存缓冲区加载纹理
-bool Texture::LoadFromMemory(const unsigned char* buffer, int bufferSize, const std::string& name, bool generateMipmap)
-{
-    // 使用 STB 从内存缓冲区加载图像
-    unsigned char* data = stbi_load_from_memory(buffer, bufferSize, &m_Width, &m_Height, &m_Channels, 0);
-
-    if (!data)
-    {
-        std::cerr << "错误：STB无法从内存加载图像: " << name << std::endl;
-        std::cerr << "STB错误信息: " << stbi_failure_reason() << std::endl;
+        LOG_ERROR("错误：不支持的通道数: " << m_Channels);
         return false;
     }
 
-    std::cout << "成功从内存加载纹理: " << name << std::endl;
-    std::cout << "  尺寸: " << m_Width << "x" << m_Height << std::endl;
-    std::cout << "  通道数: " << m_Channels << std::endl;
+    LOG_INFO("  使用格式: " << (m_Channels == 3 ? "RGB" : (m_Channels == 4 ? "RGBA" : "RED")));
 
     // 生成OpenGL纹理
     glGenTextures(1, &m_TextureID);
     glBindTexture(GL_TEXTURE_2D, m_TextureID);
 
     // 设置纹理参数
+    // 纹理环绕方式（Wrapping）
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    // 纹理过滤方式（Filtering）
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, generateMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    // 根据通道数选择格式
-    GLenum internalFormat;
-    GLenum dataFormat;
+    // 设置像素对齐（对于RGB非常重要！）
+    // RGB和单通道的行不一定是4字节的倍数，需要1字节对齐；RGBA使用4字节对齐
+    glPixelStorei(GL_UNPACK_ALIGNMENT, m_Channels == 4 ? 4 : 1);
 
-    if (m_Channels == 3)
+    // 上传纹理数据到GPU（缓存里有 Mipmap 时逐级上传）
+    long long uploadedBytes = 0;
+    for (size_t level = 0; level < levels.size(); ++level)
     {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        internalFormat = GL_RGB;
-        dataFormat = GL_RGB;
-    }
-    else if (m_Channels == 4)
-    {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        internalFormat = GL_RGBA;
-        dataFormat = GL_RGBA;
-    }
-    else if (m_Channels == 1)
-    {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        internalFormat = GL_RED;
-        dataFormat = GL_RED;
-    }
-    else
-    {
-        std::cerr << "错误：不支持的通道数: " << m_Channels << std::endl;
-        stbi_image_free(data);
-        return false;
+        int width = std::max(1, m_Width >> level);
+        int height = std::max(1, m_Height >> level);
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, width, height, 0,
+                     dataFormat, GL_UNSIGNED_BYTE, levels[level].data());
+        uploadedBytes += static_cast<long long>(levels[level].size());
     }
-
-    std::cout << "  使用格式: " << (m_Channels == 3 ? "RGB" : (m_Channels == 4 ? "RGBA" : "RED")) << std::endl;
-
-    // 上传纹理数据到GPU
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_Width, m_Height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, uploadedBytes);
 
     // 生成Mipmap
     if (generateMipmap)
     {
-        glGenerateMipmap(GL_TEXTURE_2D);
-        std::cout << "  Mipmap已生成" << std::endl;
+        if (levels.size() == 1)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        LOG_INFO("  Mipmap已生成");
     }
-
-    // 释放图像数据
-    stbi_image_free(data);
+    m_GpuMemory.Set(MemoryTracker::TextureBytes(m_Width, m_Height, 1, m_Channels, generateMipmap));
 
     // 解绑纹理
     glBindTexture(GL_TEXTURE_2D, 0);
 
     return true;
 }
+
+// ========================================
+// 在 CPU 上生成 Mipmap
+// ========================================
+void Texture::BuildMipChain(std::vector<std::vector<unsigned char>>& levels, int width, int height, int channels)
+{
+    levels.resize(1);
+    while (width > 1 || height > 1)
+    {
+        int srcW = width;
+        int srcH = height;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+
+        const std::vector<unsigned char>& src = levels.back();
+        std::vector<unsigned char> dst(static_cast<size_t>(width) * height * channels);
+        for (int y = 0; y < height; ++y)
+        {
+            int y0 = std::min(2 * y, srcH - 1);
+            int y1 = std::min(2 * y + 1, srcH - 1);
+            for (int x = 0; x < width; ++x)
+            {
+                int x0 = std::min(2 * x, srcW - 1);
+                int x1 = std::min(2 * x + 1, srcW - 1);
+                for (int c = 0; c < channels; ++c)
+                {
+                    int sum = src[(static_cast<size_t>(y0) * srcW + x0) * channels + c]
+                            + src[(static_cast<size_t>(y0) * srcW + x1) * channels + c]
+                            + src[(static_cast<size_t>(y1) * srcW + x0) * channels + c]
+                            + src[(static_cast<size_t>(y1) * srcW + x1) * channels + c];
+                    dst[(static_cast<size_t>(y) * width + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(std::move(dst));
+    }
+}
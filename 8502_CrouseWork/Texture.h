@@ -2,9 +2,15 @@
 #define TEXTURE_H
 
 #include <glad/glad.h>
+#include "nclgl/MemoryTracker.h"
 #include <string>
+#include <vector>
+
+class DerivedDataKey;
 
 // Texture类：负责加载和管理OpenGL纹理
+// 解码后的图像和 Mipmap 存进派生数据缓存（DerivedDataCache 打开时），
+// 同一个文件下次启动直接读取，不再解码
 class Texture
 {
 public:
@@ -41,18 +47,28 @@ public:
     // 检查纹理是否加载成功
     bool IsLoaded() const { return m_TextureID != 0; }
 
+    // 在 CPU 上生成 Mipmap：levels[0] 是原图，按 2×2 平均依次生成到 1×1
+    // （奇数边长时最后一行/列重复使用），每级尺寸与 glGenerateMipmap 相同
+    static void BuildMipChain(std::vector<std::vector<unsigned char>>& levels, int width, int height, int channels);
+
 private:
     GLuint m_TextureID;      // OpenGL纹理ID
     int m_Width;             // 纹理宽度
     int m_Height;            // 纹理高度
     int m_Channels;          // 颜色通道数（3=RGB, 4=RGBA）
     std::string m_FilePath;  // 文件路径（用于调试）
+    TrackedMemory m_GpuMemory; // 显存统计
 
     // 辅助函数：从文件加载纹理
     bool LoadFromFile(const std::string& path, bool generateMipmap);
 
     // 辅助函数：从内存缓冲区加载纹理
     bool LoadFromMemory(const unsigned char* data, int size, const std::string& name, bool generateMipmap);
+
+    // 辅助函数：解码（或从派生数据缓存读取）并上传
+    // key 已包含图像文件的内容
+    bool LoadImage(const unsigned char* data, int size, const DerivedDataKey& key,
+                   const std::string& name, bool generateMipmap);
 };
 
 #endif // TEXTURE_H
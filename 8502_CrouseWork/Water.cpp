@@ -1,5 +1,5 @@
 #include "Water.h"
-#include <iostream>
+#include "nclgl/Log.h"
 
 /**
  * 构造函数 - 创建水面
@@ -11,9 +11,9 @@ Water::Water(const glm::vec3& position, float size)
     : position(position), size(size), VAO(0), VBO(0), EBO(0)
 {
     setupWater();
-    std::cout << "水面创建成功：" << std::endl;
-    std::cout << "  位置：(" << position.x << ", " << position.y << ", " << position.z << ")" << std::endl;
-    std::cout << "  大小：" << size << "x" << size << std::endl;
+    LOG_INFO("水面创建成功：");
+    LOG_INFO("  位置：(" << position.x << ", " << position.y << ", " << position.z << ")");
+    LOG_INFO("  大小：" << size << "x" << size);
 }
 
 /**
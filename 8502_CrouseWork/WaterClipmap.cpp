@@ -0,0 +1,479 @@
+#include "WaterClipmap.h"
+#include "WaterTileMap.h"
+#include "nclgl/LinearArena.h"
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// ========================================
+// 构造函数 - 创建多层级水面
+// ========================================
+WaterClipmap::WaterClipmap(float waterLevel, int gridSize, int levelCount, float baseCellSize)
+    : m_VAO(0)
+    , m_VBO(0)
+    , m_EBO(0)
+    , m_WaterLevel(waterLevel)
+    , m_GridSize(gridSize)
+    , m_BaseCellSize(baseCellSize)
+    , m_TileMap(nullptr)
+    , m_DrawDistance(0.0f)
+    , m_DrawnIndexCount(0)
+    , m_CpuMemory(MEMORY_WATER, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_WATER, MEMORY_GPU_BUFFER)
+{
+    LOG_INFO("\n========================================");
+    LOG_INFO("开始创建水面（Clipmap）...");
+    LOG_INFO("========================================");
+
+    // 格子数必须能被4整除（内层正好占外层中间一半），并且留出足够的边距
+    if (m_GridSize < 16 || m_GridSize % 4 != 0) {
+        LOG_ERROR("错误：水面网格每边格子数必须是4的倍数且不小于16，已改为64");
+        m_GridSize = 64;
+    }
+    if (levelCount < 1) {
+        levelCount = 1;
+    }
+
+    // ========================================
+    // 步骤1：为每一层分配固定的顶点/索引区域
+    // ========================================
+    // 第0层：完整网格
+    //   顶点 (n+1)²，三角形 2n²
+    // 其它层：挖掉中间 h×h 个格子（h = n/2），
+    //   内部顶点 (h-1)² 个被去掉，挖空边界每边加 h 个边中点；
+    //   相邻挖空的 4h 个格子各拆成3个三角形
+    int n = m_GridSize;
+    int h = n / 2;
+    int vertexTotal = 0;
+    int indexTotal = 0;
+    m_Levels.resize(levelCount);
+    for (int l = 0; l < levelCount; ++l) {
+        Level& level = m_Levels[l];
+        level.originX = 0;
+        level.originZ = 0;
+        level.built = false;
+        level.vertexOffset = vertexTotal;
+        level.indexOffset = indexTotal;
+        if (l == 0) {
+            level.vertexCount = (n + 1) * (n + 1);
+            level.indexCount = 6 * n * n;
+        } else {
+            level.vertexCount = (n + 1) * (n + 1) - (h - 1) * (h - 1) + 4 * h;
+            level.indexCount = 3 * (2 * (n * n - h * h - 4 * h) + 3 * 4 * h);
+        }
+        vertexTotal += level.vertexCount;
+        indexTotal += level.indexCount;
+    }
+    m_Vertices.resize(vertexTotal);
+    m_Indices.resize(indexTotal);
+
+    LOG_INFO("  水面高度: Y = " << m_WaterLevel);
+    LOG_INFO("  层数: " << levelCount << "，每层 " << n << " x " << n << " 格");
+    LOG_INFO("  最细格子: " << m_BaseCellSize << "，覆盖范围: " << GetExtent());
+
+    // ========================================
+    // 步骤2：以原点为中心生成网格
+    // ========================================
+    LOG_INFO("\n[步骤1] 生成水面网格...");
+    Update(Vector3(0.0f, 0.0f, 0.0f));
+    LOG_INFO("✓ 生成了 " << m_Vertices.size() << " 个顶点");
+    LOG_INFO("✓ 生成了 " << m_Indices.size() / 3 << " 个三角形");
+
+    // ========================================
+    // 步骤3：设置OpenGL缓冲对象
+    // ========================================
+    LOG_INFO("\n[步骤2] 创建GPU缓冲对象...");
+    SetupMesh();
+    m_CpuMemory.Set(VectorBytes(m_Vertices) + VectorBytes(m_Indices));
+    LOG_INFO("✓ VAO/VBO/EBO创建成功");
+
+    LOG_INFO("\n========================================");
+    LOG_INFO("水面创建完成！");
+    LOG_INFO("========================================\n");
+}
+
+// ========================================
+// 析构函数 - 清理GPU资源
+// ========================================
+WaterClipmap::~WaterClipmap()
+{
+    if (m_VAO != 0)
+        glDeleteVertexArrays(1, &m_VAO);
+    if (m_VBO != 0)
+        glDeleteBuffers(1, &m_VBO);
+    if (m_EBO != 0)
+        glDeleteBuffers(1, &m_EBO);
+
+    LOG_INFO("水面对象已销毁，GPU资源已释放");
+}
+
+Vector2 WaterClipmap::GetLevelOrigin(int level) const
+{
+    float cellSize = GetCellSize(level);
+    return Vector2(m_Levels[level].originX * cellSize, m_Levels[level].originZ * cellSize);
+}
+
+// ========================================
+// 吸附原点
+// ========================================
+// 让相机尽量处于本层中心，原点取本层格子的偶数倍，
+// 即外一层格子的整数倍——这样本层正好落在外层的网格线上
+// ========================================
+void WaterClipmap::ComputeOrigin(int level, const Vector3& cameraPosition, int& originX, int& originZ) const
+{
+    double cellSize = GetCellSize(level);
+    double half = 0.5 * m_GridSize * cellSize;
+    originX = 2 * static_cast<int>(std::floor((cameraPosition.x - half) / (2.0 * cellSize)));
+    originZ = 2 * static_cast<int>(std::floor((cameraPosition.z - half) / (2.0 * cellSize)));
+}
+
+// ========================================
+// 跟随相机
+// ========================================
+// 内层原点变化时外层的挖空位置也随之变化，所以外层也要重建
+// ========================================
+void WaterClipmap::Update(const Vector3& cameraPosition)
+{
+    // 临时数组放在线程的临时内存里，相机每帧移动时不用反复分配
+    ArenaScope scratch(LinearArena::Scratch());
+    int levelCount = GetLevelCount();
+    ArenaVector<char> moved(levelCount, 0, ArenaAllocator<char>(scratch.GetArena()));
+    m_CameraPosition = Vector2(cameraPosition.x, cameraPosition.z);
+
+    for (int l = 0; l < levelCount; ++l) {
+        int originX, originZ;
+        ComputeOrigin(l, cameraPosition, originX, originZ);
+
+        Level& level = m_Levels[l];
+        if (!level.built || originX != level.originX || originZ != level.originZ) {
+            level.originX = originX;
+            level.originZ = originZ;
+            moved[l] = 1;
+        }
+    }
+
+    for (int l = 0; l < levelCount; ++l) {
+        if (moved[l] || (l > 0 && moved[l - 1])) {
+            BuildLevel(l);
+            if (m_VBO != 0) {
+                UploadLevel(l);
+            }
+        }
+    }
+}
+
+// ========================================
+// 生成一层网格
+// ========================================
+// 网格坐标 (i, j)：0..n，世界坐标 = (原点 + i) × 格子边长
+// 挖空区域（内层覆盖的范围）：格子 [hx0, hx1) × [hz0, hz1)
+//
+// 与挖空区域相邻的格子有一条边和内层边界重合，
+// 内层在这条边中点也有一个顶点，所以在这里加一个边中点，
+// 把格子拆成以中点为扇心的3个三角形：
+//
+//   d ─── m ─── c        (挖空区域在上方)
+//   │   ╱   ╲   │
+//   │  ╱     ╲  │
+//   a ─────────── b
+// ========================================
+void WaterClipmap::BuildLevel(int levelIndex)
+{
+    Level& level = m_Levels[levelIndex];
+    int n = m_GridSize;
+    int h = n / 2;
+    float cellSize = GetCellSize(levelIndex);
+
+    // 挖空区域（第0层没有）
+    bool hasHole = levelIndex > 0;
+    int hx0 = 0, hz0 = 0, hx1 = 0, hz1 = 0;
+    if (hasHole) {
+        const Level& inner = m_Levels[levelIndex - 1];
+        hx0 = inner.originX / 2 - level.originX;
+        hz0 = inner.originZ / 2 - level.originZ;
+        hx1 = hx0 + h;
+        hz1 = hz0 + h;
+    }
+
+    unsigned int next = static_cast<unsigned int>(level.vertexOffset);
+    auto addVertex = [&](float gx, float gz) -> unsigned int {
+        float x = (level.originX + gx) * cellSize;
+        float z = (level.originZ + gz) * cellSize;
+        Vertex& v = m_Vertices[next];
+        v.Position = Vector3(x, m_WaterLevel, z);
+        v.Normal = Vector3(0.0f, 1.0f, 0.0f);
+        // 纹理坐标与原来 1000 单位的 WaterPlane 保持同样的比例
+        v.TexCoord = Vector2(x * 0.001f + 0.5f, z * 0.001f + 0.5f);
+        return next++;
+    };
+
+    // ========================================
+    // 步骤1：网格顶点（挖空区域内部的顶点不需要）
+    // ========================================
+    ArenaScope scratch(LinearArena::Scratch());
+    ArenaAllocator<unsigned int> alloc(scratch.GetArena());
+    ArenaVector<int> grid((n + 1) * (n + 1), -1, alloc);
+    for (int j = 0; j <= n; ++j) {
+        for (int i = 0; i <= n; ++i) {
+            bool inside = hasHole && i > hx0 && i < hx1 && j > hz0 && j < hz1;
+            if (!inside) {
+                grid[j * (n + 1) + i] = static_cast<int>(addVertex(static_cast<float>(i), static_cast<float>(j)));
+            }
+        }
+    }
+
+    // ========================================
+    // 步骤2：挖空边界的边中点
+    // ========================================
+    ArenaVector<unsigned int> midBottom(alloc), midTop(alloc), midLeft(alloc), midRight(alloc);
+    if (hasHole) {
+        midBottom.reserve(h);
+        midTop.reserve(h);
+        midLeft.reserve(h);
+        midRight.reserve(h);
+        for (int k = 0; k < h; ++k) {
+            midBottom.push_back(addVertex(hx0 + k + 0.5f, static_cast<float>(hz0)));
+            midTop.push_back(addVertex(hx0 + k + 0.5f, static_cast<float>(hz1)));
+            midLeft.push_back(addVertex(static_cast<float>(hx0), hz0 + k + 0.5f));
+            midRight.push_back(addVertex(static_cast<float>(hx1), hz0 + k + 0.5f));
+        }
+    }
+
+    // ========================================
+    // 步骤3：三角形索引
+    // ========================================
+    // 按区块顺序输出，同一区块的三角形在索引数组中连续
+    unsigned int* out = &m_Indices[level.indexOffset];
+    int blockSize = n / BLOCKS_PER_SIDE;
+    for (int block = 0; block < BLOCK_COUNT; ++block) {
+        int bi = block % BLOCKS_PER_SIDE;
+        int bj = block / BLOCKS_PER_SIDE;
+        unsigned int* blockStart = out;
+
+        for (int j = bj * blockSize; j < (bj + 1) * blockSize; ++j) {
+            for (int i = bi * blockSize; i < (bi + 1) * blockSize; ++i) {
+                bool inRangeX = i >= hx0 && i < hx1;
+                bool inRangeZ = j >= hz0 && j < hz1;
+                if (hasHole && inRangeX && inRangeZ) {
+                    continue;
+                }
+
+                unsigned int a = grid[j * (n + 1) + i];
+                unsigned int b = grid[j * (n + 1) + i + 1];
+                unsigned int c = grid[(j + 1) * (n + 1) + i + 1];
+                unsigned int d = grid[(j + 1) * (n + 1) + i];
+
+                if (hasHole && inRangeX && j == hz0 - 1) {
+                    // 上边 d-c 与挖空区域相邻
+                    unsigned int m = midBottom[i - hx0];
+                    AddTriangle(out, m, a, b);
+                    AddTriangle(out, m, b, c);
+                    AddTriangle(out, m, d, a);
+                } else if (hasHole && inRangeX && j == hz1) {
+                    // 下边 a-b 与挖空区域相邻
+                    unsigned int m = midTop[i - hx0];
+                    AddTriangle(out, m, b, c);
+                    AddTriangle(out, m, c, d);
+                    AddTriangle(out, m, d, a);
+                } else if (hasHole && inRangeZ && i == hx0 - 1) {
+                    // 右边 b-c 与挖空区域相邻
+                    unsigned int m = midLeft[j - hz0];
+                    AddTriangle(out, m, c, d);
+                    AddTriangle(out, m, d, a);
+                    AddTriangle(out, m, a, b);
+                } else if (hasHole && inRangeZ && i == hx1) {
+                    // 左边 d-a 与挖空区域相邻
+                    unsigned int m = midRight[j - hz0];
+                    AddTriangle(out, m, a, b);
+                    AddTriangle(out, m, b, c);
+                    AddTriangle(out, m, c, d);
+                } else {
+                    // 普通格子：与 WaterPlane 相同的两个三角形
+                    AddTriangle(out, a, d, b);
+                    AddTriangle(out, b, d, c);
+                }
+            }
+        }
+
+        level.blockIndexOffset[block] = static_cast<int>(blockStart - m_Indices.data());
+        level.blockIndexCount[block] = static_cast<int>(out - blockStart);
+    }
+
+    if (next != static_cast<unsigned int>(level.vertexOffset + level.vertexCount) ||
+        out != m_Indices.data() + level.indexOffset + level.indexCount) {
+        LOG_ERROR("错误：水面第 " << levelIndex << " 层的顶点/索引数量与预期不符");
+    }
+
+    level.built = true;
+}
+
+// ========================================
+// 添加三角形
+// ========================================
+// 从上方看逆时针（与 WaterPlane 的三角形朝向一致，背面剔除不会剔掉）
+// ========================================
+void WaterClipmap::AddTriangle(unsigned int*& out, unsigned int a, unsigned int b, unsigned int c) const
+{
+    const Vector3& pa = m_Vertices[a].Position;
+    const Vector3& pb = m_Vertices[b].Position;
+    const Vector3& pc = m_Vertices[c].Position;
+
+    // 法向量的Y分量 = (b-a) × (c-a) 的Y分量
+    float crossY = (pb.z - pa.z) * (pc.x - pa.x) - (pb.x - pa.x) * (pc.z - pa.z);
+    if (crossY < 0.0f) {
+        std::swap(b, c);
+    }
+
+    *out++ = a;
+    *out++ = b;
+    *out++ = c;
+}
+
+// ========================================
+// 设置OpenGL网格缓冲
+// ========================================
+// 缓冲大小固定，之后相机移动时只用 glBufferSubData 更新变化的层
+// ========================================
+void WaterClipmap::SetupMesh()
+{
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    glGenBuffers(1, &m_VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 m_Vertices.size() * sizeof(Vertex),
+                 m_Vertices.data(),
+                 GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &m_EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 m_Indices.size() * sizeof(unsigned int),
+                 m_Indices.data(),
+                 GL_DYNAMIC_DRAW);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+    m_GpuMemory.Set(m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+
+    // 顶点属性布局与 WaterPlane 相同
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoord));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+
+    LOG_INFO("  - VAO ID: " << m_VAO);
+    LOG_INFO("  - VBO ID: " << m_VBO << " (存储 " << m_Vertices.size() << " 个顶点)");
+    LOG_INFO("  - EBO ID: " << m_EBO << " (存储 " << m_Indices.size() << " 个索引)");
+}
+
+void WaterClipmap::UploadLevel(int levelIndex)
+{
+    const Level& level = m_Levels[levelIndex];
+
+    // 索引缓冲绑定属于VAO状态，先绑定VAO
+    glBindVertexArray(m_VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferSubData(GL_ARRAY_BUFFER,
+                    level.vertexOffset * sizeof(Vertex),
+                    level.vertexCount * sizeof(Vertex),
+                    &m_Vertices[level.vertexOffset]);
+
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                    level.indexOffset * sizeof(unsigned int),
+                    level.indexCount * sizeof(unsigned int),
+                    &m_Indices[level.indexOffset]);
+    PerfCounters::Add(PERF_BYTES_UPLOADED,
+                      level.vertexCount * sizeof(Vertex) + level.indexCount * sizeof(unsigned int));
+
+    glBindVertexArray(0);
+}
+
+// ========================================
+// 渲染水面
+// ========================================
+void WaterClipmap::Render()
+{
+    if (m_VAO == 0) {
+        return;
+    }
+
+    glBindVertexArray(m_VAO);
+    if (m_TileMap == nullptr && m_DrawDistance <= 0.0f) {
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_Indices.size()), GL_UNSIGNED_INT, 0);
+        m_DrawnIndexCount = static_cast<int>(m_Indices.size());
+    } else {
+        BuildDrawList();
+        if (!m_DrawCounts.empty()) {
+            glMultiDrawElements(GL_TRIANGLES, m_DrawCounts.data(), GL_UNSIGNED_INT,
+                                m_DrawOffsets.data(), static_cast<GLsizei>(m_DrawCounts.size()));
+        }
+    }
+    glBindVertexArray(0);
+
+    // 多重绘制只算一次调用
+    PerfCounters::Add(PERF_DRAW_CALLS, m_DrawnIndexCount > 0 ? 1 : 0);
+    PerfCounters::Add(PERF_TRIANGLES, m_DrawnIndexCount / 3);
+}
+
+// ========================================
+// 生成绘制区间
+// ========================================
+// 跳过被地形完全遮住的区块和超出绘制距离的区块；索引相邻的可见区块合并为一个区间
+// ========================================
+void WaterClipmap::BuildDrawList()
+{
+    m_DrawCounts.clear();
+    m_DrawOffsets.clear();
+    m_DrawnIndexCount = 0;
+
+    int blockSize = m_GridSize / BLOCKS_PER_SIDE;
+    int rangeStart = -1;
+    int rangeEnd = -1;
+    for (int l = 0; l < GetLevelCount(); ++l) {
+        const Level& level = m_Levels[l];
+        float cellSize = GetCellSize(l);
+
+        for (int block = 0; block < BLOCK_COUNT; ++block) {
+            int count = level.blockIndexCount[block];
+            if (count == 0) {
+                continue;
+            }
+
+            float minX = (level.originX + (block % BLOCKS_PER_SIDE) * blockSize) * cellSize;
+            float minZ = (level.originZ + (block / BLOCKS_PER_SIDE) * blockSize) * cellSize;
+            float blockExtent = blockSize * cellSize;
+            if (m_TileMap && m_TileMap->IsRegionBuried(minX, minZ, minX + blockExtent, minZ + blockExtent)) {
+                continue;
+            }
+            if (m_DrawDistance > 0.0f) {
+                float dx = std::max(std::max(minX - m_CameraPosition.x, m_CameraPosition.x - minX - blockExtent), 0.0f);
+                float dz = std::max(std::max(minZ - m_CameraPosition.y, m_CameraPosition.y - minZ - blockExtent), 0.0f);
+                if (dx * dx + dz * dz > m_DrawDistance * m_DrawDistance) {
+                    continue;
+                }
+            }
+
+            int offset = level.blockIndexOffset[block];
+            if (offset != rangeEnd) {
+                if (rangeStart >= 0) {
+                    m_DrawCounts.push_back(rangeEnd - rangeStart);
+                    m_DrawOffsets.push_back(reinterpret_cast<const void*>(rangeStart * sizeof(unsigned int)));
+                }
+                rangeStart = offset;
+            }
+            rangeEnd = offset + count;
+            m_DrawnIndexCount += count;
+        }
+    }
+    if (rangeStart >= 0) {
+        m_DrawCounts.push_back(rangeEnd - rangeStart);
+        m_DrawOffsets.push_back(reinterpret_cast<const void*>(rangeStart * sizeof(unsigned int)));
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "nclgl/Vector2.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/MemoryTracker.h"
+#include <vector>
+
+class WaterTileMap;
+
+/**
+ * @class WaterClipmap
+ * @brief 跟随相机的多层级水面网格（Clipmap）
+ *
+ * 功能特性：
+ * - 第0层是以相机为中心的细密网格，之后每一层格子边长翻倍，
+ *   做成中间挖空的“环”，套在上一层外面
+ * - 近处顶点密度高（波浪采样充分），远处稀疏，总顶点数固定
+ * - 每层的原点按本层格子的2倍对齐（吸附），相机移动时网格不会“游动”，
+ *   并且内层的范围正好落在外层的网格线上
+ * - 外层环紧贴内层的那一圈格子额外加入边中点，与内层顶点一一对应，
+ *   波浪位移后也不会出现裂缝（没有T形接缝）
+ * - 每层的顶点/索引数量固定，相机移动时只重新上传原点变化的层
+ * - 每层的三角形按 4×4 个区块排列，设置 WaterTileMap 后，
+ *   完全被地形遮住的区块不绘制（其余区块合并成尽量少的绘制区间）；
+ *   设置绘制距离后，离相机太远的区块也不绘制
+ *
+ * 与 WaterPlane 使用相同的顶点格式和着色器，可以直接替换。
+ */
+class WaterClipmap {
+public:
+    /**
+     * @brief 构造函数 - 创建水面网格
+     * @param waterLevel 水面高度（世界坐标Y值）
+     * @param gridSize 每层每边的格子数（必须是4的倍数且不小于16，如64）
+     * @param levelCount 层数（如7）
+     * @param baseCellSize 第0层的格子边长（如0.25）
+     *
+     * 覆盖范围（边长）= gridSize × baseCellSize × 2^(levelCount-1)
+     */
+    WaterClipmap(float waterLevel, int gridSize, int levelCount, float baseCellSize);
+
+    /**
+     * @brief 析构函数 - 释放OpenGL资源
+     */
+    ~WaterClipmap();
+
+    /**
+     * @brief 跟随相机移动网格
+     * @param cameraPosition 相机位置（只用X和Z）
+     *
+     * 只有吸附后的原点发生变化的层才会重建并上传
+     */
+    void Update(const Vector3& cameraPosition);
+
+    /**
+     * @brief 渲染水面（调用前的要求与 WaterPlane::Render 相同）
+     */
+    void Render();
+
+    /**
+     * @brief 设置地形遮挡分块（nullptr = 不剔除）
+     *
+     * 设置后每次 Render 都按当前分类结果剔除区块，地形编辑后无需重新设置
+     */
+    void SetTileMap(const WaterTileMap* tileMap) { m_TileMap = tileMap; }
+
+    /**
+     * @brief 设置绘制距离：与最近一次 Update 的相机水平距离超过它的区块不绘制
+     * @param distance 世界单位，<= 0 表示不限（默认）
+     */
+    void SetDrawDistance(float distance) { m_DrawDistance = distance; }
+
+    /**
+     * @brief 获取水面高度
+     */
+    float GetWaterLevel() const { return m_WaterLevel; }
+
+    /**
+     * @brief 统计信息
+     */
+    int GetLevelCount() const { return static_cast<int>(m_Levels.size()); }
+    int GetVertexCount() const { return static_cast<int>(m_Vertices.size()); }
+    int GetTriangleCount() const { return static_cast<int>(m_Indices.size() / 3); }
+    int GetDrawnTriangleCount() const { return m_DrawnIndexCount / 3; }   // 上一次 Render 实际绘制的
+    float GetCellSize(int level) const { return m_BaseCellSize * static_cast<float>(1 << level); }
+    float GetExtent() const { return m_GridSize * GetCellSize(GetLevelCount() - 1); }
+
+    /**
+     * @brief 某一层的原点（最小X/Z角，世界坐标）
+     */
+    Vector2 GetLevelOrigin(int level) const;
+
+private:
+    // OpenGL对象
+    unsigned int m_VAO;
+    unsigned int m_VBO;
+    unsigned int m_EBO;
+
+    // 参数
+    float m_WaterLevel;
+    int m_GridSize;
+    float m_BaseCellSize;
+
+    // 顶点结构体（与 WaterPlane 相同）
+    struct Vertex {
+        Vector3 Position;
+        Vector3 Normal;
+        Vector2 TexCoord;
+    };
+
+    // 每层每边的区块数（剔除的最小单位）
+    static const int BLOCKS_PER_SIDE = 4;
+    static const int BLOCK_COUNT = BLOCKS_PER_SIDE * BLOCKS_PER_SIDE;
+
+    // 每一层在顶点/索引数组中的位置（数量固定，位置固定）
+    struct Level {
+        int originX;        // 原点（以本层格子为单位）
+        int originZ;
+        bool built;
+        int vertexOffset;
+        int vertexCount;
+        int indexOffset;
+        int indexCount;
+        // 各区块的索引区间（随挖空位置变化，BuildLevel 时记录）
+        int blockIndexOffset[BLOCK_COUNT];
+        int blockIndexCount[BLOCK_COUNT];
+    };
+
+    std::vector<Level> m_Levels;
+    std::vector<Vertex> m_Vertices;
+    std::vector<unsigned int> m_Indices;
+
+    // 地形遮挡剔除和距离剔除
+    const WaterTileMap* m_TileMap;
+    float m_DrawDistance;
+    Vector2 m_CameraPosition;   // 最近一次 Update 的相机 X/Z
+    std::vector<GLsizei> m_DrawCounts;
+    std::vector<const void*> m_DrawOffsets;
+    int m_DrawnIndexCount;
+
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+
+    /**
+     * @brief 计算相机位置对应的吸附原点（以本层格子为单位，2的倍数）
+     */
+    void ComputeOrigin(int level, const Vector3& cameraPosition, int& originX, int& originZ) const;
+
+    /**
+     * @brief 生成一层的顶点和索引（写入该层固定的区域）
+     *
+     * 第0层是完整网格；其它层挖掉内层覆盖的区域，
+     * 并在与内层相邻的格子中加入边中点
+     */
+    void BuildLevel(int level);
+
+    /**
+     * @brief 添加一个三角形（保证从上方看是逆时针，与背面剔除一致）
+     */
+    void AddTriangle(unsigned int*& out, unsigned int a, unsigned int b, unsigned int c) const;
+
+    /**
+     * @brief 设置OpenGL缓冲对象（按最终大小分配，之后只做局部更新）
+     */
+    void SetupMesh();
+
+    /**
+     * @brief 上传一层的顶点和索引
+     */
+    void UploadLevel(int level);
+
+    /**
+     * @brief 按地形遮挡和绘制距离生成本帧的绘制区间
+     */
+    void BuildDrawList();
+};
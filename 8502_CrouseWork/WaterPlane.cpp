@@ -1,5 +1,6 @@
 #include "WaterPlane.h"
-#include <iostream>
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
 
 // ========================================
 // 构造函数 - 创建水平面对象
@@ -12,32 +13,34 @@ WaterPlane::WaterPlane(float waterLevel, float size, int resolution)
     , m_Size(size)
     , m_Resolution(resolution)
     , m_IndexCount(0)
+    , m_CpuMemory(MEMORY_WATER, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_WATER, MEMORY_GPU_BUFFER)
 {
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "开始创建水面..." << std::endl;
-    std::cout << "========================================" << std::endl;
-    std::cout << "  水面高度: Y = " << m_WaterLevel << std::endl;
-    std::cout << "  水面大小: " << m_Size << " x " << m_Size << std::endl;
-    std::cout << "  网格分辨率: " << m_Resolution << " x " << m_Resolution << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("开始创建水面...");
+    LOG_INFO("========================================");
+    LOG_INFO("  水面高度: Y = " << m_WaterLevel);
+    LOG_INFO("  水面大小: " << m_Size << " x " << m_Size);
+    LOG_INFO("  网格分辨率: " << m_Resolution << " x " << m_Resolution);
 
     // ========================================
     // 步骤1：生成网格数据
     // ========================================
-    std::cout << "\n[步骤1] 生成水面网格..." << std::endl;
+    LOG_INFO("\n[步骤1] 生成水面网格...");
     GenerateMesh();
-    std::cout << "✓ 生成了 " << m_Vertices.size() << " 个顶点" << std::endl;
-    std::cout << "✓ 生成了 " << m_Indices.size() / 3 << " 个三角形" << std::endl;
+    LOG_INFO("✓ 生成了 " << m_Vertices.size() << " 个顶点");
+    LOG_INFO("✓ 生成了 " << m_Indices.size() / 3 << " 个三角形");
 
     // ========================================
     // 步骤2：设置OpenGL缓冲对象
     // ========================================
-    std::cout << "\n[步骤2] 创建GPU缓冲对象..." << std::endl;
+    LOG_INFO("\n[步骤2] 创建GPU缓冲对象...");
     SetupMesh();
-    std::cout << "✓ VAO/VBO/EBO创建成功" << std::endl;
+    LOG_INFO("✓ VAO/VBO/EBO创建成功");
 
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "水面创建完成！" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("水面创建完成！");
+    LOG_INFO("========================================\n");
 }
 
 // ========================================
@@ -53,7 +56,7 @@ WaterPlane::~WaterPlane()
     if (m_EBO != 0)
         glDeleteBuffers(1, &m_EBO);
 
-    std::cout << "水面对象已销毁，GPU资源已释放" << std::endl;
+    LOG_INFO("水面对象已销毁，GPU资源已释放");
 }
 
 // ========================================
@@ -183,6 +186,10 @@ void WaterPlane::SetupMesh()
                  m_Indices.data(),
                  GL_STATIC_DRAW);
 
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+    m_CpuMemory.Set(VectorBytes(m_Vertices) + VectorBytes(m_Indices));
+    m_GpuMemory.Set(m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(unsigned int));
+
     // ========================================
     // 步骤4：配置顶点属性指针
     // ========================================
@@ -227,9 +234,9 @@ void WaterPlane::SetupMesh()
     // ========================================
     glBindVertexArray(0);
 
-    std::cout << "  - VAO ID: " << m_VAO << std::endl;
-    std::cout << "  - VBO ID: " << m_VBO << " (存储 " << m_Vertices.size() << " 个顶点)" << std::endl;
-    std::cout << "  - EBO ID: " << m_EBO << " (存储 " << m_Indices.size() << " 个索引)" << std::endl;
+    LOG_INFO("  - VAO ID: " << m_VAO);
+    LOG_INFO("  - VBO ID: " << m_VBO << " (存储 " << m_Vertices.size() << " 个顶点)");
+    LOG_INFO("  - EBO ID: " << m_EBO << " (存储 " << m_Indices.size() << " 个索引)");
 }
 
 // ========================================
@@ -244,7 +251,7 @@ void WaterPlane::Render()
 {
     // 安全检查：确保VAO已经创建
     if (m_VAO == 0) {
-        std::cerr << "错误：水面VAO未初始化，无法渲染！" << std::endl;
+        LOG_ERROR_LIMITED("错误：水面VAO未初始化，无法渲染！");
         return;
     }
 
@@ -253,6 +260,8 @@ void WaterPlane::Render()
 
     // 使用索引绘制三角形
     glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, 0);
+    PerfCounters::Add(PERF_DRAW_CALLS);
+    PerfCounters::Add(PERF_TRIANGLES, m_IndexCount / 3);
 
     // 解绑VAO
     glBindVertexArray(0);
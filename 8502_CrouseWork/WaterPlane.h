@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include "nclgl/Vector2.h"
 #include "nclgl/Vector3.h"
+#include "nclgl/MemoryTracker.h"
 #include <vector>
 
 /**
@@ -78,6 +79,10 @@ private:
     std::vector<Vertex> m_Vertices;         // 顶点数组
     std::vector<unsigned int> m_Indices;    // 索引数组
 
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+
     /**
      * @brief 生成水面网格数据
      *
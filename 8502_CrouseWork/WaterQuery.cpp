@@ -0,0 +1,171 @@
+#include "WaterQuery.h"
+#include "OceanFFT.h"
+#include <emmintrin.h>  // SSE2（x64 下始终可用）
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 4个点的双线性采样位置（网格下标 + 权重）
+    struct Footprint
+    {
+        int index00[4], index10[4], index01[4], index11[4];   // 元素下标（已乘通道数4）
+        __m128 fx, fz;
+    };
+
+    __m128 Floor(__m128 v)
+    {
+        __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+        // 负数截断后比原值大，需要再减1
+        __m128 fix = _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.0f));
+        return _mm_sub_ps(truncated, fix);
+    }
+
+    // 与 GL_LINEAR + GL_REPEAT 相同：uv = 世界坐标 / patchSize，像素中心在 (i + 0.5) / N
+    void ComputeFootprint(__m128 px, __m128 pz, float invTexelSize, int N, Footprint& fp)
+    {
+        __m128 scale = _mm_set1_ps(invTexelSize);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 u = _mm_sub_ps(_mm_mul_ps(px, scale), half);
+        __m128 v = _mm_sub_ps(_mm_mul_ps(pz, scale), half);
+        __m128 u0 = Floor(u);
+        __m128 v0 = Floor(v);
+        fp.fx = _mm_sub_ps(u, u0);
+        fp.fz = _mm_sub_ps(v, v0);
+
+        // N 是2的幂，按位与即可平铺（补码的负数也正确）
+        __m128i mask = _mm_set1_epi32(N - 1);
+        __m128i one = _mm_set1_epi32(1);
+        __m128i x0 = _mm_cvttps_epi32(u0);
+        __m128i z0 = _mm_cvttps_epi32(v0);
+        __m128i x1 = _mm_and_si128(_mm_add_epi32(x0, one), mask);
+        __m128i z1 = _mm_and_si128(_mm_add_epi32(z0, one), mask);
+        x0 = _mm_and_si128(x0, mask);
+        z0 = _mm_and_si128(z0, mask);
+
+        alignas(16) int ix0[4], ix1[4], iz0[4], iz1[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(ix0), x0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(ix1), x1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(iz0), z0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(iz1), z1);
+        for (int i = 0; i < 4; ++i)
+        {
+            fp.index00[i] = (iz0[i] * N + ix0[i]) * 4;
+            fp.index10[i] = (iz0[i] * N + ix1[i]) * 4;
+            fp.index01[i] = (iz1[i] * N + ix0[i]) * 4;
+            fp.index11[i] = (iz1[i] * N + ix1[i]) * 4;
+        }
+    }
+
+    __m128 Gather(const float* grid, const int* index, int channel)
+    {
+        return _mm_setr_ps(grid[index[0] + channel], grid[index[1] + channel],
+                           grid[index[2] + channel], grid[index[3] + channel]);
+    }
+
+    // 双线性插值网格的第 channel 个通道
+    __m128 Bilinear(const float* grid, const Footprint& fp, int channel)
+    {
+        __m128 a = Gather(grid, fp.index00, channel);
+        __m128 b = Gather(grid, fp.index10, channel);
+        __m128 c = Gather(grid, fp.index01, channel);
+        __m128 d = Gather(grid, fp.index11, channel);
+        __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fp.fx));
+        __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), fp.fx));
+        return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fp.fz));
+    }
+}
+
+WaterQuery::WaterQuery(const OceanFFT& ocean, float waterLevel, int iterations)
+    : m_Ocean(ocean)
+    , m_WaterLevel(waterLevel)
+    , m_Iterations(std::max(iterations, 0))
+{
+}
+
+void WaterQuery::Query(const float* x, const float* z, int count, Sample* samples) const
+{
+    int full = count / 4 * 4;
+    for (int i = 0; i < full; i += 4)
+        Query4(x + i, z + i, samples + i, 4);
+
+    // 剩余不足4个：复制到临时数组，用最后一个点补齐
+    int rest = count - full;
+    if (rest > 0)
+    {
+        float px[4], pz[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            int source = full + std::min(i, rest - 1);
+            px[i] = x[source];
+            pz[i] = z[source];
+        }
+        Query4(px, pz, samples + full, rest);
+    }
+}
+
+WaterQuery::Sample WaterQuery::Query(float x, float z) const
+{
+    Sample sample;
+    Query(&x, &z, 1, &sample);
+    return sample;
+}
+
+void WaterQuery::Query4(const float* x, const float* z, Sample* samples, int validCount) const
+{
+    const float* displacement = m_Ocean.GetDisplacement().data();
+    const float* previous = m_Ocean.GetPreviousDisplacement().data();
+    const float* normalFoam = m_Ocean.GetNormalFoam().data();
+    int N = m_Ocean.GetResolution();
+    float invTexelSize = N / m_Ocean.GetPatchSize();
+
+    __m128 targetX = _mm_loadu_ps(x);
+    __m128 targetZ = _mm_loadu_ps(z);
+    __m128 px = targetX;
+    __m128 pz = targetZ;
+    Footprint fp;
+
+    // 反解水平位移：p ← x - D(p)
+    for (int i = 0; i < m_Iterations; ++i)
+    {
+        ComputeFootprint(px, pz, invTexelSize, N, fp);
+        px = _mm_sub_ps(targetX, Bilinear(displacement, fp, 0));
+        pz = _mm_sub_ps(targetZ, Bilinear(displacement, fp, 2));
+    }
+    ComputeFootprint(px, pz, invTexelSize, N, fp);
+
+    __m128 dx = Bilinear(displacement, fp, 0);
+    __m128 h  = Bilinear(displacement, fp, 1);
+    __m128 dz = Bilinear(displacement, fp, 2);
+
+    // 速度：两次 Update 之间的位移差
+    float dt = m_Ocean.GetTime() - m_Ocean.GetPreviousTime();
+    __m128 invDt = _mm_set1_ps(dt > 1e-6f ? 1.0f / dt : 0.0f);
+    __m128 vx = _mm_mul_ps(_mm_sub_ps(dx, Bilinear(previous, fp, 0)), invDt);
+    __m128 vy = _mm_mul_ps(_mm_sub_ps(h, Bilinear(previous, fp, 1)), invDt);
+    __m128 vz = _mm_mul_ps(_mm_sub_ps(dz, Bilinear(previous, fp, 2)), invDt);
+
+    // 法线：与片段着色器一样插值后再归一化
+    __m128 nx = Bilinear(normalFoam, fp, 0);
+    __m128 ny = Bilinear(normalFoam, fp, 1);
+    __m128 nz = Bilinear(normalFoam, fp, 2);
+    __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+    __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq));
+    nx = _mm_mul_ps(nx, invLength);
+    ny = _mm_mul_ps(ny, invLength);
+    nz = _mm_mul_ps(nz, invLength);
+
+    __m128 height = _mm_add_ps(h, _mm_set1_ps(m_WaterLevel));
+
+    float out[7][4];
+    __m128 values[7] = { height, nx, ny, nz, vx, vy, vz };
+    for (int c = 0; c < 7; ++c)
+        _mm_storeu_ps(out[c], values[c]);
+
+    for (int i = 0; i < validCount; ++i)
+    {
+        samples[i].height = out[0][i];
+        samples[i].normal = Vector3(out[1][i], out[2][i], out[3][i]);
+        samples[i].velocity = Vector3(out[4][i], out[5][i], out[6][i]);
+    }
+}
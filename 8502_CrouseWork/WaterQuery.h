@@ -0,0 +1,63 @@
+#ifndef WATER_QUERY_H
+#define WATER_QUERY_H
+
+#include "nclgl/Vector3.h"
+
+class OceanFFT;
+
+// ========================================
+// 水面高度查询（CPU）
+// ========================================
+// 功能：
+// 1. 给漂浮物、浮力计算等提供与GPU绘制一致的水面：
+//    高度、法线、水面速度
+// 2. 直接读取 OceanFFT 的位移/法线网格，采样方式与水面着色器相同
+//    （GL_REPEAT + 双线性，纹理像素中心在 (i + 0.5) 处）
+// 3. 批量查询：SSE 一次处理4个点
+//
+// 水平位移的处理：
+// 着色器把网格点 p 移到 p + D(p)，所以世界坐标 x 处的水面
+// 来自满足 p + D(p) = x 的那个 p。用不动点迭代 p ← x - D(p) 求解，
+// 波浪不折叠（雅可比 > 0）时几次就收敛
+//
+// 速度：同一个 p 在 OceanFFT 最近两次 Update 之间的位移差 / 时间差
+// ========================================
+
+class WaterQuery
+{
+public:
+    struct Sample
+    {
+        float height;       // 水面高度（世界坐标Y）
+        Vector3 normal;     // 水面法线（单位向量）
+        Vector3 velocity;   // 水面质点速度（单位/秒）
+    };
+
+    // iterations - 反解水平位移的迭代次数（0 = 忽略水平位移）
+    WaterQuery(const OceanFFT& ocean, float waterLevel, int iterations = 3);
+
+    // ========================================
+    // 批量查询
+    // ========================================
+    // x, z    - count 个点的世界坐标
+    // samples - 输出，count 个
+    // ========================================
+    void Query(const float* x, const float* z, int count, Sample* samples) const;
+
+    // 单点查询
+    Sample Query(float x, float z) const;
+    float GetHeight(float x, float z) const { return Query(x, z).height; }
+
+    void SetWaterLevel(float waterLevel) { m_WaterLevel = waterLevel; }
+    float GetWaterLevel() const { return m_WaterLevel; }
+
+private:
+    const OceanFFT& m_Ocean;
+    float m_WaterLevel;
+    int m_Iterations;
+
+    // 查询4个点（SSE）
+    void Query4(const float* x, const float* z, Sample* samples, int validCount) const;
+};
+
+#endif // WATER_QUERY_H
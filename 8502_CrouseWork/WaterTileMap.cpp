@@ -0,0 +1,218 @@
+#include "WaterTileMap.h"
+#include "nclgl/Log.h"
+#include "nclgl/PerfCounters.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+WaterTileMap::WaterTileMap(const Terrain& terrain, float waterLevel, float margin, int tileCells)
+    : m_WaterLevel(waterLevel)
+    , m_Margin(std::max(margin, 0.0f))
+    , m_TileCells(tileCells)
+    , m_Width(terrain.GetWidth())
+    , m_Height(terrain.GetHeight())
+    , m_TerrainSize(terrain.GetTerrainSize())
+    , m_TilesX(0)
+    , m_TilesZ(0)
+    , m_MaskTexture(0)
+    , m_CpuMemory(MEMORY_WATER, MEMORY_CPU)
+    , m_GpuMemory(MEMORY_WATER, MEMORY_GPU_TEXTURE)
+{
+    if (m_TileCells < 1)
+    {
+        LOG_ERROR("错误：水面分块大小必须大于0，已改为32");
+        m_TileCells = 32;
+    }
+
+    // 每块覆盖 tileCells 个格子（tileCells + 1 个采样点，相邻块共用边界）
+    m_TilesX = std::max(1, (m_Width - 1 + m_TileCells - 1) / m_TileCells);
+    m_TilesZ = std::max(1, (m_Height - 1 + m_TileCells - 1) / m_TileCells);
+    m_States.assign(static_cast<size_t>(m_TilesX) * m_TilesZ, TileState::Open);
+    m_Mask.assign(static_cast<size_t>(m_Width) * m_Height, 255);
+    m_CpuMemory.Set(VectorBytes(m_States) + VectorBytes(m_Mask));
+
+    Classify(terrain);
+
+    LOG_INFO("✓ 水面分块: " << m_TilesX << "×" << m_TilesZ
+             << "（可见 " << CountTiles(TileState::Open)
+             << "，岸线 " << CountTiles(TileState::Shoreline)
+             << "，被地形遮住 " << CountTiles(TileState::Buried) << "）");
+}
+
+WaterTileMap::~WaterTileMap()
+{
+    if (m_MaskTexture != 0)
+        glDeleteTextures(1, &m_MaskTexture);
+}
+
+void WaterTileMap::Classify(const Terrain& terrain)
+{
+    ClassifyRegion(terrain, 0, 0, m_Width - 1, m_Height - 1);
+}
+
+void WaterTileMap::ClassifyRegion(const Terrain& terrain, int x0, int z0, int x1, int z1)
+{
+    if (terrain.GetWidth() != m_Width || terrain.GetHeight() != m_Height)
+        return;
+
+    // 边界上的采样点属于两侧的块，所以范围各外扩一格
+    int tx0 = std::max(0, (x0 - 1) / m_TileCells);
+    int tz0 = std::max(0, (z0 - 1) / m_TileCells);
+    int tx1 = std::min(m_TilesX - 1, x1 / m_TileCells);
+    int tz1 = std::min(m_TilesZ - 1, z1 / m_TileCells);
+    if (tx0 > tx1 || tz0 > tz1)
+        return;
+
+    for (int tz = tz0; tz <= tz1; ++tz)
+    {
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            ClassifyTile(terrain, tx, tz);
+        }
+    }
+
+    if (m_MaskTexture != 0)
+    {
+        UploadRegion(tx0 * m_TileCells, tz0 * m_TileCells,
+                     std::min(m_Width - 1, (tx1 + 1) * m_TileCells),
+                     std::min(m_Height - 1, (tz1 + 1) * m_TileCells));
+    }
+}
+
+// ========================================
+// 分类一块并写入遮罩
+// ========================================
+// 遮罩只取决于每个采样点的高度，相邻块共用的边界点两边写入的值相同
+// ========================================
+void WaterTileMap::ClassifyTile(const Terrain& terrain, int tx, int tz)
+{
+    const std::vector<float>& heights = terrain.GetHeightData();
+    float heightScale = terrain.GetHeightScale();
+    float threshold = m_WaterLevel + m_Margin;
+
+    int x0 = tx * m_TileCells;
+    int z0 = tz * m_TileCells;
+    int x1 = std::min(m_Width - 1, x0 + m_TileCells);
+    int z1 = std::min(m_Height - 1, z0 + m_TileCells);
+
+    int above = 0;
+    int below = 0;
+    for (int z = z0; z <= z1; ++z)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            size_t index = static_cast<size_t>(z) * m_Width + x;
+            float height = heights[index] * heightScale;
+            if (height < threshold)
+            {
+                m_Mask[index] = 255;
+                ++below;
+            }
+            else
+            {
+                m_Mask[index] = 0;
+                ++above;
+            }
+        }
+    }
+
+    TileState state = TileState::Shoreline;
+    if (below == 0)
+        state = TileState::Buried;
+    else if (above == 0)
+        state = TileState::Open;
+    m_States[tz * m_TilesX + tx] = state;
+}
+
+bool WaterTileMap::IsRegionBuried(float minX, float minZ, float maxX, float maxZ) const
+{
+    float half = m_TerrainSize * 0.5f;
+    minX -= m_Margin;
+    minZ -= m_Margin;
+    maxX += m_Margin;
+    maxZ += m_Margin;
+    if (minX < -half || minZ < -half || maxX > half || maxZ > half)
+        return false;
+
+    // 世界坐标 → 网格坐标 → 块
+    float toGridX = (m_Width - 1) / m_TerrainSize;
+    float toGridZ = (m_Height - 1) / m_TerrainSize;
+    int tx0 = static_cast<int>(std::floor((minX + half) * toGridX / m_TileCells));
+    int tz0 = static_cast<int>(std::floor((minZ + half) * toGridZ / m_TileCells));
+    int tx1 = static_cast<int>(std::floor((maxX + half) * toGridX / m_TileCells));
+    int tz1 = static_cast<int>(std::floor((maxZ + half) * toGridZ / m_TileCells));
+    tx0 = std::max(0, tx0);
+    tz0 = std::max(0, tz0);
+    tx1 = std::min(m_TilesX - 1, tx1);
+    tz1 = std::min(m_TilesZ - 1, tz1);
+
+    for (int tz = tz0; tz <= tz1; ++tz)
+    {
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            if (m_States[tz * m_TilesX + tx] != TileState::Buried)
+                return false;
+        }
+    }
+    return true;
+}
+
+int WaterTileMap::CountTiles(TileState state) const
+{
+    return static_cast<int>(std::count(m_States.begin(), m_States.end(), state));
+}
+
+// ========================================
+// 遮罩纹理
+// ========================================
+// 网格点 i 在世界坐标 i / (W-1) × size - size/2，对应纹理像素中心 (i + 0.5) / W
+// ========================================
+Vector4 WaterTileMap::GetMaskTransform() const
+{
+    float half = m_TerrainSize * 0.5f;
+    float scaleX = (m_Width - 1) / (m_TerrainSize * m_Width);
+    float scaleZ = (m_Height - 1) / (m_TerrainSize * m_Height);
+    return Vector4(scaleX, scaleZ,
+                   half * scaleX + 0.5f / m_Width,
+                   half * scaleZ + 0.5f / m_Height);
+}
+
+void WaterTileMap::UploadMask()
+{
+    if (m_MaskTexture == 0)
+        glGenTextures(1, &m_MaskTexture);
+
+    glBindTexture(GL_TEXTURE_2D, m_MaskTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_Width, m_Height, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, m_Mask.data());
+    PerfCounters::Add(PERF_BYTES_UPLOADED, m_Mask.size());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_GpuMemory.Set(MemoryTracker::TextureBytes(m_Width, m_Height, 1, 1, false));
+}
+
+void WaterTileMap::UploadRegion(int x0, int z0, int x1, int z1)
+{
+    glBindTexture(GL_TEXTURE_2D, m_MaskTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_Width);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x0, z0, x1 - x0 + 1, z1 - z0 + 1, GL_RED, GL_UNSIGNED_BYTE,
+                    &m_Mask[static_cast<size_t>(z0) * m_Width + x0]);
+    PerfCounters::Add(PERF_BYTES_UPLOADED, static_cast<long long>(x1 - x0 + 1) * (z1 - z0 + 1));
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void WaterTileMap::BindMask(unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, m_MaskTexture);
+    glActiveTexture(GL_TEXTURE0);
+    PerfCounters::Add(PERF_TEXTURE_BINDS);
+}
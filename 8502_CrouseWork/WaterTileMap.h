@@ -0,0 +1,96 @@
+#ifndef WATER_TILE_MAP_H
+#define WATER_TILE_MAP_H
+
+#include <glad/glad.h>
+#include "nclgl/Vector4.h"
+#include "nclgl/MemoryTracker.h"
+#include <vector>
+
+class Terrain;
+
+// ========================================
+// 水面分块可见性（按地形遮挡）
+// ========================================
+// 功能：
+// 1. 把地形范围划分成固定大小的块，按块内地形的最低/最高点分类：
+//    - Open：     整块地形都在水面以下，水面完整可见
+//    - Shoreline：块内既有高于水面也有低于水面的地形（岸线）
+//    - Buried：   整块地形都高于水面，水面被完全遮住，不需要绘制
+//    地形范围以外一律视为 Open
+// 2. 岸线块额外计算逐像素遮罩（与高度图同分辨率，R8）：
+//    地形低于水面的像素 = 255，其余 = 0；
+//    水面片段着色器先采样遮罩，为 0 直接 discard，跳过反射/混合
+// 3. 分类时水面高度加上 margin（波浪最大高度），
+//    保证波峰也不会被错误剔除
+//
+// 地形编辑后调用 ClassifyRegion 只更新受影响的块
+// ========================================
+
+class WaterTileMap
+{
+public:
+    enum class TileState : unsigned char
+    {
+        Open,
+        Shoreline,
+        Buried
+    };
+
+    // tileCells - 每块边长（高度图格子数）
+    WaterTileMap(const Terrain& terrain, float waterLevel, float margin, int tileCells = 32);
+    ~WaterTileMap();
+
+    // 重新分类全部块 / 与高度图区域 [x0, x1] × [z0, z1] 相交的块
+    void Classify(const Terrain& terrain);
+    void ClassifyRegion(const Terrain& terrain, int x0, int z0, int x1, int z1);
+
+    // ========================================
+    // 世界坐标矩形是否完全被地形遮住（覆盖的块全部 Buried）
+    // ========================================
+    // 超出地形范围的部分视为水面可见；矩形会再外扩 margin（水平位移）
+    // ========================================
+    bool IsRegionBuried(float minX, float minZ, float maxX, float maxZ) const;
+
+    int GetTileCountX() const { return m_TilesX; }
+    int GetTileCountZ() const { return m_TilesZ; }
+    TileState GetTileState(int tx, int tz) const { return m_States[tz * m_TilesX + tx]; }
+    int CountTiles(TileState state) const;
+
+    // ========================================
+    // 遮罩纹理
+    // ========================================
+    // 着色器中：uv = 世界坐标.xz × transform.xy + transform.zw，
+    // uv 超出 [0, 1] 时视为可见
+    // ========================================
+    void UploadMask();
+    void BindMask(unsigned int unit) const;
+    bool IsUploaded() const { return m_MaskTexture != 0; }
+    Vector4 GetMaskTransform() const;
+    const std::vector<unsigned char>& GetMask() const { return m_Mask; }
+
+private:
+    float m_WaterLevel;
+    float m_Margin;
+    int m_TileCells;
+
+    // 地形参数（世界坐标 = 网格坐标 / (尺寸-1) × terrainSize - terrainSize/2）
+    int m_Width;
+    int m_Height;
+    float m_TerrainSize;
+
+    int m_TilesX;
+    int m_TilesZ;
+    std::vector<TileState> m_States;
+    std::vector<unsigned char> m_Mask;
+
+    GLuint m_MaskTexture;
+
+    // 内存统计
+    TrackedMemory m_CpuMemory;
+    TrackedMemory m_GpuMemory;
+
+    void ClassifyTile(const Terrain& terrain, int tx, int tz);
+    void UploadRegion(int x0, int z0, int x1, int z1);
+};
+
+#endif // WATER_TILE_MAP_H
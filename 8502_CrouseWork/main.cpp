@@ -8,69 +8,490 @@
  *   左Shift   - 向下移动
  *   鼠标移动  - 环顾四周
  *   滚轮      - 缩放视野
+ *   E         - 开始/暂停地形侵蚀
+ *   R / F     - 抬高 / 降低视线落点处的地形（按住）
+ *   T / G     - 压平 / 平滑视线落点处的地形（按住）
+ *   Q         - 在视线落点处倒水（按住）
+ *   M         - 输出各部分的内存/显存用量
+ *   O         - 显示/隐藏性能计数器叠加层
  *   ESC       - 退出程序
+ *
+ * 命令行参数（基准测试）：
+ *   --benchmark [帧数]  相机沿脚本路径飞行指定帧数（默认 1000），
+ *                       输出帧时间统计和 CSV 后退出
+ *                       （没有窗口和显卡时用 Benchmarks 的 --flythrough，
+ *                       同样的路径和统计，只测 CPU，见 Benchmarks/Flythrough.h）
+ *   --warmup 帧数       正式记录前的预热帧数（默认 60）
+ *   --path 文件         相机路径文件（默认绕地形一圈，格式见 CameraPath.h）
+ *   --csv 文件          每帧明细输出文件（基准测试默认 benchmark.csv）
+ *
+ * 命令行参数（输入录制 / 回放）：
+ *   --record 文件       把每帧的键盘鼠标状态和帧时间录制到文件
+ *   --replay 文件       回放录制的输入：每帧看到的输入和帧时间与录制时完全相同，
+ *                       回放结束后输出帧时间统计（指定 --csv 时同时写出明细）后退出
+ *
+ *   --serial            关闭帧流水线：UpdateScene 和 RenderScene 依次执行
+ *                       （默认下一帧的模拟与这一帧的渲染同时进行，见 FramePipeline.h），
+ *                       配合 --benchmark 对比两种方式的帧时间
+ *   --release-cpu-copies 上传到GPU后释放地形顶点/索引等CPU副本，减少内存占用
+ *                       （之后编辑或侵蚀地形时整体重建，会变慢）
+ *   --log-level 级别    只输出该级别及以上的日志：debug / info / warning / error
+ *                       （debug 消息只在 Debug 构建中编译进来，见 nclgl/Log.h）
+ *   --profile [次数]    子系统基准测试：地形构建（高度图和 1025×1025 噪声地形）
+ *                       和网格文件解析各执行指定次数（默认 5），输出每个阶段的
+ *                       时间；Linux 上能打开硬件计数器时同时输出 IPC 和
+ *                       每个顶点的缓存/分支预测失败次数（见 nclgl/HardwareCounters.h）
+ *   --counters 文件     退出时把每帧的性能计数器（绘制调用、三角形、状态切换、
+ *                       上传字节数等）写到文件：.json 结尾写 JSON，否则写 CSV
+ *   --governor [毫秒]   开启帧时间预算控制器（默认目标 16 毫秒）：按测得的 CPU / GPU
+ *                       时间调整渲染分辨率、地形 LOD、水面网格密度和绘制距离
+ *                       （见 FrameGovernor.h），调整时输出日志，叠加层多一行状态；
+ *                       可以和 --benchmark / --replay 一起用，看它能否守住预算
+ *
+ * 命令行参数（派生数据缓存，见 nclgl/DerivedDataCache.h）：
+ *   从高度图生成的地形网格、解码后的纹理和 Mipmap、天空盒、地形烘焙贴图
+ *   按源文件内容、参数和代码版本存进缓存目录，下次启动直接读取
+ *   --cache-dir 目录    缓存目录（默认 DerivedDataCache）
+ *   --cache-size MB     缓存大小上限，超出时删除最久没用到的项（默认 1024）
+ *   --no-cache          不使用缓存，每次都重新生成
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include "nclgl/Window.h"
+#include "nclgl/InputRecorder.h"
+#include "nclgl/DerivedDataCache.h"
+#include "nclgl/HardwareCounters.h"
+#include "nclgl/JobSystem.h"
+#include "nclgl/Log.h"
+#include "nclgl/MemoryTracker.h"
+#include "nclgl/Mesh.h"
+#include "nclgl/common.h"
+#include "nclgl/PerfCounters.h"
 #include "Renderer.h"
+#include "CameraPath.h"
+#include "FrameGovernor.h"
+#include "FramePipeline.h"
+#include "FrameTimeRecorder.h"
+#include "GpuTimer.h"
 
 // 窗口尺寸
 const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 720;
 
+// ========================================
+// 命令行参数
+// ========================================
+struct LaunchOptions {
+    bool benchmark = false;
+    int frames = 1000;
+    int warmup = 60;
+    std::string pathFile;
+    std::string csvFile;
+    std::string recordFile;
+    std::string replayFile;
+    bool serial = false;
+    bool releaseCpuCopies = false;
+    LogLevel logLevel = LOG_LEVEL_DEBUG;
+    std::string countersFile;
+    int profileRepeats = 0;     // > 0 时运行子系统基准测试
+    float governorMs = 0.0f;    // > 0 时开启帧时间预算控制器
+    std::string cacheDirectory = "DerivedDataCache";   // 空 = 不使用派生数据缓存
+    int cacheSizeMb = 1024;
+};
+
+static bool ParseLogLevel(const char* name, LogLevel& level) {
+    const char* names[] = { "debug", "info", "warning", "error" };
+    for (int i = 0; i < 4; ++i) {
+        if (std::strcmp(name, names[i]) == 0) {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ParseArguments(int argc, char** argv, LaunchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--benchmark") == 0) {
+            options.benchmark = true;
+            // 帧数可以省略
+            if (hasValue && std::atoi(argv[i + 1]) > 0) {
+                options.frames = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--path") == 0 && hasValue) {
+            options.pathFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--csv") == 0 && hasValue) {
+            options.csvFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+            options.recordFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+            options.replayFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--serial") == 0) {
+            options.serial = true;
+        } else if (std::strcmp(argv[i], "--release-cpu-copies") == 0) {
+            options.releaseCpuCopies = true;
+        } else if (std::strcmp(argv[i], "--log-level") == 0 && hasValue && ParseLogLevel(argv[i + 1], options.logLevel)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            options.profileRepeats = 5;
+            if (hasValue && std::atoi(argv[i + 1]) > 0) {
+                options.profileRepeats = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--counters") == 0 && hasValue) {
+            options.countersFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--governor") == 0) {
+            options.governorMs = 16.0f;
+            // 目标可以省略
+            if (hasValue && std::atof(argv[i + 1]) > 0.0) {
+                options.governorMs = (float)std::atof(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--cache-dir") == 0 && hasValue) {
+            options.cacheDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--cache-size") == 0 && hasValue) {
+            options.cacheSizeMb = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--no-cache") == 0) {
+            options.cacheDirectory.clear();
+        } else {
+            LOG_ERROR("错误：无法识别的参数 " << argv[i]);
+            return false;
+        }
+    }
+
+    if (!options.recordFile.empty() && !options.replayFile.empty()) {
+        LOG_ERROR("错误：--record 和 --replay 不能同时使用");
+        return false;
+    }
+    if (options.benchmark && !options.replayFile.empty()) {
+        LOG_ERROR("错误：--benchmark 和 --replay 不能同时使用");
+        return false;
+    }
+    return true;
+}
+
+// 内存表格直接写到控制台，先等日志线程写完之前的消息，免得两边交错
+static void PrintMemoryReport() {
+    Log::Flush();
+    MemoryTracker::PrintReport(std::cout);
+}
+
+// ========================================
+// 性能计数器：每帧结束时取快照
+// ========================================
+// 绘制调用等由各模块自己累加；作业系统的统计在这里读出来。
+// 指定了 --counters 时记录每帧的值，叠加层打开时更新显示的文字
+// ========================================
+struct CounterState {
+    int jobsRun = PerfCounters::Register("jobs_run", PERF_COUNTER);
+    int jobSteals = PerfCounters::Register("job_steals", PERF_COUNTER);
+    bool record = false;
+    PerfCounterLog log;
+    std::vector<std::string> overlayLines;
+};
+
+static void EndCounterFrame(CounterState& counters, Renderer& renderer, const FrameGovernor* governor) {
+    // 作业系统给出的是启动以来的总数，直接设置即可，EndFrame 会算出本帧增量
+    JobSystem::Stats stats = JobSystem::Get().GetStats();
+    PerfCounters::Set(counters.jobsRun, (long long)stats.jobsRun);
+    PerfCounters::Set(counters.jobSteals, (long long)stats.steals);
+
+    PerfCounters::EndFrame();
+    if (counters.record) {
+        counters.log.AddFrame();
+    }
+    if (renderer.IsOverlayVisible()) {
+        PerfCounterLog::FormatOverlay(counters.overlayLines);
+        if (governor) {
+            counters.overlayLines.push_back(governor->Describe());
+        }
+        renderer.SetOverlayText(counters.overlayLines);
+    }
+}
+
+// ========================================
+// 执行一帧并计时
+// ========================================
+// CPU 时间分为 UpdateScene 和渲染（发布 + RenderScene，后者包含交换缓冲，
+// 驱动开启垂直同步时会被同步等待拉长）两部分，外加整帧时间；
+// 流水线模式下两部分重叠，整帧时间小于两者之和。GPU 时间晚几帧才能取回。
+// recorder 不为空时记录每帧耗时；governor 不为空时把耗时交给帧时间预算控制器，
+// 画质变了就应用到渲染器（RunFrame 已经返回，没有线程在用场景）
+// ========================================
+static void RunTimedFrame(FramePipeline& pipeline, Renderer& renderer, float msec,
+                          FrameTimeRecorder* recorder, GpuTimer& gpuTimer, FrameGovernor* governor) {
+    // 取回已经完成的 GPU 计时；在途查询满了就等最早的一个
+    int gpuFrame;
+    float gpuMsec;
+    float latestGpuMsec = -1.0f;
+    while (gpuTimer.Poll(gpuFrame, gpuMsec)) {
+        if (recorder) recorder->SetGpuTime(gpuFrame, gpuMsec);
+        latestGpuMsec = gpuMsec;
+    }
+    if (gpuTimer.IsFull() && gpuTimer.Wait(gpuFrame, gpuMsec)) {
+        if (recorder) recorder->SetGpuTime(gpuFrame, gpuMsec);
+        latestGpuMsec = gpuMsec;
+    }
+
+    // UpdateScene 不调用 GL，GPU 计时只包含发布时的上传和渲染
+    gpuTimer.Begin(recorder ? recorder->GetFrameCount() : 0);
+    FramePipeline::Timing timing = pipeline.RunFrame(msec);
+    gpuTimer.End();
+
+    if (recorder) {
+        recorder->AddFrame(timing.updateMs, timing.renderMs, timing.frameMs);
+    }
+    if (governor) {
+        // 控制器要的是 CPU 实际工作的时间，不算交换缓冲时的等待
+        float renderWork = std::max(0.0f, timing.renderMs - renderer.GetLastSwapMs());
+        float cpuMsec = pipeline.IsPipelined() ? std::max(timing.updateMs, renderWork)
+                                               : timing.updateMs + renderWork;
+        if (governor->Update(cpuMsec, latestGpuMsec)) {
+            renderer.ApplyQuality(governor->GetQuality());
+            LOG_INFO("画质调整：" << governor->Describe());
+        }
+    }
+}
+
+// 取回剩下的 GPU 计时，输出统计；指定了文件时写出每帧明细
+static bool FinishTiming(FrameTimeRecorder& recorder, GpuTimer& gpuTimer, const std::string& csvFile) {
+    int gpuFrame;
+    float gpuMsec;
+    while (gpuTimer.Wait(gpuFrame, gpuMsec)) {
+        recorder.SetGpuTime(gpuFrame, gpuMsec);
+    }
+    recorder.PrintSummary();
+    PrintMemoryReport();
+    return csvFile.empty() || recorder.WriteCsv(csvFile);
+}
+
+// ========================================
+// 基准测试：相机沿路径飞行，逐帧记录 CPU / GPU 时间
+// ========================================
+// 每帧按固定的 1/60 秒推进场景（而不是实际经过的时间），
+// 所以每次运行每一帧的相机位置和模拟状态都相同，只有耗时不同
+// ========================================
+static int RunBenchmark(Window& w, Renderer& renderer, const LaunchOptions& options, CounterState& counters,
+                        FrameGovernor* governor) {
+    CameraPath path = CameraPath::CreateOrbit(60.0f, 12.0f);
+    if (!options.pathFile.empty() && !path.LoadFromFile(options.pathFile)) {
+        return -1;
+    }
+    if (!renderer.GetCamera()) {
+        LOG_ERROR("错误：渲染器没有相机，无法运行基准测试");
+        return -1;
+    }
+
+    LOG_INFO("基准测试：预热 " << options.warmup << " 帧，记录 " << options.frames << " 帧（"
+             << (options.serial ? "串行" : "帧流水线") << "）...");
+    renderer.SetInputEnabled(false);
+    const float frameMsec = 1000.0f / 60.0f;
+    FramePipeline pipeline(renderer, !options.serial);
+
+    FrameTimeRecorder recorder(options.frames);
+    GpuTimer gpuTimer;
+
+    int total = options.warmup + options.frames;
+    for (int i = 0; i < total; ++i) {
+        if (!w.UpdateWindow()) {
+            LOG_INFO("窗口已关闭，基准测试提前结束");
+            break;
+        }
+
+        // 预热期间停在起点；正式记录的帧走完整条路径
+        int frame = i - options.warmup;
+        float t = (frame > 0 && options.frames > 1) ? (float)frame / (options.frames - 1) : 0.0f;
+        path.Apply(*renderer.GetCamera(), t);
+
+        if (frame < 0) {
+            pipeline.RunFrame(frameMsec);
+        } else {
+            RunTimedFrame(pipeline, renderer, frameMsec, &recorder, gpuTimer, governor);
+        }
+        EndCounterFrame(counters, renderer, governor);
+    }
+
+    return FinishTiming(recorder, gpuTimer, options.csvFile.empty() ? "benchmark.csv" : options.csvFile) ? 0 : -1;
+}
+
+// ========================================
+// 子系统基准测试：地形构建和网格解析
+// ========================================
+// 各阶段由其中的 ProfileScope 计时；硬件计数器统计整个进程，
+// 所以期间把日志级别调到警告，免得日志线程的输出也算进去
+// ========================================
+static int RunSubsystemProfile(int repeats) {
+    HardwareCounters::Enable();
+    LOG_INFO("子系统基准测试：每项 " << repeats << " 次...");
+    Log::Flush();
+    LogLevel level = Log::GetLevel();
+    Log::SetLevel(LOG_LEVEL_WARNING);
+
+    // 地形：项目自带的高度图，和一张更大的噪声地形（输入固定，结果可比较）
+    TerrainNoise noise(1337);
+    TerrainNoise::Settings noiseSettings;
+    for (int i = 0; i < repeats; ++i) {
+        Terrain shipped(TEXTUREDIR"heightmap.png", 100.0f, 10.0f);
+        Terrain generated(noise, noiseSettings, 1025, 100.0f, 10.0f);
+    }
+
+    // 网格：Meshes 目录下的文本网格文件，从最小的立方体到带骨骼的角色
+    const char* meshes[] = { "Cube.msh", "Sphere.msh", "Capsule.msh", "Role_T.msh" };
+    for (int i = 0; i < repeats; ++i) {
+        for (const char* name : meshes) {
+            delete Mesh::LoadFromMeshFile(name);
+        }
+    }
+
+    Log::SetLevel(level);
+    HardwareCounters::Disable();
+    Log::Flush();
+    ProfileScope::PrintReport(std::cout);
+    return 0;
+}
+
 /*
  * 主函数
  */
-int main() {
+int main(int argc, char** argv) {
     // 设置控制台输出为 UTF-8
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
-    std::cout << "========================================" << std::endl;
-    std::cout << "CSC8502 Coursework - Graphics Demo" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    LOG_INFO("========================================");
+    LOG_INFO("CSC8502 Coursework - Graphics Demo");
+    LOG_INFO("========================================\n");
+
+    LaunchOptions options;
+    if (!ParseArguments(argc, argv, options)) {
+        Log::Shutdown();
+        return -1;
+    }
+    Log::SetLevel(options.logLevel);
+
+    // 作业系统：第一次调用必须在主线程上（主线程专属的 GL 作业靠它识别主线程）
+    LOG_INFO("作业系统：" << JobSystem::Get().GetWorkerCount() << " 个工作线程 + 主线程");
+
+    // 派生数据缓存：打开失败只是每次都重新生成
+    // --profile 测的是各阶段真正的构建时间，不使用缓存
+    if (!options.cacheDirectory.empty() && options.profileRepeats == 0) {
+        DerivedDataCache::Settings cacheSettings;
+        cacheSettings.directory = options.cacheDirectory;
+        cacheSettings.maxBytes = static_cast<uint64_t>(options.cacheSizeMb) << 20;
+        DerivedDataCache& cache = DerivedDataCache::Get();
+        if (cache.Open(cacheSettings)) {
+            LOG_INFO("✓ 派生数据缓存：" << options.cacheDirectory << "（" << cache.GetEntryCount() << " 项，"
+                     << (cache.GetTotalBytes() >> 20) << " / " << options.cacheSizeMb << " MB）");
+        }
+    }
 
     // ========================================
     // 创建窗口
     // ========================================
-    std::cout << "正在创建窗口..." << std::endl;
+    LOG_INFO("正在创建窗口...");
     Window w("CSC8502 Coursework", WINDOW_WIDTH, WINDOW_HEIGHT, false);
 
     if (!w.HasInitialised()) {
-        std::cerr << "错误：窗口初始化失败！" << std::endl;
+        LOG_ERROR("错误：窗口初始化失败！");
+        Log::Shutdown();
         return -1;
     }
-    std::cout << "✓ 窗口创建成功 (" << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << ")" << std::endl;
+    LOG_INFO("✓ 窗口创建成功 (" << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << ")");
 
     // ========================================
     // 创建渲染器
     // ========================================
-    std::cout << "\n正在初始化渲染器..." << std::endl;
+    LOG_INFO("\n正在初始化渲染器...");
+    auto initStart = std::chrono::steady_clock::now();
     Renderer renderer(w);
 
     if (!renderer.HasInitialised()) {
-        std::cerr << "错误：渲染器初始化失败！" << std::endl;
+        LOG_ERROR("错误：渲染器初始化失败！");
+        Log::Shutdown();
         return -1;
     }
-    std::cout << "✓ 渲染器初始化成功" << std::endl;
+    double initMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initStart).count();
+    LOG_INFO("✓ 渲染器初始化成功（" << (int)initMs << " 毫秒）");
+    if (DerivedDataCache::Get().IsOpen()) {
+        LOG_INFO("派生数据缓存：" << DerivedDataCache::Get().Describe());
+    }
+
+    if (options.releaseCpuCopies) {
+        renderer.ReleaseCpuCopies();
+        LOG_INFO("✓ 已释放上传后不再需要的CPU副本");
+    }
+    LOG_INFO("\n内存用量：");
+    PrintMemoryReport();
 
     // 将渲染器设置到窗口
     w.SetRenderer(&renderer);
 
-    // ========================================
-    // 显示控制说明
-    // ========================================
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "初始化完成！开始渲染..." << std::endl;
-    std::cout << "========================================" << std::endl;
-    std::cout << "\n控制说明：" << std::endl;
-    std::cout << "  WASD      - 前后左右移动" << std::endl;
-    std::cout << "  空格      - 向上移动" << std::endl;
-    std::cout << "  左Shift   - 向下移动" << std::endl;
-    std::cout << "  鼠标移动  - 环顾四周" << std::endl;
-    std::cout << "  滚轮      - 缩放视野" << std::endl;
-    std::cout << "  ESC       - 退出程序" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    // 初始化期间的计数（加载的资源、上传的字节数）算作第 0 帧
+    CounterState counters;
+    counters.record = !options.countersFile.empty();
+    EndCounterFrame(counters, renderer, nullptr);
+
+    // 帧时间预算控制器（--governor）
+    FrameGovernor* governor = nullptr;
+    if (options.governorMs > 0.0f) {
+        FrameGovernor::Settings governorSettings;
+        governorSettings.targetMs = options.governorMs;
+        governor = new FrameGovernor(governorSettings);
+        renderer.ApplyQuality(governor->GetQuality());
+        LOG_INFO("✓ 帧时间预算控制器：目标 " << options.governorMs << " 毫秒");
+    }
+
+    if (options.profileRepeats > 0) {
+        int result = RunSubsystemProfile(options.profileRepeats);
+        Log::Shutdown();
+        return result;
+    }
+
+    if (options.benchmark) {
+        int result = RunBenchmark(w, renderer, options, counters, governor);
+        delete governor;
+        if (counters.record && !counters.log.Write(options.countersFile)) {
+            result = -1;
+        }
+        Log::Shutdown();
+        return result;
+    }
+
+    // 输入录制 / 回放
+    // 文件打不开时不进入主循环，但仍然走下面的正常退出流程（关闭日志线程，
+    // 否则刚才的错误信息可能来不及输出）
+    InputRecorder input;
+    bool inputReady = (options.recordFile.empty() || input.StartRecording(options.recordFile)) &&
+                      (options.replayFile.empty() || input.StartReplay(options.replayFile));
+    bool replaying = input.GetMode() == InputRecorder::MODE_REPLAY;
+
+    if (inputReady) {
+        // ========================================
+        // 显示控制说明
+        // ========================================
+        LOG_INFO("\n========================================");
+        LOG_INFO("初始化完成！开始渲染...");
+        LOG_INFO("========================================");
+        LOG_INFO("\n控制说明：");
+        LOG_INFO("  WASD      - 前后左右移动");
+        LOG_INFO("  空格      - 向上移动");
+        LOG_INFO("  左Shift   - 向下移动");
+        LOG_INFO("  鼠标移动  - 环顾四周");
+        LOG_INFO("  滚轮      - 缩放视野");
+        LOG_INFO("  E         - 开始/暂停地形侵蚀");
+        LOG_INFO("  R / F     - 抬高 / 降低视线落点处的地形（按住）");
+        LOG_INFO("  T / G     - 压平 / 平滑视线落点处的地形（按住）");
+        LOG_INFO("  Q         - 在视线落点处倒水（按住）");
+        LOG_INFO("  M         - 输出内存/显存用量");
+        LOG_INFO("  O         - 显示/隐藏性能计数器");
+        LOG_INFO("  ESC       - 退出程序");
+        LOG_INFO("========================================\n");
+    }
 
     // ========================================
     // 主循环
@@ -79,27 +500,60 @@ int main() {
     // 1. 检查窗口是否应该关闭
     // 2. 处理 Windows 消息
     // 3. 更新输入设备（Keyboard/Mouse）
-    // 4. 调用 renderer.UpdateScene()
-    // 5. 调用 renderer.RenderScene()
-    //
     // 返回 false 表示窗口应该关闭
-    while (w.UpdateWindow()) {
+    //
+    // 之后由 FramePipeline 执行 UpdateScene / RenderScene；
+    // RunFrame 返回时模拟已经完成，下一次处理消息时不会有线程在读输入
+    FramePipeline pipeline(renderer, !options.serial);
+    FrameTimeRecorder replayTimes;
+    GpuTimer* frameGpuTimer = replaying || governor ? new GpuTimer() : nullptr;
+    while (inputReady && w.UpdateWindow()) {
         // 获取时间增量（毫秒）
         float msec = w.GetTimer()->GetTimeDeltaSeconds() * 1000.0f;
 
-        // 更新场景
-        renderer.UpdateScene(msec);
+        // 录制：保存本帧的输入和帧时间；回放：换成录制的输入和帧时间
+        if (!input.ProcessFrame(*Window::GetKeyboard(), *Window::GetMouse(), msec)) {
+            LOG_INFO("回放结束（" << input.GetFrameCount() << " 帧）");
+            break;
+        }
+
+        if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_M)) {
+            PrintMemoryReport();
+        }
+        if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_O)) {
+            renderer.SetOverlayVisible(!renderer.IsOverlayVisible());
+        }
 
-        // 渲染场景
-        renderer.RenderScene();
+        if (replaying || governor) {
+            // 回放时逐帧计时，同一段录制可以反复用来分析性能
+            RunTimedFrame(pipeline, renderer, msec, replaying ? &replayTimes : nullptr, *frameGpuTimer, governor);
+        } else {
+            // 更新并渲染场景
+            pipeline.RunFrame(msec);
+        }
+        EndCounterFrame(counters, renderer, governor);
+    }
+
+    input.Stop();
+    if (replaying) {
+        FinishTiming(replayTimes, *frameGpuTimer, options.csvFile);
+    }
+    delete frameGpuTimer;
+    if (governor) {
+        LOG_INFO("帧时间预算控制器：共调整 " << governor->GetChangeCount() << " 次，最后 " << governor->Describe());
+        delete governor;
+    }
+    if (counters.record) {
+        counters.log.Write(options.countersFile);
     }
 
     // ========================================
     // 程序退出
     // ========================================
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "程序正常退出" << std::endl;
-    std::cout << "========================================" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO(inputReady ? "程序正常退出" : "输入录制 / 回放文件无法打开，程序退出");
+    LOG_INFO("========================================");
+    Log::Shutdown();
 
-    return 0;
+    return inputReady ? 0 : -1;
 }
@@ -1,19 +1,18 @@
 #include "ComputeShader.h"
 #include "Shader.h"
-#include <iostream>
+#include "Log.h"
 #include <sstream>
 
 using std::string;
 using std::ifstream;
-using std::cout;
 
 ComputeShader::ComputeShader(const std::string& filename) {
 	ifstream	file(SHADERDIR + filename);
 
-	cout << "Loading compute shader text from " << filename << "\n\n";
+	LOG_DEBUG("Loading compute shader text from " << filename);
 
 	if (!file.is_open()) {
-		cout << "ERROR ERROR ERROR ERROR: File does not exist!\n";
+		LOG_ERROR("Compute shader file " << SHADERDIR << filename << " does not exist!");
 		return;
 	}
 	std::ostringstream stream;
@@ -0,0 +1,462 @@
+#include "DerivedDataCache.h"
+#include "Log.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+	const char		ENTRY_MAGIC[4]	= { 'D', 'D', 'C', '1' };
+	const uint32_t	ENTRY_VERSION	= 2;		//2: payload hash
+	const char*		ENTRY_EXTENSION	= ".ddc";
+	const char*		TEMP_MARKER		= ".tmp";
+
+	//Temporary files younger than this might still be being written by
+	//another instance, so Open leaves them alone
+	const long long	STALE_TEMP_SECONDS = 3600;
+
+	std::atomic<unsigned int> tempCounter(0);
+
+	//xxHash64 (public domain algorithm by Yann Collet): 8 bytes a step,
+	//several times faster than byte at a time FNV on the multi-megabyte
+	//images and heightmaps this gets fed
+	const uint64_t PRIME1 = 11400714785074694791ull;
+	const uint64_t PRIME2 = 14029467366897019727ull;
+	const uint64_t PRIME3 = 1609587929392839161ull;
+	const uint64_t PRIME4 = 9650029242287828579ull;
+	const uint64_t PRIME5 = 2870177450012600261ull;
+
+	inline uint64_t RotateLeft(uint64_t value, int bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline uint64_t Read64(const unsigned char* p) {
+		uint64_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t Read32(const unsigned char* p) {
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t Round(uint64_t accumulator, uint64_t input) {
+		accumulator += input * PRIME2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * PRIME1;
+	}
+
+	inline uint64_t Merge(uint64_t accumulator, uint64_t value) {
+		accumulator ^= Round(0, value);
+		return accumulator * PRIME1 + PRIME4;
+	}
+
+	long long FileTicks(fs::file_time_type time) {
+		return static_cast<long long>(time.time_since_epoch().count());
+	}
+
+	bool IsTempFile(const std::string& name) {
+		return name.find(TEMP_MARKER) != std::string::npos;
+	}
+
+	bool IsEntryFile(const std::string& name) {
+		size_t length = strlen(ENTRY_EXTENSION);
+		return !IsTempFile(name) && name.size() > length &&
+			name.compare(name.size() - length, length, ENTRY_EXTENSION) == 0;
+	}
+}
+
+DerivedDataKey::DerivedDataKey(const std::string& kind, unsigned int version) : kind(kind) {
+	hash = Hash(kind.data(), kind.size(), 0);
+	hash = Hash(&version, sizeof(version), hash);
+}
+
+uint64_t DerivedDataKey::Hash(const void* data, size_t size, uint64_t seed) {
+	const unsigned char* p		= static_cast<const unsigned char*>(data);
+	const unsigned char* end	= p + size;
+	uint64_t h;
+
+	if (size >= 32) {
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+		const unsigned char* limit = end - 32;
+		do {
+			v1 = Round(v1, Read64(p));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		h = Merge(h, v1);
+		h = Merge(h, v2);
+		h = Merge(h, v3);
+		h = Merge(h, v4);
+	}
+	else {
+		h = seed + PRIME5;
+	}
+	h += static_cast<uint64_t>(size);
+
+	for (; p + 8 <= end; p += 8) {
+		h ^= Round(0, Read64(p));
+		h = RotateLeft(h, 27) * PRIME1 + PRIME4;
+	}
+	if (p + 4 <= end) {
+		h ^= static_cast<uint64_t>(Read32(p)) * PRIME1;
+		h = RotateLeft(h, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; ++p) {
+		h ^= (*p) * PRIME5;
+		h = RotateLeft(h, 11) * PRIME1;
+	}
+
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+DerivedDataKey& DerivedDataKey::AddBytes(const void* data, size_t size) {
+	hash = Hash(data, size, hash);
+	return *this;
+}
+
+DerivedDataKey& DerivedDataKey::AddString(const std::string& text) {
+	//Length first, so ("ab", "c") and ("a", "bc") differ
+	Add(static_cast<uint64_t>(text.size()));
+	return AddBytes(text.data(), text.size());
+}
+
+bool DerivedDataKey::AddFile(const std::string& path, std::vector<unsigned char>* contents) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::streamoff size = file.tellg();
+	if (size < 0) {
+		return false;
+	}
+	std::vector<unsigned char> local;
+	std::vector<unsigned char>& bytes = contents ? *contents : local;
+	bytes.resize(static_cast<size_t>(size));
+	file.seekg(0);
+	if (size > 0 && !file.read(reinterpret_cast<char*>(bytes.data()), size)) {
+		return false;
+	}
+	AddBytes(bytes.data(), bytes.size());
+	return true;
+}
+
+std::string DerivedDataKey::GetFileName() const {
+	char digits[17];
+	snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+	return kind + "_" + digits + ENTRY_EXTENSION;
+}
+
+DerivedDataCache& DerivedDataCache::Get() {
+	static DerivedDataCache instance;
+	return instance;
+}
+
+bool DerivedDataCache::Open(const Settings& newSettings) {
+	Close();
+
+	std::error_code error;
+	fs::create_directories(newSettings.directory, error);
+	if (newSettings.directory.empty() || !fs::is_directory(newSettings.directory, error)) {
+		LOG_ERROR("错误：无法创建派生数据缓存目录 " << newSettings.directory
+				  << (error ? "（" + error.message() + "）" : std::string()));
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	settings	= newSettings;
+	entries.clear();
+	totalBytes	= 0;
+	stats		= Stats();
+
+	long long now		= FileTicks(fs::file_time_type::clock::now());
+	long long staleAge	= std::chrono::duration_cast<fs::file_time_type::duration>(
+		std::chrono::seconds(STALE_TEMP_SECONDS)).count();
+	for (fs::directory_iterator it(settings.directory, error), end; !error && it != end; it.increment(error)) {
+		std::error_code itemError;
+		if (!it->is_regular_file(itemError)) {
+			continue;
+		}
+		std::string name = it->path().filename().string();
+		long long modified = FileTicks(it->last_write_time(itemError));
+		if (IsTempFile(name)) {
+			if (now - modified > staleAge) {
+				fs::remove(it->path(), itemError);
+			}
+			continue;
+		}
+		if (!IsEntryFile(name)) {
+			continue;
+		}
+		Entry entry;
+		entry.size		= it->file_size(itemError);
+		entry.lastUse	= modified;
+		if (!itemError) {
+			entries[name] = entry;
+			totalBytes += entry.size;
+		}
+	}
+
+	open = true;
+	Trim();
+	return true;
+}
+
+void DerivedDataCache::Close() {
+	std::lock_guard<std::mutex> guard(lock);
+	open = false;
+	entries.clear();
+	totalBytes = 0;
+}
+
+bool DerivedDataCache::IsOpen() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return open;
+}
+
+std::string DerivedDataCache::PathOf(const std::string& fileName) const {
+	return (fs::path(settings.directory) / fileName).string();
+}
+
+//Entry file: "DDC1" | format version (uint32) | hash (uint64) |
+//kind length (uint32) | kind | payload size (uint64) | payload hash (uint64) |
+//payload
+//
+//The index isn't consulted - another instance may have stored the entry
+//since Open
+bool DerivedDataCache::Load(const DerivedDataKey& key, std::vector<unsigned char>& data) {
+	data.clear();
+	std::string fileName = key.GetFileName();
+	std::string path;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (!open) {
+			return false;
+		}
+		path = PathOf(fileName);
+	}
+
+	bool valid = false;
+	bool exists = false;
+	std::streamoff fileSize = 0;
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (file.is_open()) {
+			exists = true;
+			fileSize = file.tellg();
+			file.seekg(0);
+
+			char		magic[4];
+			uint32_t	version		= 0;
+			uint64_t	hash		= 0;
+			uint32_t	kindLength	= 0;
+			file.read(magic, sizeof(magic));
+			file.read(reinterpret_cast<char*>(&version), sizeof(version));
+			file.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+			file.read(reinterpret_cast<char*>(&kindLength), sizeof(kindLength));
+
+			if (file && memcmp(magic, ENTRY_MAGIC, sizeof(magic)) == 0 && version == ENTRY_VERSION &&
+				hash == key.GetHash() && kindLength == key.GetKind().size()) {
+				std::string kind(kindLength, '\0');
+				uint64_t size = 0;
+				uint64_t payloadHash = 0;
+				file.read(&kind[0], kindLength);
+				file.read(reinterpret_cast<char*>(&size), sizeof(size));
+				file.read(reinterpret_cast<char*>(&payloadHash), sizeof(payloadHash));
+
+				std::streamoff headerSize = file.tellg();
+				if (file && kind == key.GetKind() && headerSize >= 0 &&
+					size == static_cast<uint64_t>(fileSize - headerSize)) {
+					data.resize(static_cast<size_t>(size));
+					valid = (size == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()),
+																				  static_cast<std::streamsize>(size)))) &&
+							DerivedDataKey::Hash(data.data(), data.size(), 0) == payloadHash;
+				}
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	if (!valid) {
+		data.clear();
+		if (exists) {
+			LOG_WARNING("派生数据缓存：" << fileName << " 已损坏，删除后重新生成");
+			Remove(fileName);
+		}
+		++stats.misses;
+		return false;
+	}
+
+	Entry& entry = entries[fileName];
+	if (entry.size == 0) {
+		//Written by another instance since Open. Sized on disk (header
+		//included) like Store and Open, so the size limit sees the same total
+		entry.size = static_cast<uint64_t>(fileSize);
+		totalBytes += entry.size;
+	}
+	Touch(fileName, entry);
+	++stats.hits;
+	stats.bytesRead += data.size();
+	return true;
+}
+
+//Written to a temporary file first and renamed over the entry, so nobody
+//ever opens a half written one
+bool DerivedDataCache::Store(const DerivedDataKey& key, const std::vector<unsigned char>& data) {
+	std::string fileName = key.GetFileName();
+	std::string path;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (!open) {
+			return false;
+		}
+		path = PathOf(fileName);
+	}
+
+	//Unique across threads (id, counter) and processes (time)
+	std::string tempPath = path + TEMP_MARKER
+		+ std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_"
+		+ std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "_"
+		+ std::to_string(tempCounter.fetch_add(1));
+
+	const std::string& kind = key.GetKind();
+	uint32_t	kindLength	= static_cast<uint32_t>(kind.size());
+	uint64_t	hash		= key.GetHash();
+	uint64_t	size		= static_cast<uint64_t>(data.size());
+	uint64_t	payloadHash	= DerivedDataKey::Hash(data.data(), data.size(), 0);
+	bool		written;
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		file.write(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+		file.write(reinterpret_cast<const char*>(&ENTRY_VERSION), sizeof(ENTRY_VERSION));
+		file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+		file.write(reinterpret_cast<const char*>(&kindLength), sizeof(kindLength));
+		file.write(kind.data(), kindLength);
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(reinterpret_cast<const char*>(&payloadHash), sizeof(payloadHash));
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		file.close();
+		written = !file.fail();
+	}
+
+	std::error_code error;
+	if (written) {
+		fs::rename(tempPath, path, error);
+	}
+	if (!written || error) {
+		std::error_code ignored;
+		fs::remove(tempPath, ignored);
+		LOG_ERROR("错误：无法写入派生数据缓存 " << path << (error ? "（" + error.message() + "）" : std::string()));
+		return false;
+	}
+
+	uint64_t fileSize = fs::file_size(path, error);
+	if (error) {
+		fileSize = size;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	Entry& entry = entries[fileName];
+	totalBytes -= entry.size;
+	entry.size = fileSize;
+	totalBytes += entry.size;
+	Touch(fileName, entry);
+	++stats.stores;
+	stats.bytesWritten += fileSize;
+	Trim();
+	return true;
+}
+
+void DerivedDataCache::Clear() {
+	std::lock_guard<std::mutex> guard(lock);
+	if (settings.directory.empty()) {
+		return;
+	}
+	std::error_code error;
+	for (fs::directory_iterator it(settings.directory, error), end; !error && it != end; it.increment(error)) {
+		std::string name = it->path().filename().string();
+		if (IsEntryFile(name)) {
+			std::error_code ignored;
+			fs::remove(it->path(), ignored);
+		}
+	}
+	entries.clear();
+	totalBytes = 0;
+}
+
+//Touch, Remove and Trim are called with lock held
+void DerivedDataCache::Touch(const std::string& fileName, Entry& entry) {
+	fs::file_time_type now = fs::file_time_type::clock::now();
+	std::error_code ignored;
+	fs::last_write_time(PathOf(fileName), now, ignored);
+	entry.lastUse = FileTicks(now);
+}
+
+void DerivedDataCache::Remove(const std::string& fileName) {
+	std::error_code ignored;
+	fs::remove(PathOf(fileName), ignored);
+	std::map<std::string, Entry>::iterator it = entries.find(fileName);
+	if (it != entries.end()) {
+		totalBytes -= it->second.size;
+		entries.erase(it);
+	}
+}
+
+void DerivedDataCache::Trim() {
+	while (totalBytes > settings.maxBytes && !entries.empty()) {
+		std::map<std::string, Entry>::iterator oldest = entries.begin();
+		for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+			if (it->second.lastUse < oldest->second.lastUse) {
+				oldest = it;
+			}
+		}
+		std::string fileName = oldest->first;
+		Remove(fileName);
+		++stats.evictions;
+	}
+}
+
+uint64_t DerivedDataCache::GetTotalBytes() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return totalBytes;
+}
+
+int DerivedDataCache::GetEntryCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return static_cast<int>(entries.size());
+}
+
+DerivedDataCache::Stats DerivedDataCache::GetStats() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return stats;
+}
+
+std::string DerivedDataCache::Describe() const {
+	std::lock_guard<std::mutex> guard(lock);
+	const double mb = 1.0 / (1024.0 * 1024.0);
+	char line[256];
+	snprintf(line, sizeof(line), "命中 %d，未命中 %d，读取 %.1f MB，写入 %.1f MB，淘汰 %d；共 %d 项 %.1f / %.0f MB",
+			 stats.hits, stats.misses, stats.bytesRead * mb, stats.bytesWritten * mb, stats.evictions,
+			 static_cast<int>(entries.size()), totalBytes * mb, settings.maxBytes * mb);
+	return line;
+}
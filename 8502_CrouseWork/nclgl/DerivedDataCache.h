@@ -0,0 +1,214 @@
+/******************************************************************************
+Class:DerivedDataCache
+Description:An on-disk cache for anything that's expensive to work out from a
+source file and doesn't change unless the file does - terrain meshes built
+from a heightmap, decoded images with their mip chains, baked lighting maps.
+
+Entries are content addressed. A DerivedDataKey hashes everything that goes
+into a result: the source bytes, the processing parameters, and a version
+number that the producing code bumps whenever it changes what it outputs.
+Change any of those and the key changes with it, so a stale entry is never
+found rather than having to be detected - it just ages out.
+
+Each entry is one file in the cache directory, named <kind>_<hash>.ddc, with
+a small header (magic, hash, kind, payload size, payload hash) in front of
+the payload.
+Store writes to a uniquely named temporary file and renames it over the
+entry, so another process, or this one after a crash, sees either the old
+entry, the whole new one, or nothing. Load checks the header, the size and
+the payload's hash, and treats anything that doesn't match as a miss (and
+deletes it) - so a flipped bit on disk is regenerated rather than handed to
+code that trusts the sizes and offsets inside it.
+
+The cache is bounded in size. Every hit or store stamps the entry's file
+time with the current time; when the total goes over the limit, the entries
+with the oldest times are deleted until it fits (least recently used).
+The times live in the file system, so the order carries over between runs.
+
+Payloads are opaque bytes. DerivedDataWriter / DerivedDataReader pack plain
+values and arrays of them; the reader checks every length against what's
+left, so a damaged payload fails to read instead of overrunning. "Plain"
+means standard layout with no pointers, copied byte for byte - the same thing
+glBufferData assumes of a vertex (nclgl's vectors have empty destructors, so
+they don't count as trivially copyable, but they are plain in this sense).
+
+Load and Store can be called from any thread (eg decode jobs). Get() returns
+the shared instance, which does nothing - every Load misses and Store
+returns false - until Open is called.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class DerivedDataKey	{
+public:
+	//kind names the sort of data (and prefixes the file name); version must
+	//be bumped whenever the code producing it changes its output
+	DerivedDataKey(const std::string& kind, unsigned int version);
+
+	DerivedDataKey& AddBytes(const void* data, size_t size);
+	DerivedDataKey& AddString(const std::string& text);
+
+	template <typename T>
+	DerivedDataKey& Add(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "DerivedDataKey::Add needs a plain value");
+		return AddBytes(&value, sizeof(T));
+	}
+
+	//Hashes a file's contents, and hands them back through contents if
+	//given (so a miss can decode them without reading the file again).
+	//false if the file can't be read - the key is then not usable
+	bool AddFile(const std::string& path, std::vector<unsigned char>* contents = nullptr);
+
+	const std::string&	GetKind()	const { return kind; }
+	uint64_t			GetHash()	const { return hash; }
+	std::string			GetFileName() const;
+
+	//The 64 bit hash on its own, for anything else that wants one
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed);
+
+protected:
+	std::string	kind;
+	uint64_t	hash;
+};
+
+class DerivedDataCache	{
+public:
+	struct Settings {
+		std::string	directory;					//Created if missing
+		uint64_t	maxBytes = 1024ull << 20;	//Trimmed to this, oldest first
+	};
+
+	//Totals since Open
+	struct Stats {
+		int			hits		= 0;
+		int			misses		= 0;
+		int			stores		= 0;
+		int			evictions	= 0;
+		uint64_t	bytesRead	= 0;
+		uint64_t	bytesWritten = 0;
+	};
+
+	static DerivedDataCache& Get();
+
+	//Creates the directory, deletes temporary files left behind by a crash
+	//and trims the existing entries to maxBytes. false (and the cache stays
+	//off) if the directory can't be created
+	bool	Open(const Settings& settings);
+	void	Close();
+	bool	IsOpen() const;
+
+	//false on a miss; data is left empty
+	bool	Load(const DerivedDataKey& key, std::vector<unsigned char>& data);
+	bool	Store(const DerivedDataKey& key, const std::vector<unsigned char>& data);
+
+	//Deletes every entry
+	void	Clear();
+
+	uint64_t			GetTotalBytes()	const;
+	int					GetEntryCount()	const;
+	Stats				GetStats()		const;
+	const std::string&	GetDirectory()	const { return settings.directory; }
+
+	//One line for the log: hits, misses, MB read / written, size
+	std::string	Describe() const;
+
+protected:
+	struct Entry {
+		uint64_t	size;
+		long long	lastUse;	//File time, in the file clock's ticks
+	};
+
+	Settings						settings;
+	bool							open = false;
+	mutable std::mutex				lock;
+	std::map<std::string, Entry>	entries;	//By file name
+	uint64_t						totalBytes = 0;
+	Stats							stats;
+
+	std::string	PathOf(const std::string& fileName) const;
+	void		Touch(const std::string& fileName, Entry& entry);
+	void		Remove(const std::string& fileName);
+	void		Trim();
+};
+
+//Appends plain values and arrays of them to a byte buffer
+class DerivedDataWriter	{
+public:
+	explicit DerivedDataWriter(std::vector<unsigned char>& out) : out(out) {}
+
+	void WriteBytes(const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	template <typename T>
+	void Write(const T& value) {
+		static_assert(std::is_standard_layout<T>::value, "DerivedDataWriter::Write needs a plain value");
+		WriteBytes(&value, sizeof(T));
+	}
+
+	//Element count, then the elements
+	template <typename T>
+	void WriteArray(const std::vector<T>& values) {
+		static_assert(std::is_standard_layout<T>::value, "DerivedDataWriter::WriteArray needs plain values");
+		Write(static_cast<uint64_t>(values.size()));
+		WriteBytes(values.data(), values.size() * sizeof(T));
+	}
+
+protected:
+	std::vector<unsigned char>& out;
+};
+
+//Reads back what DerivedDataWriter wrote. Every read fails (and keeps
+//failing) once anything runs past the end
+class DerivedDataReader	{
+public:
+	explicit DerivedDataReader(const std::vector<unsigned char>& data)
+		: data(data), position(0), failed(false) {}
+
+	bool ReadBytes(void* destination, size_t size) {
+		if (failed || size > data.size() - position) {
+			failed = true;
+			return false;
+		}
+		if (size > 0) {
+			memcpy(destination, data.data() + position, size);
+		}
+		position += size;
+		return true;
+	}
+
+	template <typename T>
+	bool Read(T& value) {
+		static_assert(std::is_standard_layout<T>::value, "DerivedDataReader::Read needs a plain value");
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadArray(std::vector<T>& values) {
+		static_assert(std::is_standard_layout<T>::value, "DerivedDataReader::ReadArray needs plain values");
+		uint64_t count = 0;
+		if (!Read(count) || count > (data.size() - position) / sizeof(T)) {
+			failed = true;
+			return false;
+		}
+		values.resize(static_cast<size_t>(count));
+		return ReadBytes(values.data(), values.size() * sizeof(T));
+	}
+
+	//Everything read, nothing left over
+	bool IsComplete() const { return !failed && position == data.size(); }
+
+protected:
+	const std::vector<unsigned char>&	data;
+	size_t								position;
+	bool								failed;
+};
@@ -0,0 +1,327 @@
+#include "HardwareCounters.h"
+#include "Log.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	enum CounterEvent {
+		EVENT_CYCLES,
+		EVENT_INSTRUCTIONS,
+		EVENT_CACHE_MISSES,
+		EVENT_BRANCH_MISSES,
+		EVENT_COUNT
+	};
+
+	const int MAX_SCOPES = 64;
+
+	struct ScopeTotals {
+		const char*			name;
+		long long			calls;
+		long long			elements;
+		double				milliseconds;
+		unsigned long long	events[EVENT_COUNT];
+	};
+
+	std::atomic<bool>	enabled;
+	bool				hasCounters;
+	std::chrono::steady_clock::time_point	enableTime;
+
+	//Scaled counts are estimates, and one can come out a little lower than
+	//the one before it
+	unsigned long long Increase(unsigned long long from, unsigned long long to) {
+		return to > from ? to - from : 0;
+	}
+
+	std::mutex			scopeLock;
+	ScopeTotals			scopes[MAX_SCOPES];
+	int					scopeCount;
+
+#ifdef __linux__
+	//One group per thread: cycles leads, the rest follow it on and off the
+	//PMU together, so their ratios hold even when the kernel multiplexes
+	struct ThreadGroup {
+		int		fds[EVENT_COUNT];	//-1 for events this CPU doesn't have
+	};
+
+	std::vector<ThreadGroup>	groups;
+	bool						eventOpen[EVENT_COUNT];
+
+	int OpenEvent(int thread, int event, int group) {
+		const unsigned long long configs[EVENT_COUNT] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+		};
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size			= sizeof(attr);
+		attr.type			= PERF_TYPE_HARDWARE;
+		attr.config			= configs[event];
+		attr.exclude_kernel	= 1;	//Allowed at perf_event_paranoid 2
+		attr.exclude_hv		= 1;
+		attr.read_format	= PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		return (int)syscall(__NR_perf_event_open, &attr, thread, -1, group, 0);
+	}
+
+	void CloseGroups() {
+		for (ThreadGroup& g : groups) {
+			for (int fd : g.fds) {
+				if (fd >= 0) {
+					close(fd);
+				}
+			}
+		}
+		groups.clear();
+	}
+
+	//Every thread in the process, from /proc/self/task
+	std::vector<int> ListThreads() {
+		std::vector<int> threads;
+		DIR* dir = opendir("/proc/self/task");
+		if (!dir) {
+			threads.push_back((int)syscall(SYS_gettid));
+			return threads;
+		}
+		while (dirent* entry = readdir(dir)) {
+			int id = atoi(entry->d_name);
+			if (id > 0) {
+				threads.push_back(id);
+			}
+		}
+		closedir(dir);
+		return threads;
+	}
+
+	bool OpenGroups() {
+		std::vector<int> threads = ListThreads();
+		for (int e = 0; e < EVENT_COUNT; ++e) {
+			eventOpen[e] = true;
+		}
+		for (int thread : threads) {
+			ThreadGroup g;
+			g.fds[EVENT_CYCLES] = OpenEvent(thread, EVENT_CYCLES, -1);
+			if (g.fds[EVENT_CYCLES] < 0) {
+				if (errno == ESRCH) {
+					continue;	//Thread exited while we were listing them
+				}
+				LOG_WARNING("硬件计数器不可用（perf_event_open: " << strerror(errno)
+					<< "），只记录时间");
+				CloseGroups();
+				return false;
+			}
+			for (int e = EVENT_CYCLES + 1; e < EVENT_COUNT; ++e) {
+				g.fds[e] = eventOpen[e] ? OpenEvent(thread, e, g.fds[EVENT_CYCLES]) : -1;
+				if (g.fds[e] < 0) {
+					eventOpen[e] = false;
+				}
+			}
+			groups.push_back(g);
+		}
+		//An event has to be there for every thread to be worth reporting
+		for (ThreadGroup& g : groups) {
+			for (int e = 0; e < EVENT_COUNT; ++e) {
+				if (!eventOpen[e] && g.fds[e] >= 0) {
+					close(g.fds[e]);
+					g.fds[e] = -1;
+				}
+			}
+		}
+		LOG_INFO("✓ 硬件计数器已打开（" << (int)groups.size() << " 个线程）");
+		return !groups.empty();
+	}
+
+	unsigned long long ReadEvent(int fd) {
+		unsigned long long values[3];	//value, time enabled, time running
+		if (read(fd, values, sizeof(values)) != (ssize_t)sizeof(values) || values[2] == 0) {
+			return 0;
+		}
+		if (values[2] < values[1]) {
+			return (unsigned long long)((double)values[0] * values[1] / values[2]);
+		}
+		return values[0];
+	}
+#endif
+}
+
+bool HardwareCounters::Enable() {
+	if (enabled) {
+		return hasCounters;
+	}
+#ifdef __linux__
+	hasCounters = OpenGroups();
+#else
+	LOG_WARNING("硬件计数器只支持 Linux（perf_event），只记录时间");
+	hasCounters = false;
+#endif
+	enableTime	= std::chrono::steady_clock::now();
+	enabled		= true;
+	return hasCounters;
+}
+
+void HardwareCounters::Disable() {
+	enabled = false;
+#ifdef __linux__
+	CloseGroups();
+#endif
+	hasCounters = false;
+}
+
+bool HardwareCounters::IsEnabled() {
+	return enabled.load(std::memory_order_relaxed);
+}
+
+bool HardwareCounters::HasCounters() {
+	return hasCounters;
+}
+
+void HardwareCounters::Read(HardwareSample& sample) {
+	memset(&sample, 0, sizeof(sample));
+	sample.milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - enableTime).count();
+#ifdef __linux__
+	unsigned long long* totals[EVENT_COUNT] = {
+		&sample.cycles, &sample.instructions, &sample.cacheMisses, &sample.branchMisses
+	};
+	for (const ThreadGroup& g : groups) {
+		for (int e = 0; e < EVENT_COUNT; ++e) {
+			if (g.fds[e] >= 0) {
+				*totals[e] += ReadEvent(g.fds[e]);
+			}
+		}
+	}
+#endif
+}
+
+ProfileScope::ProfileScope(const char* name, long long elements)
+	: name(name), elements(elements), active(HardwareCounters::IsEnabled()) {
+	if (active) {
+		HardwareCounters::Read(start);
+	}
+}
+
+ProfileScope::~ProfileScope(void) {
+	if (!active) {
+		return;
+	}
+	HardwareSample end;
+	HardwareCounters::Read(end);
+
+	std::lock_guard<std::mutex> guard(scopeLock);
+	ScopeTotals* totals = nullptr;
+	for (int i = 0; i < scopeCount; ++i) {
+		if (strcmp(scopes[i].name, name) == 0) {
+			totals = &scopes[i];
+			break;
+		}
+	}
+	if (!totals) {
+		if (scopeCount == MAX_SCOPES) {
+			return;
+		}
+		totals = &scopes[scopeCount++];
+		memset(totals, 0, sizeof(*totals));
+		totals->name = name;
+	}
+	totals->calls			+= 1;
+	totals->elements		+= elements;
+	totals->milliseconds	+= end.milliseconds - start.milliseconds;
+	totals->events[EVENT_CYCLES]		+= Increase(start.cycles, end.cycles);
+	totals->events[EVENT_INSTRUCTIONS]	+= Increase(start.instructions, end.instructions);
+	totals->events[EVENT_CACHE_MISSES]	+= Increase(start.cacheMisses, end.cacheMisses);
+	totals->events[EVENT_BRANCH_MISSES]	+= Increase(start.branchMisses, end.branchMisses);
+}
+
+void ProfileScope::PrintReport(std::ostream& out) {
+	std::lock_guard<std::mutex> guard(scopeLock);
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::left << std::setw(28) << "Scope"
+		<< std::right << std::setw(7) << "calls" << std::setw(11) << "ms/call"
+		<< std::setw(12) << "elem/call" << std::setw(7) << "IPC"
+		<< std::setw(16) << "cache miss/el" << std::setw(16) << "branch miss/el" << "\n";
+	out << std::fixed;
+
+	bool anyCounted = false;
+	for (int i = 0; i < scopeCount; ++i) {
+		const ScopeTotals& s = scopes[i];
+		out << std::left << std::setw(28) << s.name << std::right
+			<< std::setw(7) << s.calls
+			<< std::setprecision(3) << std::setw(11) << s.milliseconds / s.calls
+			<< std::setprecision(0) << std::setw(12) << (double)s.elements / s.calls;
+
+		//A missing event reads as 0 everywhere; print "-" rather than a
+		//ratio that looks real
+		unsigned long long cycles = s.events[EVENT_CYCLES];
+		anyCounted = anyCounted || cycles > 0;
+		if (cycles > 0 && s.events[EVENT_INSTRUCTIONS] > 0) {
+			out << std::setprecision(2) << std::setw(7) << (double)s.events[EVENT_INSTRUCTIONS] / cycles;
+		}
+		else {
+			out << std::setw(7) << "-";
+		}
+		const int perElement[2] = { EVENT_CACHE_MISSES, EVENT_BRANCH_MISSES };
+		for (int e : perElement) {
+			if (cycles > 0 && s.elements > 0) {
+				out << std::setprecision(4) << std::setw(16) << (double)s.events[e] / s.elements;
+			}
+			else {
+				out << std::setw(16) << "-";
+			}
+		}
+		out << "\n";
+	}
+	if (!anyCounted) {
+		out << "（没有硬件计数器，只有时间）\n";
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
+
+bool ProfileScope::GetTotals(const char* name, long long& calls, double& milliseconds) {
+	std::lock_guard<std::mutex> guard(scopeLock);
+	for (int i = 0; i < scopeCount; ++i) {
+		if (strcmp(scopes[i].name, name) == 0) {
+			calls			= scopes[i].calls;
+			milliseconds	= scopes[i].milliseconds;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ProfileScope::GetTotals(const char* name, long long& calls, long long& elements, HardwareSample& totals) {
+	std::lock_guard<std::mutex> guard(scopeLock);
+	for (int i = 0; i < scopeCount; ++i) {
+		if (strcmp(scopes[i].name, name) == 0) {
+			calls				= scopes[i].calls;
+			elements			= scopes[i].elements;
+			totals.milliseconds	= scopes[i].milliseconds;
+			totals.cycles		= scopes[i].events[EVENT_CYCLES];
+			totals.instructions	= scopes[i].events[EVENT_INSTRUCTIONS];
+			totals.cacheMisses	= scopes[i].events[EVENT_CACHE_MISSES];
+			totals.branchMisses	= scopes[i].events[EVENT_BRANCH_MISSES];
+			return true;
+		}
+	}
+	return false;
+}
+
+void ProfileScope::Reset() {
+	std::lock_guard<std::mutex> guard(scopeLock);
+	scopeCount = 0;
+}
@@ -0,0 +1,82 @@
+/******************************************************************************
+Class:HardwareCounters
+Description:CPU hardware counters (cycles, instructions, cache misses, branch
+misses) for finding out why a piece of code is slow, not just how slow it is.
+
+Off by default. Enable() opens a perf_event counter group for every thread the
+process has at that point (the job system workers included), counting user
+space only, and Read() adds them all up - so a scope around a ParallelFor
+counts the work the workers did for it too. Threads started after Enable()
+aren't counted, and neither is anything else running at the same time, so
+this is for benchmarks rather than the normal frame loop.
+
+Hardware counters need Linux and a kernel that lets the process use them:
+containers and VMs often don't (perf_event_paranoid, seccomp, no PMU), and
+there is no equivalent on Windows without a driver. In any of those cases
+Enable() logs why, once, and everything carries on with wall time only -
+HasCounters() says which it is, and the counter fields are left at 0.
+
+ProfileScope times the block it's declared in and adds the result to a table
+by name. It costs one atomic load while counters are disabled. PrintReport
+shows, for each name, time per call and - when there are counters -
+instructions per cycle and cache / branch misses per element, where an element
+is whatever the scope says it processed (vertices, bytes...).
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <iosfwd>
+
+struct HardwareSample {
+	double				milliseconds;	//Wall time since Enable
+	unsigned long long	cycles;
+	unsigned long long	instructions;
+	unsigned long long	cacheMisses;
+	unsigned long long	branchMisses;
+};
+
+class HardwareCounters	{
+public:
+	//Starts recording scopes. Returns true if hardware counters opened, false
+	//if it fell back to wall time (the reason is logged).
+	static bool		Enable();
+	static void		Disable();
+
+	static bool		IsEnabled();
+	static bool		HasCounters();
+
+	//Totals over every counted thread. When the kernel had to share the PMU
+	//between groups the counts are scaled up to the whole time enabled.
+	static void		Read(HardwareSample& sample);
+};
+
+class ProfileScope	{
+public:
+	//name must outlive the program (a string literal); elements can also be
+	//set later, once the scope knows how much it processed
+	explicit ProfileScope(const char* name, long long elements = 0);
+	~ProfileScope(void);
+
+	void	SetElements(long long count) { elements = count; }
+
+	//One line per scope name: calls, ms per call, elements per call, IPC,
+	//cache and branch misses per element
+	static void		PrintReport(std::ostream& out);
+	static void		Reset();
+
+	//What's been recorded for name since the last Reset - false if it hasn't
+	//run. For tools that want the numbers rather than the table.
+	static bool		GetTotals(const char* name, long long& calls, double& milliseconds);
+	//The same with the elements and hardware counts as well (the counts are
+	//0 without counters). totals.milliseconds is the time.
+	static bool		GetTotals(const char* name, long long& calls, long long& elements, HardwareSample& totals);
+
+protected:
+	const char*		name;
+	long long		elements;
+	bool			active;
+	HardwareSample	start;
+
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+};
@@ -0,0 +1,49 @@
+#include "InputRecorder.h"
+
+InputRecorder::InputRecorder(void) : InputStream(KEYBOARD_MAX, MOUSE_MAX) {
+	ResetState(current);
+}
+
+bool InputRecorder::ProcessFrame(Keyboard& keyboard, Mouse& mouse, float& msec) {
+	if (mode == MODE_RECORD) {
+		Capture(keyboard, mouse, current);
+		RecordFrame(current, msec);
+	}
+	else if (mode == MODE_REPLAY) {
+		if (!ReplayFrame(current, msec)) {
+			return false;
+		}
+		Restore(current, keyboard, mouse);
+	}
+	return true;
+}
+
+void InputRecorder::Capture(const Keyboard& keyboard, const Mouse& mouse, State& out) const {
+	for (int i = 0; i < KEYBOARD_MAX; ++i) {
+		out.keys[i]		= keyboard.keyStates[i] ? 1 : 0;
+		out.keyHolds[i]	= keyboard.holdStates[i] ? 1 : 0;
+	}
+	for (int i = 0; i < MOUSE_MAX; ++i) {
+		out.buttons[i]		= mouse.buttons[i] ? 1 : 0;
+		out.buttonHolds[i]	= mouse.holdButtons[i] ? 1 : 0;
+		out.doubleClicks[i]	= mouse.doubleClicks[i] ? 1 : 0;
+	}
+	out.relative	= mouse.relativePosition;
+	out.absolute	= mouse.absolutePosition;
+	out.wheel		= mouse.frameWheel;
+}
+
+void InputRecorder::Restore(const State& in, Keyboard& keyboard, Mouse& mouse) const {
+	for (int i = 0; i < KEYBOARD_MAX; ++i) {
+		keyboard.keyStates[i]	= in.keys[i] != 0;
+		keyboard.holdStates[i]	= in.keyHolds[i] != 0;
+	}
+	for (int i = 0; i < MOUSE_MAX; ++i) {
+		mouse.buttons[i]		= in.buttons[i] != 0;
+		mouse.holdButtons[i]	= in.buttonHolds[i] != 0;
+		mouse.doubleClicks[i]	= in.doubleClicks[i] != 0;
+	}
+	mouse.relativePosition	= in.relative;
+	mouse.absolutePosition	= in.absolute;
+	mouse.frameWheel		= in.wheel;
+}
@@ -0,0 +1,39 @@
+/******************************************************************************
+Class:InputRecorder
+Implements:InputStream
+Description:Records the per-frame Keyboard / Mouse state, plus the frame time,
+to a compact binary file, and replays it so that the rest of the program sees
+exactly the same input and the same frame times as the recorded session.
+
+The state that is recorded is everything the Keyboard and Mouse public
+interfaces expose - down, held, double click, relative and absolute position,
+wheel - so KeyTriggered etc behave identically during replay. The file format
+and the event encoding live in InputStream, which has no Windows dependency;
+this class only copies the device state in and out of it.
+
+Call ProcessFrame once per frame, after Window::UpdateWindow has pumped the
+OS messages. While replaying, live input is overwritten, and the msec value
+passed in is replaced with the recorded one.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "InputStream.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+class InputRecorder : public InputStream	{
+public:
+	InputRecorder(void);
+	~InputRecorder(void) {}
+
+	//Records or replays one frame. Returns false once a replay has run out of
+	//frames (or the file turned out to be damaged); true otherwise.
+	bool	ProcessFrame(Keyboard& keyboard, Mouse& mouse, float& msec);
+
+protected:
+	void	Capture(const Keyboard& keyboard, const Mouse& mouse, State& out) const;
+	void	Restore(const State& in, Keyboard& keyboard, Mouse& mouse) const;
+
+	State	current;	//Scratch state, kept to avoid reallocating every frame
+};
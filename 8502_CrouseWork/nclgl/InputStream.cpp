@@ -0,0 +1,352 @@
+#include "InputStream.h"
+#include "Log.h"
+#include <cstring>
+#include <iterator>
+
+namespace {
+	const char			MAGIC[4]	= { 'N', 'C', 'L', 'I' };
+	const unsigned int	VERSION		= 1;
+
+	//Flush the write buffer once it gets this big
+	const size_t		FLUSH_SIZE	= 64 * 1024;
+
+	void PutUint32(std::vector<unsigned char>& out, unsigned int value) {
+		for (int i = 0; i < 4; ++i) {
+			out.push_back((unsigned char)(value >> (i * 8)));
+		}
+	}
+
+	void PutFloat(std::vector<unsigned char>& out, float value) {
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		PutUint32(out, bits);
+	}
+
+	//7 bits per byte, high bit set on all but the last
+	void PutVarint(std::vector<unsigned char>& out, unsigned int value) {
+		while (value >= 0x80) {
+			out.push_back((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((unsigned char)value);
+	}
+
+	//Bounds-checked reader over the loaded file
+	struct Reader {
+		const std::vector<unsigned char>& data;
+		size_t& position;
+
+		bool Byte(unsigned char& value) {
+			if (position >= data.size()) {
+				return false;
+			}
+			value = data[position++];
+			return true;
+		}
+		bool Uint32(unsigned int& value) {
+			if (position > data.size() || data.size() - position < 4) {
+				return false;
+			}
+			value = 0;
+			for (int i = 0; i < 4; ++i) {
+				value |= (unsigned int)data[position++] << (i * 8);
+			}
+			return true;
+		}
+		bool Float(float& value) {
+			unsigned int bits;
+			if (!Uint32(bits)) {
+				return false;
+			}
+			memcpy(&value, &bits, sizeof(value));
+			return true;
+		}
+		bool Varint(unsigned int& value) {
+			value = 0;
+			for (int shift = 0; shift < 35; shift += 7) {
+				unsigned char b;
+				if (!Byte(b)) {
+					return false;
+				}
+				value |= (unsigned int)(b & 0x7F) << shift;
+				if (!(b & 0x80)) {
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+}
+
+InputStream::InputStream(unsigned int keys, unsigned int buttons) {
+	keyCount		= keys;
+	buttonCount		= buttons;
+	mode			= MODE_OFF;
+	damaged			= false;
+	readPosition	= 0;
+	frameCount		= 0;
+	timestamp		= 0.0;
+	ResetState(state);
+}
+
+InputStream::~InputStream(void) {
+	Stop();
+}
+
+void InputStream::ResetState(State& s) const {
+	s.keys.assign(keyCount, 0);
+	s.keyHolds.assign(keyCount, 0);
+	s.buttons.assign(buttonCount, 0);
+	s.buttonHolds.assign(buttonCount, 0);
+	s.doubleClicks.assign(buttonCount, 0);
+	s.relative	= Vector2(0.0f, 0.0f);
+	s.absolute	= Vector2(0.0f, 0.0f);
+	s.wheel		= 0;
+}
+
+bool InputStream::StartRecording(const std::string& name) {
+	Stop();
+
+	output.open(name.c_str(), std::ios::binary | std::ios::trunc);
+	if (!output.is_open()) {
+		LOG_ERROR("错误：无法创建输入录制文件 " << name);
+		return false;
+	}
+
+	buffer.assign(MAGIC, MAGIC + sizeof(MAGIC));
+	PutUint32(buffer, VERSION);
+	PutUint32(buffer, keyCount);
+	PutUint32(buffer, buttonCount);
+
+	filename	= name;
+	mode		= MODE_RECORD;
+	damaged		= false;
+	frameCount	= 0;
+	timestamp	= 0.0;
+	ResetState(state);
+	LOG_INFO("✓ 开始录制输入: " << name);
+	return true;
+}
+
+bool InputStream::StartReplay(const std::string& name) {
+	Stop();
+
+	std::ifstream input(name.c_str(), std::ios::binary);
+	if (!input.is_open()) {
+		LOG_ERROR("错误：无法打开输入录制文件 " << name);
+		return false;
+	}
+	buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+
+	//Header must match this build's key / button counts, or the codes mean
+	//something else
+	readPosition = 0;
+	Reader reader = { buffer, readPosition };
+	unsigned int version, keys, buttons;
+	bool valid = buffer.size() >= sizeof(MAGIC) && memcmp(buffer.data(), MAGIC, sizeof(MAGIC)) == 0;
+	readPosition = sizeof(MAGIC);
+	valid = valid && reader.Uint32(version) && reader.Uint32(keys) && reader.Uint32(buttons);
+	if (!valid || version != VERSION || keys != keyCount || buttons != buttonCount) {
+		LOG_ERROR("错误：" << name << " 不是有效的输入录制文件（或版本不兼容）");
+		buffer.clear();
+		readPosition = 0;
+		return false;
+	}
+
+	filename	= name;
+	mode		= MODE_REPLAY;
+	damaged		= false;
+	frameCount	= 0;
+	timestamp	= 0.0;
+	ResetState(state);
+	LOG_INFO("✓ 开始回放输入: " << name);
+	return true;
+}
+
+void InputStream::Stop() {
+	if (mode == MODE_RECORD) {
+		output.write((const char*)buffer.data(), buffer.size());
+		output.close();
+		LOG_INFO("✓ 输入录制完成: " << filename << "（" << frameCount << " 帧，"
+				 << timestamp / 1000.0 << " 秒）");
+	}
+	buffer.clear();
+	readPosition	= 0;
+	mode			= MODE_OFF;
+}
+
+void InputStream::RecordFrame(const State& current, float msec) {
+	if (mode != MODE_RECORD) {
+		return;
+	}
+	Diff(state, current, events);
+	state = current;
+	WriteFrame(msec);
+	++frameCount;
+	timestamp += msec;
+}
+
+bool InputStream::ReplayFrame(State& current, float& msec) {
+	if (mode != MODE_REPLAY || damaged) {
+		return false;
+	}
+	float recorded;
+	if (!ReadFrame(recorded)) {
+		return false;
+	}
+	Apply(events, state);
+	current	= state;
+	msec	= recorded;
+	++frameCount;
+	timestamp += msec;
+	return true;
+}
+
+/*
+Events needed to turn one state into the other. Relative movement and the wheel
+are reset every frame by UpdateHolds, so they're compared against the previous
+frame's values just like everything else.
+*/
+void InputStream::Diff(const State& from, const State& to, std::vector<Event>& out) const {
+	out.clear();
+	Event e;
+	memset(&e, 0, sizeof(e));
+
+	for (unsigned int i = 0; i < keyCount; ++i) {
+		if (from.keys[i] != to.keys[i] || from.keyHolds[i] != to.keyHolds[i]) {
+			e.type	= EVENT_KEY;
+			e.code	= (unsigned char)i;
+			e.flags	= (to.keys[i] ? 1 : 0) | (to.keyHolds[i] ? 2 : 0);
+			out.push_back(e);
+		}
+	}
+	for (unsigned int i = 0; i < buttonCount; ++i) {
+		if (from.buttons[i] != to.buttons[i] || from.buttonHolds[i] != to.buttonHolds[i] ||
+			from.doubleClicks[i] != to.doubleClicks[i]) {
+			e.type	= EVENT_BUTTON;
+			e.code	= (unsigned char)i;
+			e.flags	= (to.buttons[i] ? 1 : 0) | (to.buttonHolds[i] ? 2 : 0) | (to.doubleClicks[i] ? 4 : 0);
+			out.push_back(e);
+		}
+	}
+	if (from.relative.x != to.relative.x || from.relative.y != to.relative.y) {
+		e.type	= EVENT_RELATIVE;
+		e.code	= 0;
+		e.flags	= 0;
+		e.x		= to.relative.x;
+		e.y		= to.relative.y;
+		out.push_back(e);
+	}
+	if (from.absolute.x != to.absolute.x || from.absolute.y != to.absolute.y) {
+		e.type	= EVENT_ABSOLUTE;
+		e.x		= to.absolute.x;
+		e.y		= to.absolute.y;
+		out.push_back(e);
+	}
+	if (from.wheel != to.wheel) {
+		e.type	= EVENT_WHEEL;
+		e.flags	= (unsigned char)(signed char)to.wheel;
+		e.x		= e.y = 0.0f;
+		out.push_back(e);
+	}
+}
+
+void InputStream::Apply(const std::vector<Event>& in, State& s) const {
+	for (const Event& e : in) {
+		switch (e.type) {
+			case EVENT_KEY:
+				s.keys[e.code]		= (e.flags & 1) != 0;
+				s.keyHolds[e.code]	= (e.flags & 2) != 0;
+				break;
+			case EVENT_BUTTON:
+				s.buttons[e.code]		= (e.flags & 1) != 0;
+				s.buttonHolds[e.code]	= (e.flags & 2) != 0;
+				s.doubleClicks[e.code]	= (e.flags & 4) != 0;
+				break;
+			case EVENT_RELATIVE:
+				s.relative = Vector2(e.x, e.y);
+				break;
+			case EVENT_ABSOLUTE:
+				s.absolute = Vector2(e.x, e.y);
+				break;
+			case EVENT_WHEEL:
+				s.wheel = (signed char)e.flags;
+				break;
+		}
+	}
+}
+
+void InputStream::WriteFrame(float msec) {
+	PutFloat(buffer, msec);
+	PutVarint(buffer, (unsigned int)events.size());
+	for (const Event& e : events) {
+		buffer.push_back(e.type);
+		switch (e.type) {
+			case EVENT_KEY:
+			case EVENT_BUTTON:
+				buffer.push_back(e.code);
+				buffer.push_back(e.flags);
+				break;
+			case EVENT_RELATIVE:
+			case EVENT_ABSOLUTE:
+				PutFloat(buffer, e.x);
+				PutFloat(buffer, e.y);
+				break;
+			case EVENT_WHEEL:
+				buffer.push_back(e.flags);
+				break;
+		}
+	}
+
+	if (buffer.size() >= FLUSH_SIZE) {
+		output.write((const char*)buffer.data(), buffer.size());
+		buffer.clear();
+	}
+}
+
+bool InputStream::ReadFrame(float& msec) {
+	Reader reader = { buffer, readPosition };
+	events.clear();
+	if (readPosition >= buffer.size()) {
+		return false;	//Clean end of the recording
+	}
+
+	unsigned int count;
+	if (!reader.Float(msec) || !reader.Varint(count)) {
+		LOG_ERROR("错误：输入录制文件 " << filename << " 在第 " << frameCount << " 帧处损坏");
+		damaged = true;
+		return false;
+	}
+
+	Event e;
+	memset(&e, 0, sizeof(e));
+	for (unsigned int i = 0; i < count; ++i) {
+		bool ok = reader.Byte(e.type);
+		switch (e.type) {
+			case EVENT_KEY:
+				ok = ok && reader.Byte(e.code) && reader.Byte(e.flags) && e.code < keyCount;
+				break;
+			case EVENT_BUTTON:
+				ok = ok && reader.Byte(e.code) && reader.Byte(e.flags) && e.code < buttonCount;
+				break;
+			case EVENT_RELATIVE:
+			case EVENT_ABSOLUTE:
+				ok = ok && reader.Float(e.x) && reader.Float(e.y);
+				break;
+			case EVENT_WHEEL:
+				ok = ok && reader.Byte(e.flags);
+				break;
+			default:
+				ok = false;
+				break;
+		}
+		if (!ok) {
+			LOG_ERROR("错误：输入录制文件 " << filename << " 在第 " << frameCount << " 帧处损坏");
+			events.clear();
+			damaged = true;
+			return false;
+		}
+		events.push_back(e);
+	}
+	return true;
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+Class:InputStream
+Description:The platform independent half of InputRecorder: a per-frame
+snapshot of keyboard / mouse state plus the frame time, written to a compact
+binary file as the events that changed since the previous frame, and read
+back in the same order.
+
+It knows nothing about the Windows Keyboard / Mouse classes - InputRecorder
+copies their state into a State and back - so it can be driven with
+synthetic input (see Benchmarks/SimulationTests.cpp).
+
+File layout (little endian):
+	header : "NCLI", uint32 version, uint32 key count, uint32 button count
+	frame  : float msec, varint event count, events...
+	event  : uint8 type, then
+	         KEY      uint8 key,    uint8 flags (1 = down, 2 = held)
+	         BUTTON   uint8 button, uint8 flags (1 = down, 2 = held, 4 = double click)
+	         RELATIVE float x, float y
+	         ABSOLUTE float x, float y
+	         WHEEL    int8 movement
+
+A recording only replays with the same key and button counts, or the codes
+would mean something else. A file that ends part way through a frame, or
+holds an unknown event / out of range code, stops the replay at that frame
+with an error (IsDamaged); frames before it replay normally.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Vector2.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+class InputStream	{
+public:
+	enum Mode {
+		MODE_OFF,
+		MODE_RECORD,
+		MODE_REPLAY
+	};
+
+	enum EventType {
+		EVENT_KEY		= 0,
+		EVENT_BUTTON	= 1,
+		EVENT_RELATIVE	= 2,
+		EVENT_ABSOLUTE	= 3,
+		EVENT_WHEEL		= 4
+	};
+
+	struct Event {
+		unsigned char	type;
+		unsigned char	code;	//Key or button
+		unsigned char	flags;	//Key / button state, or signed wheel movement
+		float			x;		//Mouse position
+		float			y;
+	};
+
+	//Everything the Keyboard and Mouse public interfaces expose, one entry
+	//per key / button (non-zero = set)
+	struct State {
+		std::vector<unsigned char>	keys;
+		std::vector<unsigned char>	keyHolds;
+		std::vector<unsigned char>	buttons;
+		std::vector<unsigned char>	buttonHolds;
+		std::vector<unsigned char>	doubleClicks;
+		Vector2	relative;
+		Vector2	absolute;
+		int		wheel;
+	};
+
+	InputStream(unsigned int keyCount, unsigned int buttonCount);
+	~InputStream(void);
+
+	bool	StartRecording(const std::string& filename);
+	bool	StartReplay(const std::string& filename);
+	//Finishes writing / closes the replay
+	void	Stop();
+
+	//Appends one frame. state must be sized by ResetState.
+	void	RecordFrame(const State& current, float msec);
+	//Reads the next frame into state / msec. Returns false once the replay
+	//has run out of frames, or at a damaged frame (state is then unchanged).
+	bool	ReplayFrame(State& current, float& msec);
+
+	//All keys and buttons up, mouse at the origin
+	void	ResetState(State& s) const;
+
+	Mode	GetMode()			const { return mode; }
+	bool	IsDamaged()			const { return damaged; }
+	int		GetFrameCount()		const { return frameCount; }
+	//Total of the recorded / replayed frame times so far
+	double	GetTimestampMSec()	const { return timestamp; }
+	//Events of the most recent frame
+	const std::vector<Event>& GetFrameEvents() const { return events; }
+
+protected:
+	void	Diff(const State& from, const State& to, std::vector<Event>& out) const;
+	void	Apply(const std::vector<Event>& in, State& state) const;
+
+	void	WriteFrame(float msec);
+	bool	ReadFrame(float& msec);
+
+	unsigned int		keyCount;
+	unsigned int		buttonCount;
+	Mode				mode;
+	bool				damaged;
+	std::string			filename;
+	std::ofstream		output;
+	std::vector<unsigned char> buffer;	//Write buffer, or the whole file when replaying
+	size_t				readPosition;
+	State				state;			//State after the last processed frame
+	std::vector<Event>	events;
+	int					frameCount;
+	double				timestamp;
+};
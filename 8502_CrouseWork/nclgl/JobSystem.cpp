@@ -0,0 +1,320 @@
+#include "JobSystem.h"
+
+namespace {
+	//Which job system / deque the current thread belongs to
+	thread_local const JobSystem*	currentSystem = nullptr;
+	thread_local int				currentWorker = -1;
+
+	//Yields before a worker with nothing to do goes to sleep. Frames issue a
+	//burst of small parallel loops, and waking a sleeping thread costs more
+	//than most of them take.
+	const int SPIN_COUNT = 64;
+
+	int defaultWorkerCount = -1;
+}
+
+JobSystem::JobSystem(int workerCount) {
+	if (workerCount < 0) {
+		unsigned int hardware = std::thread::hardware_concurrency();
+		workerCount = hardware > 1 ? (int)hardware - 1 : 0;
+	}
+
+	queued		= 0;
+	sleeping	= 0;
+	quit		= false;
+	nextQueue	= 0;
+	jobsRun		= 0;
+	steals		= 0;
+
+	//A second system made on a thread (eg by a test) hands the thread back
+	//to the first one when it's destroyed
+	mainThread		= std::this_thread::get_id();
+	outerSystem		= currentSystem;
+	outerWorker		= currentWorker;
+	currentSystem	= this;
+	currentWorker	= 0;
+
+	for (int i = 0; i <= workerCount; ++i) {
+		workers.push_back(new Worker());
+	}
+	threads.reserve(workerCount);
+	for (int i = 1; i <= workerCount; ++i) {
+		threads.emplace_back(&JobSystem::WorkerLoop, this, (int)i);
+	}
+}
+
+JobSystem::~JobSystem(void) {
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		quit = true;
+	}
+	wake.notify_all();
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	for (Worker* w : workers) {
+		delete w;
+	}
+	if (currentSystem == this) {
+		currentSystem = outerSystem;
+		currentWorker = outerWorker;
+	}
+}
+
+JobSystem& JobSystem::Get() {
+	static JobSystem instance(defaultWorkerCount);
+	return instance;
+}
+
+void JobSystem::SetDefaultWorkerCount(int workerCount) {
+	defaultWorkerCount = workerCount;
+}
+
+void JobSystem::Run(Job job, JobCounter* counter, JobCounter* dependency) {
+	Start(std::move(job), counter, dependency, false);
+}
+
+void JobSystem::RunOnMainThread(Job job, JobCounter* counter, JobCounter* dependency) {
+	Start(std::move(job), counter, dependency, true);
+}
+
+void JobSystem::Start(Job&& job, JobCounter* counter, JobCounter* dependency, bool onMainThread) {
+	if (counter) {
+		counter->count.fetch_add(1);
+	}
+	if (dependency) {
+		//Finish decrements under the same lock, so either the count is still
+		//above zero and whoever takes it to zero will schedule this job, or
+		//it's already done and the job can go straight in
+		std::lock_guard<std::mutex> guard(dependency->lock);
+		if (dependency->count.load() > 0) {
+			JobCounter::Deferred* deferred;
+			{
+				std::lock_guard<std::mutex> poolGuard(deferredLock);
+				deferred = deferredPool.Create();
+			}
+			deferred->job			= std::move(job);
+			deferred->counter		= counter;
+			deferred->mainThread	= onMainThread;
+			deferred->next			= dependency->waiting;
+			dependency->waiting		= deferred;
+			return;
+		}
+	}
+	Schedule(std::move(job), counter, onMainThread);
+}
+
+void JobSystem::Schedule(Job&& job, JobCounter* counter, bool onMainThread) {
+	Task task = { std::move(job), counter };
+
+	if (onMainThread) {
+		std::lock_guard<std::mutex> guard(mainLock);
+		mainTasks.PushBack(std::move(task));
+		return;
+	}
+
+	int index = CurrentWorker();
+	if (index < 0) {
+		index = (int)(nextQueue.fetch_add(1) % workers.size());
+	}
+	{
+		std::lock_guard<std::mutex> guard(workers[index]->lock);
+		workers[index]->tasks.PushBack(std::move(task));
+	}
+
+	//A worker only sleeps after seeing queued == 0 with sleeping already
+	//raised, so either it sees this job or we see it asleep and wake it
+	queued.fetch_add(1);
+	if (sleeping.load() > 0) {
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+		}
+		wake.notify_one();
+	}
+}
+
+bool JobSystem::Pop(Task& task) {
+	int index = CurrentWorker();
+	if (index < 0) {
+		return false;
+	}
+	Worker& w = *workers[index];
+	std::lock_guard<std::mutex> guard(w.lock);
+	if (w.tasks.IsEmpty()) {
+		return false;
+	}
+	w.tasks.PopBack(task);
+	queued.fetch_sub(1);
+	return true;
+}
+
+bool JobSystem::Steal(Task& task) {
+	int self	= CurrentWorker();
+	int count	= (int)workers.size();
+	int start	= self < 0 ? 0 : self + 1;
+
+	for (int i = 0; i < count; ++i) {
+		int victim = (start + i) % count;
+		if (victim == self) {
+			continue;
+		}
+		Worker& w = *workers[victim];
+		std::lock_guard<std::mutex> guard(w.lock);
+		if (!w.tasks.IsEmpty()) {
+			w.tasks.PopFront(task);
+			queued.fetch_sub(1);
+			steals.fetch_add(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::PopMainThread(Task& task) {
+	std::lock_guard<std::mutex> guard(mainLock);
+	if (mainTasks.IsEmpty()) {
+		return false;
+	}
+	mainTasks.PopFront(task);
+	return true;
+}
+
+bool JobSystem::RunOne(bool allowMainThread) {
+	Task task;
+	if ((allowMainThread && PopMainThread(task)) || Pop(task) || Steal(task)) {
+		task.job();
+		jobsRun.fetch_add(1);
+		Finish(task.counter);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::Finish(JobCounter* counter) {
+	if (!counter) {
+		return;
+	}
+	JobCounter::Deferred* ready = nullptr;
+	{
+		std::lock_guard<std::mutex> guard(counter->lock);
+		if (counter->count.fetch_sub(1) == 1) {
+			ready				= counter->waiting;
+			counter->waiting	= nullptr;
+		}
+	}
+	if (!ready) {
+		return;
+	}
+
+	//The list is newest first; turn it round so they're queued in the order
+	//they were started
+	JobCounter::Deferred* ordered = nullptr;
+	while (ready) {
+		JobCounter::Deferred* next = ready->next;
+		ready->next	= ordered;
+		ordered		= ready;
+		ready		= next;
+	}
+	for (JobCounter::Deferred* d = ordered; d; d = d->next) {
+		Schedule(std::move(d->job), d->counter, d->mainThread);
+	}
+
+	std::lock_guard<std::mutex> poolGuard(deferredLock);
+	while (ordered) {
+		JobCounter::Deferred* next = ordered->next;
+		deferredPool.Destroy(ordered);
+		ordered = next;
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	bool main = IsMainThread();
+	while (counter.count.load() > 0) {
+		if (!RunOne(main)) {
+			std::this_thread::yield();
+		}
+	}
+	//The job that took the count to zero may still hold the lock; the
+	//counter mustn't be destroyed until it has let go
+	std::lock_guard<std::mutex> guard(counter.lock);
+}
+
+int JobSystem::RunMainThreadJobs() {
+	//Only what was queued already, so a job that queues another for next
+	//frame can't keep this going forever
+	size_t count;
+	{
+		std::lock_guard<std::mutex> guard(mainLock);
+		count = mainTasks.GetSize();
+	}
+
+	int ran = 0;
+	Task task;
+	while ((size_t)ran < count && PopMainThread(task)) {
+		task.job();
+		jobsRun.fetch_add(1);
+		Finish(task.counter);
+		++ran;
+	}
+	return ran;
+}
+
+JobSystem::Stats JobSystem::GetStats() const {
+	Stats stats;
+	stats.jobsRun	= jobsRun.load();
+	stats.steals	= steals.load();
+	return stats;
+}
+
+void JobSystem::TaskQueue::PushBack(Task&& task) {
+	if (count == items.size()) {
+		//Unwrap into a buffer twice the size
+		std::vector<Task> grown(std::max(items.size() * 2, (size_t)64));
+		for (size_t i = 0; i < count; ++i) {
+			grown[i] = std::move(items[(head + i) % items.size()]);
+		}
+		items.swap(grown);
+		head = 0;
+	}
+	items[(head + count) % items.size()] = std::move(task);
+	++count;
+}
+
+//Moving out leaves an empty std::function behind, so whatever the job
+//captured is released now rather than when the slot is next reused
+void JobSystem::TaskQueue::PopBack(Task& task) {
+	task = std::move(items[(head + count - 1) % items.size()]);
+	--count;
+}
+
+void JobSystem::TaskQueue::PopFront(Task& task) {
+	task = std::move(items[head]);
+	head = (head + 1) % items.size();
+	--count;
+}
+
+int JobSystem::CurrentWorker() const {
+	return currentSystem == this ? currentWorker : -1;
+}
+
+void JobSystem::WorkerLoop(int index) {
+	currentSystem = this;
+	currentWorker = index;
+
+	while (!quit) {
+		if (RunOne(false)) {
+			continue;
+		}
+		for (int spin = 0; spin < SPIN_COUNT && queued.load() == 0 && !quit; ++spin) {
+			std::this_thread::yield();
+		}
+		if (queued.load() > 0) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepLock);
+		sleeping.fetch_add(1);
+		wake.wait(lock, [this]() { return quit || queued.load() > 0; });
+		sleeping.fetch_sub(1);
+	}
+}
@@ -0,0 +1,213 @@
+/******************************************************************************
+Class:JobSystem
+Description:A pool of worker threads that run small jobs (std::function<void()>).
+
+Each worker owns a deque of jobs. A thread pushes and pops at the back of its
+own deque (newest first, so recently touched data is still in cache), and when
+it runs dry it steals from the front of somebody else's (oldest first, which
+tends to be the biggest piece of work left). The main thread has a deque of
+its own and takes part whenever it waits.
+
+Completion is tracked with JobCounters: every job started with a counter adds
+one to it, and subtracts one when it finishes. Wait(counter) keeps running
+other jobs until the counter gets back to zero, so waiting inside a job (eg a
+nested ParallelFor) can't deadlock. A job can also be given a dependency - it
+isn't queued at all until that counter reaches zero.
+
+Jobs held back by a dependency wait in a list on the counter, in nodes taken
+from a pool (see PoolAllocator.h) that the job system keeps, so once the
+busiest frame has been seen, dependencies don't allocate either.
+
+OpenGL calls must stay on the thread that owns the context, so jobs started
+with RunOnMainThread go into a separate queue that only the main thread runs:
+when it waits, and in RunMainThreadJobs (call once per frame).
+
+Get() creates the shared instance with one worker per hardware thread, minus
+one for the main thread, unless SetDefaultWorkerCount picked another number
+first (tests and benchmarks use it to get real thread sweeps on any machine).
+The first call must come from the main thread.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter	{
+public:
+	JobCounter(void) : count(0), waiting(nullptr) {}
+
+	//Only safe to destroy once Wait has returned - a job might still be
+	//finishing off when IsDone first reports true
+	bool	IsDone()		const { return count.load() == 0; }
+	int		GetPending()	const { return count.load(); }
+
+protected:
+	friend class JobSystem;
+
+	struct Deferred {
+		std::function<void()>	job;
+		JobCounter*				counter;
+		bool					mainThread;
+		Deferred*				next;
+	};
+
+	std::atomic<int>		count;
+	std::mutex				lock;
+	Deferred*				waiting;	//Jobs that depend on this counter, newest first
+
+	JobCounter(const JobCounter&);
+	JobCounter& operator=(const JobCounter&);
+};
+
+class JobSystem	{
+public:
+	typedef std::function<void()> Job;
+
+	//Totals since the job system was created, for profiling
+	struct Stats {
+		unsigned long long	jobsRun;
+		unsigned long long	steals;
+	};
+
+	//workerCount < 0 : one per hardware thread, less the main thread
+	explicit JobSystem(int workerCount = -1);
+	~JobSystem(void);
+
+	static JobSystem& Get();
+
+	//Worker count for the shared instance. Only has an effect before the
+	//first call to Get()
+	static void SetDefaultWorkerCount(int workerCount);
+
+	//Queues job on the calling thread's deque (any worker can steal it).
+	//counter, if given, is incremented now and decremented when the job ends.
+	//dependency, if given, holds the job back until it reaches zero.
+	void	Run(Job job, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	void	RunOnMainThread(Job job, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	//Runs jobs until counter reaches zero
+	void	Wait(JobCounter& counter);
+
+	//Runs the main thread jobs queued so far. Returns how many ran.
+	int		RunMainThreadJobs();
+
+	/*
+	Calls func(i) for every i in [0, count). Indices are handed out grain at a
+	time through an atomic counter, so each is processed exactly once whichever
+	thread gets it, and uneven work balances itself out. maxThreads limits how
+	many threads (including the caller) take part; 0 = all of them.
+	*/
+	template <typename Func>
+	void	ParallelFor(int count, int grain, const Func& func, unsigned int maxThreads = 0);
+
+	unsigned int	GetWorkerCount()	const { return (unsigned int)threads.size(); }
+	bool			IsMainThread()		const { return std::this_thread::get_id() == mainThread; }
+	Stats			GetStats()			const;
+
+protected:
+	struct Task {
+		Job			job;
+		JobCounter*	counter;
+	};
+
+	//Ring buffer used as a deque. It doubles when full and never shrinks, so
+	//once it's big enough queueing a job doesn't allocate (std::deque can
+	//allocate a block for every element)
+	struct TaskQueue {
+		std::vector<Task>	items;
+		size_t				head;
+		size_t				count;
+
+		TaskQueue(void) : head(0), count(0) {}
+
+		bool	IsEmpty()	const { return count == 0; }
+		size_t	GetSize()	const { return count; }
+		void	PushBack(Task&& task);
+		void	PopBack(Task& task);
+		void	PopFront(Task& task);
+	};
+
+	struct Worker {
+		std::mutex	lock;
+		TaskQueue	tasks;
+	};
+
+	void	Start(Job&& job, JobCounter* counter, JobCounter* dependency, bool onMainThread);
+	void	Schedule(Job&& job, JobCounter* counter, bool onMainThread);
+	bool	Pop(Task& task);		//Own deque, newest first
+	bool	Steal(Task& task);		//Someone else's, oldest first
+	bool	PopMainThread(Task& task);
+	bool	RunOne(bool allowMainThread);
+	void	Finish(JobCounter* counter);
+	int		CurrentWorker() const;	//Index into workers, or -1 for outside threads
+	void	WorkerLoop(int index);
+
+	std::vector<Worker*>		workers;	//[0] belongs to the main thread
+	const JobSystem*			outerSystem;	//What the creating thread belonged to before
+	int							outerWorker;
+	std::vector<std::thread>	threads;
+	std::thread::id				mainThread;
+
+	std::mutex					mainLock;
+	TaskQueue					mainTasks;
+
+	std::mutex								deferredLock;
+	ObjectPool<JobCounter::Deferred>		deferredPool;	//Nodes for JobCounter::waiting
+
+	std::atomic<int>			queued;		//Tasks sitting in any worker deque
+	std::atomic<int>			sleeping;
+	std::atomic<bool>			quit;
+	std::atomic<unsigned int>	nextQueue;	//Round robin for outside threads
+	std::mutex					sleepLock;
+	std::condition_variable		wake;
+
+	std::atomic<unsigned long long>	jobsRun;
+	std::atomic<unsigned long long>	steals;
+};
+
+template <typename Func>
+void JobSystem::ParallelFor(int count, int grain, const Func& func, unsigned int maxThreads) {
+	if (count <= 0) {
+		return;
+	}
+	if (grain < 1) {
+		grain = 1;
+	}
+	int chunks		= (count + grain - 1) / grain;
+	int helpers		= std::min(chunks, (int)GetWorkerCount() + 1) - 1;
+	if (maxThreads > 0) {
+		helpers = std::min(helpers, (int)maxThreads - 1);
+	}
+	if (helpers <= 0) {
+		for (int i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::atomic<int> next(0);
+	auto body = [&]() {
+		for (int begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain)) {
+			int end = std::min(begin + grain, count);
+			for (int i = begin; i < end; ++i) {
+				func(i);
+			}
+		}
+	};
+
+	//The jobs only hold a pointer to body, so std::function can store them
+	//without allocating
+	JobCounter done;
+	for (int h = 0; h < helpers; ++h) {
+		Run([&body]() { body(); }, &done);
+	}
+	body();
+	Wait(done);
+}
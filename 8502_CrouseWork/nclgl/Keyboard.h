@@ -172,6 +172,7 @@ enum KeyboardKeys {
 class Keyboard : public InputDevice	{
 public:
 	friend class Window;
+	friend class InputRecorder;	//Records / replays the device state
 
 	//Is this key currently pressed down?
 	bool KeyDown(KeyboardKeys key);
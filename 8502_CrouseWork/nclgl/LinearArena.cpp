@@ -0,0 +1,132 @@
+#include "LinearArena.h"
+#include <algorithm>
+#include <cstdint>
+
+LinearArena::LinearArena(size_t capacity) : memory(MEMORY_TRANSIENT, MEMORY_CPU) {
+	Block block;
+	block.size	= std::max(capacity, (size_t)64);
+	block.data	= (char*)::operator new(block.size);
+	blocks.push_back(block);
+
+	current	= 0;
+	offset	= 0;
+	used	= 0;
+	peak	= 0;
+	memory.Set(block.size);
+}
+
+LinearArena::~LinearArena(void) {
+	for (Block& b : blocks) {
+		::operator delete(b.data);
+	}
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment) {
+	if (size == 0) {
+		size = 1;
+	}
+	for (;;) {
+		Block&		b		= blocks[current];
+		uintptr_t	base	= (uintptr_t)b.data;
+		uintptr_t	at		= (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t		end		= (size_t)(at - base) + size;
+
+		if (end <= b.size) {
+			used	+= end - offset;
+			offset	= end;
+			peak	= std::max(peak, used);
+			return (void*)at;
+		}
+
+		//Move on to the next block if a rewind left one behind, otherwise
+		//chain on a new one. Either way the rest of this one goes unused
+		//until the arena is emptied and the blocks get merged.
+		if (current + 1 < blocks.size()) {
+			++current;
+			offset = 0;
+			continue;
+		}
+		Block block;
+		block.size	= std::max(b.size * 2, size + alignment);
+		block.data	= (char*)::operator new(block.size);
+		blocks.push_back(block);
+		current	= blocks.size() - 1;
+		offset	= 0;
+		memory.Set(GetCapacity());
+	}
+}
+
+LinearArena::Marker LinearArena::GetMarker() const {
+	Marker marker = { current, offset, used };
+	return marker;
+}
+
+void LinearArena::Rewind(const Marker& marker) {
+	current	= marker.block;
+	offset	= marker.offset;
+	used	= marker.used;
+	if (used == 0) {
+		Coalesce();
+	}
+}
+
+void LinearArena::Reset() {
+	Marker start = { 0, 0, 0 };
+	Rewind(start);
+}
+
+size_t LinearArena::GetCapacity() const {
+	size_t total = 0;
+	for (const Block& b : blocks) {
+		total += b.size;
+	}
+	return total;
+}
+
+LinearArena& LinearArena::Scratch() {
+	thread_local LinearArena arena;
+	return arena;
+}
+
+//Only called when nothing is allocated, so the blocks can be swapped for a
+//single one that holds what they all did
+void LinearArena::Coalesce() {
+	if (blocks.size() < 2) {
+		return;
+	}
+	size_t total = GetCapacity();
+	for (Block& b : blocks) {
+		::operator delete(b.data);
+	}
+	blocks.clear();
+
+	Block block;
+	block.size	= total;
+	block.data	= (char*)::operator new(block.size);
+	blocks.push_back(block);
+	current	= 0;
+	offset	= 0;
+}
+
+void ArenaCommandList::Execute() {
+	for (Command* c = first; c; ) {
+		Command* next = c->next;
+		c->run(c);
+		c->destroy(c);
+		c = next;
+	}
+	first	= nullptr;
+	last	= nullptr;
+	count	= 0;
+}
+
+void ArenaCommandList::Clear() {
+	for (Command* c = first; c; ) {
+		Command* next = c->next;
+		c->destroy(c);
+		c = next;
+	}
+	first	= nullptr;
+	last	= nullptr;
+	count	= 0;
+}
@@ -0,0 +1,204 @@
+/******************************************************************************
+Class:LinearArena
+Description:A bump allocator for short lived data - per frame command lists,
+scratch arrays used for the length of one function, that sort of thing.
+
+Allocating is just moving an offset along; nothing is freed individually.
+Reset() throws everything away at once (once a frame, say), and a Marker taken
+with GetMarker() can be rewound to, which frees everything allocated since in
+one go - ArenaScope does that automatically at the end of a block.
+
+If a block fills up another, bigger one is chained on. When the arena is next
+emptied the blocks are merged into a single one that's big enough for all of
+them, so after the first few frames it stops touching the heap at all.
+
+Destructors aren't called for anything in the arena, so only put things there
+that don't need one (or see ArenaCommandList, which does call them).
+
+Scratch() gives each thread its own arena, for temporary arrays that would
+otherwise be a std::vector allocated on every call. Always use it through an
+ArenaScope, so whatever is allocated is given back when the function returns.
+
+ArenaAllocator lets standard containers allocate from an arena; memory given
+back to it isn't reused until the arena is rewound, so reserve() up front
+rather than letting a vector grow a step at a time.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "MemoryTracker.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class LinearArena	{
+public:
+	struct Marker {
+		size_t	block;
+		size_t	offset;
+		size_t	used;
+	};
+
+	explicit LinearArena(size_t capacity = 64 * 1024);
+	~LinearArena(void);
+
+	void*	Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	//Uninitialised space for count Ts
+	template <typename T>
+	T*		AllocateArray(size_t count) {
+		return (T*)Allocate(sizeof(T) * count, alignof(T));
+	}
+
+	//Constructs a T in the arena. Its destructor will never be called.
+	template <typename T, typename... Args>
+	T*		Create(Args&&... args) {
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	Marker	GetMarker() const;
+	void	Rewind(const Marker& marker);
+	void	Reset();
+
+	size_t	GetUsed()		const { return used; }
+	size_t	GetCapacity()	const;
+	size_t	GetPeak()		const { return peak; }	//Most that's ever been in use at once
+
+	//This thread's scratch arena
+	static LinearArena& Scratch();
+
+protected:
+	struct Block {
+		char*	data;
+		size_t	size;
+	};
+
+	void	Coalesce();
+
+	std::vector<Block>	blocks;
+	size_t				current;	//Block being allocated from
+	size_t				offset;		//Into blocks[current]
+	size_t				used;		//Bytes handed out, across all blocks
+	size_t				peak;
+	TrackedMemory		memory;		//Blocks allocated, under MEMORY_TRANSIENT
+
+	LinearArena(const LinearArena&);
+	LinearArena& operator=(const LinearArena&);
+};
+
+//Rewinds an arena to where it was when the scope was entered
+class ArenaScope	{
+public:
+	explicit ArenaScope(LinearArena& arena) : arena(arena), marker(arena.GetMarker()) {}
+	~ArenaScope(void) { arena.Rewind(marker); }
+
+	LinearArena& GetArena() const { return arena; }
+
+protected:
+	LinearArena&		arena;
+	LinearArena::Marker	marker;
+
+	ArenaScope(const ArenaScope&);
+	ArenaScope& operator=(const ArenaScope&);
+};
+
+//Standard library allocator that takes its memory from a LinearArena
+template <typename T>
+class ArenaAllocator	{
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(LinearArena& arena) : arena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.GetArena()) {}
+
+	T*		allocate(size_t count)				{ return arena->AllocateArray<T>(count); }
+	void	deallocate(T*, size_t)				{}
+
+	LinearArena* GetArena() const { return arena; }
+
+protected:
+	LinearArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+	return a.GetArena() == b.GetArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+	return a.GetArena() != b.GetArena();
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/*
+A list of callables stored in an arena, run in the order they were added.
+Unlike std::function, nothing is allocated on the heap however much the
+callable captures. Execute() runs and destroys them; the memory itself goes
+back when the owner resets the arena, so the list must be executed or cleared
+before that.
+*/
+class ArenaCommandList	{
+public:
+	explicit ArenaCommandList(LinearArena& arena) : arena(arena), first(nullptr), last(nullptr), count(0) {}
+	~ArenaCommandList(void) { Clear(); }
+
+	template <typename Func>
+	void	Add(Func&& func);
+
+	void	Execute();		//Runs every command, then empties the list
+	void	Clear();		//Empties the list without running anything
+
+	bool	IsEmpty()	const { return first == nullptr; }
+	int		GetCount()	const { return count; }
+
+protected:
+	struct Command {
+		void		(*run)(Command*);
+		void		(*destroy)(Command*);
+		Command*	next;
+	};
+
+	template <typename Func>
+	struct Holder : Command {
+		Func func;
+
+		explicit Holder(Func&& f) : func(std::move(f)) {}
+
+		static void Run(Command* c)		{ static_cast<Holder*>(c)->func(); }
+		static void Destroy(Command* c)	{ static_cast<Holder*>(c)->~Holder(); }
+	};
+
+	LinearArena&	arena;
+	Command*		first;
+	Command*		last;
+	int				count;
+
+	ArenaCommandList(const ArenaCommandList&);
+	ArenaCommandList& operator=(const ArenaCommandList&);
+};
+
+template <typename Func>
+void ArenaCommandList::Add(Func&& func) {
+	typedef Holder<typename std::decay<Func>::type> Type;
+
+	Type* h		= arena.Create<Type>(typename std::decay<Func>::type(std::forward<Func>(func)));
+	h->run		= &Type::Run;
+	h->destroy	= &Type::Destroy;
+	h->next		= nullptr;
+
+	if (last) {
+		last->next = h;
+	}
+	else {
+		first = h;
+	}
+	last = h;
+	++count;
+}
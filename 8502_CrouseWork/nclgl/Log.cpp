@@ -0,0 +1,465 @@
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+	const size_t	RING_SIZE		= 512;	//Messages per thread
+	const int		WRITE_INTERVAL	= 5;	//Milliseconds between idle passes
+
+	struct Record {
+		unsigned long long	sequence;
+		LogLevel			level;
+		size_t				length;
+		char				text[LOG_MESSAGE_SIZE];
+	};
+
+	//Single producer (the owning thread), single consumer (the writer).
+	//head and tail only ever go up; the slot is index % RING_SIZE.
+	struct ThreadRing {
+		Record				records[RING_SIZE];
+		std::atomic<size_t>	head;
+		std::atomic<size_t>	tail;
+		std::atomic<bool>	retired;	//Owning thread has exited
+
+		ThreadRing(void) : head(0), tail(0), retired(false) {}
+	};
+
+	enum WriterState {
+		WRITER_NOT_STARTED,
+		WRITER_RUNNING,
+		WRITER_STOPPED
+	};
+
+	//Zero initialised before any constructor runs, like the counters in
+	//MemoryTracker, so logging from static init / shutdown is safe
+	std::atomic<int>					state;
+	std::atomic<int>					minimumLevel;
+	std::atomic<unsigned long long>		nextSequence;
+	std::atomic<unsigned long long>		stalls;
+	std::atomic<int>					pushing;	//Threads part way through putting a message in a ring
+	std::mutex							directLock;	//Constant initialised too
+	std::atomic<std::ostream*>			outStream;	//nullptr = std::cout
+	std::atomic<std::ostream*>			errStream;	//nullptr = std::cerr
+
+	std::ostream& GetStream(bool isError) {
+		std::ostream* stream = (isError ? errStream : outStream).load(std::memory_order_acquire);
+		return stream ? *stream : (isError ? std::cerr : std::cout);
+	}
+
+	//Held by Stop until the rings are empty, so a thread's message can't
+	//overtake the ones it left in its ring
+	void WriteDirect(LogLevel level, const char* text, size_t length) {
+		std::lock_guard<std::mutex> guard(directLock);
+		std::ostream& out = GetStream(level >= LOG_LEVEL_WARNING);
+		out.write(text, length);
+		out << '\n';
+		out.flush();
+	}
+
+	class Writer	{
+	public:
+		Writer(void) : quit(false), woken(false), passes(0), flushTarget(0) {
+			batch.reserve(RING_SIZE);
+			thread = std::thread(&Writer::Run, this);
+			state = WRITER_RUNNING;
+		}
+
+		~Writer(void) {
+			Stop();
+		}
+
+		ThreadRing* Register() {
+			ThreadRing* ring = new ThreadRing();
+			std::lock_guard<std::mutex> guard(lock);
+			rings.push_back(ring);
+			return ring;
+		}
+
+		//A thread whose ring is filling up. The flag is what makes the writer
+		//go round again - a bare notify would fail the wait's predicate and
+		//it would go back to sleep for the rest of the interval
+		void Wake() {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				woken = true;
+			}
+			wake.notify_one();
+		}
+
+		void Flush() {
+			std::unique_lock<std::mutex> guard(lock);
+			//The pass that's running now may already have gone past the
+			//caller's ring, so wait for the one after it to finish too
+			unsigned long long target = passes + 2;
+			flushTarget = std::max(flushTarget, target);
+			wake.notify_one();
+			flushed.wait(guard, [&]() { return passes >= target || quit; });
+		}
+
+		void Stop() {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (quit) {
+					return;
+				}
+				quit = true;
+			}
+			wake.notify_one();
+			thread.join();
+
+			//A thread that got past the state check before this still puts
+			//its message in a ring - keep emptying them until it's done, and
+			//only then let anyone write directly
+			std::lock_guard<std::mutex> direct(directLock);
+			state = WRITER_STOPPED;
+			while (pushing.load() > 0) {
+				Drain();
+				std::this_thread::yield();
+			}
+			Drain();
+			flushed.notify_all();
+			//Rings still owned by live threads are left alone - those
+			//threads can still be holding on to them
+		}
+
+	protected:
+		void Run() {
+			std::unique_lock<std::mutex> guard(lock);
+			while (!quit) {
+				wake.wait_for(guard, std::chrono::milliseconds(WRITE_INTERVAL),
+					[&]() { return quit || woken || passes < flushTarget; });
+				woken = false;
+				guard.unlock();
+				Drain();
+				guard.lock();
+				++passes;
+				flushed.notify_all();
+			}
+			guard.unlock();
+			Drain();
+		}
+
+		void Drain() {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				active = rings;
+			}
+
+			batch.clear();
+			for (ThreadRing* ring : active) {
+				//Read before emptying it - if the thread had already gone,
+				//nothing more can arrive and the ring can be deleted after
+				bool	retired	= ring->retired.load(std::memory_order_acquire);
+				size_t	head	= ring->head.load(std::memory_order_relaxed);
+				size_t	tail	= ring->tail.load(std::memory_order_acquire);
+				for (; head != tail; ++head) {
+					batch.push_back(ring->records[head % RING_SIZE]);
+				}
+				ring->head.store(head, std::memory_order_release);
+
+				if (retired) {
+					std::lock_guard<std::mutex> guard(lock);
+					rings.erase(std::find(rings.begin(), rings.end(), ring));
+					delete ring;
+				}
+			}
+			if (batch.empty()) {
+				return;
+			}
+
+			//Each ring is already in order; this interleaves the threads
+			//the way their messages were actually logged
+			std::sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+				return a.sequence < b.sequence;
+			});
+
+			std::ostream&	normal		= GetStream(false);
+			std::ostream&	errors		= GetStream(true);
+			bool			wroteOut	= false;
+			bool			wroteErr	= false;
+			for (const Record& r : batch) {
+				bool			isError	= r.level >= LOG_LEVEL_WARNING;
+				std::ostream&	out		= isError ? errors : normal;
+				//Keep the two streams in order where they share a console
+				if (isError && wroteOut) {
+					normal.flush();
+					wroteOut = false;
+				}
+				out.write(r.text, r.length);
+				out << '\n';
+				(isError ? wroteErr : wroteOut) = true;
+			}
+			if (wroteOut) {
+				normal.flush();
+			}
+			if (wroteErr) {
+				errors.flush();
+			}
+		}
+
+		std::thread					thread;
+		std::mutex					lock;
+		std::condition_variable		wake;
+		std::condition_variable		flushed;
+		bool						quit;
+		bool						woken;
+		unsigned long long			passes;
+		unsigned long long			flushTarget;
+		std::vector<ThreadRing*>	rings;
+		std::vector<ThreadRing*>	active;		//Writer's copy of rings
+		std::vector<Record>			batch;
+	};
+
+	Writer& GetWriter() {
+		static Writer writer;
+		return writer;
+	}
+
+	//Marks the thread's ring as finished when the thread exits, so the
+	//writer can delete it once it's empty
+	struct RingOwner {
+		ThreadRing* ring;
+
+		RingOwner(void) : ring(nullptr) {}
+		~RingOwner(void) {
+			if (ring) {
+				ring->retired.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local RingOwner currentRing;
+
+	//pushing goes up before state is read, and Stop changes state before
+	//reading pushing, so either this sees the writer stopped or Stop sees
+	//this push and waits for it
+	void Push(LogLevel level, const char* text, size_t length) {
+		pushing.fetch_add(1);
+		if (state.load() == WRITER_STOPPED) {
+			pushing.fetch_sub(1);
+			WriteDirect(level, text, length);
+			return;
+		}
+		Writer& writer = GetWriter();
+
+		ThreadRing* ring = currentRing.ring;
+		if (!ring) {
+			ring = writer.Register();
+			currentRing.ring = ring;
+		}
+
+		size_t tail = ring->tail.load(std::memory_order_relaxed);
+		size_t head = ring->head.load(std::memory_order_acquire);
+		if (tail - head >= RING_SIZE) {
+			++stalls;
+			//Once the writer has gone, Stop empties the ring instead
+			do {
+				writer.Wake();
+				std::this_thread::yield();
+				head = ring->head.load(std::memory_order_acquire);
+			} while (tail - head >= RING_SIZE);
+		}
+
+		Record& r	= ring->records[tail % RING_SIZE];
+		r.sequence	= nextSequence.fetch_add(1, std::memory_order_relaxed);
+		r.level		= level;
+		r.length	= length;
+		memcpy(r.text, text, length);
+		ring->tail.store(tail + 1, std::memory_order_release);
+		pushing.fetch_sub(1, std::memory_order_release);
+
+		//Don't wait for the next idle pass if the ring is getting full
+		if (tail + 1 - head == RING_SIZE / 2) {
+			writer.Wake();
+		}
+	}
+}
+
+void Log::SetLevel(LogLevel level) {
+	minimumLevel = level;
+}
+
+LogLevel Log::GetLevel() {
+	return (LogLevel)minimumLevel.load(std::memory_order_relaxed);
+}
+
+void Log::Write(LogLevel level, const char* text, size_t length) {
+	if (!IsEnabled(level)) {
+		return;
+	}
+	//Too long for one record - break it at the last line end that fits,
+	//or failing that between two UTF-8 characters
+	while (length > LOG_MESSAGE_SIZE) {
+		size_t cut = LOG_MESSAGE_SIZE;
+		while (cut > 0 && text[cut - 1] != '\n') {
+			--cut;
+		}
+		size_t skip = 1;
+		if (cut == 0) {
+			cut		= LOG_MESSAGE_SIZE;
+			skip	= 0;
+			while (cut > 1 && ((unsigned char)text[cut] & 0xC0) == 0x80) {
+				--cut;
+			}
+		}
+		else {
+			--cut;
+		}
+		Push(level, text, cut);
+		text	+= cut + skip;
+		length	-= cut + skip;
+	}
+	Push(level, text, length);
+}
+
+void Log::Flush() {
+	if (state.load() == WRITER_RUNNING) {
+		GetWriter().Flush();
+	}
+}
+
+void Log::Shutdown() {
+	if (state.load() == WRITER_RUNNING) {
+		GetWriter().Stop();
+	}
+}
+
+void Log::SetStreams(std::ostream& out, std::ostream& err) {
+	Flush();
+	outStream.store(&out == &std::cout ? nullptr : &out, std::memory_order_release);
+	errStream.store(&err == &std::cerr ? nullptr : &err, std::memory_order_release);
+}
+
+unsigned long long Log::GetStallCount() {
+	return stalls.load();
+}
+
+void LogLine::Append(const char* source, size_t count) {
+	size_t room = LOG_MESSAGE_SIZE - length;
+	if (count > room) {
+		//Don't leave half a UTF-8 character at the end
+		count = room;
+		while (count > 0 && ((unsigned char)source[count] & 0xC0) == 0x80) {
+			--count;
+		}
+	}
+	memcpy(text + length, source, count);
+	length += count;
+}
+
+LogLine& LogLine::operator<<(const char* value) {
+	if (value) {
+		Append(value, strlen(value));
+	}
+	return *this;
+}
+
+LogLine& LogLine::operator<<(const std::string& value) {
+	Append(value.data(), value.size());
+	return *this;
+}
+
+LogLine& LogLine::operator<<(char c) {
+	Append(&c, 1);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(bool value) {
+	//What an ostream prints without boolalpha
+	return *this << (value ? "1" : "0");
+}
+
+namespace {
+	//Integers are by far the most common thing logged, and snprintf costs
+	//more than the rest of the call put together
+	void AppendUnsigned(LogLine& line, unsigned long long value, bool negative) {
+		char	buffer[24];
+		char*	end	= buffer + sizeof(buffer);
+		char*	at	= end;
+		do {
+			*--at = (char)('0' + value % 10);
+			value /= 10;
+		} while (value > 0);
+		if (negative) {
+			*--at = '-';
+		}
+		line.Append(at, end - at);
+	}
+
+	void AppendSigned(LogLine& line, long long value) {
+		//Negated as unsigned so the most negative value works too
+		bool negative = value < 0;
+		AppendUnsigned(line, negative ? 0 - (unsigned long long)value : (unsigned long long)value, negative);
+	}
+
+	template <typename T>
+	void AppendFormatted(LogLine& line, const char* format, T value) {
+		char buffer[32];
+		int count = snprintf(buffer, sizeof(buffer), format, value);
+		if (count > 0) {
+			line.Append(buffer, std::min((size_t)count, sizeof(buffer) - 1));
+		}
+	}
+}
+
+LogLine& LogLine::operator<<(int value) {
+	AppendSigned(*this, value);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(unsigned int value) {
+	AppendUnsigned(*this, value, false);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(long value) {
+	AppendSigned(*this, value);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(unsigned long value) {
+	AppendUnsigned(*this, value, false);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(long long value) {
+	AppendSigned(*this, value);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(unsigned long long value) {
+	AppendUnsigned(*this, value, false);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(double value) {
+	AppendFormatted(*this, "%g", value);
+	return *this;
+}
+
+LogLine& LogLine::operator<<(const void* pointer) {
+	AppendFormatted(*this, "%p", pointer);
+	return *this;
+}
+
+bool LogRateLimit::Allow(double seconds, unsigned int& skippedOut) {
+	typedef std::chrono::steady_clock Clock;
+	long long now		= Clock::now().time_since_epoch().count();
+	long long interval	= std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)).count();
+
+	long long previous = last.load(std::memory_order_relaxed);
+	if ((previous != 0 && now - previous < interval) ||
+		!last.compare_exchange_strong(previous, now)) {
+		skipped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	skippedOut = skipped.exchange(0);
+	return true;
+}
@@ -0,0 +1,189 @@
+/******************************************************************************
+Class:Log
+Description:Leveled logging that keeps console output off the calling thread.
+
+Use the macros rather than the class directly:
+
+	LOG_INFO("Loaded " << count << " textures");
+	LOG_ERROR("错误：无法打开 " << path);
+
+The message is formatted into a fixed size LogLine on the caller's stack (no
+heap allocation, longer messages are cut short) and pushed into a ring buffer
+owned by the calling thread. Each ring has exactly one writer and one reader,
+so pushing is a couple of atomic loads and a store - no lock, and no flush.
+A background thread empties every ring every few milliseconds, puts the
+messages back into the order they were logged in and writes them out, with a
+single flush per batch. Debug and info messages go to std::cout, warnings and
+errors to std::cerr. If a thread manages to fill its ring it waits for the
+writer rather than dropping anything.
+
+LOG_COMPILE_LEVEL (0 debug, 1 info, 2 warning, 3 error, 4 none) removes calls
+below it at compile time, arguments and all. It defaults to debug in _DEBUG
+builds and info otherwise. SetLevel filters at run time on top of that.
+
+The _LIMITED versions are for code that could fail every frame - each call
+site prints at most once per LOG_REPEAT_SECONDS, and the next message that
+does get through says how many were skipped.
+
+Flush waits until everything logged before the call has been written, which
+is needed before writing to std::cout directly (tables, prompts) so the two
+don't interleave. Shutdown flushes and stops the writer; anything logged
+after that is written straight away on the calling thread. Other threads can
+keep logging while it runs - nothing is lost, and each thread's messages
+still come out in order.
+
+SetStreams sends the output somewhere other than std::cout / std::cerr, so
+the tests can read back what was written and the benchmarks can time a call
+without filling the console. It flushes first, so everything logged before
+it goes to the old streams.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+enum LogLevel {
+	LOG_LEVEL_DEBUG,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_ERROR,
+	LOG_LEVEL_NONE
+};
+
+#ifndef LOG_COMPILE_LEVEL
+#ifdef _DEBUG
+#define LOG_COMPILE_LEVEL 0
+#else
+#define LOG_COMPILE_LEVEL 1
+#endif
+#endif
+
+#define LOG_REPEAT_SECONDS 2.0
+
+const size_t LOG_MESSAGE_SIZE = 248;
+
+class Log	{
+public:
+	static void		SetLevel(LogLevel level);
+	static LogLevel	GetLevel();
+	static bool		IsEnabled(LogLevel level) { return level >= GetLevel(); }
+
+	//Copies text (length bytes, not null terminated) into the calling
+	//thread's ring buffer. Text longer than LOG_MESSAGE_SIZE is split into
+	//several messages, at line ends where possible (eg shader logs).
+	static void		Write(LogLevel level, const char* text, size_t length);
+
+	static void		Flush();
+	static void		Shutdown();
+
+	//Pass std::cout, std::cerr to put it back. The streams have to outlive
+	//the next Flush / SetStreams.
+	static void		SetStreams(std::ostream& out, std::ostream& err);
+
+	//Messages that had to wait for space in a full ring, since start up
+	static unsigned long long	GetStallCount();
+};
+
+//A message being built on the stack. Mirrors the bits of ostream the program
+//uses: strings, characters, integers and floating point (printed with %g,
+//like a stream with default settings).
+class LogLine	{
+public:
+	explicit LogLine(LogLevel level) : level(level), length(0) {}
+
+	LogLine&	operator<<(const char* text);
+	LogLine&	operator<<(const std::string& text);
+	LogLine&	operator<<(char c);
+	LogLine&	operator<<(bool value);
+	LogLine&	operator<<(int value);
+	LogLine&	operator<<(unsigned int value);
+	LogLine&	operator<<(long value);
+	LogLine&	operator<<(unsigned long value);
+	LogLine&	operator<<(long long value);
+	LogLine&	operator<<(unsigned long long value);
+	LogLine&	operator<<(double value);
+	LogLine&	operator<<(float value) { return *this << (double)value; }
+	LogLine&	operator<<(const void* pointer);
+
+	void		Append(const char* text, size_t count);
+	void		Submit() { Log::Write(level, text, length); }
+
+protected:
+	LogLevel	level;
+	size_t		length;
+	char		text[LOG_MESSAGE_SIZE];
+};
+
+//Lets through one call per interval. Lives as a static at the call site.
+class LogRateLimit	{
+public:
+	LogRateLimit(void) : last(0), skipped(0) {}
+
+	//skipped is set to how many calls were turned away since the last one
+	//that got through
+	bool	Allow(double seconds, unsigned int& skipped);
+
+protected:
+	std::atomic<long long>		last;		//Steady clock ticks, 0 = never
+	std::atomic<unsigned int>	skipped;
+};
+
+//The message is everything inside the brackets, commas in template arguments
+//(duration<double, std::milli>) included
+#define LOG_AT(level, ...) \
+	do { \
+		if (Log::IsEnabled(level)) { \
+			LogLine logLine_(level); \
+			logLine_ << __VA_ARGS__; \
+			logLine_.Submit(); \
+		} \
+	} while (0)
+
+#define LOG_AT_LIMITED(level, ...) \
+	do { \
+		static LogRateLimit logLimit_; \
+		unsigned int logSkipped_ = 0; \
+		if (Log::IsEnabled(level) && logLimit_.Allow(LOG_REPEAT_SECONDS, logSkipped_)) { \
+			LogLine logLine_(level); \
+			logLine_ << __VA_ARGS__; \
+			if (logSkipped_ > 0) { \
+				logLine_ << "（另有 " << logSkipped_ << " 条相同消息被省略）"; \
+			} \
+			logLine_.Submit(); \
+		} \
+	} while (0)
+
+#if LOG_COMPILE_LEVEL <= 0
+#define LOG_DEBUG(...)			LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_LIMITED(...)	LOG_AT_LIMITED(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)			((void)0)
+#define LOG_DEBUG_LIMITED(...)	((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define LOG_INFO(...)			LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_INFO_LIMITED(...)	LOG_AT_LIMITED(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)			((void)0)
+#define LOG_INFO_LIMITED(...)	((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define LOG_WARNING(...)			LOG_AT(LOG_LEVEL_WARNING, __VA_ARGS__)
+#define LOG_WARNING_LIMITED(...)	LOG_AT_LIMITED(LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...)			((void)0)
+#define LOG_WARNING_LIMITED(...)	((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+#define LOG_ERROR(...)			LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_ERROR_LIMITED(...)	LOG_AT_LIMITED(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...)			((void)0)
+#define LOG_ERROR_LIMITED(...)	((void)0)
+#endif
@@ -1,4 +1,5 @@
 #include "Matrix4.h"
+#include <cstring>
 
 Matrix4::Matrix4(void)	{
 	ToIdentity();
@@ -0,0 +1,106 @@
+#include "MemoryTracker.h"
+#include <atomic>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+	//Plain arrays of atomics are zeroed before any constructor runs, so
+	//objects created or destroyed during static init / shutdown are fine
+	std::atomic<long long>	current[MEMORY_TAG_COUNT][MEMORY_KIND_COUNT];
+	std::atomic<long long>	peak[MEMORY_TAG_COUNT][MEMORY_KIND_COUNT];
+	std::atomic<long long>	totalCurrent[MEMORY_KIND_COUNT];
+	std::atomic<long long>	totalPeak[MEMORY_KIND_COUNT];
+
+	const char* TAG_NAMES[MEMORY_TAG_COUNT] = {
+		"Terrain", "Water", "Textures", "Meshes", "Simulation", "Transient"
+	};
+
+	const char* KIND_NAMES[MEMORY_KIND_COUNT] = {
+		"CPU", "GPU buffers", "GPU textures"
+	};
+
+	void RaisePeak(std::atomic<long long>& peak, long long value) {
+		long long seen = peak.load();
+		while (value > seen && !peak.compare_exchange_weak(seen, value)) {
+		}
+	}
+
+	double ToMB(long long bytes) {
+		return bytes / (1024.0 * 1024.0);
+	}
+}
+
+void MemoryTracker::Add(MemoryTag tag, MemoryKind kind, long long bytes) {
+	if (bytes == 0) {
+		return;
+	}
+	long long now	= current[tag][kind].fetch_add(bytes) + bytes;
+	long long total	= totalCurrent[kind].fetch_add(bytes) + bytes;
+	if (bytes > 0) {
+		RaisePeak(peak[tag][kind], now);
+		RaisePeak(totalPeak[kind], total);
+	}
+}
+
+MemoryTracker::Usage MemoryTracker::GetUsage(MemoryTag tag, MemoryKind kind) {
+	Usage usage;
+	usage.current	= current[tag][kind].load();
+	usage.peak		= peak[tag][kind].load();
+	return usage;
+}
+
+MemoryTracker::Usage MemoryTracker::GetTotal(MemoryKind kind) {
+	Usage usage;
+	usage.current	= totalCurrent[kind].load();
+	usage.peak		= totalPeak[kind].load();
+	return usage;
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag) {
+	return TAG_NAMES[tag];
+}
+
+const char* MemoryTracker::GetKindName(MemoryKind kind) {
+	return KIND_NAMES[kind];
+}
+
+void MemoryTracker::PrintReport(std::ostream& out) {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::left << std::setw(12) << "MB (peak)";
+	for (int k = 0; k < MEMORY_KIND_COUNT; ++k) {
+		out << std::right << std::setw(22) << KIND_NAMES[k];
+	}
+	out << "\n" << std::fixed << std::setprecision(2);
+
+	for (int t = 0; t <= MEMORY_TAG_COUNT; ++t) {
+		out << std::left << std::setw(12) << (t < MEMORY_TAG_COUNT ? TAG_NAMES[t] : "Total");
+		for (int k = 0; k < MEMORY_KIND_COUNT; ++k) {
+			Usage u = t < MEMORY_TAG_COUNT ? GetUsage((MemoryTag)t, (MemoryKind)k) : GetTotal((MemoryKind)k);
+			out << std::right << std::setw(12) << ToMB(u.current)
+				<< " (" << std::setw(7) << ToMB(u.peak) << ")";
+		}
+		out << "\n";
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
+
+size_t MemoryTracker::TextureBytes(int width, int height, int depth, int bytesPerTexel, bool mipmaps) {
+	size_t total = 0;
+	for (;;) {
+		total += (size_t)width * height * depth * bytesPerTexel;
+		if (!mipmaps || (width == 1 && height == 1)) {
+			break;
+		}
+		width	= width > 1 ? width / 2 : 1;
+		height	= height > 1 ? height / 2 : 1;
+	}
+	return total;
+}
+
+void TrackedMemory::Set(size_t newBytes) {
+	MemoryTracker::Add(tag, kind, (long long)newBytes - (long long)bytes);
+	bytes = newBytes;
+}
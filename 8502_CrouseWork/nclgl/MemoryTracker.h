@@ -0,0 +1,86 @@
+/******************************************************************************
+Class:MemoryTracker
+Description:Keeps count of how much memory each part of the program is using,
+split by tag (terrain, water...) and kind (CPU, GPU buffers, GPU textures),
+along with the most each has ever used at once.
+
+Nothing is hooked into malloc or the GL driver - the code that creates a
+buffer or a big array says how big it is. The usual way is to give the owning
+object a TrackedMemory member per kind and call Set() with its current size
+whenever that changes; the destructor takes it back off the totals. GPU sizes
+are worked out from the width / height / format passed to GL, so they're what
+was asked for, not whatever padding the driver adds.
+
+The counters are atomic, so any thread can update them, and reading them is
+cheap enough to do every frame.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+enum MemoryTag {
+	MEMORY_TERRAIN,
+	MEMORY_WATER,
+	MEMORY_TEXTURES,
+	MEMORY_MESHES,
+	MEMORY_SIMULATION,
+	MEMORY_TRANSIENT,		//Frame and scratch arenas
+	MEMORY_TAG_COUNT
+};
+
+enum MemoryKind {
+	MEMORY_CPU,
+	MEMORY_GPU_BUFFER,
+	MEMORY_GPU_TEXTURE,
+	MEMORY_KIND_COUNT
+};
+
+class MemoryTracker	{
+public:
+	struct Usage {
+		long long	current;
+		long long	peak;
+	};
+
+	//bytes < 0 releases
+	static void		Add(MemoryTag tag, MemoryKind kind, long long bytes);
+
+	static Usage	GetUsage(MemoryTag tag, MemoryKind kind);
+	static Usage	GetTotal(MemoryKind kind);	//Peak is of the total, not the sum of the peaks
+
+	static const char*	GetTagName(MemoryTag tag);
+	static const char*	GetKindName(MemoryKind kind);
+
+	//Table of current / peak use for every tag, in MB
+	static void		PrintReport(std::ostream& out);
+
+	//Size of a texture with every level of a full mip chain, if mipmaps is set
+	static size_t	TextureBytes(int width, int height, int depth, int bytesPerTexel, bool mipmaps);
+};
+
+//One object's share of the totals for one tag and kind
+class TrackedMemory	{
+public:
+	TrackedMemory(MemoryTag tag, MemoryKind kind) : tag(tag), kind(kind), bytes(0) {}
+	~TrackedMemory(void) { Set(0); }
+
+	void	Set(size_t newBytes);
+	size_t	Get() const { return bytes; }
+
+protected:
+	MemoryTag	tag;
+	MemoryKind	kind;
+	size_t		bytes;
+
+	TrackedMemory(const TrackedMemory&);
+	TrackedMemory& operator=(const TrackedMemory&);
+};
+
+//What a vector has allocated, rather than what's in use
+template <typename T, typename A>
+size_t VectorBytes(const std::vector<T, A>& v) {
+	return v.capacity() * sizeof(T);
+}
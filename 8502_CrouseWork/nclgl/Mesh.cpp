@@ -1,10 +1,16 @@
 #include "Mesh.h"
 #include "Matrix2.h"
+#include "HardwareCounters.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "PerfCounters.h"
+#include <fstream>
 
 using std::string;
+using std::vector;
 
-Mesh::Mesh(void)	{
-	glGenVertexArrays(1, &arrayObject);
+Mesh::Mesh(void) : cpuMemory(MEMORY_MESHES, MEMORY_CPU), gpuMemory(MEMORY_MESHES, MEMORY_GPU_BUFFER)	{
+	arrayObject = 0;	//Made by BufferData, so a mesh can be filled in off the GL thread
 	
 	for(int i = 0; i < MAX_BUFFER; ++i) {
 		bufferObject[i] = 0;
@@ -42,9 +48,11 @@ void Mesh::Draw()	{
 	glBindVertexArray(arrayObject);
 	if(bufferObject[INDEX_BUFFER]) {
 		glDrawElements(type, numIndices, GL_UNSIGNED_INT, 0);
+		CountDraw(numIndices);
 	}
 	else{
 		glDrawArrays(type, 0, numVertices);
+		CountDraw(numVertices);
 	}
 	glBindVertexArray(0);	
 }
@@ -63,13 +71,24 @@ void Mesh::DrawSubMesh(int i) {
 	else {
 		glDrawArrays(type, m.start, m.count);	//Draw the triangle!
 	}
+	CountDraw(m.count);
 	glBindVertexArray(0);
 }
 
+//Only triangle lists count towards the triangle total - strips and patches
+//aren't used anywhere, so there's no need to work them out
+void Mesh::CountDraw(int count) const {
+	PerfCounters::Add(PERF_DRAW_CALLS);
+	if (type == GL_TRIANGLES) {
+		PerfCounters::Add(PERF_TRIANGLES, count / 3);
+	}
+}
+
 void UploadAttribute(GLuint* id, int numElements, int dataSize, int attribSize, int attribID, void* pointer, const string&debugName) {
 	glGenBuffers(1, id);
 	glBindBuffer(GL_ARRAY_BUFFER, *id);
 	glBufferData(GL_ARRAY_BUFFER, numElements * dataSize, pointer, GL_STATIC_DRAW);
+	PerfCounters::Add(PERF_BYTES_UPLOADED, (long long)numElements * dataSize);
 
 	glVertexAttribPointer(attribID, attribSize, GL_FLOAT, GL_FALSE, 0, 0);
 	glEnableVertexAttribArray(attribID);
@@ -78,6 +97,10 @@ void UploadAttribute(GLuint* id, int numElements, int dataSize, int attribSize,
 }
 
 void	Mesh::BufferData()	{
+	ProfileScope scope("Mesh::BufferData", numVertices);
+	if (!arrayObject) {
+		glGenVertexArrays(1, &arrayObject);
+	}
 	glBindVertexArray(arrayObject);
 
 	////Buffer vertex data
@@ -108,6 +131,7 @@ void	Mesh::BufferData()	{
 		glGenBuffers(1, &bufferObject[WEIGHTINDEX_BUFFER]);
 		glBindBuffer(GL_ARRAY_BUFFER, bufferObject[WEIGHTINDEX_BUFFER]);
 		glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(int) * 4, weightIndices, GL_STATIC_DRAW);
+		PerfCounters::Add(PERF_BYTES_UPLOADED, numVertices * sizeof(int) * 4);
 		glVertexAttribIPointer(WEIGHTINDEX_BUFFER, 4, GL_INT, 0, 0); //note the new function...
 		glEnableVertexAttribArray(WEIGHTINDEX_BUFFER);
 
@@ -119,12 +143,52 @@ void	Mesh::BufferData()	{
 		glGenBuffers(1, &bufferObject[INDEX_BUFFER]);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferObject[INDEX_BUFFER]);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices*sizeof(GLuint), indices, GL_STATIC_DRAW);
+		PerfCounters::Add(PERF_BYTES_UPLOADED, numIndices * sizeof(GLuint));
 
 		glObjectLabel(GL_BUFFER, bufferObject[INDEX_BUFFER], -1, "Indices");
 	}
 	glBindVertexArray(0);	
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	//Every attribute that exists on the CPU has been copied as is
+	cpuMemory.Set(GetVertexDataSize());
+	gpuMemory.Set(GetVertexDataSize());
+}
+
+size_t Mesh::GetVertexDataSize() const {
+	size_t bytes = 0;
+	if (vertices)		{ bytes += numVertices * sizeof(Vector3); }
+	if (textureCoords)	{ bytes += numVertices * sizeof(Vector2); }
+	if (colours)		{ bytes += numVertices * sizeof(Vector4); }
+	if (normals)		{ bytes += numVertices * sizeof(Vector3); }
+	if (tangents)		{ bytes += numVertices * sizeof(Vector4); }
+	if (weights)		{ bytes += numVertices * sizeof(Vector4); }
+	if (weightIndices)	{ bytes += numVertices * sizeof(int) * 4; }
+	if (indices)		{ bytes += numIndices * sizeof(unsigned int); }
+	return bytes;
+}
+
+void Mesh::ReleaseCpuData() {
+	delete[]	vertices;
+	delete[]	indices;
+	delete[]	textureCoords;
+	delete[]	tangents;
+	delete[]	normals;
+	delete[]	colours;
+	delete[]	weights;
+	delete[]	weightIndices;
+
+	vertices		= nullptr;
+	indices			= nullptr;
+	textureCoords	= nullptr;
+	tangents		= nullptr;
+	normals			= nullptr;
+	colours			= nullptr;
+	weights			= nullptr;
+	weightIndices	= nullptr;
+
+	cpuMemory.Set(0);
 }
 
 
@@ -262,6 +326,38 @@ void ReadSubMeshNames(std::ifstream& file, int count, vector<string>& names) {
 }
 
 Mesh* Mesh::LoadFromMeshFile(const string& name) {
+	ProfileScope scope("Mesh::LoadFromMeshFile");	//Elements are vertices, once known
+	Mesh* mesh = ReadMeshFile(name);
+	if (mesh) {
+		scope.SetElements(mesh->numVertices);
+		mesh->BufferData();
+	}
+	return mesh;
+}
+
+/*
+Parsing the text is nearly all of the load time, and needs no GL, so each file
+gets a job of its own; the uploads then happen here on the GL thread, in order.
+*/
+vector<Mesh*> Mesh::LoadFromMeshFiles(const vector<string>& names, unsigned int maxThreads) {
+	ProfileScope scope("Mesh::LoadFromMeshFiles");	//Elements are vertices
+	vector<Mesh*> meshes(names.size(), nullptr);
+	JobSystem::Get().ParallelFor((int)names.size(), 1, [&](int i) {
+		meshes[i] = ReadMeshFile(names[i]);
+	}, maxThreads);
+
+	long long vertices = 0;
+	for (Mesh* mesh : meshes) {
+		if (mesh) {
+			vertices += mesh->numVertices;
+			mesh->BufferData();
+		}
+	}
+	scope.SetElements(vertices);
+	return meshes;
+}
+
+Mesh* Mesh::ReadMeshFile(const string& name) {
 	Mesh* mesh = new Mesh();
 
 	std::ifstream file(MESHDIR + name);
@@ -272,14 +368,17 @@ Mesh* Mesh::LoadFromMeshFile(const string& name) {
 	file >> filetype;
 
 	if (filetype != "MeshGeometry") {
-		std::cout << "File is not a MeshGeometry file!" << std::endl;
+		LOG_ERROR("File is not a MeshGeometry file!");
+		delete mesh;
 		return nullptr;
 	}
+	PerfCounters::Add(PERF_ASSETS_LOADED);
 
 	file >> fileVersion;
 
 	if (fileVersion != 1) {
-		std::cout << "MeshGeometry file has incompatible version!" << std::endl;
+		LOG_ERROR("MeshGeometry file has incompatible version!");
+		delete mesh;
 		return nullptr;
 	}
 
@@ -370,8 +469,6 @@ Mesh* Mesh::LoadFromMeshFile(const string& name) {
 		memcpy(mesh->weightIndices, readWeightIndices.data(), numVertices * sizeof(int) * 4);
 	}
 
-	mesh->BufferData();
-
 	return mesh;
 }
 
@@ -18,7 +18,10 @@ _-_-_-_-_-_-_-""  ""
 
 #pragma once
 
-#include "OGLRenderer.h"
+#include "glad/glad.h"
+#include "Vector2.h"
+#include "Matrix4.h"
+#include "MemoryTracker.h"
 #include <vector>
 #include <string>
 
@@ -53,12 +56,22 @@ public:
 	void DrawSubMesh(int i);
 
 	static Mesh* LoadFromMeshFile(const std::string& name);
+	//Loads several files at once, parsing them in parallel on the job system
+	//(up to maxThreads threads, 0 = all of them) and then uploading them on
+	//the calling thread, which must own the GL context. A file that fails to
+	//load leaves nullptr in its place.
+	static std::vector<Mesh*> LoadFromMeshFiles(const std::vector<std::string>& names, unsigned int maxThreads = 0);
 
 	unsigned int GetTriCount() const {
-		int primCount = indices ? numIndices : numVertices;
+		int primCount = bufferObject[INDEX_BUFFER] ? numIndices : numVertices;
 		return primCount / 3;
 	}
 
+	//Frees the CPU side copies of the vertex attributes and indices, once
+	//they've been uploaded. Only do this for meshes that will never be
+	//modified or read back again.
+	void	ReleaseCpuData();
+
 	unsigned int GetJointCount() const {
 		return (unsigned int)jointNames.size();
 	}
@@ -84,7 +97,13 @@ public:
 	bool GetSubMesh(const std::string& name, const SubMesh* s) const;
 
 protected:
+	//The file parsing half of LoadFromMeshFile. Makes no GL calls, so it can
+	//run on any thread; BufferData still has to follow on the GL thread.
+	static Mesh* ReadMeshFile(const std::string& name);
+
 	void	BufferData();
+	void	CountDraw(int count) const;	//Draw call and triangle counters
+	size_t	GetVertexDataSize() const;	//Bytes of vertex attributes + indices
 
 	GLuint	arrayObject;
 
@@ -113,5 +132,8 @@ protected:
 	std::vector<int>			jointParents;
 	std::vector< SubMesh>		meshLayers;
 	std::vector<std::string>	layerNames;
+
+	TrackedMemory	cpuMemory;
+	TrackedMemory	gpuMemory;
 };
 
@@ -1,5 +1,6 @@
 #include "MeshAnimation.h"
 #include "Matrix4.h"
+#include "Log.h"
 
 #include <fstream>
 #include <string>
@@ -19,7 +20,7 @@ MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
 	file >> filetype;
 
 	if (filetype != "MeshAnim") {
-		std::cout << "File is not a MeshAnim file!" << std::endl;
+		LOG_ERROR("File is not a MeshAnim file!");
 		return;
 	}
 	file >> fileVersion;
@@ -1,6 +1,6 @@
 #include "MeshMaterial.h"
+#include "Log.h"
 #include <fstream>
-#include <iostream>
 
 #include "common.h"
 
@@ -13,14 +13,14 @@ MeshMaterial::MeshMaterial(const std::string& filename) {
 	file >> dataType;
 
 	if (dataType != "MeshMat") {
-		std::cout << "File " << filename << " is not a MeshMaterial!\n";
+		LOG_ERROR("File " << filename << " is not a MeshMaterial!");
 		return;
 	}
 	int version;
 	file >> version;
 
 	if (version != 1) {
-		std::cout << "File " << filename << " has incompatible version " << version << "!\n";
+		LOG_ERROR("File " << filename << " has incompatible version " << version << "!");
 		return;
 	}
 
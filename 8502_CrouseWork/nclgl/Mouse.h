@@ -31,6 +31,7 @@ enum MouseButtons{
 class Mouse : public InputDevice	{
 public:
 	friend class Window;
+	friend class InputRecorder;	//Records / replays the device state
 
 	//Is this mouse button currently pressed down?
 	bool	ButtonDown(MouseButtons button);
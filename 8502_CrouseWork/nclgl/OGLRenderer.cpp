@@ -14,6 +14,8 @@ _-_-_-_-_-_-_-""  ""
 */
 #include "OGLRenderer.h"
 #include "Shader.h"
+#include "Log.h"
+#include "PerfCounters.h"
 #include <algorithm>
 
 using std::string;
@@ -39,7 +41,7 @@ OGLRenderer::OGLRenderer(Window &window)	{ // 构造函数，接收窗口引用
 
 	// Did We Get A Device Context?
 	if (!(deviceContext=GetDC(windowHandle)))		{// 获取设备上下文（DC），失败则退出构造					 
-		std::cout << "OGLRenderer::OGLRenderer(): Failed to create window!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Failed to create window!");
 		return;
 	}
 	
@@ -58,30 +60,30 @@ OGLRenderer::OGLRenderer(Window &window)	{ // 构造函数，接收窗口引用
 
 	GLuint		PixelFormat;  // 用于保存选择到的像素格式索引
 	if (!(PixelFormat=ChoosePixelFormat(deviceContext,&pfd)))		{	// Did Windows Find A Matching Pixel Format for our PFD?
-		std::cout << "OGLRenderer::OGLRenderer(): Failed to choose a pixel format!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Failed to choose a pixel format!");
 		return;
 	}
 
 	if(!SetPixelFormat(deviceContext,PixelFormat,&pfd))			{		// Are We Able To Set The Pixel Format?
-		std::cout << "OGLRenderer::OGLRenderer(): Failed to set a pixel format!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Failed to set a pixel format!");
 		return;
 	}
 
 	HGLRC		tempContext;		//We need a temporary OpenGL context to check for OpenGL 3.2 compatibility...stupid!!!
 	if (!(tempContext=wglCreateContext(deviceContext)))				{	// Are We Able To get the temporary context?
-		std::cout << "OGLRenderer::OGLRenderer(): Cannot create a temporary context!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Cannot create a temporary context!");
 		wglDeleteContext(tempContext);
 		return;
 	}
 
 	if(!wglMakeCurrent(deviceContext,tempContext))					{	// Try To Activate The Rendering Context
-		std::cout << "OGLRenderer::OGLRenderer(): Cannot set temporary context!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Cannot set temporary context!");
 		wglDeleteContext(tempContext);
 		return;
 	}
 
 	if (!gladLoadGL()) {
-		std::cout << "OGLRenderer::OGLRenderer(): Cannot initialise GLAD!\n";	//It's all gone wrong!
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Cannot initialise GLAD!");	//It's all gone wrong!
 		return;
 	}
 
@@ -90,16 +92,16 @@ OGLRenderer::OGLRenderer(Window &window)	{ // 构造函数，接收窗口引用
 	int major = ver[0] - '0';		//casts the 'correct' major version integer from our version string
 	int minor = ver[2] - '0';		//casts the 'correct' minor version integer from our version string
 
-	std::cout << "OGLRenderer::OGLRenderer(): Maximum OGL version supported is " << major << "." << minor << "\n";
+	LOG_INFO("OGLRenderer::OGLRenderer(): Maximum OGL version supported is " << major << "." << minor);
 
 	if(major < 3) {					//Graphics hardware does not support OGL 3! Erk...
-		std::cout << "OGLRenderer::OGLRenderer(): Device does not support OpenGL 3.x!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Device does not support OpenGL 3.x!");
 		wglDeleteContext(tempContext);
 		return;
 	}
 
 	if(major == 3 && minor < 2) {	//Graphics hardware does not support ENOUGH of OGL 3! Erk...
-		std::cout << "OGLRenderer::OGLRenderer(): Device does not support OpenGL 3.2!\n";
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Device does not support OpenGL 3.2!");
 		wglDeleteContext(tempContext);
 		return;
 	}
@@ -124,7 +126,7 @@ OGLRenderer::OGLRenderer(Window &window)	{ // 构造函数，接收窗口引用
 
 	// Check for the context, and try to make it the current rendering context
 	if(!renderContext || !wglMakeCurrent(deviceContext,renderContext))		{			
-		std::cout << "OGLRenderer::OGLRenderer(): Cannot set OpenGL 3 context!\n";	//It's all gone wrong!
+		LOG_ERROR("OGLRenderer::OGLRenderer(): Cannot set OpenGL 3 context!");	//It's all gone wrong!
 		wglDeleteContext(renderContext);
 		wglDeleteContext(tempContext);
 		return;
@@ -221,6 +223,7 @@ void OGLRenderer::UpdateShaderMatrices() {
 void OGLRenderer::BindShader(Shader*s) {
 	currentShader = s; // 记录当前着色器对象指针
 	glUseProgram(s->GetProgram()); // 激活对应的着色器程序（绑定到管线）
+	PerfCounters::Add(PERF_SHADER_BINDS);
 }
 
 #ifdef OPENGL_DEBUGGING
@@ -260,7 +263,7 @@ void OGLRenderer::DebugCallback(GLenum source, GLenum type, GLuint id, GLenum se
 			case GL_DEBUG_SEVERITY_LOW_ARB		: severityName = "Priority(Low)"		;break;
 		}
 
-		std::cout << "OpenGL Debug Output: " + sourceName + ", " + typeName + ", " + severityName + ", " + string(message) << "\n";
+		LOG_WARNING("OpenGL Debug Output: " + sourceName + ", " + typeName + ", " + severityName + ", " + string(message));
 }
 #endif
 
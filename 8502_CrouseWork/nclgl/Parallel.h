@@ -0,0 +1,24 @@
+/******************************************************************************
+Description:Parallel-for helper, running on the shared JobSystem. Work items are
+handed out through an atomic counter, so each index is processed exactly once
+regardless of how many threads take part. As long as the work for an index
+only depends on that index, results are identical for any thread count.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "JobSystem.h"
+
+//Number of threads to use when the caller passes 0
+inline unsigned int DefaultThreadCount() {
+	return JobSystem::Get().GetWorkerCount() + 1;
+}
+
+//Calls func(i) for every i in [0, count), spread across at most threadCount
+//threads (0 = every worker). The calling thread takes part as well. Indices
+//are claimed grain at a time; raise it when each item is only a few
+//instructions' work.
+template <typename Func>
+void ParallelFor(int count, unsigned int threadCount, const Func& func, int grain = 1) {
+	JobSystem::Get().ParallelFor(count, grain, func, threadCount);
+}
@@ -0,0 +1,197 @@
+#include "PerfCounters.h"
+#include "Log.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace {
+	const size_t NAME_SIZE = 32;
+
+	const char* BUILTIN_NAMES[PERF_BUILTIN_COUNT] = {
+		"draw_calls", "triangles", "shader_binds", "texture_binds", "bytes_uploaded", "assets_loaded"
+	};
+
+	//Zero initialised before any constructor runs, so counters can be bumped
+	//from static init (eg shaders or textures created by globals)
+	std::atomic<long long>	current[MAX_PERF_COUNTERS];
+	std::atomic<int>		registered;		//Past the builtins
+	char					names[MAX_PERF_COUNTERS][NAME_SIZE];
+	PerfCounterKind			kinds[MAX_PERF_COUNTERS];
+	std::mutex				registerLock;
+
+	//Only touched by EndFrame and the getters, all on one thread
+	long long				previous[MAX_PERF_COUNTERS];
+	long long				frameValues[MAX_PERF_COUNTERS];
+	long long				totals[MAX_PERF_COUNTERS];
+	int						frameNumber;
+
+	void WriteJsonString(std::ostream& out, const char* text) {
+		out << '"';
+		for (const char* c = text; *c; ++c) {
+			if (*c == '"' || *c == '\\') {
+				out << '\\';
+			}
+			out << *c;
+		}
+		out << '"';
+	}
+}
+
+int PerfCounters::Register(const std::string& name, PerfCounterKind kind) {
+	std::lock_guard<std::mutex> guard(registerLock);
+	int count = GetCount();
+	for (int i = 0; i < count; ++i) {
+		if (name == GetName(i)) {
+			return i;
+		}
+	}
+	if (count >= MAX_PERF_COUNTERS) {
+		LOG_ERROR("错误：性能计数器已满，无法注册 " << name);
+		return -1;
+	}
+	strncpy(names[count], name.c_str(), NAME_SIZE - 1);
+	kinds[count] = kind;
+	//Published after the name is written, so GetName never sees half of it
+	registered.store(count + 1 - PERF_BUILTIN_COUNT, std::memory_order_release);
+	return count;
+}
+
+void PerfCounters::Add(int id, long long amount) {
+	if (id >= 0) {
+		current[id].fetch_add(amount, std::memory_order_relaxed);
+	}
+}
+
+void PerfCounters::Set(int id, long long value) {
+	if (id >= 0) {
+		current[id].store(value, std::memory_order_relaxed);
+	}
+}
+
+void PerfCounters::EndFrame() {
+	int count = GetCount();
+	for (int i = 0; i < count; ++i) {
+		long long now = current[i].load(std::memory_order_relaxed);
+		if (GetKind(i) == PERF_GAUGE) {
+			frameValues[i] = now;
+		}
+		else {
+			frameValues[i]	= now - previous[i];
+			previous[i]		= now;
+		}
+		totals[i] = now;
+	}
+	++frameNumber;
+}
+
+int PerfCounters::GetCount() {
+	return PERF_BUILTIN_COUNT + registered.load(std::memory_order_acquire);
+}
+
+const char* PerfCounters::GetName(int id) {
+	return id < PERF_BUILTIN_COUNT ? BUILTIN_NAMES[id] : names[id];
+}
+
+PerfCounterKind PerfCounters::GetKind(int id) {
+	return id < PERF_BUILTIN_COUNT ? PERF_COUNTER : kinds[id];
+}
+
+long long PerfCounters::GetFrameValue(int id) {
+	return frameValues[id];
+}
+
+long long PerfCounters::GetTotal(int id) {
+	return totals[id];
+}
+
+int PerfCounters::GetFrameNumber() {
+	return frameNumber;
+}
+
+void PerfCounterLog::AddFrame() {
+	frameNumbers.push_back(PerfCounters::GetFrameNumber());
+	values.resize(values.size() + MAX_PERF_COUNTERS, 0);
+	long long* frame = &values[values.size() - MAX_PERF_COUNTERS];
+	int count = PerfCounters::GetCount();
+	for (int i = 0; i < count; ++i) {
+		frame[i] = PerfCounters::GetFrameValue(i);
+	}
+}
+
+bool PerfCounterLog::Write(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("错误：无法写入性能计数器文件 " << path);
+		return false;
+	}
+	bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	if (json) {
+		WriteJson(file);
+	}
+	else {
+		WriteCsv(file);
+	}
+	if (!file.good()) {
+		LOG_ERROR("错误：写入性能计数器文件 " << path << " 失败");
+		return false;
+	}
+	LOG_INFO("✓ 性能计数器已写入 " << path << "（" << GetFrameCount() << " 帧）");
+	return true;
+}
+
+void PerfCounterLog::WriteCsv(std::ostream& out) const {
+	int count = PerfCounters::GetCount();
+	out << "frame";
+	for (int i = 0; i < count; ++i) {
+		out << ',' << PerfCounters::GetName(i);
+	}
+	out << '\n';
+	for (int f = 0; f < GetFrameCount(); ++f) {
+		out << frameNumbers[f];
+		for (int i = 0; i < count; ++i) {
+			out << ',' << GetValue(f, i);
+		}
+		out << '\n';
+	}
+}
+
+void PerfCounterLog::WriteJson(std::ostream& out) const {
+	int count = PerfCounters::GetCount();
+	out << "{\n  \"counters\": [";
+	for (int i = 0; i < count; ++i) {
+		out << (i ? ",\n    " : "\n    ") << "{\"name\": ";
+		WriteJsonString(out, PerfCounters::GetName(i));
+		out << ", \"kind\": \"" << (PerfCounters::GetKind(i) == PERF_GAUGE ? "gauge" : "counter") << "\"}";
+	}
+	out << "\n  ],\n  \"frames\": [";
+	for (int f = 0; f < GetFrameCount(); ++f) {
+		out << (f ? ",\n    " : "\n    ") << "{\"frame\": " << frameNumbers[f] << ", \"values\": [";
+		for (int i = 0; i < count; ++i) {
+			out << (i ? ", " : "") << GetValue(f, i);
+		}
+		out << "]}";
+	}
+	out << "\n  ]\n}\n";
+}
+
+void PerfCounterLog::FormatOverlay(std::vector<std::string>& lines) {
+	char line[96];
+	char frame[24];
+	lines.clear();
+	snprintf(frame, sizeof(frame), "frame %d", PerfCounters::GetFrameNumber());
+	snprintf(line, sizeof(line), "%-16s %10s %14s", frame, "this frame", "total");
+	lines.push_back(line);
+	int count = PerfCounters::GetCount();
+	for (int i = 0; i < count; ++i) {
+		if (PerfCounters::GetKind(i) == PERF_GAUGE) {
+			snprintf(line, sizeof(line), "%-16s %10lld", PerfCounters::GetName(i), PerfCounters::GetFrameValue(i));
+		}
+		else {
+			snprintf(line, sizeof(line), "%-16s %10lld %14lld", PerfCounters::GetName(i),
+				PerfCounters::GetFrameValue(i), PerfCounters::GetTotal(i));
+		}
+		lines.push_back(line);
+	}
+}
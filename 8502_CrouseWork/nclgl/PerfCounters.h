@@ -0,0 +1,94 @@
+/******************************************************************************
+Class:PerfCounters
+Description:Named runtime counters and gauges - draw calls, triangles, state
+changes, bytes uploaded, assets loaded and anything else worth watching.
+
+A counter only ever goes up (Add); what's reported for a frame is how much it
+went up during that frame. A gauge is a level (Set) - water tiles visible,
+jobs queued - and is reported as whatever it was last set to. The common
+rendering counters have fixed ids (PerfCounterId); anything else can be added
+at run time with Register, which hands back the same id for the same name.
+
+Add / Set are a single relaxed atomic operation on a fixed array, so they can
+be called from any thread, any number of times a frame. EndFrame takes the
+snapshot that everything else reads - call it once per frame, always from the
+same thread, and read the snapshot from that thread too.
+
+PerfCounterLog keeps every frame's snapshot and writes them out as CSV (one
+column per counter) or JSON, and FormatOverlay turns the latest snapshot into
+a few lines of text for an on-screen display.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+enum PerfCounterId {
+	PERF_DRAW_CALLS,
+	PERF_TRIANGLES,
+	PERF_SHADER_BINDS,
+	PERF_TEXTURE_BINDS,
+	PERF_BYTES_UPLOADED,	//Buffer and texture data sent to the GPU
+	PERF_ASSETS_LOADED,		//Textures, shaders, meshes, heightmaps read from disk
+	PERF_BUILTIN_COUNT
+};
+
+enum PerfCounterKind {
+	PERF_COUNTER,
+	PERF_GAUGE
+};
+
+const int MAX_PERF_COUNTERS = 64;
+
+class PerfCounters	{
+public:
+	//Returns the id for name, registering it if it's new, or -1 if the
+	//table is full. Names are copied.
+	static int		Register(const std::string& name, PerfCounterKind kind);
+
+	static void		Add(int id, long long amount = 1);
+	static void		Set(int id, long long value);
+
+	//Snapshots every counter, and starts counting the next frame
+	static void		EndFrame();
+
+	static int				GetCount();
+	static const char*		GetName(int id);
+	static PerfCounterKind	GetKind(int id);
+
+	//From the last EndFrame: a counter's increase over that frame, or a
+	//gauge's value
+	static long long		GetFrameValue(int id);
+	//From the last EndFrame: a counter's total since start up, or a gauge's
+	//value
+	static long long		GetTotal(int id);
+	static int				GetFrameNumber();	//Number of EndFrame calls so far
+};
+
+class PerfCounterLog	{
+public:
+	//Records the snapshot from the last PerfCounters::EndFrame
+	void	AddFrame();
+
+	int		GetFrameCount() const { return (int)frameNumbers.size(); }
+	//0 for counters registered after the frame was recorded
+	long long	GetValue(int frame, int id) const { return values[(size_t)frame * MAX_PERF_COUNTERS + id]; }
+
+	//Picks JSON for a .json file name and CSV for anything else. Returns
+	//false (with an error logged) if the file can't be written.
+	bool	Write(const std::string& path) const;
+
+	//frame,<counter>,<counter>... with one row per frame
+	void	WriteCsv(std::ostream& out) const;
+	//{"counters":[{"name","kind"}...],"frames":[{"frame":n,"values":[...]}...]}
+	void	WriteJson(std::ostream& out) const;
+
+	//One line per counter from the last snapshot: name, this frame, total
+	static void	FormatOverlay(std::vector<std::string>& lines);
+
+protected:
+	std::vector<int>		frameNumbers;
+	std::vector<long long>	values;		//MAX_PERF_COUNTERS per frame
+};
@@ -0,0 +1,58 @@
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <cstdint>
+
+FixedPool::FixedPool(size_t size, size_t alignment, size_t perChunk) {
+	//Every block has to be able to hold the free list link, and be aligned
+	//for it
+	blockAlignment	= std::max(alignment, alignof(FreeBlock));
+	blockSize		= std::max(size, sizeof(FreeBlock));
+	blockSize		= (blockSize + blockAlignment - 1) / blockAlignment * blockAlignment;
+	blocksPerChunk	= std::max(perChunk, (size_t)1);
+	live			= 0;
+	freeList		= nullptr;
+}
+
+FixedPool::~FixedPool(void) {
+	for (char* chunk : chunks) {
+		::operator delete(chunk);
+	}
+}
+
+void* FixedPool::Allocate() {
+	if (!freeList) {
+		Grow();
+	}
+	FreeBlock* block = freeList;
+	freeList = block->next;
+	++live;
+	return block;
+}
+
+void FixedPool::Free(void* block) {
+	if (!block) {
+		return;
+	}
+	FreeBlock* f = (FreeBlock*)block;
+	f->next		= freeList;
+	freeList	= f;
+	--live;
+}
+
+void FixedPool::Grow() {
+	//operator new only guarantees the default alignment, so leave room to
+	//line the first block up when more is asked for
+	size_t	slack	= blockAlignment > alignof(std::max_align_t) ? blockAlignment : 0;
+	char*	chunk	= (char*)::operator new(blockSize * blocksPerChunk + slack);
+	chunks.push_back(chunk);
+
+	uintptr_t	start	= ((uintptr_t)chunk + blockAlignment - 1) & ~(uintptr_t)(blockAlignment - 1);
+	char*		first	= (char*)start;
+
+	//Pushed in reverse so blocks come out in address order
+	for (size_t i = blocksPerChunk; i-- > 0; ) {
+		FreeBlock* f = (FreeBlock*)(first + i * blockSize);
+		f->next		= freeList;
+		freeList	= f;
+	}
+}
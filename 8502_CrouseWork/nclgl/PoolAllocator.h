@@ -0,0 +1,129 @@
+/******************************************************************************
+Class:FixedPool
+Description:Hands out blocks of one fixed size, for objects that are created
+and destroyed a lot - scene nodes, handles, list / map nodes and so on. The
+job system keeps the jobs waiting on a dependency in one.
+
+Blocks are carved out of big chunks, and freed ones go onto a free list that
+the next allocation takes from, so once the pool has grown to the most that's
+ever been alive at once, allocating and freeing never touch the heap. Chunks
+are only given back when the pool is destroyed. The free list is LIFO, so the
+block handed out next is the one most recently freed, and still in cache.
+
+Not thread safe - use one pool per thread, or lock around it.
+
+ObjectPool<T> wraps a FixedPool sized for T, with Create / Destroy calling the
+constructor and destructor. PoolAllocator<T> lets node based containers
+(std::list, std::map, std::set...) allocate their nodes from a FixedPool. The
+node type is the container's own, so make the pool at least as big as that;
+anything that doesn't fit, and any request for more than one element, goes
+to operator new instead.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+class FixedPool	{
+public:
+	FixedPool(size_t blockSize, size_t blockAlignment = alignof(std::max_align_t), size_t blocksPerChunk = 256);
+	~FixedPool(void);
+
+	void*	Allocate();
+	void	Free(void* block);
+
+	size_t	GetBlockSize()		const { return blockSize; }
+	size_t	GetBlockAlignment()	const { return blockAlignment; }
+	size_t	GetLiveCount()		const { return live; }
+	size_t	GetCapacity()		const { return chunks.size() * blocksPerChunk; }
+
+protected:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	void	Grow();
+
+	size_t				blockSize;
+	size_t				blockAlignment;
+	size_t				blocksPerChunk;
+	size_t				live;
+	FreeBlock*			freeList;
+	std::vector<char*>	chunks;
+
+	FixedPool(const FixedPool&);
+	FixedPool& operator=(const FixedPool&);
+};
+
+template <typename T>
+class ObjectPool	{
+public:
+	explicit ObjectPool(size_t objectsPerChunk = 256) : pool(sizeof(T), alignof(T), objectsPerChunk) {}
+
+	template <typename... Args>
+	T*		Create(Args&&... args) {
+		void* block = pool.Allocate();
+		return new (block) T(std::forward<Args>(args)...);
+	}
+
+	void	Destroy(T* object) {
+		if (object) {
+			object->~T();
+			pool.Free(object);
+		}
+	}
+
+	size_t	GetLiveCount() const { return pool.GetLiveCount(); }
+
+protected:
+	FixedPool pool;
+};
+
+template <typename T>
+class PoolAllocator	{
+public:
+	typedef T value_type;
+
+	explicit PoolAllocator(FixedPool& pool) : pool(&pool) {}
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>& other) : pool(other.GetPool()) {}
+
+	T* allocate(size_t count) {
+		if (FromPool(count)) {
+			return (T*)pool->Allocate();
+		}
+		return (T*)::operator new(sizeof(T) * count);
+	}
+
+	void deallocate(T* p, size_t count) {
+		if (FromPool(count)) {
+			pool->Free(p);
+		}
+		else {
+			::operator delete(p);
+		}
+	}
+
+	FixedPool* GetPool() const { return pool; }
+
+protected:
+	bool FromPool(size_t count) const {
+		return count == 1 && sizeof(T) <= pool->GetBlockSize() && alignof(T) <= pool->GetBlockAlignment();
+	}
+
+	FixedPool* pool;
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) {
+	return a.GetPool() == b.GetPool();
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) {
+	return a.GetPool() != b.GetPool();
+}
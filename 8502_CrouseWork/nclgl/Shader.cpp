@@ -1,11 +1,14 @@
 ﻿#include "Shader.h"      // 包含着色器类的头文件（类声明、常量定义）
 #include "Mesh.h"        // 包含顶点缓冲区枚举（VERTEX_BUFFER、COLOUR_BUFFER等）
-#include <iostream>      // 标准输入输出库
+#include "Log.h"         // 日志输出（LOG_INFO / LOG_ERROR 等）
+#include "PerfCounters.h"  // 着色器文件计入 assets_loaded
+#include <cstring>
 #include <filesystem> // C++17
+#include <fstream>
 
 using std::string;
-using std::cout;
 using std::ifstream;
+using std::vector;
 
 // 用于保存所有已创建的 Shader 实例的静态成员
 vector<Shader*> Shader::allShaders;
@@ -67,19 +70,11 @@ void	Shader::Reload(bool deleteOld) {
 bool	Shader::LoadShaderFile(const string& filename, string &into)	{
 	ifstream	file(SHADERDIR + filename);
 	string		textLine;
-	char buffer[MAX_PATH];
-	GetCurrentDirectoryA(MAX_PATH, buffer); // 获取当前工作目录
-	std::string currentDir(buffer);
 
-	std::string fullPath = SHADERDIR + filename;
-	std::string absolutePath = currentDir + "\\" + fullPath; // 拼接成绝对路径（简单拼接）
-
-	std::cout << "Current directory: " << currentDir << std::endl;
-	std::cout << "Trying to load shader from: " << absolutePath << std::endl;
-	cout << "Loading shader text from " << filename << "\n\n";
+	LOG_DEBUG("Loading shader text from " << filename);
 
 	if(!file.is_open()){
-		cout << "ERROR ERROR ERROR ERROR: File does not exist!\n";
+		LOG_ERROR("Shader file " << SHADERDIR << filename << " does not exist!");
 		return false;
 	}
 	int lineNum = 1; 
@@ -89,18 +84,19 @@ bool	Shader::LoadShaderFile(const string& filename, string &into)	{
 		into += textLine;
 		++lineNum;
 	}
-	cout << "\nLoaded shader text!\n\n";
+	LOG_DEBUG("Loaded shader text!");
+	PerfCounters::Add(PERF_ASSETS_LOADED);
 	return true;
 }
 //-----------------------------------------------------------
 // 编译指定类型的着色器（顶点、片段等）
 //-----------------------------------------------------------
 void	Shader::GenerateShaderObject(unsigned int i)	{
-	cout << "Compiling Shader...\n";
+	LOG_DEBUG("Compiling Shader...");
 
 	string shaderText;
 	if(!LoadShaderFile(shaderFiles[i],shaderText)) {
-		cout << "Loading failed!\n";
+		LOG_ERROR("Loading " << shaderFiles[i] << " failed!");
 		shaderValid[i] = false;
 		return;
 	}
@@ -115,11 +111,11 @@ void	Shader::GenerateShaderObject(unsigned int i)	{
 	glGetShaderiv(objectIDs[i], GL_COMPILE_STATUS, &shaderValid[i]);
 
 	if (!shaderValid[i]) {
-		cout << "Compiling failed!\n";
+		LOG_ERROR("Compiling " << shaderFiles[i] << " failed!");
 		PrintCompileLog(objectIDs[i]);
 	}
 	else {
-		cout << "Compiling success!\n\n";
+		LOG_DEBUG("Compiling success!");
 	}
 
 	glObjectLabel(GL_SHADER, objectIDs[i], -1, shaderFiles[i].c_str());
@@ -168,7 +164,8 @@ void	Shader::PrintCompileLog(GLuint object) {
 	if (logLength) {
 		char* tempData = new char[logLength];
 		glGetShaderInfoLog(object, logLength, NULL, tempData);
-		std::cout << "Compile Log:\n" << tempData << std::endl;
+		LOG_ERROR("Compile Log:");
+		Log::Write(LOG_LEVEL_ERROR, tempData, strlen(tempData));
 		delete[] tempData;
 	}
 }
@@ -180,7 +177,8 @@ void	Shader::PrintLinkLog(GLuint program) {
 	if (logLength) {
 		char* tempData = new char[logLength];
 		glGetProgramInfoLog(program, logLength, NULL, tempData);
-		std::cout << "Link Log:\n" << tempData << std::endl;
+		LOG_WARNING("Link Log:");
+		Log::Write(LOG_LEVEL_WARNING, tempData, strlen(tempData));
 		delete[] tempData;
 	}
 }
@@ -15,7 +15,9 @@ _-_-_-_-_-_-_-""  ""
 *//////////////////////////////////////////////////////////////////////////////
 
 #pragma once
-#include "OGLRenderer.h"
+#include "glad/glad.h"
+#include <string>
+#include <vector>
 
 enum ShaderStage {
 	SHADER_VERTEX,
@@ -1,6 +1,7 @@
 #include "Window.h"
 #include "Mouse.h"
 #include "Keyboard.h"
+#include "Log.h"
 
 Window* Window::window		= nullptr;
 Keyboard*Window::keyboard	= nullptr;
@@ -38,7 +39,7 @@ Window::Window(std::string title, int sizeX, int sizeY, bool fullScreen)	{
 		windowClass.lpszClassName = WINDOWCLASS;
 
 		if(!RegisterClassExA(&windowClass)) {
-			std::cout << "Window::Window(): Failed to register class!" << std::endl;
+			LOG_ERROR("Window::Window(): Failed to register class!");
 			return;
 		}
 	}
@@ -55,7 +56,7 @@ Window::Window(std::string title, int sizeX, int sizeY, bool fullScreen)	{
 		dmScreenSettings.dmFields=DM_BITSPERPEL|DM_PELSWIDTH|DM_PELSHEIGHT|DM_DISPLAYFREQUENCY;
 
 		if(ChangeDisplaySettings(&dmScreenSettings,CDS_FULLSCREEN)!=DISP_CHANGE_SUCCESSFUL)	{
-			std::cout << "Window::Window(): Failed to switch to fullscreen!" << std::endl;
+			LOG_ERROR("Window::Window(): Failed to switch to fullscreen!");
 			return;
 		}
 	}
@@ -74,7 +75,7 @@ Window::Window(std::string title, int sizeX, int sizeY, bool fullScreen)	{
                         NULL);				// No multiple windows!
 
  	if(!windowHandle) {
-		std::cout << "Window::Window(): Failed to create window!" << std::endl;
+		LOG_ERROR("Window::Window(): Failed to create window!");
 		return;
 	}
 